@@ -58,7 +58,7 @@ struct GraphSearchJob {
   std::shared_ptr<Graph<DataType, IDType>> graph_ = nullptr;  ///< The search graph.
   std::shared_ptr<JobContext<IDType>> job_context_;           ///< The shared job context
   std::unique_ptr<HashSetPool> visited_pool_;                 ///< Reused visited pool for rabitq
-  std::unique_ptr<QueryScratchPool> query_scratch_pool_;      ///< Reused rerank buffers
+  std::unique_ptr<QueryScratchPool> query_scratch_pool_;      ///< Reused per-query scratch
 
   /// Compile-time flag: whether rerank is needed
   static constexpr bool kNeedsRerank = !std::is_same_v<DistanceSpaceType, BuildSpaceType>;
@@ -93,6 +93,9 @@ struct GraphSearchJob {
         auto cur_neighbor = ptr_nb[i];
         if (!vis.get(cur_neighbor)) {
           vis.set(cur_neighbor);
+          if (sp->is_deleted(cur_neighbor)) {
+            continue;
+          }
           supplement_count += static_cast<uint32_t>(
               result_pool.insert(cur_neighbor,
                                  dist_func(query, sp->get_data_by_id(cur_neighbor), dim)));
@@ -143,8 +146,21 @@ struct GraphSearchJob {
     IDType id_;
   };
 
+  /// Candidate pool kept across queries. 8-bit epoch tags make starting a query O(1), with a full
+  /// clear every 255 queries, at 1 byte per node; the scratch pool keeps one pool per query that
+  /// has been in flight at once, so the tags cost that many bytes per node.
+  using SearchPool = LinearPool<DistanceType, IDType, EpochVisitedSet<uint8_t>>;
+  using QueryBuffer = std::vector<uint8_t, AlignedAlloc<uint8_t>>;
+
+  /// Everything one in-flight query needs, leased from query_scratch_pool_ so a search allocates
+  /// nothing once the pool has warmed up to the number of concurrent queries.
   struct QueryScratch {
     std::vector<RerankCandidate> rerank_heap_;
+    std::unique_ptr<SearchPool> search_pool_;
+    QueryBuffer query_buffer_;         ///< Aligned query copy / encoding for the search space
+    QueryBuffer rerank_query_buffer_;  ///< Aligned query copy for the build space (rerank)
+    std::vector<IDType> batch_ids_;          ///< Unvisited neighbors of the node being expanded
+    std::vector<DistanceType> batch_dists_;  ///< Their distances, filled in one compute() call
 
     void prepare(size_t topk) {
       rerank_heap_.clear();
@@ -152,14 +168,104 @@ struct GraphSearchJob {
         rerank_heap_.reserve(topk);
       }
     }
+
+    auto search_pool(IDType n, uint32_t ef) -> SearchPool & {
+      if (search_pool_ == nullptr) {
+        search_pool_ = std::make_unique<SearchPool>(n, static_cast<int>(ef));
+      } else {
+        search_pool_->reset(n, static_cast<int>(ef));
+      }
+      return *search_pool_;
+    }
   };
 
+  /**
+   * @brief Build a query computer for `space`, staging the query in `buffer` when the space
+   * supports caller-owned query storage and falling back to its allocating overload otherwise.
+   */
+  template <typename SpaceType>
+  static auto make_query_computer(SpaceType *space, const DataType *query, QueryBuffer &buffer) {
+    if constexpr (requires(void *raw) {
+                    space->get_query_computer(query, raw);
+                    space->get_query_buffer_size();
+                  }) {
+      auto bytes = space->get_query_buffer_size();
+      if (buffer.size() < bytes) {
+        buffer.resize(bytes);
+      }
+      return space->get_query_computer(query, static_cast<void *>(buffer.data()));
+    } else {
+      return space->get_query_computer(query);
+    }
+  }
+
+  /**
+   * @brief Mark the unvisited neighbors of `u` visited and gather them into scratch.batch_ids_
+   * @return Number of gathered neighbors
+   */
+  static auto collect_unvisited(const Graph<DataType, IDType> *gr,
+                                SearchPool &pool,
+                                IDType u,
+                                QueryScratch &scratch) -> size_t {
+    if (scratch.batch_ids_.size() < gr->max_nbrs_) {
+      scratch.batch_ids_.resize(gr->max_nbrs_);
+      scratch.batch_dists_.resize(gr->max_nbrs_);
+    }
+    size_t count = 0;
+    for (uint32_t i = 0; i < gr->max_nbrs_; ++i) {
+      auto v = gr->at(u, i);
+      if (v == static_cast<IDType>(-1)) {
+        break;
+      }
+      if (pool.vis_.get(v)) {
+        continue;
+      }
+      pool.vis_.set(v);
+      scratch.batch_ids_[count++] = v;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Score the `count` neighbors gathered by collect_unvisited() and insert them into the
+   * pool, with one QueryComputer::compute() call when the space provides the batched API and one
+   * operator() call per neighbor (prefetching a few ahead) otherwise.
+   */
+  template <typename SpaceType, typename Computer>
+  static void insert_neighbors(SpaceType *sp,
+                               const Computer &query_computer,
+                               SearchPool &pool,
+                               QueryScratch &scratch,
+                               size_t count) {
+    const IDType *ids = scratch.batch_ids_.data();
+    if constexpr (requires(const IDType *batch, DistanceType *out) {
+                    query_computer.compute(batch, count, out);
+                  }) {
+      DistanceType *dists = scratch.batch_dists_.data();
+      query_computer.compute(ids, count, dists);
+      for (size_t i = 0; i < count; ++i) {
+        pool.insert(ids[i], dists[i]);
+      }
+    } else {
+      for (size_t i = 0; i < count; ++i) {
+        if (i + 3 < count) {
+          sp->prefetch_by_id(ids[i + 3]);
+        }
+        pool.insert(ids[i], query_computer(ids[i]));
+      }
+    }
+  }
+
   class QueryScratchPool {
    public:
+    /// Grows to the largest number of scratches ever leased at once and keeps them all: a
+    /// coroutine batch holds workers x interleave queries in flight, and the next batch needs as
+    /// many again, so freeing any would bring back the per-query visited-set allocation.
     explicit QueryScratchPool(size_t init_pool_size) {
       for (size_t i = 0; i < init_pool_size; ++i) {
         pool_.push_front(new QueryScratch());
       }
+      allocations_ = init_pool_size;
     }
 
     ~QueryScratchPool() {
@@ -184,6 +290,7 @@ struct GraphSearchJob {
           pool_.pop_front();
         } else {
           res = new QueryScratch();
+          ++allocations_;
         }
       }
       res->prepare(topk);
@@ -195,9 +302,16 @@ struct GraphSearchJob {
       pool_.push_front(scratch);
     }
 
+    /// Scratches allocated so far; test observer.
+    auto allocations() -> size_t {
+      std::unique_lock<std::mutex> lock(poolguard_);
+      return allocations_;
+    }
+
    private:
     std::deque<QueryScratch *> pool_;
     std::mutex poolguard_;
+    size_t allocations_ = 0;
   };
 
   class QueryScratchLease {
@@ -257,21 +371,16 @@ struct GraphSearchJob {
    * @param topk Number of results to return
    * @param dist_compute Distance computer from build space
    */
-  void rerank(const LinearPool<DistanceType, IDType> &src,
+  void rerank(QueryScratch &scratch,
+              const SearchPool &src,
               IDType *desc,
               uint32_t topk,
               auto dist_compute) {
     if (topk == 0) {
       return;
     }
-    QueryScratchLease scratch(query_scratch_pool_.get(), topk);
-    auto *query_scratch = scratch.get();
-    if (query_scratch == nullptr) {
-      fill_invalid_ids(desc, 0, topk);
-      return;
-    }
 
-    auto &heap = query_scratch->rerank_heap_;
+    auto &heap = scratch.rerank_heap_;
     auto candidate_count = static_cast<uint32_t>(src.size());
     for (uint32_t i = 0; i < candidate_count; ++i) {
       RerankCandidate candidate{dist_compute(src.id(i)), src.id(i)};
@@ -303,7 +412,8 @@ struct GraphSearchJob {
    * @param topk Number of results to return
    * @param dist_compute Distance computer from build space
    */
-  void rerank(const LinearPool<DistanceType, IDType> &src,
+  void rerank(QueryScratch &scratch,
+              const SearchPool &src,
               IDType *desc,
               DistanceType *distances,
               uint32_t topk,
@@ -311,15 +421,8 @@ struct GraphSearchJob {
     if (topk == 0) {
       return;
     }
-    QueryScratchLease scratch(query_scratch_pool_.get(), topk);
-    auto *query_scratch = scratch.get();
-    if (query_scratch == nullptr) {
-      fill_invalid_ids(desc, 0, topk);
-      fill_invalid_distances(distances, 0, topk);
-      return;
-    }
 
-    auto &heap = query_scratch->rerank_heap_;
+    auto &heap = scratch.rerank_heap_;
     auto candidate_count = static_cast<uint32_t>(src.size());
     for (uint32_t i = 0; i < candidate_count; ++i) {
       RerankCandidate candidate{dist_compute(src.id(i)), src.id(i)};
@@ -360,7 +463,7 @@ struct GraphSearchJob {
     // init
     size_t degree_bound = RaBitQSpace<>::kDegreeBound;
     auto entry = sp->get_ep();
-    mem_prefetch_l1(sp->get_data_by_id(entry), 10);
+    mem_prefetch_l1(sp->get_chunk_by_id(entry), 10);
     auto q_computer = sp->get_query_computer(query);
 
     // sorted by estimated distance
@@ -395,11 +498,13 @@ struct GraphSearchJob {
         search_pool.insert(cand_nei, est_dist);
 
         auto next_id = search_pool.next_id();
-        mem_prefetch_l2(sp->get_data_by_id(next_id), 10);
+        mem_prefetch_l2(sp->get_chunk_by_id(next_id), 10);
       }
 
-      // implicit rerank
-      res_pool.insert(cur_node, q_computer.get_exact_qr_c_dist());
+      // implicit rerank; tombstoned nodes are routed through but never returned
+      if (!sp->is_deleted(cur_node)) {
+        res_pool.insert(cur_node, q_computer.get_exact_qr_c_dist());
+      }
     }
 
     if (!res_pool.is_full()) [[unlikely]] {
@@ -428,7 +533,7 @@ struct GraphSearchJob {
     // init
     size_t degree_bound = RaBitQSpace<>::kDegreeBound;
     auto entry = sp->get_ep();
-    mem_prefetch_l1(sp->get_data_by_id(entry), 10);
+    mem_prefetch_l1(sp->get_chunk_by_id(entry), 10);
     auto q_computer = sp->get_query_computer(query);
 
     // sorted by estimated distance
@@ -466,12 +571,14 @@ struct GraphSearchJob {
         // try insert, same node may be inserted multiple times with different estimated distances,
         // but only the smallest one will be popped and expanded
         search_pool.insert(cand_nei, est_dist);
-        mem_prefetch_l2(sp->get_data_by_id(search_pool.next_id()), 10);
+        mem_prefetch_l2(sp->get_chunk_by_id(search_pool.next_id()), 10);
         co_await std::suspend_always{};
       }
 
-      // implicit rerank
-      res_pool.insert(cur_node, q_computer.get_exact_qr_c_dist());
+      // implicit rerank; tombstoned nodes are routed through but never returned
+      if (!sp->is_deleted(cur_node)) {
+        res_pool.insert(cur_node, q_computer.get_exact_qr_c_dist());
+      }
     }
 
     if (!res_pool.is_full()) [[unlikely]] {
@@ -507,8 +614,10 @@ struct GraphSearchJob {
     auto *sp = space_.get();
     auto *gr = graph_.get();
 
-    auto query_computer = sp->get_query_computer(query);
-    LinearPool<DistanceType, IDType> pool(sp->get_data_num(), ef);
+    QueryScratchLease lease(query_scratch_pool_.get(), topk);
+    auto &scratch = *lease.get();
+    auto query_computer = make_query_computer(sp, query, scratch.query_buffer_);
+    auto &pool = scratch.search_pool(sp->get_data_num(), ef);
     gr->initialize_search(pool, query_computer);
 
     sp->prefetch_by_address(query);
@@ -519,29 +628,26 @@ struct GraphSearchJob {
       mem_prefetch_l1(gr->edges(u), gr->max_nbrs_ * sizeof(IDType) / 64);
       co_await std::suspend_always{};
 
-      for (uint32_t i = 0; i < gr->max_nbrs_; ++i) {
-        auto v = gr->at(u, i);
-
-        if (v == static_cast<IDType>(-1)) {
-          break;
-        }
-
-        if (pool.vis_.get(v)) {
-          continue;
-        }
-        pool.vis_.set(v);
-
-        sp->prefetch_by_id(v);
-        co_await std::suspend_always{};
-
-        auto cur_dist = query_computer(v);
-        pool.insert(v, cur_dist);
+      // Prefetch every unvisited neighbor, then yield once before scoring the whole list
+      auto count = collect_unvisited(gr, pool, u, scratch);
+      if (count == 0) {
+        continue;
       }
+      for (size_t i = 0; i < count; ++i) {
+        sp->prefetch_by_id(scratch.batch_ids_[i]);
+      }
+      co_await std::suspend_always{};
+
+      insert_neighbors(sp, query_computer, pool, scratch, count);
     }
 
     // Rerank if needed, otherwise directly copy topk
     if constexpr (kNeedsRerank) {
-      rerank(pool, ids, topk, build_space_->get_query_computer(query));
+      rerank(scratch,
+             pool,
+             ids,
+             topk,
+             make_query_computer(build_space_.get(), query, scratch.rerank_query_buffer_));
     } else {
       auto result_count = std::min<uint32_t>(static_cast<uint32_t>(pool.size()), topk);
       for (uint32_t i = 0; i < result_count; ++i) {
@@ -574,8 +680,10 @@ struct GraphSearchJob {
     auto *sp = space_.get();
     auto *gr = graph_.get();
 
-    auto query_computer = sp->get_query_computer(query);
-    LinearPool<DistanceType, IDType> pool(sp->get_data_num(), ef);
+    QueryScratchLease lease(query_scratch_pool_.get(), topk);
+    auto &scratch = *lease.get();
+    auto query_computer = make_query_computer(sp, query, scratch.query_buffer_);
+    auto &pool = scratch.search_pool(sp->get_data_num(), ef);
     gr->initialize_search(pool, query_computer);
 
     sp->prefetch_by_address(query);
@@ -586,29 +694,27 @@ struct GraphSearchJob {
       mem_prefetch_l1(gr->edges(u), gr->max_nbrs_ * sizeof(IDType) / 64);
       co_await std::suspend_always{};
 
-      for (uint32_t i = 0; i < gr->max_nbrs_; ++i) {
-        auto v = gr->at(u, i);
-
-        if (v == static_cast<IDType>(-1)) {
-          break;
-        }
-
-        if (pool.vis_.get(v)) {
-          continue;
-        }
-        pool.vis_.set(v);
-
-        sp->prefetch_by_id(v);
-        co_await std::suspend_always{};
-
-        auto cur_dist = query_computer(v);
-        pool.insert(v, cur_dist);
+      // Prefetch every unvisited neighbor, then yield once before scoring the whole list
+      auto count = collect_unvisited(gr, pool, u, scratch);
+      if (count == 0) {
+        continue;
       }
+      for (size_t i = 0; i < count; ++i) {
+        sp->prefetch_by_id(scratch.batch_ids_[i]);
+      }
+      co_await std::suspend_always{};
+
+      insert_neighbors(sp, query_computer, pool, scratch, count);
     }
 
     // Rerank if needed, otherwise directly copy topk
     if constexpr (kNeedsRerank) {
-      rerank(pool, ids, distances, topk, build_space_->get_query_computer(query));
+      rerank(scratch,
+             pool,
+             ids,
+             distances,
+             topk,
+             make_query_computer(build_space_.get(), query, scratch.rerank_query_buffer_));
     } else {
       auto result_count = std::min<uint32_t>(static_cast<uint32_t>(pool.size()), topk);
       for (uint32_t i = 0; i < result_count; ++i) {
@@ -641,39 +747,25 @@ struct GraphSearchJob {
     auto *sp = space_.get();
     auto *gr = graph_.get();
 
-    auto query_computer = sp->get_query_computer(query);
-    LinearPool<DistanceType, IDType> pool(sp->get_data_num(), ef);
+    QueryScratchLease lease(query_scratch_pool_.get(), topk);
+    auto &scratch = *lease.get();
+    auto query_computer = make_query_computer(sp, query, scratch.query_buffer_);
+    auto &pool = scratch.search_pool(sp->get_data_num(), ef);
     gr->initialize_search(pool, query_computer);
 
     while (pool.has_next()) {
       auto u = pool.pop();
-      for (uint32_t i = 0; i < gr->max_nbrs_; ++i) {
-        auto v = gr->at(u, i);
-
-        if (v == static_cast<IDType>(-1)) {
-          break;
-        }
-
-        if (pool.vis_.get(v)) {
-          continue;
-        }
-        pool.vis_.set(v);
-
-        auto jump_prefetch = i + 3;
-        if (jump_prefetch < gr->max_nbrs_) {
-          auto prefetch_id = gr->at(u, jump_prefetch);
-          if (prefetch_id != static_cast<IDType>(-1)) {
-            sp->prefetch_by_id(prefetch_id);
-          }
-        }
-        auto cur_dist = query_computer(v);
-        pool.insert(v, cur_dist);
-      }
+      auto count = collect_unvisited(gr, pool, u, scratch);
+      insert_neighbors(sp, query_computer, pool, scratch, count);
     }
 
     // Rerank if needed, otherwise directly copy topk
     if constexpr (kNeedsRerank) {
-      rerank(pool, ids, topk, build_space_->get_query_computer(query));
+      rerank(scratch,
+             pool,
+             ids,
+             topk,
+             make_query_computer(build_space_.get(), query, scratch.rerank_query_buffer_));
     } else {
       auto result_count = std::min<uint32_t>(static_cast<uint32_t>(pool.size()), topk);
       for (uint32_t i = 0; i < result_count; ++i) {
@@ -707,39 +799,26 @@ struct GraphSearchJob {
     auto *sp = space_.get();
     auto *gr = graph_.get();
 
-    auto query_computer = sp->get_query_computer(query);
-    LinearPool<DistanceType, IDType> pool(sp->get_data_num(), ef);
+    QueryScratchLease lease(query_scratch_pool_.get(), topk);
+    auto &scratch = *lease.get();
+    auto query_computer = make_query_computer(sp, query, scratch.query_buffer_);
+    auto &pool = scratch.search_pool(sp->get_data_num(), ef);
     gr->initialize_search(pool, query_computer);
 
     while (pool.has_next()) {
       auto u = pool.pop();
-      for (uint32_t i = 0; i < gr->max_nbrs_; ++i) {
-        auto v = gr->at(u, i);
-
-        if (v == static_cast<IDType>(-1)) {
-          break;
-        }
-
-        if (pool.vis_.get(v)) {
-          continue;
-        }
-        pool.vis_.set(v);
-
-        auto jump_prefetch = i + 3;
-        if (jump_prefetch < gr->max_nbrs_) {
-          auto prefetch_id = gr->at(u, jump_prefetch);
-          if (prefetch_id != static_cast<IDType>(-1)) {
-            sp->prefetch_by_id(prefetch_id);
-          }
-        }
-        auto cur_dist = query_computer(v);
-        pool.insert(v, cur_dist);
-      }
+      auto count = collect_unvisited(gr, pool, u, scratch);
+      insert_neighbors(sp, query_computer, pool, scratch, count);
     }
 
     // Rerank if needed, otherwise directly copy topk
     if constexpr (kNeedsRerank) {
-      rerank(pool, ids, distances, topk, build_space_->get_query_computer(query));
+      rerank(scratch,
+             pool,
+             ids,
+             distances,
+             topk,
+             make_query_computer(build_space_.get(), query, scratch.rerank_query_buffer_));
     } else {
       auto result_count = std::min<uint32_t>(static_cast<uint32_t>(pool.size()), topk);
       for (uint32_t i = 0; i < result_count; ++i) {
@@ -757,8 +836,10 @@ struct GraphSearchJob {
 
     auto *sp = space_.get();
     auto *gr = graph_.get();
-    auto query_computer = sp->get_query_computer(query);
-    LinearPool<DistanceType, IDType> pool(sp->get_data_num(), ef);
+    QueryScratchLease lease(query_scratch_pool_.get(), topk);
+    auto &scratch = *lease.get();
+    auto query_computer = make_query_computer(sp, query, scratch.query_buffer_);
+    auto &pool = scratch.search_pool(sp->get_data_num(), ef);
     gr->initialize_search(pool, query_computer);
 
     while (pool.has_next()) {
@@ -774,28 +855,8 @@ struct GraphSearchJob {
         }
         continue;
       }
-      for (uint32_t i = 0; i < gr->max_nbrs_; ++i) {
-        auto v = gr->at(u, i);
-
-        if (v == static_cast<IDType>(-1)) {
-          break;
-        }
-
-        if (pool.vis_.get(v)) {
-          continue;
-        }
-        pool.vis_.set(v);
-
-        auto jump_prefetch = i + 3;
-        if (jump_prefetch < gr->max_nbrs_) {
-          auto prefetch_id = gr->at(u, jump_prefetch);
-          if (prefetch_id != static_cast<IDType>(-1)) {
-            sp->prefetch_by_id(prefetch_id);
-          }
-        }
-        auto cur_dist = query_computer(v);
-        pool.insert(v, cur_dist);
-      }
+      auto count = collect_unvisited(gr, pool, u, scratch);
+      insert_neighbors(sp, query_computer, pool, scratch, count);
     }
     auto result_count = std::min<uint32_t>(static_cast<uint32_t>(pool.size()), topk);
     for (uint32_t i = 0; i < result_count; ++i) {
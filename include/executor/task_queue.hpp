@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <coroutine>
+#include <cstdint>
 #include <tuple>
 #include "concurrentqueue.h"  // NOLINT
 namespace alaya {
@@ -58,4 +60,112 @@ class TaskQueue {
   moodycamel::ConcurrentQueue<std::coroutine_handle<>>
       queue_;  ///< A concurrent queue that holds coroutine handles.
 };
+
+/**
+ * @brief A bounded Chase-Lev work-stealing deque of coroutine handles.
+ *
+ * Exactly one thread (the owning worker) calls `push` and `pop`, which work on the bottom end in
+ * LIFO order so the most recently resumed coroutine runs next while its data is still in cache.
+ * Any other thread may call `steal`, which takes the oldest entry from the top end. Neither side
+ * takes a lock; the owner and the thieves only race (through a CAS on `top_`) for the last entry.
+ *
+ * The capacity is fixed: `push` returns false when the deque is full and the caller falls back to
+ * the shared TaskQueue instead of growing the buffer.
+ */
+class WorkStealingDeque {
+ public:
+  static constexpr int64_t kCapacity = 1024;  ///< Power of two, so indices wrap with a mask.
+
+  WorkStealingDeque() {
+    for (auto &slot : buffer_) {
+      slot.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Pushes a handle onto the bottom end. Owner thread only.
+   *
+   * @param item The coroutine handle to enqueue.
+   * @return `false` if the deque is full and the handle was not enqueued.
+   */
+  auto push(std::coroutine_handle<> item) -> bool {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= kCapacity) {
+      return false;
+    }
+    buffer_[bottom & kMask].store(item.address(), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Pops the most recently pushed handle from the bottom end. Owner thread only.
+   *
+   * @param item Receives the handle on success.
+   * @return `true` if a handle was popped.
+   */
+  auto pop(std::coroutine_handle<> &item) -> bool {
+    auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return false;
+    }
+    auto *address = buffer_[bottom & kMask].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // Last entry: a thief may be taking it at the same time, whoever advances `top_` wins.
+      bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed);
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      if (!won) {
+        return false;
+      }
+    }
+    item = std::coroutine_handle<>::from_address(address);
+    return true;
+  }
+
+  /**
+   * @brief Steals the oldest handle from the top end. Safe from any thread.
+   *
+   * @param item Receives the handle on success.
+   * @return `true` if a handle was stolen; `false` if the deque was empty or another thread won
+   * the race for the entry.
+   */
+  auto steal(std::coroutine_handle<> &item) -> bool {
+    auto top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return false;
+    }
+    auto *address = buffer_[top & kMask].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    item = std::coroutine_handle<>::from_address(address);
+    return true;
+  }
+
+  /**
+   * @brief An approximate number of queued handles; exact only when no thread is racing.
+   */
+  auto size() const -> int64_t {
+    auto bottom = bottom_.load(std::memory_order_relaxed);
+    auto top = top_.load(std::memory_order_relaxed);
+    return bottom > top ? bottom - top : 0;
+  }
+
+ private:
+  static constexpr int64_t kMask = kCapacity - 1;
+
+  alignas(64) std::atomic<int64_t> top_{0};     ///< Next entry a thief takes.
+  alignas(64) std::atomic<int64_t> bottom_{0};  ///< Next free entry on the owner's end.
+  alignas(64) std::array<std::atomic<void *>, kCapacity> buffer_;  ///< Ring of handle addresses.
+};
 }  // namespace alaya
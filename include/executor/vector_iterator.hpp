@@ -182,7 +182,7 @@ class RaBitQVectorIterator final : public VectorIterator<IDType, DistanceType> {
         dim_(space_->get_dim()) {
     auto entry = space_->get_ep();
     search_pool_.insert(entry, std::numeric_limits<DistanceType>::max());
-    mem_prefetch_l1(space_->get_data_by_id(entry), 10);
+    mem_prefetch_l1(space_->get_chunk_by_id(entry), 10);
   }
 
   [[nodiscard]] auto has_next() -> bool override { return prepare_next(); }
@@ -248,10 +248,11 @@ class RaBitQVectorIterator final : public VectorIterator<IDType, DistanceType> {
         }
 
         search_pool_.insert(neighbor, estimated_distance);
-        mem_prefetch_l2(space->get_data_by_id(search_pool_.next_id()), 10);
+        mem_prefetch_l2(space->get_chunk_by_id(search_pool_.next_id()), 10);
       }
 
-      if (blocked_mask_ != nullptr && blocked_mask_->get(current_node)) {
+      if (space->is_deleted(current_node) ||
+          (blocked_mask_ != nullptr && blocked_mask_->get(current_node))) {
         continue;
       }
 
@@ -266,7 +267,7 @@ class RaBitQVectorIterator final : public VectorIterator<IDType, DistanceType> {
 
     while (supplement_cursor_ < supplement_candidates_.size()) {
       auto id = supplement_candidates_[supplement_cursor_++];
-      if (blocked_mask_ != nullptr && blocked_mask_->get(id)) {
+      if (space->is_deleted(id) || (blocked_mask_ != nullptr && blocked_mask_->get(id))) {
         continue;
       }
       pending_candidate_ =
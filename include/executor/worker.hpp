@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <coroutine>
 #include <cstddef>
@@ -20,6 +21,51 @@
 
 namespace alaya {
 
+inline constexpr uint32_t kDefaultInterleave = 4;  ///< Coroutines a worker keeps in flight.
+inline constexpr uint32_t kMaxInterleave = 64;     ///< Upper bound for a configured depth.
+
+class Worker;
+
+/**
+ * @brief The state shared by all workers of one Scheduler.
+ *
+ * Coroutines submitted from outside the workers enter through the lock-free `injection` queue;
+ * coroutines scheduled or resumed on a worker thread go to that worker's own WorkStealingDeque and
+ * reach the others only by stealing. Idle workers park on `wake_epoch` (a futex wait through
+ * std::atomic::wait) and are only woken when `sleepers` says somebody is parked.
+ */
+struct WorkerGroup {
+  TaskQueue injection;                      ///< Submissions from non-worker threads.
+  std::vector<Worker *> members;            ///< Steal victims, indexed by WorkerID.
+  std::atomic<size_t> total_task_cnt{0};    ///< Tasks scheduled so far.
+  std::atomic<size_t> total_finish_cnt{0};  ///< Tasks completed so far.
+  std::atomic_bool shutdown{false};         ///< Set once by Scheduler::join.
+  std::atomic<uint64_t> wake_epoch{0};      ///< Bumped to wake parked workers.
+  std::atomic<uint32_t> sleepers{0};        ///< Workers parked (or about to park) on the epoch.
+  std::atomic<uint32_t> interleave{kDefaultInterleave};  ///< Current interleave depth.
+
+  /**
+   * @brief Wakes parked workers after a push; skips the syscall when nobody is parked.
+   *
+   * The fence pairs with the one a worker issues after announcing itself in `sleepers`: either the
+   * pusher sees the sleeper, or the sleeper's final re-check sees the pushed handle.
+   *
+   * @param all Wake every parked worker (a batch was pushed) instead of one.
+   */
+  void wake(bool all = false) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+    wake_epoch.fetch_add(1, std::memory_order_release);
+    if (all) {
+      wake_epoch.notify_all();
+    } else {
+      wake_epoch.notify_one();
+    }
+  }
+};
+
 class Scheduler;
 class Worker : public std::enable_shared_from_this<Worker> {
   friend class Scheduler;
@@ -27,19 +73,10 @@ class Worker : public std::enable_shared_from_this<Worker> {
  public:
   Worker() = default;  // Designed for running on current cpu
 
-  Worker(WorkerID worker_id,
-         CpuID cpu_id,
-         TaskQueue *task_queue,
-         std::atomic<size_t> *total_task_cnt,
-         std::atomic<size_t> *total_finish_cnt,
-         uint32_t local_task_cnt = 4)
-      : id_(worker_id),
-        cpu_id_(cpu_id),
-        task_queue_(task_queue),
-        local_task_cnt_(local_task_cnt),
-        local_tasks_(std::vector<std::coroutine_handle<>>(local_task_cnt)),
-        total_task_cnt_(total_task_cnt),
-        total_finish_cnt_(total_finish_cnt) {}
+  Worker(WorkerID worker_id, CpuID cpu_id, WorkerGroup *group, bool pin_to_cpu = false)
+      : id_(worker_id), cpu_id_(cpu_id), pin_to_cpu_(pin_to_cpu), group_(group) {
+    local_tasks_.reserve(kMaxInterleave);
+  }
 
   /**
    * @brief Retrieves the unique identifier of the current Worker.
@@ -55,6 +92,14 @@ class Worker : public std::enable_shared_from_this<Worker> {
    */
   auto cpu_id() const -> CpuID { return cpu_id_; }
 
+  /**
+   * @brief The Worker running on the calling thread, or nullptr off the worker threads.
+   */
+  static auto current() -> Worker *& {
+    static thread_local Worker *worker = nullptr;
+    return worker;
+  }
+
   /**
    * @brief Starts the Worker thread.
    *
@@ -85,42 +130,59 @@ class Worker : public std::enable_shared_from_this<Worker> {
 
  protected:
   /**
-   * @brief Executes tasks (coroutines) in a round-robin manner until all tasks are completed.
+   * @brief Executes tasks (coroutines) in a round-robin manner until the scheduler shuts down.
    *
-   * This function repeatedly selects and resumes tasks from the task queue, handling tasks
-   * on a round-robin basis across the available local tasks. It continues processing until
-   * all tasks have been completed.
+   * The worker keeps up to `interleave` coroutines in flight and resumes them round-robin, so one
+   * coroutine's prefetches overlap the others' compute. Free slots are refilled from the worker's
+   * own deque first, then from the shared injection queue; a worker with nothing in flight also
+   * steals from its peers.
    *
-   * @note The function relies on a `local_task_cnt_` counter to determine how many tasks
-   * are available for processing. The `task_queue_` is used to pop tasks, and tasks are resumed
-   * when selected. The function terminates when all tasks are completed, which is monitored
-   * using the `total_finish_cnt_` counter.
+   * A worker that finds no work anywhere parks on the group's wake epoch instead of spinning, and
+   * leaves the loop once the scheduler has shut down and nothing is left for it. A coroutine that
+   * reschedules itself (`co_await scheduler.schedule()`) from its slot simply stays there.
    */
   void run() {
-    // set_affinity();
-
-    uint32_t navigator = 0;
+    if (pin_to_cpu_) {
+      set_affinity();
+    }
+    current() = this;
 
+    size_t cursor = 0;
     while (true) {
-      uint32_t idx = navigator++ % local_task_cnt_;
-      auto &handle = local_tasks_[idx];
-
-      if (handle == nullptr) {
-        auto success = task_queue_->pop(handle);
-        if (!success) {
-          if (total_finish_cnt_->load() == total_task_cnt_->load()) {
-            break;
-          }
-          continue;
+      auto depth = std::clamp<uint32_t>(group_->interleave.load(std::memory_order_relaxed), 1,
+                                        kMaxInterleave);
+      while (local_tasks_.size() < depth) {
+        std::coroutine_handle<> handle;
+        if (!acquire(handle, local_tasks_.empty())) {
+          break;
         }
+        local_tasks_.push_back(handle);
       }
-      handle.resume();
-      if (handle.done()) {
-        handle = nullptr;
-        total_finish_cnt_->fetch_add(1);
+      if (local_tasks_.empty()) {
+        if (!park()) {
+          break;
+        }
+        continue;
+      }
+
+      if (cursor >= local_tasks_.size()) {
+        cursor = 0;
+      }
+      running_ = local_tasks_[cursor];
+      running_.resume();
+      if (running_.done()) {
+        local_tasks_[cursor] = local_tasks_.back();
+        local_tasks_.pop_back();
+        auto finished = group_->total_finish_cnt.fetch_add(1, std::memory_order_acq_rel) + 1;
+        if (finished == group_->total_task_cnt.load(std::memory_order_acquire)) {
+          group_->total_finish_cnt.notify_all();
+        }
       } else {
+        ++cursor;
       }
+      running_ = nullptr;
     }
+    current() = nullptr;
   }
 
   /**
@@ -136,7 +198,7 @@ class Worker : public std::enable_shared_from_this<Worker> {
   void run_on_current_cpu() {
     while (true) {
       std::coroutine_handle<> handle;
-      auto success = task_queue_->pop(handle);
+      auto success = group_->injection.pop(handle);
       if (!success) {
         break;
       }
@@ -145,6 +207,52 @@ class Worker : public std::enable_shared_from_this<Worker> {
   }
 
  private:
+  /**
+   * @brief Takes the next runnable coroutine: own deque (newest first), then the injection queue,
+   * then, if @p steal, the oldest entry of each peer's deque.
+   */
+  auto acquire(std::coroutine_handle<> &handle, bool steal) -> bool {
+    if (deque_.pop(handle) || group_->injection.pop(handle)) {
+      return true;
+    }
+    if (!steal) {
+      return false;
+    }
+    auto n = group_->members.size();
+    for (size_t k = 1; k < n; ++k) {
+      if (group_->members[(id_ + k) % n]->deque_.steal(handle)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Parks an idle worker until new work may exist.
+   *
+   * The worker announces itself in `sleepers` and reads the epoch before its last look for work,
+   * so a push that races with parking either is found by that look or bumps the epoch and makes
+   * the wait return at once.
+   *
+   * @return `false` when the scheduler has shut down and no work is left, i.e. the worker exits.
+   */
+  auto park() -> bool {
+    group_->sleepers.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto seen = group_->wake_epoch.load(std::memory_order_acquire);
+    std::coroutine_handle<> handle;
+    bool keep_running = true;
+    if (acquire(handle, true)) {
+      local_tasks_.push_back(handle);
+    } else if (group_->shutdown.load(std::memory_order_acquire)) {
+      keep_running = false;
+    } else {
+      group_->wake_epoch.wait(seen, std::memory_order_acquire);
+    }
+    group_->sleepers.fetch_sub(1, std::memory_order_relaxed);
+    return keep_running;
+  }
+
   /** @brief Sets the CPU affinity for the current thread.
    *
    * This function sets the CPU affinity for the current thread to the specified CPU ID.
@@ -170,23 +278,21 @@ class Worker : public std::enable_shared_from_this<Worker> {
   WorkerID id_{0};   ///< Worker identifier
   CpuID cpu_id_{0};  ///< CPU identifier, represents the CPU on which the worker operates.
 
+  bool pin_to_cpu_{false};  ///< Whether `run` binds the thread to `cpu_id_` before starting.
+
   bool active_{true};  ///< Flag indicating whether the worker is active.
 
   std::thread thread_;  ///< The thread associated with the worker.
 
-  TaskQueue *task_queue_;  ///< Pointer to the task queue. All workers share the same task queue.
+  WorkerGroup *group_{nullptr};  ///< Queues, counters and parking state shared with the peers.
 
-  uint32_t local_task_cnt_;  ////< The count of local tasks assigned to the worker.
+  WorkStealingDeque deque_;  ///< Coroutines scheduled or resumed on this worker's thread.
 
   std::vector<std::coroutine_handle<>>
-      local_tasks_;  ///< The mini-batch of tasks assigned to the worker. Each task is
-                     ///< represented by a coroutine handle.
-
-  std::atomic<size_t> *total_task_cnt_;  ///< Pointer to an atomic variable that tracks the
-                                         ///< total number of tasks across all workers.
-  std::atomic<size_t>
-      *total_finish_cnt_;  ///< Pointer to an atomic variable that tracks the number of tasks that
-                           ///< have been completed across all workers.
+      local_tasks_;  ///< The coroutines currently in flight on this worker, at most the
+                     ///< interleave depth.
+
+  std::coroutine_handle<> running_{nullptr};  ///< The coroutine being resumed right now.
 };
 
 }  // namespace alaya
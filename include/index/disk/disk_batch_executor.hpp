@@ -0,0 +1,228 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#include "index/disk/types.hpp"
+#include "utils/log.hpp"
+#include "utils/thread_config.hpp"
+
+namespace alaya::disk {
+
+// Per-worker merge buffers for DiskCollection search. Every vector only ever
+// grows, so once a worker has served a query of a given shape the next one
+// reuses the same storage instead of going back to the allocator.
+struct DiskSearchScratch {
+  struct Tagged {
+    DiskSearchHit hit;
+    uint32_t segment_index;
+    size_t rank;
+  };
+
+  // One slot per segment, so segment searches fanned out to several workers
+  // never share a buffer.
+  std::vector<std::vector<DiskSearchHit>> segment_hits;
+  std::vector<std::vector<Tagged>> segment_tagged;
+  // k-way merge state: a heap of segment indices keyed by each segment's
+  // current head, and the per-segment read cursor.
+  std::vector<uint32_t> merge_heap;
+  std::vector<size_t> merge_cursor;
+  std::vector<DiskSearchHit> out;
+
+  // Size every buffer for a query over `num_segments` segments up front, so a
+  // worker that happened to sit out earlier batches does not allocate later.
+  void reserve(size_t num_segments, size_t top_k) {
+    if (segment_hits.size() < num_segments) {
+      segment_hits.resize(num_segments);
+      segment_tagged.resize(num_segments);
+    }
+    for (size_t s = 0; s < num_segments; ++s) {
+      segment_hits[s].reserve(top_k);
+      segment_tagged[s].reserve(top_k);
+    }
+    merge_heap.reserve(num_segments);
+    merge_cursor.reserve(num_segments);
+    out.reserve(top_k);
+  }
+};
+
+namespace detail {
+
+// Fixed set of long-lived workers that DiskCollection::batch_search fans a
+// batch out to. A run is published by bumping `generation_`; workers park on
+// a condition variable between runs, so a batch costs two wakeups per worker
+// rather than a thread spawn and join. The calling thread acts as worker 0,
+// which keeps one-worker-per-query batches on the caller's core.
+//
+// Dispatch goes through a plain function pointer plus context pointer so that
+// publishing a run never allocates (no std::function / packaged_task).
+class DiskBatchExecutor {
+ public:
+  DiskBatchExecutor(uint32_t num_workers, bool pin_to_cores)
+      : num_workers_(num_workers == 0 ? 1U : num_workers),
+        pin_to_cores_(pin_to_cores),
+        scratch_(num_workers_) {
+    threads_.reserve(num_workers_ - 1);
+    for (uint32_t w = 1; w < num_workers_; ++w) {
+      threads_.emplace_back([this, w]() {
+        worker_loop(w);
+      });
+    }
+  }
+
+  DiskBatchExecutor(const DiskBatchExecutor &) = delete;
+  auto operator=(const DiskBatchExecutor &) -> DiskBatchExecutor & = delete;
+  DiskBatchExecutor(DiskBatchExecutor &&) = delete;
+  auto operator=(DiskBatchExecutor &&) -> DiskBatchExecutor & = delete;
+
+  ~DiskBatchExecutor() {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (auto &t : threads_) {
+      t.join();
+    }
+  }
+
+  auto size() const -> uint32_t { return num_workers_; }
+  auto pinned() const -> bool { return pin_to_cores_; }
+  auto scratch(uint32_t worker) -> DiskSearchScratch & { return scratch_[worker]; }
+
+  // Invoke `fn(worker_index)` on workers [0, active) and block until every one
+  // has returned. Worker 0 is the calling thread. The first exception thrown
+  // by any worker is rethrown here after the run has fully drained.
+  template <typename Fn>
+  void run(uint32_t active, Fn &fn) {
+    active = active == 0 ? 1U : (active > num_workers_ ? num_workers_ : active);
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      job_ctx_ = &fn;
+      job_invoke_ = [](void *ctx, uint32_t worker) {
+        (*static_cast<Fn *>(ctx))(worker);
+      };
+      active_ = active;
+      outstanding_ = active - 1;
+      first_error_ = nullptr;
+      ++generation_;
+    }
+    if (active > 1) {
+      start_cv_.notify_all();
+    }
+
+    invoke(0);
+
+    std::unique_lock<std::mutex> lk(mutex_);
+    done_cv_.wait(lk, [this]() {
+      return outstanding_ == 0;
+    });
+    job_ctx_ = nullptr;
+    job_invoke_ = nullptr;
+    if (first_error_) {
+      auto err = first_error_;
+      first_error_ = nullptr;
+      std::rethrow_exception(err);
+    }
+  }
+
+ private:
+  void invoke(uint32_t worker) {
+    try {
+      job_invoke_(job_ctx_, worker);
+    } catch (...) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      if (!first_error_) {
+        first_error_ = std::current_exception();
+      }
+    }
+  }
+
+  void worker_loop(uint32_t worker) {
+    if (pin_to_cores_) {
+      pin_current_thread(worker);
+    }
+    uint64_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lk(mutex_);
+        start_cv_.wait(lk, [&]() {
+          return stop_ || generation_ != seen;
+        });
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+        if (worker >= active_) {
+          continue;
+        }
+      }
+      invoke(worker);
+      {
+        std::lock_guard<std::mutex> lk(mutex_);
+        --outstanding_;
+        if (outstanding_ == 0) {
+          done_cv_.notify_one();
+        }
+      }
+    }
+  }
+
+  // Best-effort: containers frequently restrict the cpuset, so a failed pin
+  // is logged and the worker keeps running unpinned.
+  static void pin_current_thread(uint32_t worker) {
+#if defined(__linux__)
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(worker % ::alaya::system_thread_count(), &cpuset);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0) {
+      LOG_WARN("DiskBatchExecutor: pthread_setaffinity_np failed for worker {}", worker);
+    }
+#else
+    (void)worker;
+#endif
+  }
+
+  const uint32_t num_workers_;
+  const bool pin_to_cores_;
+  std::vector<DiskSearchScratch> scratch_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  bool stop_ = false;
+  uint64_t generation_ = 0;
+  uint32_t active_ = 0;
+  uint32_t outstanding_ = 0;
+  void *job_ctx_ = nullptr;
+  void (*job_invoke_)(void *, uint32_t) = nullptr;
+  std::exception_ptr first_error_{nullptr};
+};
+
+// Owns the collection's executor. Boxed by DiskCollection so the collection
+// stays movable; `mutex` serializes batches onto the shared workers.
+struct DiskBatchExecutorSlot {
+  std::mutex mutex;
+  std::unique_ptr<DiskBatchExecutor> executor;
+  bool pin_to_cores = false;
+  uint64_t builds = 0;
+};
+
+}  // namespace detail
+}  // namespace alaya::disk
@@ -10,12 +10,14 @@
 #include <chrono>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstring>
 #include <exception>
 #include <filesystem>  // NOLINT(build/c++17)
+#include <functional>
 #include <limits>
 #include <memory>
 #include <mutex>
@@ -23,6 +25,7 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_set>
 #include <utility>
@@ -41,8 +44,13 @@
   #include <unistd.h>
 #endif
 
+#include "index/disk/disk_batch_executor.hpp"
+#include "index/disk/disk_memtable.hpp"
+#include "index/disk/segment_compaction.hpp"
 #include "index/disk/segment_factory.hpp"
+#include "index/disk/segment_label_index.hpp"
 #include "index/disk/segment_manifest.hpp"
+#include "index/disk/segment_tombstones.hpp"
 #include "index/disk/types.hpp"
 #include "storage/mmap_file.hpp"
 #include "utils/log.hpp"
@@ -623,8 +631,9 @@ inline auto validate_vamana_params(const VamanaSegmentBuildParams &params,
 inline auto validate_vamana_manifest_config(const CollectionManifest &manifest,
                                             const VamanaSegmentBuildParams &params,
                                             const std::string &context) -> void {
-  if (manifest.metric != MetricType::L2) {
-    throw std::runtime_error(context + ": metric must be L2 for disk_vamana");
+  if (manifest.metric != MetricType::L2 && manifest.metric != MetricType::IP &&
+      manifest.metric != MetricType::COS) {
+    throw std::runtime_error(context + ": metric must be L2, IP or COS for disk_vamana");
   }
   validate_vamana_params(params, context);
 }
@@ -654,18 +663,143 @@ inline auto load_max_pending_bytes_from_manifest(const CollectionManifest &manif
   return static_cast<size_t>(value);
 }
 
-inline auto disk_search_distance_less(float a, float b) -> bool {
-  const bool a_nan = std::isnan(a);
-  const bool b_nan = std::isnan(b);
-  if (a_nan || b_nan) {
-    return !a_nan && b_nan;
+// Immutable list of published segments. `dirs` is kept in lockstep with
+// `searchers`, and `label_index` maps every published label to its segment
+// position and row, so looking a label up is one binary search per label
+// tier that never touches an ids file and never depends on the runtime type
+// of the searcher.
+// `memtable` holds the pending (not yet flushed) rows, or is null when there
+// are none; it is searched as one extra source after the segments. Readers
+// pin one set for a whole query; writers publish a replacement.
+struct SegmentSet {
+  std::vector<std::shared_ptr<SegmentSearcher>> searchers;
+  std::vector<std::filesystem::path> dirs;
+  std::shared_ptr<const CollectionLabelIndex> label_index = CollectionLabelIndex::build({}, {});
+  std::shared_ptr<const DiskMemtable> memtable;
+
+  auto source_count() const -> size_t { return searchers.size() + (memtable != nullptr ? 1 : 0); }
+  auto source(size_t i) const -> const SegmentSearcher & {
+    if (i < searchers.size()) {
+      return *searchers[i];
+    }
+    return *memtable;
   }
-  return a < b;
-}
+};
 
-inline auto disk_search_distance_equal_for_order(float a, float b) -> bool {
-  return (std::isnan(a) && std::isnan(b)) || a == b;
-}
+// A compacted-away segment. Its directory is removed once the last reader
+// that pinned it has dropped its reference.
+struct RetiredSegment {
+  std::weak_ptr<SegmentSearcher> searcher;
+  std::filesystem::path dir;
+};
+
+// Writer-side synchronization, boxed so DiskCollection stays movable.
+struct CollectionSyncState {
+  // Lock order: flush / compaction, then writer, then deletes, then
+  // publish, then snapshot. add_batch takes only `publish` and mark_deleted
+  // only `deletes` and, for pending rows, `publish`, so neither waits for a
+  // segment build.
+  std::mutex writer;      // manifest_, id reservation, flush / import / compaction commit
+  std::mutex deletes;     // tombstone bit writes and their persistence
+  std::mutex publish;     // every read-copy-publish of segments_, and pending_labels
+  std::mutex snapshot;    // the segments_ pointer swap
+  std::mutex flush;       // one flush at a time
+  std::mutex compaction;  // one compaction round at a time
+  std::vector<RetiredSegment> retired;  // guarded by `writer`
+  // Labels of the rows in segments_->memtable, guarded by `publish`.
+  std::unordered_set<uint64_t> pending_labels;
+};
+
+// Periodic background thread that runs compaction rounds. Moving a collection
+// stops its compactor first: the thread is bound to the collection's address,
+// so this member is declared first and is therefore moved before any state the
+// thread touches.
+class BackgroundCompactor {
+ public:
+  BackgroundCompactor() = default;
+  BackgroundCompactor(const BackgroundCompactor &) = delete;
+  auto operator=(const BackgroundCompactor &) -> BackgroundCompactor & = delete;
+  BackgroundCompactor(BackgroundCompactor &&other) noexcept { other.stop(); }
+  auto operator=(BackgroundCompactor &&other) noexcept -> BackgroundCompactor & {
+    stop();
+    other.stop();
+    return *this;
+  }
+  ~BackgroundCompactor() { stop(); }
+
+  // `round()` runs one compaction round and returns true if it merged
+  // something, in which case it is called again straight away.
+  void start(std::chrono::milliseconds interval, std::function<bool()> round) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (thread_.joinable()) {
+      throw std::runtime_error("DiskCollection: background compaction is already running");
+    }
+    stop_ = false;
+    wake_ = false;
+    thread_ = std::thread([this, interval, round = std::move(round)]() {
+      loop(interval, round);
+    });
+  }
+
+  void wake() {
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      wake_ = true;
+    }
+    cv_.notify_all();
+  }
+
+  void stop() {
+    std::thread joinable;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      stop_ = true;
+      joinable = std::move(thread_);
+    }
+    cv_.notify_all();
+    if (joinable.joinable()) {
+      joinable.join();
+    }
+  }
+
+  auto running() const -> bool {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return thread_.joinable();
+  }
+
+ private:
+  void loop(std::chrono::milliseconds interval, const std::function<bool()> &round) {
+    std::unique_lock<std::mutex> lk(mutex_);
+    while (!stop_) {
+      cv_.wait_for(lk, interval, [this]() {
+        return stop_ || wake_;
+      });
+      if (stop_) {
+        return;
+      }
+      wake_ = false;
+      lk.unlock();
+      try {
+        while (!stopping() && round()) {
+        }
+      } catch (const std::exception &e) {
+        LOG_WARN("DiskCollection: background compaction round failed: {}", e.what());
+      }
+      lk.lock();
+    }
+  }
+
+  auto stopping() -> bool {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return stop_;
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  bool wake_ = false;
+  std::thread thread_;
+};
 
 }  // namespace detail
 
@@ -750,6 +884,9 @@ class DiskCollection {
     manifest_.index_type = index_type;
     manifest_.next_segment_id = 1;
     manifest_.segment_ids.clear();
+    dim_ = dim;
+    metric_ = metric;
+    index_type_ = index_type;
     max_pending_bytes_ = max_pending_bytes;
     vamana_params_ = vamana_params;
     detail::store_max_pending_bytes_in_manifest(manifest_, max_pending_bytes_);
@@ -802,6 +939,9 @@ class DiskCollection {
     // Same v1 capability gate as the constructor; delegated to the factory so
     // the dual-substring message contract has a single source of truth.
     assert_engine_supported_v1(col.manifest_.index_type);
+    col.dim_ = static_cast<uint32_t>(col.manifest_.dim);
+    col.metric_ = col.manifest_.metric;
+    col.index_type_ = col.manifest_.index_type;
     col.max_pending_bytes_ =
         detail::load_max_pending_bytes_from_manifest(col.manifest_, kDefaultMaxPendingBytes);
     if (col.manifest_.index_type == DiskIndexType::Vamana) {
@@ -810,6 +950,7 @@ class DiskCollection {
                                               col.vamana_params_,
                                               "DiskCollection::open");
     }
+    col.reclaim_retired_on_open();
     col.open_listed_segments();
     col.scan_orphans();
     return col;
@@ -819,10 +960,23 @@ class DiskCollection {
   auto operator=(const DiskCollection &) -> DiskCollection & = delete;
   DiskCollection(DiskCollection &&) = default;
   auto operator=(DiskCollection &&) -> DiskCollection & = default;
-  ~DiskCollection() = default;
+  ~DiskCollection() {
+    compactor_.stop();
+    if (!sync_) {
+      return;  // moved-from
+    }
+    // Drop our own pin so retired segments that no reader still holds are
+    // removed now rather than on the next open.
+    std::lock_guard<std::mutex> lk(sync_->writer);
+    {
+      std::lock_guard<std::mutex> publish(sync_->publish);
+      publish_segments(std::make_shared<const detail::SegmentSet>());
+    }
+    reclaim_retired_segments_locked();
+  }
 
   void add_batch(const float *vectors, const uint64_t *labels, uint64_t n) {
-    if (manifest_.index_type == DiskIndexType::Laser) {
+    if (index_type_ == DiskIndexType::Laser) {
       throw std::runtime_error(
           "DiskCollection: disk_laser add_batch not implemented in v1; use "
           "import_laser_segment");
@@ -833,8 +987,7 @@ class DiskCollection {
     if (vectors == nullptr || labels == nullptr) {
       throw std::invalid_argument("DiskCollection: add_batch with n>0 requires non-null buffers");
     }
-    const uint64_t per_row =
-        static_cast<uint64_t>(manifest_.dim) * sizeof(float) + sizeof(uint64_t);
+    const uint64_t per_row = static_cast<uint64_t>(dim_) * sizeof(float) + sizeof(uint64_t);
     const uint64_t cap = max_pending_bytes_;
 
     // Check n * per_row * 2 for overflow before any cap comparison. Without
@@ -843,7 +996,7 @@ class DiskCollection {
     if (alaya_mul_overflow(uint64_t{2}, n, &single_batch_bytes) ||
         alaya_mul_overflow(single_batch_bytes, per_row, &single_batch_bytes)) {
       throw std::runtime_error("DiskCollection: pending size arithmetic overflows uint64 (n=" +
-                               std::to_string(n) + ", dim=" + std::to_string(manifest_.dim) + ")");
+                               std::to_string(n) + ", dim=" + std::to_string(dim_) + ")");
     }
     if (single_batch_bytes > cap) {
       throw std::runtime_error("DiskCollection: single batch (" +
@@ -851,8 +1004,13 @@ class DiskCollection {
                                " bytes) exceeds max_pending_bytes (" + std::to_string(cap) +
                                " bytes); split the batch or raise max_pending_bytes");
     }
+    throw_on_invalid_rows(vectors, n);
 
-    const uint64_t current_rows = pending_labels_.size();
+    // Only sync_->publish, never sync_->writer, so ingest does not queue
+    // behind a flush, import or compaction commit.
+    std::lock_guard<std::mutex> publish(sync_->publish);
+    const auto &memtable = segments_->memtable;
+    const uint64_t current_rows = memtable != nullptr ? memtable->size() : 0;
     const uint64_t current_total = 2ULL * current_rows * per_row;
     uint64_t total_rows = 0;
     uint64_t new_total = 0;
@@ -872,50 +1030,99 @@ class DiskCollection {
                                " bytes, addable_rows_under_dim=" + std::to_string(max_addable));
     }
 
-    // Strong exception safety: reserve both buffers BEFORE any insert. If
-    // reserve throws bad_alloc, no state has been mutated. After successful
-    // reserve, the inserts cannot allocate again so they can't throw.
-    pending_vectors_.reserve(pending_vectors_.size() + n * manifest_.dim);
-    pending_labels_.reserve(pending_labels_.size() + n);
-    pending_vectors_.insert(pending_vectors_.end(), vectors, vectors + n * manifest_.dim);
-    pending_labels_.insert(pending_labels_.end(), labels, labels + n);
+    // Pending rows are searchable, so a label may be added only while it has
+    // no live published row and no pending row; otherwise a query would see
+    // it twice until the flush. Deleted labels may be written again.
+    throw_on_live_duplicate(*segments_, labels, n);
+    auto &pending_labels = sync_->pending_labels;
+    uint64_t claimed = 0;
+    try {
+      for (; claimed < n; ++claimed) {
+        if (!pending_labels.insert(labels[claimed]).second) {
+          throw std::invalid_argument("DiskCollection: duplicate pending label: " +
+                                      std::to_string(labels[claimed]));
+        }
+      }
+      // Strong exception safety: the new memtable is built off to the side
+      // and only the pointer swap publishes it, so a throw leaves the pending
+      // rows and their labels untouched. Queries see the batch from the next
+      // snapshot on.
+      auto next = std::make_shared<detail::SegmentSet>(*segments_);
+      next->memtable = DiskMemtable::append(memtable, dim_, metric_, vectors, labels, n);
+      publish_segments(std::move(next));
+    } catch (...) {
+      for (uint64_t i = 0; i < claimed; ++i) {
+        pending_labels.erase(labels[i]);
+      }
+      throw;
+    }
+  }
+
+  // Live rows buffered by add_batch and not yet flushed. They are already
+  // visible to search() / batch_search(), but not counted by size().
+  auto pending_size() const -> uint64_t {
+    const auto memtable = segment_snapshot()->memtable;
+    return memtable != nullptr ? memtable->live_size() : 0;
   }
 
+  // Publish the rows pending at the time of the call as one new segment.
+  // The segment is built without holding sync_->writer or sync_->publish, so
+  // add_batch, search and deletes proceed throughout; rows added meanwhile
+  // stay pending for the next flush. Pending rows deleted before the build
+  // are left out, and those deleted during it are tombstoned in the new
+  // segment before it is published.
   void flush() {
-    if (pending_labels_.empty()) {
+    std::lock_guard<std::mutex> one_flush(sync_->flush);
+    // Only flush removes pending rows and flushes are serialized, so every
+    // later memtable starts with the chunks frozen here.
+    const auto memtable = segment_snapshot()->memtable;
+    if (memtable == nullptr) {
       return;
     }
-    // Within-batch label uniqueness.
-    std::unordered_set<uint64_t> pending_set;
-    pending_set.reserve(pending_labels_.size() * 2);
-    for (auto label : pending_labels_) {
-      auto [it, inserted] = pending_set.insert(label);
-      if (!inserted) {
-        throw std::invalid_argument("DiskCollection: duplicate label within pending batch: " +
-                                    std::to_string(label));
-      }
-    }
-    // Cross-segment uniqueness via engine-agnostic manifest.ids_file mmap —
-    // no dynamic_cast against any concrete SegmentSearcher subclass. Each
-    // existing segment is identified by its directory in segment_dirs_, kept
-    // in lockstep with segments_.
-    for (const auto &seg_dir : segment_dirs_) {
-      auto ids_view = detail::load_segment_ids_view(seg_dir);
-      const uint64_t *labels = ids_view.data();
-      const uint64_t cnt = ids_view.count;
-      for (uint64_t i = 0; i < cnt; ++i) {
-        if (pending_set.contains(labels[i])) {
-          throw std::invalid_argument("DiskCollection: duplicate label across segments: " +
-                                      std::to_string(labels[i]));
-        }
-      }
+    // add_batch already rejected labels that are pending or live elsewhere,
+    // so the rows go to the builder unchecked. The builders take contiguous
+    // rows; a single add_batch chunk with no deletes is used in place,
+    // anything else is gathered once. `copied` marks the frozen rows that go
+    // into the segment.
+    std::vector<float> gathered_vectors;
+    std::vector<uint64_t> gathered_labels;
+    std::vector<bool> copied;
+    const auto &front = *memtable->chunks().front();
+    const float *pending_vectors = front.vectors.data();
+    const uint64_t *pending_labels = front.labels.data();
+    uint64_t pending_count = memtable->size();
+    if (memtable->chunks().size() > 1 || front.deleted->any()) {
+      gathered_vectors.resize(pending_count * dim_);
+      gathered_labels.resize(pending_count);
+      pending_count =
+          memtable->copy_live_rows(gathered_vectors.data(), gathered_labels.data(), copied);
+      pending_vectors = gathered_vectors.data();
+      pending_labels = gathered_labels.data();
+    } else {
+      copied.assign(pending_count, true);
+    }
+    if (pending_count == 0) {
+      // Every frozen row was deleted: nothing to build, just retire them.
+      std::lock_guard<std::mutex> publish(sync_->publish);
+      auto next = std::make_shared<detail::SegmentSet>(*segments_);
+      next->memtable = DiskMemtable::drop_front(segments_->memtable, memtable->chunks().size());
+      publish_segments(std::move(next));
+      return;
     }
-
-    if (manifest_.index_type == DiskIndexType::Vamana && pending_labels_.size() < 2) {
+    if (pending_count < min_build_rows()) {
       throw std::runtime_error("DiskCollection: disk_vamana flush requires at least 2 rows");
     }
 
-    const uint64_t seg_id = manifest_.next_segment_id;
+    // Reserve the segment id. A build that fails leaves an orphan under this
+    // id for the next open to classify, and a retried flush uses a fresh one.
+    uint64_t seg_id = 0;
+    CollectionManifest build_manifest;
+    {
+      std::lock_guard<std::mutex> writer(sync_->writer);
+      seg_id = manifest_.next_segment_id;
+      manifest_.next_segment_id = seg_id + 1;
+      build_manifest = manifest_;
+    }
     const std::string seg_basename = detail::format_segment_id(seg_id);
     const auto seg_dir = path_ / "segments" / seg_basename;
 
@@ -925,34 +1132,62 @@ class DiskCollection {
     // the searcher, so a builder-side or open-side failure is reported from
     // a single throw site.
     auto searcher = create_segment_from_pending(seg_dir,
-                                                manifest_,
-                                                pending_vectors_.data(),
-                                                pending_labels_.data(),
-                                                pending_labels_.size(),
+                                                build_manifest,
+                                                pending_vectors,
+                                                pending_labels,
+                                                pending_count,
                                                 vamana_params_);
-    // Segment is now on disk. Any subsequent failure in this function leaves
-    // an orphan segment that will be classified as kind=complete on next open.
-    // Eagerly advance in-memory next_segment_id so a retried flush() uses a
-    // fresh id rather than colliding with the orphan.
-    manifest_.next_segment_id = seg_id + 1;
+    auto label_run = build_label_run(seg_dir);
 
-    // Atomic rename of the collection manifest. Once this returns, the segment
-    // is officially listed on disk. If this throws, segment is still orphan.
-    auto new_manifest = manifest_;
-    new_manifest.segment_ids.push_back(seg_basename);
-    new_manifest.next_segment_id = seg_id + 1;
-    detail::publish_collection_manifest_atomic_only(path_, new_manifest);
-
-    // From this point on, the on-disk state is consistent. Commit in-memory
-    // state atomically. Pending is cleared LAST so any throw above leaves it
-    // intact for the caller (the fsync below is best-effort, not load-bearing).
-    manifest_ = std::move(new_manifest);
-    segments_.push_back(std::move(searcher));
-    segment_dirs_.push_back(seg_dir);
-    pending_vectors_.clear();
-    pending_labels_.clear();
-    pending_vectors_.shrink_to_fit();
-    pending_labels_.shrink_to_fit();
+    {
+      std::lock_guard<std::mutex> writer(sync_->writer);
+      // Atomic rename of the collection manifest. Once this returns, the
+      // segment is officially listed on disk. If this throws, the segment is
+      // still an orphan.
+      auto new_manifest = manifest_;
+      new_manifest.segment_ids.push_back(seg_basename);
+      store_retired_in_manifest_locked(new_manifest);
+      // The segment list only changes under sync_->writer, so the index can
+      // be merged and written before sync_->publish holds up add_batch.
+      auto label_index =
+          persist_label_index(segments_->label_index->append(label_run, seg_id), new_manifest);
+
+      {
+        // sync_->publish is held across the manifest write so that the
+        // snapshot built here is exactly the one published after it. Pending
+        // deletes also take it, so the rows deleted since the copy above are
+        // final here.
+        std::lock_guard<std::mutex> publish(sync_->publish);
+        tombstone_rows_deleted_during_flush(*memtable, copied, *searcher, *label_run, seg_dir);
+        auto new_segments = std::make_shared<detail::SegmentSet>(*segments_);
+        new_segments->searchers.push_back(std::move(searcher));
+        new_segments->dirs.push_back(seg_dir);
+        new_segments->label_index = std::move(label_index);
+        new_segments->memtable =
+            DiskMemtable::drop_front(segments_->memtable, memtable->chunks().size());
+        detail::publish_collection_manifest_atomic_only(path_, new_manifest);
+
+        // From this point on, the on-disk state is consistent. Commit
+        // in-memory state atomically: the one snapshot swap moves the frozen
+        // rows from the memtable into the new segment, so no query sees them
+        // twice or not at all, and any throw above leaves them pending for
+        // the caller (the fsync below is best-effort, not load-bearing).
+        manifest_ = std::move(new_manifest);
+        // A deleted row's label left pending_labels when it was deleted and
+        // may since belong to a newer pending row.
+        for (const auto &chunk : memtable->chunks()) {
+          for (uint64_t i = 0; i < chunk->labels.size(); ++i) {
+            if (!chunk->deleted->is_deleted(i)) {
+              sync_->pending_labels.erase(chunk->labels[i]);
+            }
+          }
+        }
+        publish_segments(std::move(new_segments));
+      }
+      reclaim_retired_segments_locked();
+      remove_unlisted_label_tiers();
+    }
+    compactor_.wake();
 
     // Parent-dir fsync is a durability-only step. If it fails, the rename
     // already happened — in-memory state is correct, the only impact is that
@@ -968,7 +1203,7 @@ class DiskCollection {
   void import_laser_segment(const std::filesystem::path &src_dir,
                             const uint64_t *labels,
                             uint64_t n) {
-    if (manifest_.index_type != DiskIndexType::Laser) {
+    if (index_type_ != DiskIndexType::Laser) {
       throw std::runtime_error(
           "DiskCollection: import_laser_segment requires a disk_laser collection");
     }
@@ -980,6 +1215,7 @@ class DiskCollection {
           "DiskCollection: import_laser_segment with n>0 requires non-null labels");
     }
 
+    std::lock_guard<std::mutex> writer(sync_->writer);
     std::unordered_set<uint64_t> import_set;
     if (n <= static_cast<uint64_t>(std::numeric_limits<size_t>::max() / 2)) {
       import_set.reserve(static_cast<size_t>(n * 2));
@@ -993,17 +1229,7 @@ class DiskCollection {
       }
     }
 
-    for (const auto &seg_dir : segment_dirs_) {
-      auto ids_view = detail::load_segment_ids_view(seg_dir);
-      const uint64_t *existing = ids_view.data();
-      const uint64_t cnt = ids_view.count;
-      for (uint64_t i = 0; i < cnt; ++i) {
-        if (import_set.contains(existing[i])) {
-          throw std::invalid_argument("DiskCollection: duplicate label across segments: " +
-                                      std::to_string(existing[i]));
-        }
-      }
-    }
+    throw_on_live_duplicate(*segment_snapshot(), labels, n);
 
     const uint64_t seg_id = manifest_.next_segment_id;
     const std::string seg_basename = detail::format_segment_id(seg_id);
@@ -1011,19 +1237,29 @@ class DiskCollection {
 
     auto searcher = import_segment_from_artifacts(seg_dir, manifest_, src_dir, labels, n);
 
-    // Segment is now on disk. Match flush(): advance next_segment_id before
-    // manifest publication so a retry after manifest-publish failure uses a
-    // fresh id and leaves the published segment for orphan classification.
+    // Segment is now on disk. Advance next_segment_id before manifest
+    // publication so a retry after manifest-publish failure uses a fresh id
+    // and leaves the published segment for orphan classification.
     manifest_.next_segment_id = seg_id + 1;
 
     auto new_manifest = manifest_;
     new_manifest.segment_ids.push_back(seg_basename);
     new_manifest.next_segment_id = seg_id + 1;
-    detail::publish_collection_manifest_atomic_only(path_, new_manifest);
+    store_retired_in_manifest_locked(new_manifest);
+    auto label_index = persist_label_index(
+        segments_->label_index->append(build_label_run(seg_dir), seg_id), new_manifest);
+    {
+      std::lock_guard<std::mutex> publish(sync_->publish);
+      auto new_segments = std::make_shared<detail::SegmentSet>(*segments_);
+      new_segments->searchers.push_back(std::move(searcher));
+      new_segments->dirs.push_back(seg_dir);
+      new_segments->label_index = std::move(label_index);
+      detail::publish_collection_manifest_atomic_only(path_, new_manifest);
 
-    manifest_ = std::move(new_manifest);
-    segments_.push_back(std::move(searcher));
-    segment_dirs_.push_back(seg_dir);
+      manifest_ = std::move(new_manifest);
+      publish_segments(std::move(new_segments));
+    }
+    remove_unlisted_label_tiers();
 
     try {
       detail::fsync_dir(path_);
@@ -1038,71 +1274,16 @@ class DiskCollection {
     if (opts.top_k == 0) {
       throw std::invalid_argument("DiskCollection: top_k must be > 0");
     }
-    if (segments_.empty()) {
-      return {};
-    }
-
-    if (segments_.size() == 1) {
-      auto hits = segments_[0]->search(query, opts);
-      if (segments_[0]->type() == DiskIndexType::Laser) {
-        if (hits.size() > opts.top_k) {
-          hits.resize(opts.top_k);
-        }
-        return hits;
-      }
-      std::sort(hits.begin(), hits.end(), [](const DiskSearchHit &a, const DiskSearchHit &b) {
-        if (!detail::disk_search_distance_equal_for_order(a.distance, b.distance)) {
-          return detail::disk_search_distance_less(a.distance, b.distance);
-        }
-        return a.label < b.label;
-      });
-      if (hits.size() > opts.top_k) {
-        hits.resize(opts.top_k);
-      }
-      return hits;
+    if (opts.segment_parallelism == 0) {
+      throw std::invalid_argument("DiskCollection: segment_parallelism must be > 0");
     }
-
-    struct Tagged {
-      DiskSearchHit hit;
-      uint32_t segment_index;
-      size_t rank;
-    };
-
-    const bool preserve_laser_rank = segments_[0]->type() == DiskIndexType::Laser;
-    std::vector<Tagged> all;
-    all.reserve(segments_.size() * opts.top_k);
-    for (uint32_t s = 0; s < segments_.size(); ++s) {
-      auto seg_hits = segments_[s]->search(query, opts);
-      for (size_t rank = 0; rank < seg_hits.size(); ++rank) {
-        all.push_back(Tagged{seg_hits[rank], s, rank});
-      }
-    }
-    // LASER segment hits use NaN distances today; keep segment-local rank as the
-    // equal-distance tie-break so multi-segment search matches the single-segment
-    // raw engine ordering contract.
-    std::sort(all.begin(), all.end(), [preserve_laser_rank](const Tagged &a, const Tagged &b) {
-      if (!detail::disk_search_distance_equal_for_order(a.hit.distance, b.hit.distance)) {
-        return detail::disk_search_distance_less(a.hit.distance, b.hit.distance);
-      }
-      if (preserve_laser_rank) {
-        if (a.rank != b.rank) {
-          return a.rank < b.rank;
-        }
-        return a.segment_index < b.segment_index;
-      }
-      if (a.hit.label != b.hit.label) {
-        return a.hit.label < b.hit.label;
-      }
-      return a.segment_index < b.segment_index;
-    });
-
-    const size_t k = std::min<size_t>(opts.top_k, all.size());
-    std::vector<DiskSearchHit> out;
-    out.reserve(k);
-    for (size_t i = 0; i < k; ++i) {
-      out.push_back(all[i].hit);
+    const auto segments = segment_snapshot();
+    if (segments->source_count() == 0) {
+      return {};
     }
-    return out;
+    DiskSearchScratch scratch;
+    search_into_scratch(*segments, query, opts, scratch);
+    return std::move(scratch.out);
   }
 
   // Run `n_queries` searches against `queries` (row-major `(n_queries, dim)`
@@ -1133,6 +1314,9 @@ class DiskCollection {
           "DiskCollection::batch_search: num_threads must be > 0 (the Python "
           "adapter resolves num_threads = 0 before this entry)");
     }
+    if (opts.segment_parallelism == 0) {
+      throw std::invalid_argument("DiskCollection: segment_parallelism must be > 0");
+    }
     if (n_queries == 0) {
       return;
     }
@@ -1140,14 +1324,16 @@ class DiskCollection {
     // Empty collection: every per-query search() would return an empty hits
     // vector, leaving the caller-pre-filled UINT64_MAX / NaN sentinels in
     // place. Spec point 7 requires "no exception, no allocation"; returning
-    // here skips the worker-pool allocation and the std::thread spawns
-    // entirely, so the caller's sentinels are observed without us touching
-    // any heap or kernel.
-    if (segments_.empty()) {
+    // here skips building the batch executor entirely, so the caller's
+    // sentinels are observed without us touching any heap or kernel. The
+    // whole batch runs against this one snapshot, so a concurrent flush or
+    // compaction never mixes segment lists within a batch.
+    const auto segments = segment_snapshot();
+    if (segments->source_count() == 0) {
       return;
     }
 
-    const uint64_t dim = static_cast<uint64_t>(manifest_.dim);
+    const uint64_t dim = dim_;
     const uint32_t top_k = opts.top_k;
 
     // Caller pre-fills the output buffers with sentinels (UINT64_MAX /
@@ -1167,91 +1353,850 @@ class DiskCollection {
       }
     };
 
-    // num_threads == 1 runs on the calling thread and skips the std::thread
-    // spawn/join + atomic dispatch overhead. The spec requires the resulting
-    // out_labels / out_distances state to be byte-identical to the 1-worker
-    // multi-thread path; both write the same hits in query-index order.
-    if (num_threads == 1) {
-      for (uint64_t i = 0; i < n_queries; ++i) {
-        auto hits = search(queries + i * dim, opts);
-        write_to_output(i, hits);
-      }
-      return;
-    }
-
-    // Multi-thread: per-query parallelism. workers share an atomic counter
-    // that doles out query indices; each worker invokes the existing
-    // single-query search() path on its slice. We deliberately do NOT
-    // parallelize across segments inside a single search().
+    // Per-query parallelism on the collection's long-lived batch executor:
+    // workers share an atomic counter that doles out query indices and run
+    // the same search_into_scratch() as search() on their own scratch, so the
+    // output is byte-identical to a serial loop over search(). Each query may
+    // still fan its segments out (opts.segment_parallelism > 1) onto the
+    // separate segment executor; a worker that finds it busy with another
+    // query searches its segments serially instead of queueing. num_threads
+    // == 1 runs entirely on the calling thread (executor worker 0) without
+    // waking anyone.
     //
     // Clamp workers to n_queries: a worker that immediately observes
-    // fetch_add >= n_queries returns without doing useful work, so spawning
-    // more than n_queries threads is wasted thread-spawn cost.
+    // fetch_add >= n_queries returns without doing useful work.
     const uint32_t worker_count = static_cast<uint32_t>(std::min<uint64_t>(num_threads, n_queries));
     std::atomic<uint64_t> next_query{0};
     std::atomic<bool> aborted{false};
-    std::mutex error_mutex;
-    std::exception_ptr first_error{nullptr};
-
-    std::vector<std::thread> workers;
-    workers.reserve(worker_count);
-    for (uint32_t t = 0; t < worker_count; ++t) {
-      workers.emplace_back([&, this]() {
-        try {
-          while (!aborted.load(std::memory_order_relaxed)) {
-            const uint64_t i = next_query.fetch_add(1, std::memory_order_relaxed);
-            if (i >= n_queries) {
-              return;
-            }
-            auto hits = this->search(queries + i * dim, opts);
-            write_to_output(i, hits);
+
+    auto run_batch = [&](detail::DiskBatchExecutor &executor) {
+      auto work = [&](uint32_t worker) {
+        auto &scratch = executor.scratch(worker);
+        scratch.reserve(segments->source_count(), top_k);
+        while (!aborted.load(std::memory_order_relaxed)) {
+          const uint64_t i = next_query.fetch_add(1, std::memory_order_relaxed);
+          if (i >= n_queries) {
+            return;
           }
-        } catch (...) {
-          // Capture only the first exception; subsequent failures from
-          // sibling workers are intentionally discarded so the caller
-          // observes exactly one exception type matching the first
-          // failure (spec contract 8). Setting `aborted` lets sibling
-          // workers exit at the head of their next loop iteration.
-          std::lock_guard<std::mutex> lk(error_mutex);
-          if (!first_error) {
-            first_error = std::current_exception();
+          try {
+            search_into_scratch(*segments, queries + i * dim, opts, scratch);
+          } catch (...) {
+            // The executor rethrows only the first failure (spec contract
+            // 8); `aborted` lets sibling workers stop at their next query.
+            aborted.store(true, std::memory_order_relaxed);
+            throw;
           }
-          aborted.store(true, std::memory_order_relaxed);
+          write_to_output(i, scratch.out);
         }
-      });
+      };
+      executor.run(worker_count, work);
+    };
+
+    auto &slot = *batch_executor_;
+    std::unique_lock<std::mutex> lk(slot.mutex, std::try_to_lock);
+    if (!lk.owns_lock()) {
+      // Another batch owns the shared workers. Rather than queue behind it,
+      // run this one on a throwaway executor (the pre-pool cost model).
+      detail::DiskBatchExecutor executor(worker_count, /*pin_to_cores=*/false);
+      run_batch(executor);
+      return;
     }
-    for (auto &w : workers) {
-      w.join();
+    if (!slot.executor || slot.executor->size() < worker_count) {
+      slot.executor.reset();
+      slot.executor = std::make_unique<detail::DiskBatchExecutor>(worker_count, slot.pin_to_cores);
+      ++slot.builds;
     }
-    if (first_error) {
-      std::rethrow_exception(first_error);
+    run_batch(*slot.executor);
+  }
+
+  // Pin batch_search workers to cores (worker w → CPU w mod hardware
+  // threads). Takes effect on the next batch; the current pool is dropped.
+  void set_batch_search_core_pinning(bool pin_to_cores) {
+    std::lock_guard<std::mutex> lk(batch_executor_->mutex);
+    if (batch_executor_->pin_to_cores != pin_to_cores) {
+      batch_executor_->pin_to_cores = pin_to_cores;
+      batch_executor_->executor.reset();
     }
   }
 
-  // Returns the total number of FLUSHED rows. Pending rows are intentionally
-  // excluded — see spec scenario "size() excludes pending rows".
+  // Number of times the batch_search executor has been (re)built; test observer.
+  auto batch_executor_builds() const -> uint64_t {
+    std::lock_guard<std::mutex> lk(batch_executor_->mutex);
+    return batch_executor_->builds;
+  }
+
+  // Returns the total number of FLUSHED, non-deleted rows. Pending rows are
+  // intentionally excluded — see spec scenario "size() excludes pending rows".
   auto size() const -> uint64_t {
     uint64_t s = 0;
-    for (const auto &seg : segments_) {
-      s += seg->size();
+    for (const auto &seg : segment_snapshot()->searchers) {
+      const auto *deleted = seg->tombstones();
+      s += seg->size() - (deleted != nullptr ? deleted->count() : 0);
     }
     return s;
   }
 
-  auto dim() const -> uint32_t { return static_cast<uint32_t>(manifest_.dim); }
+  // Number of published segments.
+  auto segment_count() const -> size_t { return segment_snapshot()->searchers.size(); }
+
+  auto dim() const -> uint32_t { return dim_; }
+
+  // Run one compaction round: merge the smallest size tier (by live rows)
+  // that has at least policy.min_merge_segments segments — or, failing that,
+  // rewrite the segment with the most deleted rows past
+  // policy.max_deleted_ratio — into one new segment built by the collection's
+  // engine, then swap it in with a single manifest publish. Deleted rows are
+  // dropped. A pick left with fewer live rows than the engine builds from
+  // (one row of a disk_vamana segment) is merged with its smallest
+  // neighbour, or skipped when there is none. Returns false when nothing
+  // qualifies. The rebuild runs outside the writer lock, so searches,
+  // flushes and deletes proceed throughout; queries already running keep the
+  // segments they pinned, and the old directories are deleted once the last
+  // such query finishes. disk_laser segments carry no stored vectors and are
+  // never compacted.
+  auto compact(const CompactionPolicy &policy = CompactionPolicy{}) -> bool {
+    detail::validate_compaction_policy(policy);
+    std::lock_guard<std::mutex> round(sync_->compaction);
+
+    // Plan: pick victims and reserve a segment id.
+    std::shared_ptr<const detail::SegmentSet> base;
+    std::vector<uint32_t> picked;
+    CollectionManifest build_manifest;
+    uint64_t seg_id = 0;
+    if (index_type_ == DiskIndexType::Laser) {
+      return false;
+    }
+    {
+      // flush() and import reassign manifest_ under the writer lock, so every
+      // manifest field this round needs is read here or from build_manifest.
+      std::lock_guard<std::mutex> writer(sync_->writer);
+      reclaim_retired_segments_locked();
+      base = segment_snapshot();
+      std::vector<uint64_t> rows;
+      std::vector<uint64_t> deleted;
+      rows.reserve(base->searchers.size());
+      deleted.reserve(base->searchers.size());
+      for (const auto &seg : base->searchers) {
+        rows.push_back(seg->size());
+        deleted.push_back(seg->tombstones() != nullptr ? seg->tombstones()->count() : 0);
+      }
+      picked = detail::pick_compaction_segments(rows, deleted, policy, min_build_rows());
+      if (picked.empty()) {
+        return false;
+      }
+      seg_id = manifest_.next_segment_id;
+      manifest_.next_segment_id = seg_id + 1;
+      build_manifest = manifest_;
+    }
+
+    // Build: concatenate the victims' live rows in segment order and hand
+    // them to the same factory path flush() uses. `origin` remembers where
+    // each merged row came from so deletes that land mid-build carry over.
+    const std::string seg_basename = detail::format_segment_id(seg_id);
+    const auto seg_dir = path_ / "segments" / seg_basename;
+    std::shared_ptr<SegmentSearcher> merged;
+    std::shared_ptr<const SegmentLabelRun> merged_run;
+    std::vector<std::pair<uint32_t, uint64_t>> origin;
+    {
+      std::vector<uint64_t> labels;
+      const uint64_t dim = build_manifest.dim;
+      std::vector<float> vectors;
+      for (uint32_t v = 0; v < picked.size(); ++v) {
+        const auto &seg = base->searchers[picked[v]];
+        const auto *deleted = seg->tombstones();
+        const auto view = detail::load_segment_rows_view(base->dirs[picked[v]]);
+        for (uint64_t row = 0; row < view.count; ++row) {
+          if (deleted != nullptr && deleted->is_deleted(row)) {
+            continue;
+          }
+          const float *vec = view.vector_data() + row * dim;
+          vectors.insert(vectors.end(), vec, vec + dim);
+          labels.push_back(view.id_data()[row]);
+          origin.emplace_back(v, row);
+        }
+      }
+      if (!labels.empty() && labels.size() < min_build_rows()) {
+        // Deletes since planning left too few rows to build; the next round
+        // plans against the new tombstones and folds in a neighbour.
+        return false;
+      }
+      if (!labels.empty()) {
+        merged = create_segment_from_pending(seg_dir,
+                                             build_manifest,
+                                             vectors.data(),
+                                             labels.data(),
+                                             labels.size(),
+                                             vamana_params_);
+        merged_run = build_label_run(seg_dir);
+      }
+    }
+
+    // Commit: only compaction removes segments and rounds are serialized, so
+    // every victim is still published; flushes since planning only appended.
+    {
+      std::lock_guard<std::mutex> writer(sync_->writer);
+      std::vector<const SegmentSearcher *> victims;
+      victims.reserve(picked.size());
+      for (const auto idx : picked) {
+        victims.push_back(base->searchers[idx].get());
+      }
+      // The merged segment takes the place of the first victim. The segment
+      // list only changes under sync_->writer, so the label index is updated
+      // and written here rather than under sync_->publish.
+      std::vector<uint64_t> next_ids;
+      bool placed = false;
+      for (size_t i = 0; i < segments_->searchers.size(); ++i) {
+        const auto *seg = segments_->searchers[i].get();
+        if (std::find(victims.begin(), victims.end(), seg) == victims.end()) {
+          next_ids.push_back(segment_number(segments_->dirs[i]));
+        } else if (!placed) {
+          placed = true;
+          if (merged != nullptr) {
+            next_ids.push_back(seg_id);
+          }
+        }
+      }
+      auto new_manifest = manifest_;
+      auto label_index = persist_label_index(
+          segments_->label_index->with_segments(std::move(next_ids), merged_run, seg_id),
+          new_manifest);
+      // Held until the swap below, so a delete either lands on a victim
+      // before the carry-over or finds its row in the merged segment.
+      std::lock_guard<std::mutex> deletes(sync_->deletes);
+      if (merged != nullptr) {
+        carry_over_deletes_locked(victims, origin, *merged, seg_dir);
+      }
+      std::lock_guard<std::mutex> publish(sync_->publish);
+      auto next = std::make_shared<detail::SegmentSet>();
+      next->memtable = segments_->memtable;
+      next->label_index = std::move(label_index);
+      std::vector<detail::RetiredSegment> retiring;
+      for (size_t i = 0; i < segments_->searchers.size(); ++i) {
+        const auto &seg = segments_->searchers[i];
+        if (std::find(victims.begin(), victims.end(), seg.get()) == victims.end()) {
+          next->searchers.push_back(seg);
+          next->dirs.push_back(segments_->dirs[i]);
+          continue;
+        }
+        if (retiring.empty() && merged != nullptr) {
+          next->searchers.push_back(merged);
+          next->dirs.push_back(seg_dir);
+        }
+        retiring.push_back(detail::RetiredSegment{seg, segments_->dirs[i]});
+      }
 
-  // Tombstone API stubs (v1: not implemented).
-  static void mark_deleted(uint64_t /*label*/) {
-    throw std::runtime_error("DiskCollection: deletes not implemented in v1");
+      new_manifest.segment_ids.clear();
+      for (const auto &dir : next->dirs) {
+        new_manifest.segment_ids.push_back(dir.filename().string());
+      }
+      sync_->retired.insert(sync_->retired.end(), retiring.begin(), retiring.end());
+      store_retired_in_manifest_locked(new_manifest);
+      try {
+        detail::publish_collection_manifest_atomic_only(path_, new_manifest);
+      } catch (...) {
+        // The victims stay published; the merged segment is left as an
+        // orphan for the next open to classify, exactly like a failed flush.
+        sync_->retired.resize(sync_->retired.size() - retiring.size());
+        throw;
+      }
+      manifest_ = std::move(new_manifest);
+      publish_segments(std::move(next));
+    }
+    try {
+      detail::fsync_dir(path_);
+    } catch (const std::exception &e) {
+      LOG_WARN("DiskCollection: collection_manifest fsync_dir failed (durability only): {}",
+               e.what());
+    }
+
+    base.reset();
+    std::lock_guard<std::mutex> writer(sync_->writer);
+    reclaim_retired_segments_locked();
+    remove_unlisted_label_tiers();
+    return true;
+  }
+
+  // Run compaction rounds on a background thread every policy.interval (and
+  // right after each flush) until stop_background_compaction() or
+  // destruction. Round failures are logged and retried on the next tick.
+  void start_background_compaction(const CompactionPolicy &policy = CompactionPolicy{}) {
+    detail::validate_compaction_policy(policy);
+    if (index_type_ == DiskIndexType::Laser) {
+      throw std::runtime_error(
+          "DiskCollection: disk_laser segments have no stored vectors and cannot be compacted");
+    }
+    compactor_.start(policy.interval, [this, policy]() {
+      return compact(policy);
+    });
+  }
+
+  void stop_background_compaction() { compactor_.stop(); }
+
+  auto background_compaction_running() const -> bool { return compactor_.running(); }
+
+  // Retired segment directories still waiting for their last reader.
+  auto retired_segment_count() const -> size_t {
+    std::lock_guard<std::mutex> writer(sync_->writer);
+    return sync_->retired.size();
+  }
+
+  // Delete rows by label. Each affected segment's tombstone bitmap is updated
+  // in place (searches stop returning the row immediately) and persisted once
+  // per call. Pending rows are tombstoned in the memtable and never reach a
+  // segment. Labels that are unknown or already deleted are skipped. Returns
+  // the number of rows deleted. A deleted label may be added again.
+  auto mark_deleted(const uint64_t *labels, uint64_t n) -> uint64_t {
+    if (n > 0 && labels == nullptr) {
+      throw std::invalid_argument("DiskCollection: mark_deleted with n>0 requires non-null labels");
+    }
+    // Only sync_->deletes, never sync_->writer, so a delete does not queue
+    // behind a flush, import or compaction commit.
+    std::lock_guard<std::mutex> lk(sync_->deletes);
+    // Pending rows first: a flush may move them into a segment right after,
+    // but it tombstones them there, so the segment pass below cannot find
+    // them live again. Rows never move the other way.
+    uint64_t deleted = mark_pending_deleted(labels, n);
+    const auto set = segment_snapshot();
+    std::vector<bool> touched(set->searchers.size(), false);
+    for (uint64_t i = 0; i < n; ++i) {
+      const auto loc = find_live_label(*set, labels[i]);
+      if (!loc) {
+        continue;
+      }
+      const auto &seg = set->searchers[loc->first];
+      auto *tombstones = seg->tombstones();
+      if (tombstones == nullptr) {
+        throw std::runtime_error("DiskCollection: segment engine '" +
+                                 std::string(index_type_to_string(seg->type())) +
+                                 "' does not support deletes");
+      }
+      if (tombstones->set(loc->second)) {
+        ++deleted;
+        touched[loc->first] = true;
+      }
+    }
+    for (size_t s = 0; s < touched.size(); ++s) {
+      if (touched[s]) {
+        set->searchers[s]->tombstones()->save(set->dirs[s]);
+      }
+    }
+    if (deleted > 0) {
+      compactor_.wake();
+    }
+    return deleted;
+  }
+
+  auto mark_deleted(uint64_t label) -> bool { return mark_deleted(&label, 1) == 1; }
+
+  // True when `label` has a deleted row, pending or published and not yet
+  // compacted away, and no live row, pending or published.
+  // Lock-free: reads the label runs and word-atomic bitmaps of a snapshot.
+  auto is_deleted(uint64_t label) const -> bool {
+    const auto set = segment_snapshot();
+    bool deleted = false;
+    if (set->memtable != nullptr) {
+      const auto pending = set->memtable->label_state(label);
+      if (pending.has_value() && *pending) {
+        return false;
+      }
+      deleted = pending.has_value();
+    }
+    const auto live = set->label_index->find_if(label, [&](const LabelLocation &loc) {
+      deleted = true;
+      const auto *tombstones = set->searchers[loc.segment]->tombstones();
+      return tombstones == nullptr || !tombstones->is_deleted(loc.row);
+    });
+    return !live.has_value() && deleted;
   }
-  static auto is_deleted(uint64_t /*label*/) -> bool { return false; }
 
  private:
   DiskCollection() = default;
 
+  // Shared body of search() and batch_search(): runs every segment and leaves
+  // the merged top-k in `scratch.out`. All intermediate storage comes from
+  // `scratch`, so a reused scratch makes the merge allocation-free. Callers
+  // have already rejected top_k == 0 and the empty-collection case.
+  void search_into_scratch(const detail::SegmentSet &set,
+                           const float *query,
+                           const DiskSearchOptions &opts,
+                           DiskSearchScratch &scratch) const {
+    auto &out = scratch.out;
+    if (set.source_count() == 1) {
+      const auto &segment = set.source(0);
+      auto &hits = out;
+      segment.search_into(query, opts, hits);
+      if (segment.type() == DiskIndexType::Laser) {
+        if (hits.size() > opts.top_k) {
+          hits.resize(opts.top_k);
+        }
+        return;
+      }
+      std::sort(hits.begin(), hits.end(), [](const DiskSearchHit &a, const DiskSearchHit &b) {
+        if (!detail::disk_search_distance_equal_for_order(a.distance, b.distance)) {
+          return detail::disk_search_distance_less(a.distance, b.distance);
+        }
+        return a.label < b.label;
+      });
+      if (hits.size() > opts.top_k) {
+        hits.resize(opts.top_k);
+      }
+      return;
+    }
+
+    using Tagged = DiskSearchScratch::Tagged;
+
+    // LASER segment hits use NaN distances today; keep segment-local rank as the
+    // equal-distance tie-break so multi-segment search matches the single-segment
+    // raw engine ordering contract.
+    const bool preserve_laser_rank = set.source(0).type() == DiskIndexType::Laser;
+    const auto tagged_less = [preserve_laser_rank](const Tagged &a, const Tagged &b) {
+      if (!detail::disk_search_distance_equal_for_order(a.hit.distance, b.hit.distance)) {
+        return detail::disk_search_distance_less(a.hit.distance, b.hit.distance);
+      }
+      if (preserve_laser_rank) {
+        if (a.rank != b.rank) {
+          return a.rank < b.rank;
+        }
+        return a.segment_index < b.segment_index;
+      }
+      if (a.hit.label != b.hit.label) {
+        return a.hit.label < b.hit.label;
+      }
+      return a.segment_index < b.segment_index;
+    };
+
+    // The memtable, if any, is the last source and merges like a segment.
+    const auto num_segments = static_cast<uint32_t>(set.source_count());
+    scratch.reserve(num_segments, opts.top_k);
+
+    // Search one segment and leave its hits tagged and ordered under
+    // `tagged_less`, ready for the k-way merge. Engines mostly return sorted
+    // output already, so the O(k) check usually skips the sort.
+    const auto search_segment = [&](uint32_t s) {
+      auto &hits = scratch.segment_hits[s];
+      auto &tagged = scratch.segment_tagged[s];
+      set.source(s).search_into(query, opts, hits);
+      tagged.clear();
+      for (size_t rank = 0; rank < hits.size(); ++rank) {
+        tagged.push_back(Tagged{hits[rank], s, rank});
+      }
+      if (!std::is_sorted(tagged.begin(), tagged.end(), tagged_less)) {
+        std::sort(tagged.begin(), tagged.end(), tagged_less);
+      }
+    };
+
+    if (!fan_out_segments(num_segments, opts, search_segment)) {
+      for (uint32_t s = 0; s < num_segments; ++s) {
+        search_segment(s);
+      }
+    }
+
+    // k-way merge of the per-segment runs. Every Tagged key is unique up to
+    // identical hits (segment_index is the last tie-break), so popping heads in
+    // `tagged_less` order yields exactly the prefix a full sort would.
+    auto &heap = scratch.merge_heap;
+    auto &cursor = scratch.merge_cursor;
+    cursor.assign(num_segments, 0);
+    heap.clear();
+    const auto head_greater = [&](uint32_t a, uint32_t b) {
+      return tagged_less(scratch.segment_tagged[b][cursor[b]],
+                         scratch.segment_tagged[a][cursor[a]]);
+    };
+    for (uint32_t s = 0; s < num_segments; ++s) {
+      if (!scratch.segment_tagged[s].empty()) {
+        heap.push_back(s);
+      }
+    }
+    std::make_heap(heap.begin(), heap.end(), head_greater);
+
+    out.clear();
+    while (out.size() < opts.top_k && !heap.empty()) {
+      std::pop_heap(heap.begin(), heap.end(), head_greater);
+      const uint32_t s = heap.back();
+      out.push_back(scratch.segment_tagged[s][cursor[s]].hit);
+      if (++cursor[s] < scratch.segment_tagged[s].size()) {
+        std::push_heap(heap.begin(), heap.end(), head_greater);
+      } else {
+        heap.pop_back();
+      }
+    }
+  }
+
+  // Run `search_segment(s)` for every segment on the shared segment executor
+  // when opts.segment_parallelism asks for it. Returns false when the caller
+  // should search serially instead: parallelism 1, a single segment, or the
+  // executor already busy (e.g. a concurrent query) — queueing behind another
+  // query would cost more than the fan-out saves.
+  template <typename Fn>
+  auto fan_out_segments(uint32_t num_segments, const DiskSearchOptions &opts, Fn &search_segment)
+      const -> bool {
+    const uint32_t worker_count = std::min(opts.segment_parallelism, num_segments);
+    if (worker_count <= 1) {
+      return false;
+    }
+    auto &slot = *segment_executor_;
+    std::unique_lock<std::mutex> lk(slot.mutex, std::try_to_lock);
+    if (!lk.owns_lock()) {
+      return false;
+    }
+    if (!slot.executor || slot.executor->size() < worker_count) {
+      slot.executor.reset();
+      slot.executor = std::make_unique<detail::DiskBatchExecutor>(worker_count, slot.pin_to_cores);
+      ++slot.builds;
+    }
+    std::atomic<uint32_t> next_segment{0};
+    auto work = [&](uint32_t /*worker*/) {
+      for (uint32_t s = next_segment.fetch_add(1, std::memory_order_relaxed); s < num_segments;
+           s = next_segment.fetch_add(1, std::memory_order_relaxed)) {
+        search_segment(s);
+      }
+    };
+    slot.executor->run(worker_count, work);
+    return true;
+  }
+
+  auto segment_snapshot() const -> std::shared_ptr<const detail::SegmentSet> {
+    std::lock_guard<std::mutex> lk(sync_->snapshot);
+    return segments_;
+  }
+
+  void publish_segments(std::shared_ptr<const detail::SegmentSet> next) {
+    std::lock_guard<std::mutex> lk(sync_->snapshot);
+    segments_ = std::move(next);
+  }
+
+  // Delete every retired segment directory no reader still pins. Failures
+  // are logged and retried on the next pass. Caller holds sync_->writer.
+  void reclaim_retired_segments_locked() {
+    auto &retired = sync_->retired;
+    for (auto it = retired.begin(); it != retired.end();) {
+      if (!it->searcher.expired()) {
+        ++it;
+        continue;
+      }
+      std::error_code ec;
+      std::filesystem::remove_all(it->dir, ec);
+      if (ec) {
+        LOG_WARN("DiskCollection: failed to reclaim retired segment {}: {}",
+                 it->dir.string(),
+                 ec.message());
+        ++it;
+        continue;
+      }
+      it = retired.erase(it);
+    }
+  }
+
+  // Record still-unreclaimed segment dirs under x_retired_segments so a
+  // process that exits before reclaiming them deletes them on next open.
+  void store_retired_in_manifest_locked(CollectionManifest &manifest) const {
+    std::vector<std::string> names;
+    names.reserve(sync_->retired.size());
+    for (const auto &r : sync_->retired) {
+      names.push_back(r.dir.filename().string());
+    }
+    if (names.empty()) {
+      manifest.x_extras.erase("x_retired_segments");
+    } else {
+      manifest.x_extras["x_retired_segments"] = detail::join_segment_id_list(names);
+    }
+  }
+
+  // No reader can pin a segment of a collection that is being opened, so
+  // every directory a previous process retired can go straight away.
+  void reclaim_retired_on_open() {
+    const auto it = manifest_.x_extras.find("x_retired_segments");
+    if (it == manifest_.x_extras.end()) {
+      return;
+    }
+    for (const auto &id : detail::split_segment_id_list(it->second)) {
+      if (!detail::is_valid_segment_id(id)) {
+        LOG_WARN("DiskCollection: ignoring malformed x_retired_segments entry '{}'", id);
+        continue;
+      }
+      sync_->retired.push_back(detail::RetiredSegment{{}, path_ / "segments" / id});
+    }
+    reclaim_retired_segments_locked();
+  }
+
+  // (segment position, row) of `label`'s live row in `set`, if any. One
+  // binary search per label tier, O(log^2 N), then a tombstone check per
+  // segment that holds the label; no ids-file reads.
+  static auto find_live_label(const detail::SegmentSet &set, uint64_t label)
+      -> std::optional<std::pair<size_t, uint64_t>> {
+    const auto loc = set.label_index->find_if(label, [&set](const LabelLocation &l) {
+      const auto *tombstones = set.searchers[l.segment]->tombstones();
+      return tombstones == nullptr || !tombstones->is_deleted(l.row);
+    });
+    if (!loc.has_value()) {
+      return std::nullopt;
+    }
+    return std::make_pair(static_cast<size_t>(loc->segment), loc->row);
+  }
+
+  // Reject the rows a segment builder would refuse: non-finite components
+  // under every metric and zero-magnitude rows under COS. add_batch runs this
+  // before the rows reach the memtable, so a bad row never becomes pending
+  // and cannot wedge every later flush.
+  void throw_on_invalid_rows(const float *vectors, uint64_t n) const {
+    for (uint64_t r = 0; r < n; ++r) {
+      const float *row = vectors + r * dim_;
+      double sum_sq = 0.0;
+      for (uint32_t c = 0; c < dim_; ++c) {
+        if (!detail::is_finite_f32(row[c])) {
+          throw std::invalid_argument("DiskCollection: non-finite component at row " +
+                                      std::to_string(r) + " position " + std::to_string(c));
+        }
+        sum_sq += static_cast<double>(row[c]) * static_cast<double>(row[c]);
+      }
+      if (metric_ == MetricType::COS && sum_sq == 0.0) {
+        throw std::invalid_argument("DiskCollection: zero-magnitude vector under COS at row " +
+                                    std::to_string(r));
+      }
+    }
+  }
+
+  // Tombstone the pending rows among `labels` and free their labels for a
+  // later add_batch. Returns the number of rows deleted. Caller holds
+  // sync_->deletes.
+  auto mark_pending_deleted(const uint64_t *labels, uint64_t n) -> uint64_t {
+    std::lock_guard<std::mutex> publish(sync_->publish);
+    const auto &memtable = segments_->memtable;
+    auto &pending_labels = sync_->pending_labels;
+    if (memtable == nullptr) {
+      return 0;
+    }
+    std::unordered_set<uint64_t> wanted;
+    for (uint64_t i = 0; i < n; ++i) {
+      if (pending_labels.count(labels[i]) != 0) {
+        wanted.insert(labels[i]);
+      }
+    }
+    if (wanted.empty()) {
+      return 0;
+    }
+    std::vector<uint64_t> removed;
+    memtable->mark_deleted(wanted, removed);
+    for (const auto label : removed) {
+      pending_labels.erase(label);
+    }
+    return removed.size();
+  }
+
+  // Carry the deletes of frozen pending rows that landed after flush() copied
+  // them over to the freshly built, not yet listed segment, persisting its
+  // bitmap in `seg_dir`. Caller holds sync_->publish.
+  static void tombstone_rows_deleted_during_flush(const DiskMemtable &frozen,
+                                                  const std::vector<bool> &copied,
+                                                  SegmentSearcher &segment,
+                                                  const SegmentLabelRun &label_run,
+                                                  const std::filesystem::path &seg_dir) {
+    auto *tombstones = segment.tombstones();
+    bool any = false;
+    uint64_t pos = 0;
+    for (const auto &chunk : frozen.chunks()) {
+      for (uint64_t i = 0; i < chunk->labels.size(); ++i, ++pos) {
+        if (!copied[pos] || !chunk->deleted->is_deleted(i)) {
+          continue;
+        }
+        const auto row = label_run.find(chunk->labels[i]);
+        if (tombstones == nullptr || !row) {
+          throw std::runtime_error("DiskCollection: cannot tombstone pending label " +
+                                   std::to_string(chunk->labels[i]) +
+                                   " deleted during flush");
+        }
+        any = tombstones->set(*row) || any;
+      }
+    }
+    if (any) {
+      tombstones->save(seg_dir);
+    }
+  }
+
+  // Reject the first of `labels` that already has a live published row.
+  // Deleted rows are skipped so a deleted label can be written again.
+  static void throw_on_live_duplicate(const detail::SegmentSet &set,
+                                      const uint64_t *labels,
+                                      uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      if (find_live_label(set, labels[i])) {
+        throw std::invalid_argument("DiskCollection: duplicate label across segments: " +
+                                    std::to_string(labels[i]));
+      }
+    }
+  }
+
+  // Sort a freshly built segment's ids into its label run and persist it
+  // inside the segment directory before the segment is listed. Reads the
+  // ids file rather than trusting the input order, so every engine's row
+  // numbering is honoured.
+  static auto build_label_run(const std::filesystem::path &seg_dir)
+      -> std::shared_ptr<const SegmentLabelRun> {
+    const auto ids_view = detail::load_segment_ids_view(seg_dir);
+    auto run = SegmentLabelRun::from_labels(ids_view.data(), ids_view.count);
+    run->save(seg_dir);
+    return run;
+  }
+
+  // x_label_tiers names a merged tier file labels.tier_<seq>.bin as
+  // `tier_<seq>` and a segment's own label run by its segment id.
+  static constexpr const char *kLabelTierPrefix = "tier_";
+
+  // Fewest live rows the collection's engine builds a segment from:
+  // disk_vamana needs two, the other engines one.
+  auto min_build_rows() const -> uint64_t {
+    return index_type_ == DiskIndexType::Vamana ? 2 : 1;
+  }
+
+  // Numeric id of a segment directory named by format_segment_id.
+  static auto segment_number(const std::filesystem::path &seg_dir) -> uint64_t {
+    return std::stoull(seg_dir.filename().string().substr(4));
+  }
+
+  // Merge `index`'s tiers back into shape (CollectionLabelIndex::consolidate),
+  // writing any new tier file ahead of the manifest publish that makes it
+  // current, and record the tier list in `manifest`. A failed write is
+  // logged and the unmerged tiers kept: every one of them is already on disk.
+  auto persist_label_index(std::shared_ptr<const CollectionLabelIndex> index,
+                           CollectionManifest &manifest) const
+      -> std::shared_ptr<const CollectionLabelIndex> {
+    uint64_t next_tier =
+        std::max<uint64_t>(1, detail::parse_u64_extra(manifest, "x_next_label_tier", 1));
+    try {
+      index = index->consolidate(path_, next_tier);
+    } catch (const std::exception &e) {
+      LOG_WARN("DiskCollection: could not merge the collection label tiers: {}", e.what());
+    }
+    std::vector<std::string> names;
+    names.reserve(index->tiers().size());
+    for (const auto &tier : index->tiers()) {
+      const auto run_id = tier->segment_run_id();
+      names.push_back(run_id.has_value() ? detail::format_segment_id(*run_id)
+                                         : kLabelTierPrefix + std::to_string(tier->file_seq()));
+    }
+    manifest.x_extras["x_next_label_tier"] = std::to_string(next_tier);
+    if (names.empty()) {
+      manifest.x_extras.erase("x_label_tiers");
+    } else {
+      manifest.x_extras["x_label_tiers"] = detail::join_segment_id_list(names);
+    }
+    return index;
+  }
+
+  // The label index of the listed segments (`runs[i]` belongs to ids[i]),
+  // from the tiers the manifest lists. A tier file that is missing or does
+  // not match the segments is skipped with a warning; its segments fall back
+  // to their own runs until the next flush merges them again.
+  auto open_label_index(const std::vector<std::shared_ptr<const SegmentLabelRun>> &runs,
+                        std::vector<uint64_t> ids) const
+      -> std::shared_ptr<const CollectionLabelIndex> {
+    std::vector<std::shared_ptr<const LabelTier>> tiers;
+    const auto it = manifest_.x_extras.find("x_label_tiers");
+    if (it != manifest_.x_extras.end()) {
+      for (const auto &name : detail::split_segment_id_list(it->second)) {
+        if (detail::is_valid_segment_id(name)) {
+          const auto pos = std::find(ids.begin(), ids.end(), segment_number(name));
+          if (pos != ids.end()) {
+            tiers.push_back(LabelTier::of_segment(runs[pos - ids.begin()], *pos));
+          }
+          continue;
+        }
+        const auto seq = label_tier_seq(name);
+        auto tier = seq.has_value() ? LabelTier::load(path_, *seq) : nullptr;
+        if (tier == nullptr) {
+          LOG_WARN("DiskCollection: ignoring unreadable x_label_tiers entry '{}'", name);
+          continue;
+        }
+        tiers.push_back(std::move(tier));
+      }
+    }
+    return CollectionLabelIndex::assemble(std::move(tiers), runs, std::move(ids));
+  }
+
+  // Sequence number of a `tier_<seq>` entry of x_label_tiers.
+  static auto label_tier_seq(const std::string &name) -> std::optional<uint64_t> {
+    const std::string_view prefix = kLabelTierPrefix;
+    if (name.size() <= prefix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        !std::all_of(name.begin() + static_cast<std::ptrdiff_t>(prefix.size()),
+                     name.end(),
+                     [](char c) { return c >= '0' && c <= '9'; }) ||
+        name.size() - prefix.size() > 19) {
+      return std::nullopt;
+    }
+    return std::stoull(name.substr(prefix.size()));
+  }
+
+  // Delete label tier files the manifest no longer lists: tiers merged away
+  // by a later publish, or written by a flush that failed before its
+  // publish. A reader still mapping one keeps its inode; a removal that
+  // fails (a mapped file on Windows, a read-only copy) is retried next time.
+  void remove_unlisted_label_tiers() const {
+    std::vector<std::string> listed;
+    if (const auto it = manifest_.x_extras.find("x_label_tiers"); it != manifest_.x_extras.end()) {
+      for (const auto &name : detail::split_segment_id_list(it->second)) {
+        if (const auto seq = label_tier_seq(name)) {
+          listed.push_back(LabelTier::file_name(*seq));
+        }
+      }
+    }
+    std::error_code ec;
+    for (const auto &entry : std::filesystem::directory_iterator(path_, ec)) {
+      const auto name = entry.path().filename().string();
+      if (name.rfind("labels.tier_", 0) == 0 &&
+          std::find(listed.begin(), listed.end(), name) == listed.end()) {
+        std::error_code rm_ec;
+        std::filesystem::remove(entry.path(), rm_ec);
+      }
+    }
+  }
+
+  // Map a listed segment's label run. Segments written before the label
+  // index existed get one built from their ids file; persisting it is
+  // best-effort so a read-only copy of a collection still opens.
+  static auto open_label_run(const std::filesystem::path &seg_dir, uint64_t count)
+      -> std::shared_ptr<const SegmentLabelRun> {
+    if (auto run = SegmentLabelRun::load(seg_dir, count)) {
+      return run;
+    }
+    const auto ids_view = detail::load_segment_ids_view(seg_dir);
+    auto run = SegmentLabelRun::from_labels(ids_view.data(), ids_view.count);
+    try {
+      run->save(seg_dir);
+    } catch (const std::exception &e) {
+      LOG_WARN("DiskCollection: could not persist label index for {}: {}",
+               seg_dir.string(),
+               e.what());
+    }
+    return run;
+  }
+
+  // Rows deleted from a victim after the merge copied them are deleted in
+  // the merged segment too, before it becomes visible. Caller holds
+  // sync_->deletes.
+  void carry_over_deletes_locked(const std::vector<const SegmentSearcher *> &victims,
+                                 const std::vector<std::pair<uint32_t, uint64_t>> &origin,
+                                 const SegmentSearcher &merged,
+                                 const std::filesystem::path &merged_dir) {
+    auto *merged_tombstones = merged.tombstones();
+    bool any = false;
+    for (uint64_t i = 0; i < origin.size(); ++i) {
+      const auto *deleted = victims[origin[i].first]->tombstones();
+      if (deleted != nullptr && deleted->is_deleted(origin[i].second)) {
+        any = merged_tombstones->set(i) || any;
+      }
+    }
+    if (any) {
+      merged_tombstones->save(merged_dir);
+    }
+  }
+
   void open_listed_segments() {
-    segments_.reserve(manifest_.segment_ids.size());
-    segment_dirs_.reserve(manifest_.segment_ids.size());
+    auto set = std::make_shared<detail::SegmentSet>();
+    set->searchers.reserve(manifest_.segment_ids.size());
+    set->dirs.reserve(manifest_.segment_ids.size());
+    std::vector<std::shared_ptr<const SegmentLabelRun>> runs;
+    std::vector<uint64_t> ids;
+    uint64_t labels = 0;
     for (const auto &id : manifest_.segment_ids) {
       const auto seg_dir = path_ / "segments" / id;
       // Reject segment directories that are themselves symlinks: a
@@ -1263,9 +2208,15 @@ class DiskCollection {
                                  seg_dir.string());
       }
       auto searcher = load_segment_from_manifest(seg_dir);
-      segments_.push_back(std::move(searcher));
-      segment_dirs_.push_back(seg_dir);
-    }
+      runs.push_back(open_label_run(seg_dir, searcher->size()));
+      ids.push_back(segment_number(seg_dir));
+      labels += searcher->size();
+      set->searchers.push_back(std::move(searcher));
+      set->dirs.push_back(seg_dir);
+    }
+    set->label_index = open_label_index(runs, std::move(ids));
+    publish_segments(std::move(set));
+    remove_unlisted_label_tiers();
   }
 
   void scan_orphans() {
@@ -1289,8 +2240,13 @@ class DiskCollection {
       if (!detail::is_valid_segment_id(name)) {
         continue;
       }
-      if (listed.contains(name)) {
-        // Listed; track its id for next-id calculation.
+      const bool retired =
+          std::any_of(sync_->retired.begin(), sync_->retired.end(), [&](const auto &r) {
+            return r.dir.filename() == name;
+          });
+      if (listed.contains(name) || retired) {
+        // Listed (or retired and awaiting reclaim); track its id for next-id
+        // calculation.
         const uint64_t id = std::stoull(name.substr(4));
         max_on_disk = std::max(max_on_disk, id);
         continue;
@@ -1443,18 +2399,34 @@ class DiskCollection {
     LOG_WARN("DiskCollection: orphan segment at {} kind=complete", orphan_dir.string());
   }
 
+  // Declared first so a move stops the thread before any state it touches
+  // is moved out from under it.
+  detail::BackgroundCompactor compactor_;
   std::filesystem::path path_;
+  // Fixed at construction / open, so queries and add_batch read them without
+  // a lock. Everything else in manifest_ is read and replaced under
+  // sync_->writer.
+  uint32_t dim_ = 0;
+  MetricType metric_ = MetricType::L2;
+  DiskIndexType index_type_ = DiskIndexType::Flat;
   CollectionManifest manifest_;
-  std::vector<std::shared_ptr<SegmentSearcher>> segments_;
-  // Kept in lockstep with segments_ (same push order, same lifetime). Stored
-  // explicitly so cross-segment label inventory can resolve each segment's
-  // manifest.ids_file without depending on the runtime type of the searcher.
-  std::vector<std::filesystem::path> segment_dirs_;
-  std::vector<float> pending_vectors_;
-  std::vector<uint64_t> pending_labels_;
+  // Published segments. Read through segment_snapshot(); replaced (never
+  // mutated) under sync_->publish, whose holders may read it directly.
+  std::shared_ptr<const detail::SegmentSet> segments_ = std::make_shared<detail::SegmentSet>();
   size_t max_pending_bytes_ = kDefaultMaxPendingBytes;
   VamanaSegmentBuildParams vamana_params_{};
   detail::LockFd lock_fd_;
+  // Long-lived batch_search workers plus their scratch arenas. Boxed so the
+  // collection stays movable; created lazily on the first batch.
+  std::unique_ptr<detail::DiskBatchExecutorSlot> batch_executor_ =
+      std::make_unique<detail::DiskBatchExecutorSlot>();
+  // Workers for intra-query segment fan-out (opts.segment_parallelism > 1).
+  // Separate from batch_executor_ so a batch worker can fan out its own query
+  // without waiting on the pool it is running on.
+  std::unique_ptr<detail::DiskBatchExecutorSlot> segment_executor_ =
+      std::make_unique<detail::DiskBatchExecutorSlot>();
+  std::unique_ptr<detail::CollectionSyncState> sync_ =
+      std::make_unique<detail::CollectionSyncState>();
 };
 
 }  // namespace alaya::disk
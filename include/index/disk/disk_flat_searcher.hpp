@@ -17,6 +17,7 @@
 #include <vector>
 #include "index/disk/disk_flat_builder.hpp"  // bit-pattern helpers in alaya::disk::detail
 #include "index/disk/segment_manifest.hpp"
+#include "index/disk/segment_tombstones.hpp"
 #include "index/disk/types.hpp"
 #include "simd/distance_ip.hpp"
 #include "simd/distance_l2.hpp"
@@ -105,6 +106,9 @@ class DiskFlatSegmentSearcher : public SegmentSearcher {
                                std::to_string(vectors_mmap_.size()) + " for " +
                                manifest_.vectors_file);
     }
+
+    tombstones_ = std::make_unique<SegmentTombstones>(manifest_.count);
+    tombstones_->load(segment_dir);
   }
 
   DiskFlatSegmentSearcher(const DiskFlatSegmentSearcher &) = delete;
@@ -115,6 +119,16 @@ class DiskFlatSegmentSearcher : public SegmentSearcher {
 
   auto search(const float *query, const DiskSearchOptions &opts) const
       -> std::vector<DiskSearchHit> override {
+    std::vector<DiskSearchHit> hits;
+    search_into(query, opts, hits);
+    return hits;
+  }
+
+  // The top-k heap is built in `out` itself, so a reused buffer makes the L2
+  // / IP scan allocation-free.
+  void search_into(const float *query,
+                   const DiskSearchOptions &opts,
+                   std::vector<DiskSearchHit> &out) const override {
     if (opts.top_k == 0) {
       throw std::invalid_argument("DiskFlatSegmentSearcher: top_k must be > 0");
     }
@@ -174,6 +188,8 @@ class DiskFlatSegmentSearcher : public SegmentSearcher {
     const auto *ids = static_cast<const uint64_t *>(ids_mmap_.data());
     const uint64_t count = manifest_.count;
     const uint64_t k = std::min<uint64_t>(opts.top_k, count);
+    // An exact scan needs no over-fetch: deleted rows are simply skipped.
+    const SegmentTombstones *deleted = tombstones_->any() ? tombstones_.get() : nullptr;
 
     auto cmp = [](const DiskSearchHit &a, const DiskSearchHit &b) {
       if (a.distance != b.distance) {
@@ -182,10 +198,14 @@ class DiskFlatSegmentSearcher : public SegmentSearcher {
       return a.label < b.label;
     };
 
-    std::vector<DiskSearchHit> heap;
+    auto &heap = out;
+    heap.clear();
     heap.reserve(k);
 
     for (uint64_t i = 0; i < count; ++i) {
+      if (deleted != nullptr && deleted->is_deleted(i)) {
+        continue;
+      }
       const float dist = kernel(effective_query, vectors + i * d, d);
       const DiskSearchHit hit{ids[i], dist};
       if (heap.size() < k) {
@@ -199,12 +219,12 @@ class DiskFlatSegmentSearcher : public SegmentSearcher {
     }
 
     std::sort(heap.begin(), heap.end(), cmp);
-    return heap;
   }
 
   auto size() const -> uint64_t override { return manifest_.count; }
   auto dim() const -> uint32_t override { return static_cast<uint32_t>(manifest_.dim); }
   auto type() const -> DiskIndexType override { return DiskIndexType::Flat; }
+  auto tombstones() const -> SegmentTombstones * override { return tombstones_.get(); }
 
   // Read-only view of the segment's external labels (size == size()).
   auto labels() const -> const uint64_t * {
@@ -217,6 +237,7 @@ class DiskFlatSegmentSearcher : public SegmentSearcher {
   SegmentManifest manifest_;
   alaya::storage::MMapFile ids_mmap_;
   alaya::storage::MMapFile vectors_mmap_;
+  std::unique_ptr<SegmentTombstones> tombstones_;
 };
 
 }  // namespace alaya::disk
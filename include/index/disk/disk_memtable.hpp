@@ -0,0 +1,273 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "index/disk/disk_flat_builder.hpp"  // bit-pattern helpers in alaya::disk::detail
+#include "index/disk/segment_tombstones.hpp"
+#include "index/disk/types.hpp"
+#include "simd/distance_ip.hpp"
+#include "simd/distance_l2.hpp"
+#include "utils/metric_type.hpp"
+
+namespace alaya::disk {
+
+// The rows DiskCollection::add_batch has buffered but not yet flushed, served
+// as one more search source next to the published segments. Each add_batch
+// call appends an immutable chunk and publishes a new memtable that shares the
+// earlier chunks, so a query that pinned the old one keeps scanning a stable
+// view while the writer moves on.
+//
+// The scan is an exact SIMD brute-force pass with the same kernels and COS
+// normalization as DiskFlatSegmentSearcher, so a row reports the same distance
+// before and after the flush that moves it into a flat segment. The buffer is
+// bounded by max_pending_bytes, which keeps the scan cheap next to a segment
+// search.
+//
+// Deleting a pending row sets its bit in the chunk's `deleted` bitmap, the one
+// piece of a chunk that changes after publication. Every memtable sharing the
+// chunk sees the delete at once; the scan skips the row and the flush leaves it
+// out of the segment it builds.
+class DiskMemtable final : public SegmentSearcher {
+ public:
+  struct Chunk {
+    std::vector<float> vectors;
+    std::vector<uint64_t> labels;
+    // Unit-length copy of `vectors` under COS (add_batch has already
+    // rejected zero-magnitude rows); empty for L2 / IP.
+    std::vector<float> normalized;
+    // Deleted rows, indexed like `labels`. Set under DiskCollection's delete
+    // and publish locks, read lock-free by the scan.
+    std::unique_ptr<SegmentTombstones> deleted;
+  };
+
+  DiskMemtable(uint32_t dim, MetricType metric) : dim_(dim), metric_(metric) {}
+
+  // `base` (may be null) plus the `n` rows in `vectors` / `labels`.
+  static auto append(const std::shared_ptr<const DiskMemtable> &base,
+                     uint32_t dim,
+                     MetricType metric,
+                     const float *vectors,
+                     const uint64_t *labels,
+                     uint64_t n) -> std::shared_ptr<const DiskMemtable> {
+    auto chunk = std::make_shared<Chunk>();
+    chunk->vectors.assign(vectors, vectors + n * dim);
+    chunk->labels.assign(labels, labels + n);
+    chunk->deleted = std::make_unique<SegmentTombstones>(n);
+    if (metric == MetricType::COS) {
+      chunk->normalized.assign(n * dim, 0.0F);
+      for (uint64_t r = 0; r < n; ++r) {
+        const float *src = vectors + r * dim;
+        double sum_sq = 0.0;
+        for (uint32_t c = 0; c < dim; ++c) {
+          sum_sq += static_cast<double>(src[c]) * static_cast<double>(src[c]);
+        }
+        if (sum_sq == 0.0) {
+          continue;
+        }
+        const double inv_norm = 1.0 / std::sqrt(sum_sq);
+        float *dst = chunk->normalized.data() + r * dim;
+        for (uint32_t c = 0; c < dim; ++c) {
+          dst[c] = static_cast<float>(static_cast<double>(src[c]) * inv_norm);
+        }
+      }
+    }
+
+    auto next = std::make_shared<DiskMemtable>(dim, metric);
+    if (base != nullptr) {
+      next->chunks_ = base->chunks_;
+      next->rows_ = base->rows_;
+    }
+    next->chunks_.push_back(std::move(chunk));
+    next->rows_ += n;
+    return next;
+  }
+
+  // `base` without its first `chunk_count` chunks, or null when none are
+  // left. A flush drops the chunks it has just published; rows appended
+  // while it was building stay pending.
+  static auto drop_front(const std::shared_ptr<const DiskMemtable> &base, size_t chunk_count)
+      -> std::shared_ptr<const DiskMemtable> {
+    if (base == nullptr || chunk_count >= base->chunks_.size()) {
+      return nullptr;
+    }
+    auto next = std::make_shared<DiskMemtable>(base->dim_, base->metric_);
+    next->chunks_.assign(base->chunks_.begin() + static_cast<std::ptrdiff_t>(chunk_count),
+                         base->chunks_.end());
+    for (const auto &chunk : next->chunks_) {
+      next->rows_ += chunk->labels.size();
+    }
+    return next;
+  }
+
+  auto chunks() const -> const std::vector<std::shared_ptr<const Chunk>> & { return chunks_; }
+
+  // Buffered rows that have not been deleted.
+  auto live_size() const -> uint64_t {
+    uint64_t deleted = 0;
+    for (const auto &chunk : chunks_) {
+      deleted += chunk->deleted->count();
+    }
+    return rows_ - deleted;
+  }
+
+  // Copy every live row, in insertion order, into `vectors` (rows x dim) and
+  // `labels` (rows), and record in `copied` (size() entries) which buffered
+  // rows were taken. Returns the number of rows copied. A row deleted while
+  // the copy runs is either skipped or reported as copied, never both.
+  auto copy_live_rows(float *vectors, uint64_t *labels, std::vector<bool> &copied) const
+      -> uint64_t {
+    copied.assign(rows_, false);
+    uint64_t out = 0;
+    uint64_t pos = 0;
+    for (const auto &chunk : chunks_) {
+      const uint64_t count = chunk->labels.size();
+      for (uint64_t i = 0; i < count; ++i, ++pos) {
+        if (chunk->deleted->is_deleted(i)) {
+          continue;
+        }
+        std::copy_n(chunk->vectors.data() + i * dim_, dim_, vectors + out * dim_);
+        labels[out] = chunk->labels[i];
+        copied[pos] = true;
+        ++out;
+      }
+    }
+    return out;
+  }
+
+  // Delete the live rows whose label is in `labels`, appending each deleted
+  // row's label to `removed`.
+  void mark_deleted(const std::unordered_set<uint64_t> &labels,
+                    std::vector<uint64_t> &removed) const {
+    for (const auto &chunk : chunks_) {
+      const uint64_t count = chunk->labels.size();
+      for (uint64_t i = 0; i < count; ++i) {
+        if (labels.count(chunk->labels[i]) != 0 && chunk->deleted->set(i)) {
+          removed.push_back(chunk->labels[i]);
+        }
+      }
+    }
+  }
+
+  // Whether `label` has a live row here (true), only deleted rows (false), or
+  // no row at all (nullopt).
+  auto label_state(uint64_t label) const -> std::optional<bool> {
+    std::optional<bool> state;
+    for (const auto &chunk : chunks_) {
+      const uint64_t count = chunk->labels.size();
+      for (uint64_t i = 0; i < count; ++i) {
+        if (chunk->labels[i] != label) {
+          continue;
+        }
+        if (!chunk->deleted->is_deleted(i)) {
+          return true;
+        }
+        state = false;
+      }
+    }
+    return state;
+  }
+
+  auto search(const float *query, const DiskSearchOptions &opts) const
+      -> std::vector<DiskSearchHit> override {
+    std::vector<DiskSearchHit> hits;
+    search_into(query, opts, hits);
+    return hits;
+  }
+
+  void search_into(const float *query,
+                   const DiskSearchOptions &opts,
+                   std::vector<DiskSearchHit> &out) const override {
+    if (opts.top_k == 0) {
+      throw std::invalid_argument("DiskMemtable: top_k must be > 0");
+    }
+    if (query == nullptr) {
+      throw std::invalid_argument("DiskMemtable: query must not be null");
+    }
+    for (uint32_t c = 0; c < dim_; ++c) {
+      if (!detail::is_finite_f32(query[c])) {
+        throw std::invalid_argument("DiskMemtable: non-finite query component at position " +
+                                    std::to_string(c));
+      }
+    }
+
+    const float *effective_query = query;
+    std::vector<float> normalized_query;
+    if (metric_ == MetricType::COS) {
+      double sum_sq = 0.0;
+      for (uint32_t c = 0; c < dim_; ++c) {
+        sum_sq += static_cast<double>(query[c]) * static_cast<double>(query[c]);
+      }
+      if (sum_sq == 0.0) {
+        throw std::invalid_argument("DiskMemtable: zero-magnitude query under COS metric");
+      }
+      const double inv_norm = 1.0 / std::sqrt(sum_sq);
+      normalized_query.resize(dim_);
+      for (uint32_t c = 0; c < dim_; ++c) {
+        normalized_query[c] = static_cast<float>(static_cast<double>(query[c]) * inv_norm);
+      }
+      effective_query = normalized_query.data();
+    }
+
+    using KernelFn = float (*)(const float *__restrict, const float *__restrict, size_t);
+    const KernelFn kernel = (metric_ == MetricType::L2)
+                                ? static_cast<KernelFn>(simd::get_l2_sqr_func())
+                                : static_cast<KernelFn>(simd::get_ip_sqr_func());
+
+    auto cmp = [](const DiskSearchHit &a, const DiskSearchHit &b) {
+      if (!detail::disk_search_distance_equal_for_order(a.distance, b.distance)) {
+        return detail::disk_search_distance_less(a.distance, b.distance);
+      }
+      return a.label < b.label;
+    };
+
+    const uint64_t k = std::min<uint64_t>(opts.top_k, rows_);
+    auto &heap = out;
+    heap.clear();
+    heap.reserve(k);
+    for (const auto &chunk : chunks_) {
+      const float *rows = metric_ == MetricType::COS ? chunk->normalized.data()
+                                                     : chunk->vectors.data();
+      const auto &deleted = *chunk->deleted;
+      const uint64_t count = chunk->labels.size();
+      for (uint64_t i = 0; i < count; ++i) {
+        if (deleted.any() && deleted.is_deleted(i)) {
+          continue;
+        }
+        const DiskSearchHit hit{chunk->labels[i], kernel(effective_query, rows + i * dim_, dim_)};
+        if (heap.size() < k) {
+          heap.push_back(hit);
+          std::push_heap(heap.begin(), heap.end(), cmp);
+        } else if (cmp(hit, heap.front())) {
+          std::pop_heap(heap.begin(), heap.end(), cmp);
+          heap.back() = hit;
+          std::push_heap(heap.begin(), heap.end(), cmp);
+        }
+      }
+    }
+    std::sort(heap.begin(), heap.end(), cmp);
+  }
+
+  auto size() const -> uint64_t override { return rows_; }
+  auto dim() const -> uint32_t override { return dim_; }
+  auto type() const -> DiskIndexType override { return DiskIndexType::Flat; }
+
+ private:
+  uint32_t dim_;
+  MetricType metric_;
+  std::vector<std::shared_ptr<const Chunk>> chunks_;
+  uint64_t rows_ = 0;
+};
+
+}  // namespace alaya::disk
@@ -5,7 +5,6 @@
 #pragma once
 
 #include <algorithm>
-#include <atomic>
 #include <bit>
 #include <cerrno>
 #include <cstdint>
@@ -13,9 +12,9 @@
 #include <filesystem>  // NOLINT(build/c++17)
 #include <limits>
 #include <memory>
-#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifndef _WIN32
@@ -25,6 +24,7 @@
 #endif
 
 #include "index/disk/segment_manifest.hpp"
+#include "index/disk/segment_tombstones.hpp"
 #include "index/disk/types.hpp"
 #include "storage/mmap_file.hpp"
 #include "utils/metric_type.hpp"
@@ -81,6 +81,27 @@ inline auto laser_parse_u32_extra(const SegmentManifest &manifest,
   return static_cast<uint32_t>(parsed);
 }
 
+inline auto laser_parse_u32_extra_default(const SegmentManifest &manifest,
+                                          const char *key,
+                                          uint32_t fallback,
+                                          const std::filesystem::path &seg_dir) -> uint32_t {
+  const auto it = manifest.x_extras.find(key);
+  if (it == manifest.x_extras.end() || it->second.empty()) {
+    return fallback;
+  }
+  return laser_parse_u32_extra(manifest, key, seg_dir);
+}
+
+// Default size of the per-segment ThreadData pool, i.e. how many queries one
+// LASER segment serves concurrently. Every entry owns an I/O context (1024 aio
+// events under libaio, charged against fs.aio-max-nr) and 2 * beam_width pages
+// of sector scratch, so the default is capped; x_laser_search_threads overrides.
+inline auto laser_default_search_threads() -> uint32_t {
+  constexpr uint32_t kMaxDefaultSearchThreads = 8;
+  const uint32_t hw = std::thread::hardware_concurrency();
+  return std::clamp<uint32_t>(hw, 1, kMaxDefaultSearchThreads);
+}
+
 inline auto laser_parse_float_extra_default(const SegmentManifest &manifest,
                                             const char *key,
                                             float fallback,
@@ -272,8 +293,20 @@ class LaserSegmentSearcher : public SegmentSearcher {
                                                 "x_laser_search_dram_budget_gb",
                                                 0.5F,
                                                 seg_dir);
+    const uint32_t search_threads =
+        detail::laser_parse_u32_extra_default(manifest_,
+                                              "x_laser_search_threads",
+                                              detail::laser_default_search_threads(),
+                                              seg_dir);
     try {
       quantized_graph_->load_disk_index(index_prefix.c_str(), dram_budget_gb);
+      // Size the ThreadData pool once. Per-query ef / beam_width go through
+      // QuantizedGraph::search, which grows a checked-out ThreadData in place,
+      // so the pool is never torn down while searches are in flight.
+      const DiskSearchOptions defaults;
+      quantized_graph_->set_params(defaults.ef,
+                                   search_threads,
+                                   static_cast<int>(defaults.beam_width));
     } catch (const std::exception &e) {
       throw std::runtime_error("LaserSegmentSearcher: QuantizedGraph load failed for " +
                                seg_dir.string() + ": " + e.what());
@@ -289,7 +322,9 @@ class LaserSegmentSearcher : public SegmentSearcher {
           std::to_string(ids_mmap_.size()) + " for " + (seg_dir / manifest_.ids_file).string());
     }
     ids_view_ = ids_mmap_.as<uint64_t>();
-    last_set_params_ = LastSetParams{0, 0, 0};
+
+    tombstones_ = std::make_unique<SegmentTombstones>(manifest_.count);
+    tombstones_->load(seg_dir);
   }
 
   LaserSegmentSearcher(const LaserSegmentSearcher &) = delete;
@@ -300,6 +335,16 @@ class LaserSegmentSearcher : public SegmentSearcher {
 
   auto search(const float *query, const DiskSearchOptions &opts) const
       -> std::vector<DiskSearchHit> override {
+    std::vector<DiskSearchHit> hits;
+    search_into(query, opts, hits);
+    return hits;
+  }
+
+  // PIDs land in a per-thread buffer and labels are written straight into
+  // `out`, so a reused buffer makes the adapter allocation-free.
+  void search_into(const float *query,
+                   const DiskSearchOptions &opts,
+                   std::vector<DiskSearchHit> &out) const override {
     if (opts.top_k == 0) {
       throw std::invalid_argument("LaserSegmentSearcher: top_k must be > 0");
     }
@@ -310,71 +355,68 @@ class LaserSegmentSearcher : public SegmentSearcher {
       throw std::invalid_argument("LaserSegmentSearcher: beam_width exceeds int max");
     }
 
-    // Argument validation stays pre-lock per spec; the rest serialises so
-    // QuantizedGraph::set_params' destroy + rebuild cannot race in-flight searches.
-    const std::lock_guard<std::mutex> lock(search_mutex_);
-
+    // No lock: ef / beam_width are per-query arguments and the graph hands each
+    // caller its own ThreadData, so concurrent searches only contend on the
+    // pool's checkout queue.
     const auto effective_top_k = static_cast<uint32_t>(
         std::min<uint64_t>(static_cast<uint64_t>(opts.top_k), manifest_.count));
-    const LastSetParams requested{
-        static_cast<size_t>(std::max(opts.ef, effective_top_k)),
-        1,
-        static_cast<int>(opts.beam_width),
-    };
-    if (requested != last_set_params_) {
-      apply_set_params(requested);
-      last_set_params_ = requested;
-    }
 
-    std::vector<uint32_t> pid_buf;
-    pid_buf.resize(effective_top_k);
-    quantized_graph_->search(query, effective_top_k, pid_buf.data());
-
-    std::vector<DiskSearchHit> out;
-    out.reserve(effective_top_k);
-    for (uint32_t pid : pid_buf) {
-      if (pid >= manifest_.count) {
-        throw std::runtime_error("LaserSegmentSearcher: QuantizedGraph returned PID " +
-                                 std::to_string(pid) + " outside segment count " +
-                                 std::to_string(manifest_.count));
+    // Over-fetch past deleted rows, widening until top_k live PIDs survive.
+    const SegmentTombstones *deleted = tombstones_->any() ? tombstones_.get() : nullptr;
+    auto fetch_k = deleted == nullptr ? effective_top_k
+                                      : static_cast<uint32_t>(detail::tombstone_overfetch(
+                                            effective_top_k, manifest_.count, deleted->count()));
+
+    thread_local std::vector<uint32_t> pid_buf;
+    for (;;) {
+      const auto ef_search = static_cast<size_t>(std::max(opts.ef, fetch_k));
+      pid_buf.resize(fetch_k);
+      quantized_graph_->search(query,
+                               fetch_k,
+                               pid_buf.data(),
+                               ef_search,
+                               static_cast<size_t>(opts.beam_width));
+
+      out.clear();
+      out.reserve(effective_top_k);
+      for (uint32_t pid : pid_buf) {
+        if (pid >= manifest_.count) {
+          throw std::runtime_error("LaserSegmentSearcher: QuantizedGraph returned PID " +
+                                   std::to_string(pid) + " outside segment count " +
+                                   std::to_string(manifest_.count));
+        }
+        if (deleted != nullptr && deleted->is_deleted(pid)) {
+          continue;
+        }
+        out.push_back(DiskSearchHit{ids_view_[pid], std::numeric_limits<float>::quiet_NaN()});
+        if (out.size() == effective_top_k) {
+          break;
+        }
+      }
+      if (deleted == nullptr || out.size() == effective_top_k || fetch_k >= manifest_.count) {
+        return;
       }
-      out.push_back(DiskSearchHit{ids_view_[pid], std::numeric_limits<float>::quiet_NaN()});
+      fetch_k = static_cast<uint32_t>(std::min<uint64_t>(uint64_t{fetch_k} * 2, manifest_.count));
     }
-    return out;
   }
   auto size() const -> uint64_t override { return manifest_.count; }
   auto dim() const -> uint32_t override { return static_cast<uint32_t>(manifest_.dim); }
   auto type() const -> DiskIndexType override { return DiskIndexType::Laser; }
+  auto tombstones() const -> SegmentTombstones * override { return tombstones_.get(); }
 
-  // Test-only observer for the cached set_params triple (D5). Counts how many
-  // times `QuantizedGraph::set_params` has been forwarded; tests rely on this
-  // to assert the cache-and-skip behaviour without reaching into private state.
-  auto set_params_call_count() const noexcept -> uint64_t {
-    return set_params_call_count_.load(std::memory_order_relaxed);
+  // Test-only observer: how many times the QuantizedGraph ThreadData pool has
+  // been built. Fixed after construction; search() must never move it.
+  auto thread_pool_build_count() const noexcept -> uint64_t {
+    return quantized_graph_->thread_data_pool_builds();
   }
 
  private:
-  struct LastSetParams {
-    size_t ef_search;
-    size_t num_threads;
-    int beam_width;
-
-    friend auto operator==(const LastSetParams &, const LastSetParams &) -> bool = default;
-  };
-
-  void apply_set_params(const LastSetParams &requested) const {
-    quantized_graph_->set_params(requested.ef_search, requested.num_threads, requested.beam_width);
-    set_params_call_count_.fetch_add(1, std::memory_order_relaxed);
-  }
-
   // Declaration order matters: quantized_graph_ is destroyed before ids_mmap_.
   SegmentManifest manifest_;
   alaya::storage::MMapFile ids_mmap_;
   std::unique_ptr<alaya::laser::QuantizedGraph> quantized_graph_;
   const uint64_t *ids_view_ = nullptr;
-  mutable LastSetParams last_set_params_{0, 0, 0};
-  mutable std::atomic<uint64_t> set_params_call_count_{0};
-  mutable std::mutex search_mutex_;
+  std::unique_ptr<SegmentTombstones> tombstones_;
 };
 
 #else
@@ -0,0 +1,244 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "index/disk/segment_manifest.hpp"
+#include "storage/mmap_file.hpp"
+
+namespace alaya::disk {
+
+// Size-tiered compaction policy for DiskCollection. Segments are bucketed into
+// tiers whose live (non-deleted) row counts lie within `tier_ratio` of each
+// other; the smallest tier holding at least `min_merge_segments` segments is
+// merged, up to `max_merge_segments` at a time. Small flushes therefore
+// collapse into larger segments long before large segments are rewritten
+// again. Compaction drops deleted rows, so deletes shrink a segment's tier.
+struct CompactionPolicy {
+  uint32_t min_merge_segments = 4;
+  uint32_t max_merge_segments = 16;
+  double tier_ratio = 4.0;
+  // Segments at or above this many rows are never picked (0 = no limit).
+  uint64_t max_segment_rows = 0;
+  // When no tier qualifies, rewrite the segment with the largest deleted
+  // fraction on its own once that fraction reaches this value (0 = never).
+  double max_deleted_ratio = 0.2;
+  // Background compactor wake-up period; flush() and mark_deleted() also
+  // wake it early.
+  std::chrono::milliseconds interval{1000};
+};
+
+namespace detail {
+
+inline void validate_compaction_policy(const CompactionPolicy &policy) {
+  if (policy.min_merge_segments < 2) {
+    throw std::invalid_argument("CompactionPolicy: min_merge_segments must be >= 2");
+  }
+  if (policy.max_merge_segments < policy.min_merge_segments) {
+    throw std::invalid_argument(
+        "CompactionPolicy: max_merge_segments must be >= min_merge_segments");
+  }
+  if (!(policy.tier_ratio > 1.0) || !std::isfinite(policy.tier_ratio)) {
+    throw std::invalid_argument("CompactionPolicy: tier_ratio must be finite and > 1");
+  }
+  if (!(policy.max_deleted_ratio >= 0.0 && policy.max_deleted_ratio <= 1.0)) {
+    throw std::invalid_argument("CompactionPolicy: max_deleted_ratio must be in [0, 1]");
+  }
+  if (policy.interval.count() <= 0) {
+    throw std::invalid_argument("CompactionPolicy: interval must be > 0");
+  }
+}
+
+// Pick the segments to merge next. `rows[i]` is segment i's row count. Returns
+// segment positions in ascending order, or an empty vector when no tier has
+// enough members.
+inline auto pick_size_tiered_segments(const std::vector<uint64_t> &rows,
+                                      const CompactionPolicy &policy) -> std::vector<uint32_t> {
+  std::vector<uint32_t> order;
+  order.reserve(rows.size());
+  for (uint32_t i = 0; i < rows.size(); ++i) {
+    if (policy.max_segment_rows == 0 || rows[i] < policy.max_segment_rows) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&rows](uint32_t a, uint32_t b) {
+    return rows[a] < rows[b];
+  });
+
+  // Walk ascending sizes; a tier starts at its smallest member and admits
+  // every segment no more than tier_ratio times larger.
+  size_t begin = 0;
+  while (begin < order.size()) {
+    const double limit =
+        static_cast<double>(std::max<uint64_t>(rows[order[begin]], 1)) * policy.tier_ratio;
+    size_t end = begin + 1;
+    while (end < order.size() && static_cast<double>(rows[order[end]]) <= limit) {
+      ++end;
+    }
+    if (end - begin >= policy.min_merge_segments) {
+      const size_t take = std::min<size_t>(end - begin, policy.max_merge_segments);
+      std::vector<uint32_t> picked(order.begin() + static_cast<std::ptrdiff_t>(begin),
+                                   order.begin() + static_cast<std::ptrdiff_t>(begin + take));
+      std::sort(picked.begin(), picked.end());
+      return picked;
+    }
+    begin = end;
+  }
+  return {};
+}
+
+// An engine that builds only from at least `min_build_rows` rows cannot
+// rewrite a pick holding 1..min_build_rows-1 live rows. Fold in the smallest
+// other non-empty segments the policy admits until the pick is buildable;
+// false when none can make up the shortfall. An empty pick of all-deleted
+// segments needs no build and is left alone.
+inline auto fold_to_min_build_rows(std::vector<uint32_t> &picked,
+                                   const std::vector<uint64_t> &live,
+                                   const CompactionPolicy &policy,
+                                   uint64_t min_build_rows) -> bool {
+  uint64_t total = 0;
+  for (const auto i : picked) {
+    total += live[i];
+  }
+  if (total == 0 || total >= min_build_rows) {
+    return true;
+  }
+  std::vector<uint32_t> spare;
+  for (uint32_t i = 0; i < live.size(); ++i) {
+    if (live[i] > 0 && std::find(picked.begin(), picked.end(), i) == picked.end() &&
+        (policy.max_segment_rows == 0 || live[i] < policy.max_segment_rows)) {
+      spare.push_back(i);
+    }
+  }
+  std::stable_sort(spare.begin(), spare.end(), [&live](uint32_t a, uint32_t b) {
+    return live[a] < live[b];
+  });
+  for (const auto i : spare) {
+    if (total >= min_build_rows) {
+      break;
+    }
+    picked.push_back(i);
+    total += live[i];
+  }
+  if (total < min_build_rows) {
+    return false;
+  }
+  std::sort(picked.begin(), picked.end());
+  return true;
+}
+
+// Full compaction pick over segments with `rows[i]` physical rows of which
+// `deleted[i]` are tombstoned: a size tier over live rows first, otherwise a
+// single-segment rewrite of the most-deleted segment past max_deleted_ratio.
+// Either pick is widened to hold at least `min_build_rows` live rows (see
+// fold_to_min_build_rows) or dropped, so a rebuild never sees too few rows.
+inline auto pick_compaction_segments(const std::vector<uint64_t> &rows,
+                                     const std::vector<uint64_t> &deleted,
+                                     const CompactionPolicy &policy,
+                                     uint64_t min_build_rows = 1) -> std::vector<uint32_t> {
+  std::vector<uint64_t> live(rows.size());
+  for (size_t i = 0; i < rows.size(); ++i) {
+    live[i] = rows[i] - std::min(deleted[i], rows[i]);
+  }
+  auto picked = pick_size_tiered_segments(live, policy);
+  if (!picked.empty() && fold_to_min_build_rows(picked, live, policy, min_build_rows)) {
+    return picked;
+  }
+  if (policy.max_deleted_ratio == 0.0) {
+    return {};
+  }
+  std::vector<std::pair<double, uint32_t>> candidates;
+  for (uint32_t i = 0; i < rows.size(); ++i) {
+    if (rows[i] == 0 || deleted[i] == 0) {
+      continue;
+    }
+    const double ratio = static_cast<double>(deleted[i]) / static_cast<double>(rows[i]);
+    if (ratio >= policy.max_deleted_ratio) {
+      candidates.emplace_back(ratio, i);
+    }
+  }
+  // Most-deleted first; ties keep the lower position.
+  std::stable_sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) {
+    return a.first > b.first;
+  });
+  for (const auto &candidate : candidates) {
+    picked.assign(1, candidate.second);
+    if (fold_to_min_build_rows(picked, live, policy, min_build_rows)) {
+      return picked;
+    }
+  }
+  return {};
+}
+
+// Engine-agnostic read of a segment's stored rows (`vectors_file` + `ids_file`),
+// the input a compaction rebuild consumes. LASER segments publish no vectors
+// file and are rejected here.
+struct SegmentRowsView {
+  alaya::storage::MMapFile vectors;
+  alaya::storage::MMapFile ids;
+  uint64_t count = 0;
+
+  auto vector_data() const -> const float * { return static_cast<const float *>(vectors.data()); }
+  auto id_data() const -> const uint64_t * { return static_cast<const uint64_t *>(ids.data()); }
+};
+
+inline auto load_segment_rows_view(const std::filesystem::path &seg_dir) -> SegmentRowsView {
+  const auto sm = SegmentManifest::load(seg_dir / "manifest.txt");
+  if (sm.vectors_file.empty()) {
+    throw std::runtime_error("DiskCollection: segment has no vectors_file to compact: " +
+                             seg_dir.string());
+  }
+  SegmentRowsView view;
+  view.count = sm.count;
+  view.ids = alaya::storage::MMapFile(seg_dir / sm.ids_file);
+  view.vectors = alaya::storage::MMapFile(seg_dir / sm.vectors_file);
+  if (view.ids.size() != sm.count * sizeof(uint64_t) ||
+      view.vectors.size() != sm.count * sm.dim * sizeof(float)) {
+    throw std::runtime_error("DiskCollection: segment file size mismatch during compaction at " +
+                             seg_dir.string());
+  }
+  return view;
+}
+
+// Comma-separated segment ids, as stored under x_retired_segments.
+inline auto split_segment_id_list(const std::string &csv) -> std::vector<std::string> {
+  std::vector<std::string> out;
+  size_t pos = 0;
+  while (pos <= csv.size()) {
+    const size_t comma = csv.find(',', pos);
+    const size_t end = comma == std::string::npos ? csv.size() : comma;
+    if (end > pos) {
+      out.push_back(csv.substr(pos, end - pos));
+    }
+    if (comma == std::string::npos) {
+      break;
+    }
+    pos = comma + 1;
+  }
+  return out;
+}
+
+inline auto join_segment_id_list(const std::vector<std::string> &ids) -> std::string {
+  std::string out;
+  for (const auto &id : ids) {
+    if (!out.empty()) {
+      out += ',';
+    }
+    out += id;
+  }
+  return out;
+}
+
+}  // namespace detail
+}  // namespace alaya::disk
@@ -32,8 +32,8 @@ namespace alaya::disk {
 
 // engine_supported_v1: v1 capability gate.
 //   Flat   → true
-//   Vamana → true  (registered via the Vamana adapter; metric scope is L2-only,
-//                   surfaced through the engine's own runtime_error rather than
+//   Vamana → true  (registered via the Vamana adapter; metric scope is
+//                   L2 / IP / COS, enforced by the engine itself rather than
 //                   through this gate)
 //   Laser  → build/platform gated. v1 supports load/import only when LASER is
 //            compiled into a Linux consumer TU; create-from-pending still throws.
@@ -165,9 +165,9 @@ inline auto laser_import_params_from_manifest(const CollectionManifest &manifest
 //
 // v1 routing:
 //   Flat   → DiskFlatBuilder + DiskFlatSegmentSearcher
-//   Vamana → VamanaSegmentBuilder + VamanaSegmentSearcher (L2 only — IP/COS
-//            surface through the engine's own runtime_error before any
-//            filesystem mutation)
+//   Vamana → VamanaSegmentBuilder + VamanaSegmentSearcher (L2 / IP / COS;
+//            other metrics surface through the engine's own runtime_error
+//            before any filesystem mutation)
 //   Laser  → throws (no files created at seg_dir)
 //
 // The factory dispatches on `col_manifest.index_type`; `seg_dir` MUST satisfy
@@ -0,0 +1,585 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/mmap_file.hpp"
+#include "utils/platform_fs.hpp"
+
+namespace alaya::disk {
+
+static_assert(std::endian::native == std::endian::little,
+              "SegmentLabelRun on-disk format assumes little-endian host");
+
+struct LabelRowEntry {
+  uint64_t label;
+  uint64_t row;
+};
+static_assert(sizeof(LabelRowEntry) == 2 * sizeof(uint64_t));
+
+// One segment's labels sorted by value, each paired with its row in the
+// segment's ids file: a persistent sorted run that answers "does this
+// segment hold label L, and at which row" with one binary search. Written
+// once as `labels.sorted.bin` when the segment is published and mmapped on
+// open, so neither a duplicate check nor a delete has to read ids files.
+//
+// Layout: [magic | count | count x (label, row)], little-endian uint64s.
+class SegmentLabelRun {
+ public:
+  static constexpr uint64_t kMagic = 0x414C59534C424C31ULL;  // "ALYSLBL1"
+  static constexpr const char *kFileName = "labels.sorted.bin";
+
+  SegmentLabelRun(const SegmentLabelRun &) = delete;
+  auto operator=(const SegmentLabelRun &) -> SegmentLabelRun & = delete;
+  SegmentLabelRun(SegmentLabelRun &&) = delete;
+  auto operator=(SegmentLabelRun &&) -> SegmentLabelRun & = delete;
+  ~SegmentLabelRun() = default;
+
+  // Sort `labels` (row i holds labels[i]) into a run held in memory.
+  static auto from_labels(const uint64_t *labels, uint64_t count)
+      -> std::shared_ptr<const SegmentLabelRun> {
+    std::vector<LabelRowEntry> entries(count);
+    for (uint64_t i = 0; i < count; ++i) {
+      entries[i] = LabelRowEntry{labels[i], i};
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+      return a.label < b.label;
+    });
+    return std::shared_ptr<const SegmentLabelRun>(new SegmentLabelRun(std::move(entries)));
+  }
+
+  // Map `seg_dir`/labels.sorted.bin. Returns nullptr when the file is absent
+  // (a segment published before the index existed), is not a regular file,
+  // or does not describe `expected_count` rows, so the caller can rebuild it
+  // from the ids file.
+  static auto load(const std::filesystem::path &seg_dir, uint64_t expected_count)
+      -> std::shared_ptr<const SegmentLabelRun> {
+    const auto path = seg_dir / kFileName;
+    std::error_code ec;
+    const auto status = std::filesystem::symlink_status(path, ec);
+    if (ec || !std::filesystem::is_regular_file(status)) {
+      return nullptr;
+    }
+    alaya::storage::MMapFile mmap(path);
+    const auto *words = static_cast<const uint64_t *>(mmap.data());
+    if (mmap.size() < 2 * sizeof(uint64_t) || words[0] != kMagic || words[1] != expected_count ||
+        mmap.size() != (2 + 2 * expected_count) * sizeof(uint64_t)) {
+      return nullptr;
+    }
+    return std::shared_ptr<const SegmentLabelRun>(new SegmentLabelRun(std::move(mmap)));
+  }
+
+  // Durably write this run into `seg_dir`. Segment directories are immutable
+  // once listed, so this runs before the segment is published (or, for an
+  // older segment, replaces a file no reader has mapped yet).
+  void save(const std::filesystem::path &seg_dir) const {
+    std::vector<uint64_t> blob(2 + 2 * count_);
+    blob[0] = kMagic;
+    blob[1] = count_;
+    std::copy_n(reinterpret_cast<const uint64_t *>(entries_), 2 * count_, blob.data() + 2);
+    const auto tmp = seg_dir / (std::string(kFileName) + ".tmp." +
+                                std::to_string(::alaya::platform::get_pid()));
+    ::alaya::platform::write_all_fsync(tmp, blob.data(), blob.size() * sizeof(uint64_t));
+    ::alaya::platform::atomic_replace(tmp, seg_dir / kFileName);
+    ::alaya::platform::sync_directory_or_throw(seg_dir);
+  }
+
+  auto size() const -> uint64_t { return count_; }
+
+  // Visit every (label, row) entry in label order.
+  template <typename Fn>
+  void for_each(Fn &&fn) const {
+    for (uint64_t i = 0; i < count_; ++i) {
+      fn(entries_[i]);
+    }
+  }
+
+  // Row holding `label` in this segment, if any. O(log count); a label
+  // outside [first, last] of the run is answered without touching the
+  // middle of the mapping, which is what most segments see when labels are
+  // assigned in increasing order.
+  auto find(uint64_t label) const -> std::optional<uint64_t> {
+    if (count_ == 0 || label < entries_[0].label || label > entries_[count_ - 1].label) {
+      return std::nullopt;
+    }
+    const auto *end = entries_ + count_;
+    const auto *it = std::lower_bound(entries_, end, label, [](const auto &e, uint64_t l) {
+      return e.label < l;
+    });
+    if (it == end || it->label != label) {
+      return std::nullopt;
+    }
+    return it->row;
+  }
+
+ private:
+  explicit SegmentLabelRun(std::vector<LabelRowEntry> owned)
+      : owned_(std::move(owned)), entries_(owned_.data()), count_(owned_.size()) {}
+
+  explicit SegmentLabelRun(alaya::storage::MMapFile mmap)
+      : mmap_(std::move(mmap)),
+        entries_(reinterpret_cast<const LabelRowEntry *>(static_cast<const uint64_t *>(
+                                                              mmap_.data()) +
+                                                          2)),
+        count_(static_cast<const uint64_t *>(mmap_.data())[1]) {}
+
+  alaya::storage::MMapFile mmap_;
+  std::vector<LabelRowEntry> owned_;
+  const LabelRowEntry *entries_ = nullptr;
+  uint64_t count_ = 0;
+};
+
+// Where a label lives: the segment's position in the collection's segment
+// list and the row in that segment's ids file.
+struct LabelLocation {
+  uint64_t label;
+  uint64_t segment;
+  uint64_t row;
+};
+static_assert(sizeof(LabelLocation) == 3 * sizeof(uint64_t));
+
+// An entry of a merged label tier. The segment is named by id, not by
+// position, so compaction never has to rewrite a tier because positions moved.
+struct LabelTierEntry {
+  uint64_t label;
+  uint64_t segment_id;
+  uint64_t row;
+};
+static_assert(sizeof(LabelTierEntry) == 3 * sizeof(uint64_t));
+
+// The labels of one or more segments as one immutable run sorted by label.
+// A tier is either one segment's own label run, shared rather than copied,
+// or the merge of several tiers, written once as `labels.tier_<seq>.bin` in
+// the collection directory and mmapped. A tier never changes after it is
+// written; CollectionLabelIndex replaces tiers rather than editing them.
+//
+// Layout: [magic | count | n_segments | n_segments x (segment id, entries) |
+//          count x (label, segment id, row)], little-endian uint64s.
+class LabelTier {
+ public:
+  static constexpr uint64_t kMagic = 0x414C59544C424C31ULL;  // "ALYTLBL1"
+
+  LabelTier(const LabelTier &) = delete;
+  auto operator=(const LabelTier &) -> LabelTier & = delete;
+  LabelTier(LabelTier &&) = delete;
+  auto operator=(LabelTier &&) -> LabelTier & = delete;
+  ~LabelTier() = default;
+
+  // A one-segment tier served straight from the segment's label run.
+  static auto of_segment(std::shared_ptr<const SegmentLabelRun> run, uint64_t segment_id)
+      -> std::shared_ptr<const LabelTier> {
+    std::vector<std::pair<uint64_t, uint64_t>> segments{{segment_id, run->size()}};
+    return std::shared_ptr<const LabelTier>(new LabelTier(std::move(run), std::move(segments)));
+  }
+
+  // The entries of `tiers` whose segment id is in `live` (sorted), merged
+  // into one tier held in memory. O(total entries) plus the sort.
+  static auto merge(const std::vector<const LabelTier *> &tiers, const std::vector<uint64_t> &live)
+      -> std::shared_ptr<const LabelTier> {
+    auto is_live = [&live](uint64_t id) {
+      return std::binary_search(live.begin(), live.end(), id);
+    };
+    std::vector<std::pair<uint64_t, uint64_t>> segments;
+    uint64_t total = 0;
+    for (const auto *tier : tiers) {
+      for (const auto &[id, entries] : tier->segments()) {
+        if (is_live(id)) {
+          segments.emplace_back(id, entries);
+          total += entries;
+        }
+      }
+    }
+    std::sort(segments.begin(), segments.end());
+    std::vector<LabelTierEntry> entries;
+    entries.reserve(total);
+    for (const auto *tier : tiers) {
+      tier->for_each([&](const LabelTierEntry &e) {
+        if (is_live(e.segment_id)) {
+          entries.push_back(e);
+        }
+      });
+    }
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+      return a.label < b.label;
+    });
+    return std::shared_ptr<const LabelTier>(new LabelTier(std::move(entries), std::move(segments)));
+  }
+
+  static auto file_name(uint64_t seq) -> std::string {
+    return "labels.tier_" + std::to_string(seq) + ".bin";
+  }
+
+  // Map `dir`/labels.tier_<seq>.bin. Returns nullptr when the file is absent,
+  // is not a regular file or is malformed, so the caller can fall back to
+  // the segments' own runs.
+  static auto load(const std::filesystem::path &dir, uint64_t seq)
+      -> std::shared_ptr<const LabelTier> {
+    const auto path = dir / file_name(seq);
+    std::error_code ec;
+    const auto status = std::filesystem::symlink_status(path, ec);
+    if (ec || !std::filesystem::is_regular_file(status)) {
+      return nullptr;
+    }
+    alaya::storage::MMapFile mmap(path);
+    const auto *words = static_cast<const uint64_t *>(mmap.data());
+    const uint64_t words_total = mmap.size() / sizeof(uint64_t);
+    if (mmap.size() % sizeof(uint64_t) != 0 || words_total < 3 || words[0] != kMagic ||
+        words[2] > (words_total - 3) / 2) {
+      return nullptr;
+    }
+    const uint64_t count = words[1];
+    const uint64_t header = 3 + 2 * words[2];
+    if (count > (words_total - header) / 3 || words_total != header + 3 * count) {
+      return nullptr;
+    }
+    std::vector<std::pair<uint64_t, uint64_t>> segments(words[2]);
+    uint64_t total = 0;
+    for (uint64_t s = 0; s < segments.size(); ++s) {
+      segments[s] = {words[3 + 2 * s], words[4 + 2 * s]};
+      total += segments[s].second;
+    }
+    if (total != count || !std::is_sorted(segments.begin(), segments.end())) {
+      return nullptr;
+    }
+    return std::shared_ptr<const LabelTier>(
+        new LabelTier(std::move(mmap), std::move(segments), seq));
+  }
+
+  // Durably write this tier as `dir`/labels.tier_<seq>.bin.
+  void save(const std::filesystem::path &dir, uint64_t seq) const {
+    const uint64_t header = 3 + 2 * segments_.size();
+    std::vector<uint64_t> blob(header);
+    blob.reserve(header + 3 * count_);
+    blob[0] = kMagic;
+    blob[1] = count_;
+    blob[2] = segments_.size();
+    for (uint64_t s = 0; s < segments_.size(); ++s) {
+      blob[3 + 2 * s] = segments_[s].first;
+      blob[4 + 2 * s] = segments_[s].second;
+    }
+    for_each([&blob](const LabelTierEntry &e) {
+      blob.insert(blob.end(), {e.label, e.segment_id, e.row});
+    });
+    const auto tmp = dir / (file_name(seq) + ".tmp." +
+                            std::to_string(::alaya::platform::get_pid()));
+    ::alaya::platform::write_all_fsync(tmp, blob.data(), blob.size() * sizeof(uint64_t));
+    ::alaya::platform::atomic_replace(tmp, dir / file_name(seq));
+    ::alaya::platform::sync_directory_or_throw(dir);
+  }
+
+  auto size() const -> uint64_t { return count_; }
+
+  // (segment id, entries) for every segment this tier covers, sorted by id.
+  auto segments() const -> const std::vector<std::pair<uint64_t, uint64_t>> & {
+    return segments_;
+  }
+
+  // The segment whose own run this tier is, if it is one.
+  auto segment_run_id() const -> std::optional<uint64_t> {
+    if (run_ == nullptr) {
+      return std::nullopt;
+    }
+    return segments_.front().first;
+  }
+
+  // The file sequence number of a merged tier, once written (0 otherwise).
+  auto file_seq() const -> uint64_t { return seq_; }
+
+  // Visit every entry in label order.
+  template <typename Fn>
+  void for_each(Fn &&fn) const {
+    if (run_ != nullptr) {
+      const uint64_t id = segments_.front().first;
+      run_->for_each([&](const LabelRowEntry &e) {
+        fn(LabelTierEntry{e.label, id, e.row});
+      });
+      return;
+    }
+    for (uint64_t i = 0; i < count_; ++i) {
+      fn(entries_[i]);
+    }
+  }
+
+  // Call `pred` on each entry for `label` until it returns true; returns
+  // whether it did. O(log count), with the same [first, last] shortcut as
+  // SegmentLabelRun::find.
+  template <typename Pred>
+  auto find_if(uint64_t label, Pred &&pred) const -> bool {
+    if (run_ != nullptr) {
+      const auto row = run_->find(label);
+      return row.has_value() && pred(LabelTierEntry{label, segments_.front().first, *row});
+    }
+    if (count_ == 0 || label < entries_[0].label || label > entries_[count_ - 1].label) {
+      return false;
+    }
+    const auto *end = entries_ + count_;
+    const auto *it = std::lower_bound(entries_, end, label, [](const auto &e, uint64_t l) {
+      return e.label < l;
+    });
+    for (; it != end && it->label == label; ++it) {
+      if (pred(*it)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  LabelTier(std::shared_ptr<const SegmentLabelRun> run,
+            std::vector<std::pair<uint64_t, uint64_t>> segments)
+      : run_(std::move(run)), segments_(std::move(segments)), count_(run_->size()) {}
+
+  LabelTier(std::vector<LabelTierEntry> owned, std::vector<std::pair<uint64_t, uint64_t>> segments)
+      : owned_(std::move(owned)),
+        segments_(std::move(segments)),
+        entries_(owned_.data()),
+        count_(owned_.size()) {}
+
+  LabelTier(alaya::storage::MMapFile mmap,
+            std::vector<std::pair<uint64_t, uint64_t>> segments,
+            uint64_t seq)
+      : mmap_(std::move(mmap)),
+        segments_(std::move(segments)),
+        entries_(reinterpret_cast<const LabelTierEntry *>(
+            static_cast<const uint64_t *>(mmap_.data()) + 3 + 2 * segments_.size())),
+        count_(static_cast<const uint64_t *>(mmap_.data())[1]),
+        seq_(seq) {}
+
+  std::shared_ptr<const SegmentLabelRun> run_;
+  alaya::storage::MMapFile mmap_;
+  std::vector<LabelTierEntry> owned_;
+  std::vector<std::pair<uint64_t, uint64_t>> segments_;
+  const LabelTierEntry *entries_ = nullptr;
+  uint64_t count_ = 0;
+  uint64_t seq_ = 0;
+};
+
+// Every published segment's labels as a short stack of label tiers, so
+// "where is label L" costs one binary search per tier and never touches an
+// ids file. A label has one entry per segment that holds it (at most one of
+// them live); the caller checks tombstones.
+//
+// Publishing a segment pushes its own label run as a new tier, which writes
+// nothing. consolidate() then merges the newest two tiers while the older
+// holds no more live entries than the newer, like a binary counter: the
+// stack stays O(log N) tiers deep and each entry is rewritten O(log N)
+// times over its life, so a flush costs O(batch log N) amortized rather
+// than a rewrite of the whole index. Compaction pushes the merged
+// segment's run; the victims' entries stay in their tiers, are skipped by
+// lookups, and are dropped when their tier is next merged or once they are
+// the majority of it. DiskCollection lists the tiers in its manifest, so
+// the index on disk always matches the published segment list.
+class CollectionLabelIndex {
+ public:
+  CollectionLabelIndex(const CollectionLabelIndex &) = delete;
+  auto operator=(const CollectionLabelIndex &) -> CollectionLabelIndex & = delete;
+  CollectionLabelIndex(CollectionLabelIndex &&) = delete;
+  auto operator=(CollectionLabelIndex &&) -> CollectionLabelIndex & = delete;
+  ~CollectionLabelIndex() = default;
+
+  // An index over `segment_ids` made of `tiers`, with one own-run tier for
+  // each listed segment no tier covers (`runs[i]` belongs to
+  // segment_ids[i]). A tier that disagrees with a run's size is dropped, so
+  // a stale tier file never shadows the segments' own runs.
+  static auto assemble(std::vector<std::shared_ptr<const LabelTier>> tiers,
+                       const std::vector<std::shared_ptr<const SegmentLabelRun>> &runs,
+                       std::vector<uint64_t> segment_ids)
+      -> std::shared_ptr<const CollectionLabelIndex> {
+    std::vector<std::pair<uint64_t, uint64_t>> expected;  // (segment id, entries)
+    for (uint64_t s = 0; s < segment_ids.size(); ++s) {
+      expected.emplace_back(segment_ids[s], runs[s]->size());
+    }
+    std::sort(expected.begin(), expected.end());
+    std::vector<uint64_t> covered;
+    std::vector<std::shared_ptr<const LabelTier>> kept;
+    for (auto &tier : tiers) {
+      const bool consistent =
+          std::all_of(tier->segments().begin(), tier->segments().end(), [&](const auto &seg) {
+            const auto it = std::lower_bound(expected.begin(), expected.end(),
+                                             std::make_pair(seg.first, uint64_t{0}));
+            const bool listed = it != expected.end() && it->first == seg.first;
+            return (!listed || it->second == seg.second) &&
+                   std::find(covered.begin(), covered.end(), seg.first) == covered.end();
+          });
+      if (!consistent) {
+        continue;
+      }
+      for (const auto &seg : tier->segments()) {
+        covered.push_back(seg.first);
+      }
+      kept.push_back(std::move(tier));
+    }
+    for (uint64_t s = 0; s < segment_ids.size(); ++s) {
+      if (std::find(covered.begin(), covered.end(), segment_ids[s]) == covered.end()) {
+        kept.push_back(LabelTier::of_segment(runs[s], segment_ids[s]));
+      }
+    }
+    return std::shared_ptr<const CollectionLabelIndex>(
+        new CollectionLabelIndex(std::move(kept), std::move(segment_ids)));
+  }
+
+  // One own-run tier per segment (`runs[i]` belongs to segment_ids[i]).
+  static auto build(const std::vector<std::shared_ptr<const SegmentLabelRun>> &runs,
+                    std::vector<uint64_t> segment_ids)
+      -> std::shared_ptr<const CollectionLabelIndex> {
+    return assemble({}, runs, std::move(segment_ids));
+  }
+
+  // This index plus `run`, the label run of a segment appended to the end of
+  // the segment list as `segment_id`. Writes nothing; see consolidate().
+  auto append(std::shared_ptr<const SegmentLabelRun> run, uint64_t segment_id) const
+      -> std::shared_ptr<const CollectionLabelIndex> {
+    auto ids = segments_;
+    ids.push_back(segment_id);
+    return with_segments(std::move(ids), std::move(run), segment_id);
+  }
+
+  // This index over a new segment list `segment_ids`, after compaction
+  // dropped some segments and added `added` (may be null) as `added_id`.
+  // Dropped segments' entries are skipped from here on. Writes nothing.
+  auto with_segments(std::vector<uint64_t> segment_ids,
+                     std::shared_ptr<const SegmentLabelRun> added = nullptr,
+                     uint64_t added_id = 0) const -> std::shared_ptr<const CollectionLabelIndex> {
+    auto tiers = tiers_;
+    if (added != nullptr) {
+      tiers.push_back(LabelTier::of_segment(std::move(added), added_id));
+    }
+    return std::shared_ptr<const CollectionLabelIndex>(
+        new CollectionLabelIndex(std::move(tiers), std::move(segment_ids)));
+  }
+
+  // This index with its tiers merged back into shape: tiers holding no live
+  // entry are dropped, tiers that are mostly dead entries are rewritten, and
+  // the newest two are merged while the older has no more live entries than
+  // the newer. Each merged tier is written to `dir` as
+  // labels.tier_<next_seq++>.bin before it is used. Throws on a failed
+  // write; this index stays valid, and any file already written is simply
+  // left unlisted.
+  auto consolidate(const std::filesystem::path &dir, uint64_t &next_seq) const
+      -> std::shared_ptr<const CollectionLabelIndex> {
+    std::vector<uint64_t> live_ids = segments_;
+    std::sort(live_ids.begin(), live_ids.end());
+    auto write = [&](const std::vector<const LabelTier *> &parts) {
+      const uint64_t seq = next_seq++;
+      LabelTier::merge(parts, live_ids)->save(dir, seq);
+      auto tier = LabelTier::load(dir, seq);
+      if (tier == nullptr) {
+        throw std::runtime_error("CollectionLabelIndex: could not map " +
+                                 LabelTier::file_name(seq));
+      }
+      return tier;
+    };
+
+    std::vector<std::pair<std::shared_ptr<const LabelTier>, uint64_t>> stack;  // (tier, live)
+    for (const auto &tier : tiers_) {
+      const uint64_t live = live_entries(*tier, live_ids);
+      if (live == 0) {
+        continue;
+      }
+      if (2 * live < tier->size()) {
+        stack.emplace_back(write({tier.get()}), live);
+      } else {
+        stack.emplace_back(tier, live);
+      }
+    }
+    while (stack.size() >= 2 && stack[stack.size() - 2].second <= stack.back().second) {
+      const auto newer = std::move(stack.back());
+      stack.pop_back();
+      auto &older = stack.back();
+      older = {write({older.first.get(), newer.first.get()}), older.second + newer.second};
+    }
+
+    std::vector<std::shared_ptr<const LabelTier>> tiers;
+    tiers.reserve(stack.size());
+    for (auto &entry : stack) {
+      tiers.push_back(std::move(entry.first));
+    }
+    return std::shared_ptr<const CollectionLabelIndex>(
+        new CollectionLabelIndex(std::move(tiers), segments_));
+  }
+
+  // Live entries: one per (label, listed segment) pair.
+  auto size() const -> uint64_t { return live_count_; }
+  auto segment_ids() const -> const std::vector<uint64_t> & { return segments_; }
+  auto tiers() const -> const std::vector<std::shared_ptr<const LabelTier>> & { return tiers_; }
+
+  // Call `pred` on each location of `label` in a listed segment until it
+  // returns true, and return that location. O(tiers x log N).
+  template <typename Pred>
+  auto find_if(uint64_t label, Pred &&pred) const -> std::optional<LabelLocation> {
+    std::optional<LabelLocation> found;
+    for (const auto &tier : tiers_) {
+      const bool hit = tier->find_if(label, [&](const LabelTierEntry &e) {
+        const auto position = position_of(e.segment_id);
+        if (!position.has_value()) {
+          return false;
+        }
+        const LabelLocation loc{e.label, *position, e.row};
+        if (!pred(loc)) {
+          return false;
+        }
+        found = loc;
+        return true;
+      });
+      if (hit) {
+        return found;
+      }
+    }
+    return std::nullopt;
+  }
+
+ private:
+  CollectionLabelIndex(std::vector<std::shared_ptr<const LabelTier>> tiers,
+                       std::vector<uint64_t> segment_ids)
+      : tiers_(std::move(tiers)), segments_(std::move(segment_ids)) {
+    positions_.reserve(segments_.size());
+    for (uint64_t s = 0; s < segments_.size(); ++s) {
+      positions_.emplace_back(segments_[s], s);
+    }
+    std::sort(positions_.begin(), positions_.end());
+    std::vector<uint64_t> live_ids = segments_;
+    std::sort(live_ids.begin(), live_ids.end());
+    for (const auto &tier : tiers_) {
+      live_count_ += live_entries(*tier, live_ids);
+    }
+  }
+
+  static auto live_entries(const LabelTier &tier, const std::vector<uint64_t> &live_ids)
+      -> uint64_t {
+    uint64_t live = 0;
+    for (const auto &[id, entries] : tier.segments()) {
+      if (std::binary_search(live_ids.begin(), live_ids.end(), id)) {
+        live += entries;
+      }
+    }
+    return live;
+  }
+
+  auto position_of(uint64_t segment_id) const -> std::optional<uint64_t> {
+    const auto it = std::lower_bound(positions_.begin(), positions_.end(),
+                                     std::make_pair(segment_id, uint64_t{0}));
+    if (it == positions_.end() || it->first != segment_id) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  std::vector<std::shared_ptr<const LabelTier>> tiers_;
+  std::vector<uint64_t> segments_;
+  std::vector<std::pair<uint64_t, uint64_t>> positions_;  // (segment id, position), by id
+  uint64_t live_count_ = 0;
+};
+
+}  // namespace alaya::disk
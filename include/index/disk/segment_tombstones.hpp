@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "utils/platform_fs.hpp"
+
+namespace alaya::disk {
+
+static_assert(std::endian::native == std::endian::little,
+              "SegmentTombstones on-disk format assumes little-endian host");
+
+// Deleted-row bitmap for one immutable disk segment. Bit `row` refers to the
+// row's position in the segment's ids file, so engines filter on the internal
+// id they already have in hand. A segment never grows, so the word array is
+// sized once and never moves: searches read bits lock-free while
+// DiskCollection::mark_deleted sets them under the collection's delete lock.
+//
+// Persisted as `tombstones.bin` next to the ids file, in the same
+// [magic | n_words | words] layout as diskann::TombstoneBitmap. A missing
+// file means no row of the segment has been deleted.
+class SegmentTombstones {
+ public:
+  static constexpr uint64_t kMagic = 0x414C5954424D5031ULL;  // "ALYTBMP1"
+  static constexpr const char *kFileName = "tombstones.bin";
+
+  explicit SegmentTombstones(uint64_t rows) : rows_(rows), words_((rows + 63) / 64) {}
+
+  SegmentTombstones(const SegmentTombstones &) = delete;
+  auto operator=(const SegmentTombstones &) -> SegmentTombstones & = delete;
+  SegmentTombstones(SegmentTombstones &&) = delete;
+  auto operator=(SegmentTombstones &&) -> SegmentTombstones & = delete;
+  ~SegmentTombstones() = default;
+
+  auto rows() const -> uint64_t { return rows_; }
+  auto count() const -> uint64_t { return count_.load(std::memory_order_relaxed); }
+  auto any() const -> bool { return count() != 0; }
+
+  auto is_deleted(uint64_t row) const -> bool {
+    return ((words_[row >> 6].load(std::memory_order_relaxed) >> (row & 63)) & uint64_t{1}) != 0;
+  }
+
+  // Returns true when the row was live before the call.
+  auto set(uint64_t row) -> bool {
+    if (row >= rows_) {
+      throw std::out_of_range("SegmentTombstones: row " + std::to_string(row) +
+                              " outside segment of " + std::to_string(rows_) + " rows");
+    }
+    const uint64_t mask = uint64_t{1} << (row & 63);
+    const uint64_t old = words_[row >> 6].fetch_or(mask, std::memory_order_relaxed);
+    if ((old & mask) != 0) {
+      return false;
+    }
+    count_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Load `seg_dir`/tombstones.bin if present. The deleted count is recomputed
+  // by popcount rather than trusted from disk.
+  void load(const std::filesystem::path &seg_dir) {
+    const auto path = seg_dir / kFileName;
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+      return;
+    }
+    std::ifstream in(path, std::ios::binary);
+    uint64_t header[2] = {0, 0};
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+    if (!in || header[0] != kMagic) {
+      throw std::runtime_error("SegmentTombstones: bad magic or truncated header in " +
+                               path.string());
+    }
+    if (header[1] != words_.size()) {
+      throw std::runtime_error("SegmentTombstones: " + path.string() + " holds " +
+                               std::to_string(header[1]) + " words but the segment needs " +
+                               std::to_string(words_.size()));
+    }
+    std::vector<uint64_t> buf(words_.size());
+    in.read(reinterpret_cast<char *>(buf.data()),
+            static_cast<std::streamsize>(buf.size() * sizeof(uint64_t)));
+    if (!in) {
+      throw std::runtime_error("SegmentTombstones: words truncated in " + path.string());
+    }
+    if (!buf.empty() && (rows_ & 63) != 0 && (buf.back() >> (rows_ & 63)) != 0) {
+      throw std::runtime_error("SegmentTombstones: bit set past the last row in " + path.string());
+    }
+    uint64_t recount = 0;
+    for (size_t w = 0; w < buf.size(); ++w) {
+      words_[w].store(buf[w], std::memory_order_relaxed);
+      recount += static_cast<uint64_t>(std::popcount(buf[w]));
+    }
+    count_.store(recount, std::memory_order_relaxed);
+  }
+
+  // Durably replace `seg_dir`/tombstones.bin: write a temp file, fsync,
+  // rename over the old bitmap, then fsync the directory.
+  void save(const std::filesystem::path &seg_dir) const {
+    std::vector<uint64_t> blob(2 + words_.size());
+    blob[0] = kMagic;
+    blob[1] = words_.size();
+    for (size_t w = 0; w < words_.size(); ++w) {
+      blob[2 + w] = words_[w].load(std::memory_order_relaxed);
+    }
+    const auto tmp = seg_dir / (std::string(kFileName) + ".tmp." +
+                                std::to_string(::alaya::platform::get_pid()));
+    ::alaya::platform::write_all_fsync(tmp, blob.data(), blob.size() * sizeof(uint64_t));
+    ::alaya::platform::atomic_replace(tmp, seg_dir / kFileName);
+    ::alaya::platform::sync_directory_or_throw(seg_dir);
+  }
+
+ private:
+  const uint64_t rows_;
+  std::vector<std::atomic<uint64_t>> words_;
+  std::atomic<uint64_t> count_{0};
+};
+
+namespace detail {
+
+// First candidate count to ask an approximate engine for so that, once the
+// tombstoned hits are dropped, top_k live hits are likely to remain: top_k
+// scaled by the segment's live fraction plus a small slack. Engines double
+// it and retry when a query still comes up short.
+inline auto tombstone_overfetch(uint64_t top_k, uint64_t rows, uint64_t deleted) -> uint64_t {
+  if (deleted == 0 || deleted >= rows) {
+    return std::min(top_k, rows);
+  }
+  const uint64_t live = rows - deleted;
+  const uint64_t scaled = (top_k * rows + live - 1) / live;
+  return std::min(scaled + 8, rows);
+}
+
+}  // namespace detail
+}  // namespace alaya::disk
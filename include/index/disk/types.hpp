@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cmath>
 #include <cstdint>
 #include <stdexcept>
 #include <string>
@@ -25,6 +26,10 @@ struct DiskSearchOptions {
   uint32_t ef = 100;
   uint32_t beam_width = 4;
   bool exact_rerank = true;
+  // DiskCollection::search: number of workers that search a multi-segment
+  // collection's segments concurrently for one query. 1 keeps the serial
+  // segment loop; results are identical either way.
+  uint32_t segment_parallelism = 1;
 };
 
 // Distance contract by metric (smaller-is-better in all three):
@@ -40,15 +45,49 @@ struct DiskSearchHit {
   float distance;
 };
 
+namespace detail {
+
+// Hit order shared by every search source and the cross-source merge:
+// ascending distance with NaN last, ties broken by label by the caller.
+inline auto disk_search_distance_less(float a, float b) -> bool {
+  const bool a_nan = std::isnan(a);
+  const bool b_nan = std::isnan(b);
+  if (a_nan || b_nan) {
+    return !a_nan && b_nan;
+  }
+  return a < b;
+}
+
+inline auto disk_search_distance_equal_for_order(float a, float b) -> bool {
+  return (std::isnan(a) && std::isnan(b)) || a == b;
+}
+
+}  // namespace detail
+
+class SegmentTombstones;
+
 class SegmentSearcher {
  public:
   virtual ~SegmentSearcher() = default;
 
   virtual auto search(const float *query, const DiskSearchOptions &opts) const
       -> std::vector<DiskSearchHit> = 0;
+  // Same contract as search(), but writes into `out` (cleared first) so hot
+  // callers can keep one buffer alive across queries. Engines that can fill
+  // the caller's storage directly override this; the default copies.
+  virtual void search_into(const float *query,
+                           const DiskSearchOptions &opts,
+                           std::vector<DiskSearchHit> &out) const {
+    const auto hits = search(query, opts);
+    out.assign(hits.begin(), hits.end());
+  }
+  // Physical row count, deleted rows included.
   virtual auto size() const -> uint64_t = 0;
   virtual auto dim() const -> uint32_t = 0;
   virtual auto type() const -> DiskIndexType = 0;
+  // Deleted-row bitmap that search() filters against, or nullptr for an
+  // engine that cannot drop rows. DiskCollection::mark_deleted sets bits in it.
+  virtual auto tombstones() const -> SegmentTombstones * { return nullptr; }
 };
 
 constexpr auto index_type_to_string(DiskIndexType t) noexcept -> std::string_view {
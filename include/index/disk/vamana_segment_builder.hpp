@@ -6,6 +6,7 @@
 
 #include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -46,9 +47,11 @@ struct VamanaSegmentBuildParams {
 // containing `manifest.txt`, `ids.u64.bin`, `vectors.f32.bin`, and
 // `graph.index`. Wraps `alaya::vamana::VamanaBuilder` + `save_graph`.
 //
-// v1 metric scope: L2 only. `finish()` rejects `IP` / `COS` before any
-// filesystem mutation so direct builder callers can construct the object and
-// still observe the atomic-publish precondition.
+// Metrics: L2, IP and COS. Under COS the rows are unit-normalized at build
+// time (same rule as DiskFlatBuilder: a zero-magnitude row is rejected) and
+// `vectors.f32.bin` stores the normalized rows, so the searcher only has to
+// normalize the query. `finish()` rejects any other metric before any
+// filesystem mutation.
 //
 // Lifecycle: construct → add_batch* → finish(seg_dir) → SegmentManifest.
 // `finish` is single-shot; subsequent calls throw.
@@ -111,6 +114,9 @@ class VamanaSegmentBuilder {
       throw std::runtime_error(
           "VamanaSegmentBuilder: finish called with zero rows (count=0 is rejected by manifest)");
     }
+    const std::vector<float> normalized =
+        metric_ == MetricType::COS ? normalized_rows() : std::vector<float>{};
+    const std::vector<float> &rows = metric_ == MetricType::COS ? normalized : pending_vectors_;
 
     // Step 1 — path validation. Same shape as DiskFlatBuilder::finish.
     const auto parent = seg_dir.parent_path();
@@ -167,19 +173,20 @@ class VamanaSegmentBuilder {
     detail::write_all_fsync(tmp_dir / "ids.u64.bin",
                             pending_labels_.data(),
                             pending_labels_.size() * sizeof(uint64_t));
-    detail::write_all_fsync(tmp_dir / "vectors.f32.bin",
-                            pending_vectors_.data(),
-                            pending_vectors_.size() * sizeof(float));
+    detail::write_all_fsync(tmp_dir / "vectors.f32.bin", rows.data(), rows.size() * sizeof(float));
 
-    // Step 4 — graph build. VamanaBuilder borrows `pending_vectors_.data()`
-    // for the duration of build(); the buffer outlives the builder.
+    // Step 4 — graph build. VamanaBuilder borrows `rows.data()` for the
+    // duration of build(); the buffer outlives the builder. COS rows are
+    // already unit length, where the L2 graph is the cosine graph, so they
+    // are built as L2 rather than normalized a second time.
     alaya::vamana::VamanaBuildParams vp;
     vp.R = params_.R;
     vp.L = params_.L;
     vp.alpha = params_.alpha;
     vp.num_threads = params_.num_threads;
     vp.seed = params_.seed;
-    alaya::vamana::VamanaBuilder gb(pending_vectors_.data(), pending_labels_.size(), dim_, vp);
+    vp.metric = metric_ == MetricType::IP ? MetricType::IP : MetricType::L2;
+    alaya::vamana::VamanaBuilder gb(rows.data(), pending_labels_.size(), dim_, vp);
     gb.build();
 
     // Step 5 — graph file. `save_graph` does NOT fsync the file; we open it
@@ -229,13 +236,33 @@ class VamanaSegmentBuilder {
 
  private:
   auto ensure_metric_supported() const -> void {
-    if (metric_ == MetricType::L2) {
+    if (metric_ == MetricType::L2 || metric_ == MetricType::IP || metric_ == MetricType::COS) {
       return;
     }
-    const std::string m =
-        (metric_ == MetricType::IP) ? "ip" : ((metric_ == MetricType::COS) ? "cos" : "unknown");
-    throw std::runtime_error("VamanaSegmentBuilder: metric '" + m +
-                             "' not implemented in v1 (vamana adapter v1 supports L2 only)");
+    throw std::runtime_error("VamanaSegmentBuilder: metric must be one of L2, IP, COS");
+  }
+
+  // Unit-normalized copy of the pending rows for COS.
+  auto normalized_rows() const -> std::vector<float> {
+    std::vector<float> out(pending_vectors_.size());
+    const uint64_t count = pending_labels_.size();
+    for (uint64_t r = 0; r < count; ++r) {
+      const float *src = pending_vectors_.data() + r * dim_;
+      float *dst = out.data() + r * dim_;
+      double sum_sq = 0.0;
+      for (uint32_t c = 0; c < dim_; ++c) {
+        sum_sq += static_cast<double>(src[c]) * static_cast<double>(src[c]);
+      }
+      if (sum_sq == 0.0) {
+        throw std::invalid_argument(
+            "VamanaSegmentBuilder: zero-magnitude vector under COS at row " + std::to_string(r));
+      }
+      const double inv_norm = 1.0 / std::sqrt(sum_sq);
+      for (uint32_t c = 0; c < dim_; ++c) {
+        dst[c] = static_cast<float>(static_cast<double>(src[c]) * inv_norm);
+      }
+    }
+    return out;
   }
 
   static auto fsync_regular_file(const std::filesystem::path &path) -> void {
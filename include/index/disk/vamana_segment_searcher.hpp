@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "index/disk/segment_manifest.hpp"
+#include "index/disk/segment_tombstones.hpp"
 #include "index/disk/types.hpp"
 #include "index/graph/vamana/vamana_greedy_search.hpp"
 #include "index/graph/vamana/vamana_reader.hpp"
@@ -55,11 +56,12 @@ inline auto is_neg_query_f32(float value) -> bool {
 // All I/O happens in the constructor (manifest parse, mmap of vectors / ids,
 // graph load, greedy-search wiring). After construction, `search()` performs
 // no `open(2)`, no manifest parsing, no mmap rebuild — the per-neighbor
-// distance loop runs inside `VamanaGreedySearch` whose L2 kernel is held as
-// a `simd::L2SqrFunc` function pointer.
+// distance loop runs inside `VamanaGreedySearch` whose kernel is held as a
+// function pointer.
 //
-// v1: L2 only. The constructor rejects `IP` / `COS` manifests with the
-// same dual-substring contract used by the rest of the disk subsystem.
+// Metrics: L2, IP and COS, reported the same way as DiskFlatSegmentSearcher
+// (squared L2, or negated inner product). COS segments store unit rows, so
+// only the query is normalized here.
 class VamanaSegmentSearcher : public SegmentSearcher {
  public:
   explicit VamanaSegmentSearcher(const std::filesystem::path &seg_dir)
@@ -84,15 +86,12 @@ class VamanaSegmentSearcher : public SegmentSearcher {
                                std::to_string(manifest_.count) + ") in segment " +
                                seg_dir.string());
     }
-    // Step 2 — v1 metric scope. IP / COS surface here with the dual-substring
-    // contract before any mmap so an unsupported-metric manifest produces no
-    // observable side effects (matching the spec's pre-IO promise).
-    if (manifest_.metric != MetricType::L2) {
-      const std::string m = (manifest_.metric == MetricType::IP)    ? "ip"
-                            : (manifest_.metric == MetricType::COS) ? "cos"
-                                                                    : "unknown";
-      throw std::runtime_error("VamanaSegmentSearcher: metric '" + m +
-                               "' not implemented in v1 (vamana adapter v1 supports L2 only) in "
+    // Step 2 — metric scope, checked before any mmap so an unsupported-metric
+    // manifest produces no observable side effects (matching the spec's
+    // pre-IO promise).
+    if (manifest_.metric != MetricType::L2 && manifest_.metric != MetricType::IP &&
+        manifest_.metric != MetricType::COS) {
+      throw std::runtime_error("VamanaSegmentSearcher: metric must be one of L2, IP, COS in "
                                "segment " +
                                seg_dir.string());
     }
@@ -170,7 +169,12 @@ class VamanaSegmentSearcher : public SegmentSearcher {
         std::make_unique<alaya::vamana::VamanaGreedySearch>(*reader_,
                                                             static_cast<const float *>(
                                                                 vectors_mmap_.data()),
-                                                            static_cast<uint32_t>(manifest_.dim));
+                                                            static_cast<uint32_t>(manifest_.dim),
+                                                            manifest_.metric);
+
+    // Step 8 — deleted rows (graph node id == row in the ids file).
+    tombstones_ = std::make_unique<SegmentTombstones>(manifest_.count);
+    tombstones_->load(seg_dir);
   }
 
   VamanaSegmentSearcher(const VamanaSegmentSearcher &) = delete;
@@ -181,6 +185,16 @@ class VamanaSegmentSearcher : public SegmentSearcher {
 
   auto search(const float *query, const DiskSearchOptions &opts) const
       -> std::vector<DiskSearchHit> override {
+    std::vector<DiskSearchHit> hits;
+    search_into(query, opts, hits);
+    return hits;
+  }
+
+  // Greedy hits land in a per-thread buffer and labels are written straight
+  // into `out`, so a reused buffer makes the query path allocation-free.
+  void search_into(const float *query,
+                   const DiskSearchOptions &opts,
+                   std::vector<DiskSearchHit> &out) const override {
     if (opts.top_k == 0) {
       throw std::invalid_argument("VamanaSegmentSearcher: top_k must be > 0");
     }
@@ -202,34 +216,61 @@ class VamanaSegmentSearcher : public SegmentSearcher {
             std::to_string(c) + " (" + kind + ")");
       }
     }
+    if (manifest_.metric == MetricType::COS &&
+        std::all_of(query, query + d, [](float v) { return v == 0.0F; })) {
+      throw std::invalid_argument(
+          "VamanaSegmentSearcher: zero-magnitude query under COS metric");
+    }
     const auto count = static_cast<uint32_t>(reader_->num_nodes());
     const auto effective_top_k = static_cast<uint32_t>(
         std::min<uint64_t>(static_cast<uint64_t>(opts.top_k), static_cast<uint64_t>(count)));
-    auto effective_ef = static_cast<uint32_t>(
+    const auto base_ef = static_cast<uint32_t>(
         std::min<uint64_t>(static_cast<uint64_t>(opts.ef), static_cast<uint64_t>(count)));
-    effective_ef = std::max(effective_ef, effective_top_k);
-    // Forward to VamanaGreedySearch — no additional file open, no manifest
-    // parse, no mmap rebuild, no metric-string-to-enum lookup. The per-neighbor
-    // distance kernel inside greedy search is a `simd::L2SqrFunc` function
-    // pointer; the only virtual call on this path is the SegmentSearcher
-    // boundary (one per query per segment).
-    auto greedy_hits = greedy_search_->search(query, effective_top_k, effective_ef);
 
-    // Internal-id → external-label conversion: a single sequential sweep over
-    // the result vector after greedy search returns. The ids mmap is accessed
-    // exactly once per hit, with no re-entry into VamanaGreedySearch.
+    // Deleted nodes still route the walk but must not be returned, so ask
+    // for enough extra candidates to cover them and widen until top_k live
+    // hits survive or the whole segment has been requested.
+    const SegmentTombstones *deleted = tombstones_->any() ? tombstones_.get() : nullptr;
+    auto fetch_k = deleted == nullptr
+                       ? effective_top_k
+                       : static_cast<uint32_t>(
+                             detail::tombstone_overfetch(effective_top_k, count, deleted->count()));
+
     const auto *ids = static_cast<const uint64_t *>(ids_mmap_.data());
-    std::vector<DiskSearchHit> out;
-    out.reserve(greedy_hits.size());
-    for (const auto &hit : greedy_hits) {
-      out.push_back(DiskSearchHit{ids[hit.id], hit.distance});
+    thread_local std::vector<alaya::vamana::GreedyHit> greedy_hits;
+    for (;;) {
+      const uint32_t effective_ef = std::max(base_ef, fetch_k);
+      // Forward to VamanaGreedySearch — no additional file open, no manifest
+      // parse, no mmap rebuild, no metric-string-to-enum lookup. The
+      // per-neighbor distance kernel inside greedy search is a plain
+      // function pointer; the only virtual call on this
+      // path is the SegmentSearcher boundary (one per query per segment).
+      greedy_search_->search_into(query, fetch_k, effective_ef, greedy_hits);
+
+      // Internal-id → external-label conversion: a single sequential sweep
+      // over the result vector after greedy search returns.
+      out.clear();
+      out.reserve(effective_top_k);
+      for (const auto &hit : greedy_hits) {
+        if (deleted != nullptr && deleted->is_deleted(hit.id)) {
+          continue;
+        }
+        out.push_back(DiskSearchHit{ids[hit.id], hit.distance});
+        if (out.size() == effective_top_k) {
+          break;
+        }
+      }
+      if (deleted == nullptr || out.size() == effective_top_k || fetch_k >= count) {
+        return;
+      }
+      fetch_k = static_cast<uint32_t>(std::min<uint64_t>(uint64_t{fetch_k} * 2, count));
     }
-    return out;
   }
 
   auto size() const -> uint64_t override { return manifest_.count; }
   auto dim() const -> uint32_t override { return static_cast<uint32_t>(manifest_.dim); }
   auto type() const -> DiskIndexType override { return DiskIndexType::Vamana; }
+  auto tombstones() const -> SegmentTombstones * override { return tombstones_.get(); }
 
  private:
   static constexpr uint64_t kMaxDim = static_cast<uint64_t>(UINT32_MAX);
@@ -266,6 +307,7 @@ class VamanaSegmentSearcher : public SegmentSearcher {
   //   greedy_search_ → declared LAST → destroyed FIRST so the borrowed
   //                    references survive its lifetime
   SegmentManifest manifest_;
+  std::unique_ptr<SegmentTombstones> tombstones_;
   alaya::storage::MMapFile vectors_mmap_;
   alaya::storage::MMapFile ids_mmap_;
   std::unique_ptr<alaya::vamana::VamanaReader> reader_;
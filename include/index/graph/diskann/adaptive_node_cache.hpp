@@ -0,0 +1,424 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+/**
+ * @file adaptive_node_cache.hpp
+ * @brief Frequency-aware node record cache filled online from beam-search misses.
+ *
+ * The BFS cache (node_cache.hpp) pins the nodes nearest the medoid, which every
+ * search crosses, but skewed query traffic also concentrates on regions far from
+ * the entry point. This cache learns those regions at run time: every device
+ * read a search performs is offered here, and a record is admitted under a fixed
+ * record budget only if it has been visited more often than the entry it would
+ * evict (TinyLFU over a CLOCK victim).
+ *
+ * - Frequencies live in a 4-row count-min sketch of 4-bit saturating counters,
+ *   halved every 10 * capacity increments so old popularity decays.
+ * - Records live in a set-associative table (up to 8 ways per set); each set
+ *   runs its own CLOCK hand. Admission try-locks the set and simply skips the
+ *   offer when another thread holds it, so a search never waits to admit.
+ * - Record bytes live in one slab of capacity * record_len bytes allocated up
+ *   front; admission copies the record into its way's slot, so the steady
+ *   state allocates nothing.
+ * - Lookups scan the set's atomic tags without locking and take only the
+ *   matching way's spinlock to pin it. A pinned way is never chosen as a
+ *   victim, so the record stays intact until the reader drops its Pin.
+ *
+ * save_hot_set() / load_hot_set() persist the resident ids with their estimated
+ * frequencies (hot_cache_ids.bin) so a restarted index can warm the cache.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "utils/locks.hpp"
+
+namespace alaya::diskann {
+
+class AdaptiveNodeCache {
+  struct Way;
+
+ public:
+  /**
+   * @brief A resident record held by a reader.
+   *
+   * While the pin is held its way is not reused for another node, so get()
+   * stays valid. Move-only; must be released before the cache is destroyed
+   * and never held across a coroutine suspension.
+   */
+  class Pin {
+   public:
+    Pin() = default;
+    Pin(Pin &&other) noexcept
+        : record_(std::exchange(other.record_, nullptr)),
+          pins_(std::exchange(other.pins_, nullptr)) {}
+    Pin &operator=(Pin &&other) noexcept {
+      if (this != &other) {
+        release();
+        record_ = std::exchange(other.record_, nullptr);
+        pins_ = std::exchange(other.pins_, nullptr);
+      }
+      return *this;
+    }
+    Pin(const Pin &) = delete;
+    Pin &operator=(const Pin &) = delete;
+    ~Pin() { release(); }
+
+    [[nodiscard]] const char *get() const { return record_; }
+    [[nodiscard]] explicit operator bool() const { return record_ != nullptr; }
+
+   private:
+    friend class AdaptiveNodeCache;
+    Pin(const char *record, std::atomic<uint32_t> *pins) : record_(record), pins_(pins) {}
+
+    void release() {
+      if (pins_ != nullptr) {
+        pins_->fetch_sub(1, std::memory_order_release);
+        pins_ = nullptr;
+        record_ = nullptr;
+      }
+    }
+
+    const char *record_ = nullptr;
+    std::atomic<uint32_t> *pins_ = nullptr;
+  };
+
+  /// One persisted hot-set entry: node id and its sketch frequency at save time.
+  struct HotEntry {
+    uint32_t id;
+    uint32_t freq;
+  };
+
+  static constexpr uint32_t kMaxWays = 8;
+  static constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @param capacity    Maximum resident records (> 0). Rounded down to a whole
+   *                    number of sets.
+   * @param record_len  Bytes per record (the layout's node_len).
+   */
+  AdaptiveNodeCache(uint64_t capacity, uint64_t record_len) : record_len_(record_len) {
+    if (capacity == 0 || record_len == 0) {
+      throw std::invalid_argument("AdaptiveNodeCache: capacity and record_len must be > 0");
+    }
+    if (capacity > kEmpty) {
+      capacity = kEmpty;
+    }
+    ways_ = static_cast<uint32_t>(std::min<uint64_t>(kMaxWays, capacity));
+    n_sets_ = capacity / ways_;
+    sets_ = std::make_unique<Set[]>(n_sets_);
+    slots_ = std::make_unique<Way[]>(n_sets_ * ways_);
+    slab_ = std::make_unique<char[]>(n_sets_ * ways_ * record_len_);
+
+    uint64_t width = 64;
+    while (width < capacity) {
+      width <<= 1;
+    }
+    sketch_mask_ = width - 1;
+    sketch_ = std::make_unique<std::atomic<uint8_t>[]>(kSketchRows * width);
+    for (uint64_t i = 0; i < kSketchRows * width; ++i) {
+      sketch_[i].store(0, std::memory_order_relaxed);
+    }
+    sample_size_ = 10 * n_sets_ * ways_;
+  }
+
+  AdaptiveNodeCache(const AdaptiveNodeCache &) = delete;
+  AdaptiveNodeCache &operator=(const AdaptiveNodeCache &) = delete;
+
+  /**
+   * @brief Largest capacity whose memory_bytes() fits in @p budget_bytes.
+   *
+   * Each record costs its slab bytes, its Way, at most one Set and up to
+   * 2 * kSketchRows sketch counters (the sketch is the next power of two at or
+   * above capacity, and at least 64 counters wide). Returns 0 when not even
+   * one record fits.
+   */
+  static uint64_t capacity_for_budget(uint64_t budget_bytes, uint64_t record_len) {
+    constexpr uint64_t kMinSketchBytes = uint64_t{kSketchRows} * 64;
+    const uint64_t per_record = record_len + sizeof(Way) + sizeof(Set) + 2 * kSketchRows;
+    return budget_bytes > kMinSketchBytes ? (budget_bytes - kMinSketchBytes) / per_record : 0;
+  }
+
+  /// Pinned record for @p id, or an empty Pin. A hit marks the way referenced
+  /// and counts the visit.
+  [[nodiscard]] Pin find(uint32_t id) const {
+    Way *set = set_ways(id);
+    for (uint32_t w = 0; w < ways_; ++w) {
+      Way &way = set[w];
+      if (way.tag.load(std::memory_order_acquire) != id) {
+        continue;
+      }
+      Pin pin;
+      {
+        SpinLockGuard guard(way.lock);
+        if (way.tag.load(std::memory_order_relaxed) == id) {
+          way.pins.fetch_add(1, std::memory_order_relaxed);
+          pin = Pin(slot(way), &way.pins);
+        }
+      }
+      if (pin) {
+        way.referenced.store(1, std::memory_order_relaxed);
+        increment(id);
+        hits_.fetch_add(1, std::memory_order_relaxed);
+      }
+      return pin;
+    }
+    return {};
+  }
+
+  /**
+   * @brief Count a device read of @p id and admit its record if it wins.
+   *
+   * The record is admitted into an empty way, or over the set's CLOCK victim
+   * when the sketch rates @p id strictly more frequent. Non-blocking: returns
+   * false without admitting when another thread is admitting into the same set.
+   */
+  bool admit(uint32_t id, const char *record) {
+    increment(id);
+    return place(id, record, /*force=*/false);
+  }
+
+  /// Warm start: install @p record unconditionally and seed its frequency.
+  void preload(uint32_t id, const char *record, uint32_t freq) {
+    for (uint32_t i = 0; i < std::min<uint32_t>(freq, kMaxCount); ++i) {
+      increment(id);
+    }
+    place(id, record, /*force=*/true);
+  }
+
+  /// Estimated visit count of @p id (minimum over the sketch rows).
+  [[nodiscard]] uint32_t frequency(uint32_t id) const {
+    uint32_t freq = kMaxCount;
+    for (uint32_t row = 0; row < kSketchRows; ++row) {
+      freq = std::min<uint32_t>(freq, counter(row, id).load(std::memory_order_relaxed));
+    }
+    return freq;
+  }
+
+  /// Resident ids with their frequencies, hottest first.
+  [[nodiscard]] std::vector<HotEntry> hot_set() const {
+    std::vector<HotEntry> out;
+    for (uint64_t i = 0; i < n_sets_ * ways_; ++i) {
+      const uint32_t id = slots_[i].tag.load(std::memory_order_acquire);
+      if (id != kEmpty) {
+        out.push_back({id, frequency(id)});
+      }
+    }
+    std::stable_sort(out.begin(), out.end(), [](const HotEntry &a, const HotEntry &b) {
+      return a.freq > b.freq;
+    });
+    return out;
+  }
+
+  /// Write hot_set() as: uint64 count, count * uint32 ids, count * uint32 freqs.
+  void save_hot_set(const std::string &path) const {
+    const std::vector<HotEntry> hot = hot_set();
+    const uint64_t count = hot.size();
+    std::vector<uint32_t> ids(count);
+    std::vector<uint32_t> freqs(count);
+    for (uint64_t i = 0; i < count; ++i) {
+      ids[i] = hot[i].id;
+      freqs[i] = hot[i].freq;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("AdaptiveNodeCache::save_hot_set: cannot open " + path);
+    }
+    out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char *>(ids.data()),
+              static_cast<std::streamsize>(count * sizeof(uint32_t)));
+    out.write(reinterpret_cast<const char *>(freqs.data()),
+              static_cast<std::streamsize>(count * sizeof(uint32_t)));
+    if (!out) {
+      throw std::runtime_error("AdaptiveNodeCache::save_hot_set: write failed for " + path);
+    }
+  }
+
+  /// Read a file written by save_hot_set(), hottest first.
+  static std::vector<HotEntry> load_hot_set(const std::string &path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("AdaptiveNodeCache::load_hot_set: cannot open " + path);
+    }
+    uint64_t count = 0;
+    in.read(reinterpret_cast<char *>(&count), sizeof(count));
+    if (!in || count > kEmpty) {
+      throw std::runtime_error("AdaptiveNodeCache::load_hot_set: bad header in " + path);
+    }
+    std::vector<uint32_t> ids(count);
+    std::vector<uint32_t> freqs(count);
+    in.read(reinterpret_cast<char *>(ids.data()),
+            static_cast<std::streamsize>(count * sizeof(uint32_t)));
+    in.read(reinterpret_cast<char *>(freqs.data()),
+            static_cast<std::streamsize>(count * sizeof(uint32_t)));
+    if (!in) {
+      throw std::runtime_error("AdaptiveNodeCache::load_hot_set: short read of " + path);
+    }
+    std::vector<HotEntry> hot(count);
+    for (uint64_t i = 0; i < count; ++i) {
+      hot[i] = {ids[i], freqs[i]};
+    }
+    return hot;
+  }
+
+  [[nodiscard]] uint64_t capacity() const { return n_sets_ * ways_; }
+  /// Bytes held by the slab, ways, sets and sketch.
+  [[nodiscard]] uint64_t memory_bytes() const {
+    return capacity() * (record_len_ + sizeof(Way)) + n_sets_ * sizeof(Set) +
+           kSketchRows * (sketch_mask_ + 1);
+  }
+  [[nodiscard]] uint64_t size() const {
+    uint64_t count = 0;
+    for (uint64_t i = 0; i < n_sets_ * ways_; ++i) {
+      count += slots_[i].tag.load(std::memory_order_relaxed) != kEmpty ? 1 : 0;
+    }
+    return count;
+  }
+  [[nodiscard]] uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  [[nodiscard]] uint64_t admissions() const {
+    return admissions_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr uint32_t kSketchRows = 4;
+  static constexpr uint8_t kMaxCount = 15;  // 4-bit counters, as in TinyLFU
+  static constexpr std::array<uint64_t, kSketchRows> kSeeds = {
+      0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL};
+
+  struct Way {
+    std::atomic<uint32_t> tag{kEmpty};
+    std::atomic<uint32_t> pins{0};  // readers holding the slot's bytes
+    std::atomic<uint8_t> referenced{0};
+    mutable SpinLock lock;  // guards slot writes, tag changes and new pins
+  };
+
+  struct Set {
+    SpinLock admit_lock;  // one admitter per set; held with try_lock only
+    uint32_t hand = 0;    // CLOCK hand, guarded by admit_lock
+  };
+
+  static uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+  }
+
+  Way *set_ways(uint32_t id) const { return slots_.get() + (mix(id) % n_sets_) * ways_; }
+
+  /// The way's record_len_ bytes in the slab.
+  char *slot(const Way &way) const {
+    return slab_.get() + static_cast<uint64_t>(&way - slots_.get()) * record_len_;
+  }
+
+  std::atomic<uint8_t> &counter(uint32_t row, uint32_t id) const {
+    const uint64_t col = mix(id ^ kSeeds[row]) & sketch_mask_;
+    return sketch_[row * (sketch_mask_ + 1) + col];
+  }
+
+  /// Lossy relaxed increment: a racing update may be lost, which only blurs
+  /// an estimate. Every sample_size_ increments all counters are halved.
+  void increment(uint32_t id) const {
+    for (uint32_t row = 0; row < kSketchRows; ++row) {
+      auto &c = counter(row, id);
+      const uint8_t v = c.load(std::memory_order_relaxed);
+      if (v < kMaxCount) {
+        c.store(static_cast<uint8_t>(v + 1), std::memory_order_relaxed);
+      }
+    }
+    if (additions_.fetch_add(1, std::memory_order_relaxed) + 1 == sample_size_) {
+      for (uint64_t i = 0; i < kSketchRows * (sketch_mask_ + 1); ++i) {
+        sketch_[i].store(static_cast<uint8_t>(sketch_[i].load(std::memory_order_relaxed) >> 1),
+                         std::memory_order_relaxed);
+      }
+      additions_.fetch_sub(sample_size_ / 2, std::memory_order_relaxed);
+    }
+  }
+
+  bool place(uint32_t id, const char *record, bool force) {
+    Set &set = sets_[mix(id) % n_sets_];
+    Way *ways = set_ways(id);
+    std::unique_lock<SpinLock> admit(set.admit_lock, std::defer_lock);
+    if (force) {
+      admit.lock();
+    } else if (!admit.try_lock()) {
+      return false;
+    }
+
+    uint32_t victim = ways_;
+    for (uint32_t w = 0; w < ways_; ++w) {
+      const uint32_t tag = ways[w].tag.load(std::memory_order_relaxed);
+      if (tag == id) {
+        return false;  // already resident
+      }
+      if (tag == kEmpty && victim == ways_) {
+        victim = w;
+      }
+    }
+    if (victim == ways_) {
+      // CLOCK over the unpinned ways: one full sweep clears every reference
+      // bit, so 2 * ways_ steps find a victim unless every way is pinned.
+      for (uint32_t step = 0; step < 2 * ways_ && victim == ways_; ++step) {
+        Way &way = ways[set.hand];
+        set.hand = (set.hand + 1) % ways_;
+        if (way.referenced.exchange(0, std::memory_order_relaxed) == 0 &&
+            way.pins.load(std::memory_order_relaxed) == 0) {
+          victim = static_cast<uint32_t>(&way - ways);
+        }
+      }
+      if (victim == ways_) {
+        return false;
+      }
+      const uint32_t resident = ways[victim].tag.load(std::memory_order_relaxed);
+      if (!force && frequency(id) <= frequency(resident)) {
+        return false;
+      }
+    }
+
+    Way &way = ways[victim];
+    {
+      // New pins are taken under this lock, so once the count reads zero no
+      // reader can see the slot until the new tag is published.
+      SpinLockGuard guard(way.lock);
+      if (way.pins.load(std::memory_order_acquire) != 0) {
+        return false;  // a reader pinned the victim after the sweep
+      }
+      std::memcpy(slot(way), record, record_len_);
+      way.referenced.store(0, std::memory_order_relaxed);
+      way.tag.store(id, std::memory_order_release);
+    }
+    admissions_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  uint64_t record_len_;
+  uint32_t ways_ = 0;
+  uint64_t n_sets_ = 0;
+  std::unique_ptr<Set[]> sets_;
+  std::unique_ptr<Way[]> slots_;
+  std::unique_ptr<char[]> slab_;  // capacity() * record_len_ bytes, one slot per way
+  std::unique_ptr<std::atomic<uint8_t>[]> sketch_;
+  uint64_t sketch_mask_ = 0;
+  uint64_t sample_size_ = 0;
+  mutable std::atomic<uint64_t> additions_{0};
+  mutable std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> admissions_{0};
+};
+
+}  // namespace alaya::diskann
@@ -41,6 +41,11 @@
  *     (up to 2*beam_width in flight), maximising I/O/compute overlap at the cost
  *     of strict-greedy ordering (only tie-ordering of equally-distant nodes may
  *     differ, not recall).
+ *
+ * Filtered search (SearchContext::filter) works in both modes: the frontier is
+ * also seeded at the filter labels' entry points and still expands non-matching
+ * nodes, while matching nodes are collected into a second L-bounded queue
+ * (ThreadData::filtered) that the results are taken from.
  */
 
 #pragma once
@@ -56,6 +61,7 @@
 
 #include "index/graph/diskann/disk_layout.hpp"
 #include "index/graph/diskann/disk_page_io.hpp"
+#include "index/graph/diskann/label_store.hpp"
 #include "index/graph/diskann/node_cache.hpp"
 #include "index/graph/diskann/pq_table.hpp"
 #include "index/graph/diskann/search_scratch.hpp"
@@ -95,6 +101,9 @@ struct SearchContext {
   // read pages back through the versioned fill protocol. nullptr keeps the
   // static-index behavior: BFS cache + device reads only.
   DiskPageIO *page_io = nullptr;
+
+  // Filtered search: only nodes the filter matches are returned (null = unfiltered).
+  const LabelFilter *filter = nullptr;
 };
 
 /// Optional instrumentation for tests / profiling.
@@ -120,6 +129,7 @@ struct SearchStats {
  *
  * The frontier's bounded insert prunes neighbors that cannot beat the current
  * worst entry. Already-visited neighbors and out-of-range ids are skipped.
+ * With a @p filter, the matching neighbors are also offered to @p matches.
  * Extracted as a free function so the contract is unit-testable in isolation.
  */
 inline void scan_and_insert_neighbors(alaya::vamana::NeighborPriorityQueue &retset,
@@ -129,7 +139,9 @@ inline void scan_and_insert_neighbors(alaya::vamana::NeighborPriorityQueue &rets
                                       const PQTable &pq,
                                       const float *pq_table,
                                       uint64_t num_points,
-                                      const TombstoneSnapshot *tombstone = nullptr) {
+                                      const TombstoneSnapshot *tombstone = nullptr,
+                                      const LabelFilter *filter = nullptr,
+                                      alaya::vamana::NeighborPriorityQueue *matches = nullptr) {
   // Filter first, then score all survivors with one batched PQ pass
   // (pq_distance_batch): per-neighbor pq_distance() stalls on a dependent
   // random 32 B code fetch per call — the eval hot spot at 100M scale. The
@@ -143,6 +155,9 @@ inline void scan_and_insert_neighbors(alaya::vamana::NeighborPriorityQueue &rets
     pq.pq_distance_batch(ids, cnt, pq_table, dists);
     for (uint32_t i = 0; i < cnt; ++i) {
       retset.insert(alaya::vamana::Neighbor(ids[i], dists[i]));
+      if (filter != nullptr && filter->matches(ids[i])) {
+        matches->insert(alaya::vamana::Neighbor(ids[i], dists[i]));
+      }
     }
     cnt = 0;
   };
@@ -201,12 +216,16 @@ inline std::vector<std::pair<uint32_t, float>> disk_greedy_search(const SearchCo
   td.reset_query(list_size);
   auto &frontier = td.retset;
   auto &visited = td.visited_bits;
+  const LabelFilter *filter = ctx.filter;
 
   // Absorb a freshly-read node: cache its neighbor list and insert it into the
   // frontier with its exact L2 distance (coords are co-located in the record).
   auto absorb = [&](uint32_t id, const char *rec) {
     NodeRecordView view{rec, dim};
     const float distance = l2(query, view.coords(), dim);
+    if (filter != nullptr && filter->matches(id)) {
+      td.filtered.insert(alaya::vamana::Neighbor(id, distance));
+    }
     const auto insert_result = frontier.insert_with_result(alaya::vamana::Neighbor(id, distance));
     if (insert_result.evicted) {
       td.release_cached_neighbors(insert_result.evicted_id);
@@ -254,6 +273,7 @@ inline std::vector<std::pair<uint32_t, float>> disk_greedy_search(const SearchCo
     if (stats != nullptr) {
       stats->n_ios++;
     }
+    cache.observe_miss(id, td.sector_scratch + geom.offset_to_node(id));
     return td.sector_scratch + geom.offset_to_node(id);
   };
 
@@ -271,6 +291,13 @@ inline std::vector<std::pair<uint32_t, float>> disk_greedy_search(const SearchCo
 
   visited.set(ctx.medoid);
   absorb(ctx.medoid, read_seed(ctx.medoid));
+  if (filter != nullptr) {
+    for (const uint32_t ep : filter->entry_points()) {
+      consider(ep, [&](uint32_t id) {
+        absorb(id, read_seed(id));
+      });
+    }
+  }
 
   std::vector<AlignedRead> reqs;
 
@@ -343,6 +370,10 @@ inline std::vector<std::pair<uint32_t, float>> disk_greedy_search(const SearchCo
           if (stats != nullptr) {
             stats->n_ios += reqs.size();
           }
+          for (const auto &req : reqs) {
+            const auto id = static_cast<uint32_t>(req.id);
+            cache.observe_miss(id, static_cast<char *>(req.buf) + geom.offset_to_node(id));
+          }
         }
         for (size_t j = 0; j < chunk_ids.size(); ++j) {
           absorb(chunk_ids[j], chunk_recs[j]);
@@ -443,6 +474,7 @@ inline std::vector<std::pair<uint32_t, float>> disk_greedy_search(const SearchCo
                                       td.sector_scratch + completed.page_slot * page_size,
                                       td.slot_versions[completed.page_slot]);
           }
+          cache.observe_miss(static_cast<uint32_t>(e.id), completed.record);
           absorb(static_cast<uint32_t>(e.id), completed.record);
           free_slots.push_back(completed.page_slot);
         }
@@ -452,14 +484,15 @@ inline std::vector<std::pair<uint32_t, float>> disk_greedy_search(const SearchCo
     }
   }
 
+  const auto &ranked = filter != nullptr ? td.filtered : frontier;
   std::vector<std::pair<uint32_t, float>> out;
-  out.reserve(std::min<size_t>(frontier.size(), top_k));
-  for (size_t i = 0; i < frontier.size() && out.size() < top_k; ++i) {
-    const uint32_t id = frontier[i].id;
+  out.reserve(std::min<size_t>(ranked.size(), top_k));
+  for (size_t i = 0; i < ranked.size() && out.size() < top_k; ++i) {
+    const uint32_t id = ranked[i].id;
     if (tomb != nullptr && tomb->is_deleted(id)) {
       continue;
     }
-    out.emplace_back(id, frontier[i].distance);
+    out.emplace_back(id, ranked[i].distance);
   }
   return out;
 }
@@ -499,9 +532,26 @@ inline std::vector<std::pair<uint32_t, float>> cached_beam_search(const SearchCo
   pq.preprocess_query(query, td.pq_table.data(), td.pq_qres.data());
   const float *pq_table = td.pq_table.data();
 
-  // Seed from the medoid (first node expanded — spec scenario).
+  // Seed from the medoid (first node expanded — spec scenario), plus the filter
+  // labels' entry points for a filtered search.
+  const LabelFilter *filter = ctx.filter;
+  auto seed = [&](uint32_t id) {
+    const alaya::vamana::Neighbor nbr(id, pq.pq_distance(id, pq_table));
+    retset.insert(nbr);
+    if (filter != nullptr && filter->matches(id)) {
+      td.filtered.insert(nbr);
+    }
+  };
   visited.set(ctx.medoid);
-  retset.insert(alaya::vamana::Neighbor(ctx.medoid, pq.pq_distance(ctx.medoid, pq_table)));
+  seed(ctx.medoid);
+  if (filter != nullptr) {
+    for (const uint32_t ep : filter->entry_points()) {
+      if (ep < ctx.num_points && (ctx.tombstone == nullptr || !ctx.tombstone->is_deleted(ep)) &&
+          visited.test_and_set(ep)) {
+        seed(ep);
+      }
+    }
+  }
 
   const uint64_t beam = std::max<uint64_t>(1, params.beam_width);
 
@@ -523,7 +573,9 @@ inline std::vector<std::pair<uint32_t, float>> cached_beam_search(const SearchCo
                               pq,
                               pq_table,
                               ctx.num_points,
-                              ctx.tombstone);
+                              ctx.tombstone,
+                              filter,
+                              &td.filtered);
     if (stats != nullptr) {
       stats->proc_us += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
                                                   std::chrono::steady_clock::now() - tp0)
@@ -606,6 +658,10 @@ inline std::vector<std::pair<uint32_t, float>> cached_beam_search(const SearchCo
                                       td.io_req_versions[r]);
           }
         }
+        for (const auto &req : reqs) {
+          const auto id = static_cast<uint32_t>(req.id);
+          cache.observe_miss(id, static_cast<char *>(req.buf) + geom.offset_to_node(id));
+        }
       }
 
       for (size_t i = 0; i < batch.size(); ++i) {
@@ -716,6 +772,7 @@ inline std::vector<std::pair<uint32_t, float>> cached_beam_search(const SearchCo
                                           .count());
           }
         }
+        cache.observe_miss(static_cast<uint32_t>(e.id), completed.record);
         process_node(static_cast<uint32_t>(e.id), completed.record);
         free_slots.push_back(completed.page_slot);
       }
@@ -758,13 +815,15 @@ inline std::vector<std::pair<uint32_t, float>> cached_beam_search(const SearchCo
     return ex;
   };
 
+  // A filtered search ranks only the matching nodes it met.
+  const auto &ranked = filter != nullptr ? td.filtered : retset;
   if (params.rerank) {
     // Re-score the top PQ candidates with exact L2.
     const size_t want =
         params.rerank_count > 0 ? params.rerank_count : static_cast<size_t>(top_k) * 3;
-    out.reserve(std::min<size_t>(retset.size(), want));
-    for (size_t i = 0; i < retset.size() && out.size() < want; ++i) {
-      const uint32_t id = retset[i].id;
+    out.reserve(std::min<size_t>(ranked.size(), want));
+    for (size_t i = 0; i < ranked.size() && out.size() < want; ++i) {
+      const uint32_t id = ranked[i].id;
       if (!is_live(id)) {
         continue;
       }
@@ -772,14 +831,14 @@ inline std::vector<std::pair<uint32_t, float>> cached_beam_search(const SearchCo
     }
   } else {
     // Top candidates ranked by PQ distance (exact where known during traversal).
-    out.reserve(std::min<size_t>(retset.size(), static_cast<size_t>(top_k)));
-    for (size_t i = 0; i < retset.size() && out.size() < top_k; ++i) {
-      const uint32_t id = retset[i].id;
+    out.reserve(std::min<size_t>(ranked.size(), static_cast<size_t>(top_k)));
+    for (size_t i = 0; i < ranked.size() && out.size() < top_k; ++i) {
+      const uint32_t id = ranked[i].id;
       if (!is_live(id)) {
         continue;
       }
       const float exact = td.exact_dist(id);
-      out.emplace_back(id, !ThreadData::is_missing_exact(exact) ? exact : retset[i].distance);
+      out.emplace_back(id, !ThreadData::is_missing_exact(exact) ? exact : ranked[i].distance);
     }
   }
 
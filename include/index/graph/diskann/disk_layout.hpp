@@ -198,6 +198,104 @@ struct WriteDiskLayoutParams {
   uint32_t medoid = 0;
 };
 
+/**
+ * @brief Streaming writer for a sector-aligned disk index file.
+ *
+ * Nodes are appended in id order, one record at a time, and packed into pages
+ * that are flushed as they fill, so peak memory is a single page regardless
+ * of @c num_points. This is what lets the out-of-core build write the layout
+ * straight from a merged on-disk graph and a streamed vector file.
+ */
+class DiskLayoutWriter {
+ public:
+  /**
+   * @brief Open @p path (truncating it) and write the header sector.
+   * @throws std::invalid_argument if params are inconsistent.
+   * @throws std::runtime_error if the file cannot be opened.
+   */
+  DiskLayoutWriter(const std::string &path, const WriteDiskLayoutParams &params)
+      : path_(path), params_(params) {
+    if (params.dim == 0) {
+      throw std::invalid_argument("write_disk_layout: dim must be > 0");
+    }
+    if (params.num_points == 0) {
+      throw std::invalid_argument("write_disk_layout: num_points must be > 0");
+    }
+    if (params.medoid >= params.num_points) {
+      throw std::invalid_argument("write_disk_layout: medoid out of range");
+    }
+    geom_ = DiskLayoutGeometry::compute(params.dim, params.max_degree);
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_) {
+      throw std::runtime_error("write_disk_layout: cannot open " + path);
+    }
+
+    std::vector<char> header(kSectorLen, 0);
+    detail::put_u64(header.data(), header_offset::kNumPoints, params.num_points);
+    detail::put_u64(header.data(), header_offset::kDim, params.dim);
+    detail::put_u32(header.data(), header_offset::kMedoid, params.medoid);
+    detail::put_u32(header.data(), header_offset::kMaxDegree, params.max_degree);
+    detail::put_u64(header.data(), header_offset::kNodeLen, geom_.node_len);
+    detail::put_u64(header.data(), header_offset::kNodesPerSector, geom_.nodes_per_sector);
+    detail::put_u64(header.data(),
+                    header_offset::kTotalFileSize,
+                    geom_.total_file_size(params.num_points));
+    out_.write(header.data(), static_cast<std::streamsize>(kSectorLen));
+    page_.assign(geom_.page_size, 0);
+  }
+
+  /**
+   * @brief Append the record of the next node id.
+   * @throws std::invalid_argument if @p n_nbrs exceeds max_degree or more than
+   *         num_points nodes are appended.
+   */
+  void append(const float *coords, const uint32_t *nbrs, uint32_t n_nbrs) {
+    if (next_ >= params_.num_points) {
+      throw std::invalid_argument("write_disk_layout: more than num_points nodes appended");
+    }
+    if (n_nbrs > params_.max_degree) {
+      throw std::invalid_argument("write_disk_layout: node " + std::to_string(next_) +
+                                  " degree " + std::to_string(n_nbrs) + " exceeds max_degree " +
+                                  std::to_string(params_.max_degree));
+    }
+    const uint64_t slot = next_ % geom_.nodes_per_sector;
+    if (slot == 0) {
+      std::fill(page_.begin(), page_.end(), char{0});
+    }
+    pack_node_record(page_.data() + slot * geom_.node_len, coords, nbrs, n_nbrs, params_.dim);
+    ++next_;
+    if (slot == geom_.nodes_per_sector - 1 || next_ == params_.num_points) {
+      out_.write(page_.data(), static_cast<std::streamsize>(geom_.page_size));
+    }
+  }
+
+  /**
+   * @brief Flush the file after the last node.
+   * @throws std::invalid_argument if fewer than num_points nodes were appended.
+   * @throws std::runtime_error if any write failed.
+   */
+  void finish() {
+    if (next_ != params_.num_points) {
+      throw std::invalid_argument("write_disk_layout: " + std::to_string(next_) + " of " +
+                                  std::to_string(params_.num_points) + " nodes appended");
+    }
+    out_.flush();
+    if (!out_) {
+      throw std::runtime_error("write_disk_layout: write failed for " + path_);
+    }
+  }
+
+  [[nodiscard]] const DiskLayoutGeometry &geometry() const { return geom_; }
+
+ private:
+  std::string path_;
+  WriteDiskLayoutParams params_;
+  DiskLayoutGeometry geom_;
+  std::ofstream out_;
+  std::vector<char> page_;
+  uint64_t next_ = 0;
+};
+
 /**
  * @brief Pack a graph + vectors into a sector-aligned disk index file.
  *
@@ -217,12 +315,6 @@ inline void write_disk_layout(const std::string &path,
                               const float *vectors,
                               const std::vector<std::vector<uint32_t>> &graph,
                               const WriteDiskLayoutParams &params) {
-  if (params.dim == 0) {
-    throw std::invalid_argument("write_disk_layout: dim must be > 0");
-  }
-  if (params.num_points == 0) {
-    throw std::invalid_argument("write_disk_layout: num_points must be > 0");
-  }
   if (vectors == nullptr) {
     throw std::invalid_argument("write_disk_layout: vectors must not be null");
   }
@@ -230,62 +322,17 @@ inline void write_disk_layout(const std::string &path,
     throw std::invalid_argument("write_disk_layout: graph size (" + std::to_string(graph.size()) +
                                 ") != num_points (" + std::to_string(params.num_points) + ")");
   }
-  if (params.medoid >= params.num_points) {
-    throw std::invalid_argument("write_disk_layout: medoid out of range");
-  }
-
-  const DiskLayoutGeometry geom = DiskLayoutGeometry::compute(params.dim, params.max_degree);
-
-  std::ofstream out(path, std::ios::binary | std::ios::trunc);
-  if (!out) {
-    throw std::runtime_error("write_disk_layout: cannot open " + path);
-  }
-
-  // --- Header sector ---
-  std::vector<char> header(kSectorLen, 0);
-  detail::put_u64(header.data(), header_offset::kNumPoints, params.num_points);
-  detail::put_u64(header.data(), header_offset::kDim, params.dim);
-  detail::put_u32(header.data(), header_offset::kMedoid, params.medoid);
-  detail::put_u32(header.data(), header_offset::kMaxDegree, params.max_degree);
-  detail::put_u64(header.data(), header_offset::kNodeLen, geom.node_len);
-  detail::put_u64(header.data(), header_offset::kNodesPerSector, geom.nodes_per_sector);
-  detail::put_u64(header.data(),
-                  header_offset::kTotalFileSize,
-                  geom.total_file_size(params.num_points));
-  out.write(header.data(), static_cast<std::streamsize>(kSectorLen));
-
-  // --- Node pages ---
-  std::vector<char> page(geom.page_size, 0);
+  DiskLayoutWriter writer(path, params);
   for (uint64_t node_id = 0; node_id < params.num_points; ++node_id) {
-    const uint64_t slot = node_id % geom.nodes_per_sector;
-    if (slot == 0) {
-      std::fill(page.begin(), page.end(), char{0});
-    }
-
-    char *rec = page.data() + slot * geom.node_len;
     const auto &nbrs = graph[node_id];
     if (nbrs.size() > params.max_degree) {
       throw std::invalid_argument("write_disk_layout: node " + std::to_string(node_id) +
                                   " degree " + std::to_string(nbrs.size()) +
                                   " exceeds max_degree " + std::to_string(params.max_degree));
     }
-    pack_node_record(rec,
-                     vectors + node_id * params.dim,
-                     nbrs.data(),
-                     static_cast<uint32_t>(nbrs.size()),
-                     params.dim);
-
-    const bool last_in_page = (slot == geom.nodes_per_sector - 1);
-    const bool last_node = (node_id == params.num_points - 1);
-    if (last_in_page || last_node) {
-      out.write(page.data(), static_cast<std::streamsize>(geom.page_size));
-    }
-  }
-
-  out.flush();
-  if (!out) {
-    throw std::runtime_error("write_disk_layout: write failed for " + path);
+    writer.append(vectors + node_id * params.dim, nbrs.data(), static_cast<uint32_t>(nbrs.size()));
   }
+  writer.finish();
 }
 
 /**
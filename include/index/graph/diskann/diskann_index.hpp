@@ -12,14 +12,29 @@
  * resulting on-disk index. It does not participate in the segment / disk-
  * collection subsystem.
  *
+ * When the in-memory Vamana build would exceed DiskANNBuildParams::build_dram_budget_gb,
+ * build() goes out of core instead: the base (an .fbin, or the caller's vectors
+ * spilled to one) is k-means partitioned into overlapping shards that each fit
+ * the budget, the shard graphs are merged (vamana/build_dispatch.hpp), and the
+ * layout, PQ codes and BFS cache are written by streaming the merged graph and
+ * the base file. Only one block of vectors plus the PQ training sample is
+ * resident outside the shard builds.
+ *
  * On-disk directory:
  *   meta.bin           index metadata (this file's MetaHeader)
  *   diskann.index      sector-aligned graph + vectors (disk_layout.hpp)
  *   ids.bin            internal-id -> external uint64 label map
+ *   labels.bin         per-point filter labels + label entry points (label_store.hpp;
+ *                      filtered builds only)
  *   cache_ids.bin      BFS cache node ids        (node_cache.hpp)
  *   cache_nodes.bin    BFS cache node records
+ *   hot_cache_ids.bin  adaptive cache hot set (adaptive_node_cache.hpp; written by
+ *                      save_adaptive_cache() only)
  *   pq_pivots.bin      PQ global centroid + codebook  (PQ builds only)
  *   pq_compressed.bin  PQ codes                       (PQ builds only)
+ *
+ * IP and COS indexes store their vectors mapped into squared-L2 space
+ * (metric_transform.hpp); meta.bin records the metric and the mapping.
  */
 
 #pragma once
@@ -36,6 +51,9 @@
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
 #include <shared_mutex>
 #include <stdexcept>
 #include <string>
@@ -53,6 +71,8 @@
 #include "index/graph/diskann/disk_layout.hpp"
 #include "index/graph/diskann/disk_page_io.hpp"
 #include "index/graph/diskann/disk_update_context.hpp"
+#include "index/graph/diskann/label_store.hpp"
+#include "index/graph/diskann/metric_transform.hpp"
 #include "index/graph/diskann/node_cache.hpp"
 #include "index/graph/diskann/pq_table.hpp"
 #include "index/graph/diskann/search_scratch.hpp"
@@ -60,11 +80,13 @@
 #include "index/graph/diskann/tombstone_bitmap.hpp"
 #include "index/graph/laser/utils/aligned_file_reader_factory.hpp"
 #include "index/graph/laser/utils/concurrent_queue.hpp"
+#include "index/graph/vamana/build_dispatch.hpp"
 #include "index/graph/vamana/robust_prune.hpp"
 #include "index/graph/vamana/vamana_builder.hpp"
 #include "simd/distance_l2.hpp"
 #include "storage/io/uring_reactor.hpp"
 #include "utils/coro_gate.hpp"
+#include "utils/metric_type.hpp"
 
 namespace alaya::diskann {
 
@@ -85,11 +107,24 @@ struct DiskANNBuildParams {
   ///< touch of an already-full node. The update-time degree bound
   ///< (max_degree) becomes this capacity.
   uint32_t pq_n_chunks = 0;   ///< 0 => no PQ
+  uint32_t pq_code_bits = 8;  ///< 8: 256 centroids per chunk; 4: 16 centroids, two chunks per
+                              ///< byte, scored with the fast-scan (pshufb) kernel. 4-bit
+                              ///< needs pq_n_chunks % 4 == 0; use about 2x the 8-bit chunk
+                              ///< count for similar recall at the same code size.
   double cache_ratio = 0.05;  ///< BFS cache fraction
   uint32_t num_threads = 0;   ///< 0 => all cores (Vamana build + PQ train/encode)
   uint32_t pq_train_iters = 15;
   uint64_t seed = 1234;
   bool verbose = false;  ///< print per-phase build wall-times to stderr
+  MetricType metric = MetricType::L2;  ///< L2, IP (MIPS->L2 augmentation) or COS (normalized)
+  float ip_max_norm = 0.0f;  ///< IP only: augmentation radius floor. The build uses the larger of
+                             ///< this and the longest base vector; inserts longer than it throw
+                             ///< std::invalid_argument, so set it to cover later inserts.
+  float build_dram_budget_gb = 0.0f;
+  ///< Vamana build memory budget in GiB; 0 => unbounded (always build in memory).
+  ///< When the in-memory estimate (vamana/budget_estimator.hpp) exceeds it, the
+  ///< graph is built per k-means shard and merged, and the remaining phases
+  ///< stream from disk. The sharded path requires L >= R.
 };
 
 /// Load-time configuration (sizes the thread-scratch pool).
@@ -100,6 +135,13 @@ enum class DiskANNUpdateIO {
   kBlocking,  ///< pool-thread-blocking preads (the pre-reactor behavior)
 };
 
+/// Query-path page-read backend (the AlignedFileReader behind search()).
+enum class DiskANNSearchIO {
+  kDefault,  ///< the build's LASER reader (libaio on Linux, thread pool / IOCP elsewhere)
+  kUring,    ///< io_uring with the index file registered and each ThreadData's sector
+             ///< scratch as a fixed buffer; load() throws if io_uring is unavailable
+};
+
 struct DiskANNLoadParams {
   uint32_t num_threads = 4;    ///< max concurrent searches (ThreadData pool size)
   uint32_t beam_width = 4;     ///< PQ I/O beam width (PQ caps in-flight reads at this)
@@ -149,6 +191,21 @@ struct DiskANNLoadParams {
   ///< pages it reads — the cache then behaves like Yi's unified buffer pool
   ///< (dynamic LRU shared by searches and updates) instead of a write-only
   ///< view. Off = pre-async behavior: static BFS cache + raw device reads.
+  DiskANNSearchIO search_io = DiskANNSearchIO::kDefault;
+  ///< Query-path reader. kUring reaps completions from the CQ ring in user
+  ///< space, so a pipeline wait only enters the kernel when nothing has landed.
+  bool search_io_sqpoll = false;  ///< kUring: kernel-side submission polling (one shared thread)
+  bool search_io_iopoll = false;  ///< kUring: polled completions; needs NVMe poll queues
+
+  // --- Adaptive node cache (read-only loads) ---
+  uint64_t adaptive_cache_bytes = 0;
+  ///< Memory budget (records plus bookkeeping) for the frequency-aware cache
+  ///< that learns hot nodes from search misses (adaptive_node_cache.hpp), on
+  ///< top of the static BFS cache.
+  ///< 0 disables it. Read-only loads only: updatable indices use the shard page
+  ///< cache (search_page_cache) instead.
+  bool adaptive_cache_warm_start = true;
+  ///< Pre-fill the adaptive cache from hot_cache_ids.bin when the file exists.
 };
 
 /// Per-query search configuration.
@@ -160,13 +217,18 @@ struct DiskANNSearchParams {
   bool deterministic = false;       ///< Reproducible batch==sequential via a per-expansion
                                     ///< barrier (PQ: per-beam; ~10-15% slower). Default off =
                                     ///< async-pipelined I/O. Applies to both PQ and No-PQ.
+  std::vector<uint32_t> filter_labels;
+  ///< Non-empty: return only points carrying at least one of these filter labels
+  ///< ("tenant = X" is one label, "category in {...}" several). Non-matching nodes
+  ///< are still traversed; selective filters need a larger search_list_size.
 };
 
 class DiskANNIndex {
  public:
   static constexpr uint64_t kMetaMagic = 0x414C594144534B4EULL;  // "ALYADSKN"
-  /// v2 adds max_slot_id + live_count for in-place updates; v1 is read back-compat.
-  static constexpr uint32_t kMetaVersion = 2;
+  /// v2 adds max_slot_id + live_count for in-place updates; v3 adds pq_code_bits;
+  /// v4 adds the metric and its L2 mapping. Older versions read back as 8-bit PQ, L2.
+  static constexpr uint32_t kMetaVersion = 4;
   /// Default No-PQ async pipeline depth when DiskANNLoadParams::nopq_io_depth == 0.
   /// Benchmark-tuned on SIFT1M/NVMe (knee at ~32; deeper gives no gain).
   static constexpr uint32_t kDefaultNoPQIoDepth = 32;
@@ -182,6 +244,8 @@ class DiskANNIndex {
   // ------------------------------------------------------------------ build
   /**
    * @brief Build a complete index directory from vectors + external labels.
+   * @param filter_labels optional per-point filter labels (CSR over the n points);
+   *        enables DiskANNSearchParams::filter_labels on the built index.
    * @throws std::invalid_argument for dim==0 / n==0 / null inputs.
    * @throws std::runtime_error if @p index_dir already exists.
    */
@@ -190,7 +254,8 @@ class DiskANNIndex {
                     const uint64_t *labels,
                     uint64_t n,
                     uint64_t dim,
-                    const DiskANNBuildParams &params) {
+                    const DiskANNBuildParams &params,
+                    const FilterLabelsView &filter_labels = {}) {
     if (dim == 0) {
       throw std::invalid_argument("DiskANNIndex::build: dim must be > 0");
     }
@@ -201,28 +266,9 @@ class DiskANNIndex {
       throw std::invalid_argument("DiskANNIndex::build: null vectors/labels");
     }
     validate_unique_external_labels(labels, n, "build");
-    if (params.pq_n_chunks > 0 && dim % params.pq_n_chunks != 0) {
-      throw std::invalid_argument("DiskANNIndex::build: dim not divisible by pq_n_chunks");
-    }
-    namespace fs = std::filesystem;
-    if (fs::exists(index_dir)) {
-      throw std::runtime_error("DiskANNIndex::build: index_dir already exists: " + index_dir);
-    }
-    if (!fs::create_directories(index_dir)) {
-      throw std::runtime_error("DiskANNIndex::build: cannot create " + index_dir);
-    }
-    // Remove the partial directory if any build phase throws, so the failed build
-    // does not block a retry with "index_dir already exists".
-    struct DirGuard {
-      const std::string &dir;
-      bool committed = false;
-      ~DirGuard() {
-        if (!committed) {
-          std::error_code ec;
-          std::filesystem::remove_all(dir, ec);
-        }
-      }
-    } dir_guard{index_dir};
+    MetricTransform xform = make_build_transform(dim, params);
+    create_index_dir(index_dir);
+    BuildDirGuard dir_guard{index_dir};
 
     // Per-phase wall-clock timing (opt-in; mirrors official build_disk_index logging).
     using clk = std::chrono::steady_clock;
@@ -233,6 +279,27 @@ class DiskANNIndex {
       }
     };
 
+    // 0. Map IP / COS input into the L2 space every later phase works in.
+    std::vector<float> stored;
+    if (!xform.identity()) {
+      xform.fit(vectors, n, params.ip_max_norm);
+      stored = xform.to_stored(vectors, n);
+      vectors = stored.data();
+      dim = xform.stored_dim;
+    }
+
+    // Over budget: spill the stored-space base and take the out-of-core path.
+    if (exceeds_build_budget(n, dim, params)) {
+      const std::string work_dir = path(index_dir, kBuildWorkDir);
+      std::filesystem::create_directories(work_dir);
+      const std::string base_path = path(work_dir, "base.fbin");
+      write_fbin(base_path, vectors, n, dim);
+      stored = {};
+      build_out_of_core(index_dir, base_path, labels, n, dim, xform, params, filter_labels);
+      dir_guard.committed = true;
+      return;
+    }
+
     // 1. Vamana graph.
     auto t_vamana0 = clk::now();
     alaya::vamana::VamanaBuildParams vparams;
@@ -259,13 +326,19 @@ class DiskANNIndex {
     // 2. Sector-aligned disk layout.  3. External labels.
     write_disk_layout(path(index_dir, "diskann.index"), vectors, graph, {n, dim, capacity, medoid});
     write_ids(path(index_dir, "ids.bin"), labels, n);
+    if (!filter_labels.empty()) {
+      LabelStore label_store;
+      label_store.assign(filter_labels, n);
+      label_store.compute_entry_points(vectors, dim);
+      label_store.save(path(index_dir, "labels.bin"));
+    }
     auto t_layout = clk::now();
-    stamp("layout+ids", t_vamana1, t_layout);
+    stamp("layout+ids+labels", t_vamana1, t_layout);
 
     // 4. Optional PQ.
     const bool has_pq = params.pq_n_chunks > 0;
     if (has_pq) {
-      PQTable pq;
+      PQTable pq(params.pq_code_bits);
       pq.train(vectors,
                n,
                dim,
@@ -286,22 +359,79 @@ class DiskANNIndex {
     stamp("cache", t_pq, clk::now());
 
     // 6. Metadata.
-    MetaHeader meta;
-    meta.num_points = n;
-    meta.dim = dim;
-    meta.max_degree = capacity;
-    meta.medoid = medoid;
-    meta.has_pq = has_pq ? 1 : 0;
-    meta.pq_n_chunks = params.pq_n_chunks;
-    meta.node_len = geom.node_len;
-    meta.nodes_per_sector = geom.nodes_per_sector;
-    meta.max_slot_id = n;  // fresh build: file capacity == num_points
-    meta.live_count = n;   // fresh build: every slot is live
-    write_meta(path(index_dir, "meta.bin"), meta);
+    write_build_meta(index_dir, n, geom, medoid, params, xform);
 
     dir_guard.committed = true;  // build complete — keep the directory
   }
 
+  /**
+   * @brief Build an index directory from an on-disk .fbin base
+   *        (`uint32 n, uint32 dim`, then n*dim float32).
+   *
+   * Within DiskANNBuildParams::build_dram_budget_gb (or with no budget) the
+   * file is loaded and built in memory exactly like the pointer overload.
+   * Over budget the vectors are only ever streamed: the Vamana graph is built
+   * shard by shard and merged, then the layout, ids, filter labels, PQ codes
+   * (trained on a sample) and BFS cache are written in passes over the file
+   * and the merged graph. Scratch files live under index_dir/build_work and
+   * are removed when the build completes.
+   *
+   * @param labels n external ids, or nullptr to use the row numbers 0..n-1.
+   * @throws std::invalid_argument for a malformed .fbin header or bad params.
+   * @throws std::runtime_error if @p index_dir already exists or on I/O failure.
+   */
+  static void build(const std::string &index_dir,
+                    const std::string &data_path,
+                    const uint64_t *labels,
+                    const DiskANNBuildParams &params,
+                    const FilterLabelsView &filter_labels = {}) {
+    uint32_t n32 = 0;
+    uint32_t dim32 = 0;
+    alaya::vamana::detail::read_fbin_header(data_path, n32, dim32);
+    const uint64_t n = n32;
+    if (labels != nullptr) {
+      validate_unique_external_labels(labels, n, "build");
+    }
+    MetricTransform xform = make_build_transform(dim32, params);
+
+    if (!exceeds_build_budget(n, xform.stored_dim, params)) {
+      std::vector<float> vectors;
+      alaya::vamana::detail::load_fbin(data_path, vectors, n32, dim32);
+      std::vector<uint64_t> row_ids;
+      if (labels == nullptr) {
+        row_ids.resize(n);
+        std::iota(row_ids.begin(), row_ids.end(), uint64_t{0});
+        labels = row_ids.data();
+      }
+      build(index_dir, vectors.data(), labels, n, dim32, params, filter_labels);
+      return;
+    }
+
+    create_index_dir(index_dir);
+    BuildDirGuard dir_guard{index_dir};
+    const std::string work_dir = path(index_dir, kBuildWorkDir);
+    std::filesystem::create_directories(work_dir);
+
+    // Map IP / COS input into the stored L2 space with two streaming passes
+    // (IP needs the longest base vector before it can augment any of them).
+    std::string base_path = data_path;
+    if (!xform.identity()) {
+      xform.fit(nullptr, 0, params.ip_max_norm);
+      for_each_fbin_block(data_path, n, dim32, [&](uint64_t, const float *rows, uint64_t count) {
+        xform.fit_more(rows, count);
+      });
+      base_path = path(work_dir, "base.fbin");
+      FbinWriter out(base_path, n, xform.stored_dim);
+      for_each_fbin_block(data_path, n, dim32, [&](uint64_t, const float *rows, uint64_t count) {
+        out.append(xform.to_stored(rows, count).data(), count);
+      });
+      out.finish();
+    }
+    build_out_of_core(index_dir, base_path, labels, n, xform.stored_dim, xform, params,
+                      filter_labels);
+    dir_guard.committed = true;
+  }
+
   // ------------------------------------------------------------------- load
   void load(const std::string &index_dir, const DiskANNLoadParams &params = {}) {
     teardown();
@@ -317,6 +447,14 @@ class DiskANNIndex {
     medoid_ = meta.medoid;
     has_pq_ = meta.has_pq != 0;
     pq_n_chunks_ = meta.pq_n_chunks;
+    pq_code_bits_ = meta.pq_code_bits;
+    xform_ = MetricTransform::create(static_cast<MetricType>(meta.metric),
+                                     meta.data_dim,
+                                     std::max<uint32_t>(1, pq_n_chunks_));
+    xform_.max_norm_sq = meta.max_norm_sq;
+    if (xform_.stored_dim != dim_) {
+      throw std::runtime_error("DiskANNIndex::load: meta dim inconsistent with its metric");
+    }
     max_slot_id_ = meta.max_slot_id;  // file capacity (slots); == num_points for static/v1
     live_count_ = meta.live_count;    // live nodes; == num_points for static/v1
     geom_ = DiskLayoutGeometry::compute(dim_, max_degree_);
@@ -333,25 +471,39 @@ class DiskANNIndex {
       slot_alloc_.reset(static_cast<uint32_t>(max_slot_id_));
     }
     rebuild_label_lookup_unlocked();
+    const std::string filter_labels_path = path(index_dir, "labels.bin");
+    if (std::filesystem::exists(filter_labels_path)) {
+      label_store_.load(filter_labels_path, max_slot_id_);
+    }
     cache_.load(path(index_dir, "cache_ids.bin"), path(index_dir, "cache_nodes.bin"));
     cache_.configure_geometry(dim_, max_degree_);
+    if (params.adaptive_cache_bytes > 0) {
+      if (params.updatable) {
+        throw std::invalid_argument(
+            "DiskANNIndex::load: adaptive_cache_bytes requires a read-only load");
+      }
+      cache_.enable_adaptive(params.adaptive_cache_bytes);
+      const std::string hot_path = path(index_dir, "hot_cache_ids.bin");
+      if (params.adaptive_cache_warm_start && std::filesystem::exists(hot_path)) {
+        cache_.warm_adaptive(hot_path, path(index_dir, "diskann.index"), max_slot_id_);
+      }
+    }
     if (has_pq_) {
       pq_.load(path(index_dir, "pq_pivots.bin"),
                path(index_dir, "pq_compressed.bin"),
                num_points,
                dim_,
-               pq_n_chunks_);
+               pq_n_chunks_,
+               pq_code_bits_);
     }
 
-    // Open the disk index and pre-register one libaio I/O context + scratch
-    // buffer per pool slot. Each context is created on a short-lived
-    // registration thread, then borrowed by whichever search thread pops the
-    // slot. A libaio context is a process-wide handle, and the slot pool
+    // Open the disk index and pre-register one I/O context (libaio context or
+    // io_uring ring) + scratch buffer per pool slot. Each context is created on a
+    // short-lived registration thread, then borrowed by whichever search thread
+    // pops the slot. Both kinds are process-wide handles, and the slot pool
     // guarantees only one thread uses a given context at a time, so this is safe
     // (verified by the concurrency stress test). The deterministic beam loop
     // (beam_search.hpp) makes results independent of I/O completion timing.
-    reader_ = make_aligned_file_reader();
-    reader_->open(path(index_dir, "diskann.index"));
     beam_width_ = std::max<uint32_t>(1, params.beam_width);
     uint32_t pool = std::max<uint32_t>(1, params.num_threads);
     if (params.updatable) {
@@ -363,7 +515,7 @@ class DiskANNIndex {
       }
       pool = std::max({pool, params.update_insert_threads, params.update_reconnect_threads});
     }
-    const uint32_t pq_table_entries = has_pq_ ? pq_n_chunks_ * kPQNumCentroids : 0;
+    const auto pq_table_entries = has_pq_ ? static_cast<uint32_t>(pq_.query_table_size()) : 0U;
     // One page slot per concurrent read. nopq_io_depth = 0 resolves to the
     // benchmark-tuned default (kDefaultNoPQIoDepth = 32); No-PQ issues far more
     // reads than PQ, so this deeper pipeline overlaps more I/O. Floored at
@@ -372,6 +524,15 @@ class DiskANNIndex {
         params.nopq_io_depth == 0 ? kDefaultNoPQIoDepth : params.nopq_io_depth;
     const uint64_t scratch_slots =
         std::min<uint64_t>(1024, std::max<uint64_t>(2ull * beam_width_, nopq_depth));
+    AlignedReaderOptions reader_options;
+    if (params.search_io == DiskANNSearchIO::kUring) {
+      reader_options.backend = AlignedReaderBackend::kUring;
+      reader_options.queue_depth = static_cast<uint32_t>(scratch_slots);  // max reads in flight
+      reader_options.sqpoll = params.search_io_sqpoll;
+      reader_options.iopoll = params.search_io_iopoll;
+    }
+    reader_ = make_aligned_file_reader(reader_options);
+    reader_->open(path(index_dir, "diskann.index"));
     const uint32_t scratch_list_size = std::max({DiskANNSearchParams{}.search_list_size,
                                                  params.update_search_l,
                                                  params.scratch_search_list_size});
@@ -395,6 +556,7 @@ class DiskANNIndex {
           auto td = std::make_unique<ThreadData>();
           td->ctx_ = reader_->get_ctx();
           td->alloc_scratch(scratch_config);
+          reader_->register_buffer(td->ctx_, td->sector_scratch, td->sector_scratch_bytes);
           thread_data_storage_[t] = std::move(td);
         });
       }
@@ -408,16 +570,32 @@ class DiskANNIndex {
     }
     num_pool_ = pool;
 
+    index_dir_ = index_dir;
     if (params.updatable) {
       init_updatable(index_dir, params);
     }
     loaded_ = true;
   }
 
+  /**
+   * @brief Persist the adaptive cache's learned hot set to hot_cache_ids.bin.
+   *
+   * A later load() with adaptive_cache_bytes > 0 warms the cache from it, so
+   * the hot records survive a restart. Safe to call while searches run.
+   * @throws std::runtime_error if the index was loaded without the adaptive cache.
+   */
+  void save_adaptive_cache() const {
+    if (!loaded_) {
+      throw std::runtime_error("DiskANNIndex::save_adaptive_cache: index not loaded");
+    }
+    cache_.save_adaptive(path(index_dir_, "hot_cache_ids.bin"));
+  }
+
   // ----------------------------------------------------------------- search
   /**
    * @brief Single-query search. Writes up to @p top_k external labels +
-   *        distances (ascending L2) into the caller's buffers.
+   *        distances (ascending; squared L2, -IP or -cosine per the build
+   *        metric) into the caller's buffers.
    * @return number of results written (<= top_k).
    */
   uint32_t search(const float *query,
@@ -447,10 +625,23 @@ class DiskANNIndex {
       pq_lock = std::shared_lock<std::shared_mutex>(pq_mutex_);
     }
 
+    std::optional<LabelFilter> filter;
+    if (!params.filter_labels.empty()) {
+      if (label_store_.empty()) {
+        throw std::invalid_argument("DiskANNIndex::search: index was built without filter labels");
+      }
+      filter.emplace(label_store_, params.filter_labels, params.search_list_size);
+    }
+
     ThreadData *td = acquire();
     uint32_t count = 0;
+    float query_term = 0.0f;
     std::vector<std::pair<uint32_t, float>> results;
     try {
+      if (!xform_.identity()) {
+        query_term = xform_.to_query(query, td->query_xform.data());
+        query = td->query_xform.data();
+      }
       td->resize_slot_capacity(snapshot.max_slot_id);
       if (stats != nullptr) {
         stats->setup_us +=
@@ -469,6 +660,7 @@ class DiskANNIndex {
         ctx.tombstone = &snapshot.tombstone;
       }
       ctx.page_io = search_page_io();
+      ctx.filter = filter ? &*filter : nullptr;
 
       SearchParams sp;
       sp.search_list_size = params.search_list_size;
@@ -491,7 +683,7 @@ class DiskANNIndex {
       for (uint32_t i = 0; i < count; ++i) {
         const uint32_t id = results[i].first;
         out_labels[i] = id < labels_.size() ? labels_[id] : kNoLabel;
-        out_distances[i] = results[i].second;
+        out_distances[i] = xform_.to_distance(results[i].second, query_term);
       }
     }
 
@@ -527,7 +719,7 @@ class DiskANNIndex {
     }
 
     auto run_one = [&](uint32_t qi) {
-      search(queries + static_cast<uint64_t>(qi) * dim_,
+      search(queries + static_cast<uint64_t>(qi) * xform_.dim,
              top_k,
              out_labels + static_cast<uint64_t>(qi) * top_k,
              out_distances + static_cast<uint64_t>(qi) * top_k,
@@ -626,6 +818,10 @@ class DiskANNIndex {
     if (params.rerank) {
       throw std::invalid_argument("DiskANNIndex::search_pipelined: rerank is not supported");
     }
+    if (!params.filter_labels.empty()) {
+      throw std::invalid_argument(
+          "DiskANNIndex::search_pipelined: filtered search is not supported");
+    }
     if (!update_reactor_ || !reader_ || reader_->get_fd() < 0) {
       throw std::runtime_error(
           "DiskANNIndex::search_pipelined: requires an updatable load with "
@@ -694,7 +890,12 @@ class DiskANNIndex {
           sp.deterministic = params.deterministic;
 
           SearchStats *stats = per_query_stats != nullptr ? &per_query_stats[qi] : nullptr;
-          const float *query = queries + static_cast<uint64_t>(qi) * dim_;
+          const float *query = queries + static_cast<uint64_t>(qi) * xform_.dim;
+          float query_term = 0.0f;
+          if (!xform_.identity()) {
+            query_term = xform_.to_query(query, td->query_xform.data());
+            query = td->query_xform.data();
+          }
           // No pq_mutex_ across the coroutine (a shared_mutex may not be
           // released on another thread) — safe by the dark-slot protocol, see
           // run_update_search_async.
@@ -729,7 +930,7 @@ class DiskANNIndex {
             for (uint32_t i = 0; i < count; ++i) {
               const uint32_t id = results[i].first;
               labels_row[i] = id < labels_.size() ? labels_[id] : kNoLabel;
-              dist_row[i] = results[i].second;
+              dist_row[i] = xform_.to_distance(results[i].second, query_term);
             }
           }
           for (uint32_t i = count; i < top_k; ++i) {
@@ -775,10 +976,21 @@ class DiskANNIndex {
 
   // --------------------------------------------------------------- accessors
   [[nodiscard]] uint64_t size() const { return live_count(); }  // live (non-tombstoned) vectors
-  [[nodiscard]] uint64_t dim() const { return dim_; }
+  [[nodiscard]] uint64_t dim() const { return xform_.dim; }  // caller-facing
+  [[nodiscard]] MetricType metric() const { return xform_.metric; }
   [[nodiscard]] bool has_pq() const { return has_pq_; }
   [[nodiscard]] uint32_t medoid() const { return medoid_; }
   [[nodiscard]] bool updatable() const { return updatable_; }
+  /// True if the index was built with filter labels (filtered search is available).
+  [[nodiscard]] bool has_filter_labels() const { return !label_store_.empty(); }
+  /// Records resident in the adaptive node cache (0 when it is disabled).
+  [[nodiscard]] uint64_t adaptive_cache_size() const {
+    return cache_.adaptive() != nullptr ? cache_.adaptive()->size() : 0;
+  }
+  /// Submit/wait syscalls the query-path reader has issued (0 if not loaded or not counted).
+  [[nodiscard]] uint64_t search_io_syscalls() const {
+    return reader_ ? reader_->io_syscalls() : 0;
+  }
   [[nodiscard]] uint64_t live_count() const {
     std::shared_lock<std::shared_mutex> lock(update_mutex_);
     return live_count_;
@@ -823,6 +1035,11 @@ class DiskANNIndex {
     if (query == nullptr) {
       throw std::invalid_argument("DiskANNIndex::insert: null query");
     }
+    std::vector<float> stored;
+    if (!xform_.identity()) {
+      stored = xform_.to_stored(query, 1);
+      query = stored.data();
+    }
     std::lock_guard<std::mutex> update_guard(update_serial_mutex_);
     {
       std::shared_lock<std::shared_mutex> state_lock(update_mutex_);
@@ -862,6 +1079,11 @@ class DiskANNIndex {
     }
     page_io_->clear_cache();
 
+    std::vector<float> stored;
+    if (!xform_.identity()) {
+      stored = xform_.to_stored(vectors, count);
+      vectors = stored.data();
+    }
     const uint32_t workers = std::min({batch_size, count, update_insert_threads_});
     coro::thread_pool pool{{.thread_count = workers,
                             .on_thread_start_functor = nullptr,
@@ -896,6 +1118,11 @@ class DiskANNIndex {
       validate_insert_labels_unlocked(labels, count);
     }
     page_io_->clear_cache();
+    std::vector<float> stored;
+    if (!xform_.identity()) {
+      stored = xform_.to_stored(vectors, count);
+      vectors = stored.data();
+    }
     return batch_insert_locked_with_pool(vectors, labels, count, batch_size, pool);
   }
 
@@ -1037,10 +1264,14 @@ class DiskANNIndex {
     m.medoid = medoid_;
     m.has_pq = has_pq_ ? 1 : 0;
     m.pq_n_chunks = pq_n_chunks_;
+    m.pq_code_bits = pq_code_bits_;
     m.node_len = geom_.node_len;
     m.nodes_per_sector = geom_.nodes_per_sector;
     m.max_slot_id = max_slot_id_;
     m.live_count = live_count_;
+    m.metric = static_cast<uint32_t>(xform_.metric);
+    m.data_dim = xform_.dim;
+    m.max_norm_sq = xform_.max_norm_sq;
     if (has_pq_) {
       if (pq_.num_points() != max_slot_id_) {
         throw std::runtime_error("DiskANNIndex::flush: PQ code count does not match max_slot_id");
@@ -1051,6 +1282,9 @@ class DiskANNIndex {
     write_ids(path(index_dir_, "ids.bin"), labels_.data(), labels_.size());
     cache_.save(path(index_dir_, "cache_ids.bin"), path(index_dir_, "cache_nodes.bin"));
     slot_alloc_.save(path(index_dir_, "slots.bin"));
+    if (!label_store_.empty()) {
+      label_store_.save(path(index_dir_, "labels.bin"));
+    }
   }
 
  private:
@@ -1074,6 +1308,10 @@ class DiskANNIndex {
     uint64_t nodes_per_sector = 0;
     uint64_t max_slot_id = 0;  // v2: file capacity in slots (only grows)
     uint64_t live_count = 0;   // v2: num_points minus tombstones
+    uint32_t pq_code_bits = 8;  // v3: 8 or 4 (fast-scan PQ)
+    uint32_t metric = static_cast<uint32_t>(MetricType::L2);  // v4
+    uint64_t data_dim = 0;     // v4: caller-facing dim (dim is the stored dim)
+    float max_norm_sq = 0.0f;  // v4: IP augmentation radius
   };
 
   struct SearchSnapshot {
@@ -1392,7 +1630,7 @@ class DiskANNIndex {
 
   std::vector<uint32_t> select_insert_neighbors_pq(const float *query,
                                                    std::vector<std::pair<uint32_t, float>> cand) {
-    std::vector<uint8_t> query_code(pq_n_chunks_);
+    std::vector<uint8_t> query_code(pq_.code_bytes());
     pq_.encode_to_code(query, query_code.data());
     if (update_insert_prune_) {
       std::vector<alaya::vamana::Neighbor> pool;
@@ -1485,6 +1723,7 @@ class DiskANNIndex {
   uint32_t allocate_update_slot_unlocked(uint64_t label) {
     const uint32_t slot = slot_alloc_.alloc();
     update_ctx_.forget_slot(slot);
+    label_store_.unlabel(slot);  // a reused slot must not keep the old point's filter labels
     max_slot_id_ = std::max<uint64_t>(max_slot_id_, slot_alloc_.next_fresh_id());
     set_label(slot, label);
     ++live_count_;
@@ -2224,6 +2463,7 @@ class DiskANNIndex {
     update_reactor_.reset();  // after page_io_: it holds a raw pointer to the reactor
     update_ctx_.clear();
     label_to_slot_.clear();
+    label_store_.clear();
     updatable_ = false;
     loaded_ = false;
   }
@@ -2251,6 +2491,10 @@ class DiskANNIndex {
     w(&m.nodes_per_sector, sizeof(m.nodes_per_sector));
     w(&m.max_slot_id, sizeof(m.max_slot_id));  // v2
     w(&m.live_count, sizeof(m.live_count));    // v2
+    w(&m.pq_code_bits, sizeof(m.pq_code_bits));  // v3
+    w(&m.metric, sizeof(m.metric));                // v4
+    w(&m.data_dim, sizeof(m.data_dim));            // v4
+    w(&m.max_norm_sq, sizeof(m.max_norm_sq));      // v4
     if (!out) {
       throw std::runtime_error("DiskANNIndex: meta write failed " + p);
     }
@@ -2287,9 +2531,17 @@ class DiskANNIndex {
       // v1 predates in-place updates: every slot is live, capacity == num_points.
       m.max_slot_id = m.num_points;
       m.live_count = m.num_points;
-    } else if (version == 2) {
+    } else if (version >= 2 && version <= kMetaVersion) {
       r(&m.max_slot_id, sizeof(m.max_slot_id));
       r(&m.live_count, sizeof(m.live_count));
+      if (version >= 3) {
+        r(&m.pq_code_bits, sizeof(m.pq_code_bits));
+      }
+      if (version >= 4) {
+        r(&m.metric, sizeof(m.metric));
+        r(&m.data_dim, sizeof(m.data_dim));
+        r(&m.max_norm_sq, sizeof(m.max_norm_sq));
+      }
       if (!in) {
         throw std::runtime_error("DiskANNIndex::load: meta.bin truncated/corrupt " + p);
       }
@@ -2299,17 +2551,327 @@ class DiskANNIndex {
     if (m.num_points == 0 || m.dim == 0) {
       throw std::runtime_error("DiskANNIndex::load: zero num_points/dim in meta " + p);
     }
+    if (version < 4) {
+      m.data_dim = m.dim;
+    }
     return m;
   }
 
+  // ------------------------------------------------------- build helpers
+  /// Scratch directory (under the index dir) for the out-of-core build.
+  static constexpr const char *kBuildWorkDir = "build_work";
+  /// Rows per streamed .fbin block (32 MiB at 128-d).
+  static constexpr uint64_t kFbinBlockRows = 65536;
+  /// Out-of-core PQ trains on a Bernoulli sample of about this many points
+  /// (DiskANN's MAX_PQ_TRAINING_SET_SIZE); the in-memory build trains on all.
+  static constexpr double kPQTrainSampleSize = 256000.0;
+
+  /// Removes a partially built directory if a build phase throws, so the failed
+  /// build does not block a retry with "index_dir already exists".
+  struct BuildDirGuard {
+    const std::string &dir;
+    bool committed = false;
+    ~BuildDirGuard() {
+      if (!committed) {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+      }
+    }
+  };
+
+  static MetricTransform make_build_transform(uint64_t dim, const DiskANNBuildParams &params) {
+    // IP pads its augmented vectors to a whole number of PQ chunks, so the
+    // divisibility check below applies to the stored dimension.
+    MetricTransform xform = MetricTransform::create(params.metric, dim, params.pq_n_chunks);
+    if (params.pq_n_chunks > 0 && xform.stored_dim % params.pq_n_chunks != 0) {
+      throw std::invalid_argument("DiskANNIndex::build: dim not divisible by pq_n_chunks");
+    }
+    if (params.pq_n_chunks > 0 && params.pq_code_bits == 4 && params.pq_n_chunks % 4 != 0) {
+      throw std::invalid_argument(
+          "DiskANNIndex::build: 4-bit PQ needs pq_n_chunks to be a multiple of 4");
+    }
+    return xform;
+  }
+
+  static void create_index_dir(const std::string &index_dir) {
+    namespace fs = std::filesystem;
+    if (fs::exists(index_dir)) {
+      throw std::runtime_error("DiskANNIndex::build: index_dir already exists: " + index_dir);
+    }
+    if (!fs::create_directories(index_dir)) {
+      throw std::runtime_error("DiskANNIndex::build: cannot create " + index_dir);
+    }
+  }
+
+  /// True when an in-memory Vamana build over (n, dim) would not fit the budget.
+  static bool exceeds_build_budget(uint64_t n, uint64_t dim, const DiskANNBuildParams &params) {
+    return params.build_dram_budget_gb > 0.0f &&
+           alaya::vamana::estimate_ram_usage_gib(static_cast<size_t>(n),
+                                                 static_cast<size_t>(dim),
+                                                 sizeof(float),
+                                                 params.R) > params.build_dram_budget_gb;
+  }
+
+  static void write_build_meta(const std::string &index_dir,
+                               uint64_t n,
+                               const DiskLayoutGeometry &geom,
+                               uint32_t medoid,
+                               const DiskANNBuildParams &params,
+                               const MetricTransform &xform) {
+    const bool has_pq = params.pq_n_chunks > 0;
+    MetaHeader meta;
+    meta.num_points = n;
+    meta.dim = geom.dim;
+    meta.max_degree = geom.max_degree;
+    meta.medoid = medoid;
+    meta.has_pq = has_pq ? 1 : 0;
+    meta.pq_n_chunks = params.pq_n_chunks;
+    meta.pq_code_bits = has_pq ? params.pq_code_bits : 8;
+    meta.node_len = geom.node_len;
+    meta.nodes_per_sector = geom.nodes_per_sector;
+    meta.max_slot_id = n;  // fresh build: file capacity == num_points
+    meta.live_count = n;   // fresh build: every slot is live
+    meta.metric = static_cast<uint32_t>(xform.metric);
+    meta.data_dim = xform.dim;
+    meta.max_norm_sq = xform.max_norm_sq;
+    write_meta(path(index_dir, "meta.bin"), meta);
+  }
+
+  /// Sequential .fbin writer: the header up front, then rows appended in id order.
+  class FbinWriter {
+   public:
+    FbinWriter(const std::string &p, uint64_t n, uint64_t dim)
+        : path_(p), n_(n), dim_(dim), out_(p, std::ios::binary | std::ios::trunc) {
+      if (!out_) {
+        throw std::runtime_error("DiskANNIndex: cannot write " + p);
+      }
+      if (n > std::numeric_limits<uint32_t>::max() || dim > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("DiskANNIndex: .fbin shape exceeds uint32: " + p);
+      }
+      const auto n32 = static_cast<uint32_t>(n);
+      const auto dim32 = static_cast<uint32_t>(dim);
+      out_.write(reinterpret_cast<const char *>(&n32), sizeof(n32));
+      out_.write(reinterpret_cast<const char *>(&dim32), sizeof(dim32));
+    }
+
+    void append(const float *rows, uint64_t count) {
+      out_.write(reinterpret_cast<const char *>(rows),
+                 static_cast<std::streamsize>(count * dim_ * sizeof(float)));
+      written_ += count;
+    }
+
+    void finish() {
+      out_.flush();
+      if (!out_ || written_ != n_) {
+        throw std::runtime_error("DiskANNIndex: .fbin write failed " + path_);
+      }
+    }
+
+   private:
+    std::string path_;
+    uint64_t n_;
+    uint64_t dim_;
+    std::ofstream out_;
+    uint64_t written_ = 0;
+  };
+
+  static void write_fbin(const std::string &p, const float *vectors, uint64_t n, uint64_t dim) {
+    FbinWriter out(p, n, dim);
+    out.append(vectors, n);
+    out.finish();
+  }
+
+  /**
+   * @brief Stream an .fbin in blocks of kFbinBlockRows: visit(first_id, rows, count).
+   * @throws std::runtime_error if the header does not match (n, dim) or a read is short.
+   */
+  template <typename Visit>
+  static void for_each_fbin_block(const std::string &p, uint64_t n, uint64_t dim, Visit &&visit) {
+    std::ifstream in(p, std::ios::binary);
+    uint32_t hdr[2] = {0, 0};
+    in.read(reinterpret_cast<char *>(hdr), sizeof(hdr));
+    if (!in || hdr[0] != n || hdr[1] != dim) {
+      throw std::runtime_error("DiskANNIndex: unexpected .fbin header in " + p);
+    }
+    std::vector<float> block(static_cast<size_t>(std::min(n, kFbinBlockRows) * dim));
+    for (uint64_t first = 0; first < n; first += kFbinBlockRows) {
+      const uint64_t count = std::min(kFbinBlockRows, n - first);
+      in.read(reinterpret_cast<char *>(block.data()),
+              static_cast<std::streamsize>(count * dim * sizeof(float)));
+      if (!in) {
+        throw std::runtime_error("DiskANNIndex: short read on .fbin " + p);
+      }
+      visit(first, static_cast<const float *>(block.data()), count);
+    }
+  }
+
+  /**
+   * @brief Out-of-core build over a stored-space .fbin of n x dim vectors.
+   *
+   * The caller has created @p index_dir (and guards it); this writes every
+   * index file into it, then removes the build_work scratch directory.
+   */
+  static void build_out_of_core(const std::string &index_dir,
+                                const std::string &base_path,
+                                const uint64_t *labels,
+                                uint64_t n,
+                                uint64_t dim,
+                                const MetricTransform &xform,
+                                const DiskANNBuildParams &params,
+                                const FilterLabelsView &filter_labels) {
+    using clk = std::chrono::steady_clock;
+    auto stamp = [&params](const char *name, clk::time_point a, clk::time_point b) {
+      if (params.verbose) {
+        std::cerr << "[build] " << name << ": " << std::chrono::duration<double>(b - a).count()
+                  << " s\n";
+      }
+    };
+    const uint32_t capacity = params.record_capacity != 0 ? params.record_capacity : params.R;
+    if (capacity < params.R) {
+      throw std::invalid_argument("DiskANNIndex::build: record_capacity must be >= R");
+    }
+    // Reject malformed filter labels before the expensive phases.
+    LabelStore label_store;
+    if (!filter_labels.empty()) {
+      label_store.assign(filter_labels, n);
+    }
+    const std::string work_dir = path(index_dir, kBuildWorkDir);
+
+    // 1. Vamana graph: k-means partition -> per-shard build -> merge.
+    auto t_vamana0 = clk::now();
+    const std::string graph_path = path(work_dir, "vamana.index");
+    alaya::vamana::BuildVamanaParams vargs;
+    vargs.data_path = base_path;
+    vargs.output_path = graph_path;
+    vargs.R = params.R;
+    vargs.L = params.L;
+    vargs.alpha = params.alpha;
+    vargs.num_threads = params.num_threads;
+    vargs.seed = params.seed;
+    vargs.build_dram_budget_gb = params.build_dram_budget_gb;
+    alaya::vamana::build_vamana(vargs);
+    auto t_vamana1 = clk::now();
+    stamp("vamana(sharded)", t_vamana0, t_vamana1);
+
+    // 2. Sector-aligned disk layout, streamed from the merged graph (vamana_writer.hpp
+    // layout: 24-byte header with the medoid at offset 12, then [k, nbrs[k]] per node)
+    // and the base file in the same id order.
+    std::ifstream graph_in(graph_path, std::ios::binary);
+    char graph_header[24];
+    graph_in.read(graph_header, sizeof(graph_header));
+    if (!graph_in) {
+      throw std::runtime_error("DiskANNIndex::build: cannot read merged graph " + graph_path);
+    }
+    uint32_t medoid = 0;
+    std::memcpy(&medoid, graph_header + 12, sizeof(medoid));
+    DiskLayoutWriter layout(path(index_dir, "diskann.index"), {n, dim, capacity, medoid});
+    std::vector<uint32_t> nbrs(capacity);
+    for_each_fbin_block(base_path, n, dim, [&](uint64_t first, const float *rows, uint64_t count) {
+      for (uint64_t r = 0; r < count; ++r) {
+        uint32_t k = 0;
+        graph_in.read(reinterpret_cast<char *>(&k), sizeof(k));
+        if (!graph_in || k > capacity) {
+          throw std::runtime_error("DiskANNIndex::build: bad merged graph record for node " +
+                                   std::to_string(first + r));
+        }
+        graph_in.read(reinterpret_cast<char *>(nbrs.data()),
+                      static_cast<std::streamsize>(k * sizeof(uint32_t)));
+        if (!graph_in) {
+          throw std::runtime_error("DiskANNIndex::build: short read on merged graph " +
+                                   graph_path);
+        }
+        layout.append(rows + r * dim, nbrs.data(), k);
+      }
+    });
+    layout.finish();
+    const DiskLayoutGeometry geom = layout.geometry();
+    graph_in.close();
+
+    // 3. External ids and filter labels.
+    write_ids(path(index_dir, "ids.bin"), labels, n);
+    if (!label_store.empty()) {
+      label_store.compute_entry_points_by_scan(
+          [&](auto &&visit) { for_each_fbin_block(base_path, n, dim, visit); }, dim);
+      label_store.save(path(index_dir, "labels.bin"));
+    }
+    auto t_layout = clk::now();
+    stamp("layout+ids+labels", t_vamana1, t_layout);
+
+    // 4. Optional PQ: train on a sample, then encode block by block.
+    if (params.pq_n_chunks > 0) {
+      const double rate = std::min(1.0, kPQTrainSampleSize / static_cast<double>(n));
+      std::mt19937_64 rng(params.seed);
+      std::uniform_real_distribution<double> u01(0.0, 1.0);
+      std::vector<float> sample;
+      for_each_fbin_block(base_path, n, dim, [&](uint64_t, const float *rows, uint64_t count) {
+        for (uint64_t r = 0; r < count; ++r) {
+          if (u01(rng) < rate) {
+            sample.insert(sample.end(), rows + r * dim, rows + (r + 1) * dim);
+          }
+        }
+      });
+      PQTable pq(params.pq_code_bits);
+      pq.train(sample.data(),
+               sample.size() / dim,
+               dim,
+               params.pq_n_chunks,
+               params.pq_train_iters,
+               params.seed,
+               params.num_threads);
+      sample = {};
+      pq.save_pivots(path(index_dir, "pq_pivots.bin"));
+      const std::string codes_path = path(index_dir, "pq_compressed.bin");
+      std::ofstream codes_out(codes_path, std::ios::binary | std::ios::trunc);
+      if (!codes_out) {
+        throw std::runtime_error("DiskANNIndex: cannot write " + codes_path);
+      }
+      std::vector<uint8_t> codes;
+      for_each_fbin_block(base_path, n, dim, [&](uint64_t, const float *rows, uint64_t count) {
+        codes.resize(count * pq.code_bytes());
+        pq.encode_rows(rows, count, codes.data(), params.num_threads);
+        codes_out.write(reinterpret_cast<const char *>(codes.data()),
+                        static_cast<std::streamsize>(codes.size()));
+      });
+      codes_out.flush();
+      if (!codes_out) {
+        throw std::runtime_error("DiskANNIndex: PQ codes write failed " + codes_path);
+      }
+    }
+    auto t_pq = clk::now();
+    stamp("pq(sample-train+stream-encode)", t_layout, t_pq);
+
+    // 5. BFS cache, read back from the written layout.
+    NodeCache cache;
+    cache.generate_from_disk(path(index_dir, "diskann.index"), medoid, n, dim, capacity,
+                             params.cache_ratio);
+    cache.save(path(index_dir, "cache_ids.bin"), path(index_dir, "cache_nodes.bin"));
+    stamp("cache", t_pq, clk::now());
+
+    // 6. Metadata.
+    write_build_meta(index_dir, n, geom, medoid, params, xform);
+    std::error_code ec;
+    std::filesystem::remove_all(work_dir, ec);
+  }
+
+  /// @p labels may be null for row-number ids (out-of-core builds over an .fbin).
   static void write_ids(const std::string &p, const uint64_t *labels, uint64_t n) {
     std::ofstream out(p, std::ios::binary | std::ios::trunc);
     if (!out) {
       throw std::runtime_error("DiskANNIndex: cannot write " + p);
     }
     out.write(reinterpret_cast<const char *>(&n), sizeof(n));
-    out.write(reinterpret_cast<const char *>(labels),
-              static_cast<std::streamsize>(n * sizeof(uint64_t)));
+    if (labels != nullptr) {
+      out.write(reinterpret_cast<const char *>(labels),
+                static_cast<std::streamsize>(n * sizeof(uint64_t)));
+    } else {
+      std::vector<uint64_t> block;
+      for (uint64_t first = 0; first < n; first += kFbinBlockRows) {
+        block.resize(std::min(kFbinBlockRows, n - first));
+        std::iota(block.begin(), block.end(), first);
+        out.write(reinterpret_cast<const char *>(block.data()),
+                  static_cast<std::streamsize>(block.size() * sizeof(uint64_t)));
+      }
+    }
     if (!out) {
       throw std::runtime_error("DiskANNIndex: ids write failed " + p);
     }
@@ -2339,6 +2901,8 @@ class DiskANNIndex {
   uint32_t medoid_ = 0;
   bool has_pq_ = false;
   uint32_t pq_n_chunks_ = 0;
+  uint32_t pq_code_bits_ = 8;
+  MetricTransform xform_;  ///< caller metric <-> stored L2 space (identity for L2)
   uint32_t beam_width_ = 4;
   uint32_t num_pool_ = 0;
   bool loaded_ = false;
@@ -2347,6 +2911,7 @@ class DiskANNIndex {
   // in-memory artifacts
   std::vector<uint64_t> labels_;
   std::unordered_map<uint64_t, uint32_t> label_to_slot_;  ///< Live external label to slot.
+  LabelStore label_store_;  ///< per-point filter labels (empty unless built with them)
   NodeCache cache_;
   PQTable pq_;
   std::unique_ptr<AlignedFileReader> reader_;
@@ -2395,7 +2960,7 @@ class DiskANNIndex {
   bool updatable_ = false;
   uint64_t max_slot_id_ = 0;  ///< file capacity in slots (valid-id bound; only grows)
   uint64_t live_count_ = 0;   ///< live (non-tombstoned) vector count
-  std::string index_dir_;     ///< saved at load for flush() output paths
+  std::string index_dir_;     ///< saved at load for flush()/save_adaptive_cache() paths
   std::unique_ptr<alaya::UringReactor> update_reactor_;  ///< declared before page_io_ so the
                                                          ///< page IO (raw-pointer user) dies first
   std::unique_ptr<DiskPageIO> page_io_;
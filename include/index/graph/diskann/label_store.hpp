@@ -0,0 +1,335 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+/**
+ * @file label_store.hpp
+ * @brief Per-point filter labels and label entry points for filtered DiskANN search.
+ *
+ * Filtered-DiskANN style restrictions ("tenant_id = X", "category in {...}")
+ * attach a small set of uint32 labels to every point. `LabelStore` keeps them
+ * in CSR form (offsets + sorted per-point values) next to ids.bin, plus one
+ * entry point per distinct label: the member closest to that label's centroid.
+ * A filtered query seeds its beam at the entry points of its labels as well as
+ * the medoid, so it starts inside the labelled region even when that region is
+ * far from the medoid.
+ *
+ * `LabelFilter` is the per-query predicate: a point matches when it carries at
+ * least one of the filter's labels. Searches still traverse non-matching nodes
+ * (the graph is built label-agnostic, so they carry the connectivity) but only
+ * matching nodes are returned.
+ *
+ * Updatable indexes: the CSR covers the build-time slots. A slot reused by an
+ * insert is marked unlabeled (a word-atomic TombstoneBitmap, safe against
+ * lock-free readers), and inserted points carry no labels, so they never match
+ * a filter.
+ *
+ * File (labels.bin): [magic | n | n_values | offsets (n+1) u64 | values u32 |
+ * n_entries | (label u32, node u32) * n_entries].
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "index/graph/diskann/tombstone_bitmap.hpp"
+#include "simd/distance_l2.hpp"
+
+namespace alaya::diskann {
+
+/// Borrowed CSR view of per-point labels: point i owns values[offsets[i], offsets[i + 1]).
+struct FilterLabelsView {
+  const uint64_t *offsets = nullptr;  ///< n + 1 entries, offsets[0] == 0, non-decreasing
+  const uint32_t *values = nullptr;   ///< offsets[n] labels
+
+  [[nodiscard]] bool empty() const { return offsets == nullptr; }
+};
+
+class LabelStore {
+ public:
+  static constexpr uint64_t kMagic = 0x414C594C424C5331ULL;  // "ALYLBLS1"
+  static constexpr uint32_t kNoEntry = std::numeric_limits<uint32_t>::max();
+
+  LabelStore() = default;
+  LabelStore(const LabelStore &) = delete;
+  LabelStore &operator=(const LabelStore &) = delete;
+
+  /**
+   * @brief Copy @p view for @p n points; each point's labels are sorted and deduplicated.
+   * @throws std::invalid_argument on a null view or malformed offsets.
+   */
+  void assign(const FilterLabelsView &view, uint64_t n) {
+    if (view.offsets == nullptr || (view.values == nullptr && n > 0 && view.offsets[n] > 0)) {
+      throw std::invalid_argument("LabelStore::assign: null labels");
+    }
+    if (view.offsets[0] != 0) {
+      throw std::invalid_argument("LabelStore::assign: offsets[0] must be 0");
+    }
+    offsets_.assign(n + 1, 0);
+    values_.clear();
+    values_.reserve(view.offsets[n]);
+    for (uint64_t i = 0; i < n; ++i) {
+      const uint64_t begin = view.offsets[i];
+      const uint64_t end = view.offsets[i + 1];
+      if (end < begin) {
+        throw std::invalid_argument("LabelStore::assign: offsets must be non-decreasing");
+      }
+      const size_t first = values_.size();
+      values_.insert(values_.end(), view.values + begin, view.values + end);
+      std::sort(values_.begin() + static_cast<std::ptrdiff_t>(first), values_.end());
+      auto unique_end =
+          std::unique(values_.begin() + static_cast<std::ptrdiff_t>(first), values_.end());
+      values_.erase(unique_end, values_.end());
+      offsets_[i + 1] = values_.size();
+    }
+    entry_labels_.clear();
+    entry_nodes_.clear();
+    unlabeled_.reset(0);
+  }
+
+  /**
+   * @brief Pick each label's entry point: the member closest (squared L2) to the label centroid.
+   * @param vectors the n points in the space the index searches (row-major, @p dim floats).
+   */
+  void compute_entry_points(const float *vectors, uint64_t dim) {
+    compute_entry_points_by_scan([&](auto &&visit) { visit(0, vectors, size()); }, dim);
+  }
+
+  /**
+   * @brief compute_entry_points() over vectors that are streamed rather than resident.
+   *
+   * @p scan(visit) must call @c visit(first_id, rows, count) over all n points
+   * in id order, in row-major blocks; it is invoked twice (centroids, then
+   * closest members), so peak memory is one block plus the label centroids.
+   */
+  template <typename ScanBlocks>
+  void compute_entry_points_by_scan(ScanBlocks &&scan, uint64_t dim) {
+    entry_labels_ = values_;
+    std::sort(entry_labels_.begin(), entry_labels_.end());
+    entry_labels_.erase(std::unique(entry_labels_.begin(), entry_labels_.end()),
+                        entry_labels_.end());
+    const size_t n_labels = entry_labels_.size();
+    std::vector<float> centroids(n_labels * dim, 0.0f);
+    std::vector<uint64_t> counts(n_labels, 0);
+    scan([&](uint64_t first, const float *rows, uint64_t count) {
+      for (uint64_t r = 0; r < count; ++r) {
+        const uint64_t i = first + r;
+        const float *v = rows + r * dim;
+        for (uint64_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+          const size_t l = label_index(values_[k]);
+          float *c = centroids.data() + l * dim;
+          for (uint64_t d = 0; d < dim; ++d) {
+            c[d] += v[d];
+          }
+          ++counts[l];
+        }
+      }
+    });
+    for (size_t l = 0; l < n_labels; ++l) {
+      const float inv = 1.0f / static_cast<float>(counts[l]);
+      for (uint64_t d = 0; d < dim; ++d) {
+        centroids[l * dim + d] *= inv;
+      }
+    }
+    const auto l2 = alaya::simd::get_l2_sqr_func();
+    std::vector<float> best(n_labels, std::numeric_limits<float>::max());
+    entry_nodes_.assign(n_labels, kNoEntry);
+    scan([&](uint64_t first, const float *rows, uint64_t count) {
+      for (uint64_t r = 0; r < count; ++r) {
+        const uint64_t i = first + r;
+        for (uint64_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+          const size_t l = label_index(values_[k]);
+          const float d = l2(rows + r * dim, centroids.data() + l * dim, dim);
+          if (d < best[l]) {
+            best[l] = d;
+            entry_nodes_[l] = static_cast<uint32_t>(i);
+          }
+        }
+      }
+    });
+  }
+
+  [[nodiscard]] bool empty() const { return offsets_.empty(); }
+  /// Points covered by the CSR (the build-time slot count).
+  [[nodiscard]] uint64_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  /// Distinct labels with an entry point.
+  [[nodiscard]] size_t label_count() const { return entry_labels_.size(); }
+
+  /// Sorted labels of point @p id as [first, second); empty for unlabeled or out-of-range ids.
+  [[nodiscard]] std::pair<const uint32_t *, const uint32_t *> labels_of(uint64_t id) const {
+    if (id >= size() || (unlabeled_.count() > 0 && unlabeled_.is_deleted(id))) {
+      return {nullptr, nullptr};
+    }
+    return {values_.data() + offsets_[id], values_.data() + offsets_[id + 1]};
+  }
+
+  /// Entry point of @p label, or kNoEntry if no point carries it.
+  [[nodiscard]] uint32_t entry_point(uint32_t label) const {
+    const auto it = std::lower_bound(entry_labels_.begin(), entry_labels_.end(), label);
+    if (it == entry_labels_.end() || *it != label) {
+      return kNoEntry;
+    }
+    return entry_nodes_[static_cast<size_t>(it - entry_labels_.begin())];
+  }
+
+  /// Drop @p id's labels (its slot is being reused). Runs under the index's exclusive update lock.
+  void unlabel(uint64_t id) {
+    if (id < size() && offsets_[id] != offsets_[id + 1]) {
+      unlabeled_.set(id);
+    }
+  }
+
+  /// Persist to @p path; unlabeled points are written with no labels.
+  void save(const std::string &path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("LabelStore::save: cannot open " + path);
+    }
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> values;
+    const std::vector<uint64_t> *offsets_out = &offsets_;
+    const std::vector<uint32_t> *values_out = &values_;
+    if (unlabeled_.count() > 0) {
+      offsets.assign(offsets_.size(), 0);
+      values.reserve(values_.size());
+      for (uint64_t i = 0; i < size(); ++i) {
+        const auto [first, last] = labels_of(i);
+        values.insert(values.end(), first, last);
+        offsets[i + 1] = values.size();
+      }
+      offsets_out = &offsets;
+      values_out = &values;
+    }
+    auto w = [&](const void *d, size_t bytes) {
+      out.write(reinterpret_cast<const char *>(d), static_cast<std::streamsize>(bytes));
+    };
+    const uint64_t magic = kMagic;
+    const uint64_t n = size();
+    const uint64_t n_values = values_out->size();
+    const uint64_t n_entries = entry_labels_.size();
+    w(&magic, sizeof(magic));
+    w(&n, sizeof(n));
+    w(&n_values, sizeof(n_values));
+    w(offsets_out->data(), offsets_out->size() * sizeof(uint64_t));
+    w(values_out->data(), n_values * sizeof(uint32_t));
+    w(&n_entries, sizeof(n_entries));
+    for (size_t l = 0; l < n_entries; ++l) {
+      w(&entry_labels_[l], sizeof(uint32_t));
+      w(&entry_nodes_[l], sizeof(uint32_t));
+    }
+    if (!out) {
+      throw std::runtime_error("LabelStore::save: write failed " + path);
+    }
+  }
+
+  /// Restore from @p path; @p expected_n is the slot count ids.bin holds.
+  void load(const std::string &path, uint64_t expected_n) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("LabelStore::load: cannot open " + path);
+    }
+    auto r = [&](void *d, size_t bytes) {
+      in.read(reinterpret_cast<char *>(d), static_cast<std::streamsize>(bytes));
+    };
+    uint64_t magic = 0;
+    uint64_t n = 0;
+    uint64_t n_values = 0;
+    r(&magic, sizeof(magic));
+    r(&n, sizeof(n));
+    r(&n_values, sizeof(n_values));
+    if (!in || magic != kMagic) {
+      throw std::runtime_error("LabelStore::load: bad magic/truncated " + path);
+    }
+    if (n > expected_n) {
+      throw std::runtime_error("LabelStore::load: more labelled points than slots " + path);
+    }
+    offsets_.assign(n + 1, 0);
+    values_.assign(n_values, 0);
+    r(offsets_.data(), offsets_.size() * sizeof(uint64_t));
+    r(values_.data(), n_values * sizeof(uint32_t));
+    uint64_t n_entries = 0;
+    r(&n_entries, sizeof(n_entries));
+    if (!in || offsets_[n] != n_values) {
+      throw std::runtime_error("LabelStore::load: truncated/corrupt " + path);
+    }
+    entry_labels_.assign(n_entries, 0);
+    entry_nodes_.assign(n_entries, kNoEntry);
+    for (size_t l = 0; l < n_entries; ++l) {
+      r(&entry_labels_[l], sizeof(uint32_t));
+      r(&entry_nodes_[l], sizeof(uint32_t));
+    }
+    if (!in) {
+      throw std::runtime_error("LabelStore::load: entry points truncated " + path);
+    }
+    unlabeled_.reset(0);
+  }
+
+  void clear() {
+    offsets_.clear();
+    values_.clear();
+    entry_labels_.clear();
+    entry_nodes_.clear();
+    unlabeled_.reset(0);
+  }
+
+ private:
+  [[nodiscard]] size_t label_index(uint32_t label) const {
+    return static_cast<size_t>(std::lower_bound(entry_labels_.begin(), entry_labels_.end(), label) -
+                               entry_labels_.begin());
+  }
+
+  std::vector<uint64_t> offsets_;
+  std::vector<uint32_t> values_;
+  std::vector<uint32_t> entry_labels_;  ///< sorted distinct labels
+  std::vector<uint32_t> entry_nodes_;   ///< parallel to entry_labels_
+  TombstoneBitmap unlabeled_;           ///< reused slots whose labels no longer apply
+};
+
+/// Per-query label predicate: a point matches when it carries any of the filter's labels.
+class LabelFilter {
+ public:
+  /**
+   * @param max_entry_points cap on the seeds taken from the filter labels' entry points.
+   */
+  LabelFilter(const LabelStore &store, std::vector<uint32_t> labels, size_t max_entry_points)
+      : store_(&store), labels_(std::move(labels)) {
+    std::sort(labels_.begin(), labels_.end());
+    labels_.erase(std::unique(labels_.begin(), labels_.end()), labels_.end());
+    for (const uint32_t label : labels_) {
+      if (entry_points_.size() >= max_entry_points) {
+        break;
+      }
+      const uint32_t ep = store.entry_point(label);
+      if (ep != LabelStore::kNoEntry) {
+        entry_points_.push_back(ep);
+      }
+    }
+  }
+
+  [[nodiscard]] bool matches(uint32_t id) const {
+    const auto [first, last] = store_->labels_of(id);
+    for (const uint32_t *it = first; it != last; ++it) {
+      if (std::binary_search(labels_.begin(), labels_.end(), *it)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Entry points of the filter labels, in label order (at most max_entry_points).
+  [[nodiscard]] const std::vector<uint32_t> &entry_points() const { return entry_points_; }
+
+ private:
+  const LabelStore *store_;
+  std::vector<uint32_t> labels_;
+  std::vector<uint32_t> entry_points_;
+};
+
+}  // namespace alaya::diskann
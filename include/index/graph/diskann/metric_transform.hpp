@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+/**
+ * @file metric_transform.hpp
+ * @brief Maps IP / COS vectors onto the squared-L2 space DiskANN runs in.
+ *
+ * The Vamana build, both PQ tables, robust pruning, beam search and the exact
+ * rerank all compute squared L2 only. Other metrics are reduced to it at the
+ * index boundary, so nothing below the public API changes:
+ *   - COS: base vectors and queries are normalized at ingest, so
+ *     |q - x|^2 = 2 - 2 cos(q, x). A zero base vector is rejected.
+ *   - IP: the MIPS -> L2 augmentation. A stored vector x gains the coordinate
+ *     sqrt(M - |x|^2), M being the largest squared norm the index admits, and a
+ *     query gains 0, so |q' - x'|^2 = |q|^2 + M - 2 <q, x> ranks by -<q, x>.
+ *     The stored vector is zero-padded up to a multiple of the PQ chunk count.
+ *
+ * Reported distances follow the in-memory spaces (ascending = better):
+ * L2 -> squared L2, IP -> -<q, x>, COS -> -cos(q, x).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "utils/metric_type.hpp"
+
+namespace alaya::diskann {
+
+struct MetricTransform {
+  MetricType metric = MetricType::L2;
+  uint64_t dim = 0;          ///< caller-facing vector dimension
+  uint64_t stored_dim = 0;   ///< dimension of the vectors the index stores and searches
+  float max_norm_sq = 0.0f;  ///< IP only: M, the squared augmentation radius
+
+  /**
+   * @brief Shape the transform for @p metric over @p dim-dimensional input.
+   * @param align IP pads the stored dimension to a multiple of this (the PQ
+   *        chunk count, so the augmented vector still splits evenly); 0 or 1 => no padding.
+   * @throws std::invalid_argument for MetricType::NONE or dim == 0.
+   */
+  static MetricTransform create(MetricType metric, uint64_t dim, uint32_t align = 1) {
+    if (dim == 0) {
+      throw std::invalid_argument("MetricTransform: dim must be > 0");
+    }
+    MetricTransform t;
+    t.metric = metric;
+    t.dim = dim;
+    switch (metric) {
+      case MetricType::L2:
+      case MetricType::COS:
+        t.stored_dim = dim;
+        break;
+      case MetricType::IP: {
+        const uint64_t a = std::max<uint32_t>(1, align);
+        t.stored_dim = (dim + 1 + a - 1) / a * a;
+        break;
+      }
+      default:
+        throw std::invalid_argument("MetricTransform: unsupported metric");
+    }
+    return t;
+  }
+
+  [[nodiscard]] bool identity() const { return metric == MetricType::L2; }
+
+  /// IP only: take M from the largest norm of @p n vectors, or from @p max_norm if that is larger.
+  void fit(const float *vectors, uint64_t n, float max_norm = 0.0f) {
+    if (metric != MetricType::IP) {
+      return;
+    }
+    max_norm_sq = max_norm * max_norm;
+    fit_more(vectors, n);
+  }
+
+  /// IP only: widen M to cover @p n more vectors (fit() over a base streamed in blocks).
+  void fit_more(const float *vectors, uint64_t n) {
+    if (metric != MetricType::IP) {
+      return;
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+      max_norm_sq = std::max(max_norm_sq, norm_sq(vectors + i * dim));
+    }
+  }
+
+  /**
+   * @brief Map a base vector (dim floats) to its stored form (stored_dim floats).
+   * @throws std::invalid_argument for a zero-magnitude COS vector, which has no
+   *         direction to store (DiskCollection::add_batch rejects it the same way).
+   * @throws std::invalid_argument for an IP vector longer than sqrt(M) (an
+   *         insert after build): it has no augmentation that keeps its inner
+   *         products exact. Build with a larger ip_max_norm to admit it.
+   */
+  void to_stored(const float *in, float *out) const {
+    if (metric == MetricType::COS) {
+      if (zero_magnitude(in)) {
+        throw std::invalid_argument("MetricTransform: zero-magnitude vector under COS");
+      }
+      normalize(in, out);
+      return;
+    }
+    std::copy_n(in, dim, out);
+    if (metric == MetricType::IP) {
+      const float n2 = norm_sq(in);
+      if (n2 > max_norm_sq) {
+        throw std::invalid_argument(
+            "MetricTransform: IP vector norm " + std::to_string(std::sqrt(n2)) +
+            " exceeds the index's augmentation radius " + std::to_string(std::sqrt(max_norm_sq)) +
+            "; rebuild with DiskANNBuildParams::ip_max_norm >= the longest vector to insert");
+      }
+      std::fill(out + dim, out + stored_dim, 0.0f);
+      out[dim] = std::sqrt(max_norm_sq - n2);
+    }
+  }
+
+  /// to_stored() over @p n row-major vectors.
+  [[nodiscard]] std::vector<float> to_stored(const float *in, uint64_t n) const {
+    std::vector<float> out(n * stored_dim);
+    for (uint64_t i = 0; i < n; ++i) {
+      to_stored(in + i * dim, out.data() + i * stored_dim);
+    }
+    return out;
+  }
+
+  /**
+   * @brief Map a query (dim floats) into the stored space (stored_dim floats).
+   * @return the query term to_distance() needs (|q|^2 for IP, else 0).
+   */
+  float to_query(const float *in, float *out) const {
+    if (metric == MetricType::COS) {
+      normalize(in, out);
+      return 0.0f;
+    }
+    std::copy_n(in, dim, out);
+    std::fill(out + dim, out + stored_dim, 0.0f);
+    return metric == MetricType::IP ? norm_sq(in) : 0.0f;
+  }
+
+  /// Convert a stored-space squared L2 distance back to the metric's distance.
+  [[nodiscard]] float to_distance(float l2, float query_term) const {
+    switch (metric) {
+      case MetricType::IP:
+        return 0.5f * (l2 - query_term - max_norm_sq);
+      case MetricType::COS:
+        return 0.5f * l2 - 1.0f;
+      default:
+        return l2;
+    }
+  }
+
+ private:
+  [[nodiscard]] float norm_sq(const float *v) const {
+    float s = 0.0f;
+    for (uint64_t d = 0; d < dim; ++d) {
+      s += v[d] * v[d];
+    }
+    return s;
+  }
+
+  // Summed in double like DiskCollection's row check, so tiny components that
+  // underflow a float sum still count as a direction.
+  [[nodiscard]] bool zero_magnitude(const float *v) const {
+    double s = 0.0;
+    for (uint64_t d = 0; d < dim; ++d) {
+      s += static_cast<double>(v[d]) * static_cast<double>(v[d]);
+    }
+    return s == 0.0;
+  }
+
+  void normalize(const float *in, float *out) const {
+    const float n = std::sqrt(norm_sq(in));
+    const float inv = n > 0.0f ? 1.0f / n : 0.0f;
+    for (uint64_t d = 0; d < dim; ++d) {
+      out[d] = in[d] * inv;
+    }
+  }
+};
+
+}  // namespace alaya::diskann
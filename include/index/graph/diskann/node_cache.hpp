@@ -16,6 +16,10 @@
  * Build-time records stay immutable after generate()/load(). In-place updates
  * publish per-node override records so concurrent search never observes a
  * partially-written cached node.
+ *
+ * Read-only indices may add an adaptive tier (adaptive_node_cache.hpp) behind
+ * the BFS records: beam search offers each record it reads from disk through
+ * observe_miss(), and frequently visited nodes are kept in memory.
  */
 
 #pragma once
@@ -36,6 +40,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "index/graph/diskann/adaptive_node_cache.hpp"
 #include "index/graph/diskann/disk_layout.hpp"
 
 namespace alaya::diskann {
@@ -54,6 +59,7 @@ class NodeCache {
   struct Lookup {
     const char *record = nullptr;
     std::shared_ptr<const std::vector<char>> owned;
+    AdaptiveNodeCache::Pin pin;  // holds an adaptive-tier record in place
 
     [[nodiscard]] const char *get() const { return record; }
     [[nodiscard]] explicit operator bool() const { return record != nullptr; }
@@ -88,57 +94,48 @@ class NodeCache {
       throw std::invalid_argument("NodeCache::generate: medoid out of range");
     }
 
-    const DiskLayoutGeometry geom = DiskLayoutGeometry::compute(dim, max_degree);
-    dim_ = dim;
-    max_degree_ = max_degree;
-    node_len_ = geom.node_len;
-
-    uint64_t target = 0;
-    if (cache_ratio > 0.0) {
-      target = static_cast<uint64_t>(std::ceil(cache_ratio * static_cast<double>(num_points)));
-      if (target > num_points) {
-        target = num_points;
-      }
-    }
-
-    ids_.clear();
-    map_.clear();
-    node_data_.clear();
-    clear_overrides_unsafe();
-    if (target == 0) {
-      return;
-    }
-
-    // BFS from medoid, collecting nodes in dequeue (BFS) order.
-    std::vector<uint8_t> visited(num_points, 0);
-    std::queue<uint32_t> bfs;
-    bfs.push(medoid);
-    visited[medoid] = 1;
-    ids_.reserve(target);
-    while (!bfs.empty() && ids_.size() < target) {
-      const uint32_t u = bfs.front();
-      bfs.pop();
-      ids_.push_back(u);
-      for (const uint32_t v : graph[u]) {
-        if (v < num_points && visited[v] == 0) {
-          visited[v] = 1;
-          bfs.push(v);
-        }
-      }
-    }
-
-    // Pack records (zero-initialized so unused neighbor slots are zero-filled).
-    node_data_.assign(ids_.size() * node_len_, 0);
-    map_.reserve(ids_.size() * 2);
-    for (size_t i = 0; i < ids_.size(); ++i) {
-      const uint32_t id = ids_[i];
-      char *rec = node_data_.data() + i * node_len_;
+    bfs_collect(medoid, num_points, dim, max_degree, cache_ratio, [&](uint32_t id, char *rec) {
       const auto &nbrs = graph[id];
       const uint32_t n_nbrs =
           static_cast<uint32_t>(nbrs.size() > max_degree ? max_degree : nbrs.size());
       pack_node_record(rec, vectors + static_cast<uint64_t>(id) * dim, nbrs.data(), n_nbrs, dim);
-      map_[id] = i * node_len_;
+    });
+  }
+
+  /**
+   * @brief Select the BFS cache by reading node records from a written disk index.
+   *
+   * Same selection and record bytes as generate(), but the graph and vectors
+   * are never resident: each dequeued node's record is read from
+   * @p index_path (a diskann.index whose header matches the arguments). The
+   * out-of-core build uses this after streaming the layout to disk.
+   * @throws std::runtime_error if the file cannot be read.
+   */
+  void generate_from_disk(const std::string &index_path,
+                          uint32_t medoid,
+                          uint64_t num_points,
+                          uint64_t dim,
+                          uint32_t max_degree,
+                          double cache_ratio) {
+    if (num_points == 0 || dim == 0) {
+      throw std::invalid_argument("NodeCache::generate: num_points/dim must be > 0");
+    }
+    if (medoid >= num_points) {
+      throw std::invalid_argument("NodeCache::generate: medoid out of range");
     }
+    std::ifstream in(index_path, std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("NodeCache::generate_from_disk: cannot open " + index_path);
+    }
+    const DiskLayoutGeometry geom = DiskLayoutGeometry::compute(dim, max_degree);
+    bfs_collect(medoid, num_points, dim, max_degree, cache_ratio, [&](uint32_t id, char *rec) {
+      in.seekg(static_cast<std::streamoff>(geom.file_offset(id)), std::ios::beg);
+      in.read(rec, static_cast<std::streamsize>(geom.node_len));
+      if (!in) {
+        throw std::runtime_error("NodeCache::generate_from_disk: short read of node " +
+                                 std::to_string(id) + " in " + index_path);
+      }
+    });
   }
 
   // --- Persistence ---------------------------------------------------------
@@ -248,6 +245,7 @@ class NodeCache {
       map_[ids_[i]] = i * node_len_;
     }
     clear_overrides_unsafe();
+    adaptive_.reset();
   }
 
   void configure_geometry(uint64_t dim, uint32_t max_degree) {
@@ -277,9 +275,94 @@ class NodeCache {
       return hit;
     }
     // Base records are immutable after generate()/load(): lock-free read.
-    return Lookup{find_base_record(node_id), {}};
+    const char *base = find_base_record(node_id);
+    if (base != nullptr || adaptive_ == nullptr) {
+      return Lookup{base, {}};
+    }
+    Lookup hit;
+    hit.pin = adaptive_->find(node_id);
+    hit.record = hit.pin.get();
+    return hit;
+  }
+
+  /// Offer a record beam search just read from disk to the adaptive tier (a
+  /// no-op when it is disabled). @p record must be the node's full record.
+  void observe_miss(uint32_t node_id, const char *record) const {
+    if (adaptive_ != nullptr) {
+      adaptive_->admit(node_id, record);
+    }
   }
 
+  // --- Adaptive tier (read-only indices) -------------------------------------
+
+  /**
+   * @brief Enable the adaptive tier within @p budget_bytes of memory.
+   *
+   * The budget covers the record slab and the tier's per-record bookkeeping
+   * (see AdaptiveNodeCache::capacity_for_budget). Load-time only, after
+   * configure_geometry(). A budget too small for one record disables the
+   * tier. Must not be combined with upsert_node(): adaptive records are not
+   * invalidated by in-place updates.
+   */
+  void enable_adaptive(uint64_t budget_bytes) {
+    if (node_len_ == 0) {
+      throw std::runtime_error("NodeCache::enable_adaptive: cache geometry is not configured");
+    }
+    const uint64_t capacity = AdaptiveNodeCache::capacity_for_budget(budget_bytes, node_len_);
+    adaptive_ = capacity > 0 ? std::make_unique<AdaptiveNodeCache>(capacity, node_len_) : nullptr;
+  }
+
+  /**
+   * @brief Warm the adaptive tier from a hot set saved by save_adaptive().
+   *
+   * Records are read from @p index_path (the diskann.index this cache serves),
+   * hottest first, until the tier is full; ids >= @p num_points are skipped.
+   * @return Number of records installed.
+   */
+  uint64_t warm_adaptive(const std::string &hot_path,
+                         const std::string &index_path,
+                         uint64_t num_points) {
+    if (adaptive_ == nullptr) {
+      return 0;
+    }
+    const auto hot = AdaptiveNodeCache::load_hot_set(hot_path);
+    std::ifstream in(index_path, std::ios::binary);
+    if (!in) {
+      throw std::runtime_error("NodeCache::warm_adaptive: cannot open " + index_path);
+    }
+    const DiskLayoutGeometry geom = DiskLayoutGeometry::compute(dim_, max_degree_);
+    std::vector<char> rec(node_len_);
+    uint64_t installed = 0;
+    for (const auto &entry : hot) {
+      if (installed == adaptive_->capacity()) {
+        break;
+      }
+      if (entry.id >= num_points || find_base_record(entry.id) != nullptr) {
+        continue;
+      }
+      in.seekg(static_cast<std::streamoff>(geom.file_offset(entry.id)), std::ios::beg);
+      in.read(rec.data(), static_cast<std::streamsize>(node_len_));
+      if (!in) {
+        throw std::runtime_error("NodeCache::warm_adaptive: short read of node " +
+                                 std::to_string(entry.id) + " in " + index_path);
+      }
+      adaptive_->preload(entry.id, rec.data(), entry.freq);
+      ++installed;
+    }
+    return installed;
+  }
+
+  /// Persist the adaptive tier's resident ids (see AdaptiveNodeCache::save_hot_set).
+  void save_adaptive(const std::string &hot_path) const {
+    if (adaptive_ == nullptr) {
+      throw std::runtime_error("NodeCache::save_adaptive: adaptive tier is not enabled");
+    }
+    adaptive_->save_hot_set(hot_path);
+  }
+
+  /// The adaptive tier, or nullptr when disabled.
+  [[nodiscard]] const AdaptiveNodeCache *adaptive() const { return adaptive_.get(); }
+
   [[nodiscard]] const char *lookup(uint32_t node_id) const {
     const Lookup hit = lookup_record(node_id);
     return hit.get();
@@ -347,6 +430,71 @@ class NodeCache {
   [[nodiscard]] const std::vector<uint32_t> &ids() const { return ids_; }
 
  private:
+  /**
+   * @brief BFS from @p medoid over records produced by @p fetch(id, rec).
+   *
+   * Collects @c ceil(cache_ratio * num_points) nodes in dequeue order;
+   * @p fetch writes a node's @c node_len -byte record into zeroed storage and
+   * the BFS expands through the neighbor ids stored in that record.
+   */
+  template <typename FetchRecord>
+  void bfs_collect(uint32_t medoid,
+                   uint64_t num_points,
+                   uint64_t dim,
+                   uint32_t max_degree,
+                   double cache_ratio,
+                   FetchRecord &&fetch) {
+    const DiskLayoutGeometry geom = DiskLayoutGeometry::compute(dim, max_degree);
+    dim_ = dim;
+    max_degree_ = max_degree;
+    node_len_ = geom.node_len;
+
+    uint64_t target = 0;
+    if (cache_ratio > 0.0) {
+      target = static_cast<uint64_t>(std::ceil(cache_ratio * static_cast<double>(num_points)));
+      if (target > num_points) {
+        target = num_points;
+      }
+    }
+
+    ids_.clear();
+    map_.clear();
+    node_data_.clear();
+    clear_overrides_unsafe();
+    adaptive_.reset();
+    if (target == 0) {
+      return;
+    }
+
+    // BFS from medoid, collecting nodes in dequeue (BFS) order. Records are
+    // packed as nodes are dequeued (zero-initialized so unused neighbor slots
+    // are zero-filled).
+    std::vector<uint8_t> visited(num_points, 0);
+    std::queue<uint32_t> bfs;
+    bfs.push(medoid);
+    visited[medoid] = 1;
+    ids_.reserve(target);
+    node_data_.assign(target * node_len_, 0);
+    map_.reserve(target * 2);
+    while (!bfs.empty() && ids_.size() < target) {
+      const uint32_t u = bfs.front();
+      bfs.pop();
+      char *rec = node_data_.data() + ids_.size() * node_len_;
+      fetch(u, rec);
+      map_[u] = ids_.size() * node_len_;
+      ids_.push_back(u);
+      const NodeRecordView view{rec, dim};
+      const uint32_t n_nbrs = std::min(view.n_nbrs(), max_degree);
+      for (uint32_t k = 0; k < n_nbrs; ++k) {
+        const uint32_t v = view.nbrs()[k];
+        if (v < num_points && visited[v] == 0) {
+          visited[v] = 1;
+          bfs.push(v);
+        }
+      }
+    }
+    node_data_.resize(ids_.size() * node_len_);
+  }
   void validate_neighbors_input(uint32_t n_nbrs, const uint32_t *nbr_ids, const char *name) const {
     if (dim_ == 0 || node_len_ == 0) {
       throw std::runtime_error(std::string(name) + ": cache geometry is not configured");
@@ -425,6 +573,7 @@ class NodeCache {
   std::vector<char> node_data_;                 // size() * node_len_ bytes
   std::unordered_map<uint32_t, uint64_t> map_;  // node_id -> byte offset in node_data_
   mutable std::array<OverrideShard, kOverrideShards> override_shards_;
+  std::unique_ptr<AdaptiveNodeCache> adaptive_;  // learned hot records; read-only indices
 };
 
 }  // namespace alaya::diskann
@@ -19,12 +19,20 @@
  * The trained table (global centroid + codebook + codes) is immutable after
  * load and may be shared read-only across search threads; the per-query
  * distance table is owned by each thread's scratch (see search_scratch.hpp).
+ *
+ * 4-bit mode (code_bits = 4, 16 centroids per chunk) packs two chunk codes per
+ * byte and scores neighbors with the fast-scan kernel of
+ * utils/rabitq_utils/fastscan.hpp: the per-query table is additionally
+ * quantized to uint8, so a 16-entry chunk LUT fits one SIMD register and a
+ * block of 32 candidates is scored with pshufb lookups instead of one L1
+ * gather per chunk per candidate.
  */
 
 #pragma once
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -40,16 +48,45 @@
 
 #include "simd/distance_l2.hpp"
 #include "utils/prefetch.hpp"
+#include "utils/rabitq_utils/fastscan.hpp"
 
 namespace alaya::diskann {
 
 /// Number of centroids per chunk (uint8 codes => 256).
 inline constexpr uint32_t kPQNumCentroids = 256;
+/// Centroids per chunk in 4-bit (fast-scan) mode.
+inline constexpr uint32_t kPQ4NumCentroids = 16;
+
+/**
+ * @brief Chunk-major lookup-accumulate over a tile of @p m gathered code rows.
+ *
+ * @p tile holds the rows back to back (@p n_chunks bytes each). One 1 KiB
+ * dist_table row stays L1-hot across all rows of the tile and the inner loop
+ * vectorizes; each out[i] sums its chunks in ascending order, so the result is
+ * bit-identical to a per-row scalar sum.
+ */
+inline void pq_accumulate_tile(const uint8_t *tile,
+                               uint32_t m,
+                               uint32_t n_chunks,
+                               const float *dist_table,
+                               float *out) {
+  std::fill_n(out, m, 0.0F);
+  for (uint32_t c = 0; c < n_chunks; ++c) {
+    const float *row = dist_table + static_cast<size_t>(c) * kPQNumCentroids;
+    for (uint32_t i = 0; i < m; ++i) {
+      out[i] += row[tile[static_cast<size_t>(i) * n_chunks + c]];
+    }
+  }
+}
 
 class PQTable {
  public:
   PQTable() = default;
 
+  /// @param code_bits 8 (256 centroids, one byte per chunk) or 4 (16 centroids,
+  ///        two chunks per byte, fast-scan search).
+  explicit PQTable(uint32_t code_bits) { set_code_bits(code_bits); }
+
   // --- Build-time ----------------------------------------------------------
 
   /**
@@ -66,7 +103,8 @@ class PQTable {
    *         single-threaded run regardless of thread count.
    *
    * @throws std::invalid_argument if dim is not divisible by n_chunks, or any
-   *         size is zero.
+   *         size is zero; in 4-bit mode also if n_chunks is not a multiple of 4
+   *         or is above 256.
    */
   void train(const float *data,
              uint64_t n,
@@ -86,6 +124,7 @@ class PQTable {
                                   ") must be divisible by n_chunks (" + std::to_string(n_chunks) +
                                   ")");
     }
+    validate_chunks(n_chunks, "PQTable::train");
     dim_ = dim;
     n_chunks_ = n_chunks;
     chunk_dim_ = static_cast<uint32_t>(dim / n_chunks);
@@ -113,7 +152,7 @@ class PQTable {
       }
     }
 
-    codebook_.assign(static_cast<size_t>(n_chunks_) * kPQNumCentroids * chunk_dim_, 0.0f);
+    codebook_.assign(static_cast<size_t>(n_chunks_) * num_centroids_ * chunk_dim_, 0.0f);
 
     // Per-chunk training. Chunks are independent — each writes a disjoint codebook
     // region and trains with its own seed (seed + c) — so they parallelize with a
@@ -135,7 +174,7 @@ class PQTable {
                       residual.data() + i * dim_ + static_cast<uint64_t>(c) * chunk_dim_,
                       chunk_dim_ * sizeof(float));
         }
-        float *centroids = codebook_.data() + static_cast<size_t>(c) * kPQNumCentroids * chunk_dim_;
+        float *centroids = codebook_.data() + static_cast<size_t>(c) * num_centroids_ * chunk_dim_;
         train_chunk(chunk_data.data(), n, centroids, n_iters, seed + c);
       }
     };
@@ -151,10 +190,11 @@ class PQTable {
         th.join();
       }
     }
+    build_symmetric_distance_table();
   }
 
   /**
-   * @brief Encode @p n vectors into @c n*n_chunks uint8 codes (row-major).
+   * @brief Encode @p n vectors into @c n*code_bytes() codes (row-major).
    *
    * Stores the codes internally (queryable via pq_distance / codes()). Each
    * vector's code row is independent, so encoding parallelizes across points
@@ -170,8 +210,32 @@ class PQTable {
     }
     ensure_l2();
     num_points_ = n;
-    codes_.assign(static_cast<size_t>(n) * n_chunks_, 0);
+    codes_.assign(static_cast<size_t>(n) * code_bytes_, 0);
+    encode_rows(data, n, codes_.data(), num_threads);
+  }
 
+  /**
+   * @brief Encode @p n vectors into the caller-owned @p codes_out
+   *        (@c n*code_bytes() bytes) without storing them in the table.
+   *
+   * The out-of-core build streams the base file through this in blocks and
+   * appends each block to pq_compressed.bin, so the full code table is never
+   * resident. Same threading and byte-identical output as encode().
+   * @throws std::logic_error if called before train()/load().
+   */
+  void encode_rows(const float *data,
+                   uint64_t n,
+                   uint8_t *codes_out,
+                   uint32_t num_threads = 0) const {
+    if (codebook_.empty()) {
+      throw std::logic_error("PQTable::encode_rows: not trained");
+    }
+    if (n == 0) {
+      return;
+    }
+    if (data == nullptr || codes_out == nullptr) {
+      throw std::invalid_argument("PQTable::encode_rows: null input/output");
+    }
     const uint32_t hw = std::max<uint32_t>(1, std::thread::hardware_concurrency());
     const uint32_t want = num_threads == 0 ? hw : num_threads;
     const uint32_t workers =
@@ -189,7 +253,7 @@ class PQTable {
         for (uint64_t i = start; i < end; ++i) {
           const float *v = data + i * dim_;
           build_residual(v, r.data());
-          uint8_t *code_row = codes_.data() + i * n_chunks_;
+          uint8_t *code_row = codes_out + i * code_bytes_;
           encode_residual_to_row(r.data(), code_row);
         }
       }
@@ -206,7 +270,6 @@ class PQTable {
         th.join();
       }
     }
-    build_symmetric_distance_table();
   }
 
   /// Encode one vector into @p point_id, overwriting existing slots or growing
@@ -221,15 +284,16 @@ class PQTable {
     ensure_l2();
     const uint64_t new_points = point_id + 1;
     if (new_points > num_points_) {
-      codes_.resize(static_cast<size_t>(new_points) * n_chunks_, 0);
+      codes_.resize(static_cast<size_t>(new_points) * code_bytes_, 0);
       num_points_ = new_points;
     }
     std::vector<float> residual(dim_);
     build_residual(vector, residual.data());
-    encode_residual_to_row(residual.data(), codes_.data() + point_id * n_chunks_);
+    encode_residual_to_row(residual.data(), codes_.data() + point_id * code_bytes_);
   }
 
-  /// Encode one vector into a caller-owned code row without mutating the table.
+  /// Encode one vector into a caller-owned code row (code_bytes() bytes)
+  /// without mutating the table.
   void encode_to_code(const float *vector, uint8_t *code_out) const {
     if (codebook_.empty()) {
       throw std::logic_error("PQTable::encode_to_code: not trained");
@@ -245,12 +309,14 @@ class PQTable {
   // --- Search-time ---------------------------------------------------------
 
   /**
-   * @brief Precompute the @c n_chunks x 256 query distance table.
+   * @brief Precompute the @c n_chunks x num_centroids() query distance table.
    *
    * @param query      Query vector (dim float32).
-   * @param table_out  Caller-owned buffer of @c n_chunks*256 float32. Entry
-   *                   [c*256 + k] = squared L2 between the query's chunk-c
-   *                   residual and centroid k of chunk c.
+   * @param table_out  Caller-owned buffer of query_table_size() float32. Entry
+   *                   [c*K + k] = squared L2 between the query's chunk-c
+   *                   residual and centroid k of chunk c (K = num_centroids()).
+   *                   In 4-bit mode the quantized fast-scan LUT follows the
+   *                   float entries (see quantize_lut()).
    * @param scratch    Caller-owned buffer of @c dim float32 for the query residual.
    */
   void preprocess_query(const float *query, float *table_out, float *scratch) const {
@@ -262,12 +328,25 @@ class PQTable {
     }
     for (uint32_t c = 0; c < n_chunks_; ++c) {
       const float *qchunk = scratch + static_cast<uint64_t>(c) * chunk_dim_;
-      const float *cent = codebook_.data() + static_cast<size_t>(c) * kPQNumCentroids * chunk_dim_;
-      float *trow = table_out + static_cast<size_t>(c) * kPQNumCentroids;
-      for (uint32_t k = 0; k < kPQNumCentroids; ++k) {
+      const float *cent = codebook_.data() + static_cast<size_t>(c) * num_centroids_ * chunk_dim_;
+      float *trow = table_out + static_cast<size_t>(c) * num_centroids_;
+      for (uint32_t k = 0; k < num_centroids_; ++k) {
         trow[k] = l2_(qchunk, cent + static_cast<size_t>(k) * chunk_dim_, chunk_dim_);
       }
     }
+    if (code_bits_ == 4) {
+      quantize_lut(table_out);
+    }
+  }
+
+  /// Floats preprocess_query() writes: the n_chunks x K distances, plus in
+  /// 4-bit mode the LUT scale/bias and the n_chunks x 16 uint8 LUT.
+  [[nodiscard]] size_t query_table_size() const {
+    const size_t entries = static_cast<size_t>(n_chunks_) * num_centroids_;
+    if (code_bits_ != 4) {
+      return entries;
+    }
+    return entries + kLutHeaderFloats + (entries + sizeof(float) - 1) / sizeof(float);
   }
 
   /**
@@ -277,7 +356,16 @@ class PQTable {
    * @return sum over chunks of dist_table[c*256 + code(point_id, c)].
    */
   [[nodiscard]] float pq_distance(uint64_t point_id, const float *dist_table) const {
-    const uint8_t *code_row = codes_.data() + point_id * n_chunks_;
+    const uint8_t *code_row = codes_.data() + point_id * code_bytes_;
+    if (code_bits_ == 4) {
+      // Same quantized LUT as the fast-scan batch, so seeds and neighbors compare.
+      const uint8_t *lut = lut_bytes(dist_table);
+      uint32_t sum = 0;
+      for (uint32_t c = 0; c < n_chunks_; ++c) {
+        sum += lut[static_cast<size_t>(c) * kPQ4NumCentroids + chunk_code(code_row, c)];
+      }
+      return lut_distance(dist_table, static_cast<uint16_t>(sum));
+    }
     float sum = 0.0f;
     for (uint32_t c = 0; c < n_chunks_; ++c) {
       sum += dist_table[static_cast<size_t>(c) * kPQNumCentroids + code_row[c]];
@@ -301,6 +389,10 @@ class PQTable {
                          uint32_t n,
                          const float *dist_table,
                          float *out) const {
+    if (code_bits_ == 4) {
+      pq4_distance_batch(point_ids, n, dist_table, out);
+      return;
+    }
     constexpr uint32_t kTilePoints = 96;  // >= max node degree; a few KiB of stack
     constexpr uint32_t kTileChunks = 64;  // codes tile is kTilePoints * kTileChunks
     if (n_chunks_ > kTileChunks) {        // exotic config: keep the scalar path
@@ -321,14 +413,7 @@ class PQTable {
                     base + static_cast<size_t>(point_ids[off + i]) * n_chunks_,
                     n_chunks_);
       }
-      float *o = out + off;
-      std::fill_n(o, m, 0.0F);
-      for (uint32_t c = 0; c < n_chunks_; ++c) {
-        const float *row = dist_table + static_cast<size_t>(c) * kPQNumCentroids;
-        for (uint32_t i = 0; i < m; ++i) {
-          o[i] += row[tile[static_cast<size_t>(i) * n_chunks_ + c]];
-        }
-      }
+      pq_accumulate_tile(tile, m, n_chunks_, dist_table, out + off);
     }
   }
 
@@ -337,7 +422,7 @@ class PQTable {
     if (lhs >= num_points_ || rhs >= num_points_) {
       throw std::out_of_range("PQTable::pq_symmetric_distance: point id out of range");
     }
-    return pq_symmetric_distance(codes_.data() + lhs * n_chunks_, rhs);
+    return pq_symmetric_distance(codes_.data() + lhs * code_bytes_, rhs);
   }
 
   /// Symmetric PQ distance from a caller-owned code row to a stored point.
@@ -348,14 +433,20 @@ class PQTable {
     if (rhs >= num_points_) {
       throw std::out_of_range("PQTable::pq_symmetric_distance: point id out of range");
     }
+    return pq_symmetric_distance_codes(lhs_code, codes_.data() + rhs * code_bytes_);
+  }
+
+  /// Symmetric PQ distance between two caller-owned code rows.
+  [[nodiscard]] float pq_symmetric_distance_codes(const uint8_t *lhs_code,
+                                                  const uint8_t *rhs_code) const {
     if (sym_dists_.empty()) {
       throw std::logic_error("PQTable::pq_symmetric_distance: symmetric table not built");
     }
-    const uint8_t *rhs_code = codes_.data() + rhs * n_chunks_;
+    const size_t k = num_centroids_;
     float sum = 0.0f;
     for (uint32_t c = 0; c < n_chunks_; ++c) {
-      const size_t off = static_cast<size_t>(c) * kPQNumCentroids * kPQNumCentroids;
-      sum += sym_dists_[off + static_cast<size_t>(lhs_code[c]) * kPQNumCentroids + rhs_code[c]];
+      const size_t off = static_cast<size_t>(c) * k * k;
+      sum += sym_dists_[off + chunk_code(lhs_code, c) * k + chunk_code(rhs_code, c)];
     }
     return sum;
   }
@@ -368,22 +459,7 @@ class PQTable {
    *        the index meta.bin).
    */
   void save(const std::string &pivots_path, const std::string &compressed_path) const {
-    if (codebook_.empty()) {
-      throw std::logic_error("PQTable::save: not trained");
-    }
-    {
-      std::ofstream out(pivots_path, std::ios::binary | std::ios::trunc);
-      if (!out) {
-        throw std::runtime_error("PQTable::save: cannot open " + pivots_path);
-      }
-      out.write(reinterpret_cast<const char *>(global_centroid_.data()),
-                static_cast<std::streamsize>(global_centroid_.size() * sizeof(float)));
-      out.write(reinterpret_cast<const char *>(codebook_.data()),
-                static_cast<std::streamsize>(codebook_.size() * sizeof(float)));
-      if (!out) {
-        throw std::runtime_error("PQTable::save: write failed for " + pivots_path);
-      }
-    }
+    save_pivots(pivots_path);
     {
       std::ofstream out(compressed_path, std::ios::binary | std::ios::trunc);
       if (!out) {
@@ -397,6 +473,24 @@ class PQTable {
     }
   }
 
+  /// Write pq_pivots.bin only (the codes are written separately, e.g. by encode_rows()).
+  void save_pivots(const std::string &pivots_path) const {
+    if (codebook_.empty()) {
+      throw std::logic_error("PQTable::save: not trained");
+    }
+    std::ofstream out(pivots_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("PQTable::save: cannot open " + pivots_path);
+    }
+    out.write(reinterpret_cast<const char *>(global_centroid_.data()),
+              static_cast<std::streamsize>(global_centroid_.size() * sizeof(float)));
+    out.write(reinterpret_cast<const char *>(codebook_.data()),
+              static_cast<std::streamsize>(codebook_.size() * sizeof(float)));
+    if (!out) {
+      throw std::runtime_error("PQTable::save: write failed for " + pivots_path);
+    }
+  }
+
   /**
    * @brief Load pq_pivots.bin + pq_compressed.bin. Shape (n, dim, n_chunks) is
    *        supplied by the caller (from meta.bin) and validated against file
@@ -406,10 +500,13 @@ class PQTable {
             const std::string &compressed_path,
             uint64_t n,
             uint64_t dim,
-            uint32_t n_chunks) {
+            uint32_t n_chunks,
+            uint32_t code_bits = 8) {
     if (n == 0 || dim == 0 || n_chunks == 0 || dim % n_chunks != 0) {
       throw std::invalid_argument("PQTable::load: invalid shape");
     }
+    set_code_bits(code_bits);
+    validate_chunks(n_chunks, "PQTable::load");
     dim_ = dim;
     n_chunks_ = n_chunks;
     chunk_dim_ = static_cast<uint32_t>(dim / n_chunks);
@@ -417,7 +514,7 @@ class PQTable {
     ensure_l2();
 
     const size_t centroid_floats = dim_;
-    const size_t codebook_floats = static_cast<size_t>(n_chunks_) * kPQNumCentroids * chunk_dim_;
+    const size_t codebook_floats = static_cast<size_t>(n_chunks_) * num_centroids_ * chunk_dim_;
     const uint64_t expect_pivots = (centroid_floats + codebook_floats) * sizeof(float);
 
     std::error_code ec;
@@ -444,7 +541,7 @@ class PQTable {
       throw std::runtime_error("PQTable::load: short read on " + pivots_path);
     }
 
-    const uint64_t expect_codes = n * n_chunks_;
+    const uint64_t expect_codes = n * code_bytes_;
     const auto codes_size = std::filesystem::file_size(compressed_path, ec);
     if (ec) {
       throw std::runtime_error("PQTable::load: cannot stat " + compressed_path);
@@ -470,18 +567,20 @@ class PQTable {
   static PQTable from_codebook(uint64_t dim,
                                uint32_t n_chunks,
                                std::vector<float> global_centroid,
-                               std::vector<float> codebook) {
+                               std::vector<float> codebook,
+                               uint32_t code_bits = 8) {
     if (dim == 0 || n_chunks == 0 || dim % n_chunks != 0) {
       throw std::invalid_argument("PQTable::from_codebook: invalid shape");
     }
-    PQTable t;
+    PQTable t(code_bits);
+    t.validate_chunks(n_chunks, "PQTable::from_codebook");
     t.dim_ = dim;
     t.n_chunks_ = n_chunks;
     t.chunk_dim_ = static_cast<uint32_t>(dim / n_chunks);
     if (global_centroid.size() != dim) {
       throw std::invalid_argument("PQTable::from_codebook: global_centroid size");
     }
-    if (codebook.size() != static_cast<size_t>(n_chunks) * kPQNumCentroids * t.chunk_dim_) {
+    if (codebook.size() != static_cast<size_t>(n_chunks) * t.num_centroids_ * t.chunk_dim_) {
       throw std::invalid_argument("PQTable::from_codebook: codebook size");
     }
     t.global_centroid_ = std::move(global_centroid);
@@ -497,11 +596,129 @@ class PQTable {
   [[nodiscard]] uint64_t dim() const { return dim_; }
   [[nodiscard]] uint32_t n_chunks() const { return n_chunks_; }
   [[nodiscard]] uint32_t chunk_dim() const { return chunk_dim_; }
+  [[nodiscard]] uint32_t code_bits() const { return code_bits_; }
+  [[nodiscard]] uint32_t num_centroids() const { return num_centroids_; }
+  /// Bytes per encoded point: n_chunks (8-bit) or n_chunks / 2 (4-bit).
+  [[nodiscard]] uint32_t code_bytes() const { return code_bytes_; }
   [[nodiscard]] const std::vector<float> &global_centroid() const { return global_centroid_; }
   [[nodiscard]] const std::vector<float> &codebook() const { return codebook_; }
   [[nodiscard]] const std::vector<uint8_t> &codes() const { return codes_; }
 
  private:
+  /// Floats at the start of the 4-bit LUT region: scale, bias.
+  static constexpr size_t kLutHeaderFloats = 2;
+
+  void set_code_bits(uint32_t code_bits) {
+    if (code_bits != 8 && code_bits != 4) {
+      throw std::invalid_argument("PQTable: code_bits must be 8 or 4, got " +
+                                  std::to_string(code_bits));
+    }
+    code_bits_ = code_bits;
+    num_centroids_ = code_bits == 8 ? kPQNumCentroids : kPQ4NumCentroids;
+  }
+
+  /// Fix n_chunks-dependent sizes; 4-bit packs chunk pairs, accumulates
+  /// uint8 LUT entries in uint16 lanes and hands fastscan::accumulate() a
+  /// 4 * n_chunks dim it only vectorizes when divisible by 16, so it needs a
+  /// multiple of 4 <= 256.
+  void validate_chunks(uint32_t n_chunks, const char *who) {
+    if (code_bits_ == 4 && (n_chunks % 4 != 0 || n_chunks > 256)) {
+      throw std::invalid_argument(std::string(who) +
+                                  ": 4-bit PQ needs n_chunks a multiple of 4 and <= 256, got " +
+                                  std::to_string(n_chunks));
+    }
+    code_bytes_ = code_bits_ == 8 ? n_chunks : n_chunks / 2;
+  }
+
+  /// Chunk @p c of a code row; 4-bit rows hold chunk 2i in the high nibble of
+  /// byte i (the fast-scan pack_codes() order).
+  [[nodiscard]] size_t chunk_code(const uint8_t *row, uint32_t c) const {
+    if (code_bits_ == 8) {
+      return row[c];
+    }
+    const uint8_t b = row[c >> 1];
+    return (c & 1U) != 0U ? (b & 0x0F) : (b >> 4);
+  }
+
+  [[nodiscard]] const uint8_t *lut_bytes(const float *dist_table) const {
+    return reinterpret_cast<const uint8_t *>(
+        dist_table + static_cast<size_t>(n_chunks_) * num_centroids_ + kLutHeaderFloats);
+  }
+
+  [[nodiscard]] float lut_distance(const float *dist_table, uint16_t sum) const {
+    const float *header = dist_table + static_cast<size_t>(n_chunks_) * num_centroids_;
+    return header[0] * static_cast<float>(sum) + header[1];
+  }
+
+  /**
+   * @brief Quantize the float table to the uint8 fast-scan LUT (4-bit mode).
+   *
+   * Each chunk row is shifted by its minimum and all rows share one scale
+   * (largest row range / 255), so distance ~= scale * sum(lut) + sum(min).
+   * The header and LUT are written right after the float entries.
+   */
+  void quantize_lut(float *dist_table) const {
+    const size_t k = num_centroids_;
+    float bias = 0.0f;
+    float range = 0.0f;
+    for (uint32_t c = 0; c < n_chunks_; ++c) {
+      const float *row = dist_table + c * k;
+      const auto [lo, hi] = std::minmax_element(row, row + k);
+      bias += *lo;
+      range = std::max(range, *hi - *lo);
+    }
+    const float scale = range > 0.0f ? range / 255.0f : 1.0f;
+    const float inv = 1.0f / scale;
+    float *header = dist_table + static_cast<size_t>(n_chunks_) * k;
+    header[0] = scale;
+    header[1] = bias;
+    auto *lut = reinterpret_cast<uint8_t *>(header + kLutHeaderFloats);
+    for (uint32_t c = 0; c < n_chunks_; ++c) {
+      const float *row = dist_table + c * k;
+      const float lo = *std::min_element(row, row + k);
+      for (size_t j = 0; j < k; ++j) {
+        const float q = std::nearbyint((row[j] - lo) * inv);
+        lut[c * k + j] = static_cast<uint8_t>(std::min(q, 255.0f));
+      }
+    }
+  }
+
+  /**
+   * @brief Fast-scan batch for 4-bit codes: gather up to 32 code rows, pack
+   *        them into the block layout of fastscan::pack_codes(), and score the
+   *        block with fastscan::accumulate() (pshufb over the uint8 LUT).
+   */
+  void pq4_distance_batch(const uint32_t *point_ids,
+                          uint32_t n,
+                          const float *dist_table,
+                          float *out) const {
+    constexpr uint32_t kBlock = fastscan::kBatchSize;
+    constexpr uint32_t kMaxCodeBytes = 128;  // n_chunks <= 256
+    const uint8_t *base = codes_.data();
+    const uint8_t *lut = lut_bytes(dist_table);
+    // fastscan counts 4-bit segments as "dim / 4", so n_chunks nibbles <=> dim = 4 * n_chunks
+    const size_t fs_dim = static_cast<size_t>(n_chunks_) * 4;
+    alignas(64) uint8_t rows[kBlock * kMaxCodeBytes];
+    alignas(64) uint8_t block[kBlock * kMaxCodeBytes];
+    alignas(64) uint16_t sums[kBlock];
+    for (uint32_t off = 0; off < n; off += kBlock) {
+      const uint32_t m = std::min(kBlock, n - off);
+      for (uint32_t i = 0; i < m; ++i) {
+        if (i + 4 < m) {
+          alaya::prefetch_l3(base + static_cast<size_t>(point_ids[off + i + 4]) * code_bytes_);
+        }
+        std::memcpy(rows + static_cast<size_t>(i) * code_bytes_,
+                    base + static_cast<size_t>(point_ids[off + i]) * code_bytes_,
+                    code_bytes_);
+      }
+      fastscan::pack_codes(fs_dim, rows, m, block);
+      fastscan::accumulate(block, lut, sums, fs_dim);
+      for (uint32_t i = 0; i < m; ++i) {
+        out[off + i] = lut_distance(dist_table, sums[i]);
+      }
+    }
+  }
+
   void ensure_l2() {
     if (l2_ == nullptr) {
       l2_ = alaya::simd::get_l2_sqr_func();
@@ -510,7 +727,7 @@ class PQTable {
 
   /// argmin over the 256 centroids of chunk @p c for a chunk residual vector.
   [[nodiscard]] uint8_t nearest_centroid(const float *chunk_residual, uint32_t c) const {
-    const float *cent = codebook_.data() + static_cast<size_t>(c) * kPQNumCentroids * chunk_dim_;
+    const float *cent = codebook_.data() + static_cast<size_t>(c) * num_centroids_ * chunk_dim_;
     return static_cast<uint8_t>(argmin_centroid(chunk_residual, cent));
   }
 
@@ -521,6 +738,15 @@ class PQTable {
   }
 
   void encode_residual_to_row(const float *residual, uint8_t *code_row) const {
+    if (code_bits_ == 4) {
+      for (uint32_t c = 0; c < n_chunks_; c += 2) {
+        const uint8_t hi = nearest_centroid(residual + static_cast<uint64_t>(c) * chunk_dim_, c);
+        const uint8_t lo =
+            nearest_centroid(residual + static_cast<uint64_t>(c + 1) * chunk_dim_, c + 1);
+        code_row[c >> 1] = static_cast<uint8_t>((hi << 4) | lo);
+      }
+      return;
+    }
     for (uint32_t c = 0; c < n_chunks_; ++c) {
       code_row[c] = nearest_centroid(residual + static_cast<uint64_t>(c) * chunk_dim_, c);
     }
@@ -532,15 +758,15 @@ class PQTable {
       return;
     }
     ensure_l2();
-    sym_dists_.assign(static_cast<size_t>(n_chunks_) * kPQNumCentroids * kPQNumCentroids, 0.0f);
+    const size_t k = num_centroids_;
+    sym_dists_.assign(static_cast<size_t>(n_chunks_) * k * k, 0.0f);
     for (uint32_t c = 0; c < n_chunks_; ++c) {
-      const float *centroids =
-          codebook_.data() + static_cast<size_t>(c) * kPQNumCentroids * chunk_dim_;
-      float *out = sym_dists_.data() + static_cast<size_t>(c) * kPQNumCentroids * kPQNumCentroids;
-      for (uint32_t lhs = 0; lhs < kPQNumCentroids; ++lhs) {
+      const float *centroids = codebook_.data() + static_cast<size_t>(c) * k * chunk_dim_;
+      float *out = sym_dists_.data() + static_cast<size_t>(c) * k * k;
+      for (uint32_t lhs = 0; lhs < k; ++lhs) {
         const float *lhs_centroid = centroids + static_cast<size_t>(lhs) * chunk_dim_;
-        for (uint32_t rhs = 0; rhs < kPQNumCentroids; ++rhs) {
-          out[static_cast<size_t>(lhs) * kPQNumCentroids + rhs] =
+        for (uint32_t rhs = 0; rhs < k; ++rhs) {
+          out[static_cast<size_t>(lhs) * k + rhs] =
               l2_(lhs_centroid, centroids + static_cast<size_t>(rhs) * chunk_dim_, chunk_dim_);
         }
       }
@@ -548,9 +774,10 @@ class PQTable {
   }
 
   /**
-   * @brief Train one chunk's 256 centroids into @p centroids (256*chunk_dim).
+   * @brief Train one chunk's K centroids into @p centroids (K*chunk_dim,
+   *        K = num_centroids()).
    *
-   * For n <= 256 the training points themselves become the centroids (padded),
+   * For n <= K the training points themselves become the centroids (padded),
    * which makes small-input encoding exact and deterministic. For n > 256 we
    * run k-means++ init followed by @p n_iters Lloyd iterations.
    */
@@ -560,12 +787,13 @@ class PQTable {
                    uint32_t n_iters,
                    uint64_t seed) const {
     const uint32_t cd = chunk_dim_;
-    if (n <= kPQNumCentroids) {
+    const uint32_t kc = num_centroids_;
+    if (n <= kc) {
       for (uint64_t i = 0; i < n; ++i) {
         std::memcpy(centroids + i * cd, chunk_data + i * cd, cd * sizeof(float));
       }
       // Pad remaining centroids with a copy of the last real point.
-      for (uint64_t k = n; k < kPQNumCentroids; ++k) {
+      for (uint64_t k = n; k < kc; ++k) {
         std::memcpy(centroids + k * cd, chunk_data + (n - 1) * cd, cd * sizeof(float));
       }
       return;
@@ -575,8 +803,8 @@ class PQTable {
     kmeanspp_init(chunk_data, n, centroids, rng);
 
     std::vector<uint32_t> assign(n, 0);
-    std::vector<double> sums(static_cast<size_t>(kPQNumCentroids) * cd, 0.0);
-    std::vector<uint64_t> counts(kPQNumCentroids, 0);
+    std::vector<double> sums(static_cast<size_t>(kc) * cd, 0.0);
+    std::vector<uint64_t> counts(kc, 0);
     for (uint32_t iter = 0; iter < n_iters; ++iter) {
       // Assignment step.
       for (uint64_t i = 0; i < n; ++i) {
@@ -594,7 +822,7 @@ class PQTable {
           s[d] += p[d];
         }
       }
-      for (uint32_t k = 0; k < kPQNumCentroids; ++k) {
+      for (uint32_t k = 0; k < kc; ++k) {
         if (counts[k] == 0) {
           // Empty cluster: reseed to a deterministic random training point.
           const uint64_t idx = rng() % n;
@@ -613,13 +841,13 @@ class PQTable {
     }
   }
 
-  /// argmin over a chunk's 256-centroid block @p centroids (returns the index).
+  /// argmin over a chunk's K-centroid block @p centroids (returns the index).
   /// Shared by k-means assignment (train) and encoding.
   [[nodiscard]] uint32_t argmin_centroid(const float *point, const float *centroids) const {
     const uint32_t cd = chunk_dim_;
     float best = std::numeric_limits<float>::max();
     uint32_t best_k = 0;
-    for (uint32_t k = 0; k < kPQNumCentroids; ++k) {
+    for (uint32_t k = 0; k < num_centroids_; ++k) {
       const float d = l2_(point, centroids + static_cast<size_t>(k) * cd, cd);
       if (d < best) {
         best = d;
@@ -629,7 +857,7 @@ class PQTable {
     return best_k;
   }
 
-  /// k-means++ seeding of 256 centroids (D^2 weighting).
+  /// k-means++ seeding of K centroids (D^2 weighting).
   void kmeanspp_init(const float *chunk_data,
                      uint64_t n,
                      float *centroids,
@@ -640,7 +868,7 @@ class PQTable {
     std::memcpy(centroids, chunk_data + first * cd, cd * sizeof(float));
 
     std::vector<float> d2(n, std::numeric_limits<float>::max());
-    for (uint32_t k = 1; k < kPQNumCentroids; ++k) {
+    for (uint32_t k = 1; k < num_centroids_; ++k) {
       const float *prev = centroids + static_cast<size_t>(k - 1) * cd;
       double total = 0.0;
       for (uint64_t i = 0; i < n; ++i) {
@@ -674,10 +902,13 @@ class PQTable {
   uint32_t n_chunks_ = 0;
   uint32_t chunk_dim_ = 0;
   uint64_t num_points_ = 0;
-  std::vector<float> global_centroid_;  // dim
-  std::vector<float> codebook_;         // n_chunks * 256 * chunk_dim
-  std::vector<uint8_t> codes_;          // num_points * n_chunks
-  std::vector<float> sym_dists_;        // n_chunks * 256 * 256 centroid L2 table
+  uint32_t code_bits_ = 8;
+  uint32_t num_centroids_ = kPQNumCentroids;  // K: 256 (8-bit) or 16 (4-bit)
+  uint32_t code_bytes_ = 0;                   // per point: n_chunks or n_chunks / 2
+  std::vector<float> global_centroid_;        // dim
+  std::vector<float> codebook_;               // n_chunks * K * chunk_dim
+  std::vector<uint8_t> codes_;                // num_points * code_bytes
+  std::vector<float> sym_dists_;              // n_chunks * K * K centroid L2 table
   alaya::simd::L2SqrFunc l2_ = nullptr;
 };
 
@@ -11,7 +11,7 @@
  *   - the visited bitset (dedup of popped nodes),
  *   - the @c retset frontier (NeighborPriorityQueue, reused from Vamana),
  *   - @c exact_dists: exact L2 distances of nodes actually read from disk/cache,
- *   - @c pq_table: the per-query @c n_chunks x 256 PQ distance table (PQ mode),
+ *   - @c pq_table: the per-query PQ distance table (PQTable::query_table_size()),
  *   - @c sector_scratch: a sector-aligned double buffer for async page reads,
  *   - @c ctx_: the thread's AlignedFileReader I/O context.
  *
@@ -70,10 +70,12 @@ struct ThreadData {
   // --- Per-query mutable search state ---
   VisitedBitset visited_bits;                   ///< ids popped/seeded
   alaya::vamana::NeighborPriorityQueue retset;  ///< exploration frontier
+  alaya::vamana::NeighborPriorityQueue filtered;  ///< filtered search: matching nodes seen
   std::vector<float> exact_dists;               ///< node id -> exact L2 sqr or NaN
   std::vector<uint32_t> exact_dirty;            ///< exact_dists entries written this query
-  std::vector<float> pq_table;                  ///< n_chunks*256 (empty if no PQ)
+  std::vector<float> pq_table;                  ///< query_table_size() (empty if no PQ)
   std::vector<float> pq_qres;                   ///< dim floats for PQ query residual
+  std::vector<float> query_xform;               ///< dim floats: IP/COS query in stored space
   std::vector<uint32_t> nbrs_buf;               ///< contiguous cached neighbor lists
   std::vector<std::pair<uint32_t, uint32_t>> nbrs_offsets;  ///< id -> (start, len)
   std::vector<uint32_t> nbrs_dirty;                         ///< offsets written this query
@@ -122,6 +124,8 @@ struct ThreadData {
     clear_inflight();
     retset.reserve(search_list_size);
     retset.clear();
+    filtered.reserve(search_list_size);
+    filtered.clear();
   }
 
   /// Allocate the sector page buffer, flat hot-path structures, and PQ scratch.
@@ -137,6 +141,7 @@ struct ThreadData {
     }
     if (config.query_dim > 0) {
       pq_qres.assign(config.query_dim, 0.0f);
+      query_xform.assign(config.query_dim, 0.0f);
     }
     visited_bits.resize(config.max_slot_id);
     exact_dists.assign(config.max_slot_id, std::numeric_limits<float>::quiet_NaN());
@@ -15,16 +15,20 @@
 #include <cstdint>
 #include <cstring>
 #include <deque>
+#include <exception>
 #include <filesystem>  // NOLINT(build/c++17)
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <latch>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -69,6 +73,8 @@ struct ThreadData {
   char *cur_page_scratch_ = nullptr;
   float *pca_query_scratch_ = nullptr;  // Buffer for PCA-transformed query
   std::shared_ptr<std::vector<float>> pca_query_scratch_storage_;
+  size_t sector_scratch_beam_width_ = 0;  // sector_scratch_ holds 2 * this many pages
+  size_t visited_ef_ = 0;                 // ef_search the visited set was sized for
 };
 
 struct ClusterStats {
@@ -127,7 +133,6 @@ class QuantizedGraph {
   float total_io_time_ = 0;
   float total_io_time1_ = 0;
   int64_t total_cpu_time_ = 0;
-  float total_read_num_ = 0;
   float total_iter_num_ = 0;
   float total_cache_num_ = 0;
   int64_t total_ks_time_ = 0;
@@ -150,14 +155,20 @@ class QuantizedGraph {
   size_t neighbor_offset_ = 0;  // pos of Neighbors
   size_t row_offset_ = 0;       // length of entire row
 
+  size_t thread_data_pool_builds_ = 0;
+
   void initialize();
   void allocate_data();
   void init_workspace();
+  void build_thread_data_pool();
+  void prepare_thread_data(ThreadData &data, size_t ef_search, size_t beam_width) const;
 
   // search on disk-based quantized graph
   void disk_search_qg(const float *ALAYA_RESTRICT query,
                       uint32_t knn,
-                      uint32_t *ALAYA_RESTRICT results);
+                      uint32_t *ALAYA_RESTRICT results,
+                      size_t ef_search,
+                      size_t beam_width);
 
   void copy_vectors(const float *);
 
@@ -213,6 +224,15 @@ class QuantizedGraph {
 
   void set_params(size_t ef_search, size_t num_threads, int beam_width);
 
+  /*
+   * Select the disk reader backend (e.g. io_uring with registered files and
+   * fixed sector buffers). Rebuilds the ThreadData pool if the index is loaded.
+   */
+  void set_io_backend(const AlignedReaderOptions &options);
+
+  // Submit / wait syscalls issued by the query-path reader so far.
+  [[nodiscard]] auto io_syscalls() const { return aligned_file_reader_->io_syscalls(); }
+
   void load_medoids(const char *);
 
   void load_cache(std::string &cache_ids_file,
@@ -224,6 +244,21 @@ class QuantizedGraph {
   /* search and copy results to KNN */
   void search(const float *ALAYA_RESTRICT query, uint32_t knn, uint32_t *ALAYA_RESTRICT results);
 
+  /*
+   * search with per-query ef / beam width. Unlike set_params() this never tears
+   * down the ThreadData pool: the checked-out ThreadData is resized in place when
+   * the request exceeds its current scratch, so concurrent callers with different
+   * parameters run in parallel, bounded only by the pool size.
+   */
+  void search(const float *ALAYA_RESTRICT query,
+              uint32_t knn,
+              uint32_t *ALAYA_RESTRICT results,
+              size_t ef_search,
+              size_t beam_width);
+
+  // Number of times the ThreadData pool has been (re)built; test observer.
+  [[nodiscard]] auto thread_data_pool_builds() const { return thread_data_pool_builds_; }
+
   void batch_search(const float *ALAYA_RESTRICT query,
                     uint32_t knn,
                     uint32_t *ALAYA_RESTRICT results,
@@ -318,27 +353,14 @@ inline void QuantizedGraph::set_params(size_t ef_search, size_t num_threads, int
   if (index_file_name_ == "") {
     throw std::logic_error("QuantizedGraph::set_params: call load_disk_index() first");
   }
-  aligned_file_reader_->open(index_file_name_);
+  build_thread_data_pool();
+}
 
-  const int nthreads_signed = static_cast<int>(nthreads_);
-#pragma omp parallel for num_threads(nthreads_signed)
-  for (int thread = 0; thread < nthreads_signed; thread++) {
-#pragma omp critical
-    {
-      this->aligned_file_reader_->register_thread();
-      ThreadData data;
-      data.ctx_ = aligned_file_reader_->get_ctx();
-      data.search_pool_.resize(ef_search_);
-      data.visited_ =
-          HashBasedBooleanSet(std::min(this->num_points_ / 10, ef_search_ * ef_search_));
-      data.sector_scratch_ = reinterpret_cast<char *>(
-          memory::align_allocate<kSectorLen>(2 * max_beam_width_ * page_size_));
-      data.pca_query_scratch_storage_ =
-          std::make_shared<std::vector<float>>(dimension_ + residual_dimension_);
-      data.pca_query_scratch_ =
-          data.pca_query_scratch_storage_->data();  // Allocate PCA query buffer
-      this->thread_data_.push(data);
-    }
+inline void QuantizedGraph::set_io_backend(const AlignedReaderOptions &options) {
+  destroy_thread_data();
+  aligned_file_reader_ = make_aligned_file_reader(options);
+  if (!index_file_name_.empty()) {
+    build_thread_data_pool();
   }
 }
 
@@ -348,7 +370,15 @@ inline void QuantizedGraph::set_params(size_t ef_search, size_t num_threads, int
 inline void QuantizedGraph::search(const float *ALAYA_RESTRICT query,
                                    uint32_t knn,
                                    uint32_t *ALAYA_RESTRICT results) {
-  disk_search_qg(query, knn, results);
+  disk_search_qg(query, knn, results, ef_search_, max_beam_width_);
+}
+
+inline void QuantizedGraph::search(const float *ALAYA_RESTRICT query,
+                                   uint32_t knn,
+                                   uint32_t *ALAYA_RESTRICT results,
+                                   size_t ef_search,
+                                   size_t beam_width) {
+  disk_search_qg(query, knn, results, ef_search, std::max<size_t>(beam_width, 1));
 }
 
 inline void QuantizedGraph::batch_search(const float *ALAYA_RESTRICT query,
@@ -360,7 +390,11 @@ inline void QuantizedGraph::batch_search(const float *ALAYA_RESTRICT query,
 #pragma omp parallel for schedule(dynamic) num_threads(nthreads_signed)
   for (int64_t ii = 0; ii < num_queries_signed; ++ii) {
     const size_t i = static_cast<size_t>(ii);
-    disk_search_qg(query + i * (dimension_ + residual_dimension_), knn, results + i * knn);
+    disk_search_qg(query + i * (dimension_ + residual_dimension_),
+                   knn,
+                   results + i * knn,
+                   ef_search_,
+                   max_beam_width_);
   }
 }
 
@@ -382,7 +416,7 @@ inline void QuantizedGraph::batch_search(const float *ALAYA_RESTRICT query,
  *
  * Key Optimizations:
  * - Asynchronous I/O: Overlaps disk reads with CPU computation
- * - Adaptive beam width: Starts small and grows exponentially up to max_beam_width_
+ * - Adaptive beam width: Starts small and grows exponentially up to beam_width
  * - In-memory caching: Frequently accessed nodes are cached to avoid repeated disk reads
  * - Pipelined processing: Processes nodes from previous iteration while waiting for new I/O
  *
@@ -392,6 +426,8 @@ inline void QuantizedGraph::batch_search(const float *ALAYA_RESTRICT query,
  * @param knn       Number of nearest neighbors to retrieve.
  * @param results   Output array to store the IDs of k nearest neighbors. Must have
  *                  space for at least knn uint32_t elements.
+ * @param ef_search Capacity of the candidate pool for this query.
+ * @param beam_width Upper bound of the adaptive beam width for this query.
  *
  * @note This function is thread-safe. Each thread acquires its own ThreadData from a
  *       concurrent queue, which includes scratch buffers and AIO context.
@@ -400,7 +436,9 @@ inline void QuantizedGraph::batch_search(const float *ALAYA_RESTRICT query,
  */
 inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
                                            uint32_t knn,
-                                           uint32_t *ALAYA_RESTRICT results) {
+                                           uint32_t *ALAYA_RESTRICT results,
+                                           size_t ef_search,
+                                           size_t beam_width) {
   // ==================== Thread-local Data Acquisition ====================
   // Acquire thread-local workspace from the concurrent queue.
   // This includes: visited set, search buffer, AIO context, and scratch memory.
@@ -409,6 +447,7 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
     this->thread_data_.wait_for_push_notify();
     data = thread_data_.pop();
   }
+  prepare_thread_data(data, ef_search, beam_width);
   data.visited_.clear();
   data.search_pool_.clear();
 
@@ -481,9 +520,10 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
   // ==================== Asynchronous I/O Data Structures ====================
   // frontier_read_reqs: Batch of aligned read requests to submit to AIO
   std::vector<AlignedRead> frontier_read_reqs;
-  frontier_read_reqs.reserve(2 * max_beam_width_);
+  frontier_read_reqs.reserve(2 * beam_width);
 
-  // prepared_nodes: Nodes whose data has been fetched and is ready for processing
+  // prepared_nodes: Nodes whose data has been fetched and is ready for processing,
+  // in completion order so a slow read does not hold up the ones behind it
   std::deque<std::pair<PID, char *>> prepared_nodes;
 
   // ongoing_nodes: Maps node IDs to their buffer locations for in-flight I/O requests
@@ -491,7 +531,7 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
 
   // free_slots: Pool of available memory buffers for disk reads (double-buffering scheme)
   std::deque<char *> free_slots;
-  for (size_t i = 0; i < 2 * max_beam_width_; i++) {
+  for (size_t i = 0; i < 2 * beam_width; i++) {
     free_slots.push_back(data.sector_scratch_ + i * page_size_);
   }
 
@@ -536,18 +576,29 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
 
     // Process each completed I/O event
     for (int i = 0; i < ret; i++) {
-      int id = static_cast<int>(evts[i].id);
-      if (ongoing_nodes.find(id) == ongoing_nodes.end()) {
+      const auto id = static_cast<PID>(evts[i].id);
+      auto it = ongoing_nodes.find(id);
+      if (it == ongoing_nodes.end()) {
         throw std::runtime_error(
             "disk_search_qg: I/O completion id not in ongoing_nodes "
             "(AlignedFileReader::poll_events returned an unexpected id)");
       }
       // Move from ongoing to prepared queue
-      prepared_nodes.emplace_back(id, ongoing_nodes[id]);
-      ongoing_nodes.erase(id);
+      prepared_nodes.emplace_back(id, it->second);
+      ongoing_nodes.erase(it);
     }
   };
 
+  // Hands out the first read to land, waiting only when none has.
+  auto next_prepared_node = [&]() {
+    while (prepared_nodes.empty()) {
+      wait_for_nodes();
+    }
+    auto node = prepared_nodes.front();
+    prepared_nodes.pop_front();
+    return node;
+  };
+
   // Track remaining nodes from previous iteration for pipelined processing
   size_t previous_remain_num = 0;
 
@@ -566,7 +617,7 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
 
     // Adaptive beam width: double the beam size each iteration (up to max)
     // This helps balance between exploration breadth and I/O efficiency.
-    cur_beam_size = std::min(max_beam_width_,
+    cur_beam_size = std::min(beam_width,
                              static_cast<size_t>(std::ceil(2 * static_cast<float>(cur_beam_size))));
 
     auto wait_start = std::chrono::high_resolution_clock::now();
@@ -599,7 +650,6 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
         // Create aligned read request (page-aligned for direct I/O)
         frontier_read_reqs.emplace_back(get_page_offset(cur_node), page_size_, cur_node, slot);
       }
-      total_read_num_++;
     }
 
     // -------------------- Submit Async I/O Requests --------------------
@@ -631,22 +681,14 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
 
     // Process nodes that have completed I/O (from previous or current iteration)
     while (need_process_num > 0) {
-      if (!prepared_nodes.empty()) {
-        // Process a node from the prepared queue
-        auto node = prepared_nodes.front();
-        prepared_nodes.pop_front();
-
-        // Calculate offset within page and process the node
-        process_node(node.first,
-                     reinterpret_cast<float *>(node.second + offset_to_node(node.first)));
-
-        need_process_num--;
-        // Return buffer to free pool for reuse
-        free_slots.push_back(node.second);
-      } else {
-        // No prepared nodes available; wait for I/O completion
-        wait_for_nodes();
-      }
+      auto node = next_prepared_node();
+
+      // Calculate offset within page and process the node
+      process_node(node.first, reinterpret_cast<float *>(node.second + offset_to_node(node.first)));
+
+      need_process_num--;
+      // Return buffer to free pool for reuse
+      free_slots.push_back(node.second);
     }
   }
 
@@ -654,16 +696,10 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
   // After the main loop exits, there may still be nodes in the pipeline
   // that haven't been processed yet. Drain the remaining nodes.
   while (previous_remain_num > 0) {
-    if (!prepared_nodes.empty()) {
-      auto node = prepared_nodes.front();
-      prepared_nodes.pop_front();
-      process_node(node.first, reinterpret_cast<float *>(node.second + offset_to_node(node.first)));
-      previous_remain_num--;
-      free_slots.push_back(node.second);
-    } else {
-      // Wait for any remaining in-flight I/O operations to complete
-      wait_for_nodes();
-    }
+    auto node = next_prepared_node();
+    process_node(node.first, reinterpret_cast<float *>(node.second + offset_to_node(node.first)));
+    previous_remain_num--;
+    free_slots.push_back(node.second);
   }
 
   // Record query end time for latency measurement
@@ -677,7 +713,7 @@ inline void QuantizedGraph::disk_search_qg(const float *ALAYA_RESTRICT query,
   res_pool.copy_results(results);
 
   // Return thread-local data to the concurrent queue for reuse by other threads
-  thread_data_.push(data);
+  thread_data_.push(std::move(data));
   thread_data_.push_notify_all();
 }
 
@@ -729,28 +765,80 @@ inline void QuantizedGraph::initialize() {
   this->row_offset_ = neighbor_offset_ + degree_bound_;
 }
 
-inline void QuantizedGraph::init_workspace() {
+inline void QuantizedGraph::init_workspace() { build_thread_data_pool(); }
+
+/*
+ * (Re)build the ThreadData pool with nthreads_ entries sized for the default
+ * ef_search_ / max_beam_width_. File readers key I/O contexts by thread id, so
+ * every entry is registered from its own thread and all registrars stay alive
+ * until the last one has registered; two entries can therefore never share a
+ * context, whatever the OpenMP runtime would have handed out.
+ */
+inline void QuantizedGraph::build_thread_data_pool() {
   aligned_file_reader_->open(index_file_name_);
 
-  const int nthreads_signed = static_cast<int>(nthreads_);
-#pragma omp parallel for num_threads(nthreads_signed)
-  for (int thread = 0; thread < nthreads_signed; thread++) {
-#pragma omp critical
-    {
-      this->aligned_file_reader_->register_thread();
-      ThreadData data;
-      data.ctx_ = aligned_file_reader_->get_ctx();
-      data.search_pool_.resize(ef_search_);
-      data.visited_ =
-          HashBasedBooleanSet(std::min(this->num_points_ / 10, ef_search_ * ef_search_));
-      data.sector_scratch_ = reinterpret_cast<char *>(
-          memory::align_allocate<kSectorLen>(2 * max_beam_width_ * page_size_));
-      data.pca_query_scratch_storage_ =
-          std::make_shared<std::vector<float>>(dimension_ + residual_dimension_);
-      data.pca_query_scratch_ =
-          data.pca_query_scratch_storage_->data();  // Allocate PCA query buffer
-      this->thread_data_.push(data);
+  const size_t pool_size = std::max<size_t>(nthreads_, 1);
+  std::latch all_registered(static_cast<std::ptrdiff_t>(pool_size));
+  std::mutex pool_mutex;
+  std::exception_ptr first_error;
+  std::vector<std::thread> registrars;
+  registrars.reserve(pool_size);
+  for (size_t thread = 0; thread < pool_size; ++thread) {
+    registrars.emplace_back([&] {
+      try {
+        const std::lock_guard<std::mutex> lock(pool_mutex);
+        this->aligned_file_reader_->register_thread();
+        ThreadData data;
+        data.ctx_ = aligned_file_reader_->get_ctx();
+        data.pca_query_scratch_storage_ =
+            std::make_shared<std::vector<float>>(dimension_ + residual_dimension_);
+        data.pca_query_scratch_ =
+            data.pca_query_scratch_storage_->data();  // Allocate PCA query buffer
+        prepare_thread_data(data, ef_search_, max_beam_width_);
+        this->thread_data_.push(std::move(data));
+      } catch (...) {
+        const std::lock_guard<std::mutex> lock(pool_mutex);
+        if (!first_error) {
+          first_error = std::current_exception();
+        }
+      }
+      all_registered.arrive_and_wait();
+    });
+  }
+  for (auto &registrar : registrars) {
+    registrar.join();
+  }
+  if (first_error) {
+    std::rethrow_exception(first_error);
+  }
+  ++thread_data_pool_builds_;
+}
+
+/*
+ * Size a checked-out ThreadData for one query. Scratch only ever grows, so a
+ * pool serving a mix of ef / beam widths settles after the largest request and
+ * stops allocating; shrinking the search pool's logical capacity is free.
+ */
+inline void QuantizedGraph::prepare_thread_data(ThreadData &data,
+                                                size_t ef_search,
+                                                size_t beam_width) const {
+  if (data.search_pool_.capacity() != ef_search) {
+    data.search_pool_.set_capacity(ef_search);
+  }
+  if (ef_search > data.visited_ef_) {
+    data.visited_ = HashBasedBooleanSet(std::min(this->num_points_ / 10, ef_search * ef_search));
+    data.visited_ef_ = ef_search;
+  }
+  if (beam_width > data.sector_scratch_beam_width_) {
+    if (data.sector_scratch_ != nullptr) {
+      memory::align_free(data.sector_scratch_);
     }
+    data.sector_scratch_ =
+        reinterpret_cast<char *>(memory::align_allocate<kSectorLen>(2 * beam_width * page_size_));
+    data.sector_scratch_beam_width_ = beam_width;
+    // Backends with fixed buffers (io_uring) re-pin the grown scratch; a no-op otherwise.
+    aligned_file_reader_->register_buffer(
+        data.ctx_, data.sector_scratch_, 2 * beam_width * page_size_);
   }
 }
 
@@ -110,10 +110,27 @@ struct AlignedReadEvent {
   int64_t result = 0;
 };
 
+/// Reader backend chosen at load time by make_aligned_file_reader().
+enum class AlignedReaderBackend {
+  kDefault,  ///< the build's backend (libaio on Linux, IOCP on Windows, else the thread pool)
+  kUring,    ///< io_uring with registered files and fixed buffers (Linux only)
+};
+
+struct AlignedReaderOptions {
+  AlignedReaderBackend backend = AlignedReaderBackend::kDefault;
+  uint32_t queue_depth = MAX_EVENTS;  ///< kUring: ring entries per context (max reads per batch)
+  bool sqpoll = false;                ///< kUring: kernel-side submission polling, one shared thread
+  uint32_t sqpoll_idle_ms = 50;       ///< kUring: idle time before the SQPOLL thread sleeps
+  bool iopoll = false;                ///< kUring: busy-poll completions (NVMe poll queues only)
+};
+
 class AlignedFileReader {
  protected:
   std::map<std::thread::id, IOContext> ctx_map_;
   std::mutex ctx_mut_;
+  std::atomic<uint64_t> io_syscalls_{0};
+
+  void count_syscalls(uint64_t n) { io_syscalls_.fetch_add(n, std::memory_order_relaxed); }
 
  public:
   // Returns the thread-specific context owned by the reader. The returned
@@ -156,6 +173,20 @@ class AlignedFileReader {
   // (the update-path io_uring reactor reads the index through this fd so its
   // waves keep the reader's O_DIRECT semantics).
   virtual int get_fd() const { return -1; }
+
+  // Register buf as ctx's fixed read buffer, replacing any earlier one. Reads
+  // that land inside it skip per-I/O page pinning on backends that support it;
+  // returns false when the backend has no fixed buffers or registration failed.
+  virtual bool register_buffer(IOContext &ctx, void *buf, uint64_t len) {
+    (void)ctx;
+    (void)buf;
+    (void)len;
+    return false;
+  }
+
+  // Submit / wait system calls issued by this reader so far (0 for backends
+  // that do not count them, such as the thread pool).
+  uint64_t io_syscalls() const { return io_syscalls_.load(std::memory_order_relaxed); }
 };
 
 #if defined(ALAYA_LASER_USE_LIBAIO)
@@ -204,10 +235,16 @@ using iocb_t = struct iocb;
 /// task_work that an io_uring elsewhere in the process uses to run completions
 /// (e.g. the DiskANN update reactor). A partial delivery cannot be restarted
 /// transparently by the kernel, so the caller must drain the remainder itself.
-inline void io_getevents_exact(io_context_t ctx, io_event_t *evts, int64_t want, const char *who) {
+/// Returns the number of io_getevents calls made.
+inline uint64_t io_getevents_exact(io_context_t ctx,
+                                   io_event_t *evts,
+                                   int64_t want,
+                                   const char *who) {
   int64_t got = 0;
+  uint64_t calls = 0;
   while (got < want) {
     const int64_t ret = io_getevents(ctx, want - got, want - got, evts + got, nullptr);
+    ++calls;
     if (ret < 0) {
       if (ret == -EINTR) {
         continue;
@@ -218,12 +255,15 @@ inline void io_getevents_exact(io_context_t ctx, io_event_t *evts, int64_t want,
     }
     got += ret;
   }
+  return calls;
 }
 
-inline void execute_io(io_context_t ctx,
-                       int fd,
-                       std::vector<AlignedRead> &read_reqs,
-                       uint64_t n_retries = 0) {
+/// Returns the number of io_submit / io_getevents calls made.
+inline uint64_t execute_io(io_context_t ctx,
+                           int fd,
+                           std::vector<AlignedRead> &read_reqs,
+                           uint64_t n_retries = 0) {
+  uint64_t n_syscalls = 0;
   #ifdef DEBUG
   for (auto &req : read_reqs) {
     assert(IS_ALIGNED(req.len, 512));
@@ -257,6 +297,7 @@ inline void execute_io(io_context_t ctx,
     while (n_tries <= n_retries) {
       // issue reads
       int64_t ret = io_submit(ctx, static_cast<int64_t>(n_ops), cbs.data());
+      ++n_syscalls;
       // if requests didn't get accepted
       if (ret != static_cast<int64_t>(n_ops)) {
         throw std::runtime_error("LinuxAlignedFileReader: io_submit() failed; returned " +
@@ -265,11 +306,13 @@ inline void execute_io(io_context_t ctx,
                                  ::strerror(static_cast<int>(-ret)));
       } else {
         // wait for the whole batch (drains partial deliveries after interrupts)
-        io_getevents_exact(ctx, evts.data(), static_cast<int64_t>(n_ops), "LinuxAlignedFileReader");
+        n_syscalls += io_getevents_exact(
+            ctx, evts.data(), static_cast<int64_t>(n_ops), "LinuxAlignedFileReader");
         break;
       }
     }
   }
+  return n_syscalls;
 }
 
 inline LinuxAlignedFileReader::LinuxAlignedFileReader() { this->file_desc_ = -1; }
@@ -377,7 +420,7 @@ inline void LinuxAlignedFileReader::read(std::vector<AlignedRead> &read_reqs,
     std::cout << "Async currently not supported in linux." << std::endl;
   }
   assert(this->file_desc_ != -1);
-  execute_io(ctx, this->file_desc_, read_reqs);
+  count_syscalls(execute_io(ctx, this->file_desc_, read_reqs));
 }
 
 /**
@@ -419,6 +462,7 @@ inline int LinuxAlignedFileReader::submit_reqs(std::vector<AlignedRead> &read_re
   }
 
   int ret = io_submit(ctx, static_cast<int64_t>(n_ops), cbs.data());
+  count_syscalls(1);
   if (ret != static_cast<int>(n_ops)) {
     throw std::runtime_error("LinuxAlignedFileReader::submit_reqs: io_submit() failed; returned " +
                              std::to_string(ret) + ", expected=" + std::to_string(n_ops) +
@@ -431,10 +475,10 @@ inline int LinuxAlignedFileReader::get_events(IOContext &ctx,
                                               int n_ops,
                                               std::vector<AlignedReadEvent> &out) {
   std::vector<io_event> evts(n_ops);
-  io_getevents_exact(ctx,
-                     evts.data(),
-                     static_cast<int64_t>(n_ops),
-                     "LinuxAlignedFileReader::get_events");
+  count_syscalls(io_getevents_exact(ctx,
+                                    evts.data(),
+                                    static_cast<int64_t>(n_ops),
+                                    "LinuxAlignedFileReader::get_events"));
   out.clear();
   out.reserve(static_cast<size_t>(n_ops));
   for (int64_t i = 0; i < n_ops; ++i) {
@@ -456,6 +500,7 @@ inline int LinuxAlignedFileReader::poll_events(IOContext &ctx,
   int64_t ret = 0;
   do {  // non-blocking poll; -EINTR just means "try again"
     ret = io_getevents(ctx, 0, static_cast<int64_t>(max_events), evts.data(), nullptr);
+    count_syscalls(1);
   } while (ret == -EINTR);
   if (ret < 0) {
     throw std::runtime_error(
@@ -5,8 +5,10 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
 
 #include "index/graph/laser/utils/aligned_file_reader.hpp"
+#include "index/graph/laser/utils/uring_file_reader.hpp"
 
 #if defined(ALAYA_LASER_USE_THREADPOOL)
   #include "index/graph/laser/utils/threadpool_file_reader.hpp"
@@ -23,3 +25,17 @@ inline std::unique_ptr<AlignedFileReader> make_aligned_file_reader() {
   return std::make_unique<LinuxAlignedFileReader>();
 #endif
 }
+
+/// Runtime backend selection; kUring throws where io_uring is unavailable.
+inline std::unique_ptr<AlignedFileReader> make_aligned_file_reader(
+    const AlignedReaderOptions &options) {
+  if (options.backend == AlignedReaderBackend::kDefault) {
+    return make_aligned_file_reader();
+  }
+#ifdef ALAYA_OS_LINUX
+  if (UringFileReader::is_available()) {
+    return std::make_unique<UringFileReader>(options);
+  }
+#endif
+  throw std::runtime_error("make_aligned_file_reader: io_uring reader requested but unavailable");
+}
@@ -33,7 +33,7 @@ namespace alaya::laser::buffer {
 class SearchBuffer {
  private:
   std::vector<Candidate<float>, memory::AlignedAllocator<Candidate<float>>> data_;
-  size_t size_ = 0, cur_ = 0, capacity_;
+  size_t size_ = 0, cur_ = 0, capacity_ = 0;
 
   [[nodiscard]] auto binary_search(float dist) const {
     size_t lo = 0;
@@ -96,6 +96,19 @@ class SearchBuffer {
     data_ =
         std::vector<Candidate<float>, memory::AlignedAllocator<Candidate<float>>>(capacity_ + 1);
   }
+
+  [[nodiscard]] auto capacity() const -> size_t { return capacity_; }
+
+  // Change the logical capacity and clear. Storage is only reallocated on growth, so a pooled
+  // buffer that alternates between ef values stops allocating after the largest one.
+  void set_capacity(size_t new_capacity) {
+    if (new_capacity + 1 > data_.size()) {
+      data_ = std::vector<Candidate<float>, memory::AlignedAllocator<Candidate<float>>>(
+          new_capacity + 1);
+    }
+    capacity_ = new_capacity;
+    clear();
+  }
 };
 
 /**
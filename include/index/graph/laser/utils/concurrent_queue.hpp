@@ -18,6 +18,7 @@
 #include <thread>
 #include <type_traits>
 #include <unordered_set>
+#include <utility>
 
 template <typename T>
 class ConcurrentQueue {
@@ -64,6 +65,12 @@ class ConcurrentQueue {
     lk.unlock();
   }
 
+  void push(T &&new_val) {
+    mutex_locker lk(this->mutex_);
+    this->queue_.push(std::move(new_val));
+    lk.unlock();
+  }
+
   template <class Iterator>
   void insert(Iterator iter_begin, Iterator iter_end) {
     mutex_locker lk(this->mutex_);
@@ -80,7 +87,7 @@ class ConcurrentQueue {
       lk.unlock();
       return this->null_T_;
     } else {
-      T ret = this->queue_.front();
+      T ret = std::move(this->queue_.front());
       this->queue_.pop();
       // diskann::cout << "thread_id: " << std::this_thread::get_id() << ",
       // ctx: "
@@ -0,0 +1,387 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+/**
+ * @file uring_file_reader.hpp
+ * @brief io_uring AlignedFileReader backend for the query-time search path.
+ *
+ * Each registered context owns one io_uring ring. Compared with the libaio
+ * reader it removes work from every read:
+ * - The index file is registered with the ring (IORING_REGISTER_FILES), so
+ *   SQEs carry a fixed-file index and the kernel skips the per-I/O fd lookup
+ *   and reference counting.
+ * - A context may register one fixed buffer (the caller's sector scratch);
+ *   reads landing inside it become READ_FIXED and skip per-I/O page pinning.
+ * - Completions are reaped from the shared CQ ring in user space, so a wait
+ *   only enters the kernel when nothing has completed yet (libaio pays an
+ *   io_getevents syscall on every wait).
+ * - Optional SQPOLL moves submission to a kernel thread (one thread shared by
+ *   all contexts through IORING_SETUP_ATTACH_WQ), and optional IOPOLL polls the
+ *   NVMe completion queue instead of taking interrupts. IOPOLL needs O_DIRECT
+ *   (always used here) and a device with poll queues (nvme.poll_queues > 0);
+ *   on other devices the reads complete with -EOPNOTSUPP.
+ *
+ * IOContext is an opaque per-thread pointer in every backend, so this reader
+ * stores its UringContext* in it. The backend is selected at runtime through
+ * make_aligned_file_reader(AlignedReaderOptions), whatever the build's default
+ * LASER backend is.
+ */
+
+#pragma once
+
+#include "index/graph/laser/utils/aligned_file_reader.hpp"
+#include "utils/log.hpp"
+#include "utils/platform.hpp"
+
+#ifdef ALAYA_OS_LINUX
+
+  #include <fcntl.h>
+  #include <liburing.h>
+  #include <sys/uio.h>
+  #include <unistd.h>
+
+  #include <memory>
+
+struct UringContext {
+  struct io_uring ring {};
+  uint32_t depth = 0;          ///< SQ entries; also the cap on one submit_reqs batch
+  bool fixed_file = false;     ///< the reader's fd is registered at index 0
+  char *fixed_buf = nullptr;   ///< registered buffer (index 0), or null
+  uint64_t fixed_len = 0;
+};
+
+class UringFileReader : public AlignedFileReader {
+ private:
+  int file_desc_ = -1;
+  AlignedReaderOptions options_;
+  std::map<std::thread::id, std::unique_ptr<UringContext>> owned_contexts_;
+  int sqpoll_anchor_fd_ = -1;  ///< ring whose SQPOLL thread later rings attach to
+
+  static UringContext *as_uring(IOContext &ctx) { return reinterpret_cast<UringContext *>(ctx); }
+
+  void init_ring(UringContext &uc);
+  void register_file(UringContext &uc);
+  void destroy_context(UringContext &uc);
+  int submit_range(UringContext &uc, AlignedRead *reqs, size_t n);
+  size_t reap_ready(UringContext &uc, size_t max_events, std::vector<AlignedReadEvent> &out);
+
+ public:
+  explicit UringFileReader(const AlignedReaderOptions &options = {}) : options_(options) {
+    options_.queue_depth = std::clamp<uint32_t>(options_.queue_depth, 1, MAX_EVENTS);
+  }
+  ~UringFileReader() override {
+    deregister_all_threads();
+    close();
+  }
+
+  /// True when the kernel supports io_uring with READ_FIXED (Linux >= 5.1).
+  static bool is_available() {
+    struct io_uring_probe *probe = io_uring_get_probe();
+    if (probe == nullptr) {
+      return false;
+    }
+    const bool ok = io_uring_opcode_supported(probe, IORING_OP_READ_FIXED) != 0;
+    io_uring_free_probe(probe);
+    return ok;
+  }
+
+  IOContext &get_ctx() override;
+  void register_thread() override;
+  void deregister_thread() override;
+  void deregister_all_threads() override;
+
+  void open(const std::string &fname) override;
+  void close() override;
+
+  void read(std::vector<AlignedRead> &read_reqs, IOContext &ctx, bool async = false) override;
+  int submit_reqs(std::vector<AlignedRead> &read_reqs, IOContext &ctx) override;
+  int get_events(IOContext &ctx, int n_ops, std::vector<AlignedReadEvent> &out) override;
+  int poll_events(IOContext &ctx, int max_events, std::vector<AlignedReadEvent> &out) override;
+  bool register_buffer(IOContext &ctx, void *buf, uint64_t len) override;
+
+  int get_fd() const override { return file_desc_; }
+};
+
+inline void UringFileReader::init_ring(UringContext &uc) {
+  struct io_uring_params params {};
+  if (options_.iopoll) {
+    params.flags |= IORING_SETUP_IOPOLL;
+  }
+  if (options_.sqpoll) {
+    params.flags |= IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = options_.sqpoll_idle_ms;
+    if (sqpoll_anchor_fd_ >= 0) {
+      params.flags |= IORING_SETUP_ATTACH_WQ;
+      params.wq_fd = static_cast<uint32_t>(sqpoll_anchor_fd_);
+    }
+  }
+  int ret = io_uring_queue_init_params(options_.queue_depth, &uc.ring, &params);
+  if (ret < 0 && options_.sqpoll) {
+    // SQPOLL needs CAP_SYS_NICE before Linux 5.11; keep the other savings without it.
+    LOG_WARN("UringFileReader: SQPOLL ring setup failed ({}); continuing without SQPOLL",
+             ::strerror(-ret));
+    options_.sqpoll = false;
+    params = {};
+    params.flags = options_.iopoll ? IORING_SETUP_IOPOLL : 0U;
+    ret = io_uring_queue_init_params(options_.queue_depth, &uc.ring, &params);
+  }
+  if (ret < 0) {
+    throw std::runtime_error("UringFileReader: io_uring_queue_init_params failed: " +
+                             std::string(::strerror(-ret)));
+  }
+  uc.depth = options_.queue_depth;
+  if (options_.sqpoll && sqpoll_anchor_fd_ < 0) {
+    sqpoll_anchor_fd_ = uc.ring.ring_fd;
+  }
+}
+
+inline void UringFileReader::register_file(UringContext &uc) {
+  if (uc.fixed_file) {
+    io_uring_unregister_files(&uc.ring);
+    uc.fixed_file = false;
+  }
+  if (file_desc_ == -1) {
+    return;
+  }
+  // A failed registration (e.g. RLIMIT_NOFILE) only costs the fd-lookup saving.
+  uc.fixed_file = io_uring_register_files(&uc.ring, &file_desc_, 1) == 0;
+}
+
+inline void UringFileReader::destroy_context(UringContext &uc) {
+  if (uc.ring.ring_fd == sqpoll_anchor_fd_) {
+    sqpoll_anchor_fd_ = -1;
+  }
+  io_uring_queue_exit(&uc.ring);
+}
+
+inline IOContext &UringFileReader::get_ctx() {
+  std::unique_lock<std::mutex> lk(ctx_mut_);
+  auto it = ctx_map_.find(std::this_thread::get_id());
+  if (it == ctx_map_.end()) {
+    throw std::runtime_error(
+        "UringFileReader::get_ctx: calling thread is not registered "
+        "(call register_thread() first)");
+  }
+  return it->second;
+}
+
+inline void UringFileReader::register_thread() {
+  const auto my_id = std::this_thread::get_id();
+  std::unique_lock<std::mutex> lk(ctx_mut_);
+  if (ctx_map_.find(my_id) != ctx_map_.end()) {
+    throw std::runtime_error("UringFileReader::register_thread: thread is already registered");
+  }
+  auto uc = std::make_unique<UringContext>();
+  init_ring(*uc);
+  register_file(*uc);
+  ctx_map_[my_id] = reinterpret_cast<IOContext>(uc.get());
+  owned_contexts_[my_id] = std::move(uc);
+}
+
+inline void UringFileReader::deregister_thread() {
+  const auto my_id = std::this_thread::get_id();
+  std::unique_lock<std::mutex> lk(ctx_mut_);
+  auto it = owned_contexts_.find(my_id);
+  if (it == owned_contexts_.end()) {
+    return;
+  }
+  destroy_context(*it->second);
+  owned_contexts_.erase(it);
+  ctx_map_.erase(my_id);
+}
+
+inline void UringFileReader::deregister_all_threads() {
+  std::unique_lock<std::mutex> lk(ctx_mut_);
+  for (auto &entry : owned_contexts_) {
+    destroy_context(*entry.second);
+  }
+  owned_contexts_.clear();
+  ctx_map_.clear();
+}
+
+inline void UringFileReader::open(const std::string &fname) {
+  close();
+  // O_DIRECT for the same reasons as LinuxAlignedFileReader::open; IOPOLL requires it too.
+  file_desc_ = ::open(fname.c_str(), O_DIRECT | O_RDONLY);
+  if (file_desc_ == -1) {
+    throw std::runtime_error("UringFileReader::open: open() failed for " + fname +
+                             ", errno=" + std::to_string(errno) + "=" + ::strerror(errno));
+  }
+  std::unique_lock<std::mutex> lk(ctx_mut_);
+  for (auto &entry : owned_contexts_) {
+    register_file(*entry.second);
+  }
+}
+
+inline void UringFileReader::close() {
+  if (file_desc_ == -1) {
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> lk(ctx_mut_);
+    for (auto &entry : owned_contexts_) {
+      if (entry.second->fixed_file) {
+        io_uring_unregister_files(&entry.second->ring);
+        entry.second->fixed_file = false;
+      }
+    }
+  }
+  ::close(file_desc_);
+  file_desc_ = -1;
+}
+
+inline bool UringFileReader::register_buffer(IOContext &ctx, void *buf, uint64_t len) {
+  auto *uc = as_uring(ctx);
+  if (uc->fixed_buf != nullptr) {
+    io_uring_unregister_buffers(&uc->ring);
+    uc->fixed_buf = nullptr;
+    uc->fixed_len = 0;
+  }
+  if (buf == nullptr || len == 0) {
+    return false;
+  }
+  struct iovec iov {};
+  iov.iov_base = buf;
+  iov.iov_len = len;
+  // Registration pins the pages (RLIMIT_MEMLOCK / memcg); on failure reads stay plain READs.
+  if (io_uring_register_buffers(&uc->ring, &iov, 1) != 0) {
+    return false;
+  }
+  uc->fixed_buf = static_cast<char *>(buf);
+  uc->fixed_len = len;
+  return true;
+}
+
+inline int UringFileReader::submit_range(UringContext &uc, AlignedRead *reqs, size_t n) {
+  assert(file_desc_ != -1);
+  for (size_t i = 0; i < n; ++i) {
+    const AlignedRead &req = reqs[i];
+    struct io_uring_sqe *sqe = io_uring_get_sqe(&uc.ring);
+    if (sqe == nullptr) {
+      throw std::runtime_error("UringFileReader: submission queue full");
+    }
+    const int fd = uc.fixed_file ? 0 : file_desc_;
+    auto *buf = static_cast<char *>(req.buf);
+    if (uc.fixed_buf != nullptr && buf >= uc.fixed_buf &&
+        buf + req.len <= uc.fixed_buf + uc.fixed_len) {
+      io_uring_prep_read_fixed(sqe, fd, buf, static_cast<unsigned>(req.len), req.offset, 0);
+    } else {
+      io_uring_prep_read(sqe, fd, buf, static_cast<unsigned>(req.len), req.offset);
+    }
+    if (uc.fixed_file) {
+      io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+    }
+    io_uring_sqe_set_data(sqe, reinterpret_cast<void *>(static_cast<uintptr_t>(req.id)));
+  }
+  size_t flushed = 0;
+  while (flushed < n) {
+    // With SQPOLL the kernel thread picks the SQEs up; liburing only enters to wake it.
+    const bool enters =
+        !options_.sqpoll || (IO_URING_READ_ONCE(*uc.ring.sq.kflags) & IORING_SQ_NEED_WAKEUP) != 0;
+    const int ret = io_uring_submit(&uc.ring);
+    if (enters) {
+      count_syscalls(1);
+    }
+    if (ret == -EINTR || ret == -EAGAIN) {
+      continue;
+    }
+    if (ret < 0) {
+      throw std::runtime_error("UringFileReader: io_uring_submit() failed: " +
+                               std::string(::strerror(-ret)));
+    }
+    if (ret == 0) {
+      // Retrying would spin: the kernel took none of the remaining SQEs.
+      throw std::runtime_error("UringFileReader: io_uring_submit() accepted none of " +
+                               std::to_string(n - flushed) + " pending reads");
+    }
+    flushed += static_cast<size_t>(ret);
+  }
+  return static_cast<int>(n);
+}
+
+inline size_t UringFileReader::reap_ready(UringContext &uc,
+                                          size_t max_events,
+                                          std::vector<AlignedReadEvent> &out) {
+  size_t got = 0;
+  struct io_uring_cqe *cqe = nullptr;
+  while (got < max_events) {
+    if (io_uring_peek_cqe(&uc.ring, &cqe) != 0) {
+      // IOPOLL rings have no interrupt-driven CQ: a peek that finds nothing enters the kernel
+      // to poll the device.
+      if (options_.iopoll) {
+        count_syscalls(1);
+      }
+      break;
+    }
+    out.push_back({static_cast<uint64_t>(reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe))),
+                   static_cast<int64_t>(cqe->res)});
+    io_uring_cqe_seen(&uc.ring, cqe);
+    ++got;
+  }
+  return got;
+}
+
+inline void UringFileReader::read(std::vector<AlignedRead> &read_reqs, IOContext &ctx, bool async) {
+  (void)async;
+  auto *uc = as_uring(ctx);
+  std::vector<AlignedReadEvent> evts;
+  for (size_t begin = 0; begin < read_reqs.size(); begin += uc->depth) {
+    const size_t n = std::min<size_t>(uc->depth, read_reqs.size() - begin);
+    submit_range(*uc, read_reqs.data() + begin, n);
+    get_events(ctx, static_cast<int>(n), evts);
+    for (const auto &evt : evts) {
+      if (evt.result < 0) {
+        throw std::runtime_error("UringFileReader::read: read failed: " +
+                                 std::string(::strerror(static_cast<int>(-evt.result))));
+      }
+    }
+  }
+}
+
+inline int UringFileReader::submit_reqs(std::vector<AlignedRead> &read_reqs, IOContext &ctx) {
+  auto *uc = as_uring(ctx);
+  if (read_reqs.size() > uc->depth) {
+    throw std::runtime_error("UringFileReader::submit_reqs: request count " +
+                             std::to_string(read_reqs.size()) +
+                             " exceeds queue depth=" + std::to_string(uc->depth));
+  }
+  return submit_range(*uc, read_reqs.data(), read_reqs.size());
+}
+
+inline int UringFileReader::get_events(IOContext &ctx,
+                                       int n_ops,
+                                       std::vector<AlignedReadEvent> &out) {
+  auto *uc = as_uring(ctx);
+  out.clear();
+  out.reserve(static_cast<size_t>(std::max(n_ops, 0)));
+  const auto want = static_cast<size_t>(std::max(n_ops, 0));
+  while (out.size() < want) {
+    if (reap_ready(*uc, want - out.size(), out) > 0) {
+      continue;
+    }
+    // Nothing has landed yet: block in the kernel for the next completion and
+    // leave it in the CQ for the peek loop above. io_uring_wait_cqe() would
+    // return without a syscall if one landed since the peek; entering directly
+    // keeps the syscall count exact.
+    const int ret = io_uring_enter(uc->ring.ring_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr);
+    count_syscalls(1);
+    if (ret < 0 && ret != -EINTR) {
+      throw std::runtime_error("UringFileReader::get_events: io_uring_enter() failed: " +
+                               std::string(::strerror(-ret)));
+    }
+  }
+  return n_ops;
+}
+
+inline int UringFileReader::poll_events(IOContext &ctx,
+                                        int max_events,
+                                        std::vector<AlignedReadEvent> &out) {
+  out.clear();
+  if (max_events <= 0) {
+    return 0;
+  }
+  return static_cast<int>(reap_ready(*as_uring(ctx), static_cast<size_t>(max_events), out));
+}
+
+#endif  // ALAYA_OS_LINUX
@@ -12,6 +12,7 @@
 #include <cstdint>
 #include <mutex>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,6 +20,7 @@
 #include "index/graph/vamana/robust_prune.hpp"
 #include "simd/distance_l2.hpp"
 #include "utils/log.hpp"
+#include "utils/metric_type.hpp"
 #include "utils/timer.hpp"
 
 namespace alaya::vamana {
@@ -48,10 +50,22 @@ struct VamanaBuildParams {
   uint32_t num_threads = 0;  // 0 → omp_get_num_procs()
   uint32_t maxc = 750;       // occlude_list pool cap
   uint64_t seed = 1234;      // reserved for optional shuffles; medoid is deterministic by data
+  MetricType metric = MetricType::L2;  // L2, IP or COS; see VamanaBuilder
 };
 
 // VamanaBuilder — single-shard in-memory Vamana graph construction on
-// float32 L2 data.
+// float32 data.
+//
+// Metrics: α-RNG pruning needs a non-negative distance, so every metric is
+// built as L2 over a transformed copy of the data.
+//   L2  — the caller's buffer, as is.
+//   COS — unit-normalized rows; on the unit sphere L2 order is cosine order.
+//   IP  — rows augmented to dim + 1 with sqrt(M^2 - |x|^2), M the largest
+//         row norm (the MIPS → L2 reduction). For a query q (last coordinate
+//         0), |q' - x'|^2 = |q|^2 + M^2 - 2<q, x>, so L2 order over the
+//         augmented rows is inner-product order over the originals.
+// The resulting graph is searched with the inner-product kernel over the
+// original rows (VamanaGreedySearch with the same metric).
 //
 // Ownership: builder borrows `data` (caller keeps it alive during build()).
 // Data layout: row-major `num_points × dim`, contiguous, no padding.
@@ -73,6 +87,18 @@ class VamanaBuilder {
         graph_(num_points),
         locks_(num_points),
         l2_(alaya::simd::get_l2_sqr_func()) {
+    switch (params_.metric) {
+      case MetricType::L2:
+        break;
+      case MetricType::COS:
+        normalize_rows(data, dim);
+        break;
+      case MetricType::IP:
+        augment_rows_for_mips(data, dim);
+        break;
+      default:
+        throw std::invalid_argument("VamanaBuilder: metric must be one of L2, IP, COS");
+    }
     if (params_.num_threads == 0) {
       params_.num_threads = static_cast<uint32_t>(omp_get_num_procs());
     }
@@ -116,6 +142,49 @@ class VamanaBuilder {
   uint32_t medoid() const { return medoid_; }
 
  private:
+  // COS: unit-length copy of every row. Zero rows stay zero (callers that
+  // care, such as VamanaSegmentBuilder, reject them up front).
+  void normalize_rows(const float *data, uint32_t dim) {
+    transformed_.resize(num_points_ * dim);
+    for (size_t i = 0; i < num_points_; ++i) {
+      const float *src = data + i * dim;
+      float *dst = transformed_.data() + i * dim;
+      double sum_sq = 0.0;
+      for (uint32_t j = 0; j < dim; ++j) {
+        sum_sq += static_cast<double>(src[j]) * static_cast<double>(src[j]);
+      }
+      const double inv_norm = sum_sq > 0.0 ? 1.0 / std::sqrt(sum_sq) : 0.0;
+      for (uint32_t j = 0; j < dim; ++j) {
+        dst[j] = static_cast<float>(static_cast<double>(src[j]) * inv_norm);
+      }
+    }
+    data_ = transformed_.data();
+  }
+
+  // IP: copy every row into dim + 1 columns, the extra one lifting all rows
+  // onto a sphere of radius M (see the class comment).
+  void augment_rows_for_mips(const float *data, uint32_t dim) {
+    std::vector<double> sq_norms(num_points_);
+    double max_sq = 0.0;
+    for (size_t i = 0; i < num_points_; ++i) {
+      const float *src = data + i * dim;
+      double sum_sq = 0.0;
+      for (uint32_t j = 0; j < dim; ++j) {
+        sum_sq += static_cast<double>(src[j]) * static_cast<double>(src[j]);
+      }
+      sq_norms[i] = sum_sq;
+      max_sq = std::max(max_sq, sum_sq);
+    }
+    dim_ = dim + 1;
+    transformed_.resize(num_points_ * dim_);
+    for (size_t i = 0; i < num_points_; ++i) {
+      float *dst = transformed_.data() + i * dim_;
+      std::copy_n(data + i * dim, dim, dst);
+      dst[dim] = static_cast<float>(std::sqrt(std::max(0.0, max_sq - sq_norms[i])));
+    }
+    data_ = transformed_.data();
+  }
+
   inline float l2_dist(uint32_t a, uint32_t b) const {
     return l2_(data_ + static_cast<size_t>(a) * dim_, data_ + static_cast<size_t>(b) * dim_, dim_);
   }
@@ -555,6 +624,8 @@ class VamanaBuilder {
   size_t num_points_;
   uint32_t dim_;
   VamanaBuildParams params_;
+  // Owned rows for COS / IP (data_ points here); empty for L2.
+  std::vector<float> transformed_;
   std::vector<std::vector<uint32_t>> graph_;
   std::vector<std::mutex> locks_;
   std::vector<Scratch> scratches_;
@@ -8,7 +8,10 @@
 // loaded `VamanaReader` graph plus caller-owned float32 row-major vectors.
 //
 // v1 contract (intentionally narrow; see design.md D6 / D10):
-//   * L2 only. The distance kernel is `simd::get_l2_sqr_func()`.
+//   * L2, IP or COS, matching the metric the graph was built with. L2 uses
+//     `simd::get_l2_sqr_func()`; IP and COS use `simd::get_ip_sqr_func()`
+//     (negated inner product, so smaller is still better). COS expects
+//     unit-normalized rows and normalizes each query.
 //   * In-memory only. Vectors and graph are provided by the caller; this
 //     header does no I/O and owns no on-disk file.
 //   * No coupling to the disk-segment subsystem in `include/index/disk/`
@@ -23,10 +26,12 @@
 //   * `query` — `dim` float32. Read but never mutated.
 //
 // Output: a `std::vector<GreedyHit>` of length at most
-// `min(top_k, reader.num_nodes())`, sorted by ascending L2 squared
-// distance with ties broken by ascending internal id.
+// `min(top_k, reader.num_nodes())`, sorted by ascending distance with ties
+// broken by ascending internal id.
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <mutex>
@@ -36,12 +41,15 @@
 
 #include "index/graph/vamana/robust_prune.hpp"  // Neighbor, NeighborPriorityQueue (read-only)
 #include "index/graph/vamana/vamana_reader.hpp"
+#include "simd/distance_ip.hpp"
 #include "simd/distance_l2.hpp"
+#include "utils/metric_type.hpp"
+#include "utils/prefetch.hpp"
 
 namespace alaya::vamana {
 
-// Result of a single greedy search hit: internal node id and the L2
-// squared distance to the query.
+// Result of a single greedy search hit: internal node id and the distance
+// to the query under the search's metric.
 struct GreedyHit {
   uint32_t id;
   float distance;
@@ -52,8 +60,17 @@ class VamanaGreedySearch {
   // The constructor borrows the reader and the vectors buffer. Both must
   // outlive every `search()` call. `vectors` must point to at least
   // `reader.num_nodes() * dim` consecutive float32 values, row-major.
-  VamanaGreedySearch(const VamanaReader &reader, const float *vectors, uint32_t dim)
-      : reader_(reader), vectors_(vectors), dim_(dim), kernel_(alaya::simd::get_l2_sqr_func()) {}
+  VamanaGreedySearch(const VamanaReader &reader,
+                     const float *vectors,
+                     uint32_t dim,
+                     MetricType metric = MetricType::L2)
+      : reader_(reader),
+        vectors_(vectors),
+        dim_(dim),
+        metric_(metric),
+        kernel_(select_kernel(metric)),
+        vector_lines_(
+            static_cast<uint32_t>((static_cast<size_t>(dim) * sizeof(float) + 63) / 64)) {}
 
   // Non-copyable, non-movable — keeps scratch state local-only and
   // matches the reader's ownership contract.
@@ -75,8 +92,20 @@ class VamanaGreedySearch {
   // treat `at most num_nodes()` as the upper bound.
   //
   // Throws `std::runtime_error` if any of: `top_k == 0`,
-  // `search_list_size == 0`, `search_list_size < top_k`.
+  // `search_list_size == 0`, `search_list_size < top_k`, or a
+  // zero-magnitude query under COS.
   std::vector<GreedyHit> search(const float *query, uint32_t top_k, uint32_t search_list_size) {
+    std::vector<GreedyHit> result;
+    search_into(query, top_k, search_list_size, result);
+    return result;
+  }
+
+  // Same contract as search(), but writes the hits into `result` (cleared
+  // first) so a caller that keeps the buffer across queries does not allocate.
+  void search_into(const float *query,
+                   uint32_t top_k,
+                   uint32_t search_list_size,
+                   std::vector<GreedyHit> &result) {
     if (top_k == 0) {
       throw std::runtime_error("VamanaGreedySearch: top_k = 0 is not supported");
     }
@@ -93,10 +122,27 @@ class VamanaGreedySearch {
       std::vector<uint8_t> visited;
       std::vector<uint32_t> visited_touched;
       NeighborPriorityQueue pool;
+      std::vector<float> normalized_query;
     };
 
     thread_local SearchScratch scratch;
 
+    if (metric_ == MetricType::COS) {
+      double sum_sq = 0.0;
+      for (uint32_t c = 0; c < dim_; ++c) {
+        sum_sq += static_cast<double>(query[c]) * static_cast<double>(query[c]);
+      }
+      if (sum_sq == 0.0) {
+        throw std::runtime_error("VamanaGreedySearch: zero-magnitude query under COS metric");
+      }
+      const double inv_norm = 1.0 / std::sqrt(sum_sq);
+      scratch.normalized_query.resize(dim_);
+      for (uint32_t c = 0; c < dim_; ++c) {
+        scratch.normalized_query[c] = static_cast<float>(static_cast<double>(query[c]) * inv_norm);
+      }
+      query = scratch.normalized_query.data();
+    }
+
     // Clear only the visited entries set in the previous call so reset
     // cost is O(|visited last time|) rather than O(num_nodes).
     if (scratch.visited.size() == reader_.num_nodes()) {
@@ -111,25 +157,41 @@ class VamanaGreedySearch {
     scratch.pool.clear();
     scratch.pool.reserve(search_list_size);
 
-    const auto &graph = reader_.graph();
     const uint32_t start_id = reader_.start();
     const size_t dim_sz = static_cast<size_t>(dim_);
+    // Hot-loop state lives in locals: the visited stores go through a
+    // uint8_t pointer, which may alias anything, so member reads inside the
+    // loop would be reloaded after every store.
+    const auto kernel = kernel_;
+    const float *vectors = vectors_;
+    const uint32_t lines = vector_lines_;
+    uint8_t *visited = scratch.visited.data();
+    auto &touched = scratch.visited_touched;
+    auto &pool = scratch.pool;
+
+    visited[start_id] = 1;
+    touched.push_back(start_id);
+    pool.insert(Neighbor(start_id, kernel(query, vectors + start_id * dim_sz, dim_sz)));
 
-    scratch.visited[start_id] = 1;
-    scratch.visited_touched.push_back(start_id);
-    const float start_dist =
-        kernel_(query, vectors_ + static_cast<size_t>(start_id) * dim_sz, dim_sz);
-    scratch.pool.insert(Neighbor(start_id, start_dist));
-
-    while (scratch.pool.has_unexpanded_node()) {
-      const Neighbor n = scratch.pool.closest_unexpanded();
-      const std::vector<uint32_t> &nbrs = graph[n.id];
-      for (uint32_t m : nbrs) {
-        if (scratch.visited[m] == 0) {
-          scratch.visited[m] = 1;
-          scratch.visited_touched.push_back(m);
-          const float dist = kernel_(query, vectors_ + static_cast<size_t>(m) * dim_sz, dim_sz);
-          scratch.pool.insert(Neighbor(m, dist));
+    while (pool.has_unexpanded_node()) {
+      const Neighbor n = pool.closest_unexpanded();
+      const auto nbrs = reader_.neighbors(n.id);
+      const size_t degree = nbrs.size();
+      // Warm the first few neighbor vectors before the loop, then keep a
+      // fixed lookahead of kPrefetchDistance rows ahead of the kernel (the
+      // same jump-prefetch pattern as GraphSearchJob::search_solo).
+      for (size_t i = 0; i < std::min(degree, kPrefetchDistance); ++i) {
+        mem_prefetch_l1(vectors + nbrs[i] * dim_sz, lines);
+      }
+      for (size_t i = 0; i < degree; ++i) {
+        const uint32_t m = nbrs[i];
+        if (i + kPrefetchDistance < degree) {
+          mem_prefetch_l1(vectors + nbrs[i + kPrefetchDistance] * dim_sz, lines);
+        }
+        if (visited[m] == 0) {
+          visited[m] = 1;
+          touched.push_back(m);
+          pool.insert(Neighbor(m, kernel(query, vectors + m * dim_sz, dim_sz)));
         }
       }
     }
@@ -139,16 +201,15 @@ class VamanaGreedySearch {
     // top-k in spec order without an extra sort.
     const size_t pool_size = scratch.pool.size();
     const size_t take = std::min<size_t>(static_cast<size_t>(top_k), pool_size);
-    std::vector<GreedyHit> result;
+    result.clear();
     result.reserve(take);
     for (size_t i = 0; i < take; ++i) {
       result.push_back(GreedyHit{scratch.pool[i].id, scratch.pool[i].distance});
     }
-    {
+    if (record_visit_order_.load(std::memory_order_relaxed)) {
       std::lock_guard<std::mutex> guard(last_visited_mutex_);
       last_visited_order_ = scratch.visited_touched;
     }
-    return result;
   }
 
   // Accessors for tests / introspection. The first-inserted candidate
@@ -157,17 +218,41 @@ class VamanaGreedySearch {
   uint32_t medoid() const { return reader_.start(); }
 
   // Insertion order of the visited bitset for the most recent
-  // `search()` call. Element 0 is always the medoid. Used by the
+  // `search()` call made while recording was on (see
+  // `record_visit_order()`). Element 0 is always the medoid. Used by the
   // "search starts from medoid" spec scenario; not part of the
   // production query path.
   const std::vector<uint32_t> &last_visited_order() const { return last_visited_order_; }
 
+  // Turn `last_visited_order()` capture on or off. Off by default: the copy
+  // is taken under a mutex shared by every concurrent query, so production
+  // searches skip it entirely.
+  void record_visit_order(bool on) { record_visit_order_.store(on, std::memory_order_relaxed); }
+
  private:
+  static auto select_kernel(MetricType metric) -> alaya::simd::L2SqrFunc {
+    switch (metric) {
+      case MetricType::L2:
+        return alaya::simd::get_l2_sqr_func();
+      case MetricType::IP:
+      case MetricType::COS:
+        return alaya::simd::get_ip_sqr_func();
+      default:
+        throw std::runtime_error("VamanaGreedySearch: metric must be one of L2, IP, COS");
+    }
+  }
+
   const VamanaReader &reader_;
   const float *vectors_;
   uint32_t dim_;
+  MetricType metric_;
   alaya::simd::L2SqrFunc kernel_;
+  // Cache lines per vector row, for the neighbor-vector prefetch.
+  uint32_t vector_lines_;
+
+  static constexpr size_t kPrefetchDistance = 3;
 
+  std::atomic<bool> record_visit_order_{false};
   mutable std::mutex last_visited_mutex_;
   std::vector<uint32_t> last_visited_order_;
 };
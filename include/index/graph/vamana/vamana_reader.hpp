@@ -6,16 +6,18 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>  // NOLINT(build/c++17)
 #include <fstream>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
 
 // VamanaReader — load a DiskANN-compatible Vamana `.index` file produced by
-// `alaya::vamana::save_graph` (see `vamana_writer.hpp`) back into the same
-// in-memory shape returned by `VamanaBuilder::graph()`.
+// `alaya::vamana::save_graph` (see `vamana_writer.hpp`) back into memory,
+// with the same per-node neighbor lists as `VamanaBuilder::graph()`.
 //
 // On-disk byte layout (native byte order, no padding) — must stay in sync
 // with `vamana_writer.hpp:29-44`. Any change here must also update the
@@ -33,6 +35,12 @@
 // design.md). After the constructor returns successfully, the reader's
 // graph is known to satisfy every invariant documented in the
 // `vamana-reader` spec.
+//
+// In memory the adjacency is CSR-packed: one `offsets` array of
+// num_nodes + 1 entries and one flat `neighbors` array, so a search walks
+// two contiguous buffers instead of chasing a heap allocation per node.
+// Both arrays are read fully into memory at construction; nothing is
+// mmapped, and the `.index` file keeps the per-record DiskANN layout.
 
 namespace alaya::vamana {
 
@@ -41,10 +49,10 @@ class VamanaReader {
   // Load and validate a Vamana `.index` file.
   //
   // The constructor performs all I/O and validation in a single pass.
-  // On success the reader owns an in-memory adjacency matching
-  // `VamanaBuilder::graph()`. On any structural failure it throws
-  // `std::runtime_error` whose message identifies the offending byte
-  // offset, node id, or field as appropriate.
+  // On success the reader owns a CSR adjacency with the same per-node
+  // neighbor lists as `VamanaBuilder::graph()`. On any structural failure
+  // it throws `std::runtime_error` whose message identifies the offending
+  // byte offset, node id, or field as appropriate.
   //
   // Layout consumed by this constructor — must stay in sync with
   // `vamana_writer.hpp:29-44`:
@@ -112,18 +120,31 @@ class VamanaReader {
                                " but v1 only supports frozen_pts=0 (path: " + path.string() + ")");
     }
 
-    // Per-node loop: every read is bounds-checked against the records-region
-    // byte budget so mid-record truncation surfaces with the offending file
-    // offset rather than as a stream-EOF.
+    // The records region is read in one bulk call and then compacted in
+    // place into the CSR neighbor array: each record's k word is dropped and
+    // its neighbors slide down behind the previous node's. The write cursor
+    // never passes the read cursor, so no second buffer is needed.
     const uint64_t records_total_bytes = expected_file_size_ - kHeaderSize;
+    neighbors_.resize(static_cast<size_t>((records_total_bytes + sizeof(uint32_t) - 1) /
+                                          sizeof(uint32_t)));
+    in.read(reinterpret_cast<char *>(neighbors_.data()),
+            static_cast<std::streamsize>(records_total_bytes));
+    if (!in.good()) {
+      throw std::runtime_error("VamanaReader: stream error reading node records from " +
+                               path.string());
+    }
 
     // Each healthy record is ≥ 8 bytes (4 for k, 4 for ≥ 1 neighbor — k=0
     // is rejected below), so records_total_bytes / 8 is a safe upper bound
-    // for num_nodes and avoids per-node reallocations of `graph_`.
-    const size_t reserve_hint = static_cast<size_t>(records_total_bytes / 8U);
-    graph_.reserve(reserve_hint);
+    // for num_nodes and avoids reallocations of `offsets_`.
+    offsets_.reserve(static_cast<size_t>(records_total_bytes / 8U) + 1);
+    offsets_.push_back(0);
 
+    // Per-node loop: every record is bounds-checked against the
+    // records-region byte budget so mid-record truncation surfaces with the
+    // offending file offset.
     uint64_t consumed = 0;
+    uint64_t packed = 0;
     while (consumed < records_total_bytes) {
       if (consumed + sizeof(uint32_t) > records_total_bytes) {
         throw std::runtime_error("VamanaReader: mid-record truncation reading k at byte offset " +
@@ -131,16 +152,11 @@ class VamanaReader {
                                  " (path: " + path.string() + ")");
       }
 
-      uint32_t k = 0;
-      in.read(reinterpret_cast<char *>(&k), sizeof(uint32_t));
-      if (!in.good()) {
-        throw std::runtime_error("VamanaReader: stream error reading k at byte offset " +
-                                 std::to_string(kHeaderSize + consumed) +
-                                 " (path: " + path.string() + ")");
-      }
+      const uint64_t k_word = consumed / sizeof(uint32_t);
+      const uint32_t k = neighbors_[k_word];
       consumed += sizeof(uint32_t);
 
-      const uint32_t node_id = static_cast<uint32_t>(graph_.size());
+      const uint32_t node_id = static_cast<uint32_t>(offsets_.size() - 1);
 
       if (k == 0) {
         throw std::runtime_error("VamanaReader: node " + std::to_string(node_id) +
@@ -162,15 +178,10 @@ class VamanaReader {
             " (path: " + path.string() + ")");
       }
 
-      std::vector<uint32_t> adj(k);
-      in.read(reinterpret_cast<char *>(adj.data()), static_cast<std::streamsize>(neighbor_bytes));
-      if (!in.good()) {
-        throw std::runtime_error("VamanaReader: stream error reading neighbors for node " +
-                                 std::to_string(node_id) + " (path: " + path.string() + ")");
-      }
+      std::memmove(neighbors_.data() + packed, neighbors_.data() + k_word + 1, neighbor_bytes);
+      packed += k;
       consumed += neighbor_bytes;
-
-      graph_.push_back(std::move(adj));
+      offsets_.push_back(packed);
     }
 
     // Defensive post-condition: the bounds checks above already prevent
@@ -183,7 +194,9 @@ class VamanaReader {
                                " (path: " + path.string() + ")");
     }
 
-    num_nodes_ = graph_.size();
+    neighbors_.resize(static_cast<size_t>(packed));
+    neighbors_.shrink_to_fit();
+    num_nodes_ = offsets_.size() - 1;
 
     // Empty graph: `start` must reference a real id, so 0 nodes is invalid.
     if (num_nodes_ == 0) {
@@ -194,8 +207,8 @@ class VamanaReader {
 
     // Neighbor-range and self-loop validation has to wait until after the
     // parse loop because `num_nodes` is not known mid-stream.
-    for (size_t i = 0; i < graph_.size(); ++i) {
-      for (uint32_t n : graph_[i]) {
+    for (size_t i = 0; i < num_nodes_; ++i) {
+      for (uint32_t n : neighbors(static_cast<uint32_t>(i))) {
         if (n >= num_nodes_) {
           throw std::runtime_error("VamanaReader: node " + std::to_string(i) +
                                    " has out-of-range neighbor id " + std::to_string(n) +
@@ -227,7 +240,18 @@ class VamanaReader {
   uint32_t start() const { return start_; }
   uint64_t frozen_pts() const { return frozen_pts_; }
   size_t num_nodes() const { return num_nodes_; }
-  const std::vector<std::vector<uint32_t>> &graph() const { return graph_; }
+
+  // Out-neighbors of `id`, a view into the packed neighbor array. `id` must
+  // be < num_nodes(); not bounds-checked, as this sits on the search path.
+  std::span<const uint32_t> neighbors(uint32_t id) const {
+    const uint64_t begin = offsets_[id];
+    return {neighbors_.data() + begin, static_cast<size_t>(offsets_[id + 1] - begin)};
+  }
+
+  // Raw CSR arrays: node i's neighbors are
+  // neighbor_array()[offsets()[i] .. offsets()[i + 1]).
+  const std::vector<uint64_t> &offsets() const { return offsets_; }
+  const std::vector<uint32_t> &neighbor_array() const { return neighbors_; }
 
  private:
   static constexpr uint64_t kHeaderSize = 24;
@@ -237,7 +261,8 @@ class VamanaReader {
   uint32_t start_ = 0;
   uint64_t frozen_pts_ = 0;
   size_t num_nodes_ = 0;
-  std::vector<std::vector<uint32_t>> graph_;
+  std::vector<uint64_t> offsets_;
+  std::vector<uint32_t> neighbors_;
 };
 
 }  // namespace alaya::vamana
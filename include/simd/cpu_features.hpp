@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 #include "utils/platform.hpp"
 
 namespace alaya::simd {
@@ -19,6 +20,10 @@ struct CpuFeatures {
   bool avx512bw_ = false;
   bool avx2_ = false;
   bool fma_ = false;
+  bool f16c_ = false;
+  bool avx512bf16_ = false;
+  bool avx512vnni_ = false;
+  bool avxvnni_ = false;
   bool sse4_1_ = false;
 
   static auto detect() -> CpuFeatures {
@@ -38,6 +43,18 @@ struct CpuFeatures {
     if (__builtin_cpu_supports("fma")) {
       features.fma_ = true;
     }
+    if (__builtin_cpu_supports("f16c")) {
+      features.f16c_ = true;
+    }
+    if (__builtin_cpu_supports("avx512bf16")) {
+      features.avx512bf16_ = true;
+    }
+    if (__builtin_cpu_supports("avx512vnni")) {
+      features.avx512vnni_ = true;
+    }
+    if (__builtin_cpu_supports("avxvnni")) {
+      features.avxvnni_ = true;
+    }
     if (__builtin_cpu_supports("sse4.1")) {
       features.sse4_1_ = true;
     }
@@ -50,12 +67,17 @@ struct CpuFeatures {
       __cpuid(cpu_info, 1);
       features.sse4_1_ = (cpu_info[2] & (1 << 19)) != 0;
       features.fma_ = (cpu_info[2] & (1 << 12)) != 0;
+      features.f16c_ = (cpu_info[2] & (1 << 29)) != 0;
     }
     if (max_func >= 7) {
       __cpuidex(cpu_info, 7, 0);
       features.avx512f_ = (cpu_info[1] & (1 << 16)) != 0;
       features.avx512bw_ = (cpu_info[1] & (1 << 30)) != 0;
       features.avx2_ = (cpu_info[1] & (1 << 5)) != 0;
+      features.avx512vnni_ = (cpu_info[2] & (1 << 11)) != 0;
+      __cpuidex(cpu_info, 7, 1);
+      features.avxvnni_ = (cpu_info[0] & (1 << 4)) != 0;
+      features.avx512bf16_ = (cpu_info[0] & (1 << 5)) != 0;
     }
   #endif
 #endif
@@ -69,6 +91,64 @@ inline auto get_cpu_features() -> const CpuFeatures & {
   return kFeatures;
 }
 
+/**
+ * @brief Identify the CPU model as "vendor-family-model-stepping", e.g. "GenuineIntel-6-143-8"
+ *
+ * Two hosts with the same signature run the same microarchitecture, so kernel timings measured on
+ * one hold on the other. Returns "generic" where CPUID is unavailable.
+ */
+inline auto detect_cpu_signature() -> std::string {
+#ifdef ALAYA_ARCH_X86
+  uint32_t regs[4] = {0, 0, 0, 0};  // eax, ebx, ecx, edx
+  #if defined(__GNUC__) || defined(__clang__)
+  if (__get_cpuid(0, &regs[0], &regs[1], &regs[2], &regs[3]) == 0) {
+    return "generic";
+  }
+  #elif defined(_MSC_VER)
+  int cpu_info[4];
+  __cpuid(cpu_info, 0);
+  for (int i = 0; i < 4; ++i) {
+    regs[i] = static_cast<uint32_t>(cpu_info[i]);
+  }
+  #else
+  return "generic";
+  #endif
+  const uint32_t max_leaf = regs[0];
+  char vendor[13] = {};
+  std::memcpy(vendor, &regs[1], 4);
+  std::memcpy(vendor + 4, &regs[3], 4);
+  std::memcpy(vendor + 8, &regs[2], 4);
+  if (max_leaf < 1) {
+    return vendor;
+  }
+  #if defined(__GNUC__) || defined(__clang__)
+  __get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]);
+  #elif defined(_MSC_VER)
+  __cpuid(cpu_info, 1);
+  regs[0] = static_cast<uint32_t>(cpu_info[0]);
+  #endif
+  const uint32_t eax = regs[0];
+  const uint32_t stepping = eax & 0xFU;
+  uint32_t model = (eax >> 4) & 0xFU;
+  uint32_t family = (eax >> 8) & 0xFU;
+  if (family == 0x6U || family == 0xFU) {
+    model += ((eax >> 16) & 0xFU) << 4;
+  }
+  if (family == 0xFU) {
+    family += (eax >> 20) & 0xFFU;
+  }
+  return std::string(vendor) + '-' + std::to_string(family) + '-' + std::to_string(model) + '-' +
+         std::to_string(stepping);
+#else
+  return "generic";
+#endif
+}
+
+inline auto get_cpu_signature() -> const std::string & {
+  static const std::string kSignature = detect_cpu_signature();
+  return kSignature;
+}
+
 // ============================================================================
 // SIMD Level Enum
 // ============================================================================
@@ -77,6 +157,7 @@ enum class SimdLevel : std::uint8_t { kGeneric, kSse4, kAvx2, kAvx512 };
 enum class DistanceDispatchPolicy : std::uint8_t {
   kPreferStableThroughput,
   kPreferAvx512,
+  kAutotune,  ///< Spaces time the candidate kernels for their dimension, see kernel_tuner.hpp
 };
 
 inline constexpr const char *kDistanceDispatchPolicyEnv = "ALAYA_SIMD_DISTANCE_POLICY";
@@ -85,6 +166,9 @@ inline auto parse_distance_dispatch_policy(const char *value) -> DistanceDispatc
   if (value != nullptr && std::strcmp(value, "avx512") == 0) {
     return DistanceDispatchPolicy::kPreferAvx512;
   }
+  if (value != nullptr && std::strcmp(value, "autotune") == 0) {
+    return DistanceDispatchPolicy::kAutotune;
+  }
   return DistanceDispatchPolicy::kPreferStableThroughput;
 }
 
@@ -94,6 +178,24 @@ inline auto get_distance_dispatch_policy() -> DistanceDispatchPolicy {
   return kPolicy;
 }
 
+inline constexpr const char *kSq8Int8QueryEnv = "ALAYA_SQ8_INT8_QUERY";
+
+/// Whether SQ8 query computers quantize the query to integers once per query and score rows with
+/// the VNNI integer kernels. Off unless ALAYA_SQ8_INT8_QUERY=1 and the CPU has AVX-512 VNNI or
+/// AVX-VNNI: the 7-bit weights round dimensions whose range is much narrower than the widest one
+/// toward zero, so the FP32 path stays the default.
+inline auto use_sq8_int8_query() -> bool {
+  static const bool kEnabled = []() -> bool {
+    const auto &f = get_cpu_features();
+    if (!((f.avx512vnni_ && f.avx512bw_) || f.avxvnni_)) {
+      return false;
+    }
+    const char *opt_in = std::getenv(kSq8Int8QueryEnv);
+    return opt_in != nullptr && opt_in[0] == '1' && opt_in[1] == '\0';
+  }();
+  return kEnabled;
+}
+
 inline auto select_fp32_distance_level(const CpuFeatures &features, DistanceDispatchPolicy policy)
     -> SimdLevel {
 #ifdef ALAYA_ARCH_X86
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "cpu_features.hpp"
+#include "distance_ip.hpp"
+#include "distance_l2.hpp"
+
+namespace alaya::simd {
+
+// One-to-many kernels: one query against kDistanceBatchWidth rows per call, so each query
+// register is loaded once per pass and the row loads of the batch overlap.
+constexpr size_t kDistanceBatchWidth = 4;
+
+// Type Definitions
+// out[r] = l2_sqr(query, rows[r]) / ip_sqr(query, rows[r]) for r < kDistanceBatchWidth
+using L2SqrBatchFunc = void (*)(const float *__restrict query,
+                                const float *const *rows,
+                                size_t dim,
+                                float *out);
+using IpSqrBatchFunc = void (*)(const float *__restrict query,
+                                const float *const *rows,
+                                size_t dim,
+                                float *out);
+// SQ8, with the query decoded once up front:
+//   L2: query_scaled[i] = code[i] * scale[i];  out[r] = sum((query_scaled - rows[r] * scale)^2)
+//   IP: weight[i] = value[i] * scale[i];        out[r] = sum(weight * rows[r])
+// The IP kernel leaves out the constant sum(value * min) and the sign, which the caller adds.
+using L2SqrSq8BatchFunc = void (*)(const float *__restrict query_scaled,
+                                   const float *__restrict scale,
+                                   const uint8_t *const *rows,
+                                   size_t dim,
+                                   float *out);
+using DotSq8BatchFunc = void (*)(const float *__restrict weight,
+                                 const uint8_t *const *rows,
+                                 size_t dim,
+                                 float *out);
+// SQ4 takes the same decoded query, but each full block of kSq4BatchBlock dimensions is laid
+// out as its even dimensions followed by its odd ones, matching the low / high nibbles of the
+// block's bytes (see sq4_batch_position()). Dimensions past the last full block keep their order.
+using L2SqrSq4BatchFunc = L2SqrSq8BatchFunc;
+using DotSq4BatchFunc = DotSq8BatchFunc;
+
+constexpr size_t kSq4BatchBlock = 16;
+
+/// Position of dimension `d` in a decoded SQ4 query of dimensionality `dim`.
+constexpr auto sq4_batch_position(size_t d, size_t dim) -> size_t {
+  const size_t full = dim - dim % kSq4BatchBlock;
+  if (d >= full) {
+    return d;
+  }
+  const size_t base = d - d % kSq4BatchBlock;
+  const size_t k = d % kSq4BatchBlock;
+  return base + (k % 2) * (kSq4BatchBlock / 2) + k / 2;
+}
+
+auto l2_sqr_batch4_generic(const float *__restrict query,
+                           const float *const *rows,
+                           size_t dim,
+                           float *out) -> void;
+auto ip_sqr_batch4_generic(const float *__restrict query,
+                           const float *const *rows,
+                           size_t dim,
+                           float *out) -> void;
+auto l2_sqr_sq8_batch4_generic(const float *__restrict query_scaled,
+                               const float *__restrict scale,
+                               const uint8_t *const *rows,
+                               size_t dim,
+                               float *out) -> void;
+auto dot_sq8_batch4_generic(const float *__restrict weight,
+                            const uint8_t *const *rows,
+                            size_t dim,
+                            float *out) -> void;
+auto l2_sqr_sq4_batch4_generic(const float *__restrict query_scaled,
+                               const float *__restrict scale,
+                               const uint8_t *const *rows,
+                               size_t dim,
+                               float *out) -> void;
+auto dot_sq4_batch4_generic(const float *__restrict weight,
+                            const uint8_t *const *rows,
+                            size_t dim,
+                            float *out) -> void;
+
+#ifdef ALAYA_ARCH_X86
+auto l2_sqr_batch4_avx2(const float *__restrict query,
+                        const float *const *rows,
+                        size_t dim,
+                        float *out) -> void;
+auto l2_sqr_batch4_avx512(const float *__restrict query,
+                          const float *const *rows,
+                          size_t dim,
+                          float *out) -> void;
+auto ip_sqr_batch4_avx2(const float *__restrict query,
+                        const float *const *rows,
+                        size_t dim,
+                        float *out) -> void;
+auto ip_sqr_batch4_avx512(const float *__restrict query,
+                          const float *const *rows,
+                          size_t dim,
+                          float *out) -> void;
+auto l2_sqr_sq8_batch4_avx2(const float *__restrict query_scaled,
+                            const float *__restrict scale,
+                            const uint8_t *const *rows,
+                            size_t dim,
+                            float *out) -> void;
+auto l2_sqr_sq8_batch4_avx512(const float *__restrict query_scaled,
+                              const float *__restrict scale,
+                              const uint8_t *const *rows,
+                              size_t dim,
+                              float *out) -> void;
+auto dot_sq8_batch4_avx2(const float *__restrict weight,
+                         const uint8_t *const *rows,
+                         size_t dim,
+                         float *out) -> void;
+auto dot_sq8_batch4_avx512(const float *__restrict weight,
+                           const uint8_t *const *rows,
+                           size_t dim,
+                           float *out) -> void;
+auto l2_sqr_sq4_batch4_avx2(const float *__restrict query_scaled,
+                            const float *__restrict scale,
+                            const uint8_t *const *rows,
+                            size_t dim,
+                            float *out) -> void;
+auto l2_sqr_sq4_batch4_avx512(const float *__restrict query_scaled,
+                              const float *__restrict scale,
+                              const uint8_t *const *rows,
+                              size_t dim,
+                              float *out) -> void;
+auto dot_sq4_batch4_avx2(const float *__restrict weight,
+                         const uint8_t *const *rows,
+                         size_t dim,
+                         float *out) -> void;
+auto dot_sq4_batch4_avx512(const float *__restrict weight,
+                           const uint8_t *const *rows,
+                           size_t dim,
+                           float *out) -> void;
+#endif
+
+// Dispatch
+auto get_l2_sqr_batch4_func() -> L2SqrBatchFunc;
+auto get_ip_sqr_batch4_func() -> IpSqrBatchFunc;
+auto get_l2_sqr_sq8_batch4_func() -> L2SqrSq8BatchFunc;
+auto get_dot_sq8_batch4_func() -> DotSq8BatchFunc;
+auto get_l2_sqr_sq4_batch4_func() -> L2SqrSq4BatchFunc;
+auto get_dot_sq4_batch4_func() -> DotSq4BatchFunc;
+
+}  // namespace alaya::simd
+
+// Implementation
+#include "distance_batch.ipp"
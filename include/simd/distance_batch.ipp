@@ -0,0 +1,727 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+// This file is included by distance_batch.hpp - do not include directly
+// NOLINTBEGIN(portability-simd-intrinsics)
+#include <cstddef>
+#include <cstdint>
+#include "cpu_features.hpp"
+
+namespace alaya::simd {
+
+// Generic implementations loop over the single-vector kernels picked by the regular
+// dispatch, so the ALAYA_FORCE_* overrides still apply on the batched path.
+inline auto l2_sqr_batch4_generic(const float *__restrict query,
+                                  const float *const *rows,
+                                  size_t dim,
+                                  float *out) -> void {
+  const auto func = get_l2_sqr_func();
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    out[r] = func(query, rows[r], dim);
+  }
+}
+
+inline auto ip_sqr_batch4_generic(const float *__restrict query,
+                                  const float *const *rows,
+                                  size_t dim,
+                                  float *out) -> void {
+  const auto func = get_ip_sqr_func();
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    out[r] = func(query, rows[r], dim);
+  }
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto l2_sqr_sq8_batch4_generic(const float *__restrict query_scaled,
+                                      const float *__restrict scale,
+                                      const uint8_t *const *rows,
+                                      size_t dim,
+                                      float *out) -> void {
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    const uint8_t *y = rows[r];
+    float sum = 0.0F;
+    for (size_t i = 0; i < dim; ++i) {
+      float diff = query_scaled[i] - static_cast<float>(y[i]) * scale[i];
+      sum += diff * diff;
+    }
+    out[r] = sum;
+  }
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto dot_sq8_batch4_generic(const float *__restrict weight,
+                                   const uint8_t *const *rows,
+                                   size_t dim,
+                                   float *out) -> void {
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    const uint8_t *y = rows[r];
+    float sum = 0.0F;
+    for (size_t i = 0; i < dim; ++i) {
+      sum += weight[i] * static_cast<float>(y[i]);
+    }
+    out[r] = sum;
+  }
+}
+
+// Code of dimension `d` in an SQ4 row (low nibble = even dimension)
+inline auto sq4_code(const uint8_t *row, size_t d) -> float {
+  return static_cast<float>((row[d / 2] >> ((d % 2) * 4)) & 0x0F);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto l2_sqr_sq4_batch4_generic(const float *__restrict query_scaled,
+                                      const float *__restrict scale,
+                                      const uint8_t *const *rows,
+                                      size_t dim,
+                                      float *out) -> void {
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = 0.0F;
+    for (size_t d = 0; d < dim; ++d) {
+      const size_t p = sq4_batch_position(d, dim);
+      float diff = query_scaled[p] - sq4_code(rows[r], d) * scale[p];
+      sum += diff * diff;
+    }
+    out[r] = sum;
+  }
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto dot_sq4_batch4_generic(const float *__restrict weight,
+                                   const uint8_t *const *rows,
+                                   size_t dim,
+                                   float *out) -> void {
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = 0.0F;
+    for (size_t d = 0; d < dim; ++d) {
+      sum += weight[sq4_batch_position(d, dim)] * sq4_code(rows[r], d);
+    }
+    out[r] = sum;
+  }
+}
+
+#ifdef ALAYA_ARCH_X86
+
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX2
+auto batch_hsum_avx2(__m256 v) -> float {
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  __m128 shuf = _mm_movehdup_ps(sum128);
+  sum128 = _mm_add_ps(sum128, shuf);
+  shuf = _mm_movehl_ps(shuf, sum128);
+  sum128 = _mm_add_ss(sum128, shuf);
+  return _mm_cvtss_f32(sum128);
+}
+
+// AVX2 FP32 L2: two accumulators per row, 16 floats of the query per iteration
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto l2_sqr_batch4_avx2(const float *__restrict query,
+                               const float *const *rows,
+                               size_t dim,
+                               float *out) -> void {
+  const float *y0 = rows[0];
+  const float *y1 = rows[1];
+  const float *y2 = rows[2];
+  const float *y3 = rows[3];
+  __m256 a0 = _mm256_setzero_ps();
+  __m256 a1 = _mm256_setzero_ps();
+  __m256 a2 = _mm256_setzero_ps();
+  __m256 a3 = _mm256_setzero_ps();
+  __m256 b0 = _mm256_setzero_ps();
+  __m256 b1 = _mm256_setzero_ps();
+  __m256 b2 = _mm256_setzero_ps();
+  __m256 b3 = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m256 qa = _mm256_loadu_ps(query + i);
+    __m256 qb = _mm256_loadu_ps(query + i + 8);
+    __m256 d = _mm256_sub_ps(qa, _mm256_loadu_ps(y0 + i));
+    a0 = _mm256_fmadd_ps(d, d, a0);
+    d = _mm256_sub_ps(qa, _mm256_loadu_ps(y1 + i));
+    a1 = _mm256_fmadd_ps(d, d, a1);
+    d = _mm256_sub_ps(qa, _mm256_loadu_ps(y2 + i));
+    a2 = _mm256_fmadd_ps(d, d, a2);
+    d = _mm256_sub_ps(qa, _mm256_loadu_ps(y3 + i));
+    a3 = _mm256_fmadd_ps(d, d, a3);
+    d = _mm256_sub_ps(qb, _mm256_loadu_ps(y0 + i + 8));
+    b0 = _mm256_fmadd_ps(d, d, b0);
+    d = _mm256_sub_ps(qb, _mm256_loadu_ps(y1 + i + 8));
+    b1 = _mm256_fmadd_ps(d, d, b1);
+    d = _mm256_sub_ps(qb, _mm256_loadu_ps(y2 + i + 8));
+    b2 = _mm256_fmadd_ps(d, d, b2);
+    d = _mm256_sub_ps(qb, _mm256_loadu_ps(y3 + i + 8));
+    b3 = _mm256_fmadd_ps(d, d, b3);
+  }
+  for (; i + 8 <= dim; i += 8) {
+    __m256 q = _mm256_loadu_ps(query + i);
+    __m256 d = _mm256_sub_ps(q, _mm256_loadu_ps(y0 + i));
+    a0 = _mm256_fmadd_ps(d, d, a0);
+    d = _mm256_sub_ps(q, _mm256_loadu_ps(y1 + i));
+    a1 = _mm256_fmadd_ps(d, d, a1);
+    d = _mm256_sub_ps(q, _mm256_loadu_ps(y2 + i));
+    a2 = _mm256_fmadd_ps(d, d, a2);
+    d = _mm256_sub_ps(q, _mm256_loadu_ps(y3 + i));
+    a3 = _mm256_fmadd_ps(d, d, a3);
+  }
+
+  out[0] = batch_hsum_avx2(_mm256_add_ps(a0, b0));
+  out[1] = batch_hsum_avx2(_mm256_add_ps(a1, b1));
+  out[2] = batch_hsum_avx2(_mm256_add_ps(a2, b2));
+  out[3] = batch_hsum_avx2(_mm256_add_ps(a3, b3));
+
+  // Tail
+  for (; i < dim; ++i) {
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      float diff = query[i] - rows[r][i];
+      out[r] += diff * diff;
+    }
+  }
+}
+
+// AVX2 FP32 IP (returns the negated inner product, like ip_sqr)
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto ip_sqr_batch4_avx2(const float *__restrict query,
+                               const float *const *rows,
+                               size_t dim,
+                               float *out) -> void {
+  const float *y0 = rows[0];
+  const float *y1 = rows[1];
+  const float *y2 = rows[2];
+  const float *y3 = rows[3];
+  __m256 a0 = _mm256_setzero_ps();
+  __m256 a1 = _mm256_setzero_ps();
+  __m256 a2 = _mm256_setzero_ps();
+  __m256 a3 = _mm256_setzero_ps();
+  __m256 b0 = _mm256_setzero_ps();
+  __m256 b1 = _mm256_setzero_ps();
+  __m256 b2 = _mm256_setzero_ps();
+  __m256 b3 = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m256 qa = _mm256_loadu_ps(query + i);
+    __m256 qb = _mm256_loadu_ps(query + i + 8);
+    a0 = _mm256_fmadd_ps(qa, _mm256_loadu_ps(y0 + i), a0);
+    a1 = _mm256_fmadd_ps(qa, _mm256_loadu_ps(y1 + i), a1);
+    a2 = _mm256_fmadd_ps(qa, _mm256_loadu_ps(y2 + i), a2);
+    a3 = _mm256_fmadd_ps(qa, _mm256_loadu_ps(y3 + i), a3);
+    b0 = _mm256_fmadd_ps(qb, _mm256_loadu_ps(y0 + i + 8), b0);
+    b1 = _mm256_fmadd_ps(qb, _mm256_loadu_ps(y1 + i + 8), b1);
+    b2 = _mm256_fmadd_ps(qb, _mm256_loadu_ps(y2 + i + 8), b2);
+    b3 = _mm256_fmadd_ps(qb, _mm256_loadu_ps(y3 + i + 8), b3);
+  }
+  for (; i + 8 <= dim; i += 8) {
+    __m256 q = _mm256_loadu_ps(query + i);
+    a0 = _mm256_fmadd_ps(q, _mm256_loadu_ps(y0 + i), a0);
+    a1 = _mm256_fmadd_ps(q, _mm256_loadu_ps(y1 + i), a1);
+    a2 = _mm256_fmadd_ps(q, _mm256_loadu_ps(y2 + i), a2);
+    a3 = _mm256_fmadd_ps(q, _mm256_loadu_ps(y3 + i), a3);
+  }
+
+  float sum[kDistanceBatchWidth] = {batch_hsum_avx2(_mm256_add_ps(a0, b0)),
+                                    batch_hsum_avx2(_mm256_add_ps(a1, b1)),
+                                    batch_hsum_avx2(_mm256_add_ps(a2, b2)),
+                                    batch_hsum_avx2(_mm256_add_ps(a3, b3))};
+  for (; i < dim; ++i) {
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      sum[r] += query[i] * rows[r][i];
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    out[r] = -sum[r];
+  }
+}
+
+// AVX-512 FP32 L2: two accumulators per row, 32 floats of the query per iteration
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto l2_sqr_batch4_avx512(const float *__restrict query,
+                                 const float *const *rows,
+                                 size_t dim,
+                                 float *out) -> void {
+  const float *y0 = rows[0];
+  const float *y1 = rows[1];
+  const float *y2 = rows[2];
+  const float *y3 = rows[3];
+  __m512 a0 = _mm512_setzero_ps();
+  __m512 a1 = _mm512_setzero_ps();
+  __m512 a2 = _mm512_setzero_ps();
+  __m512 a3 = _mm512_setzero_ps();
+  __m512 b0 = _mm512_setzero_ps();
+  __m512 b1 = _mm512_setzero_ps();
+  __m512 b2 = _mm512_setzero_ps();
+  __m512 b3 = _mm512_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m512 qa = _mm512_loadu_ps(query + i);
+    __m512 qb = _mm512_loadu_ps(query + i + 16);
+    __m512 d = _mm512_sub_ps(qa, _mm512_loadu_ps(y0 + i));
+    a0 = _mm512_fmadd_ps(d, d, a0);
+    d = _mm512_sub_ps(qa, _mm512_loadu_ps(y1 + i));
+    a1 = _mm512_fmadd_ps(d, d, a1);
+    d = _mm512_sub_ps(qa, _mm512_loadu_ps(y2 + i));
+    a2 = _mm512_fmadd_ps(d, d, a2);
+    d = _mm512_sub_ps(qa, _mm512_loadu_ps(y3 + i));
+    a3 = _mm512_fmadd_ps(d, d, a3);
+    d = _mm512_sub_ps(qb, _mm512_loadu_ps(y0 + i + 16));
+    b0 = _mm512_fmadd_ps(d, d, b0);
+    d = _mm512_sub_ps(qb, _mm512_loadu_ps(y1 + i + 16));
+    b1 = _mm512_fmadd_ps(d, d, b1);
+    d = _mm512_sub_ps(qb, _mm512_loadu_ps(y2 + i + 16));
+    b2 = _mm512_fmadd_ps(d, d, b2);
+    d = _mm512_sub_ps(qb, _mm512_loadu_ps(y3 + i + 16));
+    b3 = _mm512_fmadd_ps(d, d, b3);
+  }
+  for (; i < dim; i += 16) {
+    // Masked loads cover the last partial block without a scalar tail
+    auto mask = dim - i >= 16 ? static_cast<__mmask16>(0xFFFF)
+                              : static_cast<__mmask16>((1U << (dim - i)) - 1);
+    __m512 q = _mm512_maskz_loadu_ps(mask, query + i);
+    __m512 d = _mm512_sub_ps(q, _mm512_maskz_loadu_ps(mask, y0 + i));
+    a0 = _mm512_fmadd_ps(d, d, a0);
+    d = _mm512_sub_ps(q, _mm512_maskz_loadu_ps(mask, y1 + i));
+    a1 = _mm512_fmadd_ps(d, d, a1);
+    d = _mm512_sub_ps(q, _mm512_maskz_loadu_ps(mask, y2 + i));
+    a2 = _mm512_fmadd_ps(d, d, a2);
+    d = _mm512_sub_ps(q, _mm512_maskz_loadu_ps(mask, y3 + i));
+    a3 = _mm512_fmadd_ps(d, d, a3);
+  }
+
+  out[0] = _mm512_reduce_add_ps(_mm512_add_ps(a0, b0));
+  out[1] = _mm512_reduce_add_ps(_mm512_add_ps(a1, b1));
+  out[2] = _mm512_reduce_add_ps(_mm512_add_ps(a2, b2));
+  out[3] = _mm512_reduce_add_ps(_mm512_add_ps(a3, b3));
+}
+
+// AVX-512 FP32 IP (returns the negated inner product, like ip_sqr)
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto ip_sqr_batch4_avx512(const float *__restrict query,
+                                 const float *const *rows,
+                                 size_t dim,
+                                 float *out) -> void {
+  const float *y0 = rows[0];
+  const float *y1 = rows[1];
+  const float *y2 = rows[2];
+  const float *y3 = rows[3];
+  __m512 a0 = _mm512_setzero_ps();
+  __m512 a1 = _mm512_setzero_ps();
+  __m512 a2 = _mm512_setzero_ps();
+  __m512 a3 = _mm512_setzero_ps();
+  __m512 b0 = _mm512_setzero_ps();
+  __m512 b1 = _mm512_setzero_ps();
+  __m512 b2 = _mm512_setzero_ps();
+  __m512 b3 = _mm512_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m512 qa = _mm512_loadu_ps(query + i);
+    __m512 qb = _mm512_loadu_ps(query + i + 16);
+    a0 = _mm512_fmadd_ps(qa, _mm512_loadu_ps(y0 + i), a0);
+    a1 = _mm512_fmadd_ps(qa, _mm512_loadu_ps(y1 + i), a1);
+    a2 = _mm512_fmadd_ps(qa, _mm512_loadu_ps(y2 + i), a2);
+    a3 = _mm512_fmadd_ps(qa, _mm512_loadu_ps(y3 + i), a3);
+    b0 = _mm512_fmadd_ps(qb, _mm512_loadu_ps(y0 + i + 16), b0);
+    b1 = _mm512_fmadd_ps(qb, _mm512_loadu_ps(y1 + i + 16), b1);
+    b2 = _mm512_fmadd_ps(qb, _mm512_loadu_ps(y2 + i + 16), b2);
+    b3 = _mm512_fmadd_ps(qb, _mm512_loadu_ps(y3 + i + 16), b3);
+  }
+  for (; i < dim; i += 16) {
+    auto mask = dim - i >= 16 ? static_cast<__mmask16>(0xFFFF)
+                              : static_cast<__mmask16>((1U << (dim - i)) - 1);
+    __m512 q = _mm512_maskz_loadu_ps(mask, query + i);
+    a0 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(mask, y0 + i), a0);
+    a1 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(mask, y1 + i), a1);
+    a2 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(mask, y2 + i), a2);
+    a3 = _mm512_fmadd_ps(q, _mm512_maskz_loadu_ps(mask, y3 + i), a3);
+  }
+
+  out[0] = -_mm512_reduce_add_ps(_mm512_add_ps(a0, b0));
+  out[1] = -_mm512_reduce_add_ps(_mm512_add_ps(a1, b1));
+  out[2] = -_mm512_reduce_add_ps(_mm512_add_ps(a2, b2));
+  out[3] = -_mm512_reduce_add_ps(_mm512_add_ps(a3, b3));
+}
+
+// AVX2 SQ8 L2: widen 8 codes per row, one fnmadd + one fmadd per row and block
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto l2_sqr_sq8_batch4_avx2(const float *__restrict query_scaled,
+                                   const float *__restrict scale,
+                                   const uint8_t *const *rows,
+                                   size_t dim,
+                                   float *out) -> void {
+  __m256 acc[kDistanceBatchWidth] = {_mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps()};
+  size_t i = 0;
+  for (; i + 8 <= dim; i += 8) {
+    __m256 q = _mm256_loadu_ps(query_scaled + i);
+    __m256 s = _mm256_loadu_ps(scale + i);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      __m128i codes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows[r] + i));
+      __m256 y = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(codes));
+      __m256 d = _mm256_fnmadd_ps(y, s, q);
+      acc[r] = _mm256_fmadd_ps(d, d, acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = batch_hsum_avx2(acc[r]);
+    for (size_t j = i; j < dim; ++j) {
+      float diff = query_scaled[j] - static_cast<float>(rows[r][j]) * scale[j];
+      sum += diff * diff;
+    }
+    out[r] = sum;
+  }
+}
+
+// AVX2 SQ8 weighted dot product
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto dot_sq8_batch4_avx2(const float *__restrict weight,
+                                const uint8_t *const *rows,
+                                size_t dim,
+                                float *out) -> void {
+  __m256 acc[kDistanceBatchWidth] = {_mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps()};
+  size_t i = 0;
+  for (; i + 8 <= dim; i += 8) {
+    __m256 w = _mm256_loadu_ps(weight + i);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      __m128i codes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(rows[r] + i));
+      __m256 y = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(codes));
+      acc[r] = _mm256_fmadd_ps(w, y, acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = batch_hsum_avx2(acc[r]);
+    for (size_t j = i; j < dim; ++j) {
+      sum += weight[j] * static_cast<float>(rows[r][j]);
+    }
+    out[r] = sum;
+  }
+}
+
+// AVX-512 SQ8 L2
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto l2_sqr_sq8_batch4_avx512(const float *__restrict query_scaled,
+                                     const float *__restrict scale,
+                                     const uint8_t *const *rows,
+                                     size_t dim,
+                                     float *out) -> void {
+  __m512 acc[kDistanceBatchWidth] = {_mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps()};
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m512 q = _mm512_loadu_ps(query_scaled + i);
+    __m512 s = _mm512_loadu_ps(scale + i);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      __m128i codes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + i));
+      __m512 y = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(codes));
+      __m512 d = _mm512_fnmadd_ps(y, s, q);
+      acc[r] = _mm512_fmadd_ps(d, d, acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = _mm512_reduce_add_ps(acc[r]);
+    for (size_t j = i; j < dim; ++j) {
+      float diff = query_scaled[j] - static_cast<float>(rows[r][j]) * scale[j];
+      sum += diff * diff;
+    }
+    out[r] = sum;
+  }
+}
+
+// AVX-512 SQ8 weighted dot product
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto dot_sq8_batch4_avx512(const float *__restrict weight,
+                                  const uint8_t *const *rows,
+                                  size_t dim,
+                                  float *out) -> void {
+  __m512 acc[kDistanceBatchWidth] = {_mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps()};
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m512 w = _mm512_loadu_ps(weight + i);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      __m128i codes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(rows[r] + i));
+      __m512 y = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(codes));
+      acc[r] = _mm512_fmadd_ps(w, y, acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = _mm512_reduce_add_ps(acc[r]);
+    for (size_t j = i; j < dim; ++j) {
+      sum += weight[j] * static_cast<float>(rows[r][j]);
+    }
+    out[r] = sum;
+  }
+}
+
+// Unpack the 8 bytes of one SQ4 block into its even (low nibble) and odd (high nibble) codes
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX2
+auto sq4_block_codes_avx2(const uint8_t *block, __m256 &even, __m256 &odd) -> void {
+  __m256i bytes =
+      _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(block)));
+  even = _mm256_cvtepi32_ps(_mm256_and_si256(bytes, _mm256_set1_epi32(0x0F)));
+  odd = _mm256_cvtepi32_ps(_mm256_srli_epi32(bytes, 4));
+}
+
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX512
+auto sq4_block_codes_avx512(const uint8_t *block) -> __m512 {
+  __m256i bytes =
+      _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(block)));
+  __m256i even = _mm256_and_si256(bytes, _mm256_set1_epi32(0x0F));
+  __m256i odd = _mm256_srli_epi32(bytes, 4);
+  return _mm512_cvtepi32_ps(_mm512_inserti64x4(_mm512_castsi256_si512(even), odd, 1));
+}
+
+// AVX2 SQ4 L2 over the block-permuted decoded query
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto l2_sqr_sq4_batch4_avx2(const float *__restrict query_scaled,
+                                   const float *__restrict scale,
+                                   const uint8_t *const *rows,
+                                   size_t dim,
+                                   float *out) -> void {
+  __m256 acc[kDistanceBatchWidth] = {_mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps()};
+  size_t i = 0;
+  for (; i + kSq4BatchBlock <= dim; i += kSq4BatchBlock) {
+    __m256 q_even = _mm256_loadu_ps(query_scaled + i);
+    __m256 q_odd = _mm256_loadu_ps(query_scaled + i + 8);
+    __m256 s_even = _mm256_loadu_ps(scale + i);
+    __m256 s_odd = _mm256_loadu_ps(scale + i + 8);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      __m256 even;
+      __m256 odd;
+      sq4_block_codes_avx2(rows[r] + i / 2, even, odd);
+      __m256 d = _mm256_fnmadd_ps(even, s_even, q_even);
+      acc[r] = _mm256_fmadd_ps(d, d, acc[r]);
+      d = _mm256_fnmadd_ps(odd, s_odd, q_odd);
+      acc[r] = _mm256_fmadd_ps(d, d, acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = batch_hsum_avx2(acc[r]);
+    for (size_t d = i; d < dim; ++d) {
+      float diff = query_scaled[d] - sq4_code(rows[r], d) * scale[d];
+      sum += diff * diff;
+    }
+    out[r] = sum;
+  }
+}
+
+// AVX2 SQ4 weighted dot product over the block-permuted decoded query
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto dot_sq4_batch4_avx2(const float *__restrict weight,
+                                const uint8_t *const *rows,
+                                size_t dim,
+                                float *out) -> void {
+  __m256 acc[kDistanceBatchWidth] = {_mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps(),
+                                     _mm256_setzero_ps()};
+  size_t i = 0;
+  for (; i + kSq4BatchBlock <= dim; i += kSq4BatchBlock) {
+    __m256 w_even = _mm256_loadu_ps(weight + i);
+    __m256 w_odd = _mm256_loadu_ps(weight + i + 8);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      __m256 even;
+      __m256 odd;
+      sq4_block_codes_avx2(rows[r] + i / 2, even, odd);
+      acc[r] = _mm256_fmadd_ps(w_even, even, acc[r]);
+      acc[r] = _mm256_fmadd_ps(w_odd, odd, acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = batch_hsum_avx2(acc[r]);
+    for (size_t d = i; d < dim; ++d) {
+      sum += weight[d] * sq4_code(rows[r], d);
+    }
+    out[r] = sum;
+  }
+}
+
+// AVX-512 SQ4 L2: one block of 16 codes per row fills a single register
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto l2_sqr_sq4_batch4_avx512(const float *__restrict query_scaled,
+                                     const float *__restrict scale,
+                                     const uint8_t *const *rows,
+                                     size_t dim,
+                                     float *out) -> void {
+  __m512 acc[kDistanceBatchWidth] = {_mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps()};
+  size_t i = 0;
+  for (; i + kSq4BatchBlock <= dim; i += kSq4BatchBlock) {
+    __m512 q = _mm512_loadu_ps(query_scaled + i);
+    __m512 s = _mm512_loadu_ps(scale + i);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      __m512 d = _mm512_fnmadd_ps(sq4_block_codes_avx512(rows[r] + i / 2), s, q);
+      acc[r] = _mm512_fmadd_ps(d, d, acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = _mm512_reduce_add_ps(acc[r]);
+    for (size_t d = i; d < dim; ++d) {
+      float diff = query_scaled[d] - sq4_code(rows[r], d) * scale[d];
+      sum += diff * diff;
+    }
+    out[r] = sum;
+  }
+}
+
+// AVX-512 SQ4 weighted dot product
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto dot_sq4_batch4_avx512(const float *__restrict weight,
+                                  const uint8_t *const *rows,
+                                  size_t dim,
+                                  float *out) -> void {
+  __m512 acc[kDistanceBatchWidth] = {_mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps(),
+                                     _mm512_setzero_ps()};
+  size_t i = 0;
+  for (; i + kSq4BatchBlock <= dim; i += kSq4BatchBlock) {
+    __m512 w = _mm512_loadu_ps(weight + i);
+    for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+      acc[r] = _mm512_fmadd_ps(w, sq4_block_codes_avx512(rows[r] + i / 2), acc[r]);
+    }
+  }
+  for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+    float sum = _mm512_reduce_add_ps(acc[r]);
+    for (size_t d = i; d < dim; ++d) {
+      sum += weight[d] * sq4_code(rows[r], d);
+    }
+    out[r] = sum;
+  }
+}
+
+#endif  // ALAYA_ARCH_X86
+
+// Dispatch
+// FP32 batches follow whatever get_l2_sqr_func() / get_ip_sqr_func() resolved to, so the
+// dispatch policy and the scalar / DiskANN-compat overrides pick the same ISA for both paths.
+inline auto get_l2_sqr_batch4_func() -> L2SqrBatchFunc {
+  static const L2SqrBatchFunc kFunc = []() -> L2SqrBatchFunc {
+#ifdef ALAYA_ARCH_X86
+    const auto single = get_l2_sqr_func();
+    if (single == l2_sqr_avx512) {
+      return l2_sqr_batch4_avx512;
+    }
+    if (single == l2_sqr_avx2) {
+      return l2_sqr_batch4_avx2;
+    }
+#endif
+    return l2_sqr_batch4_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_ip_sqr_batch4_func() -> IpSqrBatchFunc {
+  static const IpSqrBatchFunc kFunc = []() -> IpSqrBatchFunc {
+#ifdef ALAYA_ARCH_X86
+    const auto single = get_ip_sqr_func();
+    if (single == ip_sqr_avx512) {
+      return ip_sqr_batch4_avx512;
+    }
+    if (single == ip_sqr_avx2) {
+      return ip_sqr_batch4_avx2;
+    }
+#endif
+    return ip_sqr_batch4_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_l2_sqr_sq8_batch4_func() -> L2SqrSq8BatchFunc {
+  static const L2SqrSq8BatchFunc kFunc = []() -> L2SqrSq8BatchFunc {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_) {
+      return l2_sqr_sq8_batch4_avx512;
+    }
+    if (f.avx2_ && f.fma_) {
+      return l2_sqr_sq8_batch4_avx2;
+    }
+#endif
+    return l2_sqr_sq8_batch4_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_dot_sq8_batch4_func() -> DotSq8BatchFunc {
+  static const DotSq8BatchFunc kFunc = []() -> DotSq8BatchFunc {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_) {
+      return dot_sq8_batch4_avx512;
+    }
+    if (f.avx2_ && f.fma_) {
+      return dot_sq8_batch4_avx2;
+    }
+#endif
+    return dot_sq8_batch4_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_l2_sqr_sq4_batch4_func() -> L2SqrSq4BatchFunc {
+  static const L2SqrSq4BatchFunc kFunc = []() -> L2SqrSq4BatchFunc {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_) {
+      return l2_sqr_sq4_batch4_avx512;
+    }
+    if (f.avx2_ && f.fma_) {
+      return l2_sqr_sq4_batch4_avx2;
+    }
+#endif
+    return l2_sqr_sq4_batch4_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_dot_sq4_batch4_func() -> DotSq4BatchFunc {
+  static const DotSq4BatchFunc kFunc = []() -> DotSq4BatchFunc {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_) {
+      return dot_sq4_batch4_avx512;
+    }
+    if (f.avx2_ && f.fma_) {
+      return dot_sq4_batch4_avx2;
+    }
+#endif
+    return dot_sq4_batch4_generic;
+  }();
+  return kFunc;
+}
+
+}  // namespace alaya::simd
+// NOLINTEND(portability-simd-intrinsics)
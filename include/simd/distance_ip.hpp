@@ -5,8 +5,10 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include "cpu_features.hpp"
+#include "half_convert.hpp"
 
 namespace alaya::simd {
 
@@ -30,6 +32,18 @@ using IpSqrSq4Func = float (*)(const uint8_t *__restrict,
                                size_t,
                                const float *,
                                const float *);
+using IpSqrFp16Func = float (*)(const fp16 *__restrict, const fp16 *__restrict, size_t);
+using IpSqrBf16Func = float (*)(const bf16 *__restrict, const bf16 *__restrict, size_t);
+
+/// Function pointer types for 8-bit integer IP distance (exact, returns -sum(x * y))
+using IpSqrInt8Func = int32_t (*)(const int8_t *__restrict, const int8_t *__restrict, size_t);
+using IpSqrUint8Func = int32_t (*)(const uint8_t *__restrict, const uint8_t *__restrict, size_t);
+
+/// Function pointer type for the dot product of an SQ8 code with an int8-quantized query
+using DotSq8Int8Func = int32_t (*)(const uint8_t *__restrict, const int8_t *__restrict, size_t);
+
+/// Function pointer type for the dot product of a byte-per-dimension code with an FP32 weight
+using DotSq8F32Func = float (*)(const uint8_t *__restrict, const float *__restrict, size_t);
 
 // ============================================================================
 // Full Precision IP Distance Declarations
@@ -65,6 +79,18 @@ auto ip_sqr_sq8_avx512(const uint8_t *__restrict x,
                        const float *max) -> float;
 #endif
 
+auto dot_sq8_f32_generic(const uint8_t *__restrict code,
+                         const float *__restrict weight,
+                         size_t dim) -> float;
+
+#ifdef ALAYA_ARCH_X86
+auto dot_sq8_f32_avx2(const uint8_t *__restrict code, const float *__restrict weight, size_t dim)
+    -> float;
+auto dot_sq8_f32_avx512(const uint8_t *__restrict code,
+                        const float *__restrict weight,
+                        size_t dim) -> float;
+#endif
+
 // ============================================================================
 // SQ4 IP Distance Declarations
 // ============================================================================
@@ -88,6 +114,54 @@ auto ip_sqr_sq4_avx512(const uint8_t *__restrict x,
                        const float *max) -> float;
 #endif
 
+// ============================================================================
+// FP16 / BF16 IP Distance Declarations
+// ============================================================================
+
+auto ip_sqr_fp16_generic(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim) -> float;
+auto ip_sqr_bf16_generic(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim) -> float;
+
+#ifdef ALAYA_ARCH_X86
+auto ip_sqr_fp16_avx2(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim) -> float;
+auto ip_sqr_fp16_avx512(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim) -> float;
+auto ip_sqr_bf16_avx2(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim) -> float;
+auto ip_sqr_bf16_avx512(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim) -> float;
+#endif
+
+// ============================================================================
+// INT8 / UINT8 IP Distance Declarations
+// ============================================================================
+
+auto ip_sqr_int8_generic(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto ip_sqr_uint8_generic(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto dot_sq8_int8_generic(const uint8_t *__restrict code,
+                          const int8_t *__restrict weight,
+                          size_t dim) -> int32_t;
+
+#ifdef ALAYA_ARCH_X86
+auto ip_sqr_int8_avx2(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto ip_sqr_int8_avx_vnni(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto ip_sqr_int8_avx512_vnni(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto ip_sqr_uint8_avx2(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto ip_sqr_uint8_avx_vnni(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto ip_sqr_uint8_avx512_vnni(const uint8_t *__restrict x,
+                              const uint8_t *__restrict y,
+                              size_t dim) -> int32_t;
+auto dot_sq8_int8_avx_vnni(const uint8_t *__restrict code,
+                           const int8_t *__restrict weight,
+                           size_t dim) -> int32_t;
+auto dot_sq8_int8_avx512_vnni(const uint8_t *__restrict code,
+                              const int8_t *__restrict weight,
+                              size_t dim) -> int32_t;
+#endif
+
 // ============================================================================
 // Runtime Dispatch Functions
 // ============================================================================
@@ -95,6 +169,12 @@ auto ip_sqr_sq4_avx512(const uint8_t *__restrict x,
 auto get_ip_sqr_func() -> IpSqrFunc;
 auto get_ip_sqr_sq8_func() -> IpSqrSq8Func;
 auto get_ip_sqr_sq4_func() -> IpSqrSq4Func;
+auto get_ip_sqr_fp16_func() -> IpSqrFp16Func;
+auto get_ip_sqr_bf16_func() -> IpSqrBf16Func;
+auto get_ip_sqr_int8_func() -> IpSqrInt8Func;
+auto get_ip_sqr_uint8_func() -> IpSqrUint8Func;
+auto get_dot_sq8_int8_func() -> DotSq8Int8Func;
+auto get_dot_sq8_f32_func() -> DotSq8F32Func;
 
 // ============================================================================
 // Public API Templates
@@ -5,8 +5,11 @@
 // This file is included by distance_ip.hpp - do not include directly
 // NOLINTBEGIN(portability-simd-intrinsics)
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include "cpu_features.hpp"
+#include "half_convert.hpp"
+#include "int8_widen.hpp"
 
 namespace alaya::simd {
 
@@ -22,6 +25,11 @@ using IpSqrSq4Func = float (*)(const uint8_t *__restrict,
                                size_t,
                                const float *,
                                const float *);
+using IpSqrFp16Func = float (*)(const fp16 *__restrict, const fp16 *__restrict, size_t);
+using IpSqrBf16Func = float (*)(const bf16 *__restrict, const bf16 *__restrict, size_t);
+using IpSqrInt8Func = int32_t (*)(const int8_t *__restrict, const int8_t *__restrict, size_t);
+using IpSqrUint8Func = int32_t (*)(const uint8_t *__restrict, const uint8_t *__restrict, size_t);
+using DotSq8Int8Func = int32_t (*)(const uint8_t *__restrict, const int8_t *__restrict, size_t);
 
 // ============================================================================
 // Full Precision IP Distance Implementations
@@ -355,6 +363,88 @@ inline auto ip_sqr_sq8_avx512(const uint8_t *__restrict x,
 
 #endif  // ALAYA_ARCH_X86
 
+// sum(code[i] * weight[i]) of a byte-per-dimension code (e.g. an extended RaBitQ code) against
+// an FP32 weight vector
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto dot_sq8_f32_generic(const uint8_t *__restrict code,
+                                const float *__restrict weight,
+                                size_t dim) -> float {
+  float sum = 0.0F;
+  for (size_t i = 0; i < dim; ++i) {
+    sum += weight[i] * static_cast<float>(code[i]);
+  }
+  return sum;
+}
+
+#ifdef ALAYA_ARCH_X86
+
+// AVX2: widen 8 codes to FP32 per step, two accumulators to hide the FMA latency
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto dot_sq8_f32_avx2(const uint8_t *__restrict code,
+                             const float *__restrict weight,
+                             size_t dim) -> float {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m128i c0 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(code + i));
+    __m128i c1 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(code + i + 8));
+    __m256 y0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(c0));
+    __m256 y1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(c1));
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight + i), y0, sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(weight + i + 8), y1, sum1);
+  }
+  for (; i + 8 <= dim; i += 8) {
+    __m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(code + i));
+    __m256 y = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(c));
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(weight + i), y, sum0);
+  }
+
+  sum0 = _mm256_add_ps(sum0, sum1);
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+  sum128 = _mm_add_ps(sum128, _mm_movehl_ps(sum128, sum128));
+  sum128 = _mm_add_ss(sum128, _mm_shuffle_ps(sum128, sum128, 0x55));
+  float result = _mm_cvtss_f32(sum128);
+
+  for (; i < dim; ++i) {
+    result += weight[i] * static_cast<float>(code[i]);
+  }
+  return result;
+}
+
+// AVX-512: widen 16 codes per step; the tail runs through masked loads
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto dot_sq8_f32_avx512(const uint8_t *__restrict code,
+                               const float *__restrict weight,
+                               size_t dim) -> float {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(code + i));
+    __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(code + i + 16));
+    __m512 y0 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(c0));
+    __m512 y1 = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(c1));
+    sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(weight + i), y0, sum0);
+    sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(weight + i + 16), y1, sum1);
+  }
+  for (; i < dim; i += 16) {
+    const __mmask16 mask = dim - i >= 16 ? __mmask16{0xFFFF}
+                                         : static_cast<__mmask16>((1U << (dim - i)) - 1);
+    __m128i c = _mm512_castsi512_si128(_mm512_maskz_loadu_epi8(mask, code + i));
+    __m512 y = _mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(c));
+    sum0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, weight + i), y, sum0);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+}
+
+#endif  // ALAYA_ARCH_X86
+
 // ============================================================================
 // SQ4 IP Distance Implementations
 // ============================================================================
@@ -668,6 +758,421 @@ inline auto ip_sqr_sq4_avx512(const uint8_t *__restrict x,
 
 #endif  // ALAYA_ARCH_X86
 
+// ============================================================================
+// FP16 / BF16 IP Distance Implementations
+// ============================================================================
+// Half-precision inputs are widened to float and accumulated in float, so results match the
+// FP32 kernels on the widened values up to summation order.
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto ip_sqr_fp16_generic(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim)
+    -> float {
+  float result = 0.0F;
+  for (size_t i = 0; i < dim; ++i) {
+    result += static_cast<float>(x[i]) * static_cast<float>(y[i]);
+  }
+  return -result;
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto ip_sqr_bf16_generic(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim)
+    -> float {
+  float result = 0.0F;
+  for (size_t i = 0; i < dim; ++i) {
+    result += static_cast<float>(x[i]) * static_cast<float>(y[i]);
+  }
+  return -result;
+}
+
+#ifdef ALAYA_ARCH_X86
+
+// AVX2 + F16C FP16 implementation
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2_F16C
+inline auto ip_sqr_fp16_avx2(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim)
+    -> float {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+
+  size_t i = 0;
+  // Process 16 halves per iteration (2 x 8)
+  for (; i + 16 <= dim; i += 16) {
+    __m256 vx0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)));
+    __m256 vy0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i)));
+    __m256 vx1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i + 8)));
+    __m256 vy1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i + 8)));
+    sum0 = _mm256_fmadd_ps(vx0, vy0, sum0);
+    sum1 = _mm256_fmadd_ps(vx1, vy1, sum1);
+  }
+
+  for (; i + 8 <= dim; i += 8) {
+    __m256 vx = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)));
+    __m256 vy = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i)));
+    sum0 = _mm256_fmadd_ps(vx, vy, sum0);
+  }
+
+  sum0 = _mm256_add_ps(sum0, sum1);
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+  __m128 shuf = _mm_movehdup_ps(sum128);
+  sum128 = _mm_add_ps(sum128, shuf);
+  shuf = _mm_movehl_ps(shuf, sum128);
+  sum128 = _mm_add_ss(sum128, shuf);
+  float result = _mm_cvtss_f32(sum128);
+
+  for (; i < dim; ++i) {
+    result += static_cast<float>(x[i]) * static_cast<float>(y[i]);
+  }
+  return -result;
+}
+
+// AVX2 BF16 implementation
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto ip_sqr_bf16_avx2(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim)
+    -> float {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m256 vx0 = bf16_widen_avx2(x + i);
+    __m256 vy0 = bf16_widen_avx2(y + i);
+    __m256 vx1 = bf16_widen_avx2(x + i + 8);
+    __m256 vy1 = bf16_widen_avx2(y + i + 8);
+    sum0 = _mm256_fmadd_ps(vx0, vy0, sum0);
+    sum1 = _mm256_fmadd_ps(vx1, vy1, sum1);
+  }
+
+  for (; i + 8 <= dim; i += 8) {
+    __m256 vx = bf16_widen_avx2(x + i);
+    __m256 vy = bf16_widen_avx2(y + i);
+    sum0 = _mm256_fmadd_ps(vx, vy, sum0);
+  }
+
+  sum0 = _mm256_add_ps(sum0, sum1);
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+  __m128 shuf = _mm_movehdup_ps(sum128);
+  sum128 = _mm_add_ps(sum128, shuf);
+  shuf = _mm_movehl_ps(shuf, sum128);
+  sum128 = _mm_add_ss(sum128, shuf);
+  float result = _mm_cvtss_f32(sum128);
+
+  for (; i < dim; ++i) {
+    result += static_cast<float>(x[i]) * static_cast<float>(y[i]);
+  }
+  return -result;
+}
+
+// AVX-512 FP16 implementation (vcvtph2ps is AVX-512F)
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto ip_sqr_fp16_avx512(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim)
+    -> float {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+
+  size_t i = 0;
+  // Process 32 halves per iteration (2 x 16)
+  for (; i + 32 <= dim; i += 32) {
+    __m512 vx0 = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)));
+    __m512 vy0 = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i)));
+    __m512 vx1 =
+        _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i + 16)));
+    __m512 vy1 =
+        _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i + 16)));
+    sum0 = _mm512_fmadd_ps(vx0, vy0, sum0);
+    sum1 = _mm512_fmadd_ps(vx1, vy1, sum1);
+  }
+
+  for (; i + 16 <= dim; i += 16) {
+    __m512 vx = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)));
+    __m512 vy = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i)));
+    sum0 = _mm512_fmadd_ps(vx, vy, sum0);
+  }
+
+  float result = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+  for (; i < dim; ++i) {
+    result += static_cast<float>(x[i]) * static_cast<float>(y[i]);
+  }
+  return -result;
+}
+
+// AVX-512 BF16 implementation: vdpbf16ps multiplies bf16 pairs and accumulates in float
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512_BF16
+inline auto ip_sqr_bf16_avx512(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim)
+    -> float {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+
+  size_t i = 0;
+  // Process 64 bf16 per iteration (2 x 32)
+  for (; i + 64 <= dim; i += 64) {
+    __m512i vx0 = _mm512_loadu_si512(x + i);
+    __m512i vy0 = _mm512_loadu_si512(y + i);
+    __m512i vx1 = _mm512_loadu_si512(x + i + 32);
+    __m512i vy1 = _mm512_loadu_si512(y + i + 32);
+    sum0 = _mm512_dpbf16_ps(sum0, (__m512bh)vx0, (__m512bh)vy0);
+    sum1 = _mm512_dpbf16_ps(sum1, (__m512bh)vx1, (__m512bh)vy1);
+  }
+
+  for (; i + 32 <= dim; i += 32) {
+    __m512i vx = _mm512_loadu_si512(x + i);
+    __m512i vy = _mm512_loadu_si512(y + i);
+    sum0 = _mm512_dpbf16_ps(sum0, (__m512bh)vx, (__m512bh)vy);
+  }
+
+  // Masked load of the remaining whole pairs; an odd last element goes to the scalar tail
+  size_t pairs_len = (dim - i) & ~static_cast<size_t>(1);
+  if (pairs_len > 0) {
+    auto mask = static_cast<__mmask32>((1U << pairs_len) - 1);
+    __m512i vx = _mm512_maskz_loadu_epi16(mask, x + i);
+    __m512i vy = _mm512_maskz_loadu_epi16(mask, y + i);
+    sum0 = _mm512_dpbf16_ps(sum0, (__m512bh)vx, (__m512bh)vy);
+    i += pairs_len;
+  }
+
+  float result = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+  for (; i < dim; ++i) {
+    result += static_cast<float>(x[i]) * static_cast<float>(y[i]);
+  }
+  return -result;
+}
+
+#endif  // ALAYA_ARCH_X86
+
+// ============================================================================
+// INT8 / UINT8 IP Distance Implementations
+// ============================================================================
+// 8-bit inputs are accumulated exactly in int32. vpdpbusd multiplies unsigned by signed bytes, so
+// the VNNI kernels flip the sign bit of one operand (v ^ 0x80 == v + 128 as the other
+// signedness) and subtract the resulting 128 * sum(other operand), counted with a second vpdpbusd.
+
+template <typename T>
+ALAYA_ALWAYS_INLINE auto dot_8bit_tail(const T *x, const T *y, size_t begin, size_t dim)
+    -> int32_t {
+  int32_t sum = 0;
+  for (size_t i = begin; i < dim; ++i) {
+    sum += static_cast<int32_t>(x[i]) * static_cast<int32_t>(y[i]);
+  }
+  return sum;
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto ip_sqr_int8_generic(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t {
+  return -dot_8bit_tail(x, y, 0, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto ip_sqr_uint8_generic(const uint8_t *__restrict x,
+                                 const uint8_t *__restrict y,
+                                 size_t dim) -> int32_t {
+  return -dot_8bit_tail(x, y, 0, dim);
+}
+
+// sum(code[i] * weight[i]) of an SQ8 row against an int8-quantized query
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto dot_sq8_int8_generic(const uint8_t *__restrict code,
+                                 const int8_t *__restrict weight,
+                                 size_t dim) -> int32_t {
+  int32_t sum = 0;
+  for (size_t i = 0; i < dim; ++i) {
+    sum += static_cast<int32_t>(code[i]) * static_cast<int32_t>(weight[i]);
+  }
+  return sum;
+}
+
+#ifdef ALAYA_ARCH_X86
+
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX2 auto dot_8bit_avx2(const T *x, const T *y, size_t dim)
+    -> int32_t {
+  __m256i sum0 = _mm256_setzero_si256();
+  __m256i sum1 = _mm256_setzero_si256();
+
+  size_t i = 0;
+  // Process 32 elements per iteration (2 x 16)
+  for (; i + 32 <= dim; i += 32) {
+    sum0 = _mm256_add_epi32(sum0,
+                            _mm256_madd_epi16(widen_8bit_avx2(x + i), widen_8bit_avx2(y + i)));
+    sum1 = _mm256_add_epi32(
+        sum1,
+        _mm256_madd_epi16(widen_8bit_avx2(x + i + 16), widen_8bit_avx2(y + i + 16)));
+  }
+  for (; i + 16 <= dim; i += 16) {
+    sum0 = _mm256_add_epi32(sum0,
+                            _mm256_madd_epi16(widen_8bit_avx2(x + i), widen_8bit_avx2(y + i)));
+  }
+  return hsum_epi32_avx2(_mm256_add_epi32(sum0, sum1)) + dot_8bit_tail(x, y, i, dim);
+}
+
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX_VNNI auto dot_8bit_avx_vnni(const T *x, const T *y, size_t dim)
+    -> int32_t {
+  const __m256i sign = _mm256_set1_epi8(static_cast<char>(0x80));
+  const __m256i ones = _mm256_set1_epi8(1);
+  __m256i dot = _mm256_setzero_si256();
+  __m256i sum = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m256i vx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+    __m256i vy = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i));
+    if constexpr (std::is_signed_v<T>) {
+      // (x + 128) * y, minus 128 * sum(y)
+      dot = _mm256_dpbusd_avx_epi32(dot, _mm256_xor_si256(vx, sign), vy);
+      sum = _mm256_dpbusd_avx_epi32(sum, ones, vy);
+    } else {
+      // x * (y - 128), plus 128 * sum(x)
+      dot = _mm256_dpbusd_avx_epi32(dot, vx, _mm256_xor_si256(vy, sign));
+      sum = _mm256_dpbusd_avx_epi32(sum, vx, ones);
+    }
+  }
+  const int32_t correction = 128 * hsum_epi32_avx2(sum);
+  const int32_t body = hsum_epi32_avx2(dot) + (std::is_signed_v<T> ? -correction : correction);
+  return body + dot_8bit_tail(x, y, i, dim);
+}
+
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX512_VNNI auto dot_8bit_avx512_vnni(const T *x,
+                                                                      const T *y,
+                                                                      size_t dim) -> int32_t {
+  const __m512i sign = _mm512_set1_epi8(static_cast<char>(0x80));
+  const __m512i ones = _mm512_set1_epi8(1);
+  __m512i dot = _mm512_setzero_si512();
+  __m512i sum = _mm512_setzero_si512();
+
+  // Masked-off lanes load as zero, which adds nothing to either accumulator
+  for (size_t i = 0; i < dim; i += 64) {
+    const __mmask64 mask = dim - i >= 64 ? ~__mmask64{0} : (__mmask64{1} << (dim - i)) - 1;
+    __m512i vx = _mm512_maskz_loadu_epi8(mask, x + i);
+    __m512i vy = _mm512_maskz_loadu_epi8(mask, y + i);
+    if constexpr (std::is_signed_v<T>) {
+      dot = _mm512_dpbusd_epi32(dot, _mm512_xor_si512(vx, sign), vy);
+      sum = _mm512_dpbusd_epi32(sum, ones, vy);
+    } else {
+      dot = _mm512_dpbusd_epi32(dot, vx, _mm512_xor_si512(vy, sign));
+      sum = _mm512_dpbusd_epi32(sum, vx, ones);
+    }
+  }
+  const int32_t correction = 128 * _mm512_reduce_add_epi32(sum);
+  return _mm512_reduce_add_epi32(dot) + (std::is_signed_v<T> ? -correction : correction);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto ip_sqr_int8_avx2(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t {
+  return -dot_8bit_avx2(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto ip_sqr_uint8_avx2(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t {
+  return -dot_8bit_avx2(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX_VNNI
+inline auto ip_sqr_int8_avx_vnni(const int8_t *__restrict x,
+                                 const int8_t *__restrict y,
+                                 size_t dim) -> int32_t {
+  return -dot_8bit_avx_vnni(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX_VNNI
+inline auto ip_sqr_uint8_avx_vnni(const uint8_t *__restrict x,
+                                  const uint8_t *__restrict y,
+                                  size_t dim) -> int32_t {
+  return -dot_8bit_avx_vnni(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512_VNNI
+inline auto ip_sqr_int8_avx512_vnni(const int8_t *__restrict x,
+                                    const int8_t *__restrict y,
+                                    size_t dim) -> int32_t {
+  return -dot_8bit_avx512_vnni(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512_VNNI
+inline auto ip_sqr_uint8_avx512_vnni(const uint8_t *__restrict x,
+                                     const uint8_t *__restrict y,
+                                     size_t dim) -> int32_t {
+  return -dot_8bit_avx512_vnni(x, y, dim);
+}
+
+// The SQ8 code is already unsigned and the quantized query signed, so no correction is needed
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX_VNNI
+inline auto dot_sq8_int8_avx_vnni(const uint8_t *__restrict code,
+                                  const int8_t *__restrict weight,
+                                  size_t dim) -> int32_t {
+  __m256i sum0 = _mm256_setzero_si256();
+  __m256i sum1 = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 64 <= dim; i += 64) {
+    sum0 = _mm256_dpbusd_avx_epi32(
+        sum0,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(code + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weight + i)));
+    sum1 = _mm256_dpbusd_avx_epi32(
+        sum1,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(code + i + 32)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weight + i + 32)));
+  }
+  for (; i + 32 <= dim; i += 32) {
+    sum0 = _mm256_dpbusd_avx_epi32(
+        sum0,
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(code + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weight + i)));
+  }
+  int32_t result = hsum_epi32_avx2(_mm256_add_epi32(sum0, sum1));
+  for (; i < dim; ++i) {
+    result += static_cast<int32_t>(code[i]) * static_cast<int32_t>(weight[i]);
+  }
+  return result;
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512_VNNI
+inline auto dot_sq8_int8_avx512_vnni(const uint8_t *__restrict code,
+                                     const int8_t *__restrict weight,
+                                     size_t dim) -> int32_t {
+  __m512i sum0 = _mm512_setzero_si512();
+  __m512i sum1 = _mm512_setzero_si512();
+
+  size_t i = 0;
+  // Process 128 elements per iteration (2 x 64)
+  for (; i + 128 <= dim; i += 128) {
+    sum0 = _mm512_dpbusd_epi32(sum0,
+                               _mm512_loadu_si512(code + i),
+                               _mm512_loadu_si512(weight + i));
+    sum1 = _mm512_dpbusd_epi32(sum1,
+                               _mm512_loadu_si512(code + i + 64),
+                               _mm512_loadu_si512(weight + i + 64));
+  }
+  for (; i < dim; i += 64) {
+    const __mmask64 mask = dim - i >= 64 ? ~__mmask64{0} : (__mmask64{1} << (dim - i)) - 1;
+    sum0 = _mm512_dpbusd_epi32(sum0,
+                               _mm512_maskz_loadu_epi8(mask, code + i),
+                               _mm512_maskz_loadu_epi8(mask, weight + i));
+  }
+  return _mm512_reduce_add_epi32(_mm512_add_epi32(sum0, sum1));
+}
+
+#endif  // ALAYA_ARCH_X86
+
 // ============================================================================
 // Runtime Dispatch
 // ============================================================================
@@ -722,6 +1227,112 @@ inline auto get_ip_sqr_sq4_func() -> IpSqrSq4Func {
   return kFunc;
 }
 
+// Half-precision kernels are bound by the widening step, where 512-bit registers pay off, so
+// unlike FP32 they prefer AVX-512 whenever it is present
+inline auto get_ip_sqr_fp16_func() -> IpSqrFp16Func {
+  static const IpSqrFp16Func kFunc = []() -> IpSqrFp16Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_) {
+      return ip_sqr_fp16_avx512;
+    }
+    if (f.avx2_ && f.fma_ && f.f16c_) {
+      return ip_sqr_fp16_avx2;
+    }
+#endif
+    return ip_sqr_fp16_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_ip_sqr_bf16_func() -> IpSqrBf16Func {
+  static const IpSqrBf16Func kFunc = []() -> IpSqrBf16Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    // vdpbf16ps multiplies and accumulates bf16 pairs without widening first
+    if (f.avx512bf16_ && f.avx512bw_) {
+      return ip_sqr_bf16_avx512;
+    }
+    if (f.avx2_ && f.fma_) {
+      return ip_sqr_bf16_avx2;
+    }
+#endif
+    return ip_sqr_bf16_generic;
+  }();
+  return kFunc;
+}
+
+// 8-bit kernels prefer 512-bit VNNI: the integer units do not share the FP32 throttling concern
+inline auto get_ip_sqr_int8_func() -> IpSqrInt8Func {
+  static const IpSqrInt8Func kFunc = []() -> IpSqrInt8Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512vnni_ && f.avx512bw_) {
+      return ip_sqr_int8_avx512_vnni;
+    }
+    if (f.avxvnni_) {
+      return ip_sqr_int8_avx_vnni;
+    }
+    if (f.avx2_) {
+      return ip_sqr_int8_avx2;
+    }
+#endif
+    return ip_sqr_int8_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_ip_sqr_uint8_func() -> IpSqrUint8Func {
+  static const IpSqrUint8Func kFunc = []() -> IpSqrUint8Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512vnni_ && f.avx512bw_) {
+      return ip_sqr_uint8_avx512_vnni;
+    }
+    if (f.avxvnni_) {
+      return ip_sqr_uint8_avx_vnni;
+    }
+    if (f.avx2_) {
+      return ip_sqr_uint8_avx2;
+    }
+#endif
+    return ip_sqr_uint8_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_dot_sq8_int8_func() -> DotSq8Int8Func {
+  static const DotSq8Int8Func kFunc = []() -> DotSq8Int8Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512vnni_ && f.avx512bw_) {
+      return dot_sq8_int8_avx512_vnni;
+    }
+    if (f.avxvnni_) {
+      return dot_sq8_int8_avx_vnni;
+    }
+#endif
+    return dot_sq8_int8_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_dot_sq8_f32_func() -> DotSq8F32Func {
+  static const DotSq8F32Func kFunc = []() -> DotSq8F32Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_ && f.avx512bw_) {
+      return dot_sq8_f32_avx512;
+    }
+    if (f.avx2_ && f.fma_) {
+      return dot_sq8_f32_avx2;
+    }
+#endif
+    return dot_sq8_f32_generic;
+  }();
+  return kFunc;
+}
+
 // ============================================================================
 // Public API
 // ============================================================================
@@ -731,6 +1342,14 @@ inline auto ip_sqr(const DataType *__restrict x, const DataType *__restrict y, s
     -> DistanceType {
   if constexpr (std::is_same_v<DataType, float>) {
     return static_cast<DistanceType>(get_ip_sqr_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, fp16>) {
+    return static_cast<DistanceType>(get_ip_sqr_fp16_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, bf16>) {
+    return static_cast<DistanceType>(get_ip_sqr_bf16_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, int8_t>) {
+    return static_cast<DistanceType>(get_ip_sqr_int8_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, uint8_t>) {
+    return static_cast<DistanceType>(get_ip_sqr_uint8_func()(x, y, dim));
   } else {
     DistanceType sum = 0;
     for (size_t i = 0; i < dim; ++i) {
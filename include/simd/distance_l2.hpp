@@ -5,8 +5,10 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include "cpu_features.hpp"
+#include "half_convert.hpp"
 
 namespace alaya::simd {
 
@@ -22,6 +24,18 @@ using L2SqrSq4Func = float (*)(const uint8_t *__restrict,
                                size_t,
                                const float *,
                                const float *);
+using L2SqrFp16Func = float (*)(const fp16 *__restrict, const fp16 *__restrict, size_t);
+using L2SqrBf16Func = float (*)(const bf16 *__restrict, const bf16 *__restrict, size_t);
+using L2SqrInt8Func = int32_t (*)(const int8_t *__restrict, const int8_t *__restrict, size_t);
+using L2SqrUint8Func = int32_t (*)(const uint8_t *__restrict, const uint8_t *__restrict, size_t);
+using L2SqrSq8WeightedFunc = int64_t (*)(const uint8_t *__restrict,
+                                         const uint8_t *__restrict,
+                                         const int16_t *__restrict,
+                                         size_t);
+
+/// Largest per-dimension weight accepted by the weighted SQ8 L2 kernels, so that
+/// (x - y) * weight still fits in int16 for any pair of 8-bit codes.
+constexpr int16_t kSq8L2WeightMax = 127;
 
 auto l2_sqr_generic(const float *__restrict x, const float *__restrict y, size_t dim) -> float;
 #ifdef ALAYA_ARCH_X86
@@ -67,10 +81,65 @@ auto l2_sqr_sq4_avx512(const uint8_t *__restrict x,
                        const float *max) -> float;
 #endif
 
+auto l2_sqr_fp16_generic(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim) -> float;
+auto l2_sqr_bf16_generic(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim) -> float;
+
+#ifdef ALAYA_ARCH_X86
+auto l2_sqr_fp16_avx2(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim) -> float;
+auto l2_sqr_fp16_avx512(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim) -> float;
+auto l2_sqr_bf16_avx2(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim) -> float;
+auto l2_sqr_bf16_avx512(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim) -> float;
+#endif
+
+// 8-bit integer vectors, exact in int32
+auto l2_sqr_int8_generic(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto l2_sqr_uint8_generic(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t;
+
+#ifdef ALAYA_ARCH_X86
+auto l2_sqr_int8_avx2(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto l2_sqr_int8_avx_vnni(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto l2_sqr_int8_avx512_vnni(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto l2_sqr_uint8_avx2(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto l2_sqr_uint8_avx_vnni(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t;
+auto l2_sqr_uint8_avx512_vnni(const uint8_t *__restrict x,
+                              const uint8_t *__restrict y,
+                              size_t dim) -> int32_t;
+#endif
+
+// SQ8 codes with integer per-dimension weights: sum(weight[i] * (x[i] - y[i])^2).
+// Weights must lie in [0, kSq8L2WeightMax].
+auto l2_sqr_sq8_weighted_generic(const uint8_t *__restrict x,
+                                 const uint8_t *__restrict y,
+                                 const int16_t *__restrict weight,
+                                 size_t dim) -> int64_t;
+
+#ifdef ALAYA_ARCH_X86
+auto l2_sqr_sq8_weighted_avx_vnni(const uint8_t *__restrict x,
+                                  const uint8_t *__restrict y,
+                                  const int16_t *__restrict weight,
+                                  size_t dim) -> int64_t;
+auto l2_sqr_sq8_weighted_avx512_vnni(const uint8_t *__restrict x,
+                                     const uint8_t *__restrict y,
+                                     const int16_t *__restrict weight,
+                                     size_t dim) -> int64_t;
+#endif
+
 // Dispatch
 auto get_l2_sqr_func() -> L2SqrFunc;
 auto get_l2_sqr_sq8_func() -> L2SqrSq8Func;
 auto get_l2_sqr_sq4_func() -> L2SqrSq4Func;
+auto get_l2_sqr_fp16_func() -> L2SqrFp16Func;
+auto get_l2_sqr_bf16_func() -> L2SqrBf16Func;
+auto get_l2_sqr_int8_func() -> L2SqrInt8Func;
+auto get_l2_sqr_uint8_func() -> L2SqrUint8Func;
+auto get_l2_sqr_sq8_weighted_func() -> L2SqrSq8WeightedFunc;
 
 // Public API
 /**
@@ -78,7 +147,7 @@ auto get_l2_sqr_sq4_func() -> L2SqrSq4Func;
  *
  * Returns sum((x[i] - y[i])^2).
  *
- * @tparam DataType Type of input vectors (float).
+ * @tparam DataType Type of input vectors (float, fp16, bf16, int8_t or uint8_t use SIMD kernels).
  * @tparam DistanceType Type of the returned distance (float).
  * @param x Pointer to first input vector.
  * @param y Pointer to second input vector.
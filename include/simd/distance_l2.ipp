@@ -4,9 +4,13 @@
 
 // This file is included by distance_l2.hpp - do not include directly
 // NOLINTBEGIN(portability-simd-intrinsics)
+#include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include "cpu_features.hpp"
+#include "half_convert.hpp"
+#include "int8_widen.hpp"
 
 namespace alaya::simd {
 
@@ -22,6 +26,14 @@ using L2SqrSq4Func = float (*)(const uint8_t *__restrict,
                                size_t,
                                const float *,
                                const float *);
+using L2SqrFp16Func = float (*)(const fp16 *__restrict, const fp16 *__restrict, size_t);
+using L2SqrBf16Func = float (*)(const bf16 *__restrict, const bf16 *__restrict, size_t);
+using L2SqrInt8Func = int32_t (*)(const int8_t *__restrict, const int8_t *__restrict, size_t);
+using L2SqrUint8Func = int32_t (*)(const uint8_t *__restrict, const uint8_t *__restrict, size_t);
+using L2SqrSq8WeightedFunc = int64_t (*)(const uint8_t *__restrict,
+                                         const uint8_t *__restrict,
+                                         const int16_t *__restrict,
+                                         size_t);
 
 // Generic Implementation (ALAYA_TARGET_SSE2 forces baseline ISA for portability)
 ALAYA_NOINLINE
@@ -694,6 +706,418 @@ inline auto l2_sqr_sq4_avx512(const uint8_t *__restrict x,
 
 #endif  // ALAYA_ARCH_X86
 
+// ============================================================================
+// FP16 / BF16 L2 Distance Implementations
+// ============================================================================
+// Half-precision inputs are widened to float and accumulated in float, so results match the
+// FP32 kernels on the widened values up to summation order.
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto l2_sqr_fp16_generic(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim)
+    -> float {
+  float result = 0.0F;
+  for (size_t i = 0; i < dim; ++i) {
+    float diff = static_cast<float>(x[i]) - static_cast<float>(y[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto l2_sqr_bf16_generic(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim)
+    -> float {
+  float result = 0.0F;
+  for (size_t i = 0; i < dim; ++i) {
+    float diff = static_cast<float>(x[i]) - static_cast<float>(y[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+#ifdef ALAYA_ARCH_X86
+
+// AVX2 + F16C FP16 implementation
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2_F16C
+inline auto l2_sqr_fp16_avx2(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim)
+    -> float {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+
+  size_t i = 0;
+  // Process 16 halves per iteration (2 x 8)
+  for (; i + 16 <= dim; i += 16) {
+    __m256 vx0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)));
+    __m256 vy0 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i)));
+    __m256 vx1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i + 8)));
+    __m256 vy1 = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i + 8)));
+    __m256 d0 = _mm256_sub_ps(vx0, vy0);
+    sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+    __m256 d1 = _mm256_sub_ps(vx1, vy1);
+    sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+  }
+
+  for (; i + 8 <= dim; i += 8) {
+    __m256 vx = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(x + i)));
+    __m256 vy = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y + i)));
+    __m256 d0 = _mm256_sub_ps(vx, vy);
+    sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+  }
+
+  sum0 = _mm256_add_ps(sum0, sum1);
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+  __m128 shuf = _mm_movehdup_ps(sum128);
+  sum128 = _mm_add_ps(sum128, shuf);
+  shuf = _mm_movehl_ps(shuf, sum128);
+  sum128 = _mm_add_ss(sum128, shuf);
+  float result = _mm_cvtss_f32(sum128);
+
+  for (; i < dim; ++i) {
+    float diff = static_cast<float>(x[i]) - static_cast<float>(y[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+// AVX2 BF16 implementation
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto l2_sqr_bf16_avx2(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim)
+    -> float {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 16 <= dim; i += 16) {
+    __m256 vx0 = bf16_widen_avx2(x + i);
+    __m256 vy0 = bf16_widen_avx2(y + i);
+    __m256 vx1 = bf16_widen_avx2(x + i + 8);
+    __m256 vy1 = bf16_widen_avx2(y + i + 8);
+    __m256 d0 = _mm256_sub_ps(vx0, vy0);
+    sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+    __m256 d1 = _mm256_sub_ps(vx1, vy1);
+    sum1 = _mm256_fmadd_ps(d1, d1, sum1);
+  }
+
+  for (; i + 8 <= dim; i += 8) {
+    __m256 vx = bf16_widen_avx2(x + i);
+    __m256 vy = bf16_widen_avx2(y + i);
+    __m256 d0 = _mm256_sub_ps(vx, vy);
+    sum0 = _mm256_fmadd_ps(d0, d0, sum0);
+  }
+
+  sum0 = _mm256_add_ps(sum0, sum1);
+  __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum0), _mm256_extractf128_ps(sum0, 1));
+  __m128 shuf = _mm_movehdup_ps(sum128);
+  sum128 = _mm_add_ps(sum128, shuf);
+  shuf = _mm_movehl_ps(shuf, sum128);
+  sum128 = _mm_add_ss(sum128, shuf);
+  float result = _mm_cvtss_f32(sum128);
+
+  for (; i < dim; ++i) {
+    float diff = static_cast<float>(x[i]) - static_cast<float>(y[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+// AVX-512 FP16 implementation (vcvtph2ps is AVX-512F)
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto l2_sqr_fp16_avx512(const fp16 *__restrict x, const fp16 *__restrict y, size_t dim)
+    -> float {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+
+  size_t i = 0;
+  // Process 32 halves per iteration (2 x 16)
+  for (; i + 32 <= dim; i += 32) {
+    __m512 vx0 = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)));
+    __m512 vy0 = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i)));
+    __m512 vx1 =
+        _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i + 16)));
+    __m512 vy1 =
+        _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i + 16)));
+    __m512 d0 = _mm512_sub_ps(vx0, vy0);
+    sum0 = _mm512_fmadd_ps(d0, d0, sum0);
+    __m512 d1 = _mm512_sub_ps(vx1, vy1);
+    sum1 = _mm512_fmadd_ps(d1, d1, sum1);
+  }
+
+  for (; i + 16 <= dim; i += 16) {
+    __m512 vx = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i)));
+    __m512 vy = _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i)));
+    __m512 d0 = _mm512_sub_ps(vx, vy);
+    sum0 = _mm512_fmadd_ps(d0, d0, sum0);
+  }
+
+  float result = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+  for (; i < dim; ++i) {
+    float diff = static_cast<float>(x[i]) - static_cast<float>(y[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+// AVX-512 BF16 implementation. The differences must be formed in float, so this widens with a
+// shift instead of using vdpbf16ps.
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512
+inline auto l2_sqr_bf16_avx512(const bf16 *__restrict x, const bf16 *__restrict y, size_t dim)
+    -> float {
+  __m512 sum0 = _mm512_setzero_ps();
+  __m512 sum1 = _mm512_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m512 vx0 = bf16_widen_avx512(x + i);
+    __m512 vy0 = bf16_widen_avx512(y + i);
+    __m512 vx1 = bf16_widen_avx512(x + i + 16);
+    __m512 vy1 = bf16_widen_avx512(y + i + 16);
+    __m512 d0 = _mm512_sub_ps(vx0, vy0);
+    sum0 = _mm512_fmadd_ps(d0, d0, sum0);
+    __m512 d1 = _mm512_sub_ps(vx1, vy1);
+    sum1 = _mm512_fmadd_ps(d1, d1, sum1);
+  }
+
+  for (; i + 16 <= dim; i += 16) {
+    __m512 vx = bf16_widen_avx512(x + i);
+    __m512 vy = bf16_widen_avx512(y + i);
+    __m512 d0 = _mm512_sub_ps(vx, vy);
+    sum0 = _mm512_fmadd_ps(d0, d0, sum0);
+  }
+
+  float result = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+  for (; i < dim; ++i) {
+    float diff = static_cast<float>(x[i]) - static_cast<float>(y[i]);
+    result += diff * diff;
+  }
+  return result;
+}
+
+#endif  // ALAYA_ARCH_X86
+
+// ============================================================================
+// INT8 / UINT8 L2 Distance Implementations
+// ============================================================================
+// 8-bit inputs are accumulated exactly in int32: differences are widened to int16 and squared
+// with vpmaddwd (AVX2) or vpdpwssd (VNNI, which fuses the multiply and the accumulate).
+
+template <typename T>
+ALAYA_ALWAYS_INLINE auto l2_sqr_8bit_tail(const T *x, const T *y, size_t begin, size_t dim)
+    -> int32_t {
+  int32_t sum = 0;
+  for (size_t i = begin; i < dim; ++i) {
+    int32_t diff = static_cast<int32_t>(x[i]) - static_cast<int32_t>(y[i]);
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto l2_sqr_int8_generic(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t {
+  return l2_sqr_8bit_tail(x, y, 0, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto l2_sqr_uint8_generic(const uint8_t *__restrict x,
+                                 const uint8_t *__restrict y,
+                                 size_t dim) -> int32_t {
+  return l2_sqr_8bit_tail(x, y, 0, dim);
+}
+
+// sum(weight[i] * (x[i] - y[i])^2), accumulated in int64
+ALAYA_NOINLINE
+ALAYA_TARGET_SSE2
+inline auto l2_sqr_sq8_weighted_generic(const uint8_t *__restrict x,
+                                        const uint8_t *__restrict y,
+                                        const int16_t *__restrict weight,
+                                        size_t dim) -> int64_t {
+  int64_t sum = 0;
+  for (size_t i = 0; i < dim; ++i) {
+    int32_t diff = static_cast<int32_t>(x[i]) - static_cast<int32_t>(y[i]);
+    sum += static_cast<int64_t>(weight[i]) * diff * diff;
+  }
+  return sum;
+}
+
+#ifdef ALAYA_ARCH_X86
+
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX2 auto l2_sqr_8bit_avx2(const T *x, const T *y, size_t dim)
+    -> int32_t {
+  __m256i sum0 = _mm256_setzero_si256();
+  __m256i sum1 = _mm256_setzero_si256();
+
+  size_t i = 0;
+  // Process 32 elements per iteration (2 x 16)
+  for (; i + 32 <= dim; i += 32) {
+    __m256i diff0 = _mm256_sub_epi16(widen_8bit_avx2(x + i), widen_8bit_avx2(y + i));
+    __m256i diff1 = _mm256_sub_epi16(widen_8bit_avx2(x + i + 16), widen_8bit_avx2(y + i + 16));
+    sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(diff0, diff0));
+    sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(diff1, diff1));
+  }
+  for (; i + 16 <= dim; i += 16) {
+    __m256i diff = _mm256_sub_epi16(widen_8bit_avx2(x + i), widen_8bit_avx2(y + i));
+    sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(diff, diff));
+  }
+  return hsum_epi32_avx2(_mm256_add_epi32(sum0, sum1)) + l2_sqr_8bit_tail(x, y, i, dim);
+}
+
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX_VNNI auto l2_sqr_8bit_avx_vnni(const T *x,
+                                                                    const T *y,
+                                                                    size_t dim) -> int32_t {
+  __m256i sum0 = _mm256_setzero_si256();
+  __m256i sum1 = _mm256_setzero_si256();
+
+  size_t i = 0;
+  for (; i + 32 <= dim; i += 32) {
+    __m256i diff0 = _mm256_sub_epi16(widen_8bit_avx2(x + i), widen_8bit_avx2(y + i));
+    __m256i diff1 = _mm256_sub_epi16(widen_8bit_avx2(x + i + 16), widen_8bit_avx2(y + i + 16));
+    sum0 = _mm256_dpwssd_avx_epi32(sum0, diff0, diff0);
+    sum1 = _mm256_dpwssd_avx_epi32(sum1, diff1, diff1);
+  }
+  for (; i + 16 <= dim; i += 16) {
+    __m256i diff = _mm256_sub_epi16(widen_8bit_avx2(x + i), widen_8bit_avx2(y + i));
+    sum0 = _mm256_dpwssd_avx_epi32(sum0, diff, diff);
+  }
+  return hsum_epi32_avx2(_mm256_add_epi32(sum0, sum1)) + l2_sqr_8bit_tail(x, y, i, dim);
+}
+
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX512_VNNI auto l2_sqr_8bit_avx512_vnni(const T *x,
+                                                                         const T *y,
+                                                                         size_t dim) -> int32_t {
+  __m512i sum0 = _mm512_setzero_si512();
+  __m512i sum1 = _mm512_setzero_si512();
+
+  size_t i = 0;
+  // Process 64 elements per iteration (2 x 32)
+  for (; i + 64 <= dim; i += 64) {
+    __m512i diff0 = _mm512_sub_epi16(widen_8bit_avx512(x + i), widen_8bit_avx512(y + i));
+    __m512i diff1 =
+        _mm512_sub_epi16(widen_8bit_avx512(x + i + 32), widen_8bit_avx512(y + i + 32));
+    sum0 = _mm512_dpwssd_epi32(sum0, diff0, diff0);
+    sum1 = _mm512_dpwssd_epi32(sum1, diff1, diff1);
+  }
+  for (; i + 32 <= dim; i += 32) {
+    __m512i diff = _mm512_sub_epi16(widen_8bit_avx512(x + i), widen_8bit_avx512(y + i));
+    sum0 = _mm512_dpwssd_epi32(sum0, diff, diff);
+  }
+  return _mm512_reduce_add_epi32(_mm512_add_epi32(sum0, sum1)) + l2_sqr_8bit_tail(x, y, i, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto l2_sqr_int8_avx2(const int8_t *__restrict x, const int8_t *__restrict y, size_t dim)
+    -> int32_t {
+  return l2_sqr_8bit_avx2(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX2
+inline auto l2_sqr_uint8_avx2(const uint8_t *__restrict x, const uint8_t *__restrict y, size_t dim)
+    -> int32_t {
+  return l2_sqr_8bit_avx2(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX_VNNI
+inline auto l2_sqr_int8_avx_vnni(const int8_t *__restrict x,
+                                 const int8_t *__restrict y,
+                                 size_t dim) -> int32_t {
+  return l2_sqr_8bit_avx_vnni(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX_VNNI
+inline auto l2_sqr_uint8_avx_vnni(const uint8_t *__restrict x,
+                                  const uint8_t *__restrict y,
+                                  size_t dim) -> int32_t {
+  return l2_sqr_8bit_avx_vnni(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512_VNNI
+inline auto l2_sqr_int8_avx512_vnni(const int8_t *__restrict x,
+                                    const int8_t *__restrict y,
+                                    size_t dim) -> int32_t {
+  return l2_sqr_8bit_avx512_vnni(x, y, dim);
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512_VNNI
+inline auto l2_sqr_uint8_avx512_vnni(const uint8_t *__restrict x,
+                                     const uint8_t *__restrict y,
+                                     size_t dim) -> int32_t {
+  return l2_sqr_8bit_avx512_vnni(x, y, dim);
+}
+
+// Weighted SQ8 L2: diff * (diff * weight) stays within int16 because weight <= kSq8L2WeightMax,
+// and the int32 lanes are drained into int64 every kSq8WeightedChunk dimensions so they cannot
+// overflow.
+constexpr size_t kSq8WeightedChunk = 1024;
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX_VNNI
+inline auto l2_sqr_sq8_weighted_avx_vnni(const uint8_t *__restrict x,
+                                         const uint8_t *__restrict y,
+                                         const int16_t *__restrict weight,
+                                         size_t dim) -> int64_t {
+  int64_t total = 0;
+  size_t i = 0;
+  const size_t body = dim - dim % 16;
+  while (i < body) {
+    const size_t end = std::min(body, i + kSq8WeightedChunk);
+    __m256i sum = _mm256_setzero_si256();
+    for (; i < end; i += 16) {
+      __m256i diff = _mm256_sub_epi16(widen_8bit_avx2(x + i), widen_8bit_avx2(y + i));
+      __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weight + i));
+      sum = _mm256_dpwssd_avx_epi32(sum, diff, _mm256_mullo_epi16(diff, w));
+    }
+    total += hsum_epi32_wide_avx2(sum);
+  }
+  for (; i < dim; ++i) {
+    int32_t diff = static_cast<int32_t>(x[i]) - static_cast<int32_t>(y[i]);
+    total += static_cast<int64_t>(weight[i]) * diff * diff;
+  }
+  return total;
+}
+
+ALAYA_NOINLINE
+ALAYA_TARGET_AVX512_VNNI
+inline auto l2_sqr_sq8_weighted_avx512_vnni(const uint8_t *__restrict x,
+                                            const uint8_t *__restrict y,
+                                            const int16_t *__restrict weight,
+                                            size_t dim) -> int64_t {
+  int64_t total = 0;
+  size_t i = 0;
+  const size_t body = dim - dim % 32;
+  while (i < body) {
+    const size_t end = std::min(body, i + kSq8WeightedChunk);
+    __m512i sum = _mm512_setzero_si512();
+    for (; i < end; i += 32) {
+      __m512i diff = _mm512_sub_epi16(widen_8bit_avx512(x + i), widen_8bit_avx512(y + i));
+      __m512i w = _mm512_loadu_si512(weight + i);
+      sum = _mm512_dpwssd_epi32(sum, diff, _mm512_mullo_epi16(diff, w));
+    }
+    total += hsum_epi32_wide_avx512(sum);
+  }
+  for (; i < dim; ++i) {
+    int32_t diff = static_cast<int32_t>(x[i]) - static_cast<int32_t>(y[i]);
+    total += static_cast<int64_t>(weight[i]) * diff * diff;
+  }
+  return total;
+}
+
+#endif  // ALAYA_ARCH_X86
+
 // ============================================================================
 // Runtime Dispatch
 // ============================================================================
@@ -764,6 +1188,95 @@ inline auto get_l2_sqr_sq4_func() -> L2SqrSq4Func {
   return kFunc;
 }
 
+// Half-precision kernels are bound by the widening step, where 512-bit registers pay off, so
+// unlike FP32 they prefer AVX-512 whenever it is present
+inline auto get_l2_sqr_fp16_func() -> L2SqrFp16Func {
+  static const L2SqrFp16Func kFunc = []() -> L2SqrFp16Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_) {
+      return l2_sqr_fp16_avx512;
+    }
+    if (f.avx2_ && f.fma_ && f.f16c_) {
+      return l2_sqr_fp16_avx2;
+    }
+#endif
+    return l2_sqr_fp16_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_l2_sqr_bf16_func() -> L2SqrBf16Func {
+  static const L2SqrBf16Func kFunc = []() -> L2SqrBf16Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512f_) {
+      return l2_sqr_bf16_avx512;
+    }
+    if (f.avx2_ && f.fma_) {
+      return l2_sqr_bf16_avx2;
+    }
+#endif
+    return l2_sqr_bf16_generic;
+  }();
+  return kFunc;
+}
+
+// 8-bit kernels prefer 512-bit VNNI: the integer units do not share the FP32 throttling concern
+inline auto get_l2_sqr_int8_func() -> L2SqrInt8Func {
+  static const L2SqrInt8Func kFunc = []() -> L2SqrInt8Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512vnni_ && f.avx512bw_) {
+      return l2_sqr_int8_avx512_vnni;
+    }
+    if (f.avxvnni_) {
+      return l2_sqr_int8_avx_vnni;
+    }
+    if (f.avx2_) {
+      return l2_sqr_int8_avx2;
+    }
+#endif
+    return l2_sqr_int8_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_l2_sqr_uint8_func() -> L2SqrUint8Func {
+  static const L2SqrUint8Func kFunc = []() -> L2SqrUint8Func {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512vnni_ && f.avx512bw_) {
+      return l2_sqr_uint8_avx512_vnni;
+    }
+    if (f.avxvnni_) {
+      return l2_sqr_uint8_avx_vnni;
+    }
+    if (f.avx2_) {
+      return l2_sqr_uint8_avx2;
+    }
+#endif
+    return l2_sqr_uint8_generic;
+  }();
+  return kFunc;
+}
+
+inline auto get_l2_sqr_sq8_weighted_func() -> L2SqrSq8WeightedFunc {
+  static const L2SqrSq8WeightedFunc kFunc = []() -> L2SqrSq8WeightedFunc {
+#ifdef ALAYA_ARCH_X86
+    const auto &f = get_cpu_features();
+    if (f.avx512vnni_ && f.avx512bw_) {
+      return l2_sqr_sq8_weighted_avx512_vnni;
+    }
+    if (f.avxvnni_) {
+      return l2_sqr_sq8_weighted_avx_vnni;
+    }
+#endif
+    return l2_sqr_sq8_weighted_generic;
+  }();
+  return kFunc;
+}
+
 // ============================================================================
 // Public API
 // ============================================================================
@@ -772,6 +1285,14 @@ inline auto l2_sqr(const DataType *__restrict x, const DataType *__restrict y, s
     -> DistanceType {
   if constexpr (std::is_same_v<DataType, float>) {
     return static_cast<DistanceType>(get_l2_sqr_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, fp16>) {
+    return static_cast<DistanceType>(get_l2_sqr_fp16_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, bf16>) {
+    return static_cast<DistanceType>(get_l2_sqr_bf16_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, int8_t>) {
+    return static_cast<DistanceType>(get_l2_sqr_int8_func()(x, y, dim));
+  } else if constexpr (std::is_same_v<DataType, uint8_t>) {
+    return static_cast<DistanceType>(get_l2_sqr_uint8_func()(x, y, dim));
   } else {
     DistanceType sum = 0;
     for (size_t i = 0; i < dim; ++i) {
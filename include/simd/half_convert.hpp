@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+// NOLINTBEGIN(portability-simd-intrinsics)
+#include "cpu_features.hpp"
+#include "utils/half.hpp"
+
+namespace alaya::simd {
+
+#ifdef ALAYA_ARCH_X86
+
+// Widen 8 bf16 values to float: zero-extend each lane to 32 bits and shift into the high half.
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX2
+auto bf16_widen_avx2(const bf16 *p) -> __m256 {
+  __m256i u32 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+  return _mm256_castsi256_ps(_mm256_slli_epi32(u32, 16));
+}
+
+// Widen 16 bf16 values to float.
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX512
+auto bf16_widen_avx512(const bf16 *p) -> __m512 {
+  __m512i u32 = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)));
+  return _mm512_castsi512_ps(_mm512_slli_epi32(u32, 16));
+}
+
+#endif  // ALAYA_ARCH_X86
+
+}  // namespace alaya::simd
+// NOLINTEND(portability-simd-intrinsics)
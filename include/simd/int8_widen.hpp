@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+// NOLINTBEGIN(portability-simd-intrinsics)
+#include <cstdint>
+#include <type_traits>
+#include "cpu_features.hpp"
+
+namespace alaya::simd {
+
+#ifdef ALAYA_ARCH_X86
+
+// Widen 16 8-bit values to int16, sign-extending int8_t and zero-extending uint8_t.
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX2 auto widen_8bit_avx2(const T *p) -> __m256i {
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+  if constexpr (std::is_signed_v<T>) {
+    return _mm256_cvtepi8_epi16(v);
+  } else {
+    return _mm256_cvtepu8_epi16(v);
+  }
+}
+
+// Widen 32 8-bit values to int16.
+template <typename T>
+ALAYA_ALWAYS_INLINE ALAYA_TARGET_AVX512_VNNI auto widen_8bit_avx512(const T *p) -> __m512i {
+  __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+  if constexpr (std::is_signed_v<T>) {
+    return _mm512_cvtepi8_epi16(v);
+  } else {
+    return _mm512_cvtepu8_epi16(v);
+  }
+}
+
+// Horizontal sum of 8 int32 lanes.
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX2
+auto hsum_epi32_avx2(__m256i v) -> int32_t {
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sum);
+}
+
+// Horizontal sum of 8 int32 lanes into int64, for lanes whose total may exceed int32.
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX2
+auto hsum_epi32_wide_avx2(__m256i v) -> int64_t {
+  __m256i sum = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)),
+                                 _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+  __m128i sum128 = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+  return _mm_cvtsi128_si64(sum128) + _mm_extract_epi64(sum128, 1);
+}
+
+// Horizontal sum of 16 int32 lanes into int64.
+ALAYA_ALWAYS_INLINE
+ALAYA_TARGET_AVX512_VNNI
+auto hsum_epi32_wide_avx512(__m512i v) -> int64_t {
+  return _mm512_reduce_add_epi64(
+      _mm512_add_epi64(_mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)),
+                       _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1))));
+}
+
+#endif  // ALAYA_ARCH_X86
+
+}  // namespace alaya::simd
+// NOLINTEND(portability-simd-intrinsics)
@@ -0,0 +1,501 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "cpu_features.hpp"
+#include "distance_batch.hpp"
+#include "distance_ip.hpp"
+#include "distance_l2.hpp"
+#include "utils/platform_fs.hpp"
+
+namespace alaya::simd {
+
+// ============================================================================
+// Runtime Kernel Autotuning
+// ============================================================================
+//
+// With ALAYA_SIMD_DISTANCE_POLICY=autotune, spaces bind their distance kernels through the
+// tune_*_func(dim) helpers below: every variant the CPU supports is timed once for the space's
+// dimension and the fastest one is kept. Results are cached per (kernel, dim) for the process
+// and, when ALAYA_KERNEL_PROFILE names a file, persisted there under the CPU signature so later
+// runs on the same CPU model skip the measurement, while a profile shared with or copied from
+// another model is measured again. Without the policy the helpers return the static
+// get_*_func() choice.
+
+inline constexpr const char *kKernelProfileEnv = "ALAYA_KERNEL_PROFILE";
+
+/// One tuning decision, kept for logging
+struct KernelChoice {
+  std::string kernel_;   ///< Kernel family, e.g. "l2_sqr" or "dot_sq8_batch4"
+  size_t dim_ = 0;       ///< Dimension the kernel was tuned for
+  std::string variant_;  ///< Bound variant, e.g. "avx2"
+  double ns_ = 0.0;      ///< Measured time per call, as saved in the profile
+  std::string cpu_;      ///< get_cpu_signature() of the host that measured it
+};
+
+template <typename Func>
+struct KernelCandidate {
+  const char *name_;
+  Func func_;
+};
+
+inline auto kernel_autotune_enabled() -> bool {
+  return get_distance_dispatch_policy() == DistanceDispatchPolicy::kAutotune;
+}
+
+class KernelTuner {
+ public:
+  /// Process-wide tuner, backed by the ALAYA_KERNEL_PROFILE file when the variable is set
+  static auto instance() -> KernelTuner & {
+    static KernelTuner tuner(std::getenv(kKernelProfileEnv));
+    return tuner;
+  }
+
+  /**
+   * @brief Create a tuner, reading earlier decisions from `profile_path` if it exists
+   * @param profile_path Profile file, or nullptr to keep decisions in memory only
+   * @param cpu Signature decisions are saved under; profile lines of other CPUs are not reused
+   */
+  explicit KernelTuner(const char *profile_path, std::string cpu = get_cpu_signature())
+      : cpu_(std::move(cpu)) {
+    if (profile_path == nullptr || profile_path[0] == '\0') {
+      return;
+    }
+    profile_path_ = profile_path;
+    for (auto &c : read_profile(profile_path_)) {
+      if (c.cpu_ == cpu_) {
+        choices_.push_back(std::move(c));
+      }
+    }
+  }
+
+  /**
+   * @brief Pick the fastest of `candidates` for `kernel` at `dim`
+   *
+   * A decision already made, or read from a profile line with this tuner's CPU signature, is
+   * reused as long as its variant is still among the candidates. Lines measured on another CPU
+   * model are ignored, so a copied profile is re-measured rather than trusted.
+   * @param bench Returns the time per call, in ns, of the function it is given
+   */
+  template <typename Func, typename Bench>
+  auto select(const char *kernel,
+              size_t dim,
+              const std::vector<KernelCandidate<Func>> &candidates,
+              Bench bench) -> Func {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = choices_.begin(); it != choices_.end(); ++it) {
+      if (it->kernel_ != kernel || it->dim_ != dim) {
+        continue;
+      }
+      for (const auto &c : candidates) {
+        if (it->variant_ == c.name_) {
+          return c.func_;
+        }
+      }
+      choices_.erase(it);
+      break;
+    }
+
+    // Two interleaved rounds, keeping each candidate's best, to damp frequency ramp-up
+    std::vector<double> best(candidates.size(), 0.0);
+    for (int round = 0; round < 2; ++round) {
+      for (size_t i = 0; i < candidates.size() && candidates.size() > 1; ++i) {
+        double ns = bench(candidates[i].func_);
+        best[i] = round == 0 ? ns : std::min(best[i], ns);
+      }
+    }
+    size_t pick = 0;
+    for (size_t i = 1; i < candidates.size(); ++i) {
+      if (best[i] < best[pick]) {
+        pick = i;
+      }
+    }
+
+    KernelChoice choice{kernel, dim, candidates[pick].name_, best[pick], cpu_};
+    if (!profile_path_.empty()) {
+      write_profile(choice);
+    }
+    choices_.push_back(std::move(choice));
+    return candidates[pick].func_;
+  }
+
+  /// Decisions made or loaded so far for this tuner's CPU
+  auto choices() const -> std::vector<KernelChoice> {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return choices_;
+  }
+
+ private:
+  /// Insert `choice`, replacing an earlier decision for the same CPU, kernel and dimension
+  static void upsert(std::vector<KernelChoice> &choices, KernelChoice choice) {
+    for (auto &c : choices) {
+      if (c.cpu_ == choice.cpu_ && c.kernel_ == choice.kernel_ && c.dim_ == choice.dim_) {
+        c = std::move(choice);
+        return;
+      }
+    }
+    choices.push_back(std::move(choice));
+  }
+
+  /**
+   * @brief Decisions in `path`, one "kernel dim variant ns cpu" line each
+   *
+   * When a CPU, kernel and dimension appear twice, the later line wins. Lines without a CPU
+   * signature cannot be matched to a host and are dropped.
+   */
+  static auto read_profile(const std::string &path) -> std::vector<KernelChoice> {
+    std::vector<KernelChoice> choices;
+    std::ifstream reader(path);
+    std::string line;
+    while (std::getline(reader, line)) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      std::istringstream fields(line);
+      KernelChoice choice;
+      if (fields >> choice.kernel_ >> choice.dim_ >> choice.variant_ >> choice.ns_ >>
+          choice.cpu_) {
+        upsert(choices, std::move(choice));
+      }
+    }
+    return choices;
+  }
+
+  /**
+   * @brief Rewrite the profile with `choice` replacing any earlier line for its CPU, kernel and
+   * dimension. The file is re-read first, so decisions another process saved since this tuner
+   * loaded it are kept, and replaced through a temporary file so readers never see a partial one.
+   * The profile is only a cache: a failed write leaves the old file and is otherwise ignored.
+   */
+  void write_profile(const KernelChoice &choice) const {
+    auto merged = read_profile(profile_path_);
+    upsert(merged, choice);
+    const std::filesystem::path target(profile_path_);
+    auto tmp = target;
+    tmp += ".tmp." + std::to_string(::alaya::platform::get_pid());
+    try {
+      {
+        std::ofstream writer(tmp, std::ios::trunc);
+        writer << "# kernel dim variant ns cpu\n";
+        for (const auto &c : merged) {
+          writer << c.kernel_ << ' ' << c.dim_ << ' ' << c.variant_ << ' ' << c.ns_ << ' '
+                 << c.cpu_ << '\n';
+        }
+        if (!writer.flush()) {
+          throw std::runtime_error("KernelTuner: failed to write " + tmp.string());
+        }
+      }
+      ::alaya::platform::atomic_replace(tmp, target);
+    } catch (const std::exception &) {
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::string cpu_;
+  std::string profile_path_;
+  std::vector<KernelChoice> choices_;
+};
+
+/// Kernel choices of the process-wide tuner, e.g. to log which variants a space is running
+inline auto kernel_choices() -> std::vector<KernelChoice> {
+  return KernelTuner::instance().choices();
+}
+
+namespace tuner_detail {
+
+constexpr size_t kTuneRows = 16;  ///< Rows cycled through, so a run is not one cached pair
+
+inline auto tune_iterations(size_t dim) -> size_t {
+  return std::max<size_t>(64, (size_t{1} << 18) / std::max<size_t>(dim, 1));
+}
+
+template <typename Call>
+auto time_per_call(size_t iterations, Call call) -> double {
+  for (size_t i = 0; i < iterations / 8; ++i) {
+    call(i);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    call(i);
+  }
+  auto end = std::chrono::steady_clock::now();
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return static_cast<double>(ns) / static_cast<double>(iterations);
+}
+
+template <typename T>
+auto random_rows(size_t count, T lo, T hi) -> std::vector<T> {
+  std::mt19937 rng(42);
+  std::vector<T> v(count);
+  if constexpr (std::is_floating_point_v<T>) {
+    std::uniform_real_distribution<T> dist(lo, hi);
+    for (auto &x : v) {
+      x = dist(rng);
+    }
+  } else {
+    std::uniform_int_distribution<int> dist(lo, hi);
+    for (auto &x : v) {
+      x = static_cast<T>(dist(rng));
+    }
+  }
+  return v;
+}
+
+/// The FP32 L2 dispatch honours the ALAYA_FORCE_* diagnostics; tuning must not override them
+inline auto fp32_l2_forced() -> bool {
+  for (const char *name : {"ALAYA_FORCE_SCALAR_L2", "ALAYA_FORCE_DISKANN_COMPAT_L2"}) {
+    const char *force = std::getenv(name);
+    if (force != nullptr && force[0] == '1' && force[1] == '\0') {
+      return true;
+    }
+  }
+  return false;
+}
+
+/// generic / avx2 / avx512 variants of a kernel, filtered by what the CPU runs
+template <typename Func>
+auto fp_candidates(Func generic, Func avx2, Func avx512) -> std::vector<KernelCandidate<Func>> {
+  std::vector<KernelCandidate<Func>> out = {{"generic", generic}};
+#ifdef ALAYA_ARCH_X86
+  const auto &f = get_cpu_features();
+  if (f.avx2_ && f.fma_) {
+    out.push_back({"avx2", avx2});
+  }
+  if (f.avx512f_) {
+    out.push_back({"avx512", avx512});
+  }
+#else
+  (void)avx2;
+  (void)avx512;
+#endif
+  return out;
+}
+
+#ifdef ALAYA_ARCH_X86
+  #define ALAYA_TUNE_CANDIDATES(name) \
+    tuner_detail::fp_candidates(name##_generic, name##_avx2, name##_avx512)
+#else
+  #define ALAYA_TUNE_CANDIDATES(name) \
+    tuner_detail::fp_candidates(name##_generic, name##_generic, name##_generic)
+#endif
+
+template <typename Func>
+auto bench_fp32(size_t dim) {
+  return [dim](Func func) -> double {
+    auto query = random_rows<float>(dim, -1.0F, 1.0F);
+    auto rows = random_rows<float>(kTuneRows * dim, -1.0F, 1.0F);
+    volatile float sink = 0;
+    double ns = time_per_call(tune_iterations(dim), [&](size_t i) {
+      sink = func(query.data(), rows.data() + (i % kTuneRows) * dim, dim);
+    });
+    (void)sink;
+    return ns;
+  };
+}
+
+template <typename Func>
+auto bench_fp32_batch4(size_t dim) {
+  return [dim](Func func) -> double {
+    auto query = random_rows<float>(dim, -1.0F, 1.0F);
+    auto pool = random_rows<float>(kTuneRows * dim, -1.0F, 1.0F);
+    float out[kDistanceBatchWidth];
+    const float *rows[kDistanceBatchWidth];
+    double ns = time_per_call(tune_iterations(dim) / kDistanceBatchWidth, [&](size_t i) {
+      for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+        rows[r] = pool.data() + ((i * kDistanceBatchWidth + r) % kTuneRows) * dim;
+      }
+      func(query.data(), rows, dim, out);
+    });
+    volatile float sink = out[0];
+    (void)sink;
+    return ns;
+  };
+}
+
+/// Single-row SQ8 and SQ4 kernels: `code_bytes` is the packed row size for `dim` dimensions
+template <typename Func>
+auto bench_sq(size_t dim, size_t code_bytes) {
+  return [dim, code_bytes](Func func) -> double {
+    auto lo = random_rows<float>(dim, -1.0F, 0.0F);
+    auto hi = random_rows<float>(dim, 0.0F, 1.0F);
+    auto pool = random_rows<uint8_t>((kTuneRows + 1) * code_bytes, 0, 255);
+    volatile float sink = 0;
+    double ns = time_per_call(tune_iterations(dim), [&](size_t i) {
+      sink = func(pool.data() + kTuneRows * code_bytes, pool.data() + (i % kTuneRows) * code_bytes,
+                  dim, lo.data(), hi.data());
+    });
+    (void)sink;
+    return ns;
+  };
+}
+
+/// SQ8 and SQ4 batch kernels: `code_bytes` is the packed row size for `dim` dimensions
+inline auto bench_sq_l2_batch4(size_t dim, size_t code_bytes) {
+  return [dim, code_bytes](L2SqrSq8BatchFunc func) -> double {
+    auto query = random_rows<float>(dim, 0.0F, 1.0F);
+    auto scale = random_rows<float>(dim, 0.0F, 0.01F);
+    auto pool = random_rows<uint8_t>(kTuneRows * code_bytes, 0, 255);
+    float out[kDistanceBatchWidth];
+    const uint8_t *rows[kDistanceBatchWidth];
+    double ns = time_per_call(tune_iterations(dim) / kDistanceBatchWidth, [&](size_t i) {
+      for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+        rows[r] = pool.data() + ((i * kDistanceBatchWidth + r) % kTuneRows) * code_bytes;
+      }
+      func(query.data(), scale.data(), rows, dim, out);
+    });
+    volatile float sink = out[0];
+    (void)sink;
+    return ns;
+  };
+}
+
+inline auto bench_sq_dot_batch4(size_t dim, size_t code_bytes) {
+  return [dim, code_bytes](DotSq8BatchFunc func) -> double {
+    auto weight = random_rows<float>(dim, -0.01F, 0.01F);
+    auto pool = random_rows<uint8_t>(kTuneRows * code_bytes, 0, 255);
+    float out[kDistanceBatchWidth];
+    const uint8_t *rows[kDistanceBatchWidth];
+    double ns = time_per_call(tune_iterations(dim) / kDistanceBatchWidth, [&](size_t i) {
+      for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+        rows[r] = pool.data() + ((i * kDistanceBatchWidth + r) % kTuneRows) * code_bytes;
+      }
+      func(weight.data(), rows, dim, out);
+    });
+    volatile float sink = out[0];
+    (void)sink;
+    return ns;
+  };
+}
+
+}  // namespace tuner_detail
+
+// ============================================================================
+// Tuned Dispatch
+// ============================================================================
+
+inline auto tune_l2_sqr_func(size_t dim) -> L2SqrFunc {
+  if (!kernel_autotune_enabled() || tuner_detail::fp32_l2_forced()) {
+    return get_l2_sqr_func();
+  }
+  return KernelTuner::instance().select("l2_sqr", dim, ALAYA_TUNE_CANDIDATES(l2_sqr),
+                                        tuner_detail::bench_fp32<L2SqrFunc>(dim));
+}
+
+inline auto tune_ip_sqr_func(size_t dim) -> IpSqrFunc {
+  if (!kernel_autotune_enabled()) {
+    return get_ip_sqr_func();
+  }
+  return KernelTuner::instance().select("ip_sqr", dim, ALAYA_TUNE_CANDIDATES(ip_sqr),
+                                        tuner_detail::bench_fp32<IpSqrFunc>(dim));
+}
+
+inline auto tune_l2_sqr_batch4_func(size_t dim) -> L2SqrBatchFunc {
+  if (!kernel_autotune_enabled() || tuner_detail::fp32_l2_forced()) {
+    return get_l2_sqr_batch4_func();
+  }
+  return KernelTuner::instance().select("l2_sqr_batch4", dim,
+                                        ALAYA_TUNE_CANDIDATES(l2_sqr_batch4),
+                                        tuner_detail::bench_fp32_batch4<L2SqrBatchFunc>(dim));
+}
+
+inline auto tune_ip_sqr_batch4_func(size_t dim) -> IpSqrBatchFunc {
+  if (!kernel_autotune_enabled()) {
+    return get_ip_sqr_batch4_func();
+  }
+  return KernelTuner::instance().select("ip_sqr_batch4", dim,
+                                        ALAYA_TUNE_CANDIDATES(ip_sqr_batch4),
+                                        tuner_detail::bench_fp32_batch4<IpSqrBatchFunc>(dim));
+}
+
+inline auto tune_l2_sqr_sq8_func(size_t dim) -> L2SqrSq8Func {
+  if (!kernel_autotune_enabled()) {
+    return get_l2_sqr_sq8_func();
+  }
+  return KernelTuner::instance().select("l2_sqr_sq8", dim, ALAYA_TUNE_CANDIDATES(l2_sqr_sq8),
+                                        tuner_detail::bench_sq<L2SqrSq8Func>(dim, dim));
+}
+
+inline auto tune_ip_sqr_sq8_func(size_t dim) -> IpSqrSq8Func {
+  if (!kernel_autotune_enabled()) {
+    return get_ip_sqr_sq8_func();
+  }
+  return KernelTuner::instance().select("ip_sqr_sq8", dim, ALAYA_TUNE_CANDIDATES(ip_sqr_sq8),
+                                        tuner_detail::bench_sq<IpSqrSq8Func>(dim, dim));
+}
+
+inline auto tune_l2_sqr_sq4_func(size_t dim) -> L2SqrSq4Func {
+  if (!kernel_autotune_enabled()) {
+    return get_l2_sqr_sq4_func();
+  }
+  return KernelTuner::instance().select("l2_sqr_sq4", dim, ALAYA_TUNE_CANDIDATES(l2_sqr_sq4),
+                                        tuner_detail::bench_sq<L2SqrSq4Func>(dim, (dim + 1) / 2));
+}
+
+inline auto tune_ip_sqr_sq4_func(size_t dim) -> IpSqrSq4Func {
+  if (!kernel_autotune_enabled()) {
+    return get_ip_sqr_sq4_func();
+  }
+  return KernelTuner::instance().select("ip_sqr_sq4", dim, ALAYA_TUNE_CANDIDATES(ip_sqr_sq4),
+                                        tuner_detail::bench_sq<IpSqrSq4Func>(dim, (dim + 1) / 2));
+}
+
+inline auto tune_l2_sqr_sq8_batch4_func(size_t dim) -> L2SqrSq8BatchFunc {
+  if (!kernel_autotune_enabled()) {
+    return get_l2_sqr_sq8_batch4_func();
+  }
+  return KernelTuner::instance().select("l2_sqr_sq8_batch4", dim,
+                                        ALAYA_TUNE_CANDIDATES(l2_sqr_sq8_batch4),
+                                        tuner_detail::bench_sq_l2_batch4(dim, dim));
+}
+
+inline auto tune_dot_sq8_batch4_func(size_t dim) -> DotSq8BatchFunc {
+  if (!kernel_autotune_enabled()) {
+    return get_dot_sq8_batch4_func();
+  }
+  return KernelTuner::instance().select("dot_sq8_batch4", dim,
+                                        ALAYA_TUNE_CANDIDATES(dot_sq8_batch4),
+                                        tuner_detail::bench_sq_dot_batch4(dim, dim));
+}
+
+inline auto tune_l2_sqr_sq4_batch4_func(size_t dim) -> L2SqrSq4BatchFunc {
+  if (!kernel_autotune_enabled()) {
+    return get_l2_sqr_sq4_batch4_func();
+  }
+  return KernelTuner::instance().select("l2_sqr_sq4_batch4", dim,
+                                        ALAYA_TUNE_CANDIDATES(l2_sqr_sq4_batch4),
+                                        tuner_detail::bench_sq_l2_batch4(dim, (dim + 1) / 2));
+}
+
+inline auto tune_dot_sq4_batch4_func(size_t dim) -> DotSq4BatchFunc {
+  if (!kernel_autotune_enabled()) {
+    return get_dot_sq4_batch4_func();
+  }
+  return KernelTuner::instance().select("dot_sq4_batch4", dim,
+                                        ALAYA_TUNE_CANDIDATES(dot_sq4_batch4),
+                                        tuner_detail::bench_sq_dot_batch4(dim, (dim + 1) / 2));
+}
+
+#undef ALAYA_TUNE_CANDIDATES
+
+}  // namespace alaya::simd
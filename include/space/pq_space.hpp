@@ -0,0 +1,678 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "index/graph/diskann/pq_table.hpp"
+#include "simd/distance_ip.hpp"
+#include "simd/distance_l2.hpp"
+#include "space/quant/pq.hpp"
+#include "space_concepts.hpp"
+#include "storage/rocksdb_storage.hpp"
+#include "storage/sequential_storage.hpp"
+#include "utils/log.hpp"
+#include "utils/math.hpp"
+#include "utils/metadata_filter.hpp"
+#include "utils/metric_type.hpp"
+#include "utils/platform.hpp"
+#include "utils/prefetch.hpp"
+
+namespace alaya {
+
+/**
+ * @brief The PQSpace class for managing distance calculations on product-quantized data.
+ *
+ * Each point is stored as `n_chunks` one-byte centroid indices (32x smaller than float32 with the
+ * default of 8 dimensions per chunk). Queries are scored by asymmetric distance computation: the
+ * query is turned into an `n_chunks x 256` lookup table once, after which a point costs
+ * `n_chunks` table lookups. PQ distances are approximate, so searches over this space should be
+ * reranked against a RawSpace (GraphSearchJob does that when the build space differs).
+ *
+ * @tparam DataType The data type for storing raw data points, float only.
+ * @tparam DistanceType The data type for storing distances, with the default being float.
+ * @tparam IDType The data type for storing IDs, with the default being uint32_t.
+ * @tparam DataStorage The storage backend for vector data, with the default being
+ * SequentialStorage.
+ * @tparam ScalarDataType The data type for ScalarData, with the default being EmptyScalarData.
+ */
+template <typename DataType = float,
+          typename DistanceType = float,
+          typename IDType = uint32_t,
+          typename DataStorage = SequentialStorage<uint8_t, IDType>,
+          typename ScalarDataType = EmptyScalarData>
+class PQSpace {
+ public:
+  static constexpr bool has_scalar_data =
+      !std::is_same_v<ScalarDataType, EmptyScalarData>;  // NOLINT
+
+  using DataTypeAlias = DataType;
+  using IDTypeAlias = IDType;
+  using DistanceTypeAlias = DistanceType;
+
+  using DistDataType = DataType;
+
+  static constexpr uint32_t kCentroids = diskann::kPQNumCentroids;
+  /// Code rows gathered per QueryComputer::compute() tile
+  static constexpr uint32_t kTileRows = 32;
+
+ public:
+  /**
+   * @brief Construct an empty PQSpace object without parameter for loading.
+   *
+   */
+  PQSpace() = default;
+
+  /**
+   * @brief Construct a new PQSpace object.
+   *
+   * @param capacity The maximum number of data points (nodes)
+   * @param dim Dimensionality of each data point
+   * @param metric Metric type
+   * @param config RocksDB configuration for scalardata storage
+   * @param n_chunks Number of PQ sub-spaces (bytes per code), must divide dim; 0 picks
+   * PQQuantizer::default_chunks(dim)
+   */
+  PQSpace(IDType capacity,
+          size_t dim,
+          MetricType metric,
+          RocksDBConfig config = RocksDBConfig::default_config(),
+          uint32_t n_chunks = 0)
+      : capacity_(capacity),
+        dim_(dim),
+        metric_(metric),
+        quantizer_(static_cast<uint32_t>(dim), n_chunks),
+        config_(std::move(config)) {
+    data_size_ = quantizer_.get_n_chunks() * sizeof(uint8_t);
+    data_storage_.init(data_size_, capacity);
+    set_metric_function();
+  }
+
+  ~PQSpace() = default;
+
+  PQSpace(PQSpace &&other) = delete;
+  PQSpace(const PQSpace &other) = delete;
+  auto operator=(const PQSpace &) -> PQSpace & = delete;
+  auto operator=(PQSpace &&) -> PQSpace & = delete;
+
+  /**
+   * @brief Set the full-precision distance function based on the metric type
+   */
+  void set_metric_function() {
+    switch (metric_) {
+      case MetricType::L2:
+        distance_calu_func_ = simd::get_l2_sqr_func();
+        break;
+      case MetricType::COS:
+      case MetricType::IP:
+        distance_calu_func_ = simd::get_ip_sqr_func();
+        break;
+      default:
+        break;
+    }
+  }
+
+  /**
+   * @brief Get the capacity of the space
+   * @return The capacity
+   */
+  auto get_capacity() -> IDType { return capacity_; }
+
+  /**
+   * @brief Fit the data into the space: train the codebooks, then encode every point
+   * @param data Pointer to the input data array
+   * @param item_cnt Number of data points
+   * @param scalar_data Pointer to ScalarData array (optional)
+   */
+  void fit(const DataType *data, IDType item_cnt, const ScalarDataType *scalar_data = nullptr) {
+    if (data == nullptr) {
+      throw std::invalid_argument("Invalid or null vector data pointer.");
+    }
+
+    if (item_cnt > capacity_) {
+      throw std::length_error("The number of data points exceeds the capacity of the space");
+    }
+    item_cnt_ = item_cnt;
+
+    quantizer_.fit(data, item_cnt);
+    for (IDType i = 0; i < item_cnt; i++) {
+      auto id = data_storage_.reserve();
+      quantizer_.encode(data + (static_cast<size_t>(i) * dim_), data_storage_[id]);
+    }
+
+    // Store ScalarData with synchronized IDs (0, 1, 2, ...)
+    if constexpr (has_scalar_data) {  // NOLINT
+      if (scalar_data == nullptr) {
+        throw std::invalid_argument("Invalid or null ScalarData pointer.");
+      }
+      if (scalar_storage_ == nullptr) {
+        // otherwise existing ScalarData will lack corresponding vector data.
+        // if you want to open a existing ScalarData db, try load() and then insert() your new data
+        config_.error_if_exists_ = true;
+        scalar_storage_ = std::make_unique<RocksDBStorage<IDType>>(config_);
+      }
+      // Batch insert with starting ID 0, ensuring sync with vector storage IDs
+      if (!scalar_storage_->batch_insert(static_cast<IDType>(0),
+                                         scalar_data,
+                                         scalar_data + item_cnt)) {
+        throw std::runtime_error("Failed to batch insert ScalarData");
+      }
+    }
+  }
+
+  /**
+   * @brief Get the PQ code pointer for a specific ID
+   * @param id The ID of the data point
+   * @return Pointer to the code for the given ID
+   */
+  auto get_data_by_id(IDType id) const -> uint8_t * { return data_storage_[id]; }
+
+  /**
+   * @brief Calculate the distance between two data points. L2 uses the symmetric (centroid to
+   * centroid) table; IP / COS compare the two decoded vectors.
+   * @param i ID of the first data point
+   * @param j ID of the second data point
+   * @return The calculated distance
+   */
+  auto get_distance(IDType i, IDType j) -> DistanceType {
+    if (metric_ == MetricType::L2) {
+      return quantizer_.l2_sqr(get_data_by_id(i), get_data_by_id(j));
+    }
+    std::vector<DataType> lhs(dim_);
+    std::vector<DataType> rhs(dim_);
+    quantizer_.decode(get_data_by_id(i), lhs.data());
+    quantizer_.decode(get_data_by_id(j), rhs.data());
+    return distance_calu_func_(lhs.data(), rhs.data(), dim_);
+  }
+
+  /**
+   * @brief Get the number of the vector data
+   * @return The number of vector data.
+   */
+  auto get_data_num() -> IDType { return item_cnt_; }
+
+  /**
+   * @brief Get the size of each data point in bytes
+   * @return The size of each data point
+   */
+  auto get_data_size() const -> size_t { return data_size_; }
+
+  /**
+   * @brief Get the full-precision distance function for the metric (applies to decoded vectors)
+   * @return The distance calculation function
+   */
+  auto get_dist_func() -> DistFunc<DataType, DistanceType> { return distance_calu_func_; }
+
+  /**
+   * @brief Get scalar data for a specific ID
+   * @param id The ID of the data point
+   * @return The scalar data for the given ID
+   */
+  auto get_scalar_data(IDType id) const -> ScalarDataType {
+    if constexpr (has_scalar_data) {  // NOLINT
+      return (*scalar_storage_)[id];
+    }
+    throw std::runtime_error("No ScalarData available.");
+  }
+
+  /**
+   * @brief Get scalar data by item_id
+   * @param item_id The item_id to look up
+   * @return Pair of (internal_id, scalar_data)
+   * @throws std::runtime_error if item_id not found or no scalar data available
+   */
+  auto get_scalar_data(const std::string &item_id) const -> std::pair<IDType, ScalarDataType> {
+    if constexpr (has_scalar_data) {  // NOLINT
+      auto internal_id = scalar_storage_->find_by_item_id(item_id);
+      if (!internal_id.has_value()) {
+        throw std::runtime_error("Item ID not found: " + item_id);
+      }
+      return {internal_id.value(), (*scalar_storage_)[internal_id.value()]};
+    }
+    throw std::runtime_error("No ScalarData available.");
+  }
+
+  /**
+   * @brief Get scalar data with metadata filter
+   * @param filter MetadataFilter to apply
+   * @param limit Maximum number of results
+   * @return Vector of (internal_id, scalar_data) pairs
+   */
+  auto get_scalar_data(const MetadataFilter &filter, size_t limit) const
+      -> std::vector<std::pair<IDType, ScalarDataType>> {
+    if constexpr (has_scalar_data) {  // NOLINT
+      return scalar_storage_->scan_with_filter(
+          [&filter](const ScalarData &sd) {
+            return filter.evaluate(sd.metadata);
+          },
+          limit);
+    }
+    throw std::runtime_error("No ScalarData available.");
+  }
+
+  /**
+   * @brief Get the scalar storage for direct index access
+   * @return Pointer to RocksDBStorage (nullptr if no scalar data)
+   */
+  auto get_scalar_storage() const -> RocksDBStorage<IDType> * {
+    if constexpr (has_scalar_data) {
+      return scalar_storage_.get();
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief Get the dimensionality of the data points
+   * @return The dimensionality
+   */
+  auto get_dim() const -> uint32_t { return dim_; }
+
+  /**
+   * @brief Get the number of PQ sub-spaces, i.e. the code size in bytes
+   */
+  auto get_n_chunks() const -> uint32_t { return quantizer_.get_n_chunks(); }
+
+  /**
+   * @brief Get the quantizer
+   * @return quantizer
+   */
+  auto get_quantizer() const -> const PQQuantizer<DataType> & { return quantizer_; }
+
+  /**
+   * @brief Insert a data point into the space. The data point will be encoded with the trained
+   * codebooks and stored in the space. The ID of the inserted data point will be returned.
+   *
+   * @param data Pointer to the data point to be inserted
+   * @param scalar_data Pointer to ScalarData (optional, only used when ScalarDataType is not
+   * EmptyScalardata)
+   * @return IDType The ID of the inserted data point (-1 for failure)
+   */
+  auto insert(DataType *data, const ScalarDataType *scalar_data = nullptr) -> IDType {
+    auto id = data_storage_.reserve();
+    if (id == static_cast<IDType>(-1)) {
+      return static_cast<IDType>(-1);
+    }
+    item_cnt_++;
+    quantizer_.encode(data, data_storage_[id]);
+
+    // Insert ScalarData with the same ID as vector
+    if constexpr (has_scalar_data) {  // NOLINT
+      if (scalar_data != nullptr && scalar_storage_ != nullptr) {
+        if (!scalar_storage_->insert(id, *scalar_data)) {
+          LOG_ERROR("Failed to insert ScalarData for ID {}", id);
+          data_storage_.remove(id);
+          item_cnt_--;
+          throw std::runtime_error("Failed to insert ScalarData");
+        }
+      }
+    }
+
+    return id;
+  }
+
+  /**
+   * @brief Delete a data point by its ID. Currently, the data point will be marked as deleted, but
+   * not exactly removed from the storage.
+   *
+   * @param id the ID of the data point to delete
+   * @return IDType The ID of the deleted data point
+   */
+  auto remove(IDType id) -> IDType {
+    delete_cnt_++;
+
+    // Remove ScalarData if present
+    if constexpr (has_scalar_data) {  // NOLINT
+      if (scalar_storage_ != nullptr) {
+        scalar_storage_->remove(id);
+      }
+    }
+
+    return data_storage_.remove(id);
+  }
+
+  /**
+   * @brief Remove a data point by its item_id
+   * @param item_id The item_id to remove
+   * @return The internal ID that was removed
+   * @throws std::runtime_error if item_id not found
+   */
+  auto remove(const std::string &item_id) -> IDType {
+    if constexpr (has_scalar_data) {  // NOLINT
+      auto internal_id_opt = scalar_storage_->find_by_item_id(item_id);
+      if (!internal_id_opt.has_value()) {
+        throw std::runtime_error("Item ID not found: " + item_id);
+      }
+      return remove(internal_id_opt.value());  // Calls remove(IDType) above
+    }
+    throw std::runtime_error("No ScalarData available.");
+  }
+
+  /**
+   * @brief Load the space from a file
+   * @param filename The name of the file to load
+   */
+  auto load(std::string_view filename) -> void {
+    std::ifstream reader(std::string(filename), std::ios::binary);
+
+    if (!reader.is_open()) {
+      throw std::runtime_error("Cannot open file " + std::string(filename));
+    }
+
+    reader.read(reinterpret_cast<char *>(&metric_), sizeof(metric_));
+    reader.read(reinterpret_cast<char *>(&data_size_), sizeof(data_size_));
+    reader.read(reinterpret_cast<char *>(&dim_), sizeof(dim_));
+    reader.read(reinterpret_cast<char *>(&item_cnt_), sizeof(item_cnt_));
+    reader.read(reinterpret_cast<char *>(&delete_cnt_), sizeof(delete_cnt_));
+    reader.read(reinterpret_cast<char *>(&capacity_), sizeof(capacity_));
+
+    if constexpr (has_scalar_data) {  // NOLINT
+      load_scalar_config(reader);
+      scalar_storage_ = std::make_unique<RocksDBStorage<IDType>>(config_);
+    }
+
+    data_storage_.load(reader);
+    quantizer_.load(reader);
+    set_metric_function();
+    LOG_INFO("PQSpace is loaded from {}", filename);
+  }
+
+  /**
+   * @brief Save the space to a file
+   * @param filename The name of the file to save
+   */
+  auto save(std::string_view filename) -> void {
+    std::ofstream writer(std::string(filename), std::ios::binary);
+    if (!writer.is_open()) {
+      throw std::runtime_error("Cannot open file " + std::string(filename));
+    }
+
+    writer.write(reinterpret_cast<char *>(&metric_), sizeof(metric_));
+    writer.write(reinterpret_cast<char *>(&data_size_), sizeof(data_size_));
+    writer.write(reinterpret_cast<char *>(&dim_), sizeof(dim_));
+    writer.write(reinterpret_cast<char *>(&item_cnt_), sizeof(item_cnt_));
+    writer.write(reinterpret_cast<char *>(&delete_cnt_), sizeof(delete_cnt_));
+    writer.write(reinterpret_cast<char *>(&capacity_), sizeof(capacity_));
+
+    if constexpr (has_scalar_data) {  // NOLINT
+      save_scalar_config(writer);
+    }
+
+    data_storage_.save(writer);
+    quantizer_.save(writer);
+    LOG_INFO("PQSpace is saved to {}", filename);
+  }
+  /**
+   * @brief Nested structure for efficient query computation
+   *
+   * Holds the query's `n_chunks x 256` lookup table (L2: squared distance of each query chunk to
+   * each centroid; IP / COS: their inner product, plus the constant <query, global centroid>).
+   */
+  struct QueryComputer {
+    const PQSpace &distance_space_;
+    float *table_ = nullptr;  ///< n_chunks x 256 lookup table, followed by the scratch area
+    bool owns_table_ = true;
+    uint8_t *tile_ = nullptr;  ///< kTileRows gathered codes for compute(), after the table
+    float ip_bias_ = 0.0F;     ///< <query, global centroid>, added back for IP / COS
+
+    /**
+     * @brief Construct a new QueryComputer object
+     * @param distance_space Reference to the PQSpace
+     * @param query Pointer to the query data
+     */
+    QueryComputer(const PQSpace &distance_space, const DataType *query)
+        : distance_space_(distance_space) {
+      table_ = static_cast<float *>(
+          alaya_aligned_alloc_impl(distance_space_.get_query_buffer_size(), 64));
+      build_table(query);
+    }
+
+    /**
+     * @brief Construct a QueryComputer that builds the lookup table in a caller-owned buffer
+     * @param buffer 64-byte aligned, at least get_query_buffer_size() bytes; must outlive this
+     */
+    QueryComputer(const PQSpace &distance_space, const DataType *query, void *buffer)
+        : distance_space_(distance_space),
+          table_(static_cast<float *>(buffer)),
+          owns_table_(false) {
+      build_table(query);
+    }
+
+    QueryComputer(const PQSpace &distance_space, const IDType id)
+        : distance_space_(distance_space) {
+      table_ = static_cast<float *>(
+          alaya_aligned_alloc_impl(distance_space_.get_query_buffer_size(), 64));
+      std::vector<DataType> decoded(distance_space_.get_dim());
+      distance_space_.get_quantizer().decode(distance_space_.get_data_by_id(id), decoded.data());
+      build_table(decoded.data());
+    }
+    /**
+     * @brief Destructor
+     */
+    ~QueryComputer() {
+      if (table_ != nullptr && owns_table_) {
+        alaya_aligned_free_impl(table_);
+      }
+    }
+
+    /**
+     * @brief Compute the distance between the query and a data point
+     * @param u ID of the data point to compare with the query
+     * @return The calculated distance
+     */
+    auto operator()(IDType u) const -> DistanceType {
+      const uint8_t *code = distance_space_.get_data_by_id(u);
+      const uint32_t n_chunks = distance_space_.get_n_chunks();
+      float sum = 0.0F;
+      for (uint32_t c = 0; c < n_chunks; ++c) {
+        sum += table_[static_cast<size_t>(c) * kCentroids + code[c]];
+      }
+      return finish(sum);
+    }
+
+    /**
+     * @brief Compute the distances between the query and `n` data points
+     *
+     * Gathers up to kTileRows codes into a contiguous tile (prefetching the next rows) and sums
+     * the table chunk-major with diskann::pq_accumulate_tile, so each 1 KiB table row stays
+     * L1-hot across the tile. Results are bit-identical to operator().
+     * @param ids IDs of the data points
+     * @param n Number of IDs
+     * @param out Output array of `n` distances
+     */
+    void compute(const IDType *ids, size_t n, DistanceType *out) const {
+      const auto &sp = distance_space_;
+      const uint32_t n_chunks = sp.get_n_chunks();
+      float sums[kTileRows];
+      for (size_t i = 0; i < n; i += kTileRows) {
+        const auto count = static_cast<uint32_t>(std::min<size_t>(kTileRows, n - i));
+        for (uint32_t j = 0; j < count; ++j) {
+          if (i + j + 4 < n) {
+            mem_prefetch_l1(sp.get_data_by_id(ids[i + j + 4]), 1);
+          }
+          std::memcpy(tile_ + static_cast<size_t>(j) * n_chunks,
+                      sp.get_data_by_id(ids[i + j]),
+                      n_chunks);
+        }
+        diskann::pq_accumulate_tile(tile_, count, n_chunks, table_, sums);
+        for (uint32_t j = 0; j < count; ++j) {
+          out[i + j] = finish(sums[j]);
+        }
+      }
+    }
+
+   private:
+    auto finish(float sum) const -> DistanceType {
+      if (distance_space_.metric_ == MetricType::L2) {
+        return sum;
+      }
+      return -(ip_bias_ + sum);
+    }
+
+    void build_table(const DataType *query) {
+      const auto &sp = distance_space_;
+      auto *scratch = table_ + static_cast<size_t>(sp.get_n_chunks()) * kCentroids;
+      tile_ = reinterpret_cast<uint8_t *>(scratch);
+      if (sp.metric_ == MetricType::L2) {
+        sp.get_quantizer().build_l2_table(query, table_, scratch);
+      } else {
+        ip_bias_ = sp.get_quantizer().build_ip_table(query, table_);
+      }
+    }
+  };
+
+  /**
+   * @brief Prefetch data into cache by ID to optimize memory access
+   * @param id The ID of the data point to prefetch
+   */
+  auto prefetch_by_id(IDType id) -> void {
+    mem_prefetch_l1(get_data_by_id(id), math::round_up_pow2(data_size_, 64) / 64);
+  }
+
+  /**
+   * @brief Prefetch data into cache by address to optimize memory access
+   * @param address The address of the data to prefetch
+   */
+  auto prefetch_by_address(DataType *address) -> void {
+    mem_prefetch_l1(address, math::round_up_pow2(data_size_, 64) / 64);
+  }
+
+  auto get_query_computer(const DataType *query) { return QueryComputer(*this, query); }
+
+  /**
+   * @brief Like get_query_computer(query), but builds the lookup table in `buffer` instead of
+   * allocating
+   * @param buffer 64-byte aligned scratch of at least get_query_buffer_size() bytes
+   */
+  auto get_query_computer(const DataType *query, void *buffer) {
+    return QueryComputer(*this, query, buffer);
+  }
+
+  /// Lookup table, then room for the L2 query residual or the compute() code tile
+  auto get_query_buffer_size() const -> size_t {
+    size_t table_bytes = static_cast<size_t>(get_n_chunks()) * kCentroids * sizeof(float);
+    size_t scratch_bytes = std::max<size_t>(static_cast<size_t>(dim_) * sizeof(float),
+                                            static_cast<size_t>(kTileRows) * data_size_);
+    return table_bytes + math::round_up_pow2(scratch_bytes, 64);
+  }
+
+  auto get_query_computer(const IDType id) { return QueryComputer(*this, id); }
+
+  /**
+   * @brief Close the RocksDB storage explicitly
+   */
+  void close_db() {
+    if constexpr (has_scalar_data) {
+      if (scalar_storage_ != nullptr) {
+        scalar_storage_->flush();
+        scalar_storage_.reset();
+      }
+    }
+  }
+
+ private:
+  IDType capacity_{0};                 ///< The maximum number of data points (nodes)
+  uint32_t dim_{0};                    ///< Dimensionality of the data points
+  MetricType metric_{MetricType::L2};  ///< Metric type
+
+  DistFunc<DataType, DistanceType> distance_calu_func_;  ///< Full-precision distance function
+  uint32_t data_size_{0};                                ///< Size of each code in bytes
+  IDType item_cnt_{0};                                   ///< Number of data points (nodes)
+  IDType delete_cnt_{0};             ///< Number of deleted data points (nodes)
+  DataStorage data_storage_;         ///< Data storage for PQ codes
+  PQQuantizer<DataType> quantizer_;  ///< The quantizer used to encode the data
+
+  RocksDBConfig config_;  ///< Configuration for Scalar Data Storage
+  std::unique_ptr<RocksDBStorage<IDType>>
+      scalar_storage_;  ///< Scalar Data Storage (stores ScalarData)
+
+  void save_scalar_config(std::ofstream &writer) {
+    // Save db_path_ string
+    size_t db_path_size = config_.db_path_.size();
+    writer.write(reinterpret_cast<char *>(&db_path_size), sizeof(db_path_size));
+    writer.write(config_.db_path_.data(), db_path_size);
+
+    // Save POD fields
+    writer.write(reinterpret_cast<char *>(&config_.write_buffer_size_),
+                 sizeof(config_.write_buffer_size_));
+    writer.write(reinterpret_cast<char *>(&config_.max_write_buffer_number_),
+                 sizeof(config_.max_write_buffer_number_));
+    writer.write(reinterpret_cast<char *>(&config_.target_file_size_base_),
+                 sizeof(config_.target_file_size_base_));
+    writer.write(reinterpret_cast<char *>(&config_.max_background_compactions_),
+                 sizeof(config_.max_background_compactions_));
+    writer.write(reinterpret_cast<char *>(&config_.max_background_flushes_),
+                 sizeof(config_.max_background_flushes_));
+    writer.write(reinterpret_cast<char *>(&config_.block_cache_size_mb_),
+                 sizeof(config_.block_cache_size_mb_));
+
+    // Save bool as uint8_t for cross-platform compatibility
+    uint8_t enable_compression = config_.enable_compression_ ? 1 : 0;
+    writer.write(reinterpret_cast<char *>(&enable_compression), sizeof(enable_compression));
+
+    // Save indexed_fields_ for secondary index support
+    size_t fields_count = config_.indexed_fields_.size();
+    writer.write(reinterpret_cast<const char *>(&fields_count), sizeof(fields_count));
+    for (const auto &field : config_.indexed_fields_) {
+      size_t field_len = field.size();
+      writer.write(reinterpret_cast<const char *>(&field_len), sizeof(field_len));
+      writer.write(field.data(), field_len);
+    }
+  }
+
+  void load_scalar_config(std::ifstream &reader) {
+    config_.create_if_missing_ = false;  // db is missing means something went wrong
+    config_.error_if_exists_ = false;    // Of course db exists
+    // Load db_path_ string
+    size_t db_path_size;
+    reader.read(reinterpret_cast<char *>(&db_path_size), sizeof(db_path_size));
+    config_.db_path_.resize(db_path_size);
+    reader.read(config_.db_path_.data(), db_path_size);
+
+    // Load POD fields
+    reader.read(reinterpret_cast<char *>(&config_.write_buffer_size_),
+                sizeof(config_.write_buffer_size_));
+    reader.read(reinterpret_cast<char *>(&config_.max_write_buffer_number_),
+                sizeof(config_.max_write_buffer_number_));
+    reader.read(reinterpret_cast<char *>(&config_.target_file_size_base_),
+                sizeof(config_.target_file_size_base_));
+    reader.read(reinterpret_cast<char *>(&config_.max_background_compactions_),
+                sizeof(config_.max_background_compactions_));
+    reader.read(reinterpret_cast<char *>(&config_.max_background_flushes_),
+                sizeof(config_.max_background_flushes_));
+    reader.read(reinterpret_cast<char *>(&config_.block_cache_size_mb_),
+                sizeof(config_.block_cache_size_mb_));
+
+    // Load bool from uint8_t for cross-platform compatibility
+    uint8_t enable_compression = 1;  // default to true
+    reader.read(reinterpret_cast<char *>(&enable_compression), sizeof(enable_compression));
+    config_.enable_compression_ = (enable_compression != 0);
+
+    // Load indexed_fields_ for secondary index support
+    size_t fields_count = 0;
+    reader.read(reinterpret_cast<char *>(&fields_count), sizeof(fields_count));
+    if (reader.good() && fields_count < 1000) {
+      config_.indexed_fields_.clear();
+      for (size_t i = 0; i < fields_count; i++) {
+        size_t field_len = 0;
+        reader.read(reinterpret_cast<char *>(&field_len), sizeof(field_len));
+        std::string field(field_len, '\0');
+        reader.read(field.data(), field_len);
+        config_.indexed_fields_.push_back(std::move(field));
+      }
+    }
+  }
+};
+
+static_assert(Space<PQSpace<>>);
+}  // namespace alaya
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "index/graph/diskann/pq_table.hpp"
+#include "simd/distance_ip.hpp"
+
+namespace alaya {
+/**
+ * @brief Product quantizer for the in-memory spaces, built on diskann::PQTable.
+ *
+ * The vector is split into `n_chunks` sub-vectors of `dim / n_chunks` dimensions and each is
+ * replaced by the index of its nearest of 256 centroids, so a code is `n_chunks` bytes. Queries
+ * are turned into an `n_chunks x 256` lookup table once (asymmetric distance computation), after
+ * which the distance to any code is `n_chunks` table lookups.
+ *
+ * @tparam DataType The data type of input values; PQTable trains on float only.
+ */
+template <typename DataType = float>
+struct PQQuantizer {
+  static_assert(std::is_same_v<DataType, float>, "PQQuantizer only supports float data");
+
+  static constexpr uint32_t kCentroids = diskann::kPQNumCentroids;
+  static constexpr uint64_t kMaxTrainSamples = 65536;  ///< fit() trains on a sample this large
+  static constexpr uint32_t kDefaultDimsPerChunk = 8;  ///< 32x smaller than float32 by default
+
+  uint32_t dim_ = 0;
+  uint32_t n_chunks_ = 0;
+  diskann::PQTable table_;
+
+  PQQuantizer() = default;
+
+  /**
+   * @brief Constructor initializing the quantizer for a given shape.
+   * @param dim The dimensionality of the input data.
+   * @param n_chunks Number of sub-spaces, must divide dim; 0 picks default_chunks(dim).
+   */
+  PQQuantizer(uint32_t dim, uint32_t n_chunks)
+      : dim_(dim), n_chunks_(n_chunks == 0 ? default_chunks(dim) : n_chunks) {
+    if (dim_ == 0 || dim_ % n_chunks_ != 0) {
+      throw std::invalid_argument("PQQuantizer: n_chunks (" + std::to_string(n_chunks_) +
+                                  ") must divide dim (" + std::to_string(dim_) + ")");
+    }
+  }
+
+  /// Largest divisor of `dim` not above dim / kDefaultDimsPerChunk (at least 1)
+  static auto default_chunks(uint32_t dim) -> uint32_t {
+    for (uint32_t c = std::max<uint32_t>(1, dim / kDefaultDimsPerChunk); c > 1; --c) {
+      if (dim % c == 0) {
+        return c;
+      }
+    }
+    return 1;
+  }
+
+  /**
+   * @brief Train the codebooks on (a deterministic sample of at most kMaxTrainSamples of) the data.
+   * @param data Pointer to the input data array.
+   * @param item_cnt Number of data items in the input array.
+   */
+  void fit(const DataType *data, size_t item_cnt) {
+    if (item_cnt <= kMaxTrainSamples) {
+      table_.train(data, item_cnt, dim_, n_chunks_);
+      return;
+    }
+    std::vector<size_t> ids(item_cnt);
+    std::iota(ids.begin(), ids.end(), size_t{0});
+    std::mt19937_64 rng(1234);
+    std::shuffle(ids.begin(), ids.end(), rng);
+    ids.resize(kMaxTrainSamples);
+    std::sort(ids.begin(), ids.end());
+    std::vector<float> sample(kMaxTrainSamples * dim_);
+    for (size_t i = 0; i < ids.size(); ++i) {
+      std::copy_n(data + ids[i] * dim_, dim_, sample.data() + i * dim_);
+    }
+    table_.train(sample.data(), kMaxTrainSamples, dim_, n_chunks_);
+  }
+
+  /**
+   * @brief Encode a vector into its `n_chunks` centroid indices.
+   * @param raw_data Pointer to input raw data array.
+   * @param encoded_data Output code, n_chunks bytes.
+   */
+  void encode(const DataType *raw_data, uint8_t *const encoded_data) const {
+    table_.encode_to_code(raw_data, encoded_data);
+  }
+
+  /// Reconstruct the vector a code stands for: global centroid plus the chosen chunk centroids
+  void decode(const uint8_t *code, DataType *out) const {
+    const uint32_t chunk_dim = dim_ / n_chunks_;
+    const auto &centroid = table_.global_centroid();
+    const auto &codebook = table_.codebook();
+    for (uint32_t c = 0; c < n_chunks_; ++c) {
+      const float *cent =
+          codebook.data() + (static_cast<size_t>(c) * kCentroids + code[c]) * chunk_dim;
+      for (uint32_t d = 0; d < chunk_dim; ++d) {
+        out[c * chunk_dim + d] = centroid[c * chunk_dim + d] + cent[d];
+      }
+    }
+  }
+
+  /// Symmetric (code to code) squared L2 distance
+  auto l2_sqr(const uint8_t *lhs, const uint8_t *rhs) const -> float {
+    return table_.pq_symmetric_distance_codes(lhs, rhs);
+  }
+
+  /**
+   * @brief Fill the L2 lookup table: table[c * 256 + k] = |query_c - centroid_ck|^2
+   * @param scratch dim floats of working space
+   */
+  void build_l2_table(const DataType *query, float *table, float *scratch) const {
+    table_.preprocess_query(query, table, scratch);
+  }
+
+  /**
+   * @brief Fill the inner product lookup table: table[c * 256 + k] = <query_c, centroid_ck>
+   * @return <query, global centroid>, the part of every inner product the table leaves out
+   */
+  auto build_ip_table(const DataType *query, float *table) const -> float {
+    const uint32_t chunk_dim = dim_ / n_chunks_;
+    const auto &codebook = table_.codebook();
+    const auto dot = simd::get_ip_sqr_func();  // returns -<x, y>
+    for (uint32_t c = 0; c < n_chunks_; ++c) {
+      const float *qchunk = query + static_cast<size_t>(c) * chunk_dim;
+      const float *cent = codebook.data() + static_cast<size_t>(c) * kCentroids * chunk_dim;
+      for (uint32_t k = 0; k < kCentroids; ++k) {
+        table[c * kCentroids + k] = -dot(qchunk, cent + static_cast<size_t>(k) * chunk_dim,
+                                         chunk_dim);
+      }
+    }
+    return -dot(query, table_.global_centroid().data(), dim_);
+  }
+
+  auto get_n_chunks() const -> uint32_t { return n_chunks_; }
+
+  /**
+   * @brief Load the quantizer parameters from a binary file.
+   * @param reader Input file stream.
+   */
+  auto load(std::ifstream &reader) -> void {
+    reader.read(reinterpret_cast<char *>(&dim_), sizeof(dim_));
+    reader.read(reinterpret_cast<char *>(&n_chunks_), sizeof(n_chunks_));
+    std::vector<float> centroid(dim_);
+    std::vector<float> codebook(static_cast<size_t>(kCentroids) * dim_);
+    reader.read(reinterpret_cast<char *>(centroid.data()), centroid.size() * sizeof(float));
+    reader.read(reinterpret_cast<char *>(codebook.data()), codebook.size() * sizeof(float));
+    if (!reader) {
+      throw std::runtime_error("PQQuantizer::load: short read");
+    }
+    table_ = diskann::PQTable::from_codebook(dim_, n_chunks_, std::move(centroid),
+                                             std::move(codebook));
+  }
+
+  /**
+   * @brief Save the quantizer parameters to a binary file.
+   * @param writer Output file stream.
+   */
+  auto save(std::ofstream &writer) const -> void {
+    writer.write(reinterpret_cast<const char *>(&dim_), sizeof(dim_));
+    writer.write(reinterpret_cast<const char *>(&n_chunks_), sizeof(n_chunks_));
+    const auto &centroid = table_.global_centroid();
+    const auto &codebook = table_.codebook();
+    writer.write(reinterpret_cast<const char *>(centroid.data()), centroid.size() * sizeof(float));
+    writer.write(reinterpret_cast<const char *>(codebook.data()), codebook.size() * sizeof(float));
+  }
+};
+}  // namespace alaya
@@ -4,16 +4,42 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <type_traits>
+#include <vector>
 
+#include "simd/distance_ip.hpp"
 #include "utils/log.hpp"
 #include "utils/metric_type.hpp"
 #include "utils/rabitq_utils/defines.hpp"
 #include "utils/rabitq_utils/fastscan.hpp"
 
 namespace alaya {
+/**
+ * @brief <q, code> for a byte-per-dimension extended RaBitQ code
+ *
+ * FP32 queries run the dispatched simd::dot_sq8_f32 kernel, which widens the codes to FP32 and
+ * accumulates with FMA.
+ */
+template <typename DataType>
+inline auto ex_code_ip(const DataType *ALAYA_RESTRICT query,
+                       const uint8_t *ALAYA_RESTRICT code,
+                       size_t dim) -> DataType {
+  if constexpr (std::is_same_v<DataType, float>) {
+    return simd::get_dot_sq8_f32_func()(code, query, dim);
+  } else {
+    DataType sum = 0;
+    for (size_t i = 0; i < dim; ++i) {
+      sum += query[i] * static_cast<DataType>(code[i]);
+    }
+    return sum;
+  }
+}
+
 template <typename DataType>
 struct RaBitQQuantizer {
  private:
@@ -147,6 +173,81 @@ struct RaBitQQuantizer {
     fastscan::pack_codes(padded_dim_, compact_codes.data(), num, bin_code);
   }
 
+  /**
+   * @brief Quantize one rotated vector into a `bits`-bit extended RaBitQ code relative to
+   * `rotated_centroid`, one byte per dimension with values in [0, 2^bits - 1].
+   *
+   * The code is the uniform grid point x_u whose x_bar = x_u - (2^bits - 1) / 2 has the largest
+   * cosine with the residual o_r - c_r, found by scanning a few grid scales (larger scales clip
+   * outlier dimensions). The factors follow the 1-bit ones, so that
+   * dist(q, o) ~= G(q) + f_add + f_rescale * <x_bar, q_r>, with G(q) = |q - c|^2 under L2 and
+   * -<q, c> under IP/COS.
+   */
+  void ex_quantize(const DataType *rotated_data,
+                   const DataType *rotated_centroid,
+                   uint32_t bits,
+                   uint8_t *code,
+                   DataType &f_add,
+                   DataType &f_rescale,
+                   const MetricType metric) const {
+    constexpr size_t kScaleSteps = 16;
+    constexpr DataType kScaleStride = 0.125;
+
+    const auto levels = static_cast<DataType>((1U << bits) - 1);
+    const DataType half_range = (levels + 1) / 2;
+    std::vector<DataType> residual(padded_dim_);
+    DataType max_abs = 0;
+    for (size_t i = 0; i < padded_dim_; ++i) {
+      residual[i] = rotated_data[i] - rotated_centroid[i];
+      max_abs = std::max(max_abs, std::abs(residual[i]));
+    }
+    std::fill(code, code + padded_dim_, static_cast<uint8_t>(0));
+    f_add = 0;
+    f_rescale = 0;
+    if (max_abs == 0) {
+      return;  // o == c, G(q) alone is exact
+    }
+    DataType l2_sqr_residual = ::alaya::l2_sqr<DataType>(residual.data(), padded_dim_);
+
+    std::vector<uint8_t> candidate(padded_dim_);
+    DataType best_cos = 0;
+    DataType ip_resi_and_x_bar = 0;
+    for (size_t step = 0; step < kScaleSteps; ++step) {
+      // step 0 maps the largest |residual| onto the outermost level
+      DataType scale = half_range / max_abs * (1 + static_cast<DataType>(step) * kScaleStride);
+      DataType ip = 0;
+      DataType x_bar_sqr = 0;
+      for (size_t i = 0; i < padded_dim_; ++i) {
+        DataType level = std::clamp<DataType>(std::floor(residual[i] * scale + half_range), 0,
+                                              levels);
+        candidate[i] = static_cast<uint8_t>(level);
+        DataType x_bar = level - levels / 2;
+        ip += residual[i] * x_bar;
+        x_bar_sqr += x_bar * x_bar;
+      }
+      DataType cos = ip / std::sqrt(x_bar_sqr * l2_sqr_residual);
+      if (cos > best_cos) {
+        best_cos = cos;
+        ip_resi_and_x_bar = ip;
+        std::copy(candidate.begin(), candidate.end(), code);
+      }
+    }
+    if (ip_resi_and_x_bar <= 0) {
+      return;
+    }
+
+    if (metric == MetricType::L2) {
+      DataType ip_c_and_x_bar = 0;
+      for (size_t i = 0; i < padded_dim_; ++i) {
+        ip_c_and_x_bar += rotated_centroid[i] * (static_cast<DataType>(code[i]) - levels / 2);
+      }
+      f_add = l2_sqr_residual + (2 * l2_sqr_residual * ip_c_and_x_bar / ip_resi_and_x_bar);
+      f_rescale = -2 * l2_sqr_residual / ip_resi_and_x_bar;
+    } else if (metric == MetricType::COS || metric == MetricType::IP) {
+      f_rescale = -l2_sqr_residual / ip_resi_and_x_bar;
+    }
+  }
+
   auto save(std::ofstream &writer) -> void {
     writer.write(reinterpret_cast<char *>(&dim_), sizeof(dim_));
     writer.write(reinterpret_cast<char *>(&padded_dim_), sizeof(padded_dim_));
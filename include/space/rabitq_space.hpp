@@ -4,13 +4,19 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <shared_mutex>
 #include <stdexcept>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -27,9 +33,12 @@
 #include "utils/metric_type.hpp"
 #include "utils/openmp.hpp"
 #include "utils/prefetch.hpp"
+#include "utils/query_utils.hpp"
 #include "utils/rabitq_utils/fastscan.hpp"
 #include "utils/rabitq_utils/lut.hpp"
 #include "utils/rabitq_utils/rotator.hpp"
+#include "utils/rabitq_utils/search_utils/buffer.hpp"
+#include "utils/rabitq_utils/search_utils/hashset.hpp"
 
 namespace alaya {
 template <typename DataType = float,
@@ -46,8 +55,11 @@ class RaBitQSpace {
   uint32_t dim_{0};                    ///< Dimensionality of the data points
   MetricType metric_{MetricType::L2};  ///< Metric type
   RotatorType type_;                   ///< Rotator type
-  IDType item_cnt_{0};                 ///< Number of data points (nodes)
+  IDType item_cnt_{0};    ///< Number of data points (nodes), can be either, available or deleted
+  IDType delete_cnt_{0};  ///< Number of deleted data points
+  uint32_t bits_{1};  ///< Bits/dim of each node's own code; 1 keeps raw vectors inline instead
 
+  size_t self_factor_offset_{0};  ///< Own-code f_add / f_rescale pair (bits_ > 1)
   size_t quant_codes_offset_{0};
   size_t f_add_offset_{0};
   size_t f_rescale_offset_{0};
@@ -62,24 +74,34 @@ class RaBitQSpace {
       scalar_storage_;  ///< Scalar Data Storage (stores ScalarData)
   std::unique_ptr<RaBitQQuantizer<DataType>> quantizer_;  ///< Data Quantizer
   std::unique_ptr<Rotator<DataType>> rotator_;            ///< Data rotator
+  DynamicBitset deleted_{0};  ///< Tombstones: deleted nodes stay routable but are never returned
+  StaticStorage<> raw_storage_;  ///< Raw vectors, kept off the node chunks when bits_ > 1
+  std::vector<DataType> rotated_centroid_;  ///< Rotated data centroid, origin of own codes
 
   IDType ep_;  ///< search entry point
+  mutable std::shared_mutex update_mutex_;  ///< insert()/remove() write, read_guard() holders read
+  /// Held by a waiting writer so new readers queue behind it
+  mutable std::mutex update_turnstile_;
 
   void initialize_offsets() {
     // data layout: (for each node, degree_bound defines their final outdegree)
-    // 1. Its raw data vector
+    // 1. Its raw data vector, or with bits_ > 1 its own extended code (one byte per padded
+    //    dimension) followed by that code's f_add and f_rescale; raw vectors then live in
+    //    raw_storage_, off the search path
     // 2. Its neighbors' quantization codes
     // 3. F_add , F_rescale : please refer to
     // https://github.com/VectorDB-NTU/RaBitQ-Library/blob/main/docs/docs/rabitq/estimator.md
     // for detailed information
     // 4. Its neighbors' IDs
-    size_t rvec_len = dim_ * sizeof(DataType);
+    size_t rvec_len = bits_ > 1 ? get_padded_dim() + (2 * sizeof(DataType))
+                                : dim_ * sizeof(DataType);
     size_t nei_quant_code_len = get_padded_dim() * kDegreeBound / 8;  // 1 b/dim code
     size_t f_add_len = kDegreeBound * sizeof(DataType);
     size_t f_rescale_len = kDegreeBound * sizeof(DataType);
     size_t nei_id_len = kDegreeBound * sizeof(IDType);
 
     // byte
+    self_factor_offset_ = get_padded_dim();
     quant_codes_offset_ = rvec_len;
     f_add_offset_ = quant_codes_offset_ + nei_quant_code_len;
     f_rescale_offset_ = f_add_offset_ + f_add_len;
@@ -89,6 +111,157 @@ class RaBitQSpace {
     set_metric_function();
   }
 
+  void compute_centroid() {
+    std::vector<double> sum(dim_, 0.0);
+    for (IDType i = 0; i < item_cnt_; ++i) {
+      const auto *vec = get_data_by_id(i);
+      for (size_t k = 0; k < dim_; ++k) {
+        sum[k] += vec[k];
+      }
+    }
+    std::vector<DataType> centroid(dim_);
+    for (size_t k = 0; k < dim_; ++k) {
+      centroid[k] = static_cast<DataType>(sum[k] / std::max<IDType>(item_cnt_, 1));
+    }
+    rotated_centroid_.assign(get_padded_dim(), 0);
+    rotator_->rotate(centroid.data(), rotated_centroid_.data());
+  }
+
+  // write node `id`'s own extended code and factors (bits_ > 1)
+  void encode_self(IDType id) {
+    std::vector<DataType> rotated(get_padded_dim());
+    rotator_->rotate(get_data_by_id(id), rotated.data());
+    char *base = get_chunk_by_id(id);
+    auto *factors = reinterpret_cast<DataType *>(base + self_factor_offset_);
+    quantizer_->ex_quantize(rotated.data(),
+                            rotated_centroid_.data(),
+                            bits_,
+                            reinterpret_cast<uint8_t *>(base),
+                            factors[0],
+                            factors[1],
+                            metric_);
+  }
+
+  using CandidateList = std::vector<Neighbor<IDType, DistanceType>>;
+
+  /**
+   * @brief Beam-search the graph for node `id` (already copied into storage, not yet linked) and
+   * return every expanded node with its exact distance, sorted. Mirrors
+   * QGBuilder::find_candidates.
+   */
+  auto search_insert_candidates(IDType id, uint32_t ef) const -> CandidateList {
+    SearchBuffer<DistanceType> pool(ef);
+    HashBasedBooleanSet vis(std::min<size_t>(static_cast<size_t>(ef) * ef, item_cnt_ / 10));
+    pool.insert(ep_, std::numeric_limits<DistanceType>::max());
+
+    QueryComputer q_computer(*this, get_data_by_id(id), true);
+    CandidateList results;
+    while (pool.has_next()) {
+      auto cur = pool.pop();
+      if (vis.get(cur)) {
+        continue;
+      }
+      vis.set(cur);
+
+      q_computer.load_centroid(cur);
+      const auto *edges = get_edges(cur);
+      for (size_t i = 0; i < kDegreeBound; ++i) {
+        auto dist = q_computer(i);
+        if (pool.is_full(dist) || vis.get(edges[i])) {
+          continue;
+        }
+        pool.insert(edges[i], dist);
+      }
+      results.emplace_back(cur, q_computer.get_exact_qr_c_dist());
+    }
+    std::sort(results.begin(), results.end());
+    return results;
+  }
+
+  /**
+   * @brief Pick exactly kDegreeBound neighbors from `pool` (sorted by distance): live candidates
+   * that survive the NSG occlusion rule, then the nearest remaining live candidates, then
+   * tombstoned ones, then repeats of the nearest pick. A fast-scan block always holds
+   * kDegreeBound entries, so the list is never left short.
+   */
+  void select_neighbors(const CandidateList &pool, CandidateList &result) {
+    result.clear();
+    std::vector<bool> taken(pool.size(), false);
+    for (size_t k = 0; k < pool.size() && result.size() < kDegreeBound; ++k) {
+      if (deleted_.get(pool[k].id_)) {
+        continue;
+      }
+      bool occluded = false;
+      for (const auto &selected : result) {
+        if (get_distance(selected.id_, pool[k].id_) < pool[k].distance_) {
+          occluded = true;
+          break;
+        }
+      }
+      if (!occluded) {
+        result.emplace_back(pool[k]);
+        taken[k] = true;
+      }
+    }
+    for (bool deleted_pass : {false, true}) {
+      for (size_t k = 0; k < pool.size() && result.size() < kDegreeBound; ++k) {
+        if (!taken[k] && deleted_.get(pool[k].id_) == deleted_pass) {
+          result.emplace_back(pool[k]);
+          taken[k] = true;
+        }
+      }
+    }
+    while (!result.empty() && result.size() < kDegreeBound) {
+      result.emplace_back(result.front());
+    }
+    std::sort(result.begin(), result.end());
+  }
+
+  // std::shared_mutex may prefer readers; passing the turnstile first keeps a steady search load
+  // from starving insert()/remove().
+  auto write_guard() -> std::unique_lock<std::shared_mutex> {
+    std::lock_guard<std::mutex> turnstile(update_turnstile_);
+    return std::unique_lock<std::shared_mutex>(update_mutex_);
+  }
+
+  /**
+   * @brief Offer `src` to `dst`'s edge list, like QGBuilder::add_reverse_edges for one node.
+   * The block is rewritten only when the re-pruned list differs from the current one.
+   */
+  void add_reverse_edge(IDType dst, IDType src, DistanceType dist) {
+    const auto *edges = get_edges(dst);
+    std::vector<IDType> old_ids(edges, edges + kDegreeBound);
+    if (std::find(old_ids.begin(), old_ids.end(), src) != old_ids.end()) {
+      return;
+    }
+    std::sort(old_ids.begin(), old_ids.end());
+    old_ids.erase(std::unique(old_ids.begin(), old_ids.end()), old_ids.end());
+
+    CandidateList pool;
+    pool.reserve(old_ids.size() + 1);
+    for (auto nei : old_ids) {
+      if (nei != dst) {
+        pool.emplace_back(nei, get_distance(dst, nei));
+      }
+    }
+    pool.emplace_back(src, dist);
+    std::sort(pool.begin(), pool.end());
+
+    CandidateList result;
+    select_neighbors(pool, result);
+    std::vector<IDType> new_ids;
+    new_ids.reserve(result.size());
+    for (const auto &nei : result) {
+      new_ids.push_back(nei.id_);
+    }
+    std::sort(new_ids.begin(), new_ids.end());
+    new_ids.erase(std::unique(new_ids.begin(), new_ids.end()), new_ids.end());
+    if (new_ids == old_ids) {
+      return;
+    }
+    update_nei(dst, result);
+  }
+
   // TODO(review - scalar storage dedup): extract scalar_storage_ plus save/load_scalar_config into
   // a shared helper reused by Raw/SQ4/SQ8/RaBitQ spaces.
   // TODO(review - portable snapshots): checkpoint the RocksDB contents or rewrite db_path_
@@ -178,6 +351,9 @@ class RaBitQSpace {
 
   // if you change degree bound , you should consider changing the layout too
   constexpr static size_t kDegreeBound = 32;  ///< Out degree of each node (in final graph)
+  constexpr static uint32_t kDefaultInsertEf = 200;  ///< Beam width of insert()'s neighbor search
+  constexpr static uint32_t kMaxBits = 8;            ///< Widest own code, one byte per dimension
+  constexpr static uint32_t kExtCodeMagic = 0x58515242;  ///< "BRQX", leads files with bits_ > 1
 
   RaBitQSpace() = default;
   ~RaBitQSpace() = default;
@@ -188,11 +364,21 @@ class RaBitQSpace {
               size_t dim,
               MetricType metric,
               RocksDBConfig config = RocksDBConfig::default_config(),
-              RotatorType type = RotatorType::FhtKacRotator)
-      : capacity_(capacity), dim_(dim), metric_(metric), type_(type), config_(std::move(config)) {
+              RotatorType type = RotatorType::FhtKacRotator,
+              uint32_t bits = 1)
+      : capacity_(capacity),
+        dim_(dim),
+        metric_(metric),
+        type_(type),
+        bits_(bits),
+        config_(std::move(config)) {
     if constexpr (!std::is_same_v<DataType, float> || !std::is_same_v<DistanceType, float>) {
       throw std::runtime_error("RaBitQSpace only supports float as DataType and DistanceType");
     }
+    if (bits_ < 1 || bits_ > kMaxBits) {
+      throw std::invalid_argument("RaBitQSpace: bits must be in [1, " + std::to_string(kMaxBits) +
+                                  "]");
+    }
     rotator_ = choose_rotator<DataType>(dim_, type_, alaya::math::round_up_pow2<size_t>(dim_, 64));
     quantizer_ = std::make_unique<RaBitQQuantizer<DataType>>(dim_, rotator_->size());
     initialize_offsets();
@@ -200,21 +386,120 @@ class RaBitQSpace {
   auto operator=(const RaBitQSpace &) -> RaBitQSpace & = delete;
   auto operator=(RaBitQSpace &&) -> RaBitQSpace & = delete;
 
-  auto insert(DataType *data, const ScalarDataType *scalar_data = nullptr) -> IDType {
-    throw std::runtime_error("Insert operation is not supported yet!");
+  /**
+   * @brief Insert a data point and link it into the QG graph held by this space.
+   *
+   * The new node's neighbors come from a beam search over the current graph followed by the
+   * NSG-style pruning QGBuilder uses. Every chosen neighbor then re-prunes its own edge list with
+   * the new node as an extra candidate (reverse-edge repair) and re-quantizes its fast-scan block,
+   * dropping tombstoned neighbors first. Those blocks are rewritten in place, so insert() takes
+   * the writer side of update_mutex_; searches that may overlap it must hold read_guard().
+   *
+   * @param data Pointer to the data point
+   * @param scalar_data Optional scalar data
+   * @param ef Beam width of the neighbor search, clamped to at least kDegreeBound
+   * @return The internal ID of the new node
+   * @throws std::runtime_error if the space is already at capacity
+   */
+  auto insert(const DataType *data,
+              const ScalarDataType *scalar_data = nullptr,
+              uint32_t ef = kDefaultInsertEf) -> IDType {
+    if (data == nullptr) {
+      throw std::invalid_argument("Invalid or null vector data pointer.");
+    }
+    auto lock = write_guard();
+    if (item_cnt_ <= kDegreeBound) {
+      throw std::runtime_error("RaBitQSpace: insert requires a built graph with more than " +
+                               std::to_string(kDegreeBound) + " nodes");
+    }
+    if (item_cnt_ >= capacity_) {
+      throw std::runtime_error("RaBitQSpace: space is full (capacity " +
+                               std::to_string(capacity_) + ")");
+    }
+
+    auto id = item_cnt_;
+    std::copy(data, data + dim_, get_data_by_id(id));
+    if (bits_ > 1) {
+      encode_self(id);
+    }
+
+    // link the new node before publishing it, so searchers never see an empty edge block
+    auto candidates = search_insert_candidates(id, std::max<uint32_t>(ef, kDegreeBound));
+    std::vector<Neighbor<IDType, DistanceType>> neighbors;
+    select_neighbors(candidates, neighbors);
+    update_nei(id, neighbors);
+
+    if constexpr (has_scalar_data) {
+      if (scalar_data != nullptr && scalar_storage_ != nullptr) {
+        if (!scalar_storage_->insert(id, *scalar_data)) {
+          throw std::runtime_error("Failed to insert ScalarData");
+        }
+      }
+    }
+    item_cnt_++;
+
+    std::vector<IDType> repaired;
+    repaired.reserve(kDegreeBound);
+    for (const auto &nei : neighbors) {
+      if (std::find(repaired.begin(), repaired.end(), nei.id_) == repaired.end()) {
+        repaired.push_back(nei.id_);
+        add_reverse_edge(nei.id_, id, nei.distance_);
+      }
+    }
+    return id;
   }
+
+  /**
+   * @brief Delete a data point by its ID. The node is tombstoned: it keeps its edges so the
+   * graph stays connected, but searches no longer return it.
+   *
+   * @param id the id of the data point to delete
+   * @return The removed ID, or -1 if the ID is out of range or already deleted
+   */
   auto remove(IDType id) -> IDType {
-    throw std::runtime_error("Remove operation is not supported yet!");
+    auto lock = write_guard();
+    if (id >= item_cnt_ || deleted_.get(id)) {
+      return static_cast<IDType>(-1);
+    }
+    deleted_.set(id);
+    delete_cnt_++;
+    if constexpr (has_scalar_data) {
+      if (scalar_storage_ != nullptr) {
+        scalar_storage_->remove(id);
+      }
+    }
+    return id;
   }
 
   /**
    * @brief Remove a data point by its item_id
    * @param item_id The item_id to remove
    * @return The internal ID that was removed
-   * @throws std::runtime_error - not supported yet
+   * @throws std::runtime_error if item_id not found or no scalar data available
    */
   auto remove(const std::string &item_id) -> IDType {
-    throw std::runtime_error("Remove operation is not supported yet!");
+    if constexpr (has_scalar_data) {
+      auto internal_id = scalar_storage_->find_by_item_id(item_id);
+      if (!internal_id.has_value()) {
+        throw std::runtime_error("Item ID not found: " + item_id);
+      }
+      remove(internal_id.value());
+      return internal_id.value();
+    }
+    throw std::runtime_error("RaBitQSpace does not store scalar data.");
+  }
+
+  [[nodiscard]] auto is_deleted(IDType id) const -> bool { return deleted_.get(id); }
+
+  auto get_avl_data_num() const -> IDType { return item_cnt_ - delete_cnt_; }
+
+  /**
+   * @brief Reader side of the insert()/remove() guard. Hold it for a whole search when updates
+   * may run concurrently; it must be released on the thread that took it.
+   */
+  auto read_guard() const -> std::shared_lock<std::shared_mutex> {
+    std::lock_guard<std::mutex> turnstile(update_turnstile_);
+    return std::shared_lock<std::shared_mutex>(update_mutex_);
   }
 
   void set_ep(IDType ep) { ep_ = ep; }
@@ -287,7 +572,13 @@ class RaBitQSpace {
     item_cnt_ = item_cnt;
 
     // We don't fit after loading , so loaded storage_ would not be overwritten.
-    storage_ = StaticStorage<>(std::vector<size_t>{item_cnt_, data_chunk_size_});
+    // sized for capacity_ so insert() can append without moving nodes under running searches
+    storage_ = StaticStorage<>(std::vector<size_t>{capacity_, data_chunk_size_});
+    delete_cnt_ = 0;
+    deleted_ = DynamicBitset(capacity_);
+    if (bits_ > 1) {
+      raw_storage_ = StaticStorage<>(std::vector<size_t>{capacity_, dim_ * sizeof(DataType)});
+    }
     platform::log_openmp_fallback_once();
     ALAYA_OMP_PARALLEL_FOR_DYNAMIC
     for (int64_t i = 0; i < static_cast<int64_t>(item_cnt); i++) {
@@ -295,6 +586,13 @@ class RaBitQSpace {
       auto *dst = get_data_by_id(i);
       std::copy(src, src + dim_, dst);
     }
+    if (bits_ > 1) {
+      compute_centroid();
+      ALAYA_OMP_PARALLEL_FOR_DYNAMIC
+      for (int64_t i = 0; i < static_cast<int64_t>(item_cnt); i++) {
+        encode_self(static_cast<IDType>(i));
+      }
+    }
 
     // Store ScalarData with synchronized IDs (0, 1, 2, ...)
     if constexpr (has_scalar_data) {
@@ -319,13 +617,28 @@ class RaBitQSpace {
   }
 
   [[nodiscard]] auto get_data_by_id(IDType id) const -> const DataType * {
+    if (bits_ > 1) {
+      return reinterpret_cast<const DataType *>(&raw_storage_.at(dim_ * sizeof(DataType) * id));
+    }
     return reinterpret_cast<const DataType *>(&storage_.at(data_chunk_size_ * id));
   }
 
   [[nodiscard]] auto get_data_by_id(IDType id) -> DataType * {
+    if (bits_ > 1) {
+      return reinterpret_cast<DataType *>(&raw_storage_.at(dim_ * sizeof(DataType) * id));
+    }
     return reinterpret_cast<DataType *>(&storage_.at(data_chunk_size_ * id));
   }
 
+  // get the start of a node's chunk, the first line a search touches
+  [[nodiscard]] auto get_chunk_by_id(IDType id) const -> const char * {
+    return &storage_.at(data_chunk_size_ * id);
+  }
+
+  [[nodiscard]] auto get_chunk_by_id(IDType id) -> char * {
+    return &storage_.at(data_chunk_size_ * id);
+  }
+
   // get neighbors' quantization codes pointer
   [[nodiscard]] auto get_nei_qc_ptr(IDType id) const -> const uint8_t * {
     return reinterpret_cast<const uint8_t *>(
@@ -358,7 +671,7 @@ class RaBitQSpace {
 
   // get neighbors' IDs
   [[nodiscard]] auto get_edges(IDType id) const -> const IDType * {
-    return reinterpret_cast<IDType *>(&storage_.at((data_chunk_size_ * id) + nei_id_offset_));
+    return reinterpret_cast<const IDType *>(&storage_.at((data_chunk_size_ * id) + nei_id_offset_));
   }
 
   [[nodiscard]] auto get_edges(IDType id) -> IDType * {
@@ -424,7 +737,7 @@ class RaBitQSpace {
    */
   auto prefetch_by_id(IDType id) -> void {  // for vertex
     // quant_codes_offset_ = rvec_len;
-    mem_prefetch_l1(get_data_by_id(id), quant_codes_offset_ / 64);
+    mem_prefetch_l1(get_chunk_by_id(id), quant_codes_offset_ / 64);
   }
 
   /**
@@ -455,8 +768,11 @@ class RaBitQSpace {
 
   auto get_query_computer(const DataType *query) const { return QueryComputer(*this, query); }
 
+  auto get_bits() const -> uint32_t { return bits_; }
+
+  // build paths (QGBuilder, insert) rank by exact distances even when bits_ > 1
   auto get_query_computer(const IDType id) const {
-    return QueryComputer(*this, get_data_by_id(id));
+    return QueryComputer(*this, get_data_by_id(id), true);
   }
 
   struct QueryComputer {
@@ -471,10 +787,17 @@ class RaBitQSpace {
     DistFuncRaBitQ<DataType, DistanceType> dist_func_;  ///< Distance function
     uint32_t dim_;                                      ///< Original dimension
     size_t padded_dim_;                                 ///< Padded dimension
+    const DataType *raw_ptr_;                           ///< Raw vectors when bits_ > 1
+    size_t self_factor_offset_;                         ///< Own-code factors offset
+    bool use_self_code_;  ///< Estimate query-centroid distances from own codes
 
     const DataType *query_;
     IDType c_;
 
+    std::vector<DataType> rotated_query_;  ///< Kept only for own-code estimates
+    DataType g_centroid_ = 0;  ///< |q - c|^2 (L2) or -<q, c> (IP/COS), c = data centroid
+    DataType self_bias_ = 0;   ///< <q_r, x_bar - x_u> for own codes
+
     Lut<DataType> lookup_table_;
 
     DataType g_add_ = 0;
@@ -515,7 +838,11 @@ class RaBitQSpace {
     QueryComputer(const QueryComputer &) = delete;
     auto operator=(const QueryComputer &) -> QueryComputer & = delete;
 
-    QueryComputer(const RaBitQSpace &distance_space, const DataType *query)
+    /**
+     * @param exact Compute query-centroid distances from raw vectors even when the space stores
+     * extended own codes (bits_ > 1); build paths need exact ranking
+     */
+    QueryComputer(const RaBitQSpace &distance_space, const DataType *query, bool exact = false)
         : storage_ptr_(reinterpret_cast<const char *>(distance_space.storage_.data())),
           data_chunk_size_(distance_space.data_chunk_size_),
           qc_offset_(distance_space.quant_codes_offset_),
@@ -525,6 +852,9 @@ class RaBitQSpace {
           dist_func_(distance_space.distance_cal_func_),
           dim_(distance_space.dim_),
           padded_dim_(distance_space.get_padded_dim()),
+          raw_ptr_(reinterpret_cast<const DataType *>(distance_space.raw_storage_.data())),
+          self_factor_offset_(distance_space.self_factor_offset_),
+          use_self_code_(distance_space.bits_ > 1 && !exact),
           query_(query) {
       // rotate query vector
       std::vector<DataType> rotated_query(padded_dim_);
@@ -541,14 +871,37 @@ class RaBitQSpace {
       g_k1xsumq_ = sumq * c_1;
       lut_delta_ = lookup_table_.delta();
       lut_bias_ = lookup_table_.sum_vl() + g_k1xsumq_;
+
+      if (use_self_code_) {
+        const auto &centroid = distance_space.rotated_centroid_;
+        if (distance_space.metric_ == MetricType::L2) {
+          g_centroid_ =
+              ::alaya::l2_sqr<DataType>(rotated_query.data(), centroid.data(), padded_dim_);
+        } else {
+          g_centroid_ = -dot_product<DataType>(rotated_query.data(), centroid.data(), padded_dim_);
+        }
+        self_bias_ = -static_cast<DataType>((1U << distance_space.bits_) - 1) / 2 * sumq;
+        rotated_query_ = std::move(rotated_query);
+      }
     }
 
     void load_centroid(IDType c) {
       c_ = c;
 
       const char *base = storage_ptr_ + data_chunk_size_ * c_;
-      const auto *centroid_vec = reinterpret_cast<const DataType *>(base);
-      g_add_ = dist_func_(query_, centroid_vec, dim_);
+      if (use_self_code_) {
+        // B-bit estimate replaces the raw-vector distance; it also anchors the 1-bit estimates
+        const auto *factors = reinterpret_cast<const DataType *>(base + self_factor_offset_);
+        g_add_ = g_centroid_ + factors[0] +
+                 factors[1] * (ex_code_ip(rotated_query_.data(),
+                                          reinterpret_cast<const uint8_t *>(base),
+                                          padded_dim_) +
+                               self_bias_);
+      } else {
+        const auto *centroid_vec = raw_ptr_ != nullptr ? raw_ptr_ + (static_cast<size_t>(dim_) * c_)
+                                                       : reinterpret_cast<const DataType *>(base);
+        g_add_ = dist_func_(query_, centroid_vec, dim_);
+      }
 
       batch_est_dist();
     }
@@ -558,6 +911,7 @@ class RaBitQSpace {
       return reinterpret_cast<const IDType *>(base + nei_id_offset_);
     }
 
+    // exact unless the space stores extended own codes, then their B-bit estimate
     auto get_exact_qr_c_dist() const -> DataType { return g_add_; }
 
     [[nodiscard]] auto est_data() const -> const DataType * { return est_dists_.data(); }
@@ -578,6 +932,12 @@ class RaBitQSpace {
       throw std::runtime_error("Cannot open file " + std::string(filename));
     }
 
+    if (bits_ > 1) {
+      // one-bit files start directly with the metric, which never equals the magic
+      uint32_t magic = kExtCodeMagic;
+      writer.write(reinterpret_cast<char *>(&magic), sizeof(magic));
+      writer.write(reinterpret_cast<char *>(&bits_), sizeof(bits_));
+    }
     writer.write(reinterpret_cast<char *>(&metric_), sizeof(metric_));
     writer.write(reinterpret_cast<char *>(&dim_), sizeof(dim_));
     writer.write(reinterpret_cast<char *>(&item_cnt_), sizeof(item_cnt_));
@@ -592,10 +952,27 @@ class RaBitQSpace {
 
     rotator_->save(writer);
 
-    storage_.save(writer);
+    // only the used prefix of the capacity-sized storage
+    writer.write(reinterpret_cast<const char *>(storage_.data()),
+                 static_cast<std::streamsize>(data_chunk_size_ * item_cnt_));
 
     quantizer_->save(writer);
 
+    // tombstones trail the quantizer so files written before deletes existed still load
+    writer.write(reinterpret_cast<char *>(&delete_cnt_), sizeof(delete_cnt_));
+    for (IDType id = 0; id < item_cnt_; ++id) {
+      if (deleted_.get(id)) {
+        writer.write(reinterpret_cast<char *>(&id), sizeof(id));
+      }
+    }
+
+    if (bits_ > 1) {
+      writer.write(reinterpret_cast<const char *>(rotated_centroid_.data()),
+                   static_cast<std::streamsize>(rotated_centroid_.size() * sizeof(DataType)));
+      writer.write(reinterpret_cast<const char *>(raw_storage_.data()),
+                   static_cast<std::streamsize>(dim_ * sizeof(DataType) * item_cnt_));
+    }
+
     LOG_INFO("RaBitQSpace is successfully saved to {}.", filename);
   }
 
@@ -606,7 +983,19 @@ class RaBitQSpace {
       throw std::runtime_error("Cannot open file " + std::string(filename));
     }
 
-    reader.read(reinterpret_cast<char *>(&metric_), sizeof(metric_));
+    uint32_t head = 0;
+    reader.read(reinterpret_cast<char *>(&head), sizeof(head));
+    bits_ = 1;
+    if (head == kExtCodeMagic) {
+      reader.read(reinterpret_cast<char *>(&bits_), sizeof(bits_));
+      if (bits_ < 2 || bits_ > kMaxBits) {
+        throw std::runtime_error("RaBitQSpace: invalid code width in " + std::string(filename));
+      }
+      reader.read(reinterpret_cast<char *>(&metric_), sizeof(metric_));
+    } else {
+      static_assert(sizeof(metric_) == sizeof(head));
+      std::memcpy(&metric_, &head, sizeof(head));
+    }
     reader.read(reinterpret_cast<char *>(&dim_), sizeof(dim_));
     reader.read(reinterpret_cast<char *>(&item_cnt_), sizeof(item_cnt_));
     reader.read(reinterpret_cast<char *>(&capacity_), sizeof(capacity_));
@@ -623,12 +1012,43 @@ class RaBitQSpace {
 
     this->initialize_offsets();
 
-    storage_ = StaticStorage<>(std::vector<size_t>{item_cnt_, data_chunk_size_});
-    storage_.load(reader);
+    capacity_ = std::max(capacity_, item_cnt_);
+    storage_ = StaticStorage<>(std::vector<size_t>{capacity_, data_chunk_size_});
+    reader.read(reinterpret_cast<char *>(storage_.data()),
+                static_cast<std::streamsize>(data_chunk_size_ * item_cnt_));
 
     quantizer_ = std::make_unique<RaBitQQuantizer<DataType>>();
     quantizer_->load(reader);
 
+    deleted_ = DynamicBitset(capacity_);
+    delete_cnt_ = 0;
+    IDType saved_delete_cnt = 0;
+    if (reader.read(reinterpret_cast<char *>(&saved_delete_cnt), sizeof(saved_delete_cnt))) {
+      for (IDType i = 0; i < saved_delete_cnt; ++i) {
+        IDType id = 0;
+        reader.read(reinterpret_cast<char *>(&id), sizeof(id));
+        if (!reader || id >= item_cnt_) {
+          throw std::runtime_error("RaBitQSpace: corrupt tombstone list in " +
+                                   std::string(filename));
+        }
+        deleted_.set(id);
+      }
+      delete_cnt_ = saved_delete_cnt;
+    }
+
+    if (bits_ > 1) {
+      rotated_centroid_.assign(get_padded_dim(), 0);
+      reader.read(reinterpret_cast<char *>(rotated_centroid_.data()),
+                  static_cast<std::streamsize>(rotated_centroid_.size() * sizeof(DataType)));
+      raw_storage_ = StaticStorage<>(std::vector<size_t>{capacity_, dim_ * sizeof(DataType)});
+      reader.read(reinterpret_cast<char *>(raw_storage_.data()),
+                  static_cast<std::streamsize>(dim_ * sizeof(DataType) * item_cnt_));
+      if (!reader) {
+        throw std::runtime_error("RaBitQSpace: truncated extended-code data in " +
+                                 std::string(filename));
+      }
+    }
+
     LOG_INFO("RaBitQSpace is successfully loaded from {}", filename);
   }
 
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #pragma once
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
@@ -12,13 +13,17 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include "../utils/prefetch.hpp"
+#include "simd/distance_batch.hpp"
 #include "simd/distance_ip.hpp"
 #include "simd/distance_l2.hpp"
+#include "simd/kernel_tuner.hpp"
 #include "space_concepts.hpp"
 #include "storage/rocksdb_storage.hpp"
 #include "storage/sequential_storage.hpp"
 #include "utils/data_utils.hpp"
+#include "utils/half.hpp"
 #include "utils/log.hpp"
 #include "utils/math.hpp"
 #include "utils/metadata_filter.hpp"
@@ -54,6 +59,7 @@ class RawSpace {
   using DistanceTypeAlias = DistanceType;
 
   DistFunc<DistDataType, DistanceType> distance_calu_func_;  ///< Distance calculation function
+  simd::L2SqrBatchFunc batch_func_ = nullptr;  ///< FP32 batch kernel of QueryComputer::compute()
 
   IDType capacity_{0};                 ///< The maximum number of data points (nodes)
   uint32_t dim_{0};                    ///< Dimensionality of the data points
@@ -85,9 +91,10 @@ class RawSpace {
 
     data_storage_.init(data_size_, capacity);
 
-    if constexpr (!(std::is_same_v<DataType, float> || std::is_same_v<DataType, double>)) {
+    if constexpr (!(std::is_same_v<DataType, float> || std::is_same_v<DataType, double> ||
+                    std::is_same_v<DataType, fp16> || std::is_same_v<DataType, bf16>)) {
       if (metric_ == MetricType::COS) {
-        LOG_ERROR("COS metric only support float or double");
+        LOG_ERROR("COS metric only support float, double, fp16 or bf16");
         exit(-1);
       }
     }
@@ -121,6 +128,16 @@ class RawSpace {
       default:
         break;
     }
+    // FP32 spaces bind the kernels directly, tuned for dim_ under the autotune dispatch policy
+    if constexpr (std::is_same_v<DataType, float> && std::is_same_v<DistanceType, float>) {
+      if (metric_ == MetricType::L2) {
+        distance_calu_func_ = simd::tune_l2_sqr_func(dim_);
+        batch_func_ = simd::tune_l2_sqr_batch4_func(dim_);
+      } else {
+        distance_calu_func_ = simd::tune_ip_sqr_func(dim_);
+        batch_func_ = simd::tune_ip_sqr_batch4_func(dim_);
+      }
+    }
   }
 
   /**
@@ -383,6 +400,7 @@ class RawSpace {
       scalar_storage_ = std::make_unique<RocksDBStorage<IDType>>(config_);
     }
     data_storage_.load(reader);
+    set_metric_function();
     LOG_INFO("RawSpace is loaded from {}", filename);
   }
 
@@ -412,6 +430,7 @@ class RawSpace {
   struct QueryComputer {
     const RawSpace &distance_space_;
     DataType *query_ = nullptr;
+    bool owns_query_ = true;
 
     /**
      * @brief Construct a new QueryComputer object
@@ -425,6 +444,17 @@ class RawSpace {
       std::memcpy(query_, query, distance_space.data_size_);
     }
 
+    /**
+     * @brief Construct a QueryComputer that stages the query in a caller-owned buffer
+     * @param buffer kAlignment-aligned, at least get_query_buffer_size() bytes; must outlive this
+     */
+    QueryComputer(const RawSpace &distance_space, const DataType *query, void *buffer)
+        : distance_space_(distance_space),
+          query_(static_cast<DataType *>(buffer)),
+          owns_query_(false) {
+      std::memcpy(query_, query, distance_space.data_size_);
+    }
+
     QueryComputer(const RawSpace &distance_space, const IDType id)
         : distance_space_(distance_space) {
       size_t aligned_size = math::round_up_pow2(distance_space_.data_size_, kAlignment);
@@ -436,7 +466,7 @@ class RawSpace {
      * @brief Destructor
      */
     ~QueryComputer() {
-      if (query_ != nullptr) {
+      if (query_ != nullptr && owns_query_) {
         alaya_aligned_free_impl(query_);
       }
     }
@@ -454,6 +484,46 @@ class RawSpace {
                                                  distance_space_.get_data_by_id(u),
                                                  distance_space_.dim_);
     }
+
+    /**
+     * @brief Compute the distances between the query and `n` data points
+     *
+     * FP32 spaces evaluate simd::kDistanceBatchWidth rows per kernel call and prefetch the next
+     * group while the current one is computed; other element types fall back to operator().
+     * @param ids IDs of the data points; invalid (deleted) IDs yield the max float
+     * @param n Number of IDs
+     * @param out Output array of `n` distances
+     */
+    void compute(const IDType *ids, size_t n, DistanceType *out) const {
+      if constexpr (std::is_same_v<DataType, float> && std::is_same_v<DistanceType, float>) {
+        constexpr size_t kWidth = simd::kDistanceBatchWidth;
+        const auto &sp = distance_space_;
+        const auto batch_func = sp.batch_func_;
+        const auto lines = static_cast<uint32_t>(math::round_up_pow2(sp.data_size_, 64) / 64);
+        const float *rows[kWidth];
+        float dists[kWidth];
+        for (size_t i = 0; i < n; i += kWidth) {
+          const size_t count = std::min(kWidth, n - i);
+          for (size_t j = i + kWidth; j < std::min(i + 2 * kWidth, n); ++j) {
+            mem_prefetch_l1(sp.get_data_by_id(ids[j]), lines);
+          }
+          // Invalid IDs and the padding of a short group score the query against itself
+          for (size_t j = 0; j < kWidth; ++j) {
+            rows[j] = j < count && sp.data_storage_.is_valid(ids[i + j])
+                          ? sp.get_data_by_id(ids[i + j])
+                          : query_;
+          }
+          batch_func(query_, rows, sp.dim_, dists);
+          for (size_t j = 0; j < count; ++j) {
+            out[i + j] = rows[j] == query_ ? std::numeric_limits<float>::max() : dists[j];
+          }
+        }
+      } else {
+        for (size_t i = 0; i < n; ++i) {
+          out[i] = (*this)(ids[i]);
+        }
+      }
+    }
   };
 
   /**
@@ -470,6 +540,18 @@ class RawSpace {
 
   auto get_query_computer(const DataType *query) { return QueryComputer(*this, query); }
 
+  /**
+   * @brief Like get_query_computer(query), but stages the query in `buffer` instead of allocating
+   * @param buffer kAlignment-aligned scratch of at least get_query_buffer_size() bytes
+   */
+  auto get_query_computer(const DataType *query, void *buffer) {
+    return QueryComputer(*this, query, buffer);
+  }
+
+  auto get_query_buffer_size() const -> size_t {
+    return math::round_up_pow2(data_size_, kAlignment);
+  }
+
   auto get_query_computer(IDType id) { return QueryComputer(*this, id); }
 
   /**
@@ -15,9 +15,12 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include "quant/sq4.hpp"
+#include "simd/distance_batch.hpp"
 #include "simd/distance_ip.hpp"
 #include "simd/distance_l2.hpp"
+#include "simd/kernel_tuner.hpp"
 #include "space_concepts.hpp"
 #include "storage/rocksdb_storage.hpp"
 #include "storage/sequential_storage.hpp"
@@ -59,6 +62,10 @@ class SQ4Space {
 
   using DistDataType = DataType;  ///< Type alias for the data type used in distance calculations
 
+  /// QueryComputer::compute() runs the batch kernels, which work on a float-decoded query
+  static constexpr bool kDecodeQuery =
+      std::is_same_v<DataType, float> && std::is_same_v<DistanceType, float>;
+
   /**
    * @brief Construct an empty SQ4Space object without parameter for loading.
    *
@@ -109,6 +116,15 @@ class SQ4Space {
       default:
         break;
     }
+    if constexpr (kDecodeQuery) {
+      if (metric_ == MetricType::L2) {
+        distance_calu_func_ = simd::tune_l2_sqr_sq4_func(dim_);
+        l2_batch_func_ = simd::tune_l2_sqr_sq4_batch4_func(dim_);
+      } else {
+        distance_calu_func_ = simd::tune_ip_sqr_sq4_func(dim_);
+        dot_batch_func_ = simd::tune_dot_sq4_batch4_func(dim_);
+      }
+    }
   }
 
   /**
@@ -266,7 +282,7 @@ class SQ4Space {
    * @brief Get the quantizer
    * @return quantizer
    */
-  auto get_quantizer() const -> SQ4Quantizer<DataType> { return quantizer_; }
+  auto get_quantizer() const -> const SQ4Quantizer<DataType> & { return quantizer_; }
 
   /**
    * @brief Insert a data point into the space. The data point will be quantized and stored in the
@@ -362,6 +378,7 @@ class SQ4Space {
 
     data_storage_.load(reader);
     quantizer_.load(reader);
+    set_metric_function();
     LOG_INFO("SQ4Space is loaded from {}", filename);
   }
 
@@ -393,7 +410,11 @@ class SQ4Space {
 
   struct QueryComputer {
     const SQ4Space &distance_space_;
-    uint8_t *query_;
+    uint8_t *query_ = nullptr;
+    bool owns_query_ = true;
+    float *decoded_ = nullptr;  ///< Decoded query for compute(), stored after the code in query_
+    float *scale_ = nullptr;    ///< Per-dimension dequantization step, same layout as decoded_
+    float ip_bias_ = 0.0F;      ///< sum(value * min) of the query, added back for IP / COS
 
     /**
      * @brief Construct a new QueryComputer object
@@ -402,23 +423,37 @@ class SQ4Space {
      */
     QueryComputer(const SQ4Space &distance_space, const DataType *query)
         : distance_space_(distance_space) {
-      size_t aligned_size = math::round_up_pow2(distance_space_.get_data_size(), 64);
-      query_ = static_cast<uint8_t *>(alaya_aligned_alloc_impl(aligned_size, 64));
+      query_ = static_cast<uint8_t *>(
+          alaya_aligned_alloc_impl(distance_space_.get_query_buffer_size(), 64));
+      distance_space.get_quantizer().encode(query, query_);
+      decode_query();
+    }
+
+    /**
+     * @brief Construct a QueryComputer that encodes the query into a caller-owned buffer
+     * @param buffer 64-byte aligned, at least get_query_buffer_size() bytes; must outlive this
+     */
+    QueryComputer(const SQ4Space &distance_space, const DataType *query, void *buffer)
+        : distance_space_(distance_space),
+          query_(static_cast<uint8_t *>(buffer)),
+          owns_query_(false) {
       distance_space.get_quantizer().encode(query, query_);
+      decode_query();
     }
 
     QueryComputer(const SQ4Space &distance_space, const IDType id)
         : distance_space_(distance_space) {
-      size_t aligned_size = math::round_up_pow2(distance_space_.get_data_size(), 64);
-      query_ = static_cast<uint8_t *>(alaya_aligned_alloc_impl(aligned_size, 64));
+      query_ = static_cast<uint8_t *>(
+          alaya_aligned_alloc_impl(distance_space_.get_query_buffer_size(), 64));
       std::memcpy(query_, distance_space_.get_data_by_id(id), distance_space_.get_data_size());
+      decode_query();
     }
 
     /**
      * @brief Destructor
      */
     ~QueryComputer() {
-      if (query_ != nullptr) {
+      if (query_ != nullptr && owns_query_) {
         alaya_aligned_free_impl(query_);
       }
     }
@@ -435,6 +470,81 @@ class SQ4Space {
                                                  distance_space_.get_quantizer().get_min(),
                                                  distance_space_.get_quantizer().get_max());
     }
+
+    /**
+     * @brief Compute the distances between the query and `n` data points
+     *
+     * FP32 spaces run the SQ4 batch kernels on the decoded query, simd::kDistanceBatchWidth rows
+     * per call, and prefetch the next group while the current one is computed; other element
+     * types fall back to operator().
+     * @param ids IDs of the data points
+     * @param n Number of IDs
+     * @param out Output array of `n` distances
+     */
+    void compute(const IDType *ids, size_t n, DistanceType *out) const {
+      if constexpr (kDecodeQuery) {
+        constexpr size_t kWidth = simd::kDistanceBatchWidth;
+        const auto &sp = distance_space_;
+        const bool is_l2 = sp.metric_ == MetricType::L2;
+        const auto l2_func = sp.l2_batch_func_;
+        const auto dot_func = sp.dot_batch_func_;
+        const auto lines = static_cast<uint32_t>(math::round_up_pow2(sp.data_size_, 64) / 64);
+        const uint8_t *rows[kWidth];
+        float dists[kWidth];
+        for (size_t i = 0; i < n; i += kWidth) {
+          const size_t count = std::min(kWidth, n - i);
+          for (size_t j = i + kWidth; j < std::min(i + 2 * kWidth, n); ++j) {
+            mem_prefetch_l1(sp.get_data_by_id(ids[j]), lines);
+          }
+          // A short group repeats its last row to fill the batch
+          for (size_t j = 0; j < kWidth; ++j) {
+            rows[j] = sp.get_data_by_id(ids[i + std::min(j, count - 1)]);
+          }
+          if (is_l2) {
+            l2_func(decoded_, scale_, rows, sp.dim_, dists);
+            std::copy(dists, dists + count, out + i);
+          } else {
+            dot_func(decoded_, rows, sp.dim_, dists);
+            for (size_t j = 0; j < count; ++j) {
+              out[i + j] = -(ip_bias_ + dists[j]);
+            }
+          }
+        }
+      } else {
+        for (size_t i = 0; i < n; ++i) {
+          out[i] = (*this)(ids[i]);
+        }
+      }
+    }
+
+   private:
+    /// Dequantize the query code once, in the block-permuted order of the SQ4 batch kernels:
+    /// L2 keeps code * scale, IP keeps value * scale plus the constant sum(value * min).
+    void decode_query() {
+      if constexpr (kDecodeQuery) {
+        constexpr float kInv15 = 1.0F / 15.0F;
+        const auto &sp = distance_space_;
+        const size_t dim = sp.dim_;
+        const float *min = sp.quantizer_.get_min();
+        const float *max = sp.quantizer_.get_max();
+        decoded_ = reinterpret_cast<float *>(query_ + math::round_up_pow2(sp.get_data_size(), 64));
+        scale_ = decoded_ + math::round_up_pow2(dim, 16);
+        ip_bias_ = 0.0F;
+        for (size_t d = 0; d < dim; ++d) {
+          const size_t p = simd::sq4_batch_position(d, dim);
+          scale_[p] = (max[d] - min[d]) * kInv15;
+          const auto code = static_cast<float>((query_[d / 2] >> ((d % 2) * 4)) & 0x0F);
+          const float scaled = code * scale_[p];
+          if (sp.metric_ == MetricType::L2) {
+            decoded_[p] = scaled;
+          } else {
+            const float value = min[d] + scaled;
+            decoded_[p] = value * scale_[p];
+            ip_bias_ += value * min[d];
+          }
+        }
+      }
+    }
   };
 
   /**
@@ -451,6 +561,23 @@ class SQ4Space {
 
   auto get_query_computer(const DataType *query) { return QueryComputer(*this, query); }
 
+  /**
+   * @brief Like get_query_computer(query), but encodes the query into `buffer` instead of
+   * allocating
+   * @param buffer 64-byte aligned scratch of at least get_query_buffer_size() bytes
+   */
+  auto get_query_computer(const DataType *query, void *buffer) {
+    return QueryComputer(*this, query, buffer);
+  }
+
+  auto get_query_buffer_size() const -> size_t {
+    size_t bytes = math::round_up_pow2(get_data_size(), 64);
+    if constexpr (kDecodeQuery) {
+      bytes += 2 * math::round_up_pow2(dim_, 16) * sizeof(float);  // decoded query + scales
+    }
+    return bytes;
+  }
+
   auto get_query_computer(const IDType id) { return QueryComputer(*this, id); }
 
   /**
@@ -471,6 +598,8 @@ class SQ4Space {
   MetricType metric_{MetricType::L2};  ///< Metric type
 
   DistFuncSQ<DataType, DistanceType> distance_calu_func_;  ///< Distance calculation function
+  simd::L2SqrSq4BatchFunc l2_batch_func_ = nullptr;  ///< Batch kernels of QueryComputer::compute(),
+  simd::DotSq4BatchFunc dot_batch_func_ = nullptr;   ///< only the one for metric_ is bound
   uint32_t data_size_{0};                                  ///< Size of each data point in bytes
   IDType item_cnt_{0};                                     ///< Number of data points (nodes)
   IDType delete_cnt_{0};              ///< Number of deleted data points (nodes)
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: AGPL-3.0-only
 
 #pragma once
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
@@ -12,9 +13,12 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include "simd/distance_batch.hpp"
 #include "simd/distance_ip.hpp"
 #include "simd/distance_l2.hpp"
+#include "simd/kernel_tuner.hpp"
 #include "space/quant/sq8.hpp"
 #include "space_concepts.hpp"
 #include "storage/rocksdb_storage.hpp"
@@ -57,6 +61,10 @@ class SQ8Space {
 
   using DistDataType = DataType;
 
+  /// QueryComputer::compute() runs the batch kernels, which work on a float-decoded query
+  static constexpr bool kDecodeQuery =
+      std::is_same_v<DataType, float> && std::is_same_v<DistanceType, float>;
+
  public:
   /**
    * @brief Construct an empty SQ8Space object without parameter for loading.
@@ -108,6 +116,15 @@ class SQ8Space {
       default:
         break;
     }
+    if constexpr (kDecodeQuery) {
+      if (metric_ == MetricType::L2) {
+        distance_calu_func_ = simd::tune_l2_sqr_sq8_func(dim_);
+        l2_batch_func_ = simd::tune_l2_sqr_sq8_batch4_func(dim_);
+      } else {
+        distance_calu_func_ = simd::tune_ip_sqr_sq8_func(dim_);
+        dot_batch_func_ = simd::tune_dot_sq8_batch4_func(dim_);
+      }
+    }
   }
 
   /**
@@ -265,7 +282,7 @@ class SQ8Space {
    * @brief Get the quantizer
    * @return quantizer
    */
-  auto get_quantizer() const -> SQ8Quantizer<DataType> { return quantizer_; }
+  auto get_quantizer() const -> const SQ8Quantizer<DataType> & { return quantizer_; }
 
   /**
    * @brief Insert a data point into the space. The data point will be quantized and stored in the
@@ -361,6 +378,7 @@ class SQ8Space {
 
     data_storage_.load(reader);
     quantizer_.load(reader);
+    set_metric_function();
     LOG_INFO("SQ8Space is loaded from {}", filename);
   }
 
@@ -395,6 +413,14 @@ class SQ8Space {
   struct QueryComputer {
     const SQ8Space &distance_space_;
     uint8_t *query_ = nullptr;
+    bool owns_query_ = true;
+    float *decoded_ = nullptr;  ///< Decoded query for compute(), stored after the code in query_
+    float *scale_ = nullptr;    ///< Per-dimension dequantization step, same layout as decoded_
+    float ip_bias_ = 0.0F;      ///< sum(value * min) of the query, added back for IP / COS
+    bool int_query_ = false;    ///< Score rows with the VNNI integer kernels (see quantize_query())
+    float int_scale_ = 0.0F;    ///< Converts the integer kernel result back to a float distance
+    int16_t *l2_weight_ = nullptr;  ///< L2: per-dimension scale^2 quantized to [0, 127]
+    int8_t *ip_weight_ = nullptr;   ///< IP: decoded_ quantized to int8
 
     /**
      * @brief Construct a new QueryComputer object
@@ -403,22 +429,36 @@ class SQ8Space {
      */
     QueryComputer(const SQ8Space &distance_space, const DataType *query)
         : distance_space_(distance_space) {
-      size_t aligned_size = math::round_up_pow2(distance_space_.get_data_size(), 64);
-      query_ = static_cast<uint8_t *>(alaya_aligned_alloc_impl(aligned_size, 64));
+      query_ = static_cast<uint8_t *>(
+          alaya_aligned_alloc_impl(distance_space_.get_query_buffer_size(), 64));
+      distance_space.get_quantizer().encode(query, query_);
+      decode_query();
+    }
+
+    /**
+     * @brief Construct a QueryComputer that encodes the query into a caller-owned buffer
+     * @param buffer 64-byte aligned, at least get_query_buffer_size() bytes; must outlive this
+     */
+    QueryComputer(const SQ8Space &distance_space, const DataType *query, void *buffer)
+        : distance_space_(distance_space),
+          query_(static_cast<uint8_t *>(buffer)),
+          owns_query_(false) {
       distance_space.get_quantizer().encode(query, query_);
+      decode_query();
     }
 
     QueryComputer(const SQ8Space &distance_space, const IDType id)
         : distance_space_(distance_space) {
-      size_t aligned_size = math::round_up_pow2(distance_space_.get_data_size(), 64);
-      query_ = static_cast<uint8_t *>(alaya_aligned_alloc_impl(aligned_size, 64));
+      query_ = static_cast<uint8_t *>(
+          alaya_aligned_alloc_impl(distance_space_.get_query_buffer_size(), 64));
       std::memcpy(query_, distance_space_.get_data_by_id(id), distance_space_.get_data_size());
+      decode_query();
     }
     /**
      * @brief Destructor
      */
     ~QueryComputer() {
-      if (query_ != nullptr) {
+      if (query_ != nullptr && owns_query_) {
         alaya_aligned_free_impl(query_);
       }
     }
@@ -429,12 +469,139 @@ class SQ8Space {
      * @return The calculated distance
      */
     auto operator()(IDType u) const -> DistanceType {
+      if (int_query_) {
+        return int_distance(distance_space_.get_data_by_id(u));
+      }
       return distance_space_.distance_calu_func_(query_,
                                                  distance_space_.get_data_by_id(u),
                                                  distance_space_.get_dim(),
                                                  distance_space_.get_quantizer().get_min(),
                                                  distance_space_.get_quantizer().get_max());
     }
+
+    /**
+     * @brief Compute the distances between the query and `n` data points
+     *
+     * FP32 spaces run the SQ8 batch kernels on the decoded query, simd::kDistanceBatchWidth rows
+     * per call, and prefetch the next group while the current one is computed. When
+     * simd::use_sq8_int8_query() opts in, rows are scored one by one against the
+     * integer-quantized query instead; other element types fall back to operator().
+     * @param ids IDs of the data points
+     * @param n Number of IDs
+     * @param out Output array of `n` distances
+     */
+    void compute(const IDType *ids, size_t n, DistanceType *out) const {
+      if constexpr (kDecodeQuery) {
+        constexpr size_t kWidth = simd::kDistanceBatchWidth;
+        const auto &sp = distance_space_;
+        const auto lines = static_cast<uint32_t>(math::round_up_pow2(sp.data_size_, 64) / 64);
+        if (int_query_) {
+          for (size_t i = 0; i < n; ++i) {
+            if (i + kWidth < n) {
+              mem_prefetch_l1(sp.get_data_by_id(ids[i + kWidth]), lines);
+            }
+            out[i] = int_distance(sp.get_data_by_id(ids[i]));
+          }
+          return;
+        }
+        const bool is_l2 = sp.metric_ == MetricType::L2;
+        const auto l2_func = sp.l2_batch_func_;
+        const auto dot_func = sp.dot_batch_func_;
+        const uint8_t *rows[kWidth];
+        float dists[kWidth];
+        for (size_t i = 0; i < n; i += kWidth) {
+          const size_t count = std::min(kWidth, n - i);
+          for (size_t j = i + kWidth; j < std::min(i + 2 * kWidth, n); ++j) {
+            mem_prefetch_l1(sp.get_data_by_id(ids[j]), lines);
+          }
+          // A short group repeats its last row to fill the batch
+          for (size_t j = 0; j < kWidth; ++j) {
+            rows[j] = sp.get_data_by_id(ids[i + std::min(j, count - 1)]);
+          }
+          if (is_l2) {
+            l2_func(decoded_, scale_, rows, sp.dim_, dists);
+            std::copy(dists, dists + count, out + i);
+          } else {
+            dot_func(decoded_, rows, sp.dim_, dists);
+            for (size_t j = 0; j < count; ++j) {
+              out[i + j] = -(ip_bias_ + dists[j]);
+            }
+          }
+        }
+      } else {
+        for (size_t i = 0; i < n; ++i) {
+          out[i] = (*this)(ids[i]);
+        }
+      }
+    }
+
+   private:
+    auto int_distance(const uint8_t *row) const -> DistanceType {
+      const auto &sp = distance_space_;
+      if (sp.metric_ == MetricType::L2) {
+        auto sum = simd::get_l2_sqr_sq8_weighted_func()(query_, row, l2_weight_, sp.dim_);
+        return int_scale_ * static_cast<float>(sum);
+      }
+      auto dot = simd::get_dot_sq8_int8_func()(row, ip_weight_, sp.dim_);
+      return -(ip_bias_ + int_scale_ * static_cast<float>(dot));
+    }
+
+    /// Quantize the decoded query to integers once, so rows are scored with vpdpwssd / vpdpbusd:
+    ///   L2: sum(scale^2 * (code - row)^2) ~= int_scale_ * sum(l2_weight_ * (code - row)^2)
+    ///   IP: sum(decoded_ * row)           ~= int_scale_ * sum(ip_weight_ * row)
+    /// Each weight keeps 7 bits relative to the largest one, so a dimension much narrower than
+    /// the widest rounds toward 0; that is why the path is opt-in (simd::use_sq8_int8_query()).
+    void quantize_query() {
+      const auto &sp = distance_space_;
+      const size_t dim = sp.dim_;
+      const bool is_l2 = sp.metric_ == MetricType::L2;
+      float max_weight = 0.0F;
+      for (size_t d = 0; d < dim; ++d) {
+        max_weight = std::max(max_weight, is_l2 ? scale_[d] * scale_[d] : std::abs(decoded_[d]));
+      }
+      int_scale_ = max_weight / static_cast<float>(simd::kSq8L2WeightMax);
+      const float inv = max_weight > 0.0F ? 1.0F / int_scale_ : 0.0F;
+      for (size_t d = 0; d < dim; ++d) {
+        if (is_l2) {
+          l2_weight_[d] = static_cast<int16_t>(std::lround(scale_[d] * scale_[d] * inv));
+        } else {
+          ip_weight_[d] = static_cast<int8_t>(std::lround(decoded_[d] * inv));
+        }
+      }
+      int_query_ = true;
+    }
+
+    /// Dequantize the query code once (in dimension order) for the batch kernels:
+    /// L2 keeps code * scale, IP keeps value * scale plus the constant sum(value * min).
+    void decode_query() {
+      if constexpr (kDecodeQuery) {
+        constexpr float kInv255 = 1.0F / 255.0F;
+        const auto &sp = distance_space_;
+        const size_t dim = sp.dim_;
+        const float *min = sp.quantizer_.get_min();
+        const float *max = sp.quantizer_.get_max();
+        decoded_ = reinterpret_cast<float *>(query_ + math::round_up_pow2(sp.get_data_size(), 64));
+        scale_ = decoded_ + math::round_up_pow2(dim, 16);
+        ip_bias_ = 0.0F;
+        for (size_t d = 0; d < dim; ++d) {
+          const size_t p = d;
+          scale_[p] = (max[d] - min[d]) * kInv255;
+          const float scaled = static_cast<float>(query_[d]) * scale_[p];
+          if (sp.metric_ == MetricType::L2) {
+            decoded_[p] = scaled;
+          } else {
+            const float value = min[d] + scaled;
+            decoded_[p] = value * scale_[p];
+            ip_bias_ += value * min[d];
+          }
+        }
+        if (simd::use_sq8_int8_query()) {
+          l2_weight_ = reinterpret_cast<int16_t *>(scale_ + math::round_up_pow2(dim, 16));
+          ip_weight_ = reinterpret_cast<int8_t *>(l2_weight_);
+          quantize_query();
+        }
+      }
+    }
   };
 
   /**
@@ -451,6 +618,24 @@ class SQ8Space {
 
   auto get_query_computer(const DataType *query) { return QueryComputer(*this, query); }
 
+  /**
+   * @brief Like get_query_computer(query), but encodes the query into `buffer` instead of
+   * allocating
+   * @param buffer 64-byte aligned scratch of at least get_query_buffer_size() bytes
+   */
+  auto get_query_computer(const DataType *query, void *buffer) {
+    return QueryComputer(*this, query, buffer);
+  }
+
+  auto get_query_buffer_size() const -> size_t {
+    size_t bytes = math::round_up_pow2(get_data_size(), 64);
+    if constexpr (kDecodeQuery) {
+      bytes += 2 * math::round_up_pow2(dim_, 16) * sizeof(float);  // decoded query + scales
+      bytes += math::round_up_pow2(dim_, 32) * sizeof(int16_t);     // integer query weights
+    }
+    return bytes;
+  }
+
   auto get_query_computer(const IDType id) { return QueryComputer(*this, id); }
 
   /**
@@ -471,6 +656,8 @@ class SQ8Space {
   MetricType metric_{MetricType::L2};  ///< Metric type
 
   DistFuncSQ<DataType, DistanceType> distance_calu_func_;  ///< Distance calculation function
+  simd::L2SqrSq8BatchFunc l2_batch_func_ = nullptr;  ///< Batch kernels of QueryComputer::compute(),
+  simd::DotSq8BatchFunc dot_batch_func_ = nullptr;   ///< only the one for metric_ is bound
   uint32_t data_size_{0};                                  ///< Size of each data point in bytes
   IDType item_cnt_{0};                                     ///< Number of data points (nodes)
   IDType delete_cnt_{0};              ///< Number of deleted data points (nodes)
@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+namespace alaya {
+
+/**
+ * @brief IEEE 754 binary16 storage type.
+ *
+ * A plain 16-bit wrapper rather than _Float16 so it compiles on every toolchain the repo
+ * supports; arithmetic happens in float, which is also what the SIMD kernels accumulate in.
+ */
+struct fp16 {
+  uint16_t bits_ = 0;
+
+  constexpr fp16() = default;
+  explicit fp16(float value) : bits_(from_float(value)) {}
+
+  operator float() const { return to_float(bits_); }  // NOLINT(google-explicit-constructor)
+
+  static auto from_bits(uint16_t bits) -> fp16 {
+    fp16 h;
+    h.bits_ = bits;
+    return h;
+  }
+
+  static auto to_float(uint16_t h) -> float {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000U) << 16;
+    uint32_t exponent = (h >> 10) & 0x1FU;
+    uint32_t mantissa = h & 0x3FFU;
+    uint32_t bits = 0;
+    if (exponent == 0x1FU) {
+      bits = sign | 0x7F800000U | (mantissa << 13);  // inf / nan
+    } else if (exponent != 0) {
+      bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa != 0) {
+      // subnormal: normalize into a float exponent
+      exponent = 113;
+      while ((mantissa & 0x400U) == 0) {
+        mantissa <<= 1;
+        --exponent;
+      }
+      bits = sign | (exponent << 23) | ((mantissa & 0x3FFU) << 13);
+    } else {
+      bits = sign;
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // round to nearest even, overflow to inf
+  static auto from_float(float value) -> uint16_t {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000U);
+    uint32_t abs = bits & 0x7FFFFFFFU;
+    if (abs >= 0x7F800000U) {
+      return sign | (abs > 0x7F800000U ? 0x7E00U : 0x7C00U);
+    }
+    if (abs >= 0x477FF000U) {  // rounds past the largest finite half
+      return sign | 0x7C00U;
+    }
+    if (abs < 0x38800000U) {  // below the smallest normal half
+      if (abs < 0x33000000U) {
+        return sign;
+      }
+      uint32_t exponent = abs >> 23;
+      uint32_t mantissa = (abs & 0x7FFFFFU) | 0x800000U;
+      uint32_t shift = 126 - exponent;
+      uint32_t half = mantissa >> shift;
+      uint32_t rest = mantissa & ((1U << shift) - 1);
+      uint32_t midpoint = 1U << (shift - 1);
+      if (rest > midpoint || (rest == midpoint && (half & 1U) != 0)) {
+        ++half;
+      }
+      return sign | static_cast<uint16_t>(half);
+    }
+    uint32_t rounded = abs + 0xFFFU + ((abs >> 13) & 1U);
+    return sign | static_cast<uint16_t>((rounded - 0x38000000U) >> 13);
+  }
+};
+
+/**
+ * @brief bfloat16 storage type: the upper half of a float, so widening is a 16-bit shift.
+ */
+struct bf16 {
+  uint16_t bits_ = 0;
+
+  constexpr bf16() = default;
+  explicit bf16(float value) : bits_(from_float(value)) {}
+
+  operator float() const { return to_float(bits_); }  // NOLINT(google-explicit-constructor)
+
+  static auto from_bits(uint16_t bits) -> bf16 {
+    bf16 b;
+    b.bits_ = bits;
+    return b;
+  }
+
+  static auto to_float(uint16_t b) -> float {
+    uint32_t bits = static_cast<uint32_t>(b) << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  // round to nearest even, quieting nans
+  static auto from_float(float value) -> uint16_t {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7FFFFFFFU) > 0x7F800000U) {
+      return static_cast<uint16_t>((bits >> 16) | 0x40U);
+    }
+    bits += 0x7FFFU + ((bits >> 16) & 1U);
+    return static_cast<uint16_t>(bits >> 16);
+  }
+};
+
+static_assert(sizeof(fp16) == 2 && sizeof(bf16) == 2);
+
+}  // namespace alaya
@@ -44,6 +44,12 @@
     #define ALAYA_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx512dq")))
     #define ALAYA_TARGET_AVX512_BW __attribute__((target("avx512f,avx512bw")))
     #define ALAYA_TARGET_AVX2 __attribute__((target("avx2,fma")))
+    #define ALAYA_TARGET_AVX2_F16C __attribute__((target("avx2,fma,f16c")))
+    #define ALAYA_TARGET_AVX512_BF16 \
+      __attribute__((target("avx512f,avx512bw,avx512dq,avx512bf16")))
+    #define ALAYA_TARGET_AVX512_VNNI \
+      __attribute__((target("avx512f,avx512bw,avx512dq,avx512vnni")))
+    #define ALAYA_TARGET_AVX_VNNI __attribute__((target("avx2,fma,avxvnni")))
     #define ALAYA_TARGET_SSE4 __attribute__((target("sse4.1")))
     #define ALAYA_TARGET_SSE2 __attribute__((target("sse2")))  // Baseline for x86-64
   #else
@@ -51,6 +57,10 @@
     #define ALAYA_TARGET_AVX512
     #define ALAYA_TARGET_AVX512_BW
     #define ALAYA_TARGET_AVX2
+    #define ALAYA_TARGET_AVX2_F16C
+    #define ALAYA_TARGET_AVX512_BF16
+    #define ALAYA_TARGET_AVX512_VNNI
+    #define ALAYA_TARGET_AVX_VNNI
     #define ALAYA_TARGET_SSE4
     #define ALAYA_TARGET_SSE2
   #endif
@@ -71,6 +81,10 @@
   #define ALAYA_TARGET_AVX512
   #define ALAYA_TARGET_AVX512_BW
   #define ALAYA_TARGET_AVX2
+  #define ALAYA_TARGET_AVX2_F16C
+  #define ALAYA_TARGET_AVX512_BF16
+  #define ALAYA_TARGET_AVX512_VNNI
+  #define ALAYA_TARGET_AVX_VNNI
   #define ALAYA_TARGET_SSE4
   #define ALAYA_TARGET_SSE2
   #define ALAYA_NOINLINE __declspec(noinline)
@@ -85,6 +99,10 @@
   #define ALAYA_TARGET_AVX512
   #define ALAYA_TARGET_AVX512_BW
   #define ALAYA_TARGET_AVX2
+  #define ALAYA_TARGET_AVX2_F16C
+  #define ALAYA_TARGET_AVX512_BF16
+  #define ALAYA_TARGET_AVX512_VNNI
+  #define ALAYA_TARGET_AVX_VNNI
   #define ALAYA_TARGET_SSE4
   #define ALAYA_TARGET_SSE2
   #define ALAYA_NOINLINE
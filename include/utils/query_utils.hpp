@@ -277,10 +277,33 @@ class HierarchicalBitset {
 };
 
 /// todo test this class.
-template <typename DistanceType, typename IDType>
+/// `VisitedType` is DynamicBitset for a pool built per query; a pool kept across queries (see
+/// reset) uses EpochVisitedSet so starting the next query does not touch every node's marker.
+template <typename DistanceType, typename IDType, typename VisitedType = DynamicBitset>
 struct LinearPool {
   LinearPool(IDType n, int capacity) : nb_(n), capacity_(capacity), data_(capacity_ + 1), vis_(n) {}
 
+  /**
+   * @brief Empty the pool for a new query over `n` nodes with room for `capacity` candidates,
+   * keeping its allocations. The visited set is cleared in place when it already covers `n`
+   * nodes and regrown (to at least twice its size, so a growing index does not reallocate per
+   * query) otherwise.
+   */
+  void reset(IDType n, int capacity) {
+    nb_ = n;
+    size_ = 0;
+    cur_ = 0;
+    capacity_ = capacity;
+    if (data_.size() < capacity_ + 1) {
+      data_.resize(capacity_ + 1);
+    }
+    if (vis_.size() < static_cast<size_t>(n)) {
+      vis_ = VisitedType(std::max<size_t>(n, 2 * vis_.size()));
+    } else {
+      vis_.clear();
+    }
+  }
+
   auto find_bsearch(DistanceType dist) -> int {
     int l = 0;
     int r = size_;
@@ -356,7 +379,7 @@ struct LinearPool {
 
   size_t nb_, size_ = 0, cur_ = 0, capacity_;
   std::vector<Neighbor<IDType, DistanceType>, AlignedAlloc<Neighbor<IDType, DistanceType>>> data_;
-  DynamicBitset vis_;
+  VisitedType vis_;
 };
 
 }  // namespace alaya
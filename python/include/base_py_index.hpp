@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include "utils/metadata_filter.hpp"
 
@@ -67,6 +68,7 @@ class BasePyIndex {
                                           uint32_t topk,
                                           uint32_t ef,
                                           uint32_t num_threads) -> py::object = 0;
+  virtual auto set_search_cpus(const std::vector<uint32_t> &cpus) -> void = 0;
 
   virtual auto load(const std::string &index_path,
                     const std::string &data_path,
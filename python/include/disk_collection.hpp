@@ -78,20 +78,6 @@ inline auto index_type_from_string_strict(const std::string &s) -> DiskIndexType
                         supported);
 }
 
-inline auto metric_name(MetricType metric) -> std::string {
-  switch (metric) {
-    case MetricType::L2:
-      return "L2";
-    case MetricType::IP:
-      return "IP";
-    case MetricType::COS:
-      return "COS";
-    case MetricType::NONE:
-      return "NONE";
-  }
-  return "unknown";
-}
-
 inline auto is_finite_f64(double value) -> bool {
   uint64_t bits = 0;
   static_assert(sizeof(bits) == sizeof(value));
@@ -216,10 +202,6 @@ class PyDiskCollection {
     const auto parsed_index_type = index_type_from_string_strict(index_type);
     VamanaSegmentBuildParams vamana_params;
     if (parsed_index_type == DiskIndexType::Vamana) {
-      if (metric != MetricType::L2) {
-        throw py::value_error("DiskCollection: disk_vamana metric " + metric_name(metric) +
-                              " is not supported; Vamana v1 supports L2 only");
-      }
       vamana_params =
           validate_vamana_params(vamana_R, vamana_L, vamana_alpha, vamana_seed, vamana_num_threads);
     }
@@ -11,6 +11,7 @@
 #include <cassert>
 #include <cmath>
 #include <concepts>
+#include <coroutine>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
@@ -22,6 +23,7 @@
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <shared_mutex>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -111,6 +113,16 @@ class PyIndex : public BasePyIndex {
     }
   }
 
+  // RaBitQ spaces rewrite neighbor fast-scan blocks in place on insert/remove, so searches hold
+  // the reader side of the space's update guard. Take it after releasing the GIL.
+  auto search_read_guard() const -> std::shared_lock<std::shared_mutex> {
+    if constexpr (is_rabitq_space_v<SearchSpaceType>) {
+      return search_space_->read_guard();
+    } else {
+      return {};
+    }
+  }
+
   // todo: this cache may become a bottleneck under frequent thread-count changes.
   // Cache a thread pool per requested width to amortize batch-search setup.
   auto get_hybrid_batch_pool(uint32_t requested_threads) -> std::shared_ptr<alaya::ThreadPool> {
@@ -123,6 +135,25 @@ class PyIndex : public BasePyIndex {
     return hybrid_batch_pool_;
   }
 
+  // Persistent coroutine scheduler shared by batch_search calls of the same width, so a batch
+  // does not spawn and join its own workers. Workers are pinned only when the caller configured
+  // CPUs through set_search_cpus; otherwise the OS places them instead of every index piling onto
+  // CPUs 0..n-1.
+  auto get_search_scheduler(uint32_t requested_threads) -> std::shared_ptr<alaya::Scheduler> {
+    auto effective_threads = std::max<uint32_t>(1, requested_threads);
+    std::lock_guard<std::mutex> lock(search_scheduler_mutex_);
+    if (search_scheduler_ == nullptr || search_scheduler_->worker_count() != effective_threads) {
+      std::vector<CpuID> worker_cpus(effective_threads);
+      for (uint32_t i = 0; i < effective_threads; i++) {
+        worker_cpus[i] = search_cpus_.empty() ? i : search_cpus_[i % search_cpus_.size()];
+      }
+      search_scheduler_ =
+          std::make_shared<alaya::Scheduler>(worker_cpus, true, !search_cpus_.empty());
+      search_scheduler_->begin();
+    }
+    return search_scheduler_;
+  }
+
 #if defined(__linux__)
   // add coroutine support
   auto execute_hybrid_search_dispatch_task(const DataType *query,
@@ -321,6 +352,17 @@ class PyIndex : public BasePyIndex {
   }
 
   auto insert_nondurable(DataType *data, uint32_t ef, const ScalarData *scalar_data) -> IDType {
+    if constexpr (is_rabitq_space_v<SearchSpaceType>) {
+      // QG indexes keep their graph inside the space, which links new nodes itself
+      IDType inserted_id;
+      if constexpr (SearchSpaceType::has_scalar_data) {
+        inserted_id = search_space_->insert(data, scalar_data, ef);
+      } else {
+        inserted_id = search_space_->insert(data, nullptr, ef);
+      }
+      materialized_view_manager_.invalidate("insert");
+      return inserted_id;
+    }
     if (update_job_ == nullptr) {
       throw std::runtime_error("incremental updates are not supported for the current index type");
     }
@@ -347,6 +389,11 @@ class PyIndex : public BasePyIndex {
   }
 
   auto remove_nondurable(IDType id) -> void {
+    if constexpr (is_rabitq_space_v<SearchSpaceType>) {
+      search_space_->remove(id);
+      materialized_view_manager_.invalidate("remove");
+      return;
+    }
     if (update_job_ == nullptr) {
       throw std::runtime_error("incremental updates are not supported for the current index type");
     }
@@ -355,6 +402,11 @@ class PyIndex : public BasePyIndex {
   }
 
   auto remove_nondurable(const std::string &item_id) -> void {
+    if constexpr (is_rabitq_space_v<SearchSpaceType>) {
+      search_space_->remove(item_id);
+      materialized_view_manager_.invalidate("remove_by_item_id");
+      return;
+    }
     if (update_job_ == nullptr) {
       throw std::runtime_error("incremental updates are not supported for the current index type");
     }
@@ -601,11 +653,17 @@ class PyIndex : public BasePyIndex {
         search_space_ = std::make_shared<SearchSpaceType>(params_.capacity_,
                                                           data_dim_,
                                                           params_.metric_,
-                                                          rocksdb_config);
+                                                          rocksdb_config,
+                                                          RotatorType::FhtKacRotator,
+                                                          params_.rabitq_bits_);
         search_space_->fit(vectors_, data_size_, scalar_ptr);
       } else {
-        search_space_ =
-            std::make_shared<SearchSpaceType>(params_.capacity_, data_dim_, params_.metric_);
+        search_space_ = std::make_shared<SearchSpaceType>(params_.capacity_,
+                                                          data_dim_,
+                                                          params_.metric_,
+                                                          RocksDBConfig::default_config(),
+                                                          RotatorType::FhtKacRotator,
+                                                          params_.rabitq_bits_);
         search_space_->fit(vectors_, data_size_);
       }
       auto graph_builder = std::make_shared<QGBuilder<SearchSpaceType>>(search_space_);
@@ -903,6 +961,7 @@ class PyIndex : public BasePyIndex {
 
     {
       py::gil_scoped_release release;
+      auto guard = search_read_guard();
       if constexpr (is_rabitq_space_v<SearchSpaceType>) {
         search_job_->rabitq_search_solo(query_ptr, topk, result_ids.data(), ef);
       } else {
@@ -958,6 +1017,7 @@ class PyIndex : public BasePyIndex {
       std::vector<std::string> item_ids(topk);
       {
         py::gil_scoped_release release;
+        auto guard = search_read_guard();
         execute_hybrid_search_dispatch(query_ptr,
                                        result_ids.data(),
                                        search_info,
@@ -1011,6 +1071,7 @@ class PyIndex : public BasePyIndex {
                                                             std::vector<std::string>(topk));
       {
         py::gil_scoped_release release;
+        auto guard = search_read_guard();
         auto batch_pool = get_hybrid_batch_pool(num_threads);
         std::vector<std::future<void>> futures;
         futures.reserve(query_size);
@@ -1084,69 +1145,52 @@ class PyIndex : public BasePyIndex {
 
     auto *query_ptr = static_cast<DataType *>(queries.request().ptr);
 
-#if defined(__linux__)
-    std::vector<std::vector<IDType>> res_pool(query_size, std::vector<IDType>(topk));
+    // Each query writes its topk ids straight into its row of the returned array.
+    auto ret = py::array_t<IDType>({query_size, static_cast<size_t>(topk)});
+    auto ret_ptr = static_cast<IDType *>(ret.request().ptr);
 
+#if defined(__linux__)
     {
       py::gil_scoped_release release;
-      std::vector<CpuID> worker_cpus;
+      // held on this thread for the whole batch; the coroutines resume on scheduler workers
+      auto guard = search_read_guard();
       std::vector<coro::task<>> coros;
+      std::vector<std::coroutine_handle<>> handles;
 
-      worker_cpus.reserve(num_threads);
       coros.reserve(query_size);
+      handles.reserve(query_size);
 
-      for (uint32_t i = 0; i < num_threads; i++) {
-        worker_cpus.push_back(i);
-      }
-      auto scheduler = std::make_shared<alaya::Scheduler>(worker_cpus);
-      for (uint32_t i = 0; i < query_size; i++) {
+      for (size_t i = 0; i < query_size; i++) {
         auto cur_query = query_ptr + i * query_dim;
 
         if constexpr (is_rabitq_space_v<SearchSpaceType>) {
-          coros.emplace_back(search_job_->rabitq_search(cur_query, topk, res_pool[i].data(), ef));
+          coros.emplace_back(search_job_->rabitq_search(cur_query, topk, ret_ptr + i * topk, ef));
         } else {
           // search now handles rerank internally and returns topk results
-          coros.emplace_back(search_job_->search(cur_query, res_pool[i].data(), topk, ef));
+          coros.emplace_back(search_job_->search(cur_query, ret_ptr + i * topk, topk, ef));
         }
-
-        scheduler->schedule(coros.back().handle());
+        handles.push_back(coros.back().handle());
       }
-      scheduler->begin();
-      scheduler->join();
+      get_search_scheduler(num_threads)->run_batch(handles);
     }
-
-    auto ret = py::array_t<IDType>({query_size, static_cast<size_t>(topk)});
-    auto ret_ptr = static_cast<IDType *>(ret.request().ptr);
-    for (size_t i = 0; i < query_size; i++) {
-      std::copy(res_pool[i].begin(), res_pool[i].end(), ret_ptr + i * topk);
-    }
-    return ret;
 #else
-    std::vector<std::vector<IDType>> res_pool(query_size, std::vector<IDType>(topk));
-
     {
       py::gil_scoped_release release;
       LOG_INFO_ONCE(
           "search fallback: coroutine batch search is unavailable on this platform, using "
           "synchronous search path");
+      auto guard = search_read_guard();
       for (size_t i = 0; i < query_size; i++) {
         auto cur_query = query_ptr + i * query_dim;
         if constexpr (is_rabitq_space_v<SearchSpaceType>) {
-          search_job_->rabitq_search_solo(cur_query, topk, res_pool[i].data(), ef);
+          search_job_->rabitq_search_solo(cur_query, topk, ret_ptr + i * topk, ef);
         } else {
-          search_job_->search_solo(cur_query, res_pool[i].data(), topk, ef);
+          search_job_->search_solo(cur_query, ret_ptr + i * topk, topk, ef);
         }
       }
     }
-
-    auto ret = py::array_t<IDType>({query_size, static_cast<size_t>(topk)});
-    auto ret_ptr = static_cast<IDType *>(ret.request().ptr);
-    for (size_t i = 0; i < query_size; i++) {
-      std::copy(res_pool[i].begin(), res_pool[i].end(), ret_ptr + i * topk);
-    }
-    return ret;
-
 #endif
+    return ret;
   }
 
   auto batch_search_with_distance(py::array_t<DataType> queries,
@@ -1162,43 +1206,33 @@ class PyIndex : public BasePyIndex {
 
     auto *query_ptr = static_cast<DataType *>(queries.request().ptr);
 
-#if defined(__linux__)
-    // Arrays to store topk results (search now returns topk directly)
-    std::vector<std::vector<IDType>> topk_ids(query_size, std::vector<IDType>(topk));
-    std::vector<std::vector<DistanceType>> topk_dists(query_size, std::vector<DistanceType>(topk));
+    auto ret_id = py::array_t<IDType>({query_size, static_cast<size_t>(topk)});
+    auto ret_dist = py::array_t<DistanceType>({query_size, static_cast<size_t>(topk)});
+    auto ret_id_ptr = static_cast<IDType *>(ret_id.request().ptr);
+    auto ret_dist_ptr = static_cast<DistanceType *>(ret_dist.request().ptr);
 
+#if defined(__linux__)
     {
       py::gil_scoped_release release;
-      std::vector<CpuID> worker_cpus;
       std::vector<coro::task<>> coros;
+      std::vector<std::coroutine_handle<>> handles;
 
-      worker_cpus.reserve(num_threads);
       coros.reserve(query_size);
+      handles.reserve(query_size);
 
-      for (uint32_t i = 0; i < num_threads; i++) {
-        worker_cpus.push_back(i);
-      }
-      auto scheduler = std::make_shared<alaya::Scheduler>(worker_cpus);
-
-      for (uint32_t i = 0; i < query_size; i++) {
+      for (size_t i = 0; i < query_size; i++) {
         auto cur_query = query_ptr + i * query_dim;
         // search now handles rerank internally and returns topk results with distances
-        coros.emplace_back(
-            search_job_->search(cur_query, topk_ids[i].data(), topk_dists[i].data(), topk, ef));
-        scheduler->schedule(coros.back().handle());
+        coros.emplace_back(search_job_->search(cur_query,
+                                               ret_id_ptr + i * topk,
+                                               ret_dist_ptr + i * topk,
+                                               topk,
+                                               ef));
+        handles.push_back(coros.back().handle());
       }
-
-      scheduler->begin();
-      scheduler->join();
+      get_search_scheduler(num_threads)->run_batch(handles);
     }
-
-    auto ret_id = get_topk_array(topk_ids, topk);
-    auto ret_dist = get_topk_array(topk_dists, topk);
-    return py::make_tuple(ret_id, ret_dist);
 #else
-    std::vector<std::vector<IDType>> topk_ids(query_size, std::vector<IDType>(topk));
-    std::vector<std::vector<DistanceType>> topk_dists(query_size, std::vector<DistanceType>(topk));
-
     {
       py::gil_scoped_release release;
       LOG_INFO_ONCE(
@@ -1206,14 +1240,39 @@ class PyIndex : public BasePyIndex {
           "synchronous search path");
       for (size_t i = 0; i < query_size; i++) {
         auto cur_query = query_ptr + i * query_dim;
-        search_job_->search_solo(cur_query, topk_ids[i].data(), topk_dists[i].data(), topk, ef);
+        search_job_->search_solo(cur_query,
+                                 ret_id_ptr + i * topk,
+                                 ret_dist_ptr + i * topk,
+                                 topk,
+                                 ef);
       }
     }
-
-    auto ret_id = get_topk_array(topk_ids, topk);
-    auto ret_dist = get_topk_array(topk_dists, topk);
-    return py::make_tuple(ret_id, ret_dist);
 #endif
+    return py::make_tuple(ret_id, ret_dist);
+  }
+
+  /**
+   * @brief Pin the batch-search workers to `cpus` (worker i runs on cpus[i % cpus.size()]). An
+   * empty list restores the default of unpinned workers. Takes effect on the next batch.
+   */
+  auto set_search_cpus(const std::vector<uint32_t> &cpus) -> void override {
+    auto hw_threads = std::thread::hardware_concurrency();
+    for (auto cpu : cpus) {
+      if (hw_threads != 0 && cpu >= hw_threads) {
+        throw std::invalid_argument("set_search_cpus: cpu " + std::to_string(cpu) +
+                                    " out of range (hardware threads: " +
+                                    std::to_string(hw_threads) + ")");
+      }
+    }
+    std::shared_ptr<alaya::Scheduler> retired;
+    {
+      std::lock_guard<std::mutex> lock(search_scheduler_mutex_);
+      search_cpus_.assign(cpus.begin(), cpus.end());
+      retired = std::move(search_scheduler_);
+    }
+    // Joins the old workers outside the lock, after any in-flight batch releases its reference.
+    py::gil_scoped_release release;
+    retired.reset();
   }
 
   /**
@@ -1359,6 +1418,9 @@ class PyIndex : public BasePyIndex {
   std::mutex hybrid_batch_pool_mutex_;
   std::shared_ptr<alaya::ThreadPool> hybrid_batch_pool_{nullptr};
   uint32_t hybrid_batch_pool_threads_{0};
+  std::mutex search_scheduler_mutex_;
+  std::shared_ptr<alaya::Scheduler> search_scheduler_{nullptr};
+  std::vector<CpuID> search_cpus_;
   MaterializedViewManagerType materialized_view_manager_;
   std::unique_ptr<alaya::recovery::RecoveryManager> recovery_manager_{nullptr};
   uint64_t next_recovery_op_id_{1};
@@ -29,6 +29,7 @@ struct IndexParams {
   std::string rocksdb_path_ = "";            // Path for RocksDB storage (for scalar data)
   bool has_scalar_data_ = false;             // Whether to enable scalar data storage
   std::vector<std::string> indexed_fields_;  // Fields to create secondary indexes for
+  uint32_t rabitq_bits_ = 1;                 // Bits/dim of RaBitQ node codes (1 keeps raw vectors)
 
   IndexParams(IndexType index_type = IndexType::HNSW,  // NOLINT
               py::dtype data_type = py::dtype::of<float>(),
@@ -5,7 +5,8 @@ from alayalite._alayalitepy import diskann as _diskann_module  # type: ignore[at
 BuildParams = _diskann_module.BuildParams
 Index = _diskann_module.Index
 LoadParams = _diskann_module.LoadParams
+SearchIO = _diskann_module.SearchIO
 SearchParams = _diskann_module.SearchParams
 UpdateIO = _diskann_module.UpdateIO
 
-__all__ = ["BuildParams", "Index", "LoadParams", "SearchParams", "UpdateIO"]
+__all__ = ["BuildParams", "Index", "LoadParams", "SearchIO", "SearchParams", "UpdateIO"]
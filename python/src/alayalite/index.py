@@ -248,6 +248,15 @@ class Index:
         )
         return self.__index.batch_search_with_distance(queries, topk, ef_search, num_threads)
 
+    def set_search_cpus(self, cpus: List[int]) -> None:
+        """
+        Pin batch-search workers to the given CPU ids (worker i runs on cpus[i % len(cpus)]).
+        An empty list restores unpinned workers. The workers persist across batch_search calls;
+        the new placement applies from the next batch.
+        """
+        _assert(self.__index is not None, "Index is not init yet")
+        self.__index.set_search_cpus([int(cpu) for cpu in cpus])
+
     def get_dim(self):
         """
         Get the dimensionality of vectors stored in the index.
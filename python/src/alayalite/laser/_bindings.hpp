@@ -87,6 +87,19 @@ struct Index {
     index->set_params(ef_search, num_threads, beam_width);
   }
 
+  void set_io_backend(const std::string &backend, bool sqpoll, bool iopoll) const {
+    AlignedReaderOptions options;
+    if (backend == "uring") {
+      options.backend = AlignedReaderBackend::kUring;
+    } else if (backend != "default") {
+      throw py::value_error("Laser Index: io backend must be 'default' or 'uring', got '" +
+                            backend + "'");
+    }
+    options.sqpoll = sqpoll;
+    options.iopoll = iopoll;
+    index->set_io_backend(options);
+  }
+
   void build_index(const std::string &vamana_file,
                    const std::string &data_file,
                    size_t ef_indexing = 200,
@@ -155,6 +168,11 @@ inline void register_laser_module(py::module_ &m) {
            py::arg("ef_search") = 200,
            py::arg("num_threads") = 48,
            py::arg("beam_width") = 16)
+      .def("set_io_backend",
+           &Index::set_io_backend,
+           py::arg("backend") = "default",
+           py::arg("sqpoll") = false,
+           py::arg("iopoll") = false)
       .def("build_index",
            &Index::build_index,
            py::arg("vamana_file"),
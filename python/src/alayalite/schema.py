@@ -50,6 +50,7 @@ class IndexParams:
     rocksdb_path: str = ""  # Path for RocksDB storage (for scalar data)
     has_scalar_data: bool = False  # Whether to enable scalar data storage
     indexed_fields: list = None  # Fields to create secondary indexes for (for fast filtering)
+    rabitq_bits: int = 1  # Bits per dimension of RaBitQ node codes; >1 keeps raw vectors off the search path
 
     def index_path(self, folder_uri):
         return os.path.join(folder_uri, f"{self.index_type}_{self.metric}_{self.max_nbrs}.index")
@@ -90,7 +91,11 @@ class IndexParams:
         build_threads = valid_thread_count(self.build_threads)
         materialized_view_build_threads = valid_thread_count(self.materialized_view_build_threads)
 
-        return _IndexParams(
+        rabitq_bits = int(self.rabitq_bits)
+        if not 1 <= rabitq_bits <= 8:
+            raise ValueError(f"rabitq_bits must be in [1, 8], got {self.rabitq_bits}")
+
+        params = _IndexParams(
             index_type_=native_index_type,
             data_type_=native_data_type,
             id_type_=native_id_type,
@@ -104,6 +109,8 @@ class IndexParams:
             has_scalar_data_=self.has_scalar_data,
             indexed_fields_=self.indexed_fields if self.indexed_fields else [],
         )
+        params.rabitq_bits_ = rabitq_bits
+        return params
 
     def to_json_dict(self) -> dict:
         return {
@@ -119,6 +126,7 @@ class IndexParams:
             "rocksdb_path": self.rocksdb_path,
             "has_scalar_data": self.has_scalar_data,
             "indexed_fields": self.indexed_fields if self.indexed_fields else [],
+            "rabitq_bits": self.rabitq_bits,
         }
 
     @classmethod
@@ -137,6 +145,7 @@ class IndexParams:
             rocksdb_path=data.get("rocksdb_path", ""),
             has_scalar_data=data.get("has_scalar_data", False),  # Default to False for backward compatibility
             indexed_fields=data.get("indexed_fields", []),  # Default to empty list for backward compatibility
+            rabitq_bits=data.get("rabitq_bits", 1),
         )
 
     @classmethod
@@ -152,6 +161,7 @@ class IndexParams:
         materialized_view_build_threads = None
         rocksdb_path = ""
         indexed_fields = None
+        rabitq_bits = 1
 
         if kwargs.get("index_type") is not None:
             ind_type = kwargs.get("index_type")
@@ -181,6 +191,8 @@ class IndexParams:
             rocksdb_path = str(kwargs.get("rocksdb_path"))
         if kwargs.get("indexed_fields") is not None:
             indexed_fields = list(kwargs.get("indexed_fields"))
+        if kwargs.get("rabitq_bits") is not None:
+            rabitq_bits = int(kwargs.get("rabitq_bits"))
         return cls(
             index_type=index_type,
             data_type=data_type,
@@ -193,6 +205,7 @@ class IndexParams:
             materialized_view_build_threads=materialized_view_build_threads,
             rocksdb_path=rocksdb_path,
             indexed_fields=indexed_fields,
+            rabitq_bits=rabitq_bits,
         )
 
 
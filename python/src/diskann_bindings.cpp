@@ -7,6 +7,7 @@
 #include <cstring>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -43,12 +44,39 @@ uint32_t checked_u32(py::ssize_t value, const char *name) {
   return static_cast<uint32_t>(value);
 }
 
+// Per-point filter label lists flattened into the CSR view DiskANNIndex::build takes.
+struct FilterLabelsCSR {
+  std::vector<uint64_t> offsets;
+  std::vector<uint32_t> values;
+  FilterLabelsView view;
+
+  FilterLabelsCSR(const std::optional<std::vector<std::vector<uint32_t>>> &filter_labels,
+                  uint64_t count,
+                  const char *count_name) {
+    if (!filter_labels.has_value()) {
+      return;
+    }
+    if (filter_labels->size() != count) {
+      throw py::value_error(std::string("filter_labels length must match ") + count_name);
+    }
+    offsets.reserve(count + 1);
+    offsets.push_back(0);
+    for (const auto &point_labels : *filter_labels) {
+      values.insert(values.end(), point_labels.begin(), point_labels.end());
+      offsets.push_back(values.size());
+    }
+    view.offsets = offsets.data();
+    view.values = values.data();
+  }
+};
+
 class PyDiskANNIndex {
  public:
   static void build(const std::string &path,
                     const py::array &vectors,
                     const py::array &labels,
-                    const DiskANNBuildParams &params) {
+                    const DiskANNBuildParams &params,
+                    const std::optional<std::vector<std::vector<uint32_t>>> &filter_labels) {
     require_array(vectors, py::dtype::of<float>(), 2, "vectors");
     require_array(labels, py::dtype::of<uint64_t>(), 1, "labels");
     if (vectors.shape(0) == 0 || vectors.shape(1) == 0) {
@@ -61,8 +89,31 @@ class PyDiskANNIndex {
     const auto dim = static_cast<uint64_t>(vectors.shape(1));
     const auto *vector_data = static_cast<const float *>(vectors.data());
     const auto *label_data = static_cast<const uint64_t *>(labels.data());
+    FilterLabelsCSR filter_csr(filter_labels, count, "vectors rows");
     py::gil_scoped_release release;
-    DiskANNIndex::build(path, vector_data, label_data, count, dim, params);
+    DiskANNIndex::build(path, vector_data, label_data, count, dim, params, filter_csr.view);
+  }
+
+  static void build_from_file(
+      const std::string &path,
+      const std::string &data_path,
+      const std::optional<py::array> &labels,
+      const DiskANNBuildParams &params,
+      const std::optional<std::vector<std::vector<uint32_t>>> &filter_labels) {
+    uint32_t count = 0;
+    uint32_t dim = 0;
+    alaya::vamana::detail::read_fbin_header(data_path, count, dim);
+    const uint64_t *label_data = nullptr;
+    if (labels.has_value()) {
+      require_array(*labels, py::dtype::of<uint64_t>(), 1, "labels");
+      if (static_cast<uint64_t>(labels->shape(0)) != count) {
+        throw py::value_error("labels length must match the .fbin point count");
+      }
+      label_data = static_cast<const uint64_t *>(labels->data());
+    }
+    FilterLabelsCSR filter_csr(filter_labels, count, "the .fbin point count");
+    py::gil_scoped_release release;
+    DiskANNIndex::build(path, data_path, label_data, params, filter_csr.view);
   }
 
   static std::unique_ptr<PyDiskANNIndex> open(const std::string &path,
@@ -190,9 +241,16 @@ class PyDiskANNIndex {
     index_.flush();
   }
 
+  void save_adaptive_cache() {
+    py::gil_scoped_release release;
+    index_.save_adaptive_cache();
+  }
+
   uint64_t size() const { return index_.size(); }
   uint64_t dim() const { return index_.dim(); }
   bool updatable() const { return index_.updatable(); }
+  bool has_filter_labels() const { return index_.has_filter_labels(); }
+  uint64_t adaptive_cache_size() const { return index_.adaptive_cache_size(); }
 
  private:
   void require_vector(const py::array &vector, const char *name) const {
@@ -213,6 +271,10 @@ void register_diskann(py::module_ &module) {
       .value("URING", DiskANNUpdateIO::kUring)
       .value("BLOCKING", DiskANNUpdateIO::kBlocking);
 
+  py::enum_<DiskANNSearchIO>(module, "SearchIO")
+      .value("DEFAULT", DiskANNSearchIO::kDefault)
+      .value("URING", DiskANNSearchIO::kUring);
+
   py::class_<DiskANNBuildParams>(module, "BuildParams")
       .def(py::init<>())
       .def_readwrite("R", &DiskANNBuildParams::R)
@@ -224,7 +286,10 @@ void register_diskann(py::module_ &module) {
       .def_readwrite("num_threads", &DiskANNBuildParams::num_threads)
       .def_readwrite("pq_train_iters", &DiskANNBuildParams::pq_train_iters)
       .def_readwrite("seed", &DiskANNBuildParams::seed)
-      .def_readwrite("verbose", &DiskANNBuildParams::verbose);
+      .def_readwrite("verbose", &DiskANNBuildParams::verbose)
+      .def_readwrite("metric", &DiskANNBuildParams::metric)
+      .def_readwrite("ip_max_norm", &DiskANNBuildParams::ip_max_norm)
+      .def_readwrite("build_dram_budget_gb", &DiskANNBuildParams::build_dram_budget_gb);
 
   py::class_<DiskANNLoadParams>(module, "LoadParams")
       .def(py::init<>())
@@ -244,7 +309,13 @@ void register_diskann(py::module_ &module) {
       .def_readwrite("update_reconnect_threads", &DiskANNLoadParams::update_reconnect_threads)
       .def_readwrite("update_io", &DiskANNLoadParams::update_io)
       .def_readwrite("update_search_concurrency", &DiskANNLoadParams::update_search_concurrency)
-      .def_readwrite("search_page_cache", &DiskANNLoadParams::search_page_cache);
+      .def_readwrite("search_page_cache", &DiskANNLoadParams::search_page_cache)
+      .def_readwrite("search_io", &DiskANNLoadParams::search_io)
+      .def_readwrite("search_io_sqpoll", &DiskANNLoadParams::search_io_sqpoll)
+      .def_readwrite("search_io_iopoll", &DiskANNLoadParams::search_io_iopoll)
+      .def_readwrite("adaptive_cache_bytes", &DiskANNLoadParams::adaptive_cache_bytes)
+      .def_readwrite("adaptive_cache_warm_start",
+                     &DiskANNLoadParams::adaptive_cache_warm_start);
 
   py::class_<DiskANNSearchParams>(module, "SearchParams")
       .def(py::init<>())
@@ -252,7 +323,8 @@ void register_diskann(py::module_ &module) {
       .def_readwrite("use_pq", &DiskANNSearchParams::use_pq)
       .def_readwrite("rerank", &DiskANNSearchParams::rerank)
       .def_readwrite("rerank_count", &DiskANNSearchParams::rerank_count)
-      .def_readwrite("deterministic", &DiskANNSearchParams::deterministic);
+      .def_readwrite("deterministic", &DiskANNSearchParams::deterministic)
+      .def_readwrite("filter_labels", &DiskANNSearchParams::filter_labels);
 
   DiskANNLoadParams default_load_params;
   default_load_params.updatable = true;
@@ -262,7 +334,17 @@ void register_diskann(py::module_ &module) {
                   py::arg("path"),
                   py::arg("vectors"),
                   py::arg("external_ids"),
-                  py::arg("params") = DiskANNBuildParams{})
+                  py::arg("params") = DiskANNBuildParams{},
+                  py::kw_only(),
+                  py::arg("filter_labels") = std::nullopt)
+      .def_static("build_from_file",
+                  &PyDiskANNIndex::build_from_file,
+                  py::arg("path"),
+                  py::arg("data_path"),
+                  py::arg("external_ids") = std::nullopt,
+                  py::arg("params") = DiskANNBuildParams{},
+                  py::kw_only(),
+                  py::arg("filter_labels") = std::nullopt)
       .def_static("open",
                   &PyDiskANNIndex::open,
                   py::arg("path"),
@@ -290,9 +372,12 @@ void register_diskann(py::module_ &module) {
       .def("batch_remove", &PyDiskANNIndex::batch_remove, py::arg("external_ids"))
       .def("contains", &PyDiskANNIndex::contains, py::arg("external_id"))
       .def("flush", &PyDiskANNIndex::flush)
+      .def("save_adaptive_cache", &PyDiskANNIndex::save_adaptive_cache)
       .def_property_readonly("size", &PyDiskANNIndex::size)
       .def_property_readonly("dim", &PyDiskANNIndex::dim)
-      .def_property_readonly("updatable", &PyDiskANNIndex::updatable);
+      .def_property_readonly("updatable", &PyDiskANNIndex::updatable)
+      .def_property_readonly("has_filter_labels", &PyDiskANNIndex::has_filter_labels)
+      .def_property_readonly("adaptive_cache_size", &PyDiskANNIndex::adaptive_cache_size);
 }
 
 }  // namespace alaya::diskann::pybindings
@@ -165,7 +165,8 @@ PYBIND11_MODULE(_alayalitepy, m) {
                      &alaya::IndexParams::materialized_view_build_threads_)
       .def_readwrite("rocksdb_path_", &alaya::IndexParams::rocksdb_path_)
       .def_readwrite("has_scalar_data_", &alaya::IndexParams::has_scalar_data_)
-      .def_readwrite("indexed_fields_", &alaya::IndexParams::indexed_fields_);
+      .def_readwrite("indexed_fields_", &alaya::IndexParams::indexed_fields_)
+      .def_readwrite("rabitq_bits_", &alaya::IndexParams::rabitq_bits_);
 
   alaya::IndexParams default_param;
 
@@ -253,6 +254,9 @@ PYBIND11_MODULE(_alayalitepy, m) {
            py::arg("topk"),                                  //
            py::arg("ef"),                                    //
            py::arg("num_threads"))                           //
+      .def("set_search_cpus",                                //
+           &alaya::BasePyIndex::set_search_cpus,             //
+           py::arg("cpus"))                                  //
       .def("save",                                           //
            &alaya::BasePyIndex::save,                        //
            py::arg("index_path"),                            //
@@ -57,6 +57,24 @@ class TestAlayaLiteIndex(unittest.TestCase):
         recall = calc_recall(result, gt)
         self.assertGreaterEqual(recall, 0.9)
 
+    def test_repeated_batch_search_reuses_workers(self):
+        index = self.client.create_index()
+        vectors = np.random.rand(1000, 64).astype(np.float32)
+        queries = np.random.rand(8, 64).astype(np.float32)
+        index.fit(vectors)
+        gt = calc_gt(vectors, queries, 10)
+        for num_threads in (2, 2, 1, 2):
+            result = index.batch_search(queries, 10, num_threads=num_threads)
+            self.assertGreaterEqual(calc_recall(result, gt), 0.9)
+            ids, dists = index.batch_search_with_distance(queries, 10, num_threads=num_threads)
+            self.assertEqual(ids.shape, (8, 10))
+            self.assertEqual(dists.shape, (8, 10))
+
+        index.set_search_cpus([0])
+        self.assertGreaterEqual(calc_recall(index.batch_search(queries, 10, num_threads=2), gt), 0.9)
+        index.set_search_cpus([])
+        self.assertGreaterEqual(calc_recall(index.batch_search(queries, 10, num_threads=2), gt), 0.9)
+
 
 if __name__ == "__main__":
     unittest.main()
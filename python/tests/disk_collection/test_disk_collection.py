@@ -254,7 +254,7 @@ def test_disk_collection_open_missing_path_raises(tmp_path):
         DiskCollection.open(str(tmp_path / "definitely_missing"))
 
 
-def test_disk_collection_search_before_flush_returns_empty(tmp_path):
+def test_disk_collection_search_before_flush_sees_pending(tmp_path):
     path = str(tmp_path / "coll")
     col = DiskCollection(path=path, dim=4, metric=MetricType.L2, index_type="disk_flat")
     q = np.zeros(4, dtype=np.float32)
@@ -263,7 +263,7 @@ def test_disk_collection_search_before_flush_returns_empty(tmp_path):
 
     col.add(_rand_vectors(3, 4), _ids(3))
     hits2 = col.search(q, k=5)
-    assert hits2 == [], "pending must be excluded from search"
+    assert len(hits2) == 3, "pending rows must be searchable before flush"
 
 
 def test_disk_collection_size_excludes_pending(tmp_path):
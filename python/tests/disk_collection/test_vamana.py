@@ -166,11 +166,10 @@ def test_disk_vamana_duplicate_label_throws(tmp_path):
         vamana_R=16,
         vamana_L=32,
     )
-    col.add(vectors, ids)
-
     with pytest.raises(Exception) as exc_info:
-        col.flush()
+        col.add(vectors, ids)
     assert "duplicate" in str(exc_info.value).lower()
+    col.flush()
     assert not (tmp_path / "vamana" / "segments" / "seg_00000001").exists()
 
 
@@ -574,19 +573,26 @@ def test_concurrent_disk_vamana_search_results_are_stable(tmp_path):
 
 
 @pytest.mark.parametrize("metric, token", [(MetricType.IP, "IP"), (MetricType.COS, "COS")])
-def test_disk_vamana_unsupported_metric_if_applicable(tmp_path, metric, token):
+def test_disk_vamana_ip_and_cos_metrics(tmp_path, metric, token):
     path = tmp_path / f"vamana_{token.lower()}"
-    with pytest.raises(ValueError) as exc_info:
-        DiskCollection(
-            path=str(path),
-            dim=8,
-            metric=metric,
-            index_type="disk_vamana",
-        )
-    msg = str(exc_info.value)
-    assert token in msg
-    assert "supports L2 only" in msg
-    assert not path.exists()
+    col = DiskCollection(
+        path=str(path),
+        dim=8,
+        metric=metric,
+        index_type="disk_vamana",
+    )
+    vectors = _rand_vectors(200, 8, seed=7)
+    col.add(vectors, _ids(200, base=0))
+    col.flush()
+
+    query = vectors[3]
+    if metric == MetricType.COS:
+        scores = vectors @ query / np.linalg.norm(vectors, axis=1)
+    else:
+        scores = vectors @ query
+    expected = int(np.argmax(scores))
+    hits = col.search(query, k=1, ef=64)
+    assert hits[0][0] == expected
 
 
 @pytest.mark.skipif(
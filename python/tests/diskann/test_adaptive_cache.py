@@ -0,0 +1,41 @@
+"""Tests for the frequency-aware adaptive node cache of read-only DiskANN indexes."""
+
+import numpy as np
+import pytest
+from alayalite import diskann
+
+
+def _load_params(cache_bytes):
+    params = diskann.LoadParams()
+    params.updatable = False
+    params.adaptive_cache_bytes = cache_bytes
+    return params
+
+
+def test_adaptive_cache_persists_hot_set(tmp_path):
+    vectors = np.random.default_rng(5).random((1000, 16), dtype=np.float32)
+    external_ids = np.arange(1000, dtype=np.uint64)
+    diskann.Index.build(str(tmp_path), vectors, external_ids)
+
+    index = diskann.Index.open(str(tmp_path), _load_params(64 * 1024))
+    params = diskann.SearchParams()
+    params.use_pq = False
+    for _ in range(3):
+        labels, _ = index.search(vectors[7], 5, params)
+        assert labels[0] == 7
+    assert index.adaptive_cache_size > 0
+    index.save_adaptive_cache()
+    assert (tmp_path / "hot_cache_ids.bin").exists()
+
+    restarted = diskann.Index.open(str(tmp_path), _load_params(64 * 1024))
+    assert restarted.adaptive_cache_size == index.adaptive_cache_size
+
+
+def test_adaptive_cache_requires_read_only_load(tmp_path):
+    vectors = np.random.default_rng(6).random((100, 8), dtype=np.float32)
+    diskann.Index.build(str(tmp_path), vectors, np.arange(100, dtype=np.uint64))
+    params = _load_params(4096)
+    params.updatable = True
+    with pytest.raises(ValueError):
+        diskann.Index.open(str(tmp_path), params)
+    assert diskann.Index.open(str(tmp_path)).adaptive_cache_size == 0
@@ -0,0 +1,46 @@
+"""Tests for building a DiskANN index from an .fbin file under a DRAM budget."""
+
+import numpy as np
+import pytest
+from alayalite import diskann
+
+
+def _write_fbin(path, vectors):
+    with open(path, "wb") as out:
+        np.array(vectors.shape, dtype=np.uint32).tofile(out)
+        vectors.astype(np.float32).tofile(out)
+
+
+def _params(budget_gb):
+    params = diskann.BuildParams()
+    params.R = 24
+    params.L = 48
+    params.build_dram_budget_gb = budget_gb
+    return params
+
+
+@pytest.mark.parametrize("budget_gb", [0.0, 0.0003])
+def test_build_from_file_finds_nearest_neighbor(tmp_path, budget_gb):
+    # 0.0003 GiB is below the in-memory estimate for 2000 x 16, forcing the sharded build.
+    vectors = np.random.default_rng(3).random((2000, 16), dtype=np.float32)
+    data_path = tmp_path / "base.fbin"
+    _write_fbin(data_path, vectors)
+    diskann.Index.build_from_file(str(tmp_path / "index"), str(data_path), None, _params(budget_gb))
+    assert not (tmp_path / "index" / "build_work").exists()
+
+    index = diskann.Index.open(str(tmp_path / "index"))
+    params = diskann.SearchParams()
+    params.search_list_size = 64
+    params.use_pq = False
+    labels, _ = index.search(vectors[42], 5, params)
+    assert labels[0] == 42  # no external ids => row numbers
+
+
+def test_build_from_file_validates_external_ids(tmp_path):
+    vectors = np.random.default_rng(4).random((50, 8), dtype=np.float32)
+    data_path = tmp_path / "base.fbin"
+    _write_fbin(data_path, vectors)
+    with pytest.raises(ValueError, match="labels length"):
+        diskann.Index.build_from_file(
+            str(tmp_path / "index"), str(data_path), np.arange(10, dtype=np.uint64)
+        )
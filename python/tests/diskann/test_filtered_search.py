@@ -0,0 +1,48 @@
+"""Tests for label-filtered DiskANN search."""
+
+import numpy as np
+import pytest
+from alayalite import diskann
+
+
+def _build_index(path, filter_labels=None):
+    rng = np.random.default_rng(42)
+    vectors = rng.random((120, 16), dtype=np.float32)
+    external_ids = np.arange(2000, 2120, dtype=np.uint64)
+    build_params = diskann.BuildParams()
+    build_params.R = 16
+    build_params.L = 32
+    diskann.Index.build(str(path), vectors, external_ids, build_params, filter_labels=filter_labels)
+    return diskann.Index.open(str(path)), vectors
+
+
+def test_filtered_search_returns_only_matching_points(tmp_path):
+    # Point i carries tenant label i % 3; every tenth point also carries label 50.
+    filter_labels = [[i % 3] + ([50] if i % 10 == 0 else []) for i in range(120)]
+    index, vectors = _build_index(tmp_path / "index", filter_labels)
+    assert index.has_filter_labels
+
+    params = diskann.SearchParams()
+    params.search_list_size = 64
+    params.filter_labels = [50]
+    labels, _ = index.search(vectors[3], 5, params)
+    assert len(labels) == 5
+    assert all((label - 2000) % 10 == 0 for label in labels)
+
+    params.filter_labels = [1, 2]
+    labels, _ = index.search(vectors[0], 10, params)
+    assert all((label - 2000) % 3 != 0 for label in labels)
+
+
+def test_filter_labels_length_must_match_vectors(tmp_path):
+    with pytest.raises(ValueError, match="filter_labels"):
+        _build_index(tmp_path / "index", [[0]] * 5)
+
+
+def test_filtered_search_requires_labeled_index(tmp_path):
+    index, vectors = _build_index(tmp_path / "index")
+    assert not index.has_filter_labels
+    params = diskann.SearchParams()
+    params.filter_labels = [1]
+    with pytest.raises(ValueError):
+        index.search(vectors[0], 5, params)
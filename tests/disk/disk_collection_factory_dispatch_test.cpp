@@ -4,19 +4,24 @@
 
 #include <gtest/gtest.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <filesystem>  // NOLINT(build/c++17)
 #include <fstream>
+#include <map>
 #include <numeric>
+#include <optional>
 #include <random>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #include "index/disk/disk_collection.hpp"
 #include "index/disk/disk_flat_builder.hpp"
 #include "index/disk/disk_flat_searcher.hpp"
 #include "index/disk/segment_factory.hpp"
+#include "index/disk/segment_label_index.hpp"
 #include "index/disk/segment_manifest.hpp"
 #include "index/disk/types.hpp"
 #include "utils/metric_type.hpp"
@@ -183,11 +188,12 @@ TEST_F(DiskCollectionFactoryDispatchTest,
   auto col = DiskCollection::open(coll);
   EXPECT_EQ(col.size(), 1u);
 
-  // Attempt to flush a pending payload that collides with the existing label.
+  // Attempt to add a pending payload that collides with the existing label.
   std::vector<float> v(kDim, 0.0F);
   std::vector<uint64_t> l{42};
-  col.add_batch(v.data(), l.data(), 1);
-  EXPECT_THROW(col.flush(), std::invalid_argument);
+  EXPECT_THROW(col.add_batch(v.data(), l.data(), 1), std::invalid_argument);
+  EXPECT_EQ(col.pending_size(), 0u);
+  col.flush();
   // No new segment file appears.
   EXPECT_FALSE(std::filesystem::exists(coll / "segments" / "seg_00000002"));
 }
@@ -238,9 +244,8 @@ TEST_F(DiskCollectionFactoryDispatchTest,
   // inventory must walk every listed segment, not just the first.
   std::vector<float> v(kDim, 0.0F);
   std::vector<uint64_t> l{50};
-  col.add_batch(v.data(), l.data(), 1);
   try {
-    col.flush();
+    col.add_batch(v.data(), l.data(), 1);
     FAIL() << "expected throw on duplicate cross-segment label";
   } catch (const std::invalid_argument &e) {
     const std::string msg = e.what();
@@ -313,122 +318,264 @@ void seed_one_segment_collection(const std::filesystem::path &coll, uint32_t dim
 
 }  // namespace
 
-// These tests must corrupt the ids file AFTER DiskCollection::open succeeds.
-// The DiskFlatSegmentSearcher constructor (invoked by open) mmap's the ids
-// file and validates its size at open time, so corrupting the file before
-// open would short-circuit the test at open() with the searcher's pre-existing
-// validation. The point of these tests is to exercise the FLUSH-time
-// engine-agnostic inventory path that fresh-mmap's the file and re-validates.
+// Flush-time label inventory goes through each segment's persistent label
+// run (labels.sorted.bin), never through a fresh mmap of its ids file. A
+// damaged or missing run is rebuilt from the ids file at open().
+
+TEST_F(DiskCollectionFactoryDispatchTest, label_run_finds_rows_after_reload) {
+  const std::vector<uint64_t> labels{40, 7, 19, 3};
+  const auto dir = tmp_root_ / "run";
+  std::filesystem::create_directories(dir);
+  SegmentLabelRun::from_labels(labels.data(), labels.size())->save(dir);
+
+  EXPECT_EQ(SegmentLabelRun::load(dir, 5), nullptr);  // count mismatch
+  const auto run = SegmentLabelRun::load(dir, labels.size());
+  ASSERT_NE(run, nullptr);
+  for (uint64_t row = 0; row < labels.size(); ++row) {
+    EXPECT_EQ(run->find(labels[row]), std::optional<uint64_t>(row));
+  }
+  EXPECT_FALSE(run->find(8).has_value());
+  EXPECT_FALSE(run->find(41).has_value());
+}
 
-TEST_F(DiskCollectionFactoryDispatchTest, flush_throws_on_missing_ids_file) {
+TEST_F(DiskCollectionFactoryDispatchTest, collection_label_index_merges_segment_runs) {
+  const std::vector<uint64_t> a{5, 1, 9};
+  const std::vector<uint64_t> b{2, 9, 7};
+  const std::vector<uint64_t> c{1, 3};
+  const auto run_a = SegmentLabelRun::from_labels(a.data(), a.size());
+  const auto run_b = SegmentLabelRun::from_labels(b.data(), b.size());
+  const auto run_c = SegmentLabelRun::from_labels(c.data(), c.size());
+  const auto dir = tmp_root_ / "global";
+  std::filesystem::create_directories(dir);
+  uint64_t next_seq = 1;
+
+  const auto appended = CollectionLabelIndex::build({run_a}, {1})->append(run_b, 4);
+  EXPECT_EQ(appended->size(), 6U);
+  EXPECT_EQ(appended->tiers().size(), 2U);  // appending writes nothing
+  const auto index = appended->consolidate(dir, next_seq);
+  ASSERT_EQ(index->tiers().size(), 1U);  // two equal tiers merge into one file
+  EXPECT_EQ(index->tiers()[0]->file_seq(), 1U);
+  EXPECT_EQ(next_seq, 2U);
+  EXPECT_EQ(index->segment_ids(), (std::vector<uint64_t>{1, 4}));
+
+  auto locations = [](const CollectionLabelIndex &idx, uint64_t label) {
+    std::vector<std::pair<uint64_t, uint64_t>> out;
+    (void)idx.find_if(label, [&out](const LabelLocation &loc) {
+      out.emplace_back(loc.segment, loc.row);
+      return false;
+    });
+    std::sort(out.begin(), out.end());
+    return out;
+  };
+  using Locs = std::vector<std::pair<uint64_t, uint64_t>>;
+  EXPECT_EQ(locations(*index, 9), (Locs{{0, 2}, {1, 1}}));
+  EXPECT_EQ(locations(*index, 7), (Locs{{1, 2}}));
+  EXPECT_TRUE(locations(*index, 4).empty());
+
+  // Compaction merges segment 1 away into segment 6, which takes its place.
+  // The merged tier keeps segment 1's entries until it is rewritten.
+  const auto compacted = index->with_segments({6, 4}, run_c, 6);
+  EXPECT_EQ(compacted->size(), 5U);
+  EXPECT_EQ(locations(*compacted, 1), (Locs{{0, 0}}));
+  EXPECT_EQ(locations(*compacted, 9), (Locs{{1, 1}}));
+  EXPECT_TRUE(locations(*compacted, 5).empty());
+
+  // Half the merged tier is dead, which is not yet a majority, and its 3
+  // live entries outweigh the newer 2, so consolidating rewrites nothing.
+  const auto consolidated = compacted->consolidate(dir, next_seq);
+  EXPECT_EQ(consolidated->tiers().size(), 2U);
+  EXPECT_EQ(next_seq, 2U);
+  for (const uint64_t label : {1, 2, 3, 5, 7, 9}) {
+    EXPECT_EQ(locations(*consolidated, label), locations(*compacted, label)) << label;
+  }
+  // Once segment 4 is gone too, the merged tier holds nothing live and goes.
+  const auto only_c = compacted->with_segments({6})->consolidate(dir, next_seq);
+  ASSERT_EQ(only_c->tiers().size(), 1U);
+  EXPECT_EQ(only_c->tiers()[0]->segment_run_id(), std::optional<uint64_t>(6));
+  EXPECT_EQ(only_c->size(), 2U);
+
+  // A written tier reloads, and a tier file that does not match the listed
+  // segments' runs is ignored in favour of the runs themselves.
+  const auto loaded = LabelTier::load(dir, 1);
+  ASSERT_NE(loaded, nullptr);
+  EXPECT_EQ(loaded->size(), 6U);
+  EXPECT_EQ(LabelTier::load(dir, 99), nullptr);
+  const auto stale = CollectionLabelIndex::assemble({loaded}, {run_c, run_b}, {1, 4});
+  EXPECT_EQ(stale->tiers().size(), 2U);  // run_c is not segment 1's 3-label run
+  EXPECT_EQ(locations(*stale, 5), Locs{});
+  EXPECT_EQ(locations(*stale, 3), (Locs{{0, 1}}));
+  const auto reopened = CollectionLabelIndex::assemble({loaded}, {run_a, run_b}, {1, 4});
+  ASSERT_EQ(reopened->tiers().size(), 1U);
+  for (const uint64_t label : {1, 2, 5, 7, 9}) {
+    EXPECT_EQ(locations(*reopened, label), locations(*index, label)) << label;
+  }
+}
+
+TEST_F(DiskCollectionFactoryDispatchTest, flush_cost_does_not_rewrite_the_whole_label_index) {
   constexpr uint32_t kDim = 4;
+  constexpr uint64_t kFlushes = 64;
   const auto coll = tmp_root_ / "coll";
-  seed_one_segment_collection(coll, kDim);
-  auto col = DiskCollection::open(coll);
-
-  // Remove the ids file AFTER open. The held searcher mmap stays valid (it
-  // referenced the file by inode); the flush-time inventory does a fresh
-  // open that hits ENOENT.
-  const auto ids_path = coll / "segments" / "seg_00000001" / "ids.u64.bin";
-  std::filesystem::remove(ids_path);
-
-  std::vector<float> v(kDim, 2.0F);
-  std::vector<uint64_t> l{99};
-  col.add_batch(v.data(), l.data(), 1);
-  try {
-    col.flush();
-    FAIL() << "expected throw on missing ids_file";
-  } catch (const std::runtime_error &e) {
-    const std::string msg = e.what();
-    EXPECT_NE(msg.find("ids.u64.bin"), std::string::npos) << msg;
-    EXPECT_NE(msg.find("seg_00000001"), std::string::npos) << msg;
+  uint64_t written = 0;
+  auto tier_bytes = [&coll]() {
+    std::map<std::string, uint64_t> out;
+    for (const auto &entry : std::filesystem::directory_iterator(coll)) {
+      const auto name = entry.path().filename().string();
+      if (name.rfind("labels.tier_", 0) == 0) {
+        out[name] = std::filesystem::file_size(entry.path());
+      }
+    }
+    return out;
+  };
+  std::map<std::string, uint64_t> before;
+  {
+    DiskCollection col(coll, kDim, MetricType::L2, DiskIndexType::Flat);
+    before = tier_bytes();
+    for (uint64_t label = 1; label <= kFlushes; ++label) {
+      std::vector<float> v(kDim, static_cast<float>(label));
+      col.add_batch(v.data(), &label, 1);
+      col.flush();
+      const auto after = tier_bytes();
+      for (const auto &[name, bytes] : after) {
+        if (before.count(name) == 0) {
+          written += bytes;
+        }
+      }
+      before = after;
+    }
   }
-  // No second segment published.
-  EXPECT_FALSE(std::filesystem::exists(coll / "segments" / "seg_00000002"));
+  // A binary-counter merge rewrites each entry (plus its segment's header
+  // slot) at most log2(kFlushes) + 1 = 7 times, and each file adds a 3-word
+  // header; rewriting the whole index per flush would write ~kFlushes^2 / 2
+  // entries instead.
+  constexpr uint64_t kPerEntry = 3 * sizeof(uint64_t) + 2 * sizeof(uint64_t);
+  EXPECT_LE(written, kFlushes * 7 * kPerEntry + kFlushes * 3 * sizeof(uint64_t));
+  EXPECT_LE(before.size(), 7U);  // O(log N) tiers on disk
+
+  auto reopened = DiskCollection::open(coll);
+  for (uint64_t label = 1; label <= kFlushes; ++label) {
+    std::vector<float> v(kDim, 0.0F);
+    EXPECT_THROW(reopened.add_batch(v.data(), &label, 1), std::invalid_argument) << label;
+  }
+  EXPECT_TRUE(reopened.mark_deleted(kFlushes / 2));
 }
 
-TEST_F(DiskCollectionFactoryDispatchTest, flush_throws_on_truncated_ids_file) {
+TEST_F(DiskCollectionFactoryDispatchTest, open_falls_back_to_segment_runs_for_missing_label_tiers) {
   constexpr uint32_t kDim = 4;
   const auto coll = tmp_root_ / "coll";
-  // Seed with two ids so the inventory size check has something to compare
-  // against (count=2 → expected 16 bytes).
   {
     DiskCollection col(coll, kDim, MetricType::L2, DiskIndexType::Flat);
-    std::vector<float> v(kDim * 2, 1.0F);
-    std::vector<uint64_t> l{1, 2};
-    col.add_batch(v.data(), l.data(), 2);
-    col.flush();
+    for (uint64_t label = 1; label <= 4; ++label) {
+      std::vector<float> v(kDim, static_cast<float>(label));
+      col.add_batch(v.data(), &label, 1);
+      col.flush();
+    }
   }
-  auto col = DiskCollection::open(coll);
-
-  // Truncate AFTER open succeeds. New flush-time mmap will see 9 bytes vs
-  // expected 16 and throw.
-  const auto ids_path = coll / "segments" / "seg_00000001" / "ids.u64.bin";
-  std::filesystem::resize_file(ids_path, 9);
-
-  std::vector<float> v(kDim, 2.0F);
-  std::vector<uint64_t> l{99};
-  col.add_batch(v.data(), l.data(), 1);
-  try {
-    col.flush();
-    FAIL() << "expected throw on truncated ids_file";
-  } catch (const std::runtime_error &e) {
-    const std::string msg = e.what();
-    EXPECT_NE(msg.find("size mismatch"), std::string::npos) << msg;
-    EXPECT_NE(msg.find("seg_00000001"), std::string::npos) << msg;
+  // A tier file left by a flush that crashed before its manifest publish.
+  const std::vector<uint64_t> one{7};
+  LabelTier::merge({LabelTier::of_segment(SegmentLabelRun::from_labels(one.data(), 1), 1).get()},
+                   {1})
+      ->save(coll, 1000);
+  std::vector<std::filesystem::path> listed;
+  for (const auto &entry : std::filesystem::directory_iterator(coll)) {
+    const auto name = entry.path().filename().string();
+    if (name.rfind("labels.tier_", 0) == 0 && name != LabelTier::file_name(1000)) {
+      listed.push_back(entry.path());
+    }
+  }
+  ASSERT_FALSE(listed.empty());
+  for (const bool remove : {false, true}) {
+    if (remove) {
+      for (const auto &p : listed) {
+        std::filesystem::remove(p);
+      }
+    }
+    auto col = DiskCollection::open(coll);
+    EXPECT_FALSE(std::filesystem::exists(coll / LabelTier::file_name(1000)));
+    for (uint64_t label = 1; label <= 4; ++label) {
+      std::vector<float> v(kDim, 0.0F);
+      EXPECT_THROW(col.add_batch(v.data(), &label, 1), std::invalid_argument) << label;
+    }
+    EXPECT_FALSE(col.mark_deleted(7));
   }
 }
 
-TEST_F(DiskCollectionFactoryDispatchTest, flush_throws_on_oversized_ids_file) {
+TEST_F(DiskCollectionFactoryDispatchTest, flush_inventory_does_not_reread_ids_files) {
   constexpr uint32_t kDim = 4;
   const auto coll = tmp_root_ / "coll";
   seed_one_segment_collection(coll, kDim);
   auto col = DiskCollection::open(coll);
 
-  // count=1 → expected 8 bytes; pad to 16 bytes after open succeeds.
-  const auto ids_path = coll / "segments" / "seg_00000001" / "ids.u64.bin";
-  std::filesystem::resize_file(ids_path, 16);
+  // Remove the ids file AFTER open. The held searcher mmap stays valid (it
+  // referenced the file by inode) and the inventory no longer opens it.
+  std::filesystem::remove(coll / "segments" / "seg_00000001" / "ids.u64.bin");
 
   std::vector<float> v(kDim, 2.0F);
-  std::vector<uint64_t> l{99};
-  col.add_batch(v.data(), l.data(), 1);
+  std::vector<uint64_t> dup{1};
   try {
+    col.add_batch(v.data(), dup.data(), 1);
+    FAIL() << "expected duplicate-label rejection";
+  } catch (const std::invalid_argument &e) {
+    EXPECT_NE(std::string(e.what()).find("duplicate label across segments: 1"), std::string::npos)
+        << e.what();
+  }
+  EXPECT_FALSE(std::filesystem::exists(coll / "segments" / "seg_00000002"));
+}
+
+TEST_F(DiskCollectionFactoryDispatchTest, open_rebuilds_missing_or_truncated_label_index) {
+  constexpr uint32_t kDim = 4;
+  const auto coll = tmp_root_ / "coll";
+  {
+    DiskCollection col(coll, kDim, MetricType::L2, DiskIndexType::Flat);
+    std::vector<float> v(kDim * 2, 1.0F);
+    std::vector<uint64_t> l{1, 2};
+    col.add_batch(v.data(), l.data(), 2);
     col.flush();
-    FAIL() << "expected throw on oversized ids_file";
-  } catch (const std::runtime_error &e) {
-    const std::string msg = e.what();
-    EXPECT_NE(msg.find("size mismatch"), std::string::npos) << msg;
-    EXPECT_NE(msg.find("seg_00000001"), std::string::npos) << msg;
+  }
+  const auto run_path = coll / "segments" / "seg_00000001" / "labels.sorted.bin";
+  ASSERT_TRUE(std::filesystem::exists(run_path));
+  // [magic | count | 2 x (label, row)] = 48 bytes.
+  const auto expected_size = std::filesystem::file_size(run_path);
+  EXPECT_EQ(expected_size, 48U);
+
+  for (const bool remove : {false, true}) {
+    if (remove) {
+      std::filesystem::remove(run_path);
+    } else {
+      std::filesystem::resize_file(run_path, 9);
+    }
+    auto col = DiskCollection::open(coll);
+    EXPECT_EQ(std::filesystem::file_size(run_path), expected_size);
+    std::vector<float> v(kDim, 2.0F);
+    std::vector<uint64_t> dup{2};
+    EXPECT_THROW(col.add_batch(v.data(), dup.data(), 1), std::invalid_argument);
   }
 }
 
-TEST_F(DiskCollectionFactoryDispatchTest, flush_throws_on_symlinked_ids_file) {
+TEST_F(DiskCollectionFactoryDispatchTest, open_replaces_symlinked_label_index) {
   constexpr uint32_t kDim = 4;
   const auto coll = tmp_root_ / "coll";
   seed_one_segment_collection(coll, kDim);
-  auto col = DiskCollection::open(coll);
 
-  // Build a sibling decoy file with the same byte size as ids.u64.bin.
-  const auto ids_path = coll / "segments" / "seg_00000001" / "ids.u64.bin";
-  const auto decoy = tmp_root_ / "decoy_ids.bin";
+  // A decoy run claiming label 7 instead of 1; it must never be trusted.
+  const auto run_path = coll / "segments" / "seg_00000001" / "labels.sorted.bin";
+  const auto decoy = tmp_root_ / "decoy_labels.bin";
   {
-    const uint64_t fake_id = 7;
+    const uint64_t blob[4] = {SegmentLabelRun::kMagic, 1, 7, 0};
     std::ofstream ofs(decoy, std::ios::binary);
-    ofs.write(reinterpret_cast<const char *>(&fake_id), sizeof(fake_id));
+    ofs.write(reinterpret_cast<const char *>(blob), sizeof(blob));
   }
-  // Replace the file with a symlink AFTER open succeeded. flush-time mmap
-  // hits ELOOP via O_NOFOLLOW.
-  std::filesystem::remove(ids_path);
+  std::filesystem::remove(run_path);
   std::error_code ec;
-  std::filesystem::create_symlink(decoy, ids_path, ec);
+  std::filesystem::create_symlink(decoy, run_path, ec);
   if (ec) {
     GTEST_SKIP() << "symlink creation failed: " << ec.message();
   }
 
+  auto col = DiskCollection::open(coll);
+  EXPECT_FALSE(std::filesystem::is_symlink(run_path));
   std::vector<float> v(kDim, 2.0F);
-  std::vector<uint64_t> l{99};
-  col.add_batch(v.data(), l.data(), 1);
-  EXPECT_THROW(col.flush(), std::runtime_error);
+  std::vector<uint64_t> dup{1};
+  EXPECT_THROW(col.add_batch(v.data(), dup.data(), 1), std::invalid_argument);
 }
 
 // --------------------------------------------------------------------------
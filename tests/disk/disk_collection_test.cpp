@@ -189,14 +189,64 @@ TEST_F(DiskCollectionTest, MultiSegmentGlobalTieBreak) {
   EXPECT_EQ(hits2[1].label, 200u);
 }
 
+TEST_F(DiskCollectionTest, SegmentFanOutMatchesSerialSearch) {
+  constexpr uint32_t kDim = 8;
+  constexpr uint64_t kPerSegment = 64;
+  constexpr uint32_t kSegments = 5;
+  auto coll_path = tmp_root_ / "coll";
+
+  DiskCollection col(coll_path, kDim, MetricType::L2, DiskIndexType::Flat);
+  for (uint32_t s = 0; s < kSegments; ++s) {
+    auto vectors = make_random_vectors(kPerSegment, kDim, 10 + s);
+    // Every segment repeats segment 0's first rows under new labels, so the
+    // merge sees cross-segment distance ties on every query that hits them.
+    if (s > 0) {
+      auto first = make_random_vectors(kPerSegment, kDim, 10);
+      std::copy(first.begin(), first.begin() + 8 * kDim, vectors.begin());
+    }
+    auto labels = sequential_labels(kPerSegment, 1000 + s * kPerSegment);
+    col.add_batch(vectors.data(), labels.data(), kPerSegment);
+    col.flush();
+  }
+
+  DiskSearchOptions serial;
+  serial.top_k = 12;
+  DiskSearchOptions fanned = serial;
+  fanned.segment_parallelism = 4;
+
+  const auto queries = make_random_vectors(32, kDim, 99);
+  const auto ties = make_random_vectors(1, kDim, 10);
+  for (uint64_t q = 0; q <= 32; ++q) {
+    const float *query = q < 32 ? queries.data() + q * kDim : ties.data();
+    const auto expected = col.search(query, serial);
+    const auto actual = col.search(query, fanned);
+    ASSERT_EQ(actual.size(), expected.size()) << "query " << q;
+    for (size_t j = 0; j < actual.size(); ++j) {
+      EXPECT_EQ(actual[j].label, expected[j].label) << "query " << q << " rank " << j;
+      EXPECT_EQ(std::memcmp(&actual[j].distance, &expected[j].distance, sizeof(float)), 0)
+          << "query " << q << " rank " << j;
+    }
+  }
+}
+
+TEST_F(DiskCollectionTest, SegmentParallelismZeroThrows) {
+  constexpr uint32_t kDim = 4;
+  DiskCollection col(tmp_root_ / "coll", kDim, MetricType::L2, DiskIndexType::Flat);
+  DiskSearchOptions opts;
+  opts.segment_parallelism = 0;
+  std::vector<float> q(kDim, 0.0F);
+  EXPECT_THROW((void)col.search(q.data(), opts), std::invalid_argument);
+}
+
 TEST_F(DiskCollectionTest, DuplicateLabelWithinBatchThrows) {
   constexpr uint32_t kDim = 4;
   auto coll_path = tmp_root_ / "coll";
   DiskCollection col(coll_path, kDim, MetricType::L2, DiskIndexType::Flat);
   auto vectors = make_random_vectors(5, kDim);
   std::vector<uint64_t> labels{1, 2, 3, 1, 5};  // dup label 1
-  col.add_batch(vectors.data(), labels.data(), 5);
-  EXPECT_THROW(col.flush(), std::invalid_argument);
+  EXPECT_THROW(col.add_batch(vectors.data(), labels.data(), 5), std::invalid_argument);
+  EXPECT_EQ(col.pending_size(), 0U);
+  col.flush();
 
   // No segment created.
   EXPECT_FALSE(std::filesystem::exists(coll_path / "segments" / "seg_00000001"));
@@ -214,8 +264,9 @@ TEST_F(DiskCollectionTest, DuplicateLabelAcrossSegmentsThrows) {
 
   auto v2 = make_random_vectors(3, kDim, 2);
   std::vector<uint64_t> l2{40, 20, 60};  // 20 collides
-  col.add_batch(v2.data(), l2.data(), 3);
-  EXPECT_THROW(col.flush(), std::invalid_argument);
+  EXPECT_THROW(col.add_batch(v2.data(), l2.data(), 3), std::invalid_argument);
+  EXPECT_EQ(col.pending_size(), 0U);
+  col.flush();
 
   // Second segment NOT published.
   EXPECT_FALSE(std::filesystem::exists(coll_path / "segments" / "seg_00000002"));
@@ -349,7 +400,7 @@ TEST_F(DiskCollectionTest, PendingBufferSingleBatchTooLarge) {
   }
 }
 
-TEST_F(DiskCollectionTest, SearchBeforeAnyFlushReturnsEmpty) {
+TEST_F(DiskCollectionTest, SearchBeforeAnyFlushSeesOnlyPendingRows) {
   constexpr uint32_t kDim = 4;
   auto coll_path = tmp_root_ / "coll";
   DiskCollection col(coll_path, kDim, MetricType::L2, DiskIndexType::Flat);
@@ -359,12 +410,14 @@ TEST_F(DiskCollectionTest, SearchBeforeAnyFlushReturnsEmpty) {
   auto hits = col.search(q.data(), opts);
   EXPECT_TRUE(hits.empty());
 
-  // Even after add_batch, search returns empty (pending excluded).
+  // Pending rows are served from the memtable before any flush.
   std::vector<float> v(kDim, 1.0F);
   std::vector<uint64_t> l{1};
   col.add_batch(v.data(), l.data(), 1);
   auto hits2 = col.search(q.data(), opts);
-  EXPECT_TRUE(hits2.empty()) << "pending buffer must be excluded from search";
+  ASSERT_EQ(hits2.size(), 1u);
+  EXPECT_EQ(hits2[0].label, 1u);
+  EXPECT_FLOAT_EQ(hits2[0].distance, 4 * 0.25F);
 }
 
 TEST_F(DiskCollectionTest, SizeExcludesPending) {
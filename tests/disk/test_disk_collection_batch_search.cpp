@@ -8,15 +8,19 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <filesystem>  // NOLINT(build/c++17)
 #include <fstream>
 #include <limits>
+#include <new>
 #include <numeric>
 #include <random>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "index/disk/segment_factory.hpp"
@@ -31,6 +35,26 @@
   #define ALAYA_LASER_FIXTURE_PREFIX "dsqg_seg_00000001"
 #endif
 
+// Counting global allocator for the steady-state allocation test. Counting is
+// off unless a test flips `g_count_allocations`, so every other test in this
+// binary sees plain malloc/free.
+namespace {
+std::atomic<bool> g_count_allocations{false};
+std::atomic<uint64_t> g_allocation_count{0};
+}  // namespace
+
+auto operator new(std::size_t size) -> void * {
+  if (g_count_allocations.load(std::memory_order_relaxed)) {
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t /*size*/) noexcept { std::free(p); }
+
 namespace alaya::disk {
 namespace {
 
@@ -242,6 +266,34 @@ TEST_F(BatchFlatTest, MultiQueryAgreesWithSerial) {
   }
 }
 
+TEST_F(BatchFlatTest, SegmentFanOutInsideBatchAgreesWithSerial) {
+  auto col = DiskCollection::open(build_two_segment_collection());
+  const auto opts = default_opts();
+  auto fanned = opts;
+  fanned.segment_parallelism = 2;
+
+  constexpr uint64_t kN = 64;
+  const auto queries = make_vectors(kN, kDim, 150);
+
+  std::vector<uint64_t> baseline_labels;
+  std::vector<float> baseline_distances;
+  serial_baseline(col, queries.data(), kN, opts, kDim, baseline_labels, baseline_distances);
+
+  // Batch workers contend for the one segment executor; whichever query loses
+  // the race searches its segments serially. Rows must not depend on which.
+  auto out_labels = allocate_label_buffer(kN, opts.top_k);
+  auto out_distances = allocate_distance_buffer(kN, opts.top_k);
+  col.batch_search(queries.data(), kN, fanned, /*num_threads=*/4, out_labels.data(),
+                   out_distances.data());
+
+  EXPECT_EQ(out_labels, baseline_labels);
+  for (size_t i = 0; i < out_distances.size(); ++i) {
+    if (!is_nan_f32(baseline_distances[i])) {
+      EXPECT_TRUE(bits_equal_f32(out_distances[i], baseline_distances[i])) << "row " << i;
+    }
+  }
+}
+
 TEST_F(BatchFlatTest, EmptyQueriesNoop) {
   auto col = DiskCollection::open(build_two_segment_collection());
   const auto opts = default_opts();
@@ -333,6 +385,93 @@ TEST_F(BatchFlatTest, ConcurrentBatchSearch_NoCorruption) {
   EXPECT_EQ(out_labels, baseline_labels);
 }
 
+TEST_F(BatchFlatTest, ExecutorReusedAcrossCalls) {
+  auto col = DiskCollection::open(build_two_segment_collection());
+  const auto opts = default_opts();
+  constexpr uint64_t kN = 32;
+  const auto queries = make_vectors(kN, kDim, 300);
+  auto out_labels = allocate_label_buffer(kN, opts.top_k);
+
+  EXPECT_EQ(col.batch_executor_builds(), 0u);
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/4, out_labels.data(), nullptr);
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/4, out_labels.data(), nullptr);
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/2, out_labels.data(), nullptr);
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/1, out_labels.data(), nullptr);
+  EXPECT_EQ(col.batch_executor_builds(), 1u);
+
+  // Growing the worker count rebuilds once; the larger pool is then kept.
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/8, out_labels.data(), nullptr);
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/4, out_labels.data(), nullptr);
+  EXPECT_EQ(col.batch_executor_builds(), 2u);
+}
+
+TEST_F(BatchFlatTest, CorePinnedExecutorAgreesWithSerial) {
+  auto col = DiskCollection::open(build_two_segment_collection());
+  col.set_batch_search_core_pinning(true);
+  const auto opts = default_opts();
+  constexpr uint64_t kN = 64;
+  const auto queries = make_vectors(kN, kDim, 400);
+
+  std::vector<uint64_t> baseline_labels;
+  std::vector<float> baseline_distances;
+  serial_baseline(col, queries.data(), kN, opts, kDim, baseline_labels, baseline_distances);
+
+  auto out_labels = allocate_label_buffer(kN, opts.top_k);
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/4, out_labels.data(), nullptr);
+  EXPECT_EQ(out_labels, baseline_labels);
+}
+
+TEST_F(BatchFlatTest, SteadyStateBatchDoesNotAllocate) {
+  auto col = DiskCollection::open(build_two_segment_collection());
+  const auto opts = default_opts();
+  constexpr uint64_t kN = 64;
+  const auto queries = make_vectors(kN, kDim, 500);
+  auto out_labels = allocate_label_buffer(kN, opts.top_k);
+  auto out_distances = allocate_distance_buffer(kN, opts.top_k);
+
+  // Warm-up sizes the executor and every worker's scratch.
+  for (int round = 0; round < 2; ++round) {
+    col.batch_search(queries.data(), kN, opts, /*num_threads=*/4, out_labels.data(),
+                     out_distances.data());
+  }
+
+  g_allocation_count.store(0);
+  g_count_allocations.store(true);
+  col.batch_search(queries.data(), kN, opts, /*num_threads=*/4, out_labels.data(),
+                   out_distances.data());
+  g_count_allocations.store(false);
+  EXPECT_EQ(g_allocation_count.load(), 0u);
+}
+
+TEST_F(BatchFlatTest, ConcurrentCallersAgreeWithSerial) {
+  auto col = DiskCollection::open(build_two_segment_collection());
+  const auto opts = default_opts();
+  constexpr uint64_t kN = 128;
+  const auto queries = make_vectors(kN, kDim, 600);
+
+  std::vector<uint64_t> baseline_labels;
+  std::vector<float> baseline_distances;
+  serial_baseline(col, queries.data(), kN, opts, kDim, baseline_labels, baseline_distances);
+
+  // Two callers contend for the shared executor; the loser falls back to a
+  // private one and both must still match the serial rows.
+  std::vector<std::vector<uint64_t>> outs(2, allocate_label_buffer(kN, opts.top_k));
+  std::vector<std::thread> callers;
+  for (auto &out : outs) {
+    callers.emplace_back([&col, &queries, &opts, &out]() {
+      for (int round = 0; round < 4; ++round) {
+        col.batch_search(queries.data(), kN, opts, /*num_threads=*/4, out.data(), nullptr);
+      }
+    });
+  }
+  for (auto &c : callers) {
+    c.join();
+  }
+  for (const auto &out : outs) {
+    EXPECT_EQ(out, baseline_labels);
+  }
+}
+
 // ---------------------------------------------------------------------------
 // disk_vamana fixture
 // ---------------------------------------------------------------------------
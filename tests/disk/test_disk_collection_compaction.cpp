@@ -0,0 +1,254 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "index/disk/disk_collection.hpp"
+#include "index/disk/segment_compaction.hpp"
+#include "index/disk/segment_manifest.hpp"
+#include "index/disk/types.hpp"
+#include "utils/metric_type.hpp"
+
+namespace alaya::disk {
+
+namespace {
+
+constexpr uint32_t kDim = 8;
+
+class DiskCollectionCompactionTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto pid_str = std::to_string(static_cast<long long>(::getpid()));
+    tmp_root_ = std::filesystem::temp_directory_path() /
+                ("alaya_disk_compact_" + pid_str + "_" +
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(tmp_root_);
+    std::filesystem::create_directories(tmp_root_);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(tmp_root_, ec);
+  }
+
+  static auto make_vectors(uint64_t n, uint32_t seed) -> std::vector<float> {
+    std::vector<float> out(n * kDim);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+    for (auto &v : out) {
+      v = dist(rng);
+    }
+    return out;
+  }
+
+  // Flush `segments` batches of `rows` rows each, labelled consecutively from
+  // `first_label`; returns every row written.
+  static auto flush_segments(DiskCollection &col,
+                             uint32_t segments,
+                             uint64_t rows,
+                             uint64_t first_label = 0) -> std::vector<float> {
+    std::vector<float> all;
+    for (uint32_t s = 0; s < segments; ++s) {
+      auto vectors = make_vectors(rows, 100 + s);
+      std::vector<uint64_t> labels(rows);
+      std::iota(labels.begin(), labels.end(), first_label + static_cast<uint64_t>(s) * rows);
+      col.add_batch(vectors.data(), labels.data(), rows);
+      col.flush();
+      all.insert(all.end(), vectors.begin(), vectors.end());
+    }
+    return all;
+  }
+
+  static auto segment_dir_count(const std::filesystem::path &coll) -> size_t {
+    size_t n = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(coll / "segments")) {
+      n += entry.is_directory() ? 1 : 0;
+    }
+    return n;
+  }
+
+  static auto labels_of(const std::vector<DiskSearchHit> &hits) -> std::vector<uint64_t> {
+    std::vector<uint64_t> out;
+    out.reserve(hits.size());
+    for (const auto &h : hits) {
+      out.push_back(h.label);
+    }
+    return out;
+  }
+
+  static auto small_policy() -> CompactionPolicy {
+    CompactionPolicy policy;
+    policy.min_merge_segments = 3;
+    policy.interval = std::chrono::milliseconds(10);
+    return policy;
+  }
+
+  std::filesystem::path tmp_root_;
+};
+
+}  // namespace
+
+TEST(SizeTieredPickerTest, MergesSmallestTierThatIsLargeEnough) {
+  CompactionPolicy policy;
+  policy.min_merge_segments = 3;
+  policy.max_merge_segments = 4;
+  policy.tier_ratio = 2.0;
+
+  // Tier {10, 12, 15, 19, 20} qualifies before {1000, 1500}; max keeps the
+  // four smallest, returned in segment order.
+  const std::vector<uint64_t> rows{1000, 12, 20, 1500, 10, 15, 19};
+  EXPECT_EQ(detail::pick_size_tiered_segments(rows, policy), (std::vector<uint32_t>{1, 4, 5, 6}));
+
+  // Two members only: nothing to do.
+  EXPECT_TRUE(detail::pick_size_tiered_segments({10, 12, 1000}, policy).empty());
+
+  // Oversized segments never take part.
+  policy.max_segment_rows = 100;
+  EXPECT_TRUE(detail::pick_size_tiered_segments({200, 300, 400}, policy).empty());
+}
+
+TEST(SizeTieredPickerTest, RejectsInvalidPolicy) {
+  CompactionPolicy policy;
+  policy.min_merge_segments = 1;
+  EXPECT_THROW(detail::validate_compaction_policy(policy), std::invalid_argument);
+  policy = CompactionPolicy{};
+  policy.max_merge_segments = 2;
+  EXPECT_THROW(detail::validate_compaction_policy(policy), std::invalid_argument);
+  policy = CompactionPolicy{};
+  policy.tier_ratio = 1.0;
+  EXPECT_THROW(detail::validate_compaction_policy(policy), std::invalid_argument);
+}
+
+TEST_F(DiskCollectionCompactionTest, CompactMergesFlatSegmentsAndKeepsResults) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  const auto all = flush_segments(col, 5, 40);
+  ASSERT_EQ(col.segment_count(), 5U);
+
+  DiskSearchOptions opts;
+  opts.top_k = 10;
+  std::vector<std::vector<uint64_t>> before;
+  for (uint64_t q = 0; q < 200; q += 17) {
+    before.push_back(labels_of(col.search(all.data() + q * kDim, opts)));
+  }
+
+  ASSERT_TRUE(col.compact(small_policy()));
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 200U);
+  EXPECT_EQ(col.retired_segment_count(), 0U);
+  EXPECT_EQ(segment_dir_count(path), 1U);
+  EXPECT_FALSE(col.compact(small_policy()));
+
+  size_t i = 0;
+  for (uint64_t q = 0; q < 200; q += 17, ++i) {
+    EXPECT_EQ(labels_of(col.search(all.data() + q * kDim, opts)), before[i]) << "query " << q;
+  }
+
+  // Later flushes keep appending next to the merged segment.
+  flush_segments(col, 1, 40, 200);
+  EXPECT_EQ(col.segment_count(), 2U);
+}
+
+TEST_F(DiskCollectionCompactionTest, CompactedCollectionReopens) {
+  const auto path = tmp_root_ / "coll";
+  std::vector<float> all;
+  {
+    DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+    all = flush_segments(col, 4, 30);
+    ASSERT_TRUE(col.compact(small_policy()));
+  }
+  auto col = DiskCollection::open(path);
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 120U);
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  const auto hits = col.search(all.data() + 77 * kDim, opts);
+  ASSERT_EQ(hits.size(), 1U);
+  EXPECT_EQ(hits[0].label, 77U);
+  EXPECT_EQ(segment_dir_count(path), 1U);
+}
+
+TEST_F(DiskCollectionCompactionTest, OpenReclaimsRetiredSegmentsLeftByACrash) {
+  const auto path = tmp_root_ / "coll";
+  {
+    DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+    flush_segments(col, 2, 20);
+  }
+  // Simulate a process that published a compaction but died before the last
+  // reader released seg_00000001.
+  auto manifest = CollectionManifest::load(path / "collection_manifest.txt");
+  ASSERT_EQ(manifest.segment_ids.size(), 2U);
+  const auto retired = manifest.segment_ids.front();
+  manifest.segment_ids.erase(manifest.segment_ids.begin());
+  manifest.x_extras["x_retired_segments"] = retired;
+  detail::publish_collection_manifest_atomic_only(path, manifest);
+  ASSERT_TRUE(std::filesystem::exists(path / "segments" / retired));
+
+  auto col = DiskCollection::open(path);
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_FALSE(std::filesystem::exists(path / "segments" / retired));
+}
+
+TEST_F(DiskCollectionCompactionTest, BackgroundCompactionMergesFlushes) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  col.start_background_compaction(small_policy());
+  EXPECT_TRUE(col.background_compaction_running());
+  EXPECT_THROW(col.start_background_compaction(small_policy()), std::runtime_error);
+
+  const auto all = flush_segments(col, 3, 25);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  while (col.segment_count() > 1 && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 75U);
+
+  // Searches keep working while the compactor runs.
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  EXPECT_EQ(col.search(all.data() + 30 * kDim, opts).at(0).label, 30U);
+
+  col.stop_background_compaction();
+  EXPECT_FALSE(col.background_compaction_running());
+}
+
+TEST_F(DiskCollectionCompactionTest, CompactRebuildsVamanaSegments) {
+  const auto path = tmp_root_ / "coll";
+  VamanaSegmentBuildParams params;
+  params.R = 16;
+  params.L = 32;
+  params.num_threads = 1;
+  DiskCollection col(path,
+                     kDim,
+                     MetricType::L2,
+                     DiskIndexType::Vamana,
+                     DiskCollection::kDefaultMaxPendingBytes,
+                     params);
+  const auto all = flush_segments(col, 3, 64);
+  ASSERT_TRUE(col.compact(small_policy()));
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 192U);
+
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  opts.ef = 64;
+  uint32_t found = 0;
+  for (uint64_t q = 0; q < 192; ++q) {
+    const auto hits = col.search(all.data() + q * kDim, opts);
+    found += (!hits.empty() && hits[0].label == q) ? 1 : 0;
+  }
+  EXPECT_GE(found, 180U);
+}
+
+}  // namespace alaya::disk
@@ -0,0 +1,357 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "index/disk/disk_collection.hpp"
+#include "index/disk/segment_compaction.hpp"
+#include "index/disk/segment_tombstones.hpp"
+#include "index/disk/types.hpp"
+#include "utils/metric_type.hpp"
+
+namespace alaya::disk {
+
+namespace {
+
+constexpr uint32_t kDim = 8;
+
+class DiskCollectionDeleteTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto pid_str = std::to_string(static_cast<long long>(::getpid()));
+    tmp_root_ = std::filesystem::temp_directory_path() /
+                ("alaya_disk_delete_" + pid_str + "_" +
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(tmp_root_);
+    std::filesystem::create_directories(tmp_root_);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(tmp_root_, ec);
+  }
+
+  static auto make_vectors(uint64_t n, uint32_t seed) -> std::vector<float> {
+    std::vector<float> out(n * kDim);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+    for (auto &v : out) {
+      v = dist(rng);
+    }
+    return out;
+  }
+
+  static void add_and_flush(DiskCollection &col,
+                            const std::vector<float> &vectors,
+                            uint64_t first_label) {
+    const uint64_t n = vectors.size() / kDim;
+    std::vector<uint64_t> labels(n);
+    std::iota(labels.begin(), labels.end(), first_label);
+    col.add_batch(vectors.data(), labels.data(), n);
+    col.flush();
+  }
+
+  static auto vamana_params() -> VamanaSegmentBuildParams {
+    VamanaSegmentBuildParams params;
+    params.R = 16;
+    params.L = 32;
+    params.num_threads = 1;
+    return params;
+  }
+
+  std::filesystem::path tmp_root_;
+};
+
+}  // namespace
+
+TEST(SegmentTombstonesTest, SaveLoadRoundTrip) {
+  const auto dir = std::filesystem::temp_directory_path() /
+                   ("alaya_seg_tomb_" + std::to_string(static_cast<long long>(::getpid())));
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  {
+    SegmentTombstones t(130);
+    EXPECT_TRUE(t.set(0));
+    EXPECT_TRUE(t.set(129));
+    EXPECT_FALSE(t.set(129));
+    EXPECT_THROW(t.set(130), std::out_of_range);
+    EXPECT_EQ(t.count(), 2U);
+    t.save(dir);
+  }
+  SegmentTombstones loaded(130);
+  loaded.load(dir);
+  EXPECT_EQ(loaded.count(), 2U);
+  EXPECT_TRUE(loaded.is_deleted(0));
+  EXPECT_TRUE(loaded.is_deleted(129));
+  EXPECT_FALSE(loaded.is_deleted(64));
+
+  SegmentTombstones wrong_size(1000);
+  EXPECT_THROW(wrong_size.load(dir), std::runtime_error);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(SegmentTombstonesTest, PickerRewritesMostDeletedSegment) {
+  CompactionPolicy policy;
+  // No tier of 4: rows 100 / 1000 / 10000.
+  EXPECT_EQ(detail::pick_compaction_segments({100, 1000, 10000}, {10, 500, 2500}, policy),
+            (std::vector<uint32_t>{1}));
+  policy.max_deleted_ratio = 0.0;
+  EXPECT_TRUE(
+      detail::pick_compaction_segments({100, 1000, 10000}, {10, 500, 2500}, policy).empty());
+}
+
+TEST(SegmentTombstonesTest, PickerFoldsPicksTooSmallToBuild) {
+  CompactionPolicy policy;
+  // Segment 0 keeps 1 live row: alone it is only buildable by a 1-row engine.
+  EXPECT_EQ(detail::pick_compaction_segments({50, 1000}, {49, 0}, policy, 1),
+            (std::vector<uint32_t>{0}));
+  // A 2-row engine folds in the smallest other non-empty segment.
+  EXPECT_EQ(detail::pick_compaction_segments({50, 1000, 30, 40}, {49, 0, 0, 20}, policy, 2),
+            (std::vector<uint32_t>{0, 3}));
+  // Nothing to fold in: the pick is dropped rather than handed to a failing build.
+  EXPECT_TRUE(detail::pick_compaction_segments({50}, {49}, policy, 2).empty());
+  // A fully deleted segment needs no build and is still picked.
+  EXPECT_EQ(detail::pick_compaction_segments({50}, {50}, policy, 2), (std::vector<uint32_t>{0}));
+  // Folding never pulls in a segment at or above max_segment_rows.
+  EXPECT_EQ(detail::pick_compaction_segments({50, 1000}, {49, 0}, policy, 2),
+            (std::vector<uint32_t>{0, 1}));
+  policy.max_segment_rows = 500;
+  EXPECT_TRUE(detail::pick_compaction_segments({50, 1000}, {49, 0}, policy, 2).empty());
+}
+
+TEST_F(DiskCollectionDeleteTest, FlatSearchSkipsDeletedRowsAndPersists) {
+  const auto path = tmp_root_ / "coll";
+  const auto vectors = make_vectors(100, 1);
+  {
+    DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+    add_and_flush(col, vectors, 0);
+
+    EXPECT_TRUE(col.mark_deleted(7));
+    EXPECT_FALSE(col.mark_deleted(7));
+    EXPECT_FALSE(col.mark_deleted(12345));
+    const std::vector<uint64_t> more{8, 9};
+    EXPECT_EQ(col.mark_deleted(more.data(), more.size()), 2U);
+    EXPECT_TRUE(col.is_deleted(7));
+    EXPECT_FALSE(col.is_deleted(10));
+    EXPECT_EQ(col.size(), 97U);
+
+    DiskSearchOptions opts;
+    opts.top_k = 5;
+    const auto hits = col.search(vectors.data() + 7 * kDim, opts);
+    ASSERT_EQ(hits.size(), 5U);
+    for (const auto &h : hits) {
+      EXPECT_TRUE(h.label != 7 && h.label != 8 && h.label != 9) << h.label;
+    }
+  }
+  auto col = DiskCollection::open(path);
+  EXPECT_EQ(col.size(), 97U);
+  EXPECT_TRUE(col.is_deleted(8));
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  EXPECT_NE(col.search(vectors.data() + 8 * kDim, opts).at(0).label, 8U);
+}
+
+TEST_F(DiskCollectionDeleteTest, VamanaOverFetchStillReturnsTopK) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path,
+                     kDim,
+                     MetricType::L2,
+                     DiskIndexType::Vamana,
+                     DiskCollection::kDefaultMaxPendingBytes,
+                     vamana_params());
+  const auto vectors = make_vectors(200, 2);
+  add_and_flush(col, vectors, 0);
+
+  // Delete the query's ten nearest rows; the next ten must still come back.
+  DiskSearchOptions opts;
+  opts.top_k = 10;
+  opts.ef = 64;
+  const float *query = vectors.data() + 42 * kDim;
+  const auto before = col.search(query, opts);
+  ASSERT_EQ(before.size(), 10U);
+  std::vector<uint64_t> nearest;
+  for (const auto &h : before) {
+    nearest.push_back(h.label);
+  }
+  EXPECT_EQ(col.mark_deleted(nearest.data(), nearest.size()), 10U);
+
+  const auto after = col.search(query, opts);
+  ASSERT_EQ(after.size(), 10U);
+  const std::set<uint64_t> gone(nearest.begin(), nearest.end());
+  for (const auto &h : after) {
+    EXPECT_FALSE(gone.contains(h.label)) << h.label;
+  }
+}
+
+TEST_F(DiskCollectionDeleteTest, DeletedLabelCanBeAddedAgain) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  add_and_flush(col, make_vectors(10, 3), 0);
+
+  const auto replacement = make_vectors(1, 4);
+  const uint64_t label = 3;
+  EXPECT_THROW(col.add_batch(replacement.data(), &label, 1), std::invalid_argument);
+
+  ASSERT_TRUE(col.mark_deleted(label));
+  col.add_batch(replacement.data(), &label, 1);
+  col.flush();
+  EXPECT_FALSE(col.is_deleted(label));
+  EXPECT_EQ(col.size(), 10U);
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  const auto hits = col.search(replacement.data(), opts);
+  ASSERT_EQ(hits.size(), 1U);
+  EXPECT_EQ(hits[0].label, label);
+  EXPECT_EQ(hits[0].distance, 0.0F);
+}
+
+TEST_F(DiskCollectionDeleteTest, CompactionDropsDeletedRows) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  const auto vectors = make_vectors(50, 5);
+  add_and_flush(col, vectors, 0);
+
+  // Deleting 40% crosses the default max_deleted_ratio on a lone segment.
+  std::vector<uint64_t> doomed(20);
+  std::iota(doomed.begin(), doomed.end(), 10);
+  ASSERT_EQ(col.mark_deleted(doomed.data(), doomed.size()), 20U);
+  ASSERT_TRUE(col.compact());
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 30U);
+  EXPECT_FALSE(col.is_deleted(15));  // compacted away, no longer tracked
+  EXPECT_FALSE(col.compact());
+
+  // Deletes keep working against the merged segment.
+  EXPECT_TRUE(col.mark_deleted(40));
+  EXPECT_FALSE(col.mark_deleted(15));
+  EXPECT_EQ(col.size(), 29U);
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  EXPECT_EQ(col.search(vectors.data() + 45 * kDim, opts).at(0).label, 45U);
+}
+
+TEST_F(DiskCollectionDeleteTest, LabelIndexFollowsCompactionAndReopen) {
+  const auto path = tmp_root_ / "coll";
+  {
+    DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+    add_and_flush(col, make_vectors(10, 7), 0);
+    add_and_flush(col, make_vectors(10, 8), 10);
+    ASSERT_TRUE(col.mark_deleted(3));
+    add_and_flush(col, make_vectors(1, 9), 3);  // label 3 lives on in a newer segment
+    const std::vector<uint64_t> doomed{0, 1, 12};
+    ASSERT_EQ(col.mark_deleted(doomed.data(), doomed.size()), 3U);
+
+    // Only the first segment crosses max_deleted_ratio.
+    ASSERT_TRUE(col.compact());
+    EXPECT_EQ(col.segment_count(), 3U);
+    EXPECT_FALSE(col.is_deleted(0));  // dropped by the merge
+    EXPECT_FALSE(col.is_deleted(3));
+    EXPECT_TRUE(col.is_deleted(12));  // untouched segment keeps its tombstone
+    EXPECT_TRUE(col.mark_deleted(5));  // now a row of the merged segment
+    EXPECT_TRUE(col.mark_deleted(3));
+    EXPECT_TRUE(col.is_deleted(3));
+    EXPECT_EQ(col.size(), 15U);
+  }
+  auto col = DiskCollection::open(path);
+  EXPECT_TRUE(col.is_deleted(3));
+  EXPECT_TRUE(col.is_deleted(5));
+  EXPECT_FALSE(col.is_deleted(6));
+  EXPECT_FALSE(col.mark_deleted(12));
+  EXPECT_TRUE(col.mark_deleted(19));
+  EXPECT_EQ(col.size(), 14U);
+}
+
+TEST_F(DiskCollectionDeleteTest, DeletesRacingCompactionAreKept) {
+  const auto path = tmp_root_ / "coll";
+  constexpr uint64_t kSegments = 8;
+  constexpr uint64_t kRows = 20;
+  {
+    DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+    for (uint64_t s = 0; s < kSegments; ++s) {
+      add_and_flush(col, make_vectors(kRows, static_cast<uint32_t>(s)), s * kRows);
+    }
+    std::thread deleter([&]() {
+      for (uint64_t label = 1; label < kSegments * kRows; label += 2) {
+        EXPECT_TRUE(col.mark_deleted(label)) << label;
+      }
+    });
+    CompactionPolicy policy;
+    policy.min_merge_segments = 2;
+    while (col.compact(policy)) {
+    }
+    deleter.join();
+    EXPECT_EQ(col.size(), kSegments * kRows / 2);
+    for (uint64_t label = 1; label < kSegments * kRows; label += 2) {
+      EXPECT_FALSE(col.mark_deleted(label)) << label;  // deleted or compacted away
+    }
+  }
+  auto col = DiskCollection::open(path);
+  EXPECT_EQ(col.size(), kSegments * kRows / 2);
+  DiskSearchOptions opts;
+  opts.top_k = static_cast<uint32_t>(kSegments * kRows);
+  const auto query = make_vectors(1, 99);
+  for (const auto &hit : col.search(query.data(), opts)) {
+    EXPECT_EQ(hit.label % 2, 0U) << hit.label;
+  }
+}
+
+TEST_F(DiskCollectionDeleteTest, VamanaSegmentWithOneLiveRowIsFoldedNotRebuilt) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path,
+                     kDim,
+                     MetricType::L2,
+                     DiskIndexType::Vamana,
+                     DiskCollection::kDefaultMaxPendingBytes,
+                     vamana_params());
+  const auto vectors = make_vectors(50, 11);
+  add_and_flush(col, vectors, 0);
+  std::vector<uint64_t> doomed(49);
+  std::iota(doomed.begin(), doomed.end(), 1);
+  ASSERT_EQ(col.mark_deleted(doomed.data(), doomed.size()), 49U);
+
+  // A lone 1-row Vamana segment cannot be rebuilt: every round declines
+  // instead of throwing, and no segment id is burned.
+  for (int round = 0; round < 3; ++round) {
+    EXPECT_FALSE(col.compact());
+  }
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 1U);
+
+  const auto more = make_vectors(20, 12);
+  add_and_flush(col, more, 100);
+  EXPECT_TRUE(std::filesystem::exists(path / "segments" / "seg_00000002"));
+
+  // With a neighbour to fold in, the survivor is merged with it.
+  ASSERT_TRUE(col.compact());
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 21U);
+  EXPECT_FALSE(col.compact());
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  EXPECT_EQ(col.search(vectors.data(), opts).at(0).label, 0U);
+  EXPECT_EQ(col.search(more.data() + 5 * kDim, opts).at(0).label, 105U);
+}
+
+TEST_F(DiskCollectionDeleteTest, DeletingEverythingCompactsToNoSegments) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  add_and_flush(col, make_vectors(4, 6), 0);
+  const std::vector<uint64_t> all{0, 1, 2, 3};
+  ASSERT_EQ(col.mark_deleted(all.data(), all.size()), 4U);
+  EXPECT_EQ(col.size(), 0U);
+  ASSERT_TRUE(col.compact());
+  EXPECT_EQ(col.segment_count(), 0U);
+}
+
+}  // namespace alaya::disk
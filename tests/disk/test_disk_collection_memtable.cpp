@@ -0,0 +1,375 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <limits>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "index/disk/disk_collection.hpp"
+#include "index/disk/disk_memtable.hpp"
+#include "index/disk/types.hpp"
+#include "utils/metric_type.hpp"
+
+namespace alaya::disk {
+
+namespace {
+
+constexpr uint32_t kDim = 8;
+
+class DiskCollectionMemtableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto pid_str = std::to_string(static_cast<long long>(::getpid()));
+    tmp_root_ = std::filesystem::temp_directory_path() /
+                ("alaya_disk_memtable_" + pid_str + "_" +
+                 ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    std::filesystem::remove_all(tmp_root_);
+    std::filesystem::create_directories(tmp_root_);
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(tmp_root_, ec);
+  }
+
+  static auto make_vectors(uint64_t n, uint32_t seed) -> std::vector<float> {
+    std::vector<float> out(n * kDim);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+    for (auto &v : out) {
+      v = dist(rng);
+    }
+    return out;
+  }
+
+  static void add(DiskCollection &col, const std::vector<float> &vectors, uint64_t first_label) {
+    const uint64_t n = vectors.size() / kDim;
+    std::vector<uint64_t> labels(n);
+    std::iota(labels.begin(), labels.end(), first_label);
+    col.add_batch(vectors.data(), labels.data(), n);
+  }
+
+  std::filesystem::path tmp_root_;
+};
+
+}  // namespace
+
+TEST(DiskMemtableTest, AppendSharesEarlierChunks) {
+  const auto a = std::vector<float>(2 * kDim, 1.0F);
+  const std::vector<uint64_t> la{1, 2};
+  const auto first = DiskMemtable::append(nullptr, kDim, MetricType::L2, a.data(), la.data(), 2);
+  const auto b = std::vector<float>(kDim, 2.0F);
+  const uint64_t lb = 3;
+  const auto second = DiskMemtable::append(first, kDim, MetricType::L2, b.data(), &lb, 1);
+
+  EXPECT_EQ(first->size(), 2U);
+  EXPECT_EQ(second->size(), 3U);
+  ASSERT_EQ(second->chunks().size(), 2U);
+  EXPECT_EQ(second->chunks()[0], first->chunks()[0]);
+
+  std::vector<float> vectors(3 * kDim);
+  std::vector<uint64_t> labels(3);
+  std::vector<bool> copied;
+  EXPECT_EQ(second->copy_live_rows(vectors.data(), labels.data(), copied), 3U);
+  EXPECT_EQ(labels, (std::vector<uint64_t>{1, 2, 3}));
+  EXPECT_EQ(copied, (std::vector<bool>{true, true, true}));
+  EXPECT_EQ(vectors.back(), 2.0F);
+}
+
+TEST_F(DiskCollectionMemtableTest, PendingRowsMergeWithSegmentsAndMatchAfterFlush) {
+  for (const auto metric : {MetricType::L2, MetricType::IP, MetricType::COS}) {
+    const auto path = tmp_root_ / ("coll_" + std::to_string(static_cast<int>(metric)));
+    DiskCollection col(path, kDim, metric, DiskIndexType::Flat);
+    const auto flushed = make_vectors(60, 1);
+    add(col, flushed, 0);
+    col.flush();
+    const auto pending = make_vectors(40, 2);
+    add(col, pending, 1000);
+    EXPECT_EQ(col.pending_size(), 40U);
+    EXPECT_EQ(col.size(), 60U);
+
+    DiskSearchOptions opts;
+    opts.top_k = 10;
+    std::vector<std::vector<DiskSearchHit>> before;
+    bool saw_pending = false;
+    for (uint64_t q = 0; q < 40; q += 3) {
+      auto hits = col.search(pending.data() + q * kDim, opts);
+      ASSERT_EQ(hits.size(), 10U);
+      for (const auto &h : hits) {
+        saw_pending = saw_pending || h.label >= 1000;
+      }
+      before.push_back(std::move(hits));
+    }
+    EXPECT_TRUE(saw_pending);
+
+    col.flush();
+    EXPECT_EQ(col.pending_size(), 0U);
+    size_t i = 0;
+    for (uint64_t q = 0; q < 40; q += 3, ++i) {
+      const auto after = col.search(pending.data() + q * kDim, opts);
+      ASSERT_EQ(after.size(), before[i].size());
+      for (size_t j = 0; j < after.size(); ++j) {
+        EXPECT_EQ(after[j].label, before[i][j].label) << "query " << q << " rank " << j;
+        EXPECT_EQ(after[j].distance, before[i][j].distance) << "query " << q << " rank " << j;
+      }
+    }
+  }
+}
+
+TEST_F(DiskCollectionMemtableTest, BatchSearchSeesPendingRows) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  const auto vectors = make_vectors(50, 3);
+  add(col, std::vector<float>(vectors.begin(), vectors.begin() + 25 * kDim), 0);
+  col.flush();
+  add(col, std::vector<float>(vectors.begin() + 25 * kDim, vectors.end()), 25);
+
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  std::vector<uint64_t> labels(50, std::numeric_limits<uint64_t>::max());
+  std::vector<float> distances(50, std::numeric_limits<float>::quiet_NaN());
+  col.batch_search(vectors.data(), 50, opts, 4, labels.data(), distances.data());
+  for (uint64_t q = 0; q < 50; ++q) {
+    EXPECT_EQ(labels[q], q);
+    EXPECT_EQ(distances[q], 0.0F);
+  }
+}
+
+TEST_F(DiskCollectionMemtableTest, MemtableAccumulatesAcrossBatchesAndVamanaFlush) {
+  const auto path = tmp_root_ / "coll";
+  VamanaSegmentBuildParams params;
+  params.R = 16;
+  params.L = 32;
+  params.num_threads = 1;
+  DiskCollection col(path,
+                     kDim,
+                     MetricType::L2,
+                     DiskIndexType::Vamana,
+                     DiskCollection::kDefaultMaxPendingBytes,
+                     params);
+  const auto vectors = make_vectors(90, 4);
+  for (uint64_t b = 0; b < 3; ++b) {
+    add(col,
+        std::vector<float>(vectors.begin() + b * 30 * kDim, vectors.begin() + (b + 1) * 30 * kDim),
+        b * 30);
+  }
+  EXPECT_EQ(col.pending_size(), 90U);
+
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  opts.ef = 64;
+  for (uint64_t q = 0; q < 90; q += 7) {
+    EXPECT_EQ(col.search(vectors.data() + q * kDim, opts).at(0).label, q);
+  }
+
+  col.flush();
+  EXPECT_EQ(col.segment_count(), 1U);
+  EXPECT_EQ(col.size(), 90U);
+  uint32_t found = 0;
+  for (uint64_t q = 0; q < 90; ++q) {
+    found += col.search(vectors.data() + q * kDim, opts).at(0).label == q ? 1 : 0;
+  }
+  EXPECT_GE(found, 85U);
+}
+
+TEST_F(DiskCollectionMemtableTest, FailedFlushKeepsRowsSearchable) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Vamana);
+  const auto vectors = make_vectors(1, 5);
+  add(col, vectors, 7);
+  EXPECT_THROW(col.flush(), std::runtime_error);  // disk_vamana needs 2 rows
+  EXPECT_EQ(col.pending_size(), 1U);
+
+  DiskSearchOptions opts;
+  opts.top_k = 2;
+  EXPECT_EQ(col.search(vectors.data(), opts).size(), 1U);
+}
+
+TEST_F(DiskCollectionMemtableTest, AddBatchRejectsLabelsAlreadyPendingOrPublished) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  add(col, make_vectors(4, 1), 0);
+  col.flush();
+  add(col, make_vectors(2, 2), 10);
+
+  const auto one = make_vectors(2, 3);
+  const std::vector<uint64_t> published{20, 3};
+  EXPECT_THROW(col.add_batch(one.data(), published.data(), 2), std::invalid_argument);
+  const std::vector<uint64_t> pending{20, 11};
+  EXPECT_THROW(col.add_batch(one.data(), pending.data(), 2), std::invalid_argument);
+  const std::vector<uint64_t> within{20, 20};
+  EXPECT_THROW(col.add_batch(one.data(), within.data(), 2), std::invalid_argument);
+  EXPECT_EQ(col.pending_size(), 2U);
+
+  // A rejected batch claims none of its labels, and a deleted label is free.
+  ASSERT_TRUE(col.mark_deleted(3));
+  const std::vector<uint64_t> fresh{20, 3};
+  col.add_batch(one.data(), fresh.data(), 2);
+  EXPECT_EQ(col.pending_size(), 4U);
+
+  DiskSearchOptions opts;
+  opts.top_k = 10;
+  const auto hits = col.search(one.data(), opts);
+  EXPECT_EQ(std::count_if(hits.begin(), hits.end(), [](const DiskSearchHit &h) {
+              return h.label == 3;
+            }),
+            1);
+  col.flush();
+  EXPECT_EQ(col.size(), 7U);
+}
+
+TEST_F(DiskCollectionMemtableTest, DeletesReachPendingRows) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  const auto vectors = make_vectors(20, 6);
+  add(col, vectors, 0);
+
+  EXPECT_EQ(col.mark_deleted(std::vector<uint64_t>{4, 9, 9, 500}.data(), 4), 2U);
+  EXPECT_FALSE(col.mark_deleted(4));
+  EXPECT_TRUE(col.is_deleted(4));
+  EXPECT_FALSE(col.is_deleted(5));
+  EXPECT_EQ(col.pending_size(), 18U);
+
+  DiskSearchOptions opts;
+  opts.top_k = 20;
+  const auto is_gone = [](const std::vector<DiskSearchHit> &hits) {
+    return std::none_of(hits.begin(), hits.end(), [](const DiskSearchHit &h) {
+      return h.label == 4 || h.label == 9;
+    });
+  };
+  auto hits = col.search(vectors.data() + 4 * kDim, opts);
+  EXPECT_EQ(hits.size(), 18U);
+  EXPECT_TRUE(is_gone(hits));
+
+  col.flush();
+  EXPECT_EQ(col.pending_size(), 0U);
+  EXPECT_EQ(col.size(), 18U);
+  hits = col.search(vectors.data() + 4 * kDim, opts);
+  EXPECT_EQ(hits.size(), 18U);
+  EXPECT_TRUE(is_gone(hits));
+
+  // The freed label can be written again, pending and after the flush.
+  const uint64_t again = 9;
+  col.add_batch(vectors.data() + 9 * kDim, &again, 1);
+  EXPECT_FALSE(col.is_deleted(9));
+  EXPECT_EQ(col.search(vectors.data() + 9 * kDim, opts).at(0).label, 9U);
+  col.flush();
+  EXPECT_EQ(col.size(), 19U);
+  EXPECT_EQ(col.search(vectors.data() + 9 * kDim, opts).at(0).label, 9U);
+
+  // A flush whose rows were all deleted publishes nothing.
+  add(col, make_vectors(2, 7), 100);
+  EXPECT_EQ(col.mark_deleted(std::vector<uint64_t>{100, 101}.data(), 2), 2U);
+  const auto segments = col.segment_count();
+  col.flush();
+  EXPECT_EQ(col.segment_count(), segments);
+  EXPECT_EQ(col.pending_size(), 0U);
+}
+
+TEST_F(DiskCollectionMemtableTest, DeletesRacingFlushStayDeleted) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  constexpr uint64_t kBatches = 100;
+  constexpr uint64_t kRows = 16;
+  std::atomic<uint64_t> added{0};
+  std::thread writer([&]() {
+    for (uint64_t b = 0; b < kBatches; ++b) {
+      add(col, make_vectors(kRows, static_cast<uint32_t>(b)), b * kRows);
+      added = (b + 1) * kRows;
+    }
+  });
+  std::thread deleter([&]() {
+    for (uint64_t label = 0; label < kBatches * kRows; label += 3) {
+      while (added.load() <= label) {
+        std::this_thread::yield();
+      }
+      EXPECT_TRUE(col.mark_deleted(label)) << label;
+    }
+  });
+  while (added.load() < kBatches * kRows) {
+    col.flush();
+  }
+  writer.join();
+  deleter.join();
+  col.flush();
+
+  constexpr uint64_t kDeleted = (kBatches * kRows + 2) / 3;
+  EXPECT_EQ(col.size(), kBatches * kRows - kDeleted);
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  for (uint64_t label = 0; label < kBatches * kRows; label += 3) {
+    const auto batch = make_vectors(kRows, static_cast<uint32_t>(label / kRows));
+    EXPECT_NE(col.search(batch.data() + (label % kRows) * kDim, opts).at(0).label, label);
+  }
+}
+
+TEST_F(DiskCollectionMemtableTest, AddBatchRunsWhileFlushBuilds) {
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Flat);
+  constexpr uint64_t kBatches = 200;
+  constexpr uint64_t kRows = 16;
+  std::atomic<bool> done{false};
+  std::thread writer([&]() {
+    for (uint64_t b = 0; b < kBatches; ++b) {
+      add(col, make_vectors(kRows, static_cast<uint32_t>(b)), b * kRows);
+    }
+    done = true;
+  });
+  while (!done) {
+    col.flush();
+  }
+  writer.join();
+  col.flush();
+  EXPECT_EQ(col.pending_size(), 0U);
+  EXPECT_EQ(col.size(), kBatches * kRows);
+  for (uint64_t label = 0; label < kBatches * kRows; label += 97) {
+    EXPECT_FALSE(col.is_deleted(label));
+    EXPECT_TRUE(col.mark_deleted(label)) << label;
+  }
+}
+
+TEST(DiskMemtableTest, DropFrontKeepsRowsAppendedLater) {
+  const auto a = std::vector<float>(2 * kDim, 1.0F);
+  const std::vector<uint64_t> la{1, 2};
+  const auto first = DiskMemtable::append(nullptr, kDim, MetricType::L2, a.data(), la.data(), 2);
+  const auto b = std::vector<float>(kDim, 2.0F);
+  const uint64_t lb = 3;
+  const auto second = DiskMemtable::append(first, kDim, MetricType::L2, b.data(), &lb, 1);
+
+  EXPECT_EQ(DiskMemtable::drop_front(second, first->chunks().size())->size(), 1U);
+  EXPECT_EQ(DiskMemtable::drop_front(first, first->chunks().size()), nullptr);
+}
+
+TEST(DiskMemtableTest, TiesAndNaNOrderLikeTheCollectionMerge) {
+  std::vector<float> rows(3 * kDim, 1.0F);
+  std::fill_n(rows.begin(), kDim, std::numeric_limits<float>::quiet_NaN());
+  const std::vector<uint64_t> labels{1, 9, 4};
+  const auto memtable =
+      DiskMemtable::append(nullptr, kDim, MetricType::L2, rows.data(), labels.data(), 3);
+  const std::vector<float> query(kDim, 0.0F);
+  DiskSearchOptions opts;
+  opts.top_k = 3;
+  auto hits = memtable->search(query.data(), opts);
+  ASSERT_EQ(hits.size(), 3U);
+  EXPECT_EQ(hits[0].label, 4U);
+  EXPECT_EQ(hits[1].label, 9U);
+  EXPECT_EQ(hits[2].label, 1U);  // NaN sorts last
+
+  opts.top_k = 2;
+  hits = memtable->search(query.data(), opts);
+  ASSERT_EQ(hits.size(), 2U);
+  EXPECT_EQ(hits[0].label, 4U);
+  EXPECT_EQ(hits[1].label, 9U);
+}
+
+}  // namespace alaya::disk
@@ -8,8 +8,10 @@
 #include <cstdint>
 #include <filesystem>  // NOLINT(build/c++17)
 #include <fstream>
+#include <limits>
 #include <numeric>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "index/disk/disk_collection.hpp"
@@ -141,8 +143,9 @@ TEST_F(DiskCollectionVamanaTest, duplicate_label_across_vamana_segments_throws)
 
   auto v2 = make_vectors(4, kDim, 5);
   std::vector<uint64_t> l2{42, 1000, 1001, 1002};
-  col.add_batch(v2.data(), l2.data(), l2.size());
-  EXPECT_THROW(col.flush(), std::invalid_argument);
+  EXPECT_THROW(col.add_batch(v2.data(), l2.data(), l2.size()), std::invalid_argument);
+  EXPECT_EQ(col.pending_size(), 0U);
+  col.flush();
   EXPECT_FALSE(std::filesystem::exists(path / "segments" / "seg_00000002"));
 }
 
@@ -183,18 +186,37 @@ TEST_F(DiskCollectionVamanaTest, open_rejects_invalid_vamana_params) {
   EXPECT_FALSE(std::filesystem::exists(path / "segments" / "seg_00000001"));
 }
 
-TEST_F(DiskCollectionVamanaTest, open_rejects_unsupported_vamana_metric) {
-  const auto path = tmp_root_ / "coll";
-  std::filesystem::create_directories(path / "segments");
-  std::ofstream manifest(path / "collection_manifest.txt");
-  manifest << "version=1\n"
-           << "dim=4\n"
-           << "metric=IP\n"
-           << "index_type=disk_vamana\n"
-           << "next_segment_id=1\n";
-  manifest.close();
+TEST_F(DiskCollectionVamanaTest, ip_and_cos_segments_match_exact_pending_search) {
+  constexpr uint32_t kDim = 16;
+  constexpr uint64_t kN = 300;
+  auto vectors = make_vectors(kN, kDim, 7);
+  auto ids = labels(kN);
+  auto queries = make_vectors(30, kDim, 8);
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  opts.ef = 64;
 
-  EXPECT_THROW((void)DiskCollection::open(path), std::runtime_error);
+  for (const auto metric : {MetricType::IP, MetricType::COS}) {
+    const auto path = tmp_root_ / ("coll_" + std::to_string(static_cast<int>(metric)));
+    std::vector<uint64_t> exact;
+    {
+      DiskCollection col(path, kDim, metric, DiskIndexType::Vamana);
+      col.add_batch(vectors.data(), ids.data(), kN);
+      // Pending rows are scanned exactly, which gives the reference answer.
+      for (uint64_t q = 0; q < 30; ++q) {
+        exact.push_back(col.search(queries.data() + q * kDim, opts).at(0).label);
+      }
+      col.flush();
+    }
+
+    auto reopened = DiskCollection::open(path);
+    EXPECT_EQ(CollectionManifest::load(path / "collection_manifest.txt").metric, metric);
+    uint32_t agree = 0;
+    for (uint64_t q = 0; q < 30; ++q) {
+      agree += reopened.search(queries.data() + q * kDim, opts).at(0).label == exact[q] ? 1 : 0;
+    }
+    EXPECT_GE(agree, 28u) << "metric " << static_cast<int>(metric);
+  }
 }
 
 TEST_F(DiskCollectionVamanaTest, max_pending_bytes_survives_reopen) {
@@ -252,23 +274,41 @@ TEST_F(DiskCollectionVamanaTest, laser_still_rejected) {
   }
 }
 
-TEST_F(DiskCollectionVamanaTest, vamana_ip_flush_rejected_by_engine) {
+TEST_F(DiskCollectionVamanaTest, vamana_cos_add_batch_rejects_zero_row) {
   constexpr uint32_t kDim = 8;
   const auto path = tmp_root_ / "coll";
-  DiskCollection col(path, kDim, MetricType::IP, DiskIndexType::Vamana);
+  DiskCollection col(path, kDim, MetricType::COS, DiskIndexType::Vamana);
   auto vectors = make_vectors(32, kDim, 8);
+  std::fill_n(vectors.begin() + 3 * kDim, kDim, 0.0F);
   auto ids = labels(32);
+  EXPECT_THROW(col.add_batch(vectors.data(), ids.data(), ids.size()), std::invalid_argument);
+  EXPECT_EQ(col.pending_size(), 0u);
+
+  // Nothing was buffered, so the same labels go in cleanly once the row is fixed.
+  vectors[3 * kDim] = 1.0F;
   col.add_batch(vectors.data(), ids.data(), ids.size());
+  col.flush();
+  EXPECT_EQ(col.pending_size(), 0u);
+  EXPECT_EQ(col.size(), 32u);
+  EXPECT_TRUE(std::filesystem::exists(path / "segments" / "seg_00000001"));
+}
 
-  try {
-    col.flush();
-    FAIL() << "expected Vamana IP rejection";
-  } catch (const std::runtime_error &e) {
-    const std::string msg = e.what();
-    EXPECT_NE(msg.find("ip"), std::string::npos) << msg;
-    EXPECT_NE(msg.find("not implemented in v1"), std::string::npos) << msg;
-  }
-  EXPECT_FALSE(std::filesystem::exists(path / "segments" / "seg_00000001"));
+TEST_F(DiskCollectionVamanaTest, add_batch_rejects_non_finite_row) {
+  constexpr uint32_t kDim = 8;
+  const auto path = tmp_root_ / "coll";
+  DiskCollection col(path, kDim, MetricType::L2, DiskIndexType::Vamana);
+  auto vectors = make_vectors(32, kDim, 9);
+  vectors[5 * kDim + 2] = std::numeric_limits<float>::quiet_NaN();
+  auto ids = labels(32);
+  EXPECT_THROW(col.add_batch(vectors.data(), ids.data(), ids.size()), std::invalid_argument);
+  vectors[5 * kDim + 2] = std::numeric_limits<float>::infinity();
+  EXPECT_THROW(col.add_batch(vectors.data(), ids.data(), ids.size()), std::invalid_argument);
+  EXPECT_EQ(col.pending_size(), 0u);
+
+  vectors[5 * kDim + 2] = 0.5F;
+  col.add_batch(vectors.data(), ids.data(), ids.size());
+  col.flush();
+  EXPECT_EQ(col.size(), 32u);
 }
 
 }  // namespace
@@ -283,13 +283,13 @@ TEST_F(LaserSegmentSearcherConcurrentSearchTest,
   EXPECT_EQ(exceptions.load(std::memory_order_relaxed), 0);
 }
 
-TEST_F(LaserSegmentSearcherConcurrentSearchTest, two_threads_same_params_apply_set_params_once) {
+TEST_F(LaserSegmentSearcherConcurrentSearchTest, two_threads_same_params_keep_thread_pool) {
   if (const auto reason = fixture_skip_reason(); !reason.empty()) {
     GTEST_SKIP() << reason;
   }
   import_fixture();
   LaserSegmentSearcher searcher(seg_dir_);
-  ASSERT_EQ(searcher.set_params_call_count(), 0U);
+  const auto builds = searcher.thread_pool_build_count();
 
   const auto query = fixture_query(7);
   DiskSearchOptions opts;
@@ -301,17 +301,16 @@ TEST_F(LaserSegmentSearcherConcurrentSearchTest, two_threads_same_params_apply_s
   std::thread t2([&] { (void)searcher.search(query.data(), opts); });
   t1.join();
   t2.join();
-  EXPECT_EQ(searcher.set_params_call_count(), 1U);
+  EXPECT_EQ(searcher.thread_pool_build_count(), builds);
 }
 
-TEST_F(LaserSegmentSearcherConcurrentSearchTest,
-       two_threads_distinct_ef_apply_set_params_one_or_two_times) {
+TEST_F(LaserSegmentSearcherConcurrentSearchTest, two_threads_distinct_ef_keep_thread_pool) {
   if (const auto reason = fixture_skip_reason(); !reason.empty()) {
     GTEST_SKIP() << reason;
   }
   import_fixture();
   LaserSegmentSearcher searcher(seg_dir_);
-  ASSERT_EQ(searcher.set_params_call_count(), 0U);
+  const auto builds = searcher.thread_pool_build_count();
 
   const auto query = fixture_query(13);
   DiskSearchOptions opts_a;
@@ -327,17 +326,16 @@ TEST_F(LaserSegmentSearcherConcurrentSearchTest,
   std::thread t_b([&] { (void)searcher.search(query.data(), opts_b); });
   t_a.join();
   t_b.join();
-  const auto count = searcher.set_params_call_count();
-  EXPECT_GE(count, 1U);
-  EXPECT_LE(count, 2U);
+  EXPECT_EQ(searcher.thread_pool_build_count(), builds);
 }
 
-TEST_F(LaserSegmentSearcherConcurrentSearchTest, argument_validation_throws_before_lock) {
+TEST_F(LaserSegmentSearcherConcurrentSearchTest, argument_validation_throws_before_search) {
   if (const auto reason = fixture_skip_reason(); !reason.empty()) {
     GTEST_SKIP() << reason;
   }
   import_fixture();
   LaserSegmentSearcher searcher(seg_dir_);
+  const auto builds = searcher.thread_pool_build_count();
 
   const auto expect_invalid_argument_with =
       [&searcher](const std::function<void()> &fn, const std::string &needle) {
@@ -372,10 +370,8 @@ TEST_F(LaserSegmentSearcherConcurrentSearchTest, argument_validation_throws_befo
   expect_invalid_argument_with(
       [&] { (void)searcher.search(query.data(), opts_overflow); }, "beam_width exceeds int max");
 
-  // Counter at zero is the indirect proof that none of the three throws ran the
-  // search body — including its mutex acquisition (apply_set_params is the only
-  // place that bumps it, and it sits inside the locked region).
-  EXPECT_EQ(searcher.set_params_call_count(), 0U);
+  // None of the three throws may reach the graph: the pool is untouched.
+  EXPECT_EQ(searcher.thread_pool_build_count(), builds);
 }
 
 }  // namespace
@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>  // NOLINT(build/c++17)
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "index/disk/laser_segment_importer.hpp"
+#include "index/disk/laser_segment_searcher.hpp"
+#include "index/disk/segment_factory.hpp"
+#include "index/disk/segment_manifest.hpp"
+#include "index/disk/types.hpp"
+#include "utils/metric_type.hpp"
+
+#ifndef ALAYA_LASER_FIXTURE_DIR
+  #define ALAYA_LASER_FIXTURE_DIR ""
+#endif
+
+#ifndef ALAYA_LASER_FIXTURE_PREFIX
+  #define ALAYA_LASER_FIXTURE_PREFIX "dsqg_seg_00000001"
+#endif
+
+namespace alaya::disk {
+namespace {
+
+constexpr uint32_t kFixtureDim = 128;
+constexpr uint64_t kFixtureCount = 2048;
+constexpr uint32_t kFixtureR = 64;
+constexpr uint32_t kQueries = 2000;
+constexpr uint32_t kTopK = 10;
+constexpr uint32_t kEf = 64;
+constexpr uint32_t kBeamWidth = 4;
+constexpr uint32_t kSearchThreads = 8;
+
+auto fixture_dir() -> std::filesystem::path {
+  return std::filesystem::path(ALAYA_LASER_FIXTURE_DIR);
+}
+
+auto fixture_prefix() -> std::string { return std::string(ALAYA_LASER_FIXTURE_PREFIX); }
+
+auto fixture_has_required_files(const std::filesystem::path &dir) -> bool {
+  if (dir.empty()) {
+    return false;
+  }
+  const auto index = fixture_prefix() + "_R" + std::to_string(kFixtureR) + "_MD" +
+                     std::to_string(kFixtureDim) + ".index";
+  const std::vector<std::string> required = {
+      index,
+      index + "_rotator",
+      index + "_cache_ids",
+      index + "_cache_nodes",
+      fixture_prefix() + "_input.fbin",
+  };
+  return std::all_of(required.begin(), required.end(), [&](const auto &name) {
+    std::error_code ec;
+    const auto path = dir / name;
+    return std::filesystem::is_regular_file(path, ec) && !ec &&
+           std::filesystem::file_size(path, ec) > 0 && !ec;
+  });
+}
+
+auto read_fixture_vectors() -> std::vector<float> {
+  const auto path = fixture_dir() / (fixture_prefix() + "_input.fbin");
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("failed to open fixture vectors: " + path.string());
+  }
+  int32_t count = 0;
+  int32_t dim = 0;
+  input.read(reinterpret_cast<char *>(&count), sizeof(count));
+  input.read(reinterpret_cast<char *>(&dim), sizeof(dim));
+  if (count != static_cast<int32_t>(kFixtureCount) || dim != static_cast<int32_t>(kFixtureDim)) {
+    throw std::runtime_error("unexpected fixture vector header in " + path.string());
+  }
+  std::vector<float> out(static_cast<size_t>(count) * static_cast<size_t>(dim));
+  input.read(reinterpret_cast<char *>(out.data()),
+             static_cast<std::streamsize>(out.size() * sizeof(float)));
+  if (!input) {
+    throw std::runtime_error("short fixture vector read: " + path.string());
+  }
+  return out;
+}
+
+// Runs kQueries searches split across `threads` workers that share an atomic
+// cursor, the same dispatch shape DiskCollection::batch_search uses. When
+// `results` is non-null, query q's hits are stored in (*results)[q].
+auto measure_qps(const LaserSegmentSearcher &searcher,
+                 const std::vector<float> &vectors,
+                 uint32_t threads,
+                 std::vector<std::vector<DiskSearchHit>> *results = nullptr) -> double {
+  DiskSearchOptions opts;
+  opts.top_k = kTopK;
+  opts.ef = kEf;
+  opts.beam_width = kBeamWidth;
+  if (results != nullptr) {
+    results->assign(kQueries, {});
+  }
+
+  std::atomic<uint32_t> next{0};
+  std::atomic<bool> go{false};
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (uint32_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (uint32_t q = next.fetch_add(1); q < kQueries; q = next.fetch_add(1)) {
+        const uint64_t row = (static_cast<uint64_t>(q) * 37U + 11U) % kFixtureCount;
+        auto hits = searcher.search(vectors.data() + row * kFixtureDim, opts);
+        if (results != nullptr) {
+          (*results)[q] = std::move(hits);
+        }
+      }
+    });
+  }
+  const auto t0 = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto &w : workers) {
+    w.join();
+  }
+  const auto t1 = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(t1 - t0).count();
+  return static_cast<double>(kQueries) / std::max(seconds, 1e-9);
+}
+
+class LaserSearcherThroughputTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!engine_supported_v1(DiskIndexType::Laser)) {
+      GTEST_SKIP() << "disk_laser is not registered in this build";
+    }
+    if (!fixture_has_required_files(fixture_dir())) {
+      GTEST_SKIP() << "LASER fixture is missing or incomplete under " << fixture_dir();
+    }
+
+    root_ = std::filesystem::temp_directory_path() /
+            ("alaya_laser_throughput_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_);
+    seg_dir_ = root_ / "seg_00000001";
+    {
+      LaserSegmentImporter importer(kFixtureDim, MetricType::L2, {});
+      std::vector<uint64_t> ids(kFixtureCount);
+      std::iota(ids.begin(), ids.end(), 0);
+      (void)importer.import_from(fixture_dir(), ids.data(), ids.size(), seg_dir_);
+    }
+    // Pin the pool size so every host runs the same searcher.
+    {
+      auto manifest = SegmentManifest::load(seg_dir_ / "manifest.txt");
+      manifest.x_extras["x_laser_search_threads"] = std::to_string(kSearchThreads);
+      manifest.save(seg_dir_ / "manifest.txt");
+    }
+    vectors_ = read_fixture_vectors();
+  }
+
+  void TearDown() override {
+    if (!root_.empty()) {
+      std::error_code ec;
+      std::filesystem::remove_all(root_, ec);
+    }
+  }
+
+  std::filesystem::path root_;
+  std::filesystem::path seg_dir_;
+  std::vector<float> vectors_;
+};
+
+}  // namespace
+
+// The search processes disk reads in completion order, so I/O timing can steer
+// it to a slightly different candidate set: concurrent results must agree with
+// a single-threaded run statistically, not byte for byte. The searcher has no
+// rerank, so every hit carries a NaN distance and only labels are compared.
+TEST_F(LaserSearcherThroughputTest, concurrent_results_agree_with_single_thread) {
+  LaserSegmentSearcher searcher(seg_dir_);
+  std::vector<std::vector<DiskSearchHit>> expected;
+  std::vector<std::vector<DiskSearchHit>> actual;
+  (void)measure_qps(searcher, vectors_, 1, &expected);
+  (void)measure_qps(searcher, vectors_, kSearchThreads, &actual);
+
+  uint64_t shared = 0;
+  for (uint32_t q = 0; q < kQueries; ++q) {
+    ASSERT_EQ(actual[q].size(), kTopK) << "query " << q;
+    ASSERT_EQ(expected[q].size(), kTopK) << "query " << q;
+    for (const auto &hit : actual[q]) {
+      if (std::any_of(expected[q].begin(), expected[q].end(), [&](const auto &e) {
+            return e.label == hit.label;
+          })) {
+        ++shared;
+      }
+    }
+  }
+  const double overlap = static_cast<double>(shared) / (static_cast<double>(kQueries) * kTopK);
+  RecordProperty("top_k_overlap", std::to_string(overlap));
+  EXPECT_GE(overlap, 0.95);
+}
+
+// Each thread count keeps the best of a few rounds to ride out scheduler noise,
+// and the bar sits well below the pool's real speedup: it only has to rule out
+// a global search lock, which pins the ratio at ~1.0.
+TEST_F(LaserSearcherThroughputTest, qps_scales_with_thread_count) {
+  const uint32_t hw = std::thread::hardware_concurrency();
+  if (hw < 4) {
+    GTEST_SKIP() << "scaling check needs at least 4 hardware threads, have " << hw;
+  }
+  constexpr int kRounds = 3;
+  const uint32_t max_threads = std::min(kSearchThreads, hw);
+  LaserSegmentSearcher searcher(seg_dir_);
+  (void)measure_qps(searcher, vectors_, 1);  // warm the page cache and the pool
+
+  double single_qps = 0.0;
+  double best_multi_qps = 0.0;
+  for (uint32_t threads = 1; threads <= max_threads; threads *= 2) {
+    double qps = 0.0;
+    for (int round = 0; round < kRounds; ++round) {
+      qps = std::max(qps, measure_qps(searcher, vectors_, threads));
+    }
+    RecordProperty("qps_threads_" + std::to_string(threads), std::to_string(qps));
+    if (threads == 1) {
+      single_qps = qps;
+    } else {
+      best_multi_qps = std::max(best_multi_qps, qps);
+    }
+  }
+  EXPECT_GT(best_multi_qps, 1.2 * single_qps)
+      << "single=" << single_qps << " best_multi=" << best_multi_qps;
+}
+
+}  // namespace alaya::disk
@@ -357,7 +357,7 @@ TEST_F(LaserSegmentSearcherTest, distance_is_nan_in_v1) {
   }
 }
 
-TEST_F(LaserSegmentSearcherTest, set_params_skipped_on_repeat) {
+TEST_F(LaserSegmentSearcherTest, repeat_search_does_not_rebuild_thread_pool) {
   if (const auto reason = fixture_skip_reason(); !reason.empty()) {
     GTEST_SKIP() << reason;
   }
@@ -372,14 +372,15 @@ TEST_F(LaserSegmentSearcherTest, set_params_skipped_on_repeat) {
   opts.ef = 64;
   opts.beam_width = 4;
 
-  EXPECT_EQ(searcher.set_params_call_count(), 0U);
+  const auto builds = searcher.thread_pool_build_count();
+  EXPECT_GE(builds, 1U);
   (void)searcher.search(query.data(), opts);
-  EXPECT_EQ(searcher.set_params_call_count(), 1U);
+  EXPECT_EQ(searcher.thread_pool_build_count(), builds);
   (void)searcher.search(query.data(), opts);
-  EXPECT_EQ(searcher.set_params_call_count(), 1U);
+  EXPECT_EQ(searcher.thread_pool_build_count(), builds);
 }
 
-TEST_F(LaserSegmentSearcherTest, set_params_called_on_change) {
+TEST_F(LaserSegmentSearcherTest, param_change_does_not_rebuild_thread_pool) {
   if (const auto reason = fixture_skip_reason(); !reason.empty()) {
     GTEST_SKIP() << reason;
   }
@@ -395,13 +396,20 @@ TEST_F(LaserSegmentSearcherTest, set_params_called_on_change) {
   first.beam_width = 4;
 
   DiskSearchOptions second = first;
-  second.ef = 64;
-  second.beam_width = 8;
+  second.ef = 256;
+  second.beam_width = 32;
 
-  (void)searcher.search(query.data(), first);
-  EXPECT_EQ(searcher.set_params_call_count(), 1U);
+  const auto builds = searcher.thread_pool_build_count();
+  const auto first_hits = searcher.search(query.data(), first);
   (void)searcher.search(query.data(), second);
-  EXPECT_EQ(searcher.set_params_call_count(), 2U);
+  EXPECT_EQ(searcher.thread_pool_build_count(), builds);
+
+  // Growing a pooled ThreadData for `second` must not leak into `first`.
+  const auto again = searcher.search(query.data(), first);
+  ASSERT_EQ(again.size(), first_hits.size());
+  for (size_t i = 0; i < again.size(); ++i) {
+    EXPECT_EQ(again[i].label, first_hits[i].label) << "rank " << i;
+  }
 }
 
 TEST_F(LaserSegmentSearcherTest, search_does_not_reopen_files) {
@@ -176,25 +176,33 @@ TEST_F(SegmentFactoryVamanaTest, laser_still_unsupported) {
   }
 }
 
-TEST_F(SegmentFactoryVamanaTest, vamana_ip_throws_through_engine) {
+TEST_F(SegmentFactoryVamanaTest, vamana_ip_builds_through_engine) {
   constexpr uint32_t kDim = 4;
   auto vectors = make_vectors(32, kDim, 5);
   auto ids = labels(32);
   const auto seg_dir = seg_parent_ / "seg_00000001";
 
-  try {
-    (void)create_segment_from_pending(seg_dir,
-                                      manifest(DiskIndexType::Vamana, kDim, MetricType::IP),
-                                      vectors.data(), ids.data(), ids.size());
-    FAIL() << "expected Vamana IP rejection";
-  } catch (const std::runtime_error &e) {
-    const std::string msg = e.what();
-    EXPECT_NE(msg.find("ip"), std::string::npos) << msg;
-    EXPECT_NE(msg.find("not implemented in v1"), std::string::npos) << msg;
-  }
-  EXPECT_FALSE(std::filesystem::exists(seg_dir));
-  for (const auto &entry : std::filesystem::directory_iterator(seg_parent_)) {
-    EXPECT_FALSE(entry.path().filename().string().starts_with(".tmp_seg_"));
+  auto searcher = create_segment_from_pending(seg_dir,
+                                              manifest(DiskIndexType::Vamana, kDim, MetricType::IP),
+                                              vectors.data(), ids.data(), ids.size());
+  ASSERT_NE(searcher, nullptr);
+  EXPECT_EQ(searcher->type(), DiskIndexType::Vamana);
+  EXPECT_TRUE(std::filesystem::exists(seg_dir));
+
+  // IP distances are the negated inner product with the stored row.
+  const float *query = vectors.data() + 7 * kDim;
+  DiskSearchOptions opts;
+  opts.top_k = 3;
+  opts.ef = 32;
+  const auto hits = searcher->search(query, opts);
+  ASSERT_FALSE(hits.empty());
+  for (const auto &hit : hits) {
+    const float *row = vectors.data() + (hit.label - 1000) * kDim;
+    float ip = 0.0F;
+    for (uint32_t c = 0; c < kDim; ++c) {
+      ip += query[c] * row[c];
+    }
+    EXPECT_NEAR(hit.distance, -ip, 1e-4F);
   }
 }
 
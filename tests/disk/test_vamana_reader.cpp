@@ -113,6 +113,11 @@ void overwrite_uint64_at(const std::filesystem::path &path, uint64_t offset, uin
   f.close();
 }
 
+std::vector<uint32_t> neighbors_of(const alaya::vamana::VamanaReader &reader, uint32_t id) {
+  const auto nbrs = reader.neighbors(id);
+  return {nbrs.begin(), nbrs.end()};
+}
+
 // Run `fn`, capture the runtime_error message. Fail the test if `fn`
 // did not throw a runtime_error.
 template <typename Fn>
@@ -158,10 +163,13 @@ TEST_F(VamanaReaderTest, LoadsWriterOutput) {
   EXPECT_EQ(reader.frozen_pts(), 0u);
   EXPECT_EQ(reader.num_nodes(), static_cast<size_t>(N));
 
-  ASSERT_EQ(reader.graph().size(), br.graph.size());
+  ASSERT_EQ(reader.num_nodes(), br.graph.size());
+  ASSERT_EQ(reader.offsets().size(), br.graph.size() + 1);
+  EXPECT_EQ(reader.offsets().back(), reader.neighbor_array().size());
   for (size_t i = 0; i < br.graph.size(); ++i) {
+    const auto nbrs = reader.neighbors(static_cast<uint32_t>(i));
     std::unordered_set<uint32_t> expected(br.graph[i].begin(), br.graph[i].end());
-    std::unordered_set<uint32_t> actual(reader.graph()[i].begin(), reader.graph()[i].end());
+    std::unordered_set<uint32_t> actual(nbrs.begin(), nbrs.end());
     EXPECT_EQ(expected, actual) << "node " << i;
   }
 }
@@ -184,8 +192,8 @@ TEST_F(VamanaReaderTest, SaveGraphWritesBareFilename) {
   EXPECT_EQ(reader.num_nodes(), 2u);
   EXPECT_EQ(reader.max_degree(), 1u);
   EXPECT_EQ(reader.start(), 0u);
-  EXPECT_EQ(reader.graph()[0], std::vector<uint32_t>{1});
-  EXPECT_EQ(reader.graph()[1], std::vector<uint32_t>{0});
+  EXPECT_EQ(neighbors_of(reader, 0), std::vector<uint32_t>{1});
+  EXPECT_EQ(neighbors_of(reader, 1), std::vector<uint32_t>{0});
 
   std::filesystem::remove_all(root, ec);
 }
@@ -329,13 +337,13 @@ TEST_F(VamanaReaderTest, SurvivesFileDeletion) {
   // Don't track for teardown — we delete inside the test.
 
   alaya::vamana::VamanaReader reader{br.path};
-  std::vector<uint32_t> neighbors_before = reader.graph()[0];
+  std::vector<uint32_t> neighbors_before = neighbors_of(reader, 0);
 
   std::error_code ec;
   std::filesystem::remove(br.path, ec);
   ASSERT_FALSE(std::filesystem::exists(br.path));
 
-  EXPECT_EQ(reader.graph()[0], neighbors_before);
+  EXPECT_EQ(neighbors_of(reader, 0), neighbors_before);
   EXPECT_EQ(reader.num_nodes(), static_cast<size_t>(N));
 }
 
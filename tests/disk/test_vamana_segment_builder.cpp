@@ -12,6 +12,7 @@
 #include <numeric>
 #include <random>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include "index/disk/segment_manifest.hpp"
@@ -163,7 +164,7 @@ TEST_F(VamanaSegmentBuilderTest, finish_refuses_existing_seg_dir) {
   EXPECT_TRUE(std::filesystem::exists(seg_dir / "marker.txt"));
 }
 
-TEST_F(VamanaSegmentBuilderTest, finish_rejects_ip_metric) {
+TEST_F(VamanaSegmentBuilderTest, finish_accepts_ip_metric) {
   constexpr uint32_t kDim = 4;
   auto vectors = make_vectors(32, kDim, 9);
   auto ids = labels(32);
@@ -171,18 +172,14 @@ TEST_F(VamanaSegmentBuilderTest, finish_rejects_ip_metric) {
 
   VamanaSegmentBuilder builder(kDim, MetricType::IP, default_params());
   builder.add_batch(vectors.data(), ids.data(), ids.size());
-  try {
-    (void)builder.finish(seg_dir);
-    FAIL() << "expected IP metric rejection";
-  } catch (const std::runtime_error &e) {
-    const std::string msg = e.what();
-    EXPECT_NE(msg.find("ip"), std::string::npos) << msg;
-    EXPECT_NE(msg.find("not implemented in v1"), std::string::npos) << msg;
-  }
-  EXPECT_FALSE(std::filesystem::exists(seg_dir));
+  const auto manifest = builder.finish(seg_dir);
+  EXPECT_EQ(manifest.metric, MetricType::IP);
+  EXPECT_EQ(SegmentManifest::load(seg_dir / "manifest.txt").metric, MetricType::IP);
+  // IP keeps the raw rows; the MIPS transform only shapes the graph.
+  EXPECT_EQ(read_floats(seg_dir / "vectors.f32.bin"), vectors);
 }
 
-TEST_F(VamanaSegmentBuilderTest, finish_rejects_cos_metric) {
+TEST_F(VamanaSegmentBuilderTest, finish_cos_stores_normalized_rows) {
   constexpr uint32_t kDim = 4;
   auto vectors = make_vectors(32, kDim, 10);
   auto ids = labels(32);
@@ -190,14 +187,29 @@ TEST_F(VamanaSegmentBuilderTest, finish_rejects_cos_metric) {
 
   VamanaSegmentBuilder builder(kDim, MetricType::COS, default_params());
   builder.add_batch(vectors.data(), ids.data(), ids.size());
-  try {
-    (void)builder.finish(seg_dir);
-    FAIL() << "expected COS metric rejection";
-  } catch (const std::runtime_error &e) {
-    const std::string msg = e.what();
-    EXPECT_NE(msg.find("cos"), std::string::npos) << msg;
-    EXPECT_NE(msg.find("not implemented in v1"), std::string::npos) << msg;
+  const auto manifest = builder.finish(seg_dir);
+  EXPECT_EQ(manifest.metric, MetricType::COS);
+  const auto stored = read_floats(seg_dir / "vectors.f32.bin");
+  ASSERT_EQ(stored.size(), vectors.size());
+  for (uint64_t r = 0; r < 32; ++r) {
+    double norm_sq = 0.0;
+    for (uint32_t c = 0; c < kDim; ++c) {
+      norm_sq += static_cast<double>(stored[r * kDim + c]) * stored[r * kDim + c];
+    }
+    EXPECT_NEAR(norm_sq, 1.0, 1e-5) << "row " << r;
   }
+}
+
+TEST_F(VamanaSegmentBuilderTest, finish_cos_rejects_zero_row) {
+  constexpr uint32_t kDim = 4;
+  auto vectors = make_vectors(32, kDim, 10);
+  std::fill_n(vectors.begin() + 5 * kDim, kDim, 0.0F);
+  auto ids = labels(32);
+  const auto seg_dir = seg_parent_ / "seg_00000006";
+
+  VamanaSegmentBuilder builder(kDim, MetricType::COS, default_params());
+  builder.add_batch(vectors.data(), ids.data(), ids.size());
+  EXPECT_THROW((void)builder.finish(seg_dir), std::invalid_argument);
   EXPECT_FALSE(std::filesystem::exists(seg_dir));
 }
 
@@ -70,11 +70,12 @@ class VamanaSegmentSearcherTest : public ::testing::Test {
   auto build_segment(uint64_t n,
                      uint32_t dim,
                      uint32_t seed,
-                     uint64_t label_base = 1000) -> std::filesystem::path {
+                     uint64_t label_base = 1000,
+                     MetricType metric = MetricType::L2) -> std::filesystem::path {
     vectors_ = make_vectors(n, dim, seed);
     labels_ = labels(n, label_base);
     const auto seg_dir = seg_parent_ / "seg_00000001";
-    VamanaSegmentBuilder builder(dim, MetricType::L2, params());
+    VamanaSegmentBuilder builder(dim, metric, params());
     builder.add_batch(vectors_.data(), labels_.data(), n);
     builder.finish(seg_dir);
     return seg_dir;
@@ -226,6 +227,29 @@ TEST_F(VamanaSegmentSearcherTest, reopen_results_stable) {
   }
 }
 
+TEST_F(VamanaSegmentSearcherTest, search_into_reuses_buffer_and_matches_search) {
+  constexpr uint32_t kDim = 16;
+  const auto seg_dir = build_segment(512, kDim, 6);
+  VamanaSegmentSearcher searcher(seg_dir);
+  DiskSearchOptions opts;
+  opts.top_k = 10;
+  opts.ef = 64;
+  std::vector<DiskSearchHit> out;
+  out.reserve(opts.top_k);
+  const DiskSearchHit *storage = out.data();
+  for (uint64_t q = 0; q < 8; ++q) {
+    const float *query = vectors_.data() + q * 31 * kDim;
+    searcher.search_into(query, opts, out);
+    const auto expected = searcher.search(query, opts);
+    ASSERT_EQ(out.size(), expected.size());
+    for (size_t i = 0; i < out.size(); ++i) {
+      EXPECT_EQ(out[i].label, expected[i].label);
+      EXPECT_FLOAT_EQ(out[i].distance, expected[i].distance);
+    }
+    EXPECT_EQ(out.data(), storage);  // filled in place, never reallocated
+  }
+}
+
 TEST_F(VamanaSegmentSearcherTest, recall_against_brute_force_l2) {
   constexpr uint32_t kDim = 16;
   constexpr uint32_t kN = 2048;
@@ -313,13 +337,52 @@ TEST_F(VamanaSegmentSearcherTest, manifest_count_disagrees_with_graph_throws) {
                                   {"127", "128", seg_dir.string()});
 }
 
-TEST_F(VamanaSegmentSearcherTest, cos_metric_rejected) {
-  const auto seg_dir = build_segment(128, 8, 11);
-  auto manifest = SegmentManifest::load(seg_dir / "manifest.txt");
-  manifest.metric = MetricType::COS;
-  manifest.save(seg_dir / "manifest.txt");
-  expect_runtime_message_contains([&] { VamanaSegmentSearcher searcher(seg_dir); },
-                                  {"cos", "not implemented in v1"});
+TEST_F(VamanaSegmentSearcherTest, ip_and_cos_top1_matches_brute_force) {
+  constexpr uint32_t kDim = 16;
+  constexpr uint64_t kN = 400;
+  for (const auto metric : {MetricType::IP, MetricType::COS}) {
+    std::filesystem::remove_all(seg_parent_ / "seg_00000001");
+    const auto seg_dir = build_segment(kN, kDim, 11, 1000, metric);
+    VamanaSegmentSearcher searcher(seg_dir);
+    DiskSearchOptions opts;
+    opts.top_k = 1;
+    opts.ef = 64;
+
+    const auto queries = make_vectors(50, kDim, 99);
+    uint32_t agree = 0;
+    for (uint64_t q = 0; q < 50; ++q) {
+      const float *query = queries.data() + q * kDim;
+      double best = -std::numeric_limits<double>::infinity();
+      uint64_t best_label = 0;
+      for (uint64_t i = 0; i < kN; ++i) {
+        double dot = 0.0;
+        double norm_sq = 0.0;
+        for (uint32_t c = 0; c < kDim; ++c) {
+          dot += static_cast<double>(query[c]) * vectors_[i * kDim + c];
+          norm_sq += static_cast<double>(vectors_[i * kDim + c]) * vectors_[i * kDim + c];
+        }
+        const double score = metric == MetricType::COS ? dot / std::sqrt(norm_sq) : dot;
+        if (score > best) {
+          best = score;
+          best_label = labels_[i];
+        }
+      }
+      const auto hits = searcher.search(query, opts);
+      ASSERT_EQ(hits.size(), 1u);
+      agree += hits[0].label == best_label ? 1 : 0;
+    }
+    EXPECT_GE(agree, 48u) << "metric " << static_cast<int>(metric);
+  }
+}
+
+TEST_F(VamanaSegmentSearcherTest, cos_zero_query_rejected) {
+  constexpr uint32_t kDim = 8;
+  const auto seg_dir = build_segment(128, kDim, 11, 1000, MetricType::COS);
+  VamanaSegmentSearcher searcher(seg_dir);
+  const std::vector<float> zero(kDim, 0.0F);
+  DiskSearchOptions opts;
+  opts.top_k = 1;
+  EXPECT_THROW(searcher.search(zero.data(), opts), std::invalid_argument);
 }
 
 }  // namespace
@@ -22,6 +22,24 @@
 //   --only_l L        run a single L instead of the full sweep
 //   --time_pq         time PQ train+encode at --threads then exit (no search)
 //   --pq_n N          cap train-set size for --time_pq
+//   --pq_bits B       PQ code width: 8 (256 centroids, 32 chunks), 4 (16 centroids,
+//                     64 chunks, fast-scan kernel; same 32 B/vector) or "both" to
+//                     sweep the two modes back to back into one CSV. 4-bit builds
+//                     go to index_dir + "_pq4".
+//   --search_io M     query-path reader: default (libaio), uring, or "both" to sweep the
+//                     two back to back on the same index
+//   --sqpoll          io_uring only: kernel-side submission polling (falls back if denied)
+//   --iopoll          io_uring only: completion polling (needs an NVMe poll queue)
+//   --filter_labels N filtered search: tag each base point with one of N synthetic
+//                     labels (hash of its id), filter query q on label q % N, and score
+//                     recall against a brute-force filtered ground truth (computed for
+//                     the --nq queries). Builds go to index_dir + "_flt<N>".
+//   --build_budget_gb G  build from sift_base.fbin with a G GiB Vamana DRAM budget; over
+//                     budget the graph is built per k-means shard and merged out of core
+//   --adaptive_cache_mb M  load with an M MiB frequency-aware node cache that learns hot
+//                     nodes from search misses (system suffix "_adc<M>")
+// Besides latency (mean / p99 / p99.9) each row reports reader-side submit/wait
+// syscalls per query and the voluntary context switches per query of the process.
 // Defaults: data_dir=./sift1m  index_dir=/tmp/diskann_sift1m_alaya  out_csv=diskann_sift1m_alaya.csv
 // data_dir must hold sift_base.fbin / sift_query.fbin / sift_gt.ibin (override via argv[1]).
 // The on-disk layout always stores full-precision coords, so --nopq runs on the
@@ -42,13 +60,18 @@
 #include <unordered_set>
 #include <vector>
 
+#include <sys/resource.h>
+
 #include "index/graph/diskann/beam_search.hpp"  // SearchStats
 #include "index/graph/diskann/diskann_index.hpp"
 
 namespace {
 using alaya::diskann::DiskANNBuildParams;
 using alaya::diskann::DiskANNIndex;
+using alaya::diskann::DiskANNLoadParams;
+using alaya::diskann::DiskANNSearchIO;
 using alaya::diskann::DiskANNSearchParams;
+using alaya::diskann::FilterLabelsView;
 using alaya::diskann::SearchStats;
 
 // .fbin / .fvecs sibling format used by the DiskANN tooling:
@@ -126,6 +149,62 @@ double percentile(std::vector<double> v, double p) {
   }
   return v[idx];
 }
+
+// Synthetic filter label of base point @p id: a multiplicative hash, so labels are
+// spread uniformly over the dataset instead of forming contiguous id ranges.
+uint32_t synthetic_label(uint64_t id, uint32_t n_labels) {
+  return static_cast<uint32_t>(((id + 1) * 0x9E3779B97F4A7C15ULL) >> 33) % n_labels;
+}
+
+// Exact top-k among the base points carrying query q's label (q % n_labels).
+IntMatrix filtered_ground_truth(const FloatMatrix &base, const FloatMatrix &query, uint32_t nq,
+                                uint32_t k, uint32_t n_labels, uint32_t threads) {
+  IntMatrix gt;
+  gt.n = nq;
+  gt.dim = k;
+  gt.data.assign(static_cast<size_t>(nq) * k, 0);
+  std::vector<std::vector<uint32_t>> members(n_labels);
+  for (uint32_t i = 0; i < base.n; ++i) {
+    members[synthetic_label(i, n_labels)].push_back(i);
+  }
+  std::atomic<uint32_t> next{0};
+  auto worker = [&]() {
+    std::vector<std::pair<float, uint32_t>> scored;
+    for (uint32_t q = next.fetch_add(1); q < nq; q = next.fetch_add(1)) {
+      const float *qv = query.data.data() + static_cast<size_t>(q) * query.dim;
+      scored.clear();
+      for (const uint32_t id : members[q % n_labels]) {
+        const float *bv = base.data.data() + static_cast<size_t>(id) * base.dim;
+        float d = 0.0f;
+        for (uint32_t j = 0; j < base.dim; ++j) {
+          const float diff = qv[j] - bv[j];
+          d += diff * diff;
+        }
+        scored.emplace_back(d, id);
+      }
+      const size_t top = std::min<size_t>(k, scored.size());
+      std::partial_sort(scored.begin(), scored.begin() + static_cast<std::ptrdiff_t>(top),
+                        scored.end());
+      for (size_t i = 0; i < top; ++i) {
+        gt.data[static_cast<size_t>(q) * k + i] = scored[i].second;
+      }
+    }
+  };
+  std::vector<std::thread> pool;
+  for (uint32_t t = 0; t < std::max<uint32_t>(1, threads); ++t) {
+    pool.emplace_back(worker);
+  }
+  for (auto &th : pool) {
+    th.join();
+  }
+  return gt;
+}
+
+uint64_t voluntary_context_switches() {
+  rusage ru{};
+  getrusage(RUSAGE_SELF, &ru);
+  return static_cast<uint64_t>(ru.ru_nvcsw);
+}
 }  // namespace
 
 int main(int argc, char **argv) {
@@ -142,6 +221,13 @@ int main(int argc, char **argv) {
     uint32_t only_l = 0;         // --only_l L: run a single L instead of the full sweep
     bool time_pq = false;        // --time_pq: time PQ train+encode at --threads, then exit
     uint64_t pq_n = 0;           // --pq_n N: cap train-set size for --time_pq (0 => all base)
+    std::vector<uint32_t> pq_bits_modes = {8};  // --pq_bits {8,4,both}
+    std::vector<DiskANNSearchIO> io_modes = {DiskANNSearchIO::kDefault};  // --search_io
+    bool sqpoll = false;         // --sqpoll: io_uring SQ polling thread
+    bool iopoll = false;         // --iopoll: io_uring completion polling
+    uint32_t filter_labels = 0;  // --filter_labels N: synthetic-label filtered search
+    float build_budget_gb = 0.0f;  // --build_budget_gb G: out-of-core build budget
+    uint32_t adaptive_cache_mb = 0;  // --adaptive_cache_mb M: adaptive node cache budget
 
     std::vector<std::string> pos;
     for (int i = 1; i < argc; ++i) {
@@ -164,6 +250,31 @@ int main(int argc, char **argv) {
         time_pq = true;
       } else if (a == "--pq_n" && i + 1 < argc) {
         pq_n = static_cast<uint64_t>(std::stoull(argv[++i]));
+      } else if (a == "--pq_bits" && i + 1 < argc) {
+        const std::string v = argv[++i];
+        pq_bits_modes = v == "both" ? std::vector<uint32_t>{8, 4}
+                                    : std::vector<uint32_t>{static_cast<uint32_t>(std::stoul(v))};
+      } else if (a == "--search_io" && i + 1 < argc) {
+        const std::string v = argv[++i];
+        if (v == "both") {
+          io_modes = {DiskANNSearchIO::kDefault, DiskANNSearchIO::kUring};
+        } else if (v == "uring") {
+          io_modes = {DiskANNSearchIO::kUring};
+        } else if (v == "default") {
+          io_modes = {DiskANNSearchIO::kDefault};
+        } else {
+          throw std::invalid_argument("--search_io expects default, uring or both");
+        }
+      } else if (a == "--sqpoll") {
+        sqpoll = true;
+      } else if (a == "--iopoll") {
+        iopoll = true;
+      } else if (a == "--build_budget_gb" && i + 1 < argc) {
+        build_budget_gb = std::stof(argv[++i]);
+      } else if (a == "--adaptive_cache_mb" && i + 1 < argc) {
+        adaptive_cache_mb = static_cast<uint32_t>(std::stoul(argv[++i]));
+      } else if (a == "--filter_labels" && i + 1 < argc) {
+        filter_labels = static_cast<uint32_t>(std::stoul(argv[++i]));
       } else {
         pos.push_back(a);
       }
@@ -216,172 +327,248 @@ int main(int argc, char **argv) {
       return 0;
     }
 
-    // --- Build (identity labels: returned label == base id == gt id). ---
-    namespace fs = std::filesystem;
-    if (rebuild && fs::exists(index_dir)) {
-      std::cout << "[bench] --rebuild: removing " << index_dir << "\n";
-      fs::remove_all(index_dir);
-    }
-    // Build params held in scope so they can be echoed for reproducibility.
-    DiskANNBuildParams bp;
-    bp.R = 64;
-    bp.L = 100;
-    bp.alpha = 1.2f;
-    bp.pq_n_chunks = 32;    // 128 / 32 => 4 dims/chunk => 32 bytes/vector PQ
-    bp.cache_ratio = 0.01;  // ~10k BFS-cached nodes; match official --num_nodes_to_cache
-    bp.num_threads = 96;
-    bp.seed = 1234;
-    bp.verbose = true;  // print per-phase build wall-times
-    if (!fs::exists(index_dir)) {
-      std::vector<uint64_t> labels(n);
+    // --- Filtered mode: synthetic labels + brute-force filtered ground truth. ---
+    std::vector<uint64_t> flt_offsets;
+    std::vector<uint32_t> flt_values;
+    if (filter_labels > 0) {
+      flt_offsets.resize(n + 1);
+      flt_values.resize(n);
       for (uint64_t i = 0; i < n; ++i) {
-        labels[i] = i;
+        flt_offsets[i] = i;
+        flt_values[i] = synthetic_label(i, filter_labels);
       }
-      std::cout << "[bench] building index (R=" << bp.R << " L=" << bp.L << " alpha=" << bp.alpha
-                << " pq_chunks=" << bp.pq_n_chunks << " cache_ratio=" << bp.cache_ratio
-                << " threads=" << bp.num_threads << " seed=" << bp.seed << ") -> " << index_dir
-                << "\n";
+      flt_offsets[n] = n;
+      const uint32_t gt_nq = (max_nq > 0 && max_nq < query.n) ? max_nq : query.n;
+      std::cout << "[bench] filtered mode: " << filter_labels << " labels (selectivity ~"
+                << 1.0 / filter_labels << "), computing filtered ground truth for " << gt_nq
+                << " queries\n";
       auto t0 = std::chrono::steady_clock::now();
-      DiskANNIndex::build(index_dir, base.data.data(), labels.data(), n, dim, bp);
-      auto t1 = std::chrono::steady_clock::now();
-      std::cout << "[bench] build done in " << std::chrono::duration<double>(t1 - t0).count()
+      IntMatrix filtered = filtered_ground_truth(
+          base, query, gt_nq, 10, filter_labels, std::max(1U, std::thread::hardware_concurrency()));
+      std::cout << "[bench] filtered ground truth in "
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count()
                 << " s\n";
-    } else {
-      std::cout << "[bench] reusing existing index at " << index_dir
-                << " (pass --rebuild to force)\n";
-    }
-
-    // --- Load: fixed beam width across the L sweep. ---
-    const uint32_t kBeam = 4;
-    const uint32_t pool_threads = std::max<uint32_t>(8, threads);
-    DiskANNIndex idx;
-    idx.load(index_dir,
-             {/*num_threads=*/pool_threads, /*beam_width=*/kBeam, /*nopq_io_depth=*/io_depth});
-    // Mirror DiskANNIndex's 0 => 32 resolution for display/CSV.
-    const uint32_t eff_depth = io_depth == 0 ? 32u : std::max<uint32_t>(2u * kBeam, io_depth);
-
-    const uint32_t kTopK = 10;
-    const std::vector<uint32_t> ls =
-        only_l > 0 ? std::vector<uint32_t>{only_l} : std::vector<uint32_t>{10, 20, 30, 50, 75, 100, 150, 200};
-
-    const std::string system =
-        std::string("alaya_") + (nopq ? "nopq" : "pq") + (deterministic ? "_det" : "_async");
-    std::cout << "[bench] mode: " << system << "  (use_pq=" << (!nopq)
-              << " deterministic=" << deterministic
-              << (nopq ? "  nopq_io_depth=" + std::to_string(eff_depth) : "")
-              << "  threads=" << threads << ")\n";
-
-    const uint32_t nq_run = (max_nq > 0 && max_nq < query.n) ? max_nq : query.n;
-    if (nq_run != query.n) {
-      std::cout << "[bench] limiting to first " << nq_run << " of " << query.n << " queries\n";
+      gt = std::move(filtered);
     }
 
     std::ofstream csv(out_csv);
-    csv << "system,L,beam,recall_at_1,recall_at_10,mean_lat_us,p99_lat_us,"
-           "mean_ios,mean_rerank_reads,mean_total_reads,qps_1thread,io_depth,threads,agg_qps\n";
-
-    std::printf("\n  %3s  %9s  %9s  %9s  %7s  %4s  %9s\n", "L", "recall@10", "mean us", "p99 us",
-                "ios", "thr", "aggQPS");
-    std::printf("  ---  ---------  ---------  ---------  -------  ----  ---------\n");
-
-    // Per-query outputs are row-major (nq_run * kTopK) so concurrent workers write
-    // disjoint slices; latencies are per-query, throughput is wall-clock.
-    std::vector<uint64_t> all_l(static_cast<size_t>(nq_run) * kTopK);
-    std::vector<float> all_d(static_cast<size_t>(nq_run) * kTopK);
-    std::vector<double> lat_us(nq_run, 0.0);
-
-    for (uint32_t l : ls) {
-      DiskANNSearchParams sp;
-      sp.search_list_size = l;
-      sp.use_pq = !nopq;
-      sp.deterministic = deterministic;
-      // PQ: rerank the whole explored frontier (all L candidates) by exact L2, the
-      // apples-to-apples analogue of official DiskANN returning top-K over every
-      // node it read. At termination every retset entry is already visited, so
-      // this adds compute but ~0 extra disk reads (n_rerank_reads stays ~0).
-      // No-PQ already computes exact L2 for every read node, so rerank is moot.
-      sp.rerank = !nopq;
-      sp.rerank_count = nopq ? 0 : l;
-
-      std::atomic<uint64_t> a_ios{0};
-      std::atomic<uint32_t> next{0};
-
-      // Each worker pulls queries off a shared counter (work-stealing for balance),
-      // times each search, and writes into that query's output slice.
-      auto worker = [&]() {
-        SearchStats lst;
-        lst.read_order.reserve(4096);
-        for (;;) {
-          const uint32_t q = next.fetch_add(1, std::memory_order_relaxed);
-          if (q >= nq_run) {
-            break;
-          }
-          const float *qv = query.data.data() + static_cast<size_t>(q) * dim;
-          lst.n_ios = 0;
-          lst.n_cache_hits = 0;
-          lst.n_nodes_processed = 0;
-          lst.n_rerank_reads = 0;
-          lst.read_order.clear();
-          auto a = std::chrono::steady_clock::now();
-          idx.search(qv, kTopK, all_l.data() + static_cast<size_t>(q) * kTopK,
-                     all_d.data() + static_cast<size_t>(q) * kTopK, sp, &lst);
-          auto b = std::chrono::steady_clock::now();
-          lat_us[q] = std::chrono::duration<double, std::micro>(b - a).count();
-          a_ios.fetch_add(lst.n_ios, std::memory_order_relaxed);
-        }
-      };
+    csv << "system,L,beam,recall_at_1,recall_at_10,mean_lat_us,p99_lat_us,p999_lat_us,"
+           "mean_ios,mean_rerank_reads,mean_total_reads,qps_1thread,io_depth,threads,agg_qps,"
+           "syscalls_per_query,vcsw_per_query,filter_labels\n";
 
-      auto wall0 = std::chrono::steady_clock::now();
-      if (threads == 1) {
-        worker();
-      } else {
-        std::vector<std::thread> pool;
-        pool.reserve(threads);
-        for (uint32_t t = 0; t < threads; ++t) {
-          pool.emplace_back(worker);
-        }
-        for (auto &th : pool) {
-          th.join();
-        }
+    for (const uint32_t pq_bits : pq_bits_modes) {
+      const std::string filter_suffix =
+          filter_labels > 0 ? "_flt" + std::to_string(filter_labels) : "";
+      const std::string mode_dir = (pq_bits == 4 ? index_dir + "_pq4" : index_dir) + filter_suffix;
+      // --- Build (identity labels: returned label == base id == gt id). ---
+      namespace fs = std::filesystem;
+      if (rebuild && fs::exists(mode_dir)) {
+        std::cout << "[bench] --rebuild: removing " << mode_dir << "\n";
+        fs::remove_all(mode_dir);
       }
-      auto wall1 = std::chrono::steady_clock::now();
-      const double wall_s = std::chrono::duration<double>(wall1 - wall0).count();
-      const double agg_qps = static_cast<double>(nq_run) / wall_s;
-
-      double hit1 = 0;
-      double hit10 = 0;
-      for (uint32_t q = 0; q < nq_run; ++q) {
-        const uint64_t *row = all_l.data() + static_cast<size_t>(q) * kTopK;
-        const uint32_t *truth = gt.row(q);
-        std::unordered_set<uint32_t> t10(truth, truth + kTopK);
-        for (uint32_t i = 0; i < kTopK; ++i) {
-          if (row[i] != DiskANNIndex::kNoLabel && t10.count(static_cast<uint32_t>(row[i])) != 0) {
-            hit10 += 1.0;
-          }
+      // Build params held in scope so they can be echoed for reproducibility.
+      DiskANNBuildParams bp;
+      bp.R = 64;
+      bp.L = 100;
+      bp.alpha = 1.2f;
+      bp.pq_n_chunks = 32;    // 128 / 32 => 4 dims/chunk => 32 bytes/vector PQ
+      bp.pq_code_bits = pq_bits;
+      if (pq_bits == 4) {
+        bp.pq_n_chunks = 64;  // 2 dims/chunk, 4 bits each => the same 32 bytes/vector
+      }
+      bp.cache_ratio = 0.01;  // ~10k BFS-cached nodes; match official --num_nodes_to_cache
+      bp.num_threads = 96;
+      bp.seed = 1234;
+      bp.verbose = true;  // print per-phase build wall-times
+      bp.build_dram_budget_gb = build_budget_gb;
+      if (!fs::exists(mode_dir)) {
+        std::vector<uint64_t> labels(n);
+        for (uint64_t i = 0; i < n; ++i) {
+          labels[i] = i;
         }
-        if (row[0] != DiskANNIndex::kNoLabel && static_cast<uint32_t>(row[0]) == truth[0]) {
-          hit1 += 1.0;
+        std::cout << "[bench] building index (R=" << bp.R << " L=" << bp.L << " alpha=" << bp.alpha
+                  << " pq_chunks=" << bp.pq_n_chunks << " pq_bits=" << bp.pq_code_bits
+                  << " cache_ratio=" << bp.cache_ratio
+                  << " threads=" << bp.num_threads << " seed=" << bp.seed
+                  << " dram_budget_gb=" << bp.build_dram_budget_gb << ") -> " << mode_dir << "\n";
+        auto t0 = std::chrono::steady_clock::now();
+        const FilterLabelsView flt_view =
+            filter_labels > 0 ? FilterLabelsView{flt_offsets.data(), flt_values.data()}
+                              : FilterLabelsView{};
+        if (build_budget_gb > 0.0f) {
+          // Stream the base file; labels are the row numbers either way.
+          DiskANNIndex::build(mode_dir, base_path, nullptr, bp, flt_view);
+        } else {
+          DiskANNIndex::build(mode_dir, base.data.data(), labels.data(), n, dim, bp, flt_view);
         }
+        auto t1 = std::chrono::steady_clock::now();
+        std::cout << "[bench] build done in " << std::chrono::duration<double>(t1 - t0).count()
+                  << " s\n";
+      } else {
+        std::cout << "[bench] reusing existing index at " << mode_dir
+                  << " (pass --rebuild to force)\n";
       }
 
-      const double recall1 = hit1 / nq_run;
-      const double recall10 = hit10 / (static_cast<double>(nq_run) * kTopK);
-      double total_us = 0;
-      for (double x : lat_us) {
-        total_us += x;
+      for (const DiskANNSearchIO io_mode : io_modes) {
+        // --- Load: fixed beam width across the L sweep. ---
+        const uint32_t kBeam = 4;
+        const uint32_t pool_threads = std::max<uint32_t>(8, threads);
+        DiskANNLoadParams lp;
+        lp.num_threads = pool_threads;
+        lp.beam_width = kBeam;
+        lp.nopq_io_depth = io_depth;
+        lp.search_io = io_mode;
+        lp.search_io_sqpoll = sqpoll;
+        lp.search_io_iopoll = iopoll;
+        lp.adaptive_cache_bytes = static_cast<uint64_t>(adaptive_cache_mb) << 20;
+        DiskANNIndex idx;
+        idx.load(mode_dir, lp);
+        // Mirror DiskANNIndex's 0 => 32 resolution for display/CSV.
+        const uint32_t eff_depth = io_depth == 0 ? 32u : std::max<uint32_t>(2u * kBeam, io_depth);
+
+        const uint32_t kTopK = 10;
+        const std::vector<uint32_t> ls =
+            only_l > 0 ? std::vector<uint32_t>{only_l}
+                       : std::vector<uint32_t>{10, 20, 30, 50, 75, 100, 150, 200};
+
+        const std::string system =
+            std::string("alaya_") + (nopq ? "nopq" : (pq_bits == 4 ? "pq4" : "pq")) +
+            (deterministic ? "_det" : "_async") +
+            (io_mode == DiskANNSearchIO::kUring ? "_uring" : "") +
+            (filter_labels > 0 ? "_flt" + std::to_string(filter_labels) : "") +
+            (adaptive_cache_mb > 0 ? "_adc" + std::to_string(adaptive_cache_mb) : "");
+        std::cout << "[bench] mode: " << system << "  (use_pq=" << (!nopq)
+                  << " deterministic=" << deterministic
+                  << (nopq ? "  nopq_io_depth=" + std::to_string(eff_depth) : "")
+                  << "  threads=" << threads << ")\n";
+
+        const uint32_t nq_run = (max_nq > 0 && max_nq < query.n) ? max_nq : query.n;
+        if (nq_run != query.n) {
+          std::cout << "[bench] limiting to first " << nq_run << " of " << query.n << " queries\n";
+        }
+
+        std::printf("\n  %3s  %9s  %9s  %9s  %9s  %7s  %7s  %6s  %4s  %9s\n", "L", "recall@10",
+                    "mean us", "p99 us", "p99.9 us", "ios", "sys/q", "csw/q", "thr", "aggQPS");
+        std::printf(
+            "  ---  ---------  ---------  ---------  ---------  -------  -------  ------  ----  "
+            "---------\n");
+
+        // Per-query outputs are row-major (nq_run * kTopK) so concurrent workers write
+        // disjoint slices; latencies are per-query, throughput is wall-clock.
+        std::vector<uint64_t> all_l(static_cast<size_t>(nq_run) * kTopK);
+        std::vector<float> all_d(static_cast<size_t>(nq_run) * kTopK);
+        std::vector<double> lat_us(nq_run, 0.0);
+
+        for (uint32_t l : ls) {
+          DiskANNSearchParams sp;
+          sp.search_list_size = l;
+          sp.use_pq = !nopq;
+          sp.deterministic = deterministic;
+          // PQ: rerank the whole explored frontier (all L candidates) by exact L2, the
+          // apples-to-apples analogue of official DiskANN returning top-K over every
+          // node it read. At termination every retset entry is already visited, so
+          // this adds compute but ~0 extra disk reads (n_rerank_reads stays ~0).
+          // No-PQ already computes exact L2 for every read node, so rerank is moot.
+          sp.rerank = !nopq;
+          sp.rerank_count = nopq ? 0 : l;
+          // Filtered mode: one parameter set per label; query q filters on q % N.
+          std::vector<DiskANNSearchParams> label_sp(filter_labels, sp);
+          for (uint32_t lb = 0; lb < filter_labels; ++lb) {
+            label_sp[lb].filter_labels = {lb};
+          }
+
+          std::atomic<uint64_t> a_ios{0};
+          std::atomic<uint32_t> next{0};
+
+          // Each worker pulls queries off a shared counter (work-stealing for balance),
+          // times each search, and writes into that query's output slice.
+          auto worker = [&]() {
+            SearchStats lst;
+            lst.read_order.reserve(4096);
+            for (;;) {
+              const uint32_t q = next.fetch_add(1, std::memory_order_relaxed);
+              if (q >= nq_run) {
+                break;
+              }
+              const float *qv = query.data.data() + static_cast<size_t>(q) * dim;
+              lst.n_ios = 0;
+              lst.n_cache_hits = 0;
+              lst.n_nodes_processed = 0;
+              lst.n_rerank_reads = 0;
+              lst.read_order.clear();
+              auto a = std::chrono::steady_clock::now();
+              const DiskANNSearchParams &qsp = filter_labels > 0 ? label_sp[q % filter_labels] : sp;
+              idx.search(qv, kTopK, all_l.data() + static_cast<size_t>(q) * kTopK,
+                         all_d.data() + static_cast<size_t>(q) * kTopK, qsp, &lst);
+              auto b = std::chrono::steady_clock::now();
+              lat_us[q] = std::chrono::duration<double, std::micro>(b - a).count();
+              a_ios.fetch_add(lst.n_ios, std::memory_order_relaxed);
+            }
+          };
+
+          const uint64_t sys0 = idx.search_io_syscalls();
+          const uint64_t csw0 = voluntary_context_switches();
+          auto wall0 = std::chrono::steady_clock::now();
+          if (threads == 1) {
+            worker();
+          } else {
+            std::vector<std::thread> pool;
+            pool.reserve(threads);
+            for (uint32_t t = 0; t < threads; ++t) {
+              pool.emplace_back(worker);
+            }
+            for (auto &th : pool) {
+              th.join();
+            }
+          }
+          auto wall1 = std::chrono::steady_clock::now();
+          const double sys_per_q =
+              static_cast<double>(idx.search_io_syscalls() - sys0) / nq_run;
+          const double csw_per_q =
+              static_cast<double>(voluntary_context_switches() - csw0) / nq_run;
+          const double wall_s = std::chrono::duration<double>(wall1 - wall0).count();
+          const double agg_qps = static_cast<double>(nq_run) / wall_s;
+
+          double hit1 = 0;
+          double hit10 = 0;
+          for (uint32_t q = 0; q < nq_run; ++q) {
+            const uint64_t *row = all_l.data() + static_cast<size_t>(q) * kTopK;
+            const uint32_t *truth = gt.row(q);
+            std::unordered_set<uint32_t> t10(truth, truth + kTopK);
+            for (uint32_t i = 0; i < kTopK; ++i) {
+              if (row[i] != DiskANNIndex::kNoLabel &&
+                  t10.count(static_cast<uint32_t>(row[i])) != 0) {
+                hit10 += 1.0;
+              }
+            }
+            if (row[0] != DiskANNIndex::kNoLabel && static_cast<uint32_t>(row[0]) == truth[0]) {
+              hit1 += 1.0;
+            }
+          }
+
+          const double recall1 = hit1 / nq_run;
+          const double recall10 = hit10 / (static_cast<double>(nq_run) * kTopK);
+          double total_us = 0;
+          for (double x : lat_us) {
+            total_us += x;
+          }
+          const double mean_us = total_us / nq_run;
+          const double p99_us = percentile(lat_us, 0.99);
+          const double p999_us = percentile(lat_us, 0.999);
+          const double mean_ios = static_cast<double>(a_ios.load()) / nq_run;
+          const double qps_1t = 1e6 / mean_us;
+
+          std::printf("  %3u  %9.4f  %9.1f  %9.1f  %9.1f  %7.1f  %7.1f  %6.2f  %4u  %9.0f\n", l,
+                      recall10, mean_us, p99_us, p999_us, mean_ios, sys_per_q, csw_per_q, threads,
+                      agg_qps);
+          // CSV: mean_rerank_reads is 0 (PQ reranks from co-located coords; No-PQ has no
+          // rerank), and mean_total_reads == mean_ios for the same reason.
+          csv << system << "," << l << "," << kBeam << "," << recall1 << "," << recall10 << ","
+              << mean_us << "," << p99_us << "," << p999_us << "," << mean_ios << ",0," << mean_ios
+              << "," << qps_1t << "," << eff_depth << "," << threads << "," << agg_qps << ","
+              << sys_per_q << "," << csw_per_q << "," << filter_labels << "\n";
+        }
       }
-      const double mean_us = total_us / nq_run;
-      const double p99_us = percentile(lat_us, 0.99);
-      const double mean_ios = static_cast<double>(a_ios.load()) / nq_run;
-      const double qps_1t = 1e6 / mean_us;
-
-      std::printf("  %3u  %9.4f  %9.1f  %9.1f  %7.1f  %4u  %9.0f\n", l, recall10, mean_us, p99_us,
-                  mean_ios, threads, agg_qps);
-      // CSV: mean_rerank_reads is 0 (PQ reranks from co-located coords; No-PQ has no
-      // rerank), and mean_total_reads == mean_ios for the same reason.
-      csv << system << "," << l << "," << kBeam << "," << recall1 << "," << recall10 << ","
-          << mean_us << "," << p99_us << "," << mean_ios << ",0," << mean_ios << "," << qps_1t
-          << "," << eff_depth << "," << threads << "," << agg_qps << "\n";
     }
     csv.close();
     std::cout << "\n[bench] wrote " << out_csv << "\n";
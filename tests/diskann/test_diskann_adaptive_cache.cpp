@@ -0,0 +1,164 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "index/graph/diskann/adaptive_node_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using alaya::diskann::AdaptiveNodeCache;
+
+constexpr uint64_t kRecordLen = 16;
+
+std::vector<char> record_of(uint32_t id) {
+  std::vector<char> rec(kRecordLen);
+  std::memcpy(rec.data(), &id, sizeof(id));
+  return rec;
+}
+
+uint32_t id_in(const AdaptiveNodeCache::Pin &rec) {
+  uint32_t id = 0;
+  std::memcpy(&id, rec.get(), sizeof(id));
+  return id;
+}
+
+class AdaptiveNodeCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    static std::atomic<uint64_t> counter{0};
+    path_ = std::filesystem::temp_directory_path() /
+            ("diskann_hot_" + std::to_string(counter.fetch_add(1)) + ".bin");
+  }
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+  }
+
+  static void offer(AdaptiveNodeCache &cache, uint32_t id, int times = 1) {
+    const auto rec = record_of(id);
+    for (int i = 0; i < times; ++i) {
+      cache.admit(id, rec.data());
+    }
+  }
+
+  std::filesystem::path path_;
+};
+
+TEST_F(AdaptiveNodeCacheTest, AdmitsIntoFreeWaysAndServesCopies) {
+  AdaptiveNodeCache cache(8, kRecordLen);
+  EXPECT_EQ(cache.capacity(), 8U);
+  EXPECT_FALSE(cache.find(3));
+  offer(cache, 3);
+  offer(cache, 5);
+  const auto hit = cache.find(3);
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(id_in(hit), 3U);
+  EXPECT_EQ(cache.size(), 2U);
+  EXPECT_EQ(cache.hits(), 1U);
+  EXPECT_EQ(cache.admissions(), 2U);
+  EXPECT_THROW(AdaptiveNodeCache(0, kRecordLen), std::invalid_argument);
+}
+
+TEST_F(AdaptiveNodeCacheTest, FrequentCandidatesDisplaceOnlyRarerVictims) {
+  AdaptiveNodeCache cache(4, kRecordLen);  // a single 4-way set
+  for (uint32_t id = 0; id < 4; ++id) {
+    offer(cache, id, 3);
+  }
+  offer(cache, 100);  // one-hit wonder: never beats a resident seen three times
+  EXPECT_FALSE(cache.find(100));
+  EXPECT_EQ(cache.size(), 4U);
+
+  offer(cache, 200, 6);  // hot newcomer evicts one resident
+  ASSERT_TRUE(cache.find(200));
+  EXPECT_EQ(cache.size(), 4U);
+  EXPECT_GE(cache.frequency(200), 6U);
+}
+
+TEST_F(AdaptiveNodeCacheTest, PinnedRecordIsNeverOverwritten) {
+  AdaptiveNodeCache cache(1, kRecordLen);  // one way: every admission targets it
+  offer(cache, 1);
+  auto pinned = cache.find(1);
+  ASSERT_TRUE(pinned);
+  offer(cache, 2, 10);  // hot enough to evict 1, but its way is pinned
+  EXPECT_EQ(id_in(pinned), 1U);
+  EXPECT_FALSE(cache.find(2));
+
+  pinned = AdaptiveNodeCache::Pin();
+  offer(cache, 2);
+  const auto hit = cache.find(2);
+  ASSERT_TRUE(hit);
+  EXPECT_EQ(id_in(hit), 2U);
+}
+
+TEST_F(AdaptiveNodeCacheTest, BudgetCoversRecordsAndBookkeeping) {
+  for (const uint64_t record_len : {uint64_t{16}, uint64_t{520}, uint64_t{4096}}) {
+    for (const uint64_t budget : {uint64_t{64} << 10, uint64_t{1} << 20, uint64_t{7} << 20}) {
+      const uint64_t capacity = AdaptiveNodeCache::capacity_for_budget(budget, record_len);
+      ASSERT_GT(capacity, 0U);
+      EXPECT_LT(capacity, budget / record_len);  // bookkeeping is not free
+      AdaptiveNodeCache cache(capacity, record_len);
+      EXPECT_LE(cache.memory_bytes(), budget) << record_len << " " << budget;
+    }
+  }
+  EXPECT_EQ(AdaptiveNodeCache::capacity_for_budget(100, 16), 0U);
+}
+
+TEST_F(AdaptiveNodeCacheTest, HotSetSurvivesSaveAndPreload) {
+  AdaptiveNodeCache cache(16, kRecordLen);
+  offer(cache, 7, 5);
+  offer(cache, 9, 2);
+  offer(cache, 11, 9);
+  cache.save_hot_set(path_.string());
+
+  const auto hot = AdaptiveNodeCache::load_hot_set(path_.string());
+  ASSERT_EQ(hot.size(), 3U);
+  EXPECT_EQ(hot[0].id, 11U);  // hottest first
+  EXPECT_EQ(hot[2].id, 9U);
+
+  AdaptiveNodeCache warm(16, kRecordLen);
+  for (const auto &entry : hot) {
+    const auto rec = record_of(entry.id);
+    warm.preload(entry.id, rec.data(), entry.freq);
+  }
+  EXPECT_EQ(warm.size(), 3U);
+  EXPECT_EQ(warm.frequency(11), cache.frequency(11));
+  EXPECT_THROW(AdaptiveNodeCache::load_hot_set(path_.string() + ".missing"), std::runtime_error);
+}
+
+TEST_F(AdaptiveNodeCacheTest, ConcurrentAdmitAndFindReturnMatchingRecords) {
+  AdaptiveNodeCache cache(64, kRecordLen);
+  std::atomic<uint64_t> mismatches{0};
+  std::vector<std::thread> workers;
+  for (uint32_t t = 0; t < 4; ++t) {
+    workers.emplace_back([&, t]() {
+      for (uint32_t i = 0; i < 20000; ++i) {
+        const uint32_t id = (i * 7 + t * 13) % 512;
+        const auto hit = cache.find(id);
+        if (!hit) {
+          const auto rec = record_of(id);
+          cache.admit(id, rec.data());
+        } else if (id_in(hit) != id) {
+          mismatches.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto &w : workers) {
+    w.join();
+  }
+  EXPECT_EQ(mismatches.load(), 0U);
+  EXPECT_LE(cache.size(), cache.capacity());
+}
+
+}  // namespace
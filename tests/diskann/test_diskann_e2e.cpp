@@ -10,6 +10,7 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <filesystem>
 #include <iostream>
@@ -26,6 +27,7 @@ using alaya::diskann::DiskANNBuildParams;
 using alaya::diskann::DiskANNIndex;
 using alaya::diskann::DiskANNLoadParams;
 using alaya::diskann::DiskANNSearchParams;
+using alaya::MetricType;
 
 constexpr uint64_t kN = 2000;
 constexpr uint64_t kDim = 64;
@@ -65,6 +67,67 @@ std::vector<std::vector<uint32_t>> ground_truth(const std::vector<float> &data,
   return gt;
 }
 
+float dot(const float *a, const float *b, uint64_t dim) {
+  float s = 0.0f;
+  for (uint64_t d = 0; d < dim; ++d) {
+    s += a[d] * b[d];
+  }
+  return s;
+}
+
+// The metric's distance as the index reports it: -<q, x> for IP, -cos for COS.
+float metric_distance(MetricType metric, const float *q, const float *x, uint64_t dim) {
+  if (metric == MetricType::COS) {
+    return -dot(q, x, dim) / std::sqrt(dot(q, q, dim) * dot(x, x, dim));
+  }
+  return -dot(q, x, dim);
+}
+
+// Gaussian directions with norms spread over [0.75, 1.25] (an embedding-like
+// spread), so MIPS and cosine neighbors differ from the L2 ones.
+std::vector<float> make_scaled_vectors(uint64_t n, uint64_t dim, uint32_t seed) {
+  auto v = make_vectors(n, dim, seed);
+  std::mt19937 rng(seed + 7);
+  std::uniform_real_distribution<float> scale(0.75f, 1.25f);
+  for (uint64_t i = 0; i < n; ++i) {
+    const float s = scale(rng) / std::sqrt(dot(&v[i * dim], &v[i * dim], dim));
+    for (uint64_t d = 0; d < dim; ++d) {
+      v[i * dim + d] *= s;
+    }
+  }
+  return v;
+}
+
+// Recall@k of an IP / COS index over labels 5000 + i against brute force.
+double metric_recall(DiskANNIndex &idx, MetricType metric, const std::vector<float> &data,
+                     uint64_t n, const std::vector<float> &queries, const DiskANNSearchParams &sp) {
+  double sum = 0.0;
+  std::vector<uint64_t> out_l(kTopK);
+  std::vector<float> out_d(kTopK);
+  for (uint32_t q = 0; q < kNQ; ++q) {
+    const float *query = queries.data() + static_cast<uint64_t>(q) * kDim;
+    std::vector<std::pair<float, uint32_t>> d;
+    d.reserve(n);
+    for (uint64_t i = 0; i < n; ++i) {
+      d.emplace_back(metric_distance(metric, query, data.data() + i * kDim, kDim),
+                     static_cast<uint32_t>(i));
+    }
+    std::partial_sort(d.begin(), d.begin() + kTopK, d.end());
+    std::unordered_set<uint64_t> truth;
+    for (uint32_t i = 0; i < kTopK; ++i) {
+      truth.insert(5000 + d[i].second);
+    }
+    idx.search(query, kTopK, out_l.data(), out_d.data(), sp);
+    for (uint32_t i = 0; i < kTopK; ++i) {
+      sum += truth.count(out_l[i]) != 0 ? 1.0 : 0.0;
+    }
+    // Reranked / exact results report the metric's own distance.
+    const float *best = data.data() + (out_l[0] - 5000) * kDim;
+    EXPECT_NEAR(out_d[0], metric_distance(metric, query, best, kDim), 1e-3f) << "q=" << q;
+  }
+  return sum / (static_cast<double>(kNQ) * kTopK);
+}
+
 class DiskANNE2ETest : public ::testing::Test {
  protected:
   static void SetUpTestSuite() {
@@ -225,6 +288,41 @@ TEST_F(DiskANNE2ETest, BatchMatchesSequential) {
   }
 }
 
+TEST_F(DiskANNE2ETest, UringSearchIOMatchesDefaultReader) {
+#ifdef ALAYA_OS_LINUX
+  if (!UringFileReader::is_available()) {
+    GTEST_SKIP() << "io_uring unavailable";
+  }
+  for (const auto &dir : {pq_dir_, nopq_dir_}) {
+    const bool pq = dir == pq_dir_;
+    DiskANNLoadParams lp{/*num_threads=*/2, /*beam_width=*/8};
+    DiskANNIndex ref;
+    ref.load(dir, lp);
+    lp.search_io = alaya::diskann::DiskANNSearchIO::kUring;
+    DiskANNIndex uring;
+    uring.load(dir, lp);
+    const DiskANNSearchParams sp{/*L=*/120, /*use_pq=*/pq, /*rerank=*/pq,
+                                 /*rerank_count=*/0, /*deterministic=*/true};
+    std::vector<uint64_t> ref_l(kTopK);
+    std::vector<uint64_t> uring_l(kTopK);
+    std::vector<float> ref_d(kTopK);
+    std::vector<float> uring_d(kTopK);
+    for (uint32_t q = 0; q < 25; ++q) {
+      const float *query = queries_.data() + static_cast<uint64_t>(q) * kDim;
+      ref.search(query, kTopK, ref_l.data(), ref_d.data(), sp);
+      uring.search(query, kTopK, uring_l.data(), uring_d.data(), sp);
+      ASSERT_EQ(ref_l, uring_l) << (pq ? "pq" : "nopq") << " q=" << q;
+      ASSERT_EQ(ref_d, uring_d) << (pq ? "pq" : "nopq") << " q=" << q;
+    }
+    // The async No-PQ pipeline waits one completion at a time through get_events.
+    EXPECT_GT(mean_recall(uring, {/*L=*/150, /*use_pq=*/pq, /*rerank=*/pq}, /*nq=*/25), 0.9);
+    EXPECT_GT(uring.search_io_syscalls(), 0U);
+  }
+#else
+  GTEST_SKIP() << "io_uring is Linux-only";
+#endif
+}
+
 TEST_F(DiskANNE2ETest, ConcurrentSearchCorrect) {
   DiskANNIndex idx;
   idx.load(pq_dir_, {/*num_threads=*/4, /*beam_width=*/8});
@@ -353,4 +451,149 @@ TEST_F(DiskANNE2ETest, NoPQConcurrentDefaultPathValid) {
   EXPECT_GT(recall, 0.9);
 }
 
+// --- IP / COS metrics ------------------------------------------------------
+
+class DiskANNMetricE2ETest : public ::testing::TestWithParam<MetricType> {
+ protected:
+  void SetUp() override {
+    data_ = make_scaled_vectors(kN, kDim, /*seed=*/3);
+    queries_ = make_scaled_vectors(kNQ, kDim, /*seed=*/77);
+    labels_.resize(kN);
+    for (uint64_t i = 0; i < kN; ++i) {
+      labels_[i] = 5000 + i;
+    }
+    dir_ = (std::filesystem::temp_directory_path() /
+            ("diskann_e2e_metric_" + std::to_string(static_cast<int>(GetParam()))))
+               .string();
+    std::error_code ec;
+    std::filesystem::remove_all(dir_, ec);
+  }
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(dir_, ec);
+  }
+  DiskANNBuildParams build_params(uint32_t pq_n_chunks) const {
+    DiskANNBuildParams bp;
+    bp.R = 48;
+    bp.L = 100;
+    bp.cache_ratio = 0.05;
+    bp.pq_train_iters = kPqTrainIters;
+    bp.pq_n_chunks = pq_n_chunks;
+    bp.metric = GetParam();
+    return bp;
+  }
+
+  std::vector<float> data_;
+  std::vector<float> queries_;
+  std::vector<uint64_t> labels_;
+  std::string dir_;
+};
+
+TEST_P(DiskANNMetricE2ETest, PQRerankRecallMatchesL2) {
+  DiskANNIndex::build(dir_, data_.data(), labels_.data(), kN, kDim, build_params(16));
+  DiskANNIndex idx;
+  idx.load(dir_, {/*num_threads=*/4, /*beam_width=*/8});
+  EXPECT_EQ(idx.metric(), GetParam());
+  EXPECT_EQ(idx.dim(), kDim);
+  const double recall = metric_recall(idx, GetParam(), data_, kN, queries_,
+                                      {/*L=*/150, /*use_pq=*/true, /*rerank=*/true,
+                                       /*rerank_count=*/100});
+  std::cout << "[e2e] metric " << static_cast<int>(GetParam()) << " PQ+rerank recall@10 = "
+            << recall << std::endl;
+  EXPECT_GT(recall, 0.9);  // the L2 bar of RecallAbovePoint9_PQRerank
+}
+
+TEST_P(DiskANNMetricE2ETest, NoPQRecallMatchesL2) {
+  DiskANNIndex::build(dir_, data_.data(), labels_.data(), kN, kDim, build_params(0));
+  DiskANNIndex idx;
+  idx.load(dir_, {/*num_threads=*/4, /*beam_width=*/8});
+  const double recall = metric_recall(idx, GetParam(), data_, kN, queries_,
+                                      {/*L=*/150, /*use_pq=*/false, /*rerank=*/false});
+  std::cout << "[e2e] metric " << static_cast<int>(GetParam()) << " No-PQ recall@10 = " << recall
+            << std::endl;
+  EXPECT_GT(recall, 0.9);
+}
+
+TEST_P(DiskANNMetricE2ETest, BatchInsertKeepsMetricAcrossFlush) {
+  // Build on the first half, batch_insert the second, then flush + reopen:
+  // inserted vectors go through the same mapping, and meta.bin keeps the metric.
+  // ip_max_norm covers the longest vector make_scaled_vectors() produces (1.25), so
+  // the second half fits the IP augmentation built from the first.
+  const uint64_t half = kN / 2;
+  DiskANNBuildParams bp = build_params(16);
+  bp.ip_max_norm = 1.3f;
+  DiskANNIndex::build(dir_, data_.data(), labels_.data(), half, kDim, bp);
+  {
+    DiskANNIndex idx;
+    DiskANNLoadParams lp;
+    lp.updatable = true;
+    lp.update_io = alaya::diskann::DiskANNUpdateIO::kBlocking;
+    idx.load(dir_, lp);
+    idx.batch_insert(data_.data() + half * kDim, labels_.data() + half,
+                     static_cast<uint32_t>(kN - half), /*batch_size=*/16);
+    idx.flush();
+  }
+  DiskANNIndex idx;
+  idx.load(dir_, {/*num_threads=*/4, /*beam_width=*/8});
+  EXPECT_EQ(idx.metric(), GetParam());
+  EXPECT_EQ(idx.size(), kN);
+  const double recall = metric_recall(idx, GetParam(), data_, kN, queries_,
+                                      {/*L=*/150, /*use_pq=*/true, /*rerank=*/true,
+                                       /*rerank_count=*/100});
+  std::cout << "[e2e] metric " << static_cast<int>(GetParam())
+            << " recall@10 after batch_insert = " << recall << std::endl;
+  EXPECT_GT(recall, 0.85);
+}
+
+TEST_P(DiskANNMetricE2ETest, InsertLongerThanIpRadiusIsRejected) {
+  const uint64_t half = kN / 2;
+  DiskANNIndex::build(dir_, data_.data(), labels_.data(), half, kDim, build_params(16));
+  DiskANNIndex idx;
+  DiskANNLoadParams lp;
+  lp.updatable = true;
+  lp.update_io = alaya::diskann::DiskANNUpdateIO::kBlocking;
+  idx.load(dir_, lp);
+
+  // Every base vector has norm <= 1.25, so one of norm 2 is outside the radius.
+  std::vector<float> longer(data_.begin() + half * kDim, data_.begin() + (half + 1) * kDim);
+  const float s = 2.0f / std::sqrt(dot(longer.data(), longer.data(), kDim));
+  for (auto &x : longer) {
+    x *= s;
+  }
+  if (GetParam() == MetricType::IP) {
+    EXPECT_THROW(idx.insert(longer.data(), labels_[half]), std::invalid_argument);
+    EXPECT_THROW(idx.batch_insert(longer.data(), &labels_[half], 1), std::invalid_argument);
+    EXPECT_EQ(idx.size(), half);
+  } else {
+    idx.insert(longer.data(), labels_[half]);  // COS normalizes, so any length fits
+    EXPECT_EQ(idx.size(), half + 1);
+  }
+}
+
+TEST_P(DiskANNMetricE2ETest, ZeroVectorUnderCosIsRejected) {
+  if (GetParam() != MetricType::COS) {
+    GTEST_SKIP() << "only COS has no direction for a zero vector";
+  }
+  const uint64_t half = kN / 2;
+  std::vector<float> with_zero(data_.begin(), data_.begin() + half * kDim);
+  std::fill_n(with_zero.begin() + 7 * kDim, kDim, 0.0f);
+  EXPECT_THROW(DiskANNIndex::build(dir_, with_zero.data(), labels_.data(), half, kDim,
+                                   build_params(16)),
+               std::invalid_argument);
+
+  DiskANNIndex::build(dir_, data_.data(), labels_.data(), half, kDim, build_params(16));
+  DiskANNIndex idx;
+  DiskANNLoadParams lp;
+  lp.updatable = true;
+  lp.update_io = alaya::diskann::DiskANNUpdateIO::kBlocking;
+  idx.load(dir_, lp);
+  const std::vector<float> zero(kDim, 0.0f);
+  EXPECT_THROW(idx.insert(zero.data(), labels_[half]), std::invalid_argument);
+  EXPECT_THROW(idx.batch_insert(zero.data(), &labels_[half], 1), std::invalid_argument);
+  EXPECT_EQ(idx.size(), half);
+}
+
+INSTANTIATE_TEST_SUITE_P(IPAndCos, DiskANNMetricE2ETest,
+                         ::testing::Values(MetricType::IP, MetricType::COS));
+
 }  // namespace
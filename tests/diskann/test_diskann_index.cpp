@@ -11,9 +11,12 @@
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
 #include <random>
+#include <utility>
 #include <vector>
 
+#include "index/graph/vamana/budget_estimator.hpp"
 #include "simd/distance_l2.hpp"
 
 namespace {
@@ -22,6 +25,7 @@ using alaya::diskann::DiskANNBuildParams;
 using alaya::diskann::DiskANNIndex;
 using alaya::diskann::DiskANNLoadParams;
 using alaya::diskann::DiskANNSearchParams;
+using alaya::diskann::FilterLabelsView;
 
 std::vector<float> make_vectors(uint64_t n, uint64_t dim, uint32_t seed = 123) {
   std::mt19937 rng(seed);
@@ -57,6 +61,46 @@ std::vector<uint32_t> brute_force_ids(const std::vector<float> &v, uint64_t n, u
   return ids;
 }
 
+void write_fbin(const std::filesystem::path &p, const std::vector<float> &v, uint32_t n,
+                uint32_t dim) {
+  std::ofstream out(p, std::ios::binary);
+  out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+  out.write(reinterpret_cast<const char *>(&dim), sizeof(dim));
+  out.write(reinterpret_cast<const char *>(v.data()),
+            static_cast<std::streamsize>(v.size() * sizeof(float)));
+}
+
+// A budget a third of the in-memory Vamana estimate, forcing the sharded build.
+float tight_budget_gb(uint64_t n, uint64_t dim, uint32_t R) {
+  return static_cast<float>(alaya::vamana::estimate_ram_usage_gib(n, dim, sizeof(float), R) / 3.0);
+}
+
+// Filter labels: point i belongs to tenant i % 4, and every 40th point (i % 40 == 7)
+// also carries the rare label 100.
+struct TenantLabels {
+  std::vector<uint64_t> offsets{0};
+  std::vector<uint32_t> values;
+
+  explicit TenantLabels(uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i) {
+      values.push_back(static_cast<uint32_t>(i % 4));
+      if (i % 40 == 7) {
+        values.push_back(100);
+      }
+      offsets.push_back(values.size());
+    }
+  }
+  FilterLabelsView view() const { return {offsets.data(), values.data()}; }
+  bool has(uint64_t id, uint32_t label) const {
+    return std::find(values.begin() + static_cast<std::ptrdiff_t>(offsets[id]),
+                     values.begin() + static_cast<std::ptrdiff_t>(offsets[id + 1]),
+                     label) != values.begin() + static_cast<std::ptrdiff_t>(offsets[id + 1]);
+  }
+  bool matches(uint64_t id, const std::vector<uint32_t> &filter) const {
+    return std::any_of(filter.begin(), filter.end(), [&](uint32_t l) { return has(id, l); });
+  }
+};
+
 class DiskANNIndexTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -353,4 +397,268 @@ TEST_F(DiskANNIndexTest, BatchSearchSingleThread) {
   }
 }
 
+// ----------------------------- filtered search ----------------------------
+
+TEST_F(DiskANNIndexTest, FilteredSearchReturnsOnlyMatchingPoints) {
+  const uint64_t n = 800, dim = 32;
+  const uint32_t nq = 10, k = 10;
+  const auto v = make_vectors(n, dim);
+  const auto labels = make_labels(n);
+  const TenantLabels tenants(n);
+  const auto queries = make_vectors(nq, dim, /*seed=*/17);
+  DiskANNBuildParams bp;
+  bp.R = 32;
+  bp.pq_n_chunks = 8;
+  DiskANNIndex::build(dir(), v.data(), labels.data(), n, dim, bp, tenants.view());
+  EXPECT_TRUE(std::filesystem::exists(dir_ / "labels.bin"));
+
+  DiskANNIndex idx;
+  idx.load(dir(), {/*num_threads=*/2, /*beam_width=*/4});
+  ASSERT_TRUE(idx.has_filter_labels());
+
+  const std::vector<std::vector<uint32_t>> filters = {{2}, {100}, {1, 3}};
+  for (const bool use_pq : {true, false}) {
+    for (const bool deterministic : {true, false}) {
+      for (const auto &filter : filters) {
+        DiskANNSearchParams sp;
+        sp.search_list_size = 100;
+        sp.use_pq = use_pq;
+        sp.rerank_count = 100;
+        sp.deterministic = deterministic;
+        sp.filter_labels = filter;
+        double hits = 0;
+        double expected = 0;
+        for (uint32_t qi = 0; qi < nq; ++qi) {
+          const float *q = queries.data() + qi * dim;
+          std::vector<uint64_t> out_l(k);
+          std::vector<float> out_d(k);
+          const uint32_t cnt = idx.search(q, k, out_l.data(), out_d.data(), sp);
+          // Exact filtered top-k over the matching points.
+          std::vector<std::pair<float, uint64_t>> truth;
+          for (uint64_t i = 0; i < n; ++i) {
+            if (tenants.matches(i, filter)) {
+              truth.emplace_back(alaya::simd::l2_sqr<float, float>(q, v.data() + i * dim, dim),
+                                 labels[i]);
+            }
+          }
+          std::sort(truth.begin(), truth.end());
+          truth.resize(std::min<size_t>(truth.size(), k));
+          expected += static_cast<double>(truth.size());
+          for (uint32_t i = 0; i < cnt; ++i) {
+            ASSERT_TRUE(tenants.matches(out_l[i] - 1000, filter))
+                << "use_pq=" << use_pq << " label=" << out_l[i];
+            for (const auto &t : truth) {
+              hits += t.second == out_l[i] ? 1.0 : 0.0;
+            }
+          }
+        }
+        EXPECT_GE(hits / expected, 0.85)
+            << "use_pq=" << use_pq << " deterministic=" << deterministic
+            << " filter[0]=" << filter[0];
+      }
+    }
+  }
+}
+
+TEST_F(DiskANNIndexTest, FilteredSearchRequiresFilterLabels) {
+  const uint64_t n = 100, dim = 16;
+  const auto v = make_vectors(n, dim);
+  const auto labels = make_labels(n);
+  DiskANNIndex::build(dir(), v.data(), labels.data(), n, dim, {});
+  EXPECT_FALSE(std::filesystem::exists(dir_ / "labels.bin"));
+
+  DiskANNIndex idx;
+  idx.load(dir());
+  EXPECT_FALSE(idx.has_filter_labels());
+  DiskANNSearchParams sp;
+  sp.filter_labels = {1};
+  std::vector<uint64_t> out_l(5);
+  std::vector<float> out_d(5);
+  EXPECT_THROW(idx.search(v.data(), 5, out_l.data(), out_d.data(), sp), std::invalid_argument);
+}
+
+TEST_F(DiskANNIndexTest, ReusedSlotDropsFilterLabels) {
+  const uint64_t n = 200, dim = 16;
+  const auto v = make_vectors(n, dim);
+  const auto labels = make_labels(n);
+  const TenantLabels tenants(n);
+  DiskANNBuildParams bp;
+  bp.R = 16;
+  bp.pq_n_chunks = 0;
+  DiskANNIndex::build(dir(), v.data(), labels.data(), n, dim, bp, tenants.view());
+
+  DiskANNLoadParams lp;
+  lp.updatable = true;
+  lp.update_io = alaya::diskann::DiskANNUpdateIO::kBlocking;
+  auto idx = std::make_unique<DiskANNIndex>();
+  idx->load(dir(), lp);
+  // Slot 7 carries tenant 3 and the rare label; its reuse must carry neither.
+  idx->remove(7);
+  const auto fresh = make_vectors(1, dim, /*seed=*/99);
+  ASSERT_EQ(idx->insert(fresh.data(), 5000), 7U);
+
+  DiskANNSearchParams sp;
+  sp.search_list_size = 64;
+  sp.use_pq = false;
+  auto filtered_labels = [&](DiskANNIndex &index, std::vector<uint32_t> filter) {
+    sp.filter_labels = std::move(filter);
+    std::vector<uint64_t> out_l(20);
+    std::vector<float> out_d(20);
+    const uint32_t cnt = index.search(fresh.data(), 20, out_l.data(), out_d.data(), sp);
+    return std::vector<uint64_t>(out_l.begin(), out_l.begin() + cnt);
+  };
+  for (const uint32_t label : {3U, 100U}) {
+    const auto found = filtered_labels(*idx, {label});
+    EXPECT_FALSE(found.empty());
+    EXPECT_EQ(std::count(found.begin(), found.end(), 5000U), 0) << "label " << label;
+  }
+
+  idx->flush();
+  idx = std::make_unique<DiskANNIndex>();
+  idx->load(dir(), lp);
+  const auto found = filtered_labels(*idx, {100});
+  EXPECT_EQ(std::count(found.begin(), found.end(), 5000U), 0);
+  EXPECT_EQ(std::count(found.begin(), found.end(), 1007U), 0);
+}
+
+// ----------------------------- adaptive cache ------------------------------
+
+TEST_F(DiskANNIndexTest, AdaptiveCacheLearnsSkewedQueriesAndWarmStarts) {
+  const uint64_t n = 1000, dim = 32;
+  const uint32_t nq = 4, k = 10;
+  const auto v = make_vectors(n, dim);
+  const auto labels = make_labels(n);
+  const auto queries = make_vectors(nq, dim, /*seed=*/23);
+  DiskANNBuildParams bp;
+  bp.R = 32;
+  bp.pq_n_chunks = 8;
+  bp.cache_ratio = 0.01;
+  DiskANNIndex::build(dir(), v.data(), labels.data(), n, dim, bp);
+
+  DiskANNSearchParams sp;
+  sp.search_list_size = 64;
+  sp.deterministic = true;
+  // One pass over the hot queries; returns the cache hits and the result labels.
+  auto run = [&](const DiskANNIndex &index, bool use_pq) {
+    sp.use_pq = use_pq;
+    uint64_t hits = 0;
+    std::vector<uint64_t> found;
+    for (uint32_t qi = 0; qi < nq; ++qi) {
+      std::vector<uint64_t> out_l(k);
+      std::vector<float> out_d(k);
+      alaya::diskann::SearchStats stats;
+      const uint32_t cnt =
+          index.search(queries.data() + qi * dim, k, out_l.data(), out_d.data(), sp, &stats);
+      hits += stats.n_cache_hits;
+      found.insert(found.end(), out_l.begin(), out_l.begin() + cnt);
+    }
+    return std::make_pair(hits, found);
+  };
+
+  DiskANNIndex plain;
+  plain.load(dir(), {/*num_threads=*/2, /*beam_width=*/4});
+  DiskANNLoadParams lp{/*num_threads=*/2, /*beam_width=*/4};
+  lp.adaptive_cache_bytes = 150 * (dim + 1 + bp.R) * sizeof(float);  // ~150 of 1000 records
+  DiskANNIndex idx;
+  for (const bool use_pq : {false, true}) {
+    idx.load(dir(), lp);
+    const auto cold = run(idx, use_pq);
+    for (int pass = 0; pass < 3; ++pass) {
+      run(idx, use_pq);
+    }
+    const auto warm = run(idx, use_pq);
+    EXPECT_GT(warm.first, cold.first) << "use_pq=" << use_pq;
+    EXPECT_EQ(warm.second, run(plain, use_pq).second) << "use_pq=" << use_pq;
+  }
+  ASSERT_GT(idx.adaptive_cache_size(), 0U);
+  EXPECT_EQ(plain.adaptive_cache_size(), 0U);
+  EXPECT_THROW(plain.save_adaptive_cache(), std::runtime_error);
+
+  idx.save_adaptive_cache();
+  ASSERT_TRUE(std::filesystem::exists(dir_ / "hot_cache_ids.bin"));
+  const uint64_t learned = idx.adaptive_cache_size();
+  const uint64_t learned_hits = run(idx, true).first;
+  DiskANNIndex restarted;
+  restarted.load(dir(), lp);
+  EXPECT_EQ(restarted.adaptive_cache_size(), learned);
+  EXPECT_GE(run(restarted, true).first, learned_hits * 9 / 10);
+
+  lp.updatable = true;
+  DiskANNIndex updatable;
+  EXPECT_THROW(updatable.load(dir(), lp), std::invalid_argument);
+}
+
+// ----------------------------- out-of-core build ---------------------------
+
+TEST_F(DiskANNIndexTest, OverBudgetFbinBuildStreamsEveryPhase) {
+  const uint64_t n = 3000, dim = 16;
+  const auto v = make_vectors(n, dim);
+  const auto base = std::filesystem::temp_directory_path() / (dir_.filename().string() + ".fbin");
+  write_fbin(base, v, n, dim);
+  DiskANNBuildParams bp;
+  bp.R = 24;
+  bp.L = 48;
+  bp.pq_n_chunks = 4;
+  bp.build_dram_budget_gb = tight_budget_gb(n, dim, bp.R);
+  DiskANNIndex::build(dir(), base.string(), /*labels=*/nullptr, bp);
+  std::filesystem::remove(base);
+
+  namespace fs = std::filesystem;
+  EXPECT_FALSE(fs::exists(dir_ / "build_work"));
+  EXPECT_EQ(fs::file_size(dir_ / "pq_compressed.bin"), n * 4);
+
+  DiskANNIndex idx;
+  idx.load(dir(), {2, 4});
+  ASSERT_EQ(idx.size(), n);
+  ASSERT_TRUE(idx.has_pq());
+  uint32_t hits = 0;
+  const uint32_t nq = 20, k = 10;
+  for (const bool use_pq : {false, true}) {
+    for (uint32_t qi = 0; qi < nq; ++qi) {
+      const float *q = v.data() + (qi * 131) * dim;
+      std::vector<uint64_t> out_l(k);
+      std::vector<float> out_d(k);
+      DiskANNSearchParams sp;
+      sp.search_list_size = 64;
+      sp.use_pq = use_pq;
+      const uint32_t cnt = idx.search(q, k, out_l.data(), out_d.data(), sp);
+      ASSERT_EQ(cnt, k);
+      const auto truth = brute_force_ids(v, n, dim, q, k);
+      for (uint32_t i = 0; i < cnt; ++i) {  // null labels => row numbers
+        hits += std::count(truth.begin(), truth.end(), static_cast<uint32_t>(out_l[i]));
+      }
+    }
+  }
+  EXPECT_GE(static_cast<double>(hits) / (2.0 * nq * k), 0.9);
+}
+
+TEST_F(DiskANNIndexTest, OverBudgetVectorBuildKeepsFilterLabels) {
+  const uint64_t n = 2000, dim = 16;
+  const auto v = make_vectors(n, dim);
+  const auto labels = make_labels(n);
+  const TenantLabels tenants(n);
+  DiskANNBuildParams bp;
+  bp.R = 24;
+  bp.L = 48;
+  bp.build_dram_budget_gb = tight_budget_gb(n, dim, bp.R);
+  DiskANNIndex::build(dir(), v.data(), labels.data(), n, dim, bp, tenants.view());
+  EXPECT_FALSE(std::filesystem::exists(dir_ / "build_work"));
+
+  DiskANNIndex idx;
+  idx.load(dir(), {2, 4});
+  ASSERT_TRUE(idx.has_filter_labels());
+  DiskANNSearchParams sp;
+  sp.search_list_size = 64;
+  sp.use_pq = false;
+  sp.filter_labels = {100};
+  std::vector<uint64_t> out_l(5);
+  std::vector<float> out_d(5);
+  const uint32_t cnt = idx.search(v.data() + 7 * dim, 5, out_l.data(), out_d.data(), sp);
+  ASSERT_EQ(cnt, 5U);
+  EXPECT_EQ(out_l[0], 1007U);  // the query is point 7, which carries label 100
+  for (uint32_t i = 0; i < cnt; ++i) {
+    EXPECT_TRUE(tenants.has(out_l[i] - 1000, 100)) << out_l[i];
+  }
+}
+
 }  // namespace
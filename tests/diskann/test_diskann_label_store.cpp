@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "index/graph/diskann/label_store.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using alaya::diskann::FilterLabelsView;
+using alaya::diskann::LabelFilter;
+using alaya::diskann::LabelStore;
+
+std::vector<uint32_t> labels_of(const LabelStore &store, uint64_t id) {
+  const auto [first, last] = store.labels_of(id);
+  return {first, last};
+}
+
+class LabelStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    static std::atomic<uint64_t> counter{0};
+    path_ = std::filesystem::temp_directory_path() /
+            ("diskann_labels_" + std::to_string(counter.fetch_add(1)) + ".bin");
+  }
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove(path_, ec);
+  }
+
+  // Six 1-D points: 0,1,2 carry label 7; 2,3,4 carry label 9; 5 carries nothing.
+  void assign(LabelStore &store) const {
+    store.assign({offsets_.data(), values_.data()}, 6);
+    store.compute_entry_points(coords_.data(), 1);
+  }
+
+  std::filesystem::path path_;
+  std::vector<uint64_t> offsets_ = {0, 1, 2, 5, 6, 7, 7};
+  std::vector<uint32_t> values_ = {7, 7, 9, 7, 7, 9, 9};
+  std::vector<float> coords_ = {0.0f, 1.0f, 2.0f, 10.0f, 5.0f, 3.0f};
+};
+
+TEST_F(LabelStoreTest, AssignSortsAndDeduplicatesPerPoint) {
+  LabelStore store;
+  assign(store);
+  EXPECT_EQ(store.size(), 6U);
+  EXPECT_EQ(labels_of(store, 1), (std::vector<uint32_t>{7}));
+  EXPECT_EQ(labels_of(store, 2), (std::vector<uint32_t>{7, 9}));
+  EXPECT_TRUE(labels_of(store, 5).empty());
+  EXPECT_TRUE(labels_of(store, 99).empty());
+  EXPECT_EQ(store.label_count(), 2U);
+}
+
+TEST_F(LabelStoreTest, EntryPointIsMemberClosestToCentroid) {
+  LabelStore store;
+  assign(store);
+  EXPECT_EQ(store.entry_point(7), 1U);  // centroid of {0, 1, 2} is 1
+  EXPECT_EQ(store.entry_point(9), 4U);  // centroid of {2, 10, 5} is 17/3
+  EXPECT_EQ(store.entry_point(8), LabelStore::kNoEntry);
+}
+
+TEST_F(LabelStoreTest, FilterMatchesAnyOfItsLabels) {
+  LabelStore store;
+  assign(store);
+  LabelFilter only9(store, {9}, 8);
+  EXPECT_FALSE(only9.matches(0));
+  EXPECT_TRUE(only9.matches(2));
+  EXPECT_TRUE(only9.matches(3));
+  EXPECT_FALSE(only9.matches(5));
+  LabelFilter any(store, {9, 42, 7, 9}, 1);
+  EXPECT_TRUE(any.matches(0));
+  EXPECT_TRUE(any.matches(3));
+  EXPECT_FALSE(any.matches(5));
+  EXPECT_EQ(any.entry_points().size(), 1U);  // capped; label 7 comes first
+  EXPECT_EQ(any.entry_points()[0], store.entry_point(7));
+}
+
+TEST_F(LabelStoreTest, UnlabeledSlotsSurviveSaveLoad) {
+  LabelStore store;
+  assign(store);
+  store.unlabel(2);
+  EXPECT_TRUE(labels_of(store, 2).empty());
+  store.save(path_.string());
+
+  LabelStore loaded;
+  loaded.load(path_.string(), 6);
+  EXPECT_EQ(loaded.size(), 6U);
+  EXPECT_TRUE(labels_of(loaded, 2).empty());
+  EXPECT_EQ(labels_of(loaded, 3), (std::vector<uint32_t>{9}));
+  EXPECT_EQ(loaded.entry_point(7), store.entry_point(7));
+  EXPECT_THROW(loaded.load(path_.string(), 5), std::runtime_error);
+}
+
+TEST_F(LabelStoreTest, AssignRejectsMalformedOffsets) {
+  LabelStore store;
+  const std::vector<uint64_t> decreasing = {0, 2, 1};
+  EXPECT_THROW(store.assign({decreasing.data(), values_.data()}, 2), std::invalid_argument);
+  const std::vector<uint64_t> shifted = {1, 2};
+  EXPECT_THROW(store.assign({shifted.data(), values_.data()}, 1), std::invalid_argument);
+  EXPECT_THROW(store.assign(FilterLabelsView{}, 1), std::invalid_argument);
+}
+
+}  // namespace
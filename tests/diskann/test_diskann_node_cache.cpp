@@ -209,6 +209,27 @@ TEST_F(NodeCacheTest, FileRoundtrip) {
   }
 }
 
+TEST_F(NodeCacheTest, GenerateFromDiskMatchesInMemory) {
+  const uint64_t n = 800, dim = 16;
+  const uint32_t r = 10, medoid = 55;
+  const auto vecs = make_vectors(n, dim);
+  const auto graph = make_connected_graph(n, r);
+  NodeCache cache;
+  cache.generate(graph, vecs.data(), medoid, n, dim, r, /*cache_ratio=*/0.15);
+
+  const auto index_path = temp_path("index");
+  alaya::diskann::write_disk_layout(index_path.string(), vecs.data(), graph, {n, dim, r, medoid});
+  NodeCache from_disk;
+  from_disk.generate_from_disk(index_path.string(), medoid, n, dim, r, /*cache_ratio=*/0.15);
+
+  EXPECT_EQ(from_disk.ids(), cache.ids());
+  for (const uint32_t id : cache.ids()) {
+    ASSERT_NE(from_disk.lookup(id), nullptr) << "id=" << id;
+    EXPECT_EQ(std::memcmp(from_disk.lookup(id), cache.lookup(id), cache.node_len()), 0)
+        << "id=" << id;
+  }
+}
+
 TEST_F(NodeCacheTest, ConcurrentReadSafety) {
   const uint64_t n = 2000, dim = 32;
   const uint32_t r = 16, medoid = 7;
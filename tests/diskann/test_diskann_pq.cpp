@@ -329,6 +329,95 @@ TEST_F(PQTableTest, LoadRejectsWrongSize) {
                std::runtime_error);
 }
 
+// --- 4-bit fast-scan mode ---------------------------------------------------
+
+TEST_F(PQTableTest, FourBitRejectsChunksNotMultipleOfFourAndPacksNibbles) {
+  const uint64_t n = 64, dim = 32;
+  const auto data = make_vectors(n, dim);
+  PQTable odd(4);
+  EXPECT_THROW(odd.train(data.data(), n, dim, 3), std::invalid_argument);
+  // Even but not a multiple of 4: fastscan would fall back to the scalar path.
+  EXPECT_THROW(odd.train(data.data(), n, dim, 2), std::invalid_argument);
+  EXPECT_THROW(
+      PQTable::from_codebook(dim, 2, std::vector<float>(dim), std::vector<float>(16 * dim), 4),
+      std::invalid_argument);
+  EXPECT_THROW(PQTable(5), std::invalid_argument);
+
+  PQTable pq(4);
+  pq.train(data.data(), n, dim, 8);
+  pq.encode(data.data(), n);
+  EXPECT_EQ(pq.num_centroids(), 16u);
+  EXPECT_EQ(pq.code_bytes(), 4u);
+  EXPECT_EQ(pq.codes().size(), n * 4);
+  EXPECT_EQ(pq.codebook().size(), static_cast<size_t>(16) * dim);
+}
+
+TEST_F(PQTableTest, FourBitBatchMatchesSingleAndApproximatesFloatTable) {
+  // dim 96 / 24 chunks: fs_dim = 96 takes the SIMD path with a partial last block.
+  for (const uint32_t n_chunks : {24u, 4u}) {
+    const uint64_t n = 300, dim = 96;
+    const auto data = make_vectors(n, dim, /*seed=*/5);
+    PQTable pq(4);
+    pq.train(data.data(), n, dim, n_chunks, /*n_iters=*/4);
+    pq.encode(data.data(), n);
+
+    std::vector<float> table(pq.query_table_size());
+    std::vector<float> qres(dim);
+    const float *query = data.data() + 7 * dim;
+    pq.preprocess_query(query, table.data(), qres.data());
+
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < 45; ++i) {  // more than one 32-wide block
+      ids.push_back((i * 37) % n);
+    }
+    std::vector<float> batch(ids.size());
+    pq.pq_distance_batch(ids.data(), static_cast<uint32_t>(ids.size()), table.data(), batch.data());
+    for (size_t i = 0; i < ids.size(); ++i) {
+      EXPECT_FLOAT_EQ(batch[i], pq.pq_distance(ids[i], table.data())) << "i=" << i;
+
+      // The uint8 LUT costs at most half a quantization step per chunk over the float table.
+      float exact = 0.0f;
+      const uint8_t *row = pq.codes().data() + static_cast<size_t>(ids[i]) * pq.code_bytes();
+      for (uint32_t c = 0; c < n_chunks; ++c) {
+        const uint8_t byte = row[c / 2];
+        const uint32_t k = (c % 2 == 0) ? (byte >> 4) : (byte & 0x0F);
+        exact += table[static_cast<size_t>(c) * 16 + k];
+      }
+      EXPECT_NEAR(batch[i], exact, 0.02f * exact + 1.0f) << "i=" << i;
+    }
+  }
+}
+
+TEST_F(PQTableTest, FourBitFileRoundtrip) {
+  const uint64_t n = 100, dim = 32;
+  const uint32_t n_chunks = 16;
+  const auto data = make_vectors(n, dim);
+  PQTable pq(4);
+  pq.train(data.data(), n, dim, n_chunks);
+  pq.encode(data.data(), n);
+  const auto pivots = temp_path("pivots4");
+  const auto compressed = temp_path("compressed4");
+  pq.save(pivots.string(), compressed.string());
+
+  PQTable loaded;
+  loaded.load(pivots.string(), compressed.string(), n, dim, n_chunks, /*code_bits=*/4);
+  EXPECT_EQ(loaded.codes(), pq.codes());
+  EXPECT_EQ(loaded.codebook(), pq.codebook());
+
+  std::vector<float> t0(pq.query_table_size());
+  std::vector<float> t1(loaded.query_table_size());
+  std::vector<float> qres(dim);
+  pq.preprocess_query(data.data(), t0.data(), qres.data());
+  loaded.preprocess_query(data.data(), t1.data(), qres.data());
+  for (uint64_t pi : {0ull, 50ull, 99ull}) {
+    EXPECT_EQ(pq.pq_distance(pi, t0.data()), loaded.pq_distance(pi, t1.data())) << "pi=" << pi;
+  }
+  // Reading a 4-bit codebook as 8-bit is a size mismatch, not silent garbage.
+  PQTable wrong;
+  EXPECT_THROW(wrong.load(pivots.string(), compressed.string(), n, dim, n_chunks),
+               std::runtime_error);
+}
+
 TEST_F(PQTableTest, FromCodebookRejectsBadShapes) {
   EXPECT_THROW(PQTable::from_codebook(4, 3, std::vector<float>(4), std::vector<float>(4)),
                std::invalid_argument);  // 4 % 3 != 0
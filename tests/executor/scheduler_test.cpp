@@ -4,11 +4,97 @@
 
 #include "executor/scheduler.hpp"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <ctime>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace alaya {
 
+namespace {
+
+// Minimal owning coroutine: starts suspended and stays suspended at the end, like coro::task<>, so
+// the worker observes done() before the owner destroys the frame.
+struct StepTask {
+  struct promise_type {
+    auto get_return_object() -> StepTask {
+      return StepTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+    auto final_suspend() noexcept -> std::suspend_always { return {}; }
+    void return_void() noexcept {}
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  explicit StepTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+  StepTask(StepTask &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+  StepTask(const StepTask &) = delete;
+  auto operator=(const StepTask &) -> StepTask & = delete;
+  auto operator=(StepTask &&) -> StepTask & = delete;
+  ~StepTask() {
+    if (handle_ != nullptr) {
+      handle_.destroy();
+    }
+  }
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+// Suspends `steps` times (as the search jobs do around prefetches) before recording completion.
+auto count_after_steps(uint32_t steps, std::atomic<uint32_t> &done) -> StepTask {
+  for (uint32_t i = 0; i < steps; ++i) {
+    co_await std::suspend_always{};
+  }
+  done.fetch_add(1);
+}
+
+// Yields through the scheduler instead of suspend_always and counts every resumption.
+auto reschedule_steps(Scheduler &scheduler, uint32_t steps, std::atomic<uint32_t> &resumptions)
+    -> StepTask {
+  for (uint32_t i = 0; i < steps; ++i) {
+    co_await scheduler.schedule();
+    resumptions.fetch_add(1);
+  }
+}
+
+// Schedules every child from the worker it runs on, so the children land on that worker's deque.
+auto spawn_children(Scheduler &scheduler, std::vector<StepTask> &children) -> StepTask {
+  for (auto &child : children) {
+    scheduler.schedule(child.handle_);
+  }
+  co_return;
+}
+
+// Blocks its worker for a moment, leaving the rest of the spawner's deque to the other workers.
+auto record_thread(std::mutex &mutex, std::set<std::thread::id> &threads) -> StepTask {
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  std::lock_guard<std::mutex> guard(mutex);
+  threads.insert(std::this_thread::get_id());
+  co_return;
+}
+
+// Tracks how many of these tasks are in flight at once on a worker.
+auto track_in_flight(uint32_t steps, std::atomic<uint32_t> &live, std::atomic<uint32_t> &peak)
+    -> StepTask {
+  auto now = live.fetch_add(1) + 1;
+  auto prev = peak.load();
+  while (prev < now && !peak.compare_exchange_weak(prev, now)) {
+  }
+  for (uint32_t i = 0; i < steps; ++i) {
+    co_await std::suspend_always{};
+  }
+  live.fetch_sub(1);
+}
+
+}  // namespace
+
 class SchedulerTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -22,4 +108,164 @@ class SchedulerTest : public ::testing::Test {
   std::unique_ptr<Scheduler> scheduler_;
 };
 
+TEST_F(SchedulerTest, RunToDrainCompletesScheduledTasks) {
+  std::atomic<uint32_t> done{0};
+  std::vector<StepTask> tasks;
+  for (uint32_t i = 0; i < 16; ++i) {
+    tasks.push_back(count_after_steps(i % 4, done));
+    scheduler_->schedule(tasks.back().handle_);
+  }
+  scheduler_->begin();
+  scheduler_->join();
+  EXPECT_EQ(done.load(), 16U);
+}
+
+TEST_F(SchedulerTest, IdleWorkersParkInsteadOfSpinning) {
+  std::vector<CpuID> cpus{0, 1, 2, 3};
+  Scheduler scheduler(cpus);
+  scheduler.begin();
+  auto before = std::clock();
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  auto cpu_ms = 1000.0 * static_cast<double>(std::clock() - before) / CLOCKS_PER_SEC;
+  // Four spinning workers would burn up to 800ms of CPU time here.
+  EXPECT_LT(cpu_ms, 50.0);
+
+  std::atomic<uint32_t> done{0};
+  auto task = count_after_steps(2, done);
+  scheduler.schedule(task.handle_);  // a parked worker must still pick up late work
+  scheduler.join();
+  EXPECT_EQ(done.load(), 1U);
+}
+
+TEST_F(SchedulerTest, IdleWorkersStealSpawnedTasks) {
+  std::vector<CpuID> cpus{0, 1, 2, 3};
+  Scheduler scheduler(cpus);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  std::vector<StepTask> children;
+  for (uint32_t i = 0; i < 64; ++i) {
+    children.push_back(record_thread(mutex, threads));
+  }
+  auto root = spawn_children(scheduler, children);
+  scheduler.schedule(root.handle_);
+  scheduler.begin();
+  scheduler.join();
+  for (auto &child : children) {
+    EXPECT_TRUE(child.handle_.done());
+  }
+  EXPECT_GT(threads.size(), 1U);
+}
+
+TEST(PersistentSchedulerTest, RunsManyBatchesOnTheSameWorkers) {
+  std::vector<CpuID> cpus{0, 1, 2};
+  Scheduler scheduler(cpus, true);
+  scheduler.begin();
+  EXPECT_TRUE(scheduler.persistent());
+  EXPECT_EQ(scheduler.worker_count(), 3U);
+
+  for (uint32_t batch = 0; batch < 50; ++batch) {
+    std::atomic<uint32_t> done{0};
+    std::vector<StepTask> tasks;
+    std::vector<std::coroutine_handle<>> handles;
+    const uint32_t size = 1 + batch % 7;
+    for (uint32_t i = 0; i < size; ++i) {
+      tasks.push_back(count_after_steps(i % 5, done));
+      handles.push_back(tasks.back().handle_);
+    }
+    scheduler.run_batch(handles);
+    ASSERT_EQ(done.load(), size) << "batch " << batch;
+  }
+  // An idle gap lets every worker park; the next batch must wake them.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  std::atomic<uint32_t> done{0};
+  auto task = count_after_steps(3, done);
+  scheduler.run_batch({task.handle_});
+  EXPECT_EQ(done.load(), 1U);
+  scheduler.join();
+}
+
+TEST(PersistentSchedulerTest, ConcurrentCallersEachSeeTheirBatchFinish) {
+  std::vector<CpuID> cpus{0, 1};
+  Scheduler scheduler(cpus, true);
+  scheduler.begin();
+
+  std::vector<std::thread> callers;
+  std::atomic<uint32_t> failures{0};
+  for (uint32_t c = 0; c < 4; ++c) {
+    callers.emplace_back([&scheduler, &failures] {
+      for (uint32_t batch = 0; batch < 20; ++batch) {
+        std::atomic<uint32_t> done{0};
+        std::vector<StepTask> tasks;
+        std::vector<std::coroutine_handle<>> handles;
+        for (uint32_t i = 0; i < 8; ++i) {
+          tasks.push_back(count_after_steps(i % 3, done));
+          handles.push_back(tasks.back().handle_);
+        }
+        scheduler.run_batch(handles);
+        if (done.load() != 8U) {
+          failures.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto &caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(failures.load(), 0U);
+}
+
+TEST(PersistentSchedulerTest, RescheduledTasksResumeExactlyOnce) {
+  std::vector<CpuID> cpus{0, 1, 2};
+  Scheduler scheduler(cpus, true);
+  scheduler.begin();
+  std::atomic<uint32_t> resumptions{0};
+  std::vector<StepTask> tasks;
+  std::vector<std::coroutine_handle<>> handles;
+  for (uint32_t i = 0; i < 32; ++i) {
+    tasks.push_back(reschedule_steps(scheduler, 10, resumptions));
+    handles.push_back(tasks.back().handle_);
+  }
+  scheduler.run_batch(handles);
+  EXPECT_EQ(resumptions.load(), 320U);
+  for (auto &task : tasks) {
+    EXPECT_TRUE(task.handle_.done());
+  }
+}
+
+TEST(PersistentSchedulerTest, InterleaveDepthBoundsTasksInFlight) {
+  std::vector<CpuID> cpus{0};
+  Scheduler scheduler(cpus, true, false, 2);
+  scheduler.begin();
+  EXPECT_EQ(scheduler.interleave(), 2U);
+
+  auto run = [&scheduler](uint32_t interleave) {
+    std::atomic<uint32_t> live{0};
+    std::atomic<uint32_t> peak{0};
+    std::vector<StepTask> tasks;
+    std::vector<std::coroutine_handle<>> handles;
+    for (uint32_t i = 0; i < 24; ++i) {
+      tasks.push_back(track_in_flight(5, live, peak));
+      handles.push_back(tasks.back().handle_);
+    }
+    scheduler.run_batch(handles, interleave);
+    return peak.load();
+  };
+  EXPECT_EQ(run(0), 2U);  // the scheduler's depth
+  EXPECT_EQ(run(1), 1U);  // per-batch overrides
+  EXPECT_EQ(run(8), 8U);
+  EXPECT_EQ(run(0), 2U);  // an override does not outlive its batch
+
+  scheduler.set_interleave(1000);
+  EXPECT_EQ(scheduler.interleave(), kMaxInterleave);
+}
+
+TEST(PersistentSchedulerTest, DestructorStopsParkedWorkers) {
+  std::vector<CpuID> cpus{0, 1};
+  auto scheduler = std::make_unique<Scheduler>(cpus, true);
+  scheduler->begin();
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  scheduler.reset();  // must not hang on workers parked with an empty queue
+  SUCCEED();
+}
+
 }  // namespace alaya
@@ -16,6 +16,7 @@
 #include "index/graph/graph.hpp"
 #include "index/graph/hnsw/hnsw_builder.hpp"
 #include "index/graph/qg/qg_builder.hpp"
+#include "space/pq_space.hpp"
 #include "space/rabitq_space.hpp"
 #include "space/raw_space.hpp"
 #include "space/sq8_space.hpp"
@@ -462,6 +463,25 @@ TEST_F(SearchTest, SearchHNSWTestSQSpace) {
   EXPECT_GE(recall, 0.5);
 }
 
+TEST_F(SearchTest, SearchHNSWTestPQSpace) {
+  auto &dataset = ds();
+  auto pq_space = std::make_shared<PQSpace<>>(dataset.data_num_, dataset.dim_, MetricType::L2);
+  pq_space->fit(dataset.data_.data(), dataset.data_num_);
+  auto search_job = std::make_unique<GraphSearchJob<PQSpace<>, RawSpaceType>>(pq_space,
+                                                                              graph(),
+                                                                              nullptr,
+                                                                              raw_space());
+
+  auto res_pool = run_parallel_search(search_job, dataset, kDefaultTopk, kDefaultEf);
+  auto recall = calc_recall(res_pool,
+                            dataset.ground_truth_.data(),
+                            dataset.query_num_,
+                            dataset.gt_dim_,
+                            kDefaultTopk);
+  LOG_INFO("pq recall is {}.", recall);
+  EXPECT_GE(recall, 0.5);
+}
+
 TEST(GraphSearchJobUnitTest, SearchInfoOverloadWithoutBlockedMaskMatchesPlainSearch) {
   auto space = make_one_dim_raw_space({10.0F, 20.0F, 30.0F, 0.0F, 1.0F});
   auto graph = make_graph_from_edges({{3, 1}, {2}, {}, {4}, {}});
@@ -537,6 +557,97 @@ TEST(GraphSearchJobUnitTest, UnderfilledRerankMarksMissingIdsInvalid) {
   EXPECT_EQ(ids[2], std::numeric_limits<uint32_t>::max());
 }
 
+TEST(GraphSearchJobUnitTest, PooledScratchDoesNotLeakVisitedStateAcrossQueries) {
+  auto space = make_one_dim_raw_space({10.0F, 20.0F, 30.0F, 0.0F, 1.0F});
+  auto graph = make_graph_from_edges({{3, 1}, {2}, {}, {4}, {}});
+  GraphSearchJob<RawSpaceType> search_job(space, graph);
+
+  std::vector<float> near_query = {0.1F};
+  std::vector<float> far_query = {29.0F};
+  std::vector<uint32_t> first_near(2);
+  std::vector<uint32_t> first_far(2);
+  std::vector<float> near_dists(2);
+  search_job.search_solo(near_query.data(), first_near.data(), 2, 4);
+  search_job.search_solo(far_query.data(), first_far.data(), 2, 4);
+  EXPECT_EQ(first_near, (std::vector<uint32_t>{3, 4}));
+  EXPECT_EQ(first_far, (std::vector<uint32_t>{2, 1}));
+
+  // Every later query leases the same scratch; a stale visited mark would hide nodes.
+  for (int round = 0; round < 100; ++round) {
+    std::vector<uint32_t> ids(2);
+    search_job.search_solo(round % 2 == 0 ? near_query.data() : far_query.data(),
+                           ids.data(),
+                           2,
+                           round % 3 == 0 ? 2 : 4);
+    EXPECT_EQ(ids, round % 2 == 0 ? first_near : first_far) << "round " << round;
+  }
+  std::vector<uint32_t> ids(2);
+  search_job.search_solo(near_query.data(), ids.data(), near_dists.data(), 2, 4);
+  EXPECT_EQ(ids, first_near);
+  EXPECT_FLOAT_EQ(near_dists[0], 0.01F);
+}
+
+TEST(GraphSearchJobUnitTest, PooledScratchFollowsGrowingSpace) {
+  auto space = std::make_shared<RawSpaceType>(8, 1, MetricType::L2);
+  std::vector<float> values = {10.0F, 20.0F, 0.0F};
+  space->fit(values.data(), 3);
+  auto graph = std::make_shared<GraphType>(8, 2);
+  graph->eps_.push_back(0);
+  graph->at(0, 0) = 1;
+  graph->at(0, 1) = 2;
+  GraphSearchJob<RawSpaceType> search_job(space, graph);
+
+  std::vector<float> query = {5.5F};
+  std::vector<uint32_t> ids(1);
+  search_job.search_solo(query.data(), ids.data(), 1, 3);
+  EXPECT_EQ(ids[0], 0U);
+
+  float inserted = 5.0F;
+  auto new_id = space->insert(&inserted);
+  graph->at(1, 0) = new_id;
+  search_job.search_solo(query.data(), ids.data(), 1, 4);
+  EXPECT_EQ(ids[0], new_id);
+}
+
+#if defined(__linux__)
+TEST(GraphSearchJobUnitTest, PooledScratchSurvivesCoroutineBatches) {
+  auto space = make_one_dim_raw_space({10.0F, 20.0F, 30.0F, 0.0F, 1.0F});
+  auto graph = make_graph_from_edges({{3, 1}, {2}, {}, {4}, {}});
+  GraphSearchJob<RawSpaceType> search_job(space, graph);
+  constexpr size_t kInFlight = 16;  // 4 workers x the default interleave depth
+  std::vector<float> query = {0.1F};
+
+  auto run_batch = [&]() {
+    std::vector<std::vector<uint32_t>> ids(kInFlight, std::vector<uint32_t>(2));
+    std::vector<coro::task<>> tasks;
+    tasks.reserve(kInFlight);
+    for (size_t q = 0; q < kInFlight; ++q) {
+      tasks.push_back(search_job.search(query.data(), ids[q].data(), 2, 4));
+    }
+    // Resume round-robin like an interleaving worker, so every query holds a lease at once.
+    bool running = true;
+    while (running) {
+      running = false;
+      for (auto &task : tasks) {
+        if (!task.handle().done()) {
+          task.handle().resume();
+          running = true;
+        }
+      }
+    }
+    for (const auto &result : ids) {
+      EXPECT_EQ(result, (std::vector<uint32_t>{3, 4}));
+    }
+  };
+
+  run_batch();
+  const auto warmed = search_job.query_scratch_pool_->allocations();
+  EXPECT_GE(warmed, kInFlight);
+  run_batch();
+  EXPECT_EQ(search_job.query_scratch_pool_->allocations(), warmed);
+}
+#endif
+
 // ============================================================================
 // Hybrid Search Tests (with metadata filtering)
 // ============================================================================
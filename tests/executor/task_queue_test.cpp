@@ -4,6 +4,8 @@
 
 #include "executor/task_queue.hpp"
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
 #include <thread>
 #include <vector>
 
@@ -49,4 +51,82 @@ TEST(TaskQueueTest, ThreadSafePushPop) {
   }
   EXPECT_EQ(popped.load(), 2 * kN);
 }
+
+namespace {
+auto fake_handle(uintptr_t value) -> std::coroutine_handle<> {
+  return std::coroutine_handle<>::from_address(reinterpret_cast<void *>(value));
+}
+}  // namespace
+
+TEST(WorkStealingDequeTest, OwnerPopsNewestThiefStealsOldest) {
+  alaya::WorkStealingDeque deque;
+  for (uintptr_t i = 1; i <= 4; ++i) {
+    ASSERT_TRUE(deque.push(fake_handle(i)));
+  }
+  EXPECT_EQ(deque.size(), 4);
+  std::coroutine_handle<> h;
+  ASSERT_TRUE(deque.pop(h));
+  EXPECT_EQ(h.address(), fake_handle(4).address());
+  ASSERT_TRUE(deque.steal(h));
+  EXPECT_EQ(h.address(), fake_handle(1).address());
+  ASSERT_TRUE(deque.pop(h));
+  ASSERT_TRUE(deque.pop(h));
+  EXPECT_EQ(h.address(), fake_handle(2).address());
+  EXPECT_FALSE(deque.pop(h));
+  EXPECT_FALSE(deque.steal(h));
+}
+
+TEST(WorkStealingDequeTest, RejectsPushWhenFull) {
+  alaya::WorkStealingDeque deque;
+  for (int64_t i = 0; i < alaya::WorkStealingDeque::kCapacity; ++i) {
+    ASSERT_TRUE(deque.push(fake_handle(i + 1)));
+  }
+  EXPECT_FALSE(deque.push(fake_handle(1)));
+  std::coroutine_handle<> h;
+  ASSERT_TRUE(deque.steal(h));
+  EXPECT_TRUE(deque.push(fake_handle(1)));  // the ring wraps once the top advances
+}
+
+TEST(WorkStealingDequeTest, EveryItemIsTakenExactlyOnce) {
+  alaya::WorkStealingDeque deque;
+  constexpr uintptr_t kN = 20000;
+  std::vector<std::atomic<int>> taken(kN + 1);
+  std::atomic<uintptr_t> total{0};
+  std::atomic<bool> producing{true};
+
+  std::vector<std::thread> thieves;
+  for (int t = 0; t < 3; ++t) {
+    thieves.emplace_back([&] {
+      std::coroutine_handle<> h;
+      while (producing.load() || deque.size() > 0) {
+        if (deque.steal(h)) {
+          taken[reinterpret_cast<uintptr_t>(h.address())].fetch_add(1);
+          total.fetch_add(1);
+        }
+      }
+    });
+  }
+  // The owner interleaves pushes with pops, so it races the thieves for the last entries.
+  std::coroutine_handle<> h;
+  for (uintptr_t i = 1; i <= kN; ++i) {
+    while (!deque.push(fake_handle(i))) {
+    }
+    if (i % 3 == 0 && deque.pop(h)) {
+      taken[reinterpret_cast<uintptr_t>(h.address())].fetch_add(1);
+      total.fetch_add(1);
+    }
+  }
+  producing.store(false);
+  for (auto &t : thieves) {
+    t.join();
+  }
+  while (deque.pop(h)) {
+    taken[reinterpret_cast<uintptr_t>(h.address())].fetch_add(1);
+    total.fetch_add(1);
+  }
+  EXPECT_EQ(total.load(), kN);
+  for (uintptr_t i = 1; i <= kN; ++i) {
+    ASSERT_EQ(taken[i].load(), 1) << "item " << i;
+  }
+}
 }  // namespace alaya
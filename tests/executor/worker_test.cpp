@@ -13,17 +13,12 @@ namespace alaya {
 class WorkerTest : public ::testing::Test {
  protected:
   void SetUp() override {
-    total_tasks_ = std::make_shared<std::atomic<size_t>>(0);
-    finished_tasks_ = std::make_shared<std::atomic<size_t>>(0);
-    task_queue_ = std::make_shared<TaskQueue>();
+    group_ = std::make_shared<WorkerGroup>();
 
-    worker_ = std::make_shared<Worker>(1, 0, task_queue_.get(), total_tasks_.get(),
-                                       finished_tasks_.get());
+    worker_ = std::make_shared<Worker>(1, 0, group_.get());
   }
 
-  std::shared_ptr<TaskQueue> task_queue_;
-  std::shared_ptr<std::atomic<size_t>> total_tasks_;
-  std::shared_ptr<std::atomic<size_t>> finished_tasks_;
+  std::shared_ptr<WorkerGroup> group_;
   std::shared_ptr<Worker> worker_;
 
   auto create_mock_task(std::atomic<int> &counter) {
@@ -39,6 +34,7 @@ class WorkerTest : public ::testing::Test {
 TEST_F(WorkerTest, Initialization) {
   EXPECT_EQ(worker_->id(), 1);
   EXPECT_EQ(worker_->cpu_id(), 0);
+  EXPECT_EQ(Worker::current(), nullptr);  // the test thread is not a worker thread
 }
 
 }  // namespace alaya
@@ -4,13 +4,18 @@
 
 #include <fmt/core.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <random>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "executor/jobs/graph_search_job.hpp"
@@ -146,4 +151,202 @@ TEST_F(RaBitQSiftSmallTest, InvalidParameterTest) {
   EXPECT_THROW(search_job->rabitq_search_solo(query, topk, results.data(), ef),
                std::invalid_argument);
 }
+
+class RaBitQDynamicUpdateTest : public ::testing::Test {
+ protected:
+  static constexpr uint32_t kDim = 64;
+  static constexpr uint32_t kBuildNum = 600;
+  static constexpr uint32_t kInsertNum = 200;
+
+  void SetUp() override {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+    data_.resize((kBuildNum + kInsertNum) * kDim);
+    for (auto &v : data_) {
+      v = dist(rng);
+    }
+    space_ = std::make_shared<RaBitQSpace<>>(kBuildNum + kInsertNum, kDim, MetricType::L2);
+    space_->fit(data_.data(), kBuildNum);
+    QGBuilder<RaBitQSpace<>>(space_, 1).build_graph();
+  }
+
+  void TearDown() override { std::filesystem::remove(file_name_); }
+
+  auto top1(const std::shared_ptr<RaBitQSpace<>> &space, IDType query_id) -> IDType {
+    GraphSearchJob<RaBitQSpace<>> search_job(space, nullptr);
+    std::vector<IDType> results(1);
+    search_job.rabitq_search_solo(data_.data() + query_id * kDim, 1, results.data(), 64);
+    return results[0];
+  }
+
+  std::vector<float> data_;
+  std::shared_ptr<RaBitQSpace<>> space_;
+  std::string file_name_ = "test_rabitq_dynamic_update.qg";
+};
+
+TEST_F(RaBitQDynamicUpdateTest, InsertedNodesAreLinkedAndSearchable) {
+  for (uint32_t i = kBuildNum; i < kBuildNum + kInsertNum; ++i) {
+    ASSERT_EQ(space_->insert(data_.data() + i * kDim), i);
+  }
+  EXPECT_EQ(space_->get_data_num(), kBuildNum + kInsertNum);
+  EXPECT_THROW(space_->insert(data_.data()), std::runtime_error);  // full
+
+  uint32_t found = 0;
+  uint32_t in_degree = 0;
+  for (uint32_t i = kBuildNum; i < kBuildNum + kInsertNum; ++i) {
+    found += top1(space_, i) == i ? 1 : 0;
+  }
+  for (uint32_t u = 0; u < kBuildNum; ++u) {
+    const auto *edges = space_->get_edges(u);
+    for (size_t j = 0; j < RaBitQSpace<>::kDegreeBound; ++j) {
+      in_degree += edges[j] >= kBuildNum ? 1 : 0;
+    }
+  }
+  EXPECT_GE(found, kInsertNum * 95 / 100);
+  EXPECT_GT(in_degree, 0U);  // reverse edges point back at the new nodes
+}
+
+TEST_F(RaBitQDynamicUpdateTest, SearchesUnderReadGuardRunAlongsideInserts) {
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> bad{0};
+  std::vector<std::thread> searchers;
+  for (uint32_t t = 0; t < 4; ++t) {
+    searchers.emplace_back([&, t] {
+      GraphSearchJob<RaBitQSpace<>> search_job(space_, nullptr);
+      std::vector<IDType> results(10);
+      for (uint32_t q = t; !done.load(); q = (q + 4) % kBuildNum) {
+        auto guard = space_->read_guard();
+        search_job.rabitq_search_solo(data_.data() + q * kDim, 10, results.data(), 64);
+        for (auto id : results) {
+          bad += id >= space_->get_data_num() ? 1 : 0;
+        }
+      }
+    });
+  }
+  for (uint32_t i = kBuildNum; i < kBuildNum + kInsertNum; ++i) {
+    EXPECT_EQ(space_->insert(data_.data() + i * kDim), i);
+  }
+  done = true;
+  for (auto &searcher : searchers) {
+    searcher.join();
+  }
+  EXPECT_EQ(bad.load(), 0U);
+  EXPECT_EQ(space_->get_data_num(), kBuildNum + kInsertNum);
+}
+
+TEST_F(RaBitQDynamicUpdateTest, RemovedNodesAreSkippedAndPersist) {
+  for (uint32_t i = kBuildNum; i < kBuildNum + kInsertNum; ++i) {
+    space_->insert(data_.data() + i * kDim);
+  }
+  for (uint32_t i = 0; i < kBuildNum + kInsertNum; i += 3) {
+    ASSERT_EQ(space_->remove(i), i);
+  }
+  EXPECT_EQ(space_->remove(0), static_cast<IDType>(-1));
+  EXPECT_EQ(space_->remove(kBuildNum + kInsertNum), static_cast<IDType>(-1));
+
+  space_->save(file_name_);
+  auto loaded = std::make_shared<RaBitQSpace<>>();
+  loaded->load(file_name_);
+  EXPECT_EQ(loaded->get_avl_data_num(), space_->get_avl_data_num());
+
+  GraphSearchJob<RaBitQSpace<>> search_job(loaded, nullptr);
+  std::vector<IDType> results(10);
+  for (uint32_t q = 0; q < kBuildNum + kInsertNum; q += 7) {
+    EXPECT_TRUE(loaded->is_deleted(q) == (q % 3 == 0));
+    search_job.rabitq_search_solo(data_.data() + q * kDim, 10, results.data(), 64);
+    for (auto id : results) {
+      EXPECT_NE(id % 3, 0U) << "query " << q << " returned deleted node " << id;
+    }
+    if (q % 3 != 0) {
+      EXPECT_EQ(results[0], q);
+    }
+  }
+}
+
+class RaBitQExtendedCodeTest : public ::testing::Test {
+ protected:
+  static constexpr uint32_t kDim = 96;
+  static constexpr uint32_t kNum = 1000;
+  static constexpr uint32_t kTopk = 10;
+
+  void SetUp() override {
+    std::mt19937 rng(11);
+    std::normal_distribution<float> dist(0.0F, 1.0F);
+    data_.resize(kNum * kDim);
+    for (auto &v : data_) {
+      v = dist(rng);
+    }
+  }
+
+  void TearDown() override { std::filesystem::remove(file_name_); }
+
+  auto build(uint32_t bits, MetricType metric) -> std::shared_ptr<RaBitQSpace<>> {
+    auto space = std::make_shared<RaBitQSpace<>>(kNum,
+                                                 kDim,
+                                                 metric,
+                                                 RocksDBConfig::default_config(),
+                                                 RotatorType::FhtKacRotator,
+                                                 bits);
+    space->fit(data_.data(), kNum);
+    QGBuilder<RaBitQSpace<>>(space, 1).build_graph();
+    return space;
+  }
+
+  // recall@kTopk of self-queries against a brute-force scan
+  auto recall(const std::shared_ptr<RaBitQSpace<>> &space) -> float {
+    GraphSearchJob<RaBitQSpace<>> search_job(space, nullptr);
+    std::vector<IDType> results(kTopk);
+    uint32_t hits = 0;
+    uint32_t total = 0;
+    for (uint32_t q = 0; q < kNum; q += 20) {
+      const float *query = data_.data() + q * kDim;
+      std::vector<std::pair<float, IDType>> exact(kNum);
+      for (IDType i = 0; i < kNum; ++i) {
+        exact[i] = {space->get_dist_func()(query, data_.data() + i * kDim, kDim), i};
+      }
+      std::partial_sort(exact.begin(), exact.begin() + kTopk, exact.end());
+      search_job.rabitq_search_solo(query, kTopk, results.data(), 100);
+      for (uint32_t j = 0; j < kTopk; ++j) {
+        hits += std::count(results.begin(), results.end(), exact[j].second);
+      }
+      total += kTopk;
+    }
+    return static_cast<float>(hits) / static_cast<float>(total);
+  }
+
+  std::vector<float> data_;
+  std::string file_name_ = "test_rabitq_ext_code.qg";
+};
+
+TEST_F(RaBitQExtendedCodeTest, MultiBitCodesKeepRecall) {
+  // results are ranked by the codes alone, so recall grows with the code width
+  for (auto metric : {MetricType::L2, MetricType::IP}) {
+    auto space = build(4, metric);
+    EXPECT_EQ(space->get_bits(), 4U);
+    EXPECT_GE(recall(space), 0.85F) << "metric " << static_cast<int>(metric);
+  }
+  EXPECT_GE(recall(build(8, MetricType::L2)), 0.95F);
+}
+
+TEST_F(RaBitQExtendedCodeTest, SaveLoadKeepsCodeWidth) {
+  auto space = build(6, MetricType::L2);
+  space->save(file_name_);
+  auto loaded = std::make_shared<RaBitQSpace<>>();
+  loaded->load(file_name_);
+  EXPECT_EQ(loaded->get_bits(), 6U);
+
+  GraphSearchJob<RaBitQSpace<>> before(space, nullptr);
+  GraphSearchJob<RaBitQSpace<>> after(loaded, nullptr);
+  std::vector<IDType> expected(kTopk);
+  std::vector<IDType> actual(kTopk);
+  for (uint32_t q = 0; q < kNum; q += 50) {
+    before.rabitq_search_solo(data_.data() + q * kDim, kTopk, expected.data(), 64);
+    after.rabitq_search_solo(data_.data() + q * kDim, kTopk, actual.data(), 64);
+    EXPECT_EQ(actual, expected) << "query " << q;
+    EXPECT_EQ(actual[0], q);
+  }
+  for (uint32_t i = 0; i < kDim; ++i) {
+    EXPECT_EQ(loaded->get_data_by_id(7)[i], data_[7 * kDim + i]);
+  }
+}
 }  // namespace alaya
@@ -0,0 +1,213 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "index/graph/laser/utils/aligned_file_reader_factory.hpp"
+#include "index/graph/laser/utils/memory.hpp"
+
+#ifdef ALAYA_OS_LINUX
+
+namespace {
+
+constexpr size_t kPageSize = 4096;
+
+class UringFileReaderTest : public ::testing::Test {
+ protected:
+  std::filesystem::path root_;
+  std::filesystem::path file_path_;
+  std::vector<char> file_bytes_;
+  std::vector<char *> buffers_;
+
+  void SetUp() override {
+    if (!UringFileReader::is_available()) {
+      GTEST_SKIP() << "io_uring unavailable";
+    }
+    // O_DIRECT is refused by tmpfs, so stay on the build directory's filesystem.
+    root_ = std::filesystem::current_path() /
+            ("alaya_uring_file_reader_" + std::to_string(::getpid()));
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_);
+    file_path_ = write_file("aligned.bin", 8, 17U);
+    file_bytes_ = bytes_of(8, 17U);
+  }
+
+  void TearDown() override {
+    for (char *buf : buffers_) {
+      alaya::laser::memory::align_free(buf);
+    }
+    std::filesystem::remove_all(root_);
+  }
+
+  static std::vector<char> bytes_of(size_t pages, uint32_t salt) {
+    std::vector<char> bytes(pages * kPageSize);
+    for (size_t i = 0; i < bytes.size(); ++i) {
+      bytes[i] = static_cast<char>((i * salt + 3U) & 0x7F);
+    }
+    return bytes;
+  }
+
+  std::filesystem::path write_file(const std::string &name, size_t pages, uint32_t salt) {
+    auto path = root_ / name;
+    auto bytes = bytes_of(pages, salt);
+    std::ofstream out(path, std::ios::binary);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    return path;
+  }
+
+  char *aligned_buffer(size_t bytes) {
+    buffers_.push_back(
+        reinterpret_cast<char *>(alaya::laser::memory::align_allocate<kPageSize>(bytes)));
+    return buffers_.back();
+  }
+};
+
+TEST_F(UringFileReaderTest, BlockingReadMatchesFileAndCountsSyscalls) {
+  UringFileReader reader;
+  reader.open(file_path_.string());
+  reader.register_thread();
+  EXPECT_GE(reader.get_fd(), 0);
+
+  char *buf = aligned_buffer(3 * kPageSize);
+  std::vector<AlignedRead> reads;
+  for (uint64_t i = 0; i < 3; ++i) {
+    reads.emplace_back((2 * i + 1) * kPageSize, kPageSize, i, buf + i * kPageSize);
+  }
+  reader.read(reads, reader.get_ctx());
+  for (uint64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(std::memcmp(buf + i * kPageSize, file_bytes_.data() + (2 * i + 1) * kPageSize,
+                          kPageSize),
+              0);
+  }
+  EXPECT_GE(reader.io_syscalls(), 1U);  // at least the submit
+  reader.deregister_thread();
+}
+
+TEST_F(UringFileReaderTest, FixedAndPlainBuffersReturnEveryId) {
+  UringFileReader reader;
+  reader.open(file_path_.string());
+  reader.register_thread();
+  IOContext &ctx = reader.get_ctx();
+
+  char *fixed = aligned_buffer(4 * kPageSize);
+  char *plain = aligned_buffer(4 * kPageSize);
+  ASSERT_TRUE(reader.register_buffer(ctx, fixed, 4 * kPageSize));
+  std::vector<AlignedRead> reads;
+  for (uint64_t i = 0; i < 8; ++i) {
+    char *dst = (i % 2 == 0 ? fixed : plain) + (i / 2) * kPageSize;
+    reads.emplace_back(i * kPageSize, kPageSize, 100 + i, dst);
+  }
+  ASSERT_EQ(reader.submit_reqs(reads, ctx), 8);
+  std::vector<AlignedReadEvent> events;
+  ASSERT_EQ(reader.get_events(ctx, 8, events), 8);
+  ASSERT_EQ(events.size(), 8U);
+  std::set<uint64_t> ids;
+  for (const auto &evt : events) {
+    EXPECT_EQ(evt.result, static_cast<int64_t>(kPageSize));
+    ids.insert(evt.id);
+  }
+  EXPECT_EQ(ids.size(), 8U);
+  for (uint64_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(std::memcmp(reads[i].buf, file_bytes_.data() + i * kPageSize, kPageSize), 0)
+        << "page " << i;
+  }
+  reader.deregister_all_threads();
+}
+
+TEST_F(UringFileReaderTest, PollEventsReturnsWithoutBlocking) {
+  UringFileReader reader;
+  reader.open(file_path_.string());
+  reader.register_thread();
+  IOContext &ctx = reader.get_ctx();
+
+  std::vector<AlignedReadEvent> events;
+  EXPECT_EQ(reader.poll_events(ctx, 4, events), 0);
+
+  char *buf = aligned_buffer(2 * kPageSize);
+  std::vector<AlignedRead> reads;
+  reads.emplace_back(0, kPageSize, 7, buf);
+  reads.emplace_back(kPageSize, kPageSize, 8, buf + kPageSize);
+  reader.submit_reqs(reads, ctx);
+  std::set<uint64_t> ids;
+  while (ids.size() < 2) {
+    reader.poll_events(ctx, 4, events);
+    for (const auto &evt : events) {
+      ids.insert(evt.id);
+    }
+  }
+  EXPECT_EQ(ids, (std::set<uint64_t>{7, 8}));
+  reader.deregister_thread();
+}
+
+TEST_F(UringFileReaderTest, ReopenReregistersFileWithLiveContexts) {
+  UringFileReader reader;
+  reader.open(file_path_.string());
+  reader.register_thread();
+  auto other = write_file("other.bin", 2, 29U);
+  reader.open(other.string());
+
+  char *buf = aligned_buffer(kPageSize);
+  std::vector<AlignedRead> reads;
+  reads.emplace_back(kPageSize, kPageSize, 0, buf);
+  reader.read(reads, reader.get_ctx());
+  EXPECT_EQ(std::memcmp(buf, bytes_of(2, 29U).data() + kPageSize, kPageSize), 0);
+  reader.deregister_thread();
+}
+
+TEST_F(UringFileReaderTest, SubmitBeyondQueueDepthThrows) {
+  AlignedReaderOptions options;
+  options.queue_depth = 2;
+  UringFileReader reader(options);
+  reader.open(file_path_.string());
+  reader.register_thread();
+
+  char *buf = aligned_buffer(3 * kPageSize);
+  std::vector<AlignedRead> reads;
+  for (uint64_t i = 0; i < 3; ++i) {
+    reads.emplace_back(i * kPageSize, kPageSize, i, buf + i * kPageSize);
+  }
+  EXPECT_THROW(reader.submit_reqs(reads, reader.get_ctx()), std::runtime_error);
+  reader.read(reads, reader.get_ctx());  // the blocking path chunks to the depth
+  EXPECT_EQ(std::memcmp(buf, file_bytes_.data(), 3 * kPageSize), 0);
+  reader.deregister_thread();
+}
+
+TEST_F(UringFileReaderTest, FactorySelectsUringAtRuntime) {
+  AlignedReaderOptions options;
+  options.backend = AlignedReaderBackend::kUring;
+  options.sqpoll = true;  // falls back to a plain ring where SQPOLL is not permitted
+  auto reader = make_aligned_file_reader(options);
+  ASSERT_NE(dynamic_cast<UringFileReader *>(reader.get()), nullptr);
+  reader->open(file_path_.string());
+  reader->register_thread();
+  char *buf = aligned_buffer(kPageSize);
+  std::vector<AlignedRead> reads;
+  reads.emplace_back(5 * kPageSize, kPageSize, 0, buf);
+  reader->read(reads, reader->get_ctx());
+  EXPECT_EQ(std::memcmp(buf, file_bytes_.data() + 5 * kPageSize, kPageSize), 0);
+  reader->deregister_all_threads();
+  reader->close();
+
+  auto fallback = make_aligned_file_reader(AlignedReaderOptions{});
+  EXPECT_EQ(dynamic_cast<UringFileReader *>(fallback.get()), nullptr);
+}
+
+}  // namespace
+
+#else
+
+TEST(UringFileReaderTest, LinuxOnly) { SUCCEED(); }
+
+#endif  // ALAYA_OS_LINUX
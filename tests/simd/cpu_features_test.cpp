@@ -91,6 +91,7 @@ TEST(CpuFeaturesTest, ParseDistanceDispatchPolicyRecognizesAvx512Override) {
   EXPECT_EQ(parse_distance_dispatch_policy(nullptr),
             DistanceDispatchPolicy::kPreferStableThroughput);
   EXPECT_EQ(parse_distance_dispatch_policy("avx512"), DistanceDispatchPolicy::kPreferAvx512);
+  EXPECT_EQ(parse_distance_dispatch_policy("autotune"), DistanceDispatchPolicy::kAutotune);
   EXPECT_EQ(parse_distance_dispatch_policy("unknown"),
             DistanceDispatchPolicy::kPreferStableThroughput);
 }
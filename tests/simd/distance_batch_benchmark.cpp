@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "simd/distance_batch.hpp"
+
+/**
+  * @brief Benchmark for batched one-to-many distance kernels
+  *
+  * Simulates one graph hop: a query is scored against kNeighbors rows scattered over a
+  * larger pool, once with the single-vector kernel per row and once with the batched kernel.
+  *
+  * Usage: ./distance_batch_benchmark [dim1 dim2 ...]
+  * If no dimensions are provided, defaults to common ANN dataset dimensions.
+  */
+namespace {
+
+constexpr size_t kWarmupIterations = 100;
+constexpr size_t kBenchmarkIterations = 20000;
+constexpr size_t kNeighbors = 32;
+constexpr size_t kPoolRows = 4096;
+
+struct HopResult {
+  double single_ns_ = 0.0;
+  double batch_ns_ = 0.0;
+};
+
+struct DimResults {
+  size_t dim_ = 0;
+  HopResult fp32_;
+  HopResult sq8_;
+  HopResult sq4_;
+};
+
+template <typename Func>
+auto time_hops(Func hop) -> double {
+  for (size_t i = 0; i < kWarmupIterations; ++i) {
+    hop(i);
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < kBenchmarkIterations; ++i) {
+    hop(i);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return static_cast<double>(duration_ns) / static_cast<double>(kBenchmarkIterations);
+}
+
+auto run_benchmarks_for_dim(size_t dim) -> DimResults {
+  using alaya::simd::kDistanceBatchWidth;
+  DimResults results;
+  results.dim_ = dim;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> fdist(-1.0F, 1.0F);
+  std::uniform_int_distribution<int> cdist(0, 255);
+  std::uniform_int_distribution<size_t> rdist(0, kPoolRows - 1);
+
+  std::vector<float> query(dim);
+  std::vector<float> pool(kPoolRows * dim);
+  std::vector<uint8_t> query_codes(dim);
+  std::vector<uint8_t> codes(kPoolRows * dim);
+  std::vector<float> min(dim);
+  std::vector<float> max(dim);
+  std::vector<float> scale(dim);
+  for (auto &x : query) {
+    x = fdist(rng);
+  }
+  for (auto &x : pool) {
+    x = fdist(rng);
+  }
+  for (auto &x : query_codes) {
+    x = static_cast<uint8_t>(cdist(rng));
+  }
+  for (auto &x : codes) {
+    x = static_cast<uint8_t>(cdist(rng));
+  }
+  for (size_t i = 0; i < dim; ++i) {
+    min[i] = -1.0F;
+    max[i] = 1.0F;
+    scale[i] = 2.0F / 255.0F;
+  }
+
+  // Neighbor lists for a window of hops, so the access pattern is not a single cached set
+  constexpr size_t kHopWindow = 64;
+  std::vector<size_t> neighbors(kHopWindow * kNeighbors);
+  for (auto &x : neighbors) {
+    x = rdist(rng);
+  }
+
+  volatile float sink = 0;
+  float out[kNeighbors];
+
+  auto single_fp32 = alaya::simd::get_l2_sqr_func();
+  auto batch_fp32 = alaya::simd::get_l2_sqr_batch4_func();
+  results.fp32_.single_ns_ = time_hops([&](size_t it) {
+    const size_t *ids = neighbors.data() + (it % kHopWindow) * kNeighbors;
+    for (size_t j = 0; j < kNeighbors; ++j) {
+      out[j] = single_fp32(query.data(), pool.data() + ids[j] * dim, dim);
+    }
+    sink = out[0];
+  });
+  results.fp32_.batch_ns_ = time_hops([&](size_t it) {
+    const size_t *ids = neighbors.data() + (it % kHopWindow) * kNeighbors;
+    const float *rows[kDistanceBatchWidth];
+    for (size_t j = 0; j < kNeighbors; j += kDistanceBatchWidth) {
+      for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+        rows[r] = pool.data() + ids[j + r] * dim;
+      }
+      batch_fp32(query.data(), rows, dim, out + j);
+    }
+    sink = out[0];
+  });
+
+  // The batched SQ8 kernel takes the query decoded once per query, which the single
+  // kernel redoes for every row
+  std::vector<float> query_scaled(dim);
+  for (size_t i = 0; i < dim; ++i) {
+    query_scaled[i] = static_cast<float>(query_codes[i]) * scale[i];
+  }
+  auto single_sq8 = alaya::simd::get_l2_sqr_sq8_func();
+  auto batch_sq8 = alaya::simd::get_l2_sqr_sq8_batch4_func();
+  results.sq8_.single_ns_ = time_hops([&](size_t it) {
+    const size_t *ids = neighbors.data() + (it % kHopWindow) * kNeighbors;
+    for (size_t j = 0; j < kNeighbors; ++j) {
+      out[j] = single_sq8(query_codes.data(), codes.data() + ids[j] * dim, dim, min.data(),
+                          max.data());
+    }
+    sink = out[0];
+  });
+  results.sq8_.batch_ns_ = time_hops([&](size_t it) {
+    const size_t *ids = neighbors.data() + (it % kHopWindow) * kNeighbors;
+    const uint8_t *rows[kDistanceBatchWidth];
+    for (size_t j = 0; j < kNeighbors; j += kDistanceBatchWidth) {
+      for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+        rows[r] = codes.data() + ids[j + r] * dim;
+      }
+      batch_sq8(query_scaled.data(), scale.data(), rows, dim, out + j);
+    }
+    sink = out[0];
+  });
+
+  // SQ4 rows reuse the code pool, one packed row every `dim` bytes
+  std::vector<float> query_scaled4(dim);
+  std::vector<float> scale4(dim);
+  for (size_t d = 0; d < dim; ++d) {
+    const size_t p = alaya::simd::sq4_batch_position(d, dim);
+    scale4[p] = 2.0F / 15.0F;
+    const auto code = static_cast<float>((query_codes[d / 2] >> ((d % 2) * 4)) & 0x0F);
+    query_scaled4[p] = code * scale4[p];
+  }
+  auto single_sq4 = alaya::simd::get_l2_sqr_sq4_func();
+  auto batch_sq4 = alaya::simd::get_l2_sqr_sq4_batch4_func();
+  results.sq4_.single_ns_ = time_hops([&](size_t it) {
+    const size_t *ids = neighbors.data() + (it % kHopWindow) * kNeighbors;
+    for (size_t j = 0; j < kNeighbors; ++j) {
+      out[j] = single_sq4(query_codes.data(), codes.data() + ids[j] * dim, dim, min.data(),
+                          max.data());
+    }
+    sink = out[0];
+  });
+  results.sq4_.batch_ns_ = time_hops([&](size_t it) {
+    const size_t *ids = neighbors.data() + (it % kHopWindow) * kNeighbors;
+    const uint8_t *rows[kDistanceBatchWidth];
+    for (size_t j = 0; j < kNeighbors; j += kDistanceBatchWidth) {
+      for (size_t r = 0; r < kDistanceBatchWidth; ++r) {
+        rows[r] = codes.data() + ids[j + r] * dim;
+      }
+      batch_sq4(query_scaled4.data(), scale4.data(), rows, dim, out + j);
+    }
+    sink = out[0];
+  });
+  (void)sink;
+
+  return results;
+}
+
+void print_cell(const HopResult &r) {
+  double speedup = r.single_ns_ / r.batch_ns_;
+  std::cout << ' ' << r.single_ns_ << " ns | ";
+  if (speedup > 1.05) {
+    std::cout << "**" << r.batch_ns_ << " ns (" << speedup << "x)** |";
+  } else {
+    std::cout << r.batch_ns_ << " ns (" << speedup << "x) |";
+  }
+}
+
+void print_comparison_table(const std::vector<DimResults> &all_results) {
+  std::cout << "\n## Batched Distance Per-Hop Comparison (" << kNeighbors << " neighbors)\n\n";
+  std::cout << "| Dimension | FP32 single | FP32 batch | SQ8 single | SQ8 batch "
+               "| SQ4 single | SQ4 batch |\n";
+  std::cout << "|-----------|-------------|------------|------------|-----------"
+               "|------------|-----------|\n";
+
+  for (const auto &r : all_results) {
+    std::cout << std::fixed << std::setprecision(2) << "| " << r.dim_ << " |";
+    print_cell(r.fp32_);
+    print_cell(r.sq8_);
+    print_cell(r.sq4_);
+    std::cout << '\n';
+  }
+
+  std::cout << "\n## Summary\n\n";
+  std::cout << "- Times are per hop, single = get_*_func() per row, batch = get_*_batch4_func()\n";
+  std::cout << "- **Bold** indicates >5% speedup of the batched kernel\n";
+  std::cout << "- SIMD Level: " << alaya::simd::get_simd_level_name() << '\n';
+  std::cout << "- Hops per test: " << kBenchmarkIterations << '\n';
+}
+
+}  // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::cout << "# Batched One-to-Many Distance Benchmark\n\n";
+
+  // Default: ANN mainstream dataset dimensions
+  std::vector<size_t> dims = {96, 128, 256, 384, 768, 960};
+
+  // Allow custom dimensions from command line
+  if (argc > 1) {
+    dims.clear();
+    for (int i = 1; i < argc; ++i) {
+      dims.push_back(std::stoull(argv[i]));
+    }
+  }
+
+  std::vector<DimResults> all_results;
+  for (size_t dim : dims) {
+    std::cout << "Benchmarking dim=" << dim << "..." << std::flush;
+    all_results.push_back(run_benchmarks_for_dim(dim));
+    std::cout << " done\n";
+  }
+
+  print_comparison_table(all_results);
+
+  return 0;
+}
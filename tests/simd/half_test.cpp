@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "simd/distance_ip.hpp"
+#include "simd/distance_l2.hpp"
+#include "utils/half.hpp"
+
+// ============================================================================
+// FP16 / BF16 Distance Tests
+// ============================================================================
+
+using alaya::bf16;
+using alaya::fp16;
+
+class HalfDistanceTest : public ::testing::Test {
+ protected:
+  template <typename HalfType>
+  static auto make_random(size_t n, unsigned seed) -> std::vector<HalfType> {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+    std::vector<HalfType> v(n);
+    for (auto &x : v) {
+      x = HalfType(dist(rng));
+    }
+    return v;
+  }
+
+  static auto tol(float ref) -> float { return 1e-5F * std::max(100.0F, std::abs(ref)); }
+
+  // float reference on the widened values
+  template <typename HalfType>
+  static auto ref_l2(const std::vector<HalfType> &x, const std::vector<HalfType> &y) -> float {
+    double sum = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+      double diff = static_cast<float>(x[i]) - static_cast<float>(y[i]);
+      sum += diff * diff;
+    }
+    return static_cast<float>(sum);
+  }
+
+  template <typename HalfType>
+  static auto ref_ip(const std::vector<HalfType> &x, const std::vector<HalfType> &y) -> float {
+    double sum = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+      sum += static_cast<double>(static_cast<float>(x[i])) * static_cast<float>(y[i]);
+    }
+    return static_cast<float>(-sum);
+  }
+};
+
+TEST_F(HalfDistanceTest, Fp16ConversionRoundTrip) {
+  EXPECT_EQ(static_cast<float>(fp16(1.0F)), 1.0F);
+  EXPECT_EQ(static_cast<float>(fp16(-2.5F)), -2.5F);
+  EXPECT_EQ(static_cast<float>(fp16(65504.0F)), 65504.0F);
+  EXPECT_TRUE(std::isinf(static_cast<float>(fp16(1e6F))));
+  EXPECT_TRUE(std::isnan(static_cast<float>(fp16(std::numeric_limits<float>::quiet_NaN()))));
+  // smallest subnormal and round-to-nearest-even at its midpoint
+  EXPECT_EQ(static_cast<float>(fp16(std::ldexp(1.0F, -24))), std::ldexp(1.0F, -24));
+  EXPECT_EQ(fp16(std::ldexp(1.0F, -25)).bits_, 0U);
+  EXPECT_EQ(fp16(1.0F + std::ldexp(1.0F, -11)).bits_, fp16(1.0F).bits_);
+  EXPECT_EQ(fp16(1.0F + std::ldexp(3.0F, -11)).bits_, fp16(1.0F).bits_ + 2);
+}
+
+TEST_F(HalfDistanceTest, Bf16ConversionRoundTrip) {
+  EXPECT_EQ(static_cast<float>(bf16(1.0F)), 1.0F);
+  EXPECT_EQ(static_cast<float>(bf16(-3.0F)), -3.0F);
+  EXPECT_EQ(bf16(1.0F + std::ldexp(1.0F, -8)).bits_, bf16(1.0F).bits_);
+  EXPECT_EQ(bf16(1.0F + std::ldexp(3.0F, -8)).bits_, bf16(1.0F).bits_ + 2);
+  EXPECT_TRUE(std::isnan(static_cast<float>(bf16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST_F(HalfDistanceTest, Fp16KernelsMatchReference) {
+  for (size_t dim : {1, 7, 8, 15, 16, 17, 31, 33, 64, 100, 1024}) {
+    auto x = make_random<fp16>(dim, dim);
+    auto y = make_random<fp16>(dim, dim + 100);
+    float l2 = ref_l2(x, y);
+    float ip = ref_ip(x, y);
+    EXPECT_NEAR(alaya::simd::l2_sqr_fp16_generic(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+    EXPECT_NEAR(alaya::simd::l2_sqr(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+    EXPECT_NEAR(alaya::simd::ip_sqr_fp16_generic(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+    EXPECT_NEAR(alaya::simd::ip_sqr(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+#ifdef ALAYA_ARCH_X86
+    const auto &f = alaya::simd::get_cpu_features();
+    if (f.avx2_ && f.fma_ && f.f16c_) {
+      EXPECT_NEAR(alaya::simd::l2_sqr_fp16_avx2(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+      EXPECT_NEAR(alaya::simd::ip_sqr_fp16_avx2(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+    }
+    if (f.avx512f_) {
+      EXPECT_NEAR(alaya::simd::l2_sqr_fp16_avx512(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+      EXPECT_NEAR(alaya::simd::ip_sqr_fp16_avx512(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+    }
+#endif
+  }
+}
+
+TEST_F(HalfDistanceTest, Bf16KernelsMatchReference) {
+  for (size_t dim : {1, 7, 8, 15, 16, 17, 31, 33, 63, 64, 65, 100, 1024}) {
+    auto x = make_random<bf16>(dim, dim);
+    auto y = make_random<bf16>(dim, dim + 100);
+    float l2 = ref_l2(x, y);
+    float ip = ref_ip(x, y);
+    EXPECT_NEAR(alaya::simd::l2_sqr_bf16_generic(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+    EXPECT_NEAR(alaya::simd::l2_sqr(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+    EXPECT_NEAR(alaya::simd::ip_sqr_bf16_generic(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+    EXPECT_NEAR(alaya::simd::ip_sqr(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+#ifdef ALAYA_ARCH_X86
+    const auto &f = alaya::simd::get_cpu_features();
+    if (f.avx2_ && f.fma_) {
+      EXPECT_NEAR(alaya::simd::l2_sqr_bf16_avx2(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+      EXPECT_NEAR(alaya::simd::ip_sqr_bf16_avx2(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+    }
+    if (f.avx512f_) {
+      EXPECT_NEAR(alaya::simd::l2_sqr_bf16_avx512(x.data(), y.data(), dim), l2, tol(l2)) << dim;
+    }
+    if (f.avx512bf16_) {
+      EXPECT_NEAR(alaya::simd::ip_sqr_bf16_avx512(x.data(), y.data(), dim), ip, tol(ip)) << dim;
+    }
+#endif
+  }
+}
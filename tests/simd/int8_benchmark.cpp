@@ -0,0 +1,222 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+/**
+ * INT8 / VNNI Distance Benchmark
+ *
+ * Compares the int8 L2 / IP kernels across SIMD levels, and the SQ8 query-side
+ * integer kernels (VNNI) against the FP32-decoding SQ8 kernels they replace.
+ *
+ * Usage: ./int8_benchmark [dim1 dim2 ...]
+ * Default dimensions: 96, 128, 256, 384, 768, 960
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "simd/distance_ip.hpp"
+#include "simd/distance_l2.hpp"
+
+namespace {
+
+constexpr size_t kWarmupIterations = 1000;
+constexpr size_t kBenchmarkIterations = 100000;
+
+template <typename Func>
+auto time_calls(Func call) -> double {
+  volatile double sink = 0;
+  for (size_t i = 0; i < kWarmupIterations; ++i) {
+    sink = call();
+  }
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < kBenchmarkIterations; ++i) {
+    sink = call();
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  (void)sink;
+  auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return static_cast<double>(duration_ns) / static_cast<double>(kBenchmarkIterations);
+}
+
+// Time of each level, 0 when the CPU lacks it
+struct LevelResults {
+  double generic_ = 0.0;
+  double avx2_ = 0.0;
+  double avx_vnni_ = 0.0;
+  double avx512_vnni_ = 0.0;
+};
+
+struct DimResults {
+  size_t dim_ = 0;
+  LevelResults l2_int8_;
+  LevelResults ip_int8_;
+  double sq8_l2_float_ = 0.0;
+  double sq8_l2_int_ = 0.0;
+  double sq8_ip_float_ = 0.0;
+  double sq8_ip_int_ = 0.0;
+};
+
+template <typename Func>
+auto time_levels(Func generic, Func avx2, Func avx_vnni, Func avx512_vnni, const int8_t *x,
+                 const int8_t *y, size_t dim) -> LevelResults {
+  LevelResults r;
+  r.generic_ = time_calls([&] { return generic(x, y, dim); });
+#ifdef ALAYA_ARCH_X86
+  const auto &f = alaya::simd::get_cpu_features();
+  if (f.avx2_) {
+    r.avx2_ = time_calls([&] { return avx2(x, y, dim); });
+  }
+  if (f.avxvnni_) {
+    r.avx_vnni_ = time_calls([&] { return avx_vnni(x, y, dim); });
+  }
+  if (f.avx512vnni_ && f.avx512bw_) {
+    r.avx512_vnni_ = time_calls([&] { return avx512_vnni(x, y, dim); });
+  }
+#else
+  (void)avx2;
+  (void)avx_vnni;
+  (void)avx512_vnni;
+#endif
+  return r;
+}
+
+auto run_benchmarks_for_dim(size_t dim) -> DimResults {
+  using namespace alaya::simd;  // NOLINT
+  DimResults results;
+  results.dim_ = dim;
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> sdist(-128, 127);
+  std::uniform_int_distribution<int> udist(0, 255);
+  std::uniform_real_distribution<float> fdist(-10.0F, 10.0F);
+
+  std::vector<int8_t> x(dim);
+  std::vector<int8_t> y(dim);
+  std::vector<uint8_t> qcode(dim);
+  std::vector<uint8_t> code(dim);
+  std::vector<float> min(dim);
+  std::vector<float> max(dim);
+  for (size_t i = 0; i < dim; ++i) {
+    x[i] = static_cast<int8_t>(sdist(rng));
+    y[i] = static_cast<int8_t>(sdist(rng));
+    qcode[i] = static_cast<uint8_t>(udist(rng));
+    code[i] = static_cast<uint8_t>(udist(rng));
+    float a = fdist(rng);
+    float b = fdist(rng);
+    min[i] = std::min(a, b);
+    max[i] = std::max(a, b) + 0.1F;
+  }
+
+#ifdef ALAYA_ARCH_X86
+  results.l2_int8_ = time_levels(l2_sqr_int8_generic, l2_sqr_int8_avx2, l2_sqr_int8_avx_vnni,
+                                 l2_sqr_int8_avx512_vnni, x.data(), y.data(), dim);
+  results.ip_int8_ = time_levels(ip_sqr_int8_generic, ip_sqr_int8_avx2, ip_sqr_int8_avx_vnni,
+                                 ip_sqr_int8_avx512_vnni, x.data(), y.data(), dim);
+#else
+  results.l2_int8_ = time_levels(l2_sqr_int8_generic, l2_sqr_int8_generic, l2_sqr_int8_generic,
+                                 l2_sqr_int8_generic, x.data(), y.data(), dim);
+  results.ip_int8_ = time_levels(ip_sqr_int8_generic, ip_sqr_int8_generic, ip_sqr_int8_generic,
+                                 ip_sqr_int8_generic, x.data(), y.data(), dim);
+#endif
+
+  // SQ8 query side: the integer weights are built once per query, outside the timing
+  std::vector<int16_t> l2_weight(dim);
+  std::vector<int8_t> ip_weight(dim);
+  for (size_t i = 0; i < dim; ++i) {
+    l2_weight[i] = static_cast<int16_t>(udist(rng) % (kSq8L2WeightMax + 1));
+    ip_weight[i] = static_cast<int8_t>(sdist(rng));
+  }
+  auto l2_float = get_l2_sqr_sq8_func();
+  auto l2_int = get_l2_sqr_sq8_weighted_func();
+  auto ip_float = get_ip_sqr_sq8_func();
+  auto dot_int = get_dot_sq8_int8_func();
+  results.sq8_l2_float_ = time_calls(
+      [&] { return l2_float(qcode.data(), code.data(), dim, min.data(), max.data()); });
+  results.sq8_l2_int_ =
+      time_calls([&] { return l2_int(qcode.data(), code.data(), l2_weight.data(), dim); });
+  results.sq8_ip_float_ = time_calls(
+      [&] { return ip_float(qcode.data(), code.data(), dim, min.data(), max.data()); });
+  results.sq8_ip_int_ = time_calls([&] { return dot_int(code.data(), ip_weight.data(), dim); });
+
+  return results;
+}
+
+void print_level(double ns, double baseline) {
+  if (ns == 0.0) {
+    std::cout << " N/A |";
+    return;
+  }
+  double speedup = baseline / ns;
+  if (speedup > 1.05) {
+    std::cout << " **" << ns << " ns (" << speedup << "x)** |";
+  } else {
+    std::cout << ' ' << ns << " ns (" << speedup << "x) |";
+  }
+}
+
+void print_level_table(const std::vector<DimResults> &all_results, const char *title,
+                       LevelResults DimResults::*member) {
+  std::cout << "\n## " << title << "\n\n";
+  std::cout << "| Dimension | Generic (baseline) | AVX2 | AVX-VNNI | AVX-512 VNNI |\n";
+  std::cout << "|-----------|--------------------|------|----------|--------------|\n";
+  for (const auto &r : all_results) {
+    const auto &l = r.*member;
+    std::cout << std::fixed << std::setprecision(2) << "| " << r.dim_ << " |";
+    print_level(l.generic_, l.generic_);
+    print_level(l.avx2_, l.generic_);
+    print_level(l.avx_vnni_, l.generic_);
+    print_level(l.avx512_vnni_, l.generic_);
+    std::cout << '\n';
+  }
+}
+
+void print_sq8_table(const std::vector<DimResults> &all_results) {
+  std::cout << "\n## SQ8 Query Kernels (FP32 decode vs. integer)\n\n";
+  std::cout << "| Dimension | L2 FP32 | L2 integer | IP FP32 | IP integer |\n";
+  std::cout << "|-----------|---------|------------|---------|------------|\n";
+  for (const auto &r : all_results) {
+    std::cout << std::fixed << std::setprecision(2) << "| " << r.dim_ << " | " << r.sq8_l2_float_
+              << " ns |";
+    print_level(r.sq8_l2_int_, r.sq8_l2_float_);
+    std::cout << ' ' << r.sq8_ip_float_ << " ns |";
+    print_level(r.sq8_ip_int_, r.sq8_ip_float_);
+    std::cout << '\n';
+  }
+}
+
+}  // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::cout << "# INT8 / VNNI Distance Benchmark\n\n";
+
+  std::vector<size_t> dims = {96, 128, 256, 384, 768, 960};
+  if (argc > 1) {
+    dims.clear();
+    for (int i = 1; i < argc; ++i) {
+      dims.push_back(std::stoull(argv[i]));
+    }
+  }
+
+  std::vector<DimResults> all_results;
+  for (size_t dim : dims) {
+    std::cout << "Benchmarking dim=" << dim << "..." << std::flush;
+    all_results.push_back(run_benchmarks_for_dim(dim));
+    std::cout << " done\n";
+  }
+
+  print_level_table(all_results, "INT8 L2 Distance", &DimResults::l2_int8_);
+  print_level_table(all_results, "INT8 IP Distance", &DimResults::ip_int8_);
+  print_sq8_table(all_results);
+
+  std::cout << "\n## Summary\n\n";
+  std::cout << "- SQ8 integer = get_l2_sqr_sq8_weighted_func() / get_dot_sq8_int8_func()\n";
+  std::cout << "- **Bold** indicates >5% speedup over the baseline column\n";
+  std::cout << "- SIMD Level: " << alaya::simd::get_simd_level_name() << '\n';
+  std::cout << "- Iterations: " << kBenchmarkIterations << '\n';
+  return 0;
+}
@@ -0,0 +1,189 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "simd/distance_ip.hpp"
+#include "simd/distance_l2.hpp"
+
+// ============================================================================
+// INT8 / UINT8 and VNNI Distance Tests
+// ============================================================================
+
+namespace alaya::simd {
+namespace {
+
+const std::vector<size_t> kDims = {1, 7, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 128, 769, 2100};
+
+template <typename T>
+auto make_random(size_t n, std::mt19937 &rng) -> std::vector<T> {
+  std::uniform_int_distribution<int> dist(std::numeric_limits<T>::min(),
+                                          std::numeric_limits<T>::max());
+  std::vector<T> v(n);
+  for (auto &x : v) {
+    x = static_cast<T>(dist(rng));
+  }
+  return v;
+}
+
+// Every kernel variant the CPU can run, keyed by name
+template <typename Func>
+auto variants(Func generic, Func avx2, Func avx_vnni, Func avx512_vnni)
+    -> std::vector<std::pair<const char *, Func>> {
+  std::vector<std::pair<const char *, Func>> out = {{"generic", generic}};
+#ifdef ALAYA_ARCH_X86
+  const auto &f = get_cpu_features();
+  if (f.avx2_ && avx2 != nullptr) {
+    out.emplace_back("avx2", avx2);
+  }
+  if (f.avxvnni_) {
+    out.emplace_back("avx_vnni", avx_vnni);
+  }
+  if (f.avx512vnni_ && f.avx512bw_) {
+    out.emplace_back("avx512_vnni", avx512_vnni);
+  }
+#else
+  (void)avx2;
+  (void)avx_vnni;
+  (void)avx512_vnni;
+#endif
+  return out;
+}
+
+#ifdef ALAYA_ARCH_X86
+  #define ALAYA_INT8_VARIANTS(name) \
+    variants(name##_generic, name##_avx2, name##_avx_vnni, name##_avx512_vnni)
+  #define ALAYA_INT8_VNNI_VARIANTS(name) \
+    variants<decltype(&name##_generic)>( \
+        name##_generic, nullptr, name##_avx_vnni, name##_avx512_vnni)
+#else
+  #define ALAYA_INT8_VARIANTS(name) \
+    variants(name##_generic, name##_generic, name##_generic, name##_generic)
+  #define ALAYA_INT8_VNNI_VARIANTS(name) \
+    variants(name##_generic, name##_generic, name##_generic, name##_generic)
+#endif
+
+template <typename T>
+auto ref_l2(const std::vector<T> &x, const std::vector<T> &y) -> int64_t {
+  int64_t sum = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    int64_t diff = static_cast<int64_t>(x[i]) - static_cast<int64_t>(y[i]);
+    sum += diff * diff;
+  }
+  return sum;
+}
+
+template <typename T>
+auto ref_ip(const std::vector<T> &x, const std::vector<T> &y) -> int64_t {
+  int64_t sum = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    sum += static_cast<int64_t>(x[i]) * static_cast<int64_t>(y[i]);
+  }
+  return -sum;
+}
+
+TEST(Int8DistanceTest, Int8KernelsAreExact) {
+  std::mt19937 rng(42);
+  for (size_t dim : kDims) {
+    auto x = make_random<int8_t>(dim, rng);
+    auto y = make_random<int8_t>(dim, rng);
+    for (const auto &[name, func] : ALAYA_INT8_VARIANTS(l2_sqr_int8)) {
+      EXPECT_EQ(func(x.data(), y.data(), dim), ref_l2(x, y)) << name << " dim=" << dim;
+    }
+    for (const auto &[name, func] : ALAYA_INT8_VARIANTS(ip_sqr_int8)) {
+      EXPECT_EQ(func(x.data(), y.data(), dim), ref_ip(x, y)) << name << " dim=" << dim;
+    }
+  }
+}
+
+TEST(Int8DistanceTest, Uint8KernelsAreExact) {
+  std::mt19937 rng(7);
+  for (size_t dim : kDims) {
+    auto x = make_random<uint8_t>(dim, rng);
+    auto y = make_random<uint8_t>(dim, rng);
+    for (const auto &[name, func] : ALAYA_INT8_VARIANTS(l2_sqr_uint8)) {
+      EXPECT_EQ(func(x.data(), y.data(), dim), ref_l2(x, y)) << name << " dim=" << dim;
+    }
+    for (const auto &[name, func] : ALAYA_INT8_VARIANTS(ip_sqr_uint8)) {
+      EXPECT_EQ(func(x.data(), y.data(), dim), ref_ip(x, y)) << name << " dim=" << dim;
+    }
+  }
+}
+
+TEST(Int8DistanceTest, ExtremeValuesDoNotOverflow) {
+  const size_t dim = 4096;
+  std::vector<int8_t> lo(dim, -128);
+  std::vector<int8_t> hi(dim, 127);
+  std::vector<uint8_t> zero(dim, 0);
+  std::vector<uint8_t> full(dim, 255);
+  for (const auto &[name, func] : ALAYA_INT8_VARIANTS(l2_sqr_int8)) {
+    EXPECT_EQ(func(lo.data(), hi.data(), dim), ref_l2(lo, hi)) << name;
+  }
+  for (const auto &[name, func] : ALAYA_INT8_VARIANTS(ip_sqr_int8)) {
+    EXPECT_EQ(func(lo.data(), lo.data(), dim), ref_ip(lo, lo)) << name;
+  }
+  for (const auto &[name, func] : ALAYA_INT8_VARIANTS(l2_sqr_uint8)) {
+    EXPECT_EQ(func(zero.data(), full.data(), dim), ref_l2(zero, full)) << name;
+  }
+  for (const auto &[name, func] : ALAYA_INT8_VARIANTS(ip_sqr_uint8)) {
+    EXPECT_EQ(func(full.data(), full.data(), dim), ref_ip(full, full)) << name;
+  }
+}
+
+TEST(Int8DistanceTest, Sq8IntegerKernelsAreExact) {
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<int> weight_dist(0, kSq8L2WeightMax);
+  for (size_t dim : kDims) {
+    auto x = make_random<uint8_t>(dim, rng);
+    auto y = make_random<uint8_t>(dim, rng);
+    auto w8 = make_random<int8_t>(dim, rng);
+    std::vector<int16_t> w16(dim);
+    int64_t ref_weighted = 0;
+    int64_t ref_dot = 0;
+    for (size_t i = 0; i < dim; ++i) {
+      w16[i] = static_cast<int16_t>(weight_dist(rng));
+      int64_t diff = static_cast<int64_t>(x[i]) - y[i];
+      ref_weighted += w16[i] * diff * diff;
+      ref_dot += static_cast<int64_t>(y[i]) * w8[i];
+    }
+    // worst case for the int16 products and the int32 lanes
+    if (dim == 2100) {
+      std::fill(x.begin(), x.end(), 0);
+      std::fill(y.begin(), y.end(), 255);
+      std::fill(w16.begin(), w16.end(), kSq8L2WeightMax);
+      ref_weighted = static_cast<int64_t>(dim) * kSq8L2WeightMax * 255 * 255;
+      ref_dot = 0;
+      for (size_t i = 0; i < dim; ++i) {
+        ref_dot += 255 * static_cast<int64_t>(w8[i]);
+      }
+    }
+    for (const auto &[name, func] : ALAYA_INT8_VNNI_VARIANTS(l2_sqr_sq8_weighted)) {
+      EXPECT_EQ(func(x.data(), y.data(), w16.data(), dim), ref_weighted)
+          << name << " dim=" << dim;
+    }
+    for (const auto &[name, func] : ALAYA_INT8_VNNI_VARIANTS(dot_sq8_int8)) {
+      EXPECT_EQ(func(y.data(), w8.data(), dim), ref_dot) << name << " dim=" << dim;
+    }
+  }
+}
+
+TEST(Int8DistanceTest, PublicApiDispatchesIntegerTypes) {
+  std::mt19937 rng(11);
+  auto x = make_random<int8_t>(96, rng);
+  auto y = make_random<int8_t>(96, rng);
+  EXPECT_EQ((l2_sqr<int8_t, float>(x.data(), y.data(), 96)), static_cast<float>(ref_l2(x, y)));
+  EXPECT_EQ((ip_sqr<int8_t, float>(x.data(), y.data(), 96)), static_cast<float>(ref_ip(x, y)));
+  auto u = make_random<uint8_t>(96, rng);
+  auto v = make_random<uint8_t>(96, rng);
+  EXPECT_EQ((l2_sqr<uint8_t, float>(u.data(), v.data(), 96)), static_cast<float>(ref_l2(u, v)));
+  EXPECT_EQ((ip_sqr<uint8_t, float>(u.data(), v.data(), 96)), static_cast<float>(ref_ip(u, v)));
+}
+
+}  // namespace
+}  // namespace alaya::simd
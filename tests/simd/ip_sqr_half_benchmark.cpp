@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "simd/distance_ip.hpp"
+#include "utils/half.hpp"
+
+/**
+  * @brief Benchmark for FP16 / BF16 IP SIMD distance functions
+  *
+  * Usage: ./ip_sqr_half_benchmark [dim1 dim2 ...]
+  * If no dimensions are provided, defaults to common ANN dataset dimensions.
+  * The FP32 column is the dispatched full-precision kernel on the same values, for reference.
+  */
+namespace {
+
+constexpr size_t kWarmupIterations = 1000;
+constexpr size_t kBenchmarkIterations = 100000;
+
+template <typename T>
+void fill_random(std::vector<T>& v, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+  for (auto& x : v) {
+    x = T(dist(rng));
+  }
+}
+
+struct BenchResult {
+  double ns_per_call_ = 0.0;
+  double speedup_ = 0.0;
+  bool available_ = false;
+};
+
+struct DimResults {
+  size_t dim_ = 0;
+  BenchResult fp32_;
+  BenchResult fp16_generic_;
+  BenchResult fp16_avx2_;
+  BenchResult fp16_avx512_;
+  BenchResult fp16_best_;
+  BenchResult bf16_generic_;
+  BenchResult bf16_avx2_;
+  BenchResult bf16_avx512_;
+  BenchResult bf16_best_;
+};
+
+template <typename T, typename Func>
+auto run_benchmark(Func func, const T* x, const T* y, size_t dim, size_t iterations) -> double {
+  volatile float sink = 0;
+  for (size_t i = 0; i < kWarmupIterations; ++i) {
+    sink = func(x, y, dim);
+  }
+  (void)sink;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    sink = func(x, y, dim);
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+
+  auto duration_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return static_cast<double>(duration_ns) / static_cast<double>(iterations);
+}
+
+// Time `func` and fill `result` with its speedup over `baseline_ns`
+template <typename T, typename Func>
+void measure(BenchResult& result, Func func, const std::vector<T>& x, const std::vector<T>& y,
+             double baseline_ns) {
+  result.available_ = true;
+  result.ns_per_call_ = run_benchmark(func, x.data(), y.data(), x.size(), kBenchmarkIterations);
+  result.speedup_ = baseline_ns > 0 ? baseline_ns / result.ns_per_call_ : 1.0;
+}
+
+auto run_benchmarks_for_dim(size_t dim) -> DimResults {
+  DimResults results;
+  results.dim_ = dim;
+
+  std::vector<float> xf(dim);
+  std::vector<float> yf(dim);
+  fill_random(xf, 42);
+  fill_random(yf, 123);
+  std::vector<alaya::fp16> xh(xf.begin(), xf.end());
+  std::vector<alaya::fp16> yh(yf.begin(), yf.end());
+  std::vector<alaya::bf16> xb(xf.begin(), xf.end());
+  std::vector<alaya::bf16> yb(yf.begin(), yf.end());
+
+  measure(results.fp32_, alaya::simd::get_ip_sqr_func(), xf, yf, 0);
+
+  // Generic (baseline per type)
+  measure(results.fp16_generic_, alaya::simd::ip_sqr_fp16_generic, xh, yh, 0);
+  measure(results.bf16_generic_, alaya::simd::ip_sqr_bf16_generic, xb, yb, 0);
+  double fp16_baseline = results.fp16_generic_.ns_per_call_;
+  double bf16_baseline = results.bf16_generic_.ns_per_call_;
+
+#ifdef ALAYA_ARCH_X86
+  const auto& features = alaya::simd::get_cpu_features();
+
+  // AVX2
+  if (features.avx2_ && features.fma_) {
+    if (features.f16c_) {
+      measure(results.fp16_avx2_, alaya::simd::ip_sqr_fp16_avx2, xh, yh, fp16_baseline);
+    }
+    measure(results.bf16_avx2_, alaya::simd::ip_sqr_bf16_avx2, xb, yb, bf16_baseline);
+  }
+
+  // AVX-512
+  if (features.avx512f_) {
+    measure(results.fp16_avx512_, alaya::simd::ip_sqr_fp16_avx512, xh, yh, fp16_baseline);
+  }
+  if (features.avx512bf16_) {
+    measure(results.bf16_avx512_, alaya::simd::ip_sqr_bf16_avx512, xb, yb, bf16_baseline);
+  }
+#endif
+
+  // Best (auto dispatch)
+  measure(results.fp16_best_, alaya::simd::get_ip_sqr_fp16_func(), xh, yh, fp16_baseline);
+  measure(results.bf16_best_, alaya::simd::get_ip_sqr_bf16_func(), xb, yb, bf16_baseline);
+
+  return results;
+}
+
+void print_cell(const BenchResult& r) {
+  if (!r.available_) {
+    std::cout << "N/A | ";
+  } else if (r.speedup_ > 1.05) {
+    std::cout << "**" << r.ns_per_call_ << " ns (" << r.speedup_ << "x)** | ";
+  } else {
+    std::cout << r.ns_per_call_ << " ns (" << r.speedup_ << "x) | ";
+  }
+}
+
+void print_comparison_table(const std::vector<DimResults>& all_results) {
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "\n## FP16 / BF16 IP SIMD Distance Performance Comparison\n\n";
+  std::cout << "| Dimension | FP32 AUTO | FP16 Generic | FP16 AVX2 | FP16 AVX-512 | FP16 AUTO "
+               "| BF16 Generic | BF16 AVX2 | BF16 AVX-512 BF16 | BF16 AUTO |\n";
+  std::cout << "|-----------|-----------|--------------|-----------|--------------|-----------"
+               "|--------------|-----------|------------|-----------|\n";
+
+  for (const auto& r : all_results) {
+    std::cout << "| " << r.dim_ << " | " << r.fp32_.ns_per_call_ << " ns | ";
+    for (const auto* cell : {&r.fp16_generic_, &r.fp16_avx2_, &r.fp16_avx512_, &r.fp16_best_,
+                             &r.bf16_generic_, &r.bf16_avx2_, &r.bf16_avx512_, &r.bf16_best_}) {
+      print_cell(*cell);
+    }
+    std::cout << '\n';
+  }
+
+  // Print summary
+  std::cout << "\n## Summary\n\n";
+  std::cout << "- Speedups are relative to the Generic kernel of the same type\n";
+  std::cout << "- **Bold** indicates >5% speedup over Generic baseline\n";
+  std::cout << "- **AUTO** = get_ip_sqr_fp16_func() / get_ip_sqr_bf16_func() with auto dispatch\n";
+  std::cout << "- SIMD Level: " << alaya::simd::get_simd_level_name() << '\n';
+  std::cout << "- Iterations per test: " << kBenchmarkIterations << '\n';
+}
+
+}  // namespace
+
+auto main(int argc, char* argv[]) -> int {
+  std::cout << "# FP16 / BF16 IP SIMD Distance Benchmark\n\n";
+
+  // Default: ANN mainstream dataset dimensions
+  std::vector<size_t> dims = {96, 128, 256, 384, 512, 768, 960, 1024, 1536};
+
+  // Allow custom dimensions from command line
+  if (argc > 1) {
+    dims.clear();
+    for (int i = 1; i < argc; ++i) {
+      dims.push_back(std::stoull(argv[i]));
+    }
+  }
+
+  std::cout << "Running benchmarks for dimensions: ";
+  for (size_t i = 0; i < dims.size(); ++i) {
+    if (i > 0) {
+      std::cout << ", ";
+    }
+    std::cout << dims[i];
+  }
+  std::cout << "\n\n";
+
+  std::vector<DimResults> all_results;
+  for (size_t dim : dims) {
+    std::cout << "Benchmarking dim=" << dim << "..." << std::flush;
+    all_results.push_back(run_benchmarks_for_dim(dim));
+    std::cout << " done\n";
+  }
+
+  print_comparison_table(all_results);
+
+  return 0;
+}
@@ -364,6 +364,56 @@ TEST_F(IpSQ8Test, AVX512Correctness) {
 }
 #endif
 
+// u8 code x f32 query dot product (RaBitQ extended codes)
+class DotSq8F32Test : public IpSQ8Test {
+ protected:
+  static constexpr size_t kDims[] = {1, 7, 8, 15, 16, 31, 33, 100, 129};
+
+  static auto reference_dot(const uint8_t *code, const float *query, size_t dim) -> float {
+    double sum = 0.0;
+    for (size_t i = 0; i < dim; ++i) {
+      sum += static_cast<double>(code[i]) * static_cast<double>(query[i]);
+    }
+    return static_cast<float>(sum);
+  }
+
+  auto check(alaya::simd::DotSq8F32Func func) -> void {
+    for (size_t dim : kDims) {
+      std::vector<uint8_t> code(dim);
+      std::vector<float> query(dim);
+      fill_random(code);
+      for (auto &q : query) {
+        q = float_dist_(gen_);
+      }
+      float expected = reference_dot(code.data(), query.data(), dim);
+      EXPECT_NEAR(func(code.data(), query.data(), dim), expected, 1e-5F * 255.0F * 10.0F * dim)
+          << "dim=" << dim;
+    }
+  }
+};
+
+TEST_F(DotSq8F32Test, GenericCorrectness) { check(alaya::simd::dot_sq8_f32_generic); }
+
+TEST_F(DotSq8F32Test, DispatchedCorrectness) { check(alaya::simd::get_dot_sq8_f32_func()); }
+
+#ifdef ALAYA_ARCH_X86
+TEST_F(DotSq8F32Test, AVX2CorrectnessWithTail) {
+  const auto &features = alaya::simd::get_cpu_features();
+  if (!features.avx2_ || !features.fma_) {
+    GTEST_SKIP() << "AVX2 + FMA not available";
+  }
+  check(alaya::simd::dot_sq8_f32_avx2);
+}
+
+TEST_F(DotSq8F32Test, AVX512CorrectnessWithMaskTail) {
+  const auto &features = alaya::simd::get_cpu_features();
+  if (!features.avx512f_ || !features.avx512bw_) {
+    GTEST_SKIP() << "AVX-512 F/BW not available";
+  }
+  check(alaya::simd::dot_sq8_f32_avx512);
+}
+#endif
+
 // SQ4 IP Tests
 class IpSQ4Test : public ::testing::Test {
  protected:
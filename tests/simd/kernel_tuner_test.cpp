@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "simd/kernel_tuner.hpp"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace alaya::simd {
+namespace {
+
+using TestFunc = int (*)();
+
+auto one() -> int { return 1; }
+auto two() -> int { return 2; }
+auto three() -> int { return 3; }
+
+// Pretends `two` is the fastest variant and counts the measurements
+struct FakeBench {
+  int *calls_;
+  auto operator()(TestFunc func) const -> double {
+    ++*calls_;
+    return func() == 2 ? 1.0 : 10.0 * func();
+  }
+};
+
+const std::vector<KernelCandidate<TestFunc>> kCandidates = {
+    {"one", one}, {"two", two}, {"three", three}};
+
+auto temp_profile(const char *name) -> std::string {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove(path);
+  return path.string();
+}
+
+TEST(KernelTunerTest, SelectsFastestCandidateAndCachesIt) {
+  KernelTuner tuner(nullptr);
+  int calls = 0;
+  EXPECT_EQ(tuner.select("fake", 128, kCandidates, FakeBench{&calls}), &two);
+  EXPECT_EQ(calls, 6);  // two rounds over three candidates
+
+  EXPECT_EQ(tuner.select("fake", 128, kCandidates, FakeBench{&calls}), &two);
+  EXPECT_EQ(calls, 6);
+
+  // Another dimension is tuned separately
+  tuner.select("fake", 256, kCandidates, FakeBench{&calls});
+  EXPECT_EQ(calls, 12);
+
+  auto choices = tuner.choices();
+  ASSERT_EQ(choices.size(), 2U);
+  EXPECT_EQ(choices[0].kernel_, "fake");
+  EXPECT_EQ(choices[0].dim_, 128U);
+  EXPECT_EQ(choices[0].variant_, "two");
+  EXPECT_DOUBLE_EQ(choices[0].ns_, 1.0);
+}
+
+TEST(KernelTunerTest, SingleCandidateIsNotMeasured) {
+  KernelTuner tuner(nullptr);
+  int calls = 0;
+  std::vector<KernelCandidate<TestFunc>> only = {{"one", one}};
+  EXPECT_EQ(tuner.select("fake", 64, only, FakeBench{&calls}), &one);
+  EXPECT_EQ(calls, 0);
+}
+
+TEST(KernelTunerTest, ProfileFileIsWrittenAndReusedOnTheNextRun) {
+  auto path = temp_profile("alaya_kernel_profile_test.txt");
+  int calls = 0;
+  {
+    KernelTuner tuner(path.c_str());
+    tuner.select("fake", 96, kCandidates, FakeBench{&calls});
+  }
+  EXPECT_EQ(calls, 6);
+
+  KernelTuner reloaded(path.c_str());
+  EXPECT_EQ(reloaded.select("fake", 96, kCandidates, FakeBench{&calls}), &two);
+  EXPECT_EQ(calls, 6);
+  std::filesystem::remove(path);
+}
+
+TEST(KernelTunerTest, ProfileVariantUnknownToThisCpuIsRetuned) {
+  auto path = temp_profile("alaya_kernel_profile_foreign.txt");
+  {
+    std::ofstream writer(path);
+    writer << "# written on another host\n";
+    writer << "fake 96 avx512_future 0.5 test-cpu\n";
+  }
+  KernelTuner tuner(path.c_str(), "test-cpu");
+  int calls = 0;
+  EXPECT_EQ(tuner.select("fake", 96, kCandidates, FakeBench{&calls}), &two);
+  EXPECT_EQ(calls, 6);
+  ASSERT_EQ(tuner.choices().size(), 1U);
+  EXPECT_EQ(tuner.choices()[0].variant_, "two");
+  std::filesystem::remove(path);
+}
+
+TEST(KernelTunerTest, RetunedVariantReplacesItsProfileLine) {
+  auto path = temp_profile("alaya_kernel_profile_rewrite.txt");
+  {
+    std::ofstream writer(path);
+    writer << "fake 96 avx512_future 0.5 test-cpu\n";
+    writer << "fake 128 one 3.0 test-cpu\n";
+  }
+  int calls = 0;
+  for (int run = 0; run < 3; ++run) {
+    KernelTuner tuner(path.c_str(), "test-cpu");
+    EXPECT_EQ(tuner.select("fake", 96, kCandidates, FakeBench{&calls}), &two);
+  }
+  EXPECT_EQ(calls, 6);  // measured by the first run only
+
+  // One line per CPU, kernel and dimension, whatever the number of runs
+  std::ifstream reader(path);
+  std::vector<std::string> lines;
+  for (std::string line; std::getline(reader, line);) {
+    if (!line.empty() && line[0] != '#') {
+      lines.push_back(line);
+    }
+  }
+  ASSERT_EQ(lines.size(), 2U);
+  EXPECT_EQ(lines[0].rfind("fake 96 two ", 0), 0U);
+  EXPECT_EQ(lines[1].rfind("fake 128 one ", 0), 0U);
+  std::filesystem::remove(path);
+}
+
+TEST(KernelTunerTest, LaterProfileLineWins) {
+  auto path = temp_profile("alaya_kernel_profile_duplicate.txt");
+  {
+    std::ofstream writer(path);
+    writer << "fake 96 one 9.0 test-cpu\n";
+    writer << "fake 96 three 2.0 test-cpu\n";
+  }
+  KernelTuner tuner(path.c_str(), "test-cpu");
+  ASSERT_EQ(tuner.choices().size(), 1U);
+  int calls = 0;
+  EXPECT_EQ(tuner.select("fake", 96, kCandidates, FakeBench{&calls}), &three);
+  EXPECT_EQ(calls, 0);
+  std::filesystem::remove(path);
+}
+
+TEST(KernelTunerTest, ProfileFromAnotherCpuIsRemeasured) {
+  auto path = temp_profile("alaya_kernel_profile_other_cpu.txt");
+  {
+    std::ofstream writer(path);
+    writer << "fake 96 three 0.5 other-cpu\n";
+    writer << "fake 96 one 0.1\n";  // no CPU signature, cannot be trusted anywhere
+  }
+  int calls = 0;
+  {
+    KernelTuner tuner(path.c_str(), "test-cpu");
+    EXPECT_TRUE(tuner.choices().empty());
+    EXPECT_EQ(tuner.select("fake", 96, kCandidates, FakeBench{&calls}), &two);
+    EXPECT_EQ(calls, 6);
+  }
+
+  // Both CPUs keep their own line, and each reuses it without measuring
+  KernelTuner other(path.c_str(), "other-cpu");
+  EXPECT_EQ(other.select("fake", 96, kCandidates, FakeBench{&calls}), &three);
+  KernelTuner again(path.c_str(), "test-cpu");
+  EXPECT_EQ(again.select("fake", 96, kCandidates, FakeBench{&calls}), &two);
+  EXPECT_EQ(calls, 6);
+  std::filesystem::remove(path);
+}
+
+TEST(KernelTunerTest, CpuSignatureIsStable) {
+  EXPECT_FALSE(get_cpu_signature().empty());
+  EXPECT_EQ(get_cpu_signature().find(' '), std::string::npos);
+  EXPECT_EQ(detect_cpu_signature(), get_cpu_signature());
+}
+
+TEST(KernelTunerTest, TunedGettersFollowStaticDispatchWithoutAutotunePolicy) {
+  if (kernel_autotune_enabled()) {
+    GTEST_SKIP() << "ALAYA_SIMD_DISTANCE_POLICY=autotune is set";
+  }
+  EXPECT_EQ(tune_l2_sqr_func(128), get_l2_sqr_func());
+  EXPECT_EQ(tune_ip_sqr_func(128), get_ip_sqr_func());
+  EXPECT_EQ(tune_l2_sqr_batch4_func(128), get_l2_sqr_batch4_func());
+  EXPECT_EQ(tune_dot_sq8_batch4_func(128), get_dot_sq8_batch4_func());
+  EXPECT_EQ(tune_l2_sqr_sq4_batch4_func(128), get_l2_sqr_sq4_batch4_func());
+  EXPECT_EQ(tune_l2_sqr_sq8_func(128), get_l2_sqr_sq8_func());
+  EXPECT_EQ(tune_ip_sqr_sq8_func(128), get_ip_sqr_sq8_func());
+  EXPECT_EQ(tune_l2_sqr_sq4_func(128), get_l2_sqr_sq4_func());
+  EXPECT_EQ(tune_ip_sqr_sq4_func(128), get_ip_sqr_sq4_func());
+}
+
+TEST(KernelTunerTest, RealKernelsCanBeTimed) {
+  KernelTuner tuner(nullptr);
+  const size_t dim = 100;
+#ifdef ALAYA_ARCH_X86
+  auto candidates = tuner_detail::fp_candidates(l2_sqr_generic, l2_sqr_avx2, l2_sqr_avx512);
+#else
+  auto candidates = tuner_detail::fp_candidates(l2_sqr_generic, l2_sqr_generic, l2_sqr_generic);
+#endif
+  auto func = tuner.select("l2_sqr", dim, candidates, tuner_detail::bench_fp32<L2SqrFunc>(dim));
+  std::vector<float> x(dim, 1.0F);
+  std::vector<float> y(dim, 3.0F);
+  EXPECT_FLOAT_EQ(func(x.data(), y.data(), dim), 400.0F);
+  if (candidates.size() > 1) {
+    EXPECT_GT(tuner.choices()[0].ns_, 0.0);
+  }
+}
+
+}  // namespace
+}  // namespace alaya::simd
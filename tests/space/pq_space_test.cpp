@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: 2025 AlayaDB.AI
+//
+// SPDX-License-Identifier: AGPL-3.0-only
+
+#include "space/pq_space.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "space/raw_space.hpp"
+
+namespace alaya {
+
+class PQSpaceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 rng(7);
+    std::normal_distribution<float> dist(0.0F, 1.0F);
+    data_.resize(static_cast<size_t>(n_) * dim_);
+    for (auto &v : data_) {
+      v = dist(rng);
+    }
+    file_name_ = "test_pq_space.bin";
+    if (std::filesystem::exists(file_name_)) {
+      std::filesystem::remove(file_name_);
+    }
+  }
+
+  void TearDown() override {
+    if (std::filesystem::exists(file_name_)) {
+      std::filesystem::remove(file_name_);
+    }
+  }
+
+  auto make_space(MetricType metric, uint32_t n_chunks = 0) -> std::shared_ptr<PQSpace<>> {
+    auto space = std::make_shared<PQSpace<>>(n_ + 8, dim_, metric,
+                                             RocksDBConfig::default_config(), n_chunks);
+    space->fit(data_.data(), n_);
+    return space;
+  }
+
+  uint32_t n_ = 1000;
+  uint32_t dim_ = 32;
+  std::vector<float> data_;
+  std::string file_name_;
+};
+
+TEST_F(PQSpaceTest, Initialization) {
+  PQSpace<> space(16, dim_, MetricType::L2);
+  EXPECT_EQ(space.get_dim(), 32);
+  EXPECT_EQ(space.get_n_chunks(), 4);  // 8 dimensions per chunk by default
+  EXPECT_EQ(space.get_data_size(), 4);
+  EXPECT_EQ(space.get_data_num(), 0);
+
+  PQSpace<> explicit_chunks(16, dim_, MetricType::L2, RocksDBConfig::default_config(), 16);
+  EXPECT_EQ(explicit_chunks.get_data_size(), 16);
+  EXPECT_THROW(PQSpace<>(16, dim_, MetricType::L2, RocksDBConfig::default_config(), 5),
+               std::invalid_argument);
+}
+
+TEST_F(PQSpaceTest, QueryDistanceMatchesDecodedL2) {
+  auto space = make_space(MetricType::L2, 8);
+  const auto &quantizer = space->get_quantizer();
+  const float *query = data_.data() + 3 * dim_;
+  auto computer = space->get_query_computer(query);
+  std::vector<float> decoded(dim_);
+  auto l2 = simd::get_l2_sqr_func();
+  for (uint32_t id = 0; id < 50; ++id) {
+    quantizer.decode(space->get_data_by_id(id), decoded.data());
+    EXPECT_NEAR(computer(id), l2(query, decoded.data(), dim_), 1e-3F);
+  }
+}
+
+TEST_F(PQSpaceTest, QueryDistanceMatchesDecodedIP) {
+  auto space = make_space(MetricType::IP, 8);
+  const auto &quantizer = space->get_quantizer();
+  const float *query = data_.data() + 5 * dim_;
+  auto computer = space->get_query_computer(query);
+  std::vector<float> decoded(dim_);
+  auto ip = simd::get_ip_sqr_func();
+  for (uint32_t id = 0; id < 50; ++id) {
+    quantizer.decode(space->get_data_by_id(id), decoded.data());
+    EXPECT_NEAR(computer(id), ip(query, decoded.data(), dim_), 1e-3F);
+  }
+}
+
+TEST_F(PQSpaceTest, ComputeMatchesOperator) {
+  for (auto metric : {MetricType::L2, MetricType::IP}) {
+    auto space = make_space(metric);
+    std::vector<uint8_t> buffer(space->get_query_buffer_size() + 64);
+    void *aligned = buffer.data() + (64 - reinterpret_cast<uintptr_t>(buffer.data()) % 64) % 64;
+    auto computer = space->get_query_computer(data_.data(), aligned);
+    std::vector<uint32_t> ids;
+    for (uint32_t i = 0; i < 77; ++i) {  // spans several tiles plus a partial one
+      ids.push_back((i * 131) % n_);
+    }
+    std::vector<float> out(ids.size());
+    computer.compute(ids.data(), ids.size(), out.data());
+    for (size_t i = 0; i < ids.size(); ++i) {
+      EXPECT_EQ(out[i], computer(ids[i]));
+    }
+  }
+}
+
+TEST_F(PQSpaceTest, SymmetricDistanceApproximatesL2) {
+  auto space = make_space(MetricType::L2, 16);
+  RawSpace<> raw(n_, dim_, MetricType::L2);
+  raw.fit(data_.data(), n_);
+  double err = 0.0;
+  double total = 0.0;
+  for (uint32_t i = 0; i < 100; ++i) {
+    auto exact = raw.get_distance(i, i + 100);
+    err += std::abs(space->get_distance(i, i + 100) - exact);
+    total += exact;
+  }
+  EXPECT_LT(err / total, 0.3);
+}
+
+TEST_F(PQSpaceTest, NearestNeighborRecall) {
+  auto space = make_space(MetricType::L2, 16);
+  auto l2 = simd::get_l2_sqr_func();
+  uint32_t hits = 0;
+  for (uint32_t q = 0; q < 20; ++q) {
+    const float *query = data_.data() + q * 37 * dim_;
+    auto computer = space->get_query_computer(query);
+    uint32_t best_exact = 0;
+    uint32_t best_pq = 0;
+    for (uint32_t id = 1; id < n_; ++id) {
+      if (l2(query, data_.data() + id * dim_, dim_) <
+          l2(query, data_.data() + best_exact * dim_, dim_)) {
+        best_exact = id;
+      }
+      if (computer(id) < computer(best_pq)) {
+        best_pq = id;
+      }
+    }
+    hits += static_cast<uint32_t>(best_exact == best_pq);
+  }
+  EXPECT_GE(hits, 18);  // the query itself is in the data, so its own code should win
+}
+
+TEST_F(PQSpaceTest, InsertEncodesWithTrainedCodebooks) {
+  auto space = make_space(MetricType::L2);
+  std::vector<float> vec(data_.begin() + 9 * dim_, data_.begin() + 10 * dim_);
+  auto id = space->insert(vec.data());
+  EXPECT_EQ(id, n_);
+  EXPECT_EQ(space->get_data_num(), n_ + 1);
+  EXPECT_EQ(space->get_distance(9, id), 0.0F);
+}
+
+TEST_F(PQSpaceTest, SaveAndLoad) {
+  auto space = make_space(MetricType::L2);
+  space->save(file_name_);
+
+  PQSpace<> loaded;
+  loaded.load(file_name_);
+  EXPECT_EQ(loaded.get_dim(), space->get_dim());
+  EXPECT_EQ(loaded.get_data_num(), space->get_data_num());
+  EXPECT_EQ(loaded.get_n_chunks(), space->get_n_chunks());
+  auto before = space->get_query_computer(data_.data());
+  auto after = loaded.get_query_computer(data_.data());
+  for (uint32_t id = 0; id < 100; ++id) {
+    EXPECT_EQ(before(id), after(id));
+    EXPECT_EQ(space->get_distance(id, 0), loaded.get_distance(id, 0));
+  }
+}
+
+}  // namespace alaya
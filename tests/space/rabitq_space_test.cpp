@@ -125,6 +125,39 @@ TEST_F(RaBitQSpaceTest, ItemCntOverflow) {
   EXPECT_THROW(space_->fit(data.data(), item_cnt), std::length_error);
 }
 
+TEST_F(RaBitQSpaceTest, InsertRequiresBuiltGraph) {
+  space_ = std::make_shared<SpaceType>(capacity_, dim_, MetricType::L2);
+  auto data = make_test_data(2);
+  space_->fit(data.data(), 2);
+
+  EXPECT_THROW(space_->insert(data.data()), std::runtime_error);
+  EXPECT_THROW(space_->insert(nullptr), std::invalid_argument);
+}
+
+TEST_F(RaBitQSpaceTest, RemoveTombstonesNode) {
+  space_ = std::make_shared<SpaceType>(capacity_, dim_, MetricType::L2);
+  auto data = make_test_data(3);
+  space_->fit(data.data(), 3);
+
+  EXPECT_EQ(space_->remove(1), 1u);
+  EXPECT_TRUE(space_->is_deleted(1));
+  EXPECT_FALSE(space_->is_deleted(0));
+  EXPECT_EQ(space_->remove(1), static_cast<uint32_t>(-1));
+  EXPECT_EQ(space_->remove(3), static_cast<uint32_t>(-1));
+  EXPECT_EQ(space_->get_data_num(), 3u);
+  EXPECT_EQ(space_->get_avl_data_num(), 2u);
+  EXPECT_THROW(space_->remove(std::string("item_0")), std::runtime_error);
+}
+
+TEST_F(RaBitQSpaceTest, InvalidCodeWidth) {
+  EXPECT_THROW(SpaceType(capacity_, dim_, MetricType::L2, RocksDBConfig::default_config(),
+                         RotatorType::FhtKacRotator, 0),
+               std::invalid_argument);
+  EXPECT_THROW(SpaceType(capacity_, dim_, MetricType::L2, RocksDBConfig::default_config(),
+                         RotatorType::FhtKacRotator, 9),
+               std::invalid_argument);
+}
+
 TEST_F(RaBitQSpaceTest, SaveNonExistentPath) {
   const uint32_t item_cnt = 2;
   space_ = std::make_shared<SpaceType>(capacity_, dim_, MetricType::L2);
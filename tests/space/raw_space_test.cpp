@@ -4,8 +4,10 @@
 
 #include "space/raw_space.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cmath>
 #include <filesystem>
+#include <limits>
 #include "utils/metric_type.hpp"
 namespace alaya {
 
@@ -137,6 +139,62 @@ TEST_F(RawSpaceTest, TestDistanceCosineMetricUsesInnerProductPath) {
   ASSERT_FLOAT_EQ(distance, expected_distance);
 }
 
+TEST_F(RawSpaceTest, TestDistanceHalfPrecision) {
+  std::vector<float> data1 = {1.5F, -2.0F, 3.25F};
+  std::vector<float> data2 = {0.5F, 4.0F, -1.0F};
+
+  RawSpace<fp16> fp16_space(100, 3, MetricType::L2);
+  RawSpace<bf16> bf16_space(100, 3, MetricType::IP);
+  for (const auto *vec : {data1.data(), data2.data()}) {
+    std::vector<fp16> h(vec, vec + 3);
+    std::vector<bf16> b(vec, vec + 3);
+    fp16_space.insert(h.data());
+    bf16_space.insert(b.data());
+  }
+
+  // all inputs are exact in both formats
+  ASSERT_FLOAT_EQ(fp16_space.get_distance(0, 1), 1.0F + 36.0F + 18.0625F);
+  ASSERT_FLOAT_EQ(bf16_space.get_distance(0, 1), -(0.75F - 8.0F - 3.25F));
+}
+
+TEST_F(RawSpaceTest, TestDistanceInt8) {
+  std::vector<int8_t> data1 = {-128, 127, 5};
+  std::vector<int8_t> data2 = {127, -128, -7};
+
+  RawSpace<int8_t> l2_space(100, 3, MetricType::L2);
+  RawSpace<int8_t> ip_space(100, 3, MetricType::IP);
+  for (const auto *vec : {data1.data(), data2.data()}) {
+    l2_space.insert(vec);
+    ip_space.insert(vec);
+  }
+
+  // integer kernels are exact, including the extremes of the int8 range
+  ASSERT_FLOAT_EQ(l2_space.get_distance(0, 1), 255.0F * 255.0F * 2.0F + 144.0F);
+  ASSERT_FLOAT_EQ(ip_space.get_distance(0, 1), -(-128.0F * 127.0F * 2.0F - 35.0F));
+}
+
+TEST_F(RawSpaceTest, TestQueryComputerBatch) {
+  constexpr uint32_t kDim = 19;
+  std::vector<float> data(kDim * 20);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = std::sin(static_cast<float>(i));
+  }
+  std::vector<IDType> ids = {4, 0, 13, 7, 19, 2};  // one full group plus a short one
+  for (auto metric : {MetricType::L2, MetricType::IP}) {
+    RawSpace<DataType, DistanceType, IDType> space(20, kDim, metric);
+    space.fit(data.data(), 20);
+    space.remove(13);
+    auto query_computer = space.get_query_computer(data.data() + 5 * kDim);
+    std::vector<float> dists(ids.size());
+    query_computer.compute(ids.data(), ids.size(), dists.data());
+    for (size_t i = 0; i < ids.size(); ++i) {
+      float expected = query_computer(ids[i]);
+      ASSERT_NEAR(dists[i], expected, 1e-4F * std::max(1.0F, std::abs(expected)));
+    }
+    EXPECT_EQ(dists[2], std::numeric_limits<float>::max());
+  }
+}
+
 TEST_F(RawSpaceTest, TestFitRejectsNullDataAndCapacityOverflow) {
   std::vector<float> data = {1.0F, 2.0F, 3.0F};
 
@@ -5,6 +5,7 @@
 #include "space/sq4_space.hpp"
 #include <gtest/gtest.h>
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <filesystem>
@@ -101,6 +102,32 @@ TEST_F(SQ4SpaceTest, QueryComputerWithId) {
   EXPECT_GE(query_computer(1), 64);
 }
 
+TEST_F(SQ4SpaceTest, QueryComputerBatchMatchesSingle) {
+  constexpr uint32_t kDim = 37;
+  constexpr uint32_t kNum = 50;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+  std::vector<float> data(kDim * kNum);
+  for (auto &v : data) {
+    v = dist(rng);
+  }
+  std::vector<uint32_t> ids = {3, 17, 0, 42, 9, 9, 25};  // one full group plus a short one
+  for (auto metric : {MetricType::L2, MetricType::IP}) {
+    SQ4Space<> space(kNum, kDim, metric);
+    space.fit(data.data(), kNum);
+    for (bool from_id : {false, true}) {
+      auto query_computer = from_id ? space.get_query_computer(static_cast<uint32_t>(11))
+                                    : space.get_query_computer(data.data() + 11 * kDim);
+      std::vector<float> dists(ids.size());
+      query_computer.compute(ids.data(), ids.size(), dists.data());
+      for (size_t i = 0; i < ids.size(); ++i) {
+        float expected = query_computer(ids[i]);
+        EXPECT_NEAR(dists[i], expected, 1e-4F * std::max(1.0F, std::abs(expected)));
+      }
+    }
+  }
+}
+
 TEST_F(SQ4SpaceTest, PrefetchById) {
   float data[8] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
   space_->fit(reinterpret_cast<float *>(data), 2);
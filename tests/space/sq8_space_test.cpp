@@ -4,10 +4,14 @@
 
 #include "space/sq8_space.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
 #include <filesystem>
 #include <memory>
+#include <numeric>
+#include <random>
 #include <string_view>
 #include <vector>
 #include "utils/log.hpp"
@@ -99,6 +103,98 @@ TEST_F(SQ8SpaceTest, QueryComputerWithId) {
   EXPECT_GE(query_computer(1), 64);
 }
 
+TEST_F(SQ8SpaceTest, QueryComputerBatchMatchesSingle) {
+  constexpr uint32_t kDim = 37;
+  constexpr uint32_t kNum = 50;
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> dist(-1.0F, 1.0F);
+  std::vector<float> data(kDim * kNum);
+  for (auto &v : data) {
+    v = dist(rng);
+  }
+  std::vector<uint32_t> ids = {3, 17, 0, 42, 9, 9, 25};  // one full group plus a short one
+  for (auto metric : {MetricType::L2, MetricType::IP}) {
+    SQ8Space<> space(kNum, kDim, metric);
+    space.fit(data.data(), kNum);
+    for (bool from_id : {false, true}) {
+      auto query_computer = from_id ? space.get_query_computer(static_cast<uint32_t>(11))
+                                    : space.get_query_computer(data.data() + 11 * kDim);
+      std::vector<float> dists(ids.size());
+      query_computer.compute(ids.data(), ids.size(), dists.data());
+      for (size_t i = 0; i < ids.size(); ++i) {
+        float expected = query_computer(ids[i]);
+        EXPECT_NEAR(dists[i], expected, 1e-4F * std::max(1.0F, std::abs(expected)));
+      }
+    }
+  }
+}
+
+TEST_F(SQ8SpaceTest, QueryComputerTracksCodeDistance) {
+  // The integer query path (opt-in on VNNI) keeps 7-bit weights, so distances stay close to the
+  // FP32 ones when every dimension has a similar range
+  constexpr uint32_t kDim = 96;
+  constexpr uint32_t kNum = 200;
+  std::mt19937 rng(5);
+  std::normal_distribution<float> dist(0.0F, 1.0F);
+  std::vector<float> data(kDim * kNum);
+  for (auto &v : data) {
+    v = dist(rng);
+  }
+  for (auto metric : {MetricType::L2, MetricType::IP}) {
+    SQ8Space<> space(kNum, kDim, metric);
+    space.fit(data.data(), kNum);
+    auto query_computer = space.get_query_computer(static_cast<uint32_t>(11));
+    float max_abs = 0.0F;
+    for (uint32_t u = 0; u < kNum; ++u) {
+      max_abs = std::max(max_abs, std::abs(space.get_distance(11, u)));
+    }
+    std::vector<uint32_t> ids(kNum);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::vector<float> dists(kNum);
+    query_computer.compute(ids.data(), ids.size(), dists.data());
+    for (uint32_t u = 0; u < kNum; ++u) {
+      float expected = space.get_distance(11, u);
+      EXPECT_NEAR(dists[u], expected, 0.01F * max_abs) << "id=" << u;
+    }
+  }
+}
+
+TEST_F(SQ8SpaceTest, QueryComputerKeepsNarrowDimensions) {
+  // Half of the dimensions span a range 1000x narrower than the others and carry all of the
+  // difference between rows; the default query path must still rank by them exactly
+  constexpr uint32_t kDim = 64;
+  constexpr uint32_t kNum = 100;
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<float> wide(-100.0F, 100.0F);
+  std::uniform_real_distribution<float> narrow(-0.1F, 0.1F);
+  std::vector<float> data(kDim * kNum);
+  std::vector<float> shared(kDim / 2);
+  for (auto &v : shared) {
+    v = wide(rng);
+  }
+  for (uint32_t u = 0; u < kNum; ++u) {
+    for (uint32_t d = 0; d < kDim; ++d) {
+      data[u * kDim + d] = d % 2 == 0 ? shared[d / 2] : narrow(rng);
+    }
+  }
+  // Give the wide dimensions their full range so the quantizer sees them as wide
+  data[0] = -100.0F;
+  data[kDim] = 100.0F;
+  for (auto metric : {MetricType::L2, MetricType::IP}) {
+    SQ8Space<> space(kNum, kDim, metric);
+    space.fit(data.data(), kNum);
+    auto query_computer = space.get_query_computer(static_cast<uint32_t>(7));
+    std::vector<uint32_t> ids(kNum);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::vector<float> dists(kNum);
+    query_computer.compute(ids.data(), ids.size(), dists.data());
+    for (uint32_t u = 2; u < kNum; ++u) {
+      float expected = space.get_distance(7, u);
+      EXPECT_NEAR(dists[u], expected, 1e-3F * std::max(1.0F, std::abs(expected))) << "id=" << u;
+    }
+  }
+}
+
 TEST_F(SQ8SpaceTest, PrefetchById) {
   float data[8] = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
   space_->fit(reinterpret_cast<float *>(data), 2);
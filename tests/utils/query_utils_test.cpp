@@ -116,6 +116,31 @@ TEST_F(LinearPoolTest, ConcurrentInsertTest) {
   EXPECT_LE(pool_->size(), 5);  // Size should be less than or equal to capacity
 }
 
+TEST(LinearPoolResetTest, ResetEmptiesPoolAndVisitedSetInPlace) {
+  LinearPool<float, uint32_t, EpochVisitedSet<uint8_t>> pool(10, 3);
+  pool.insert(4, 1.0F);
+  pool.insert(7, 0.5F);
+  pool.vis_.set(4);
+  pool.pop();
+
+  pool.reset(10, 5);
+  EXPECT_EQ(pool.size(), 0U);
+  EXPECT_FALSE(pool.has_next());
+  EXPECT_EQ(pool.capacity(), 5U);
+  EXPECT_FALSE(pool.vis_.get(4));
+  for (uint32_t id = 0; id < 6; ++id) {
+    pool.insert(id, static_cast<float>(10 - id));
+  }
+  EXPECT_EQ(pool.size(), 5U);
+  EXPECT_EQ(pool.next_id(), 5U);
+
+  // A larger index regrows the visited set instead of indexing past it.
+  pool.reset(40, 5);
+  EXPECT_GE(pool.vis_.size(), 40U);
+  pool.vis_.set(39);
+  EXPECT_TRUE(pool.vis_.get(39));
+}
+
 TEST(EpochVisitedSetTest, ClearResetsLogicalState) {
   EpochVisitedSet<> visited(8);
 
@@ -134,6 +159,20 @@ TEST(EpochVisitedSetTest, ClearResetsLogicalState) {
   EXPECT_FALSE(visited.get(2));
 }
 
+TEST(EpochVisitedSetTest, NarrowTagsClearOnWrapAround) {
+  EpochVisitedSet<uint8_t> visited(4);
+
+  // Node 1 is marked in the first epoch only; when the tag wraps back to that value it must not
+  // read as visited.
+  visited.set(1);
+  for (int i = 0; i < 255; ++i) {
+    visited.clear();
+    EXPECT_FALSE(visited.get(1)) << "clear " << i;
+  }
+  visited.set(2);
+  EXPECT_TRUE(visited.get(2));
+}
+
 TEST(EpochVisitedSetTest, ResizeClearsExistingState) {
   EpochVisitedSet<> visited(4);
 